@@ -55,5 +55,6 @@ ChipDialogManager *DialogPage::GetDialogManager() const
 void DialogPage::SetDirty(Class *cg)
 {
 	GetDialogManager()->SetDirty(cg ? cg : GetChip()->GetClass());
+	GetChip()->SetUpdateStamp(); // Chips using RefreshMode::OnInputChange must see that we have changed.
 	_edited = true;
 }
@@ -30,7 +30,6 @@
 #include "StdChips/Value.h"
 #include "M3DEngine/DocumentSaveLoadUtil.h"
 #include "M3DEngine/Engine.h"
-#include "RenderSettings.h"
 
 
 using namespace m3d;
@@ -74,6 +73,9 @@ bool _3DObject::SaveChip(DocumentSaver &saver) const
 
 void _3DObject::CallChip()
 {
+	if (!engine->GetGraphics()->CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	Render(MatrixChip::IDENTITY, 1, 0, _enableFrustumCulling);
 }
 
@@ -113,7 +115,7 @@ void _3DObject::Render(const XMFLOAT4X4 &parentMatrix, uint32 instanceCount, uin
 	}
 
 	// Clear the lock for any bound resources!
-	engine->GetGraphics()->rs()->ClearGraphicsRootDescriptorTables();
+	engine->GetGraphics()->GetRenderState()->ClearGraphicsRootDescriptorTables();
 }
 
 
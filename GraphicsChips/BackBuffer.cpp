@@ -79,5 +79,6 @@ const Descriptor& BackBuffer::GetRenderTargetViewDescriptor()
 
 D3D12RenderWindow* BackBuffer::GetRenderWindow()
 {
-	return dynamic_cast<D3D12RenderWindow*>(graphics()->GetRenderWindowManager()->GetRenderWindow());
+	RenderWindowManager* rwm = graphics()->GetRenderWindowManager();
+	return rwm ? dynamic_cast<D3D12RenderWindow*>(rwm->GetRenderWindow()) : nullptr; // No manager when running headless.
 }
\ No newline at end of file
@@ -191,6 +191,9 @@ void Compute::UpdateChip()
 
 void Compute::CallChip()
 {
+	if (!CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	try {
 		D3D_DEBUG_REPORTER_BLOCK
 
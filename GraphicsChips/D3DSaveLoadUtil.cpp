@@ -23,27 +23,68 @@
 
 #include "pch.h"
 #include "D3DSaveLoadUtil.h"
+#include "M3DCore/DataBuffer.h"
 //#include "InputElementDescs.h"
 
 
 using namespace m3d;
 
 
+namespace
+{
+	// ID3DBlob keeping a reference to a (shared) DataBuffer. Lets shaders loaded from blobs of equal content use the same memory.
+	class DataBufferBlob : public ID3DBlob
+	{
+		std::atomic<ULONG> _refCount;
+		DataBuffer _data;
+
+	public:
+		DataBufferBlob(const DataBuffer &data) : _refCount(1), _data(data) {}
+
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void **ppvObject) override
+		{
+			if (!ppvObject)
+				return E_POINTER;
+			if (riid == __uuidof(ID3DBlob) || riid == __uuidof(IUnknown)) {
+				*ppvObject = static_cast<ID3DBlob*>(this);
+				AddRef();
+				return S_OK;
+			}
+			*ppvObject = nullptr;
+			return E_NOINTERFACE;
+		}
+		ULONG STDMETHODCALLTYPE AddRef() override { return ++_refCount; }
+		ULONG STDMETHODCALLTYPE Release() override
+		{
+			ULONG c = --_refCount;
+			if (c == 0)
+				delete this;
+			return c;
+		}
+		LPVOID STDMETHODCALLTYPE GetBufferPointer() override { return (LPVOID)_data.getConstBuffer(); } // Byte code is never written to!
+		SIZE_T STDMETHODCALLTYPE GetBufferSize() override { return _data.getBufferSize(); }
+	};
+}
+
 bool m3d::SerializeDocumentData(DocumentSaver &saver, const ID3DBlob *data)
 {
 	ID3DBlob *d = (ID3DBlob*)data;
 	
-	SAVE("size", (uint32)d->GetBufferSize());
-	SAVEARRAY("data", d->GetBufferPointer(), (uint32)d->GetBufferSize());
-	return true;
+	// Same format as DataBuffer, so large byte code is stored by content hash.
+	return SerializeDocumentData(saver, DataBuffer((const uint8*)d->GetBufferPointer(), d->GetBufferSize(), nullptr));
 }
 
 bool m3d::DeserializeDocumentData(DocumentLoader &loader, ID3DBlob *&data)
 {
-	uint32 size = 0;
-	LOAD("size", size);
-	B_RETURN(SUCCEEDED(D3DCreateBlob(size, &data)));
-	LOADARRAY("data", data->GetBufferPointer(), size);
+	DataBuffer db;
+	B_RETURN(DeserializeDocumentData(loader, db));
+	if (db.isShared()) {
+		data = new DataBufferBlob(db);
+		return true;
+	}
+	B_RETURN(SUCCEEDED(D3DCreateBlob(db.getBufferSize(), &data)));
+	if (db.getBufferSize())
+		std::memcpy(data->GetBufferPointer(), db.getConstBuffer(), db.getBufferSize());
 	return true;
 }
 
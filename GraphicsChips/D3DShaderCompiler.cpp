@@ -0,0 +1,104 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "D3DShaderCompiler.h"
+#include "RenderSettings.h"
+
+using namespace m3d;
+
+
+namespace
+{
+
+class ShaderInclude : public ID3DInclude
+{
+public:
+	ShaderInclude() {}
+	~ShaderInclude() {}
+
+	HRESULT Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes)
+	{
+		if (String("Std") == String(pFileName)) {
+			*ppData = STD_TEXT;
+			*pBytes = sizeof(STD_TEXT) - 1; // -1 to exclude final null.
+			return S_OK;
+		}
+		return E_FAIL;
+	}
+
+	HRESULT Close(LPCVOID pData) { return S_OK; }
+};
+
+// The macro list must be null terminated, and point into strings living as long as the list.
+List<D3D_SHADER_MACRO> _getMacros(const ShaderCompileRequest &request)
+{
+	List<D3D_SHADER_MACRO> macros;
+	for (const auto &n : request.defines) {
+		D3D_SHADER_MACRO m = { n.first.c_str(), n.second.c_str() };
+		macros.push_back(m);
+	}
+	D3D_SHADER_MACRO nullMacro = { nullptr, nullptr };
+	macros.push_back(nullMacro);
+	return macros;
+}
+
+}
+
+
+String D3DShaderCompiler::GetIdentity() const
+{
+	return strUtils::ConstructString(MTEXT("D3DCompiler_%1")).arg(D3D_COMPILER_VERSION);
+}
+
+bool D3DShaderCompiler::Preprocess(const ShaderCompileRequest &request, String &preprocessed, String &messages)
+{
+	List<D3D_SHADER_MACRO> macros = _getMacros(request);
+	ShaderInclude si;
+	SID3DBlob out, errorMsgs;
+
+	HRESULT hr = D3DPreprocess(request.source.c_str(), request.source.length(), nullptr, &macros.front(), &si, &out, &errorMsgs);
+
+	if (errorMsgs)
+		messages += String((const Char*)errorMsgs->GetBufferPointer());
+	if (FAILED(hr) || !out)
+		return false;
+	preprocessed = String((const Char*)out->GetBufferPointer(), out->GetBufferSize());
+	return true;
+}
+
+bool D3DShaderCompiler::Compile(const ShaderCompileRequest &request, DataBuffer &byteCode, String &messages)
+{
+	List<D3D_SHADER_MACRO> macros = _getMacros(request);
+	ShaderInclude si;
+	SID3DBlob bc, errorMsgs;
+
+	HRESULT hr = D3DCompile2(request.source.c_str(), request.source.length(), nullptr, &macros.front(), &si, request.entryPoint.c_str(), request.profile.c_str(), request.flags, 0, 0, NULL, 0, &bc, &errorMsgs);
+
+	if (errorMsgs)
+		messages += String((const Char*)errorMsgs->GetBufferPointer());
+	if (FAILED(hr) || !bc)
+		return false;
+	byteCode = DataBuffer((const uint8*)bc->GetBufferPointer(), bc->GetBufferSize());
+	return true;
+}
@@ -134,6 +134,9 @@ void DebugGeometry::AddBox(CXMMATRIX m, const XMFLOAT3& a, const XMFLOAT3& b, XM
 
 void DebugGeometry::CallChip()
 {
+	if (!CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	try {
 		HRESULT hr;
 
@@ -24,13 +24,18 @@
 #pragma once
 
 
-#ifdef GraphicsChips_EXPORTS
+#if defined(GRAPHICSCHIPS_STATIC)
+#define GRAPHICSCHIPS_API
+#elif defined(GraphicsChips_EXPORTS)
 #define GRAPHICSCHIPS_API __declspec(dllexport)
 #else
 #define GRAPHICSCHIPS_API __declspec(dllimport)
 #endif
 
+// The standalone targets (see pch.h) build without DirectXMath.
+#ifndef GRAPHICSCHIPS_STATIC
 #include "M3DCore/MMath.h"
+#endif
 
 
 #define FILE_D3DCOMPILER_XX MTEXT("d3dcompiler_47.dll")
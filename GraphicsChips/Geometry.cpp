@@ -36,6 +36,30 @@ CHIPDESCV1_DEF(Geometry, MTEXT("Geometry"), GEOMETRY_GUID, CHIP_GUID);
 
 namespace m3d
 {
+	bool SerializeDocumentData(DocumentSaver& saver, const Meshlet& data)
+	{
+		SAVE("startIndex", data.startIndex);
+		SAVE("indexCount", data.indexCount);
+		SAVE("vertexCount", data.vertexCount);
+		SAVE("center", data.center);
+		SAVE("radius", data.radius);
+		SAVE("coneAxis", data.coneAxis);
+		SAVE("coneCutoff", data.coneCutoff);
+		return true;
+	}
+
+	bool DeserializeDocumentData(DocumentLoader& loader, Meshlet& data)
+	{
+		LOAD("startIndex", data.startIndex);
+		LOAD("indexCount", data.indexCount);
+		LOAD("vertexCount", data.vertexCount);
+		LOAD("center", data.center);
+		LOAD("radius", data.radius);
+		LOAD("coneAxis", data.coneAxis);
+		LOAD("coneCutoff", data.coneCutoff);
+		return true;
+	}
+
 	bool SerializeDocumentData(DocumentSaver& saver, const GeometrySubset& data)
 	{
 		SAVE("name", data.name);
@@ -44,6 +68,8 @@ namespace m3d
 		SAVE("startLocation", data.startLocation);
 		SAVE("baseVertexLocation", data.baseVertexLocation);
 		SAVE("boundingBox", data.boundingBox);
+		if (data.meshlets.size())
+			SAVE("meshlets", data.meshlets);
 		return true;
 	}
 
@@ -55,6 +81,21 @@ namespace m3d
 		LOAD("startLocation|start", data.startLocation);
 		LOAD("baseVertexLocation|base", data.baseVertexLocation);
 		LOAD("boundingBox|bbox", data.boundingBox);
+		LOADDEF("meshlets", data.meshlets, MeshletList());
+		return true;
+	}
+
+	bool SerializeDocumentData(DocumentSaver& saver, const GeometryLOD& data)
+	{
+		SAVE("error", data.error);
+		SAVE("subsets", data.subsets);
+		return true;
+	}
+
+	bool DeserializeDocumentData(DocumentLoader& loader, GeometryLOD& data)
+	{
+		LOAD("error", data.error);
+		LOAD("subsets", data.subsets);
 		return true;
 	}
 }
@@ -64,7 +105,9 @@ bool Geometry::CopyChip(Chip* chip)
 	Geometry* c = dynamic_cast<Geometry*>(chip);
 	B_RETURN(Chip::CopyChip(c));
 	_subsets = c->_subsets;
+	_lods = c->_lods;
 	DestroyDeviceObjects();
+	SetUpdateStamp();
 	return true;
 }
 
@@ -72,7 +115,9 @@ bool Geometry::LoadChip(DocumentLoader& loader)
 {
 	B_RETURN(Chip::LoadChip(loader));
 	LOAD("subsets", _subsets);
+	LOADDEF("lods", _lods, GeometryLODList());
 	DestroyDeviceObjects();
+	SetUpdateStamp();
 	return true;
 }
 
@@ -80,13 +125,24 @@ bool Geometry::SaveChip(DocumentSaver& saver) const
 {
 	B_RETURN(Chip::SaveChip(saver));
 	SAVE("subsets", _subsets);
+	if (_lods.size())
+		SAVE("lods", _lods);
 	return true;
 }
 
 void Geometry::Clear()
 {
 	_subsets.clear();
+	_lods.clear();
 	DestroyDeviceObjects();
+	SetUpdateStamp();
+}
+
+void Geometry::CullMeshlets(MeshletDrawList& drawList, uint32 subset, uint32 lod, CXMMATRIX world, const Frustum* frustum, const XMFLOAT3* cameraPosition, MeshletCullStats* stats) const
+{
+	const GeometrySubsetList& subsets = GetLODSubsets(lod);
+	if (subset < subsets.size())
+		meshoptimization::CullMeshlets(drawList, subsets[subset].meshlets.data(), subsets[subset].meshlets.size(), world, frustum, cameraPosition, stats);
 }
 
 void Geometry::Prepare()
@@ -213,6 +269,16 @@ void Geometry::CreateDeviceObjects(D3D12_PRIMITIVE_TOPOLOGY_TYPE ptt, const D3D1
 	_isInit = true;
 }
 
+uint64 Geometry::GetSubsystemMemoryUsage(MemorySubsystem subsystem) const
+{
+	if (subsystem != MemorySubsystem::GEOMETRY)
+		return 0;
+	uint64 r = _indexBuffer ? _indexBufferView.SizeInBytes : 0;
+	for (const VertexBuffer &vb : _vertexBuffers)
+		r += vb.resource ? vb.view.SizeInBytes : 0;
+	return r;
+}
+
 void Geometry::DestroyDeviceObjects()
 {
 	_pisID = 0;
@@ -31,6 +31,7 @@
 #include "M3DCore/DataBuffer.h"
 #include "M3DCore/Frustum.h"
 #include "Graphics.h"
+#include "MeshOptimization.h"
 
 namespace m3d
 {
@@ -48,12 +49,24 @@ struct GeometrySubset
 	UINT count = 0u; // vertexCount if api is DRAW, else indexCount
 	UINT startLocation = 0u; // startVertexLocation if api is DRAW, else startIndexLocation
 	INT baseVertexLocation = 0; // Offset into the vertex array
+	MeshletList meshlets; // Clusters of the triangles for culling. Their index ranges are within this subset. Empty if not built.
 	mutable uint32 _cullingPlane = 0u; // This MAY improve performance in some cases by testing the frustum plane we failed last frame first.. Works good in theory :)
 };
 
 typedef List<GeometrySubset> GeometrySubsetList;
+
+// A level of detail. Has one subset for each subset of the base mesh, in the same order, drawing from the same vertex and index buffers.
+struct GeometryLOD
+{
+	float32 error = 0.0f; // Max geometric error compared to the base mesh, in object space units.
+	GeometrySubsetList subsets;
+};
+
+typedef List<GeometryLOD> GeometryLODList;
 //template class GRAPHICSCHIPS_API List<GeometrySubset>;
 
+// The update stamp is set when the subsets or the data are replaced or transformed, so that chips processing geometry can skip
+// unchanged ones. Adding vertex data is not tracked until the subset is committed.
 class GRAPHICSCHIPS_API Geometry : public Chip, public GraphicsUsage
 {
 	CHIPDESC_DECL;
@@ -66,6 +79,8 @@ public:
 
 	void OnDestroyDevice() override { return DestroyDeviceObjects(); }
 
+	uint64 GetSubsystemMemoryUsage(MemorySubsystem subsystem) const override;
+
 	// Prepares GPU before rendering. Will create device objects if they do not exist!
 	virtual void Prepare();
 	// Updates anything neccessary in the geometry!
@@ -84,16 +99,30 @@ public:
 	// Get the draw api. (If we are to use index buffer or not) To be overridden!
 	virtual DrawApi GetAPI() const { return DRAW; }
 	// Sets the subsets.
-	virtual void SetSubsets(const GeometrySubsetList& subsets) { _subsets = subsets; }
+	virtual void SetSubsets(const GeometrySubsetList& subsets) { _subsets = subsets; SetUpdateStamp(); }
 	// Adds a new subset to the end of the list.
-	virtual void AddSubset(const GeometrySubset& subset) { _subsets.push_back(subset); }
+	virtual void AddSubset(const GeometrySubset& subset) { _subsets.push_back(subset); SetUpdateStamp(); }
 	// Sets a subset at given index.
-	virtual void SetSubset(const GeometrySubset& subset, uint32 index) { _subsets[index] = subset; }
+	virtual void SetSubset(const GeometrySubset& subset, uint32 index) { _subsets[index] = subset; SetUpdateStamp(); }
 	// Gets the list of subsets.
 	virtual const GeometrySubsetList& GetSubsets() const { return _subsets; }
 
 	// Set bounding box for given subset.
 	virtual void SetBoundingBox(const AxisAlignedBox& aabb, uint32 subset) { _subsets[subset].boundingBox = aabb; }
+	// Gets the number of levels of detail, including the base mesh (level 0).
+	virtual uint32 GetLODCount() const { return 1 + (uint32)_lods.size(); }
+	// Gets the subsets for the given level of detail. Level 0 (or invalid levels) gives the base subsets.
+	virtual const GeometrySubsetList& GetLODSubsets(uint32 lod) const { return lod == 0 || lod > _lods.size() ? _subsets : _lods[lod - 1].subsets; }
+	// Gets the max geometric error for the given level of detail.
+	virtual float32 GetLODError(uint32 lod) const { return lod == 0 || lod > _lods.size() ? 0.0f : _lods[lod - 1].error; }
+	// Gets the levels of detail, not including the base mesh.
+	virtual const GeometryLODList& GetLODs() const { return _lods; }
+	// Sets the levels of detail. Each level must have the same number of subsets as the base mesh.
+	virtual void SetLODs(const GeometryLODList& lods) { _lods = lods; SetUpdateStamp(); }
+	// Removes all levels of detail.
+	virtual void ClearLODs() { _lods.clear(); SetUpdateStamp(); }
+	// Culls the meshlets of a subset of the given level of detail, appending the index ranges to draw. See meshoptimization::CullMeshlets(...).
+	virtual void CullMeshlets(MeshletDrawList& drawList, uint32 subset, uint32 lod, CXMMATRIX world, const Frustum* frustum, const XMFLOAT3* cameraPosition, MeshletCullStats* stats = nullptr) const;
 
 	// When uploaded to gpu, this is the InputElementDescsID.
 	virtual PipelineStateDescID GetPipelineInputStateDescID() const { return _pisID; }
@@ -102,6 +131,7 @@ public:
 
 protected:
 	GeometrySubsetList _subsets;
+	GeometryLODList _lods;
 
 	// These are generated!
 	uint32 _cullingPlane = Frustum::LEFTP; // This MAY improve performance in some cases by testing the frustum plane we failed last frame first.. Works good in theory :)
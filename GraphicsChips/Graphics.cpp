@@ -38,6 +38,7 @@
 #include "DebugFont.h"
 #include "M3DEngine/Application.h"
 #include "ResourceStateTracker.h"
+#include "Shader.h"
 #include <algorithm>
 #include <DirectXTK12/ResourceUploadBatch.h>
 
@@ -133,7 +134,8 @@ Graphics::~Graphics()
 
 bool Graphics::Init()
 {
-	_rs = dynamic_cast<RenderState*>(engine->GetChipManager()->CreateChip(RENDERSTATE_GUID));
+	_rs = dynamic_cast<RenderState*>(engine->GetChipManager()->CreateChip(GetRenderStateType()));
+	_renderSettings = dynamic_cast<RenderSettings*>(_rs);
 
 	HRESULT hr = CreateDXGIObjects();
 	return SUCCEEDED(hr);
@@ -147,6 +149,11 @@ void Graphics::OnNewFrame()
 	DumpMessages();
 }
 
+const Guid &Graphics::GetRenderStateType() const
+{
+	return RENDERSTATE_GUID;
+}
+
 DebugGeometry* Graphics::dg()
 {
 	return dynamic_cast<DebugGeometry*>(engine->GetChipManager()->GetGlobalChip(DEBUGGEOMETRY_GUID));
@@ -161,7 +168,7 @@ void Graphics::ClearState()
 }
 
 RenderWindowManager* Graphics::GetRenderWindowManager() { return _windowManager; }
-RenderWindow* Graphics::CreateRenderWindow(Window* wnd) { return GetRenderWindowManager()->CreateRenderWindow(wnd); }
+RenderWindow* Graphics::CreateRenderWindow(Window* wnd) { RenderWindowManager* rwm = GetRenderWindowManager(); return rwm ? rwm->CreateRenderWindow(wnd) : nullptr; }
 
 
 void Graphics::DumpMessages()
@@ -408,7 +415,7 @@ void Graphics::DestroyDevice()
 
 void Graphics::PostFrame()
 {
-	if (!_device)
+	if (!_device || !GetRenderWindowManager())
 		return;
 
 	D3D12RenderWindow* rw = dynamic_cast<D3D12RenderWindow*>(GetRenderWindowManager()->GetRenderWindow());
@@ -458,6 +465,11 @@ void Graphics::Flush()
 	_prepareFrame();
 }
 
+uint32 Graphics::CompileProjectShaders(bool dirtyOnly)
+{
+	return Shader::CompileProjectShaders(dirtyOnly);
+}
+
 void Graphics::Sync()
 {
 	if (!_device)
@@ -43,6 +43,7 @@ namespace m3d
 {
 
 static const Guid GRAPHICS_GUID = { 0x13278213, 0x8360, 0x4a1b, { 0xa8, 0x5d, 0xc7, 0x8c, 0x42, 0xb3, 0xed, 0x94 } };
+static const Guid NULLGRAPHICS_GUID = { 0x5e0c3a4f, 0x2d8b, 0x4c61, { 0x9f, 0x37, 0x1a, 0xe4, 0x6b, 0x90, 0xc2, 0x58 } };
 
 class RenderWindow;
 class Window;
@@ -144,7 +145,12 @@ public:
 	// Create a new text writer. FRee using mmdelete.
 //	virtual TextWriter *CreateTextWriter(bool tech2 = false);
 
-	RenderSettings* rs() { return (RenderSettings*)_rs; }
+	// The Direct3D 12 render settings. nullptr for the null backend, or before Init().
+	RenderSettings* rs() { return _renderSettings; }
+	// The render state of the backend. Use this for the matrices and draw calls that work without a device.
+	RenderState* GetRenderState() { return _rs; }
+	// False for the null backend. Chips that only render should return early instead of throwing.
+	bool CanRender() const { return _renderSettings != nullptr; }
 
 	// The common command queue.
 	virtual ID3D12CommandQueue* GetCommandQueue() { return _commandQueue; }
@@ -165,11 +171,18 @@ public:
 	// Wait for gpu to catch up with current frame.
 	virtual void Sync();
 
+	// Compiles the shaders of all loaded classes, see Shader::CompileProjectShaders(). Virtual so that the editor,
+	// which does not link this packet, can reach it through engine->GetGraphics(). Returns the number compiled.
+	virtual uint32 CompileProjectShaders(bool dirtyOnly = true);
+
 	virtual UINT64 GetCurrentFrameIndex() const { return _commandListBufferHead; }
 	virtual UINT64 GetLastCompletedFrameIndex() const;
 
 	ResourceUploadBatch* GetResourceUploadBatch() { return _rub; }
 
+protected:
+	// Type of the RenderState chip created by Init().
+	virtual const Guid &GetRenderStateType() const;
 
 
 private:
@@ -181,6 +194,8 @@ private:
 	
 	// Render settings.
 	RenderState* _rs = nullptr;
+	// _rs when it is the Direct3D 12 RenderSettings.
+	RenderSettings* _renderSettings = nullptr;
 
 	// The Global DXGI Factory
 	SIDXGIFactory4 _dxgiFactory;
@@ -267,19 +282,24 @@ public:
 	virtual ~GraphicsUsage();
 
 	inline Graphics* graphics() const { return _graphics; }
-	inline ID3D12Device* device() const { return _graphics->GetDevice(); }
-	inline RenderSettings* rs() const { return _graphics->rs(); }
-	inline DebugGeometry* dg() const { return _graphics->dg(); }
-	inline PipelineStatePool* GetPipelineStatePool() const { return _graphics->GetPipelineStatePool(); }
-	inline RingBuffer* GetUploadHeap() const { return _graphics->GetUploadHeap(); }
-	inline DescriptorHeapManager* GetHeapManager() const { return _graphics->GetHeapManager(); }
-	inline DescriptorHeapManager* GetRTVHeapManager() const { return _graphics->GetRTVHeapManager(); }
-	inline DescriptorHeapManager* GetDSVHeapManager() const { return _graphics->GetDSVHeapManager(); }
-	inline DescriptorHeapManager* GetSamplerHeapManager() const { return _graphics->GetSamplerHeapManager(); }
+	inline ID3D12Device* device() const { return _g()->GetDevice(); }
+	inline RenderSettings* rs() const { RenderSettings* r = _g()->rs(); if (!r) throw GraphicsException(MTEXT("No render settings!"), FATAL); return r; }
+	inline DebugGeometry* dg() const { return _g()->dg(); }
+	inline PipelineStatePool* GetPipelineStatePool() const { return _g()->GetPipelineStatePool(); }
+	inline RingBuffer* GetUploadHeap() const { return _g()->GetUploadHeap(); }
+	inline DescriptorHeapManager* GetHeapManager() const { return _g()->GetHeapManager(); }
+	inline DescriptorHeapManager* GetRTVHeapManager() const { return _g()->GetRTVHeapManager(); }
+	inline DescriptorHeapManager* GetDSVHeapManager() const { return _g()->GetDSVHeapManager(); }
+	inline DescriptorHeapManager* GetSamplerHeapManager() const { return _g()->GetSamplerHeapManager(); }
+	// False with the null graphics backend. See Graphics::CanRender().
+	inline bool CanRender() const { return _graphics && _graphics->CanRender(); }
 
 private:
 	Graphics* _graphics;
 
+	// There is no graphics engine before the engine is initialized.
+	inline Graphics* _g() const { if (!_graphics) throw GraphicsException(MTEXT("No graphics engine!"), FATAL); return _graphics; }
+
 };
 
 
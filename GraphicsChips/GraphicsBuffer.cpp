@@ -99,6 +99,9 @@ void GraphicsBuffer::SetGPUOnly(bool gpuOnly)
 
 void GraphicsBuffer::CallChip()
 {
+	if (!CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	// Note: We do not do any checking of refresh status here!
 
 	try {
@@ -56,6 +56,8 @@ public:
 
 	void UpdateChip(BufferLayoutID layoutID = InvalidBufferLayoutID) override;
 
+	uint64 GetSubsystemMemoryUsage(MemorySubsystem subsystem) const override { return subsystem == MemorySubsystem::GEOMETRY && _res ? _currentSize : 0; }
+
 protected:
 	UINT64 _currentSize = 0;
 
@@ -271,6 +271,9 @@ void GraphicsCommand::SetCommand(OperatorType cmd)
 
 void GraphicsCommand::CallChip()
 {
+	if (!CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	D3D_DEBUG_REPORTER_BLOCK
 
 		ChipExceptionScope ces(this);
@@ -524,7 +527,8 @@ void GraphicsCommand::CallChip()
 			ChildPtr<Value> ch2 = GetChild(2);
 			if (ch2) // vSync?
 				vSync = ch2->GetValueAsBool();
-			graphics()->GetRenderWindowManager()->GoFullscreen(width, height, refreshRate.Numerator, refreshRate.Denominator, outputIndex, 1, 0, false, vSync);
+			if (RenderWindowManager* rwm = graphics()->GetRenderWindowManager())
+				rwm->GoFullscreen(width, height, refreshRate.Numerator, refreshRate.Denominator, outputIndex, 1, 0, false, vSync);
 		}
 		break;
 		case OperatorType::WINDOWED:
@@ -543,7 +547,8 @@ void GraphicsCommand::CallChip()
 			ChildPtr<Value> ch1 = GetChild(1);
 			if (ch1) // vSync?
 				vSync = ch1->GetValueAsBool();
-			graphics()->GetRenderWindowManager()->GoWindowed(left, top, width, height, 1, 0, false, vSync);
+			if (RenderWindowManager* rwm = graphics()->GetRenderWindowManager())
+				rwm->GoWindowed(left, top, width, height, 1, 0, false, vSync);
 		}
 		break;
 		case OperatorType::UNBIND_RTV:
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <limits>
+#include "M3DCore/MTypes.h"
 
 namespace m3d
 {
@@ -245,8 +247,8 @@ namespace m3d
 
 	struct M3D_SAMPLE_DESC
 	{
-		UINT Count;
-		UINT Quality;
+		uint32 Count;
+		uint32 Quality;
 	};
 
 
@@ -353,12 +355,12 @@ namespace m3d
 		M3D_TEXTURE_ADDRESS_MODE AddressU = M3D_TEXTURE_ADDRESS_MODE_WRAP;
 		M3D_TEXTURE_ADDRESS_MODE AddressV = M3D_TEXTURE_ADDRESS_MODE_WRAP;
 		M3D_TEXTURE_ADDRESS_MODE AddressW = M3D_TEXTURE_ADDRESS_MODE_WRAP;
-		FLOAT MipLODBias = 0;
-		UINT MaxAnisotropy = 16;
+		float32 MipLODBias = 0;
+		uint32 MaxAnisotropy = 16;
 		M3D_COMPARISON_FUNC ComparisonFunc = M3D_COMPARISON_FUNC_LESS_EQUAL;
-		FLOAT BorderColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f};
-		FLOAT MinLOD = -std::numeric_limits<float32>::max();
-		FLOAT MaxLOD = std::numeric_limits<float32>::max();
+		float32 BorderColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f};
+		float32 MinLOD = -std::numeric_limits<float32>::max();
+		float32 MaxLOD = std::numeric_limits<float32>::max();
 	};
 
 
@@ -368,14 +370,14 @@ namespace m3d
 		M3D_TEXTURE_ADDRESS_MODE AddressU;
 		M3D_TEXTURE_ADDRESS_MODE AddressV;
 		M3D_TEXTURE_ADDRESS_MODE AddressW;
-		FLOAT MipLODBias;
-		UINT MaxAnisotropy;
+		float32 MipLODBias;
+		uint32 MaxAnisotropy;
 		M3D_COMPARISON_FUNC ComparisonFunc;
 		M3D_STATIC_BORDER_COLOR BorderColor;
-		FLOAT MinLOD;
-		FLOAT MaxLOD;
-		UINT ShaderRegister;
-		UINT RegisterSpace;
+		float32 MinLOD;
+		float32 MaxLOD;
+		uint32 ShaderRegister;
+		uint32 RegisterSpace;
 		M3D_SHADER_VISIBILITY ShaderVisibility;
 	};
 
@@ -26,7 +26,7 @@
 #include "M3DEngine/DocumentSaveLoadUtil.h"
 #include "M3DEngine/Engine.h"
 #include "Graphics.h"
-#include "RenderSettings.h"
+#include "RenderState.h"
 
 using namespace m3d;
 
@@ -60,7 +60,9 @@ bool GraphicsMatrix::SaveChip(DocumentSaver &saver) const
 
 const XMFLOAT4X4 &GraphicsMatrix::GetMatrix()
 {
-	RenderSettings *rs = engine->GetGraphics()->rs();
+	RenderState *rs = engine->GetGraphics()->GetRenderState();
+	if (!rs)
+		return _matrix = IDENTITY; // Graphics not initialized.
 
 	switch (_ot) 
 	{
@@ -134,6 +134,9 @@ void GraphicsState::SetStateElements(const StateElementMap& elements)
 
 void GraphicsState::CallChip()
 {
+	if (!CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	try
 	{
 		UpdateChip(); // throws!
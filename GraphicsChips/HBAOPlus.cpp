@@ -160,6 +160,9 @@ String _GFSDK_SSAO_StatusToString(GFSDK_SSAO_Status status)
 
 void HBAOPlusChip::CallChip()
 {
+	if (!CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	try {
 		if (!_hbao) {
 			GFSDK_SSAO_DescriptorHeaps_D3D12 heaps;
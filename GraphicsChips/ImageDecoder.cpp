@@ -0,0 +1,1118 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "ImageDecoder.h"
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+using namespace m3d;
+using namespace m3d::imagedecoder;
+
+
+void DecodedImage::InitRGBA8(uint32 w, uint32 h)
+{
+	dimension = 2;
+	width = w;
+	height = h;
+	depth = 1;
+	arraySize = 1;
+	mipLevels = 1;
+	format = M3D_FORMAT_R8G8B8A8_UNORM;
+	cubeMap = false;
+	subresources.clear();
+	subresources.push_back({ 0, w * 4, w * h * 4, w, h, 1 });
+	data.resize(size_t(w) * h * 4);
+}
+
+
+namespace
+{
+
+// Images larger than this are left to the platform decoders.
+const uint32 MAX_DIMENSION = 16384;
+
+inline uint16 _le16(const uint8 *p) { return uint16(p[0] | (p[1] << 8)); }
+inline uint32 _le32(const uint8 *p) { return uint32(p[0]) | (uint32(p[1]) << 8) | (uint32(p[2]) << 16) | (uint32(p[3]) << 24); }
+inline uint32 _be32(const uint8 *p) { return (uint32(p[0]) << 24) | (uint32(p[1]) << 16) | (uint32(p[2]) << 8) | uint32(p[3]); }
+inline uint32 _fourCC(char a, char b, char c, char d) { return uint32(uint8(a)) | (uint32(uint8(b)) << 8) | (uint32(uint8(c)) << 16) | (uint32(uint8(d)) << 24); }
+
+
+// ------------------------------------------------------------------------------------------------
+// Inflate (RFC 1951)
+
+// Reads bits LSB first. Reading past the end gives zeros, and is detected by Overrun().
+struct BitReader
+{
+	const uint8 *data;
+	size_t size;
+	size_t pos = 0;
+	uint64 buf = 0;
+	uint32 count = 0;
+	size_t padding = 0;
+
+	BitReader(const uint8 *data, size_t size) : data(data), size(size) {}
+
+	void Fill()
+	{
+		while (count <= 56) {
+			uint64 b = 0;
+			if (pos < size)
+				b = data[pos++];
+			else
+				padding++;
+			buf |= b << count;
+			count += 8;
+		}
+	}
+	uint32 Peek(uint32 n) { if (count < n) Fill(); return uint32(buf & ((1ull << n) - 1)); }
+	void Consume(uint32 n) { buf >>= n; count -= n; }
+	uint32 Bits(uint32 n) { if (n == 0) return 0; uint32 v = Peek(n); Consume(n); return v; }
+	void AlignToByte() { Consume(count % 8); }
+	bool Overrun() const { return (pos + padding) * 8 - count > size * 8; }
+};
+
+const uint32 FAST_BITS = 9;
+
+// Canonical Huffman code with a lookup table for short codes.
+struct Huffman
+{
+	uint16 counts[16];
+	uint16 symbols[288];
+	uint16 fast[1 << FAST_BITS]; // (symbol << 4) | length. 0 if the code is longer than FAST_BITS.
+
+	bool Build(const uint8 *lengths, uint32 n)
+	{
+		std::memset(counts, 0, sizeof(counts));
+		for (uint32 i = 0; i < n; i++)
+			counts[lengths[i]]++;
+		counts[0] = 0;
+
+		int32 left = 1;
+		for (uint32 len = 1; len < 16; len++) {
+			left <<= 1;
+			left -= counts[len];
+			if (left < 0)
+				return false; // Over-subscribed.
+		}
+
+		uint16 offs[16];
+		offs[1] = 0;
+		for (uint32 len = 1; len < 15; len++)
+			offs[len + 1] = offs[len] + counts[len];
+		for (uint32 i = 0; i < n; i++)
+			if (lengths[i])
+				symbols[offs[lengths[i]]++] = uint16(i);
+
+		uint32 next[16];
+		uint32 code = 0;
+		next[0] = 0;
+		for (uint32 len = 1; len < 16; len++) {
+			code = (code + counts[len - 1]) << 1;
+			next[len] = code;
+		}
+
+		std::memset(fast, 0, sizeof(fast));
+		for (uint32 i = 0; i < n; i++) {
+			uint32 len = lengths[i];
+			if (len == 0)
+				continue;
+			uint32 c = next[len]++;
+			if (len > FAST_BITS)
+				continue;
+			uint32 r = 0; // Codes are stored MSB first, but read LSB first.
+			for (uint32 j = 0; j < len; j++)
+				r |= ((c >> j) & 1) << (len - 1 - j);
+			for (uint32 k = r; k < (1u << FAST_BITS); k += 1u << len)
+				fast[k] = uint16((i << 4) | len);
+		}
+		return true;
+	}
+
+	int32 Decode(BitReader &br) const
+	{
+		uint32 b = br.Peek(15);
+		uint32 e = fast[b & ((1u << FAST_BITS) - 1)];
+		if (e) {
+			br.Consume(e & 15);
+			return int32(e >> 4);
+		}
+		int32 code = 0, first = 0, index = 0;
+		for (uint32 len = 1; len < 16; len++) {
+			code |= (b >> (len - 1)) & 1;
+			int32 count = counts[len];
+			if (code - count < first) {
+				br.Consume(len);
+				return symbols[index + (code - first)];
+			}
+			index += count;
+			first += count;
+			first <<= 1;
+			code <<= 1;
+		}
+		return -1;
+	}
+};
+
+const uint16 LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+const uint8 LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+const uint16 DIST_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+const uint8 DIST_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+bool _inflateBlock(BitReader &br, const Huffman &lit, const Huffman &dist, uint8 *out, size_t outSize, size_t &o)
+{
+	for (;;) {
+		int32 sym = lit.Decode(br);
+		if (sym < 0)
+			return false;
+		if (sym < 256) {
+			if (o >= outSize)
+				return false;
+			out[o++] = uint8(sym);
+		}
+		else if (sym == 256)
+			return true;
+		else {
+			sym -= 257;
+			if (sym >= 29)
+				return false;
+			uint32 len = LENGTH_BASE[sym] + br.Bits(LENGTH_EXTRA[sym]);
+			int32 ds = dist.Decode(br);
+			if (ds < 0 || ds >= 30)
+				return false;
+			uint32 d = DIST_BASE[ds] + br.Bits(DIST_EXTRA[ds]);
+			if (d > o || len > outSize - o)
+				return false;
+			const uint8 *src = out + o - d;
+			uint8 *dst = out + o;
+			if (d >= len)
+				std::memcpy(dst, src, len);
+			else
+				for (uint32 i = 0; i < len; i++) // Overlapping copy.
+					dst[i] = src[i];
+			o += len;
+		}
+		if (br.Overrun())
+			return false;
+	}
+}
+
+bool _inflateDynamicTables(BitReader &br, Huffman &lit, Huffman &dist)
+{
+	static const uint8 ORDER[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	uint32 nlen = br.Bits(5) + 257;
+	uint32 ndist = br.Bits(5) + 1;
+	uint32 ncode = br.Bits(4) + 4;
+	if (nlen > 286 || ndist > 30)
+		return false;
+
+	uint8 lengths[286 + 30] = {};
+	for (uint32 i = 0; i < ncode; i++)
+		lengths[ORDER[i]] = uint8(br.Bits(3));
+
+	Huffman lencode;
+	if (!lencode.Build(lengths, 19))
+		return false;
+
+	uint32 i = 0;
+	while (i < nlen + ndist) {
+		int32 sym = lencode.Decode(br);
+		if (sym < 0)
+			return false;
+		if (sym < 16) {
+			lengths[i++] = uint8(sym);
+			continue;
+		}
+		uint8 len = 0;
+		uint32 repeat;
+		if (sym == 16) {
+			if (i == 0)
+				return false;
+			len = lengths[i - 1];
+			repeat = 3 + br.Bits(2);
+		}
+		else if (sym == 17)
+			repeat = 3 + br.Bits(3);
+		else
+			repeat = 11 + br.Bits(7);
+		if (i + repeat > nlen + ndist)
+			return false;
+		while (repeat--)
+			lengths[i++] = len;
+	}
+
+	if (lengths[256] == 0)
+		return false; // No end of block code!
+
+	return lit.Build(lengths, nlen) && dist.Build(lengths + nlen, ndist) && !br.Overrun();
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Pixel helpers
+
+// Extracts a channel using a bit mask and scales it to 8 bits. Missing channels get the default value.
+struct MaskChannel
+{
+	uint32 mask = 0;
+	uint32 shift = 0;
+	uint32 max = 0;
+
+	MaskChannel(uint32 m = 0) : mask(m)
+	{
+		if (!mask)
+			return;
+		while (((mask >> shift) & 1) == 0)
+			shift++;
+		max = mask >> shift;
+	}
+	uint8 Get(uint32 px, uint8 def) const { return max ? uint8((((px & mask) >> shift) * 255 + max / 2) / max) : def; }
+};
+
+inline uint8 _expand5(uint32 v) { return uint8((v << 3) | (v >> 2)); }
+
+}
+
+
+// ------------------------------------------------------------------------------------------------
+
+bool m3d::imagedecoder::Inflate(const uint8 *data, size_t size, uint8 *out, size_t outSize)
+{
+	if (size < 2)
+		return false;
+	if ((data[0] & 0x0F) != 8 || ((uint32(data[0]) << 8) | data[1]) % 31 != 0 || (data[1] & 0x20))
+		return false; // Not deflate, bad header check or preset dictionary.
+
+	BitReader br(data + 2, size - 2);
+	size_t o = 0;
+
+	static Huffman fixedLit, fixedDist;
+	static const bool fixedInit = [] {
+		uint8 l[288];
+		std::fill(l, l + 144, uint8(8));
+		std::fill(l + 144, l + 256, uint8(9));
+		std::fill(l + 256, l + 280, uint8(7));
+		std::fill(l + 280, l + 288, uint8(8));
+		fixedLit.Build(l, 288);
+		std::fill(l, l + 30, uint8(5));
+		fixedDist.Build(l, 30);
+		return true;
+	}();
+	(void)fixedInit;
+
+	uint32 last;
+	do {
+		last = br.Bits(1);
+		uint32 type = br.Bits(2);
+		if (type == 0) { // Stored
+			br.AlignToByte();
+			uint32 len = br.Bits(16);
+			uint32 nlen = br.Bits(16);
+			if ((len ^ 0xFFFF) != nlen || len > outSize - o)
+				return false;
+			for (uint32 i = 0; i < len; i++)
+				out[o++] = uint8(br.Bits(8));
+			if (br.Overrun())
+				return false;
+		}
+		else if (type == 1) { // Fixed Huffman
+			if (!_inflateBlock(br, fixedLit, fixedDist, out, outSize, o))
+				return false;
+		}
+		else if (type == 2) { // Dynamic Huffman
+			Huffman lit, dist;
+			if (!_inflateDynamicTables(br, lit, dist) || !_inflateBlock(br, lit, dist, out, outSize, o))
+				return false;
+		}
+		else
+			return false;
+	} while (!last);
+
+	return o == outSize;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// PNG
+
+bool m3d::imagedecoder::DecodePNG(const uint8 *data, size_t size, DecodedImage &img)
+{
+	static const uint8 SIGNATURE[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	if (size < 8 || std::memcmp(data, SIGNATURE, 8) != 0)
+		return false;
+
+	uint32 width = 0, height = 0, bitDepth = 0, colorType = 0;
+	uint8 palette[256][4];
+	uint32 paletteSize = 0;
+	bool hasKey = false;
+	uint16 key[3] = {}; // tRNS for gray/rgb.
+	List<uint8> idat;
+
+	size_t p = 8;
+	bool ended = false;
+	while (!ended && p + 12 <= size) {
+		uint32 len = _be32(data + p);
+		uint32 type = _be32(data + p + 4);
+		const uint8 *c = data + p + 8;
+		if (len > size - p - 12)
+			return false;
+		switch (type)
+		{
+		case 0x49484452: // IHDR
+			if (len < 13)
+				return false;
+			width = _be32(c);
+			height = _be32(c + 4);
+			bitDepth = c[8];
+			colorType = c[9];
+			if (c[10] != 0 || c[11] != 0 || c[12] != 0)
+				return false; // Unknown compression/filter or interlaced.
+			break;
+		case 0x504C5445: // PLTE
+			paletteSize = std::min(len / 3, 256u);
+			for (uint32 i = 0; i < paletteSize; i++) {
+				palette[i][0] = c[i * 3];
+				palette[i][1] = c[i * 3 + 1];
+				palette[i][2] = c[i * 3 + 2];
+				palette[i][3] = 255;
+			}
+			break;
+		case 0x74524E53: // tRNS
+			if (colorType == 3) {
+				for (uint32 i = 0; i < std::min(len, paletteSize); i++)
+					palette[i][3] = c[i];
+			}
+			else if (colorType == 0 && len >= 2) {
+				hasKey = true;
+				key[0] = uint16((c[0] << 8) | c[1]);
+			}
+			else if (colorType == 2 && len >= 6) {
+				hasKey = true;
+				for (uint32 i = 0; i < 3; i++)
+					key[i] = uint16((c[i * 2] << 8) | c[i * 2 + 1]);
+			}
+			break;
+		case 0x49444154: // IDAT
+			idat.insert(idat.end(), c, c + len);
+			break;
+		case 0x49454E44: // IEND
+			ended = true;
+			break;
+		}
+		p += size_t(len) + 12;
+	}
+
+	if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION || idat.empty())
+		return false;
+
+	uint32 channels;
+	switch (colorType)
+	{
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 3: channels = 1; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+	if (bitDepth != 1 && bitDepth != 2 && bitDepth != 4 && bitDepth != 8 && bitDepth != 16)
+		return false;
+	if (colorType == 3 && (bitDepth > 8 || paletteSize == 0))
+		return false;
+	if ((colorType == 2 || colorType == 4 || colorType == 6) && bitDepth < 8)
+		return false;
+
+	const uint32 bitsPerPixel = channels * bitDepth;
+	const size_t rowBytes = (size_t(width) * bitsPerPixel + 7) / 8;
+	const uint32 filterBpp = std::max(1u, bitsPerPixel / 8);
+
+	List<uint8> raw(height * (rowBytes + 1));
+	if (!Inflate(idat.data(), idat.size(), raw.data(), raw.size()))
+		return false;
+	idat = List<uint8>();
+
+	// Reverse the filters in place. Each row starts with its filter type.
+	for (uint32 y = 0; y < height; y++) {
+		uint8 *row = raw.data() + y * (rowBytes + 1);
+		uint8 filter = row[0];
+		uint8 *cur = row + 1;
+		const uint8 *prev = y > 0 ? raw.data() + (y - 1) * (rowBytes + 1) + 1 : nullptr;
+		switch (filter)
+		{
+		case 0:
+			break;
+		case 1:
+			for (size_t i = filterBpp; i < rowBytes; i++)
+				cur[i] += cur[i - filterBpp];
+			break;
+		case 2:
+			if (prev)
+				for (size_t i = 0; i < rowBytes; i++)
+					cur[i] += prev[i];
+			break;
+		case 3:
+			for (size_t i = 0; i < rowBytes; i++) {
+				uint32 a = i >= filterBpp ? cur[i - filterBpp] : 0;
+				uint32 b = prev ? prev[i] : 0;
+				cur[i] += uint8((a + b) >> 1);
+			}
+			break;
+		case 4:
+			for (size_t i = 0; i < rowBytes; i++) {
+				int32 a = i >= filterBpp ? cur[i - filterBpp] : 0;
+				int32 b = prev ? prev[i] : 0;
+				int32 c = prev && i >= filterBpp ? prev[i - filterBpp] : 0;
+				int32 pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+				cur[i] += uint8(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+			}
+			break;
+		default:
+			return false;
+		}
+	}
+
+	img.InitRGBA8(width, height);
+
+	for (uint32 y = 0; y < height; y++) {
+		const uint8 *src = raw.data() + y * (rowBytes + 1) + 1;
+		uint8 *dst = img.data.data() + size_t(y) * width * 4;
+		for (uint32 x = 0; x < width; x++, dst += 4) {
+			if (bitDepth < 8) {
+				uint32 bit = x * bitDepth;
+				uint32 v = (src[bit >> 3] >> (8 - bitDepth - (bit & 7))) & ((1u << bitDepth) - 1);
+				if (colorType == 3) {
+					if (v >= paletteSize)
+						v = 0;
+					std::memcpy(dst, palette[v], 4);
+				}
+				else {
+					uint8 g = uint8(v * (255 / ((1u << bitDepth) - 1)));
+					dst[0] = dst[1] = dst[2] = g;
+					dst[3] = hasKey && v == key[0] ? 0 : 255;
+				}
+				continue;
+			}
+
+			const uint32 bpc = bitDepth / 8; // Bytes per channel. We keep the most significant byte of 16 bit samples.
+			const uint8 *s = src + size_t(x) * channels * bpc;
+			auto sample = [s, bpc](uint32 i) -> uint16 { return bpc == 2 ? uint16((s[i * 2] << 8) | s[i * 2 + 1]) : s[i]; };
+			switch (colorType)
+			{
+			case 0:
+				dst[0] = dst[1] = dst[2] = s[0];
+				dst[3] = hasKey && sample(0) == key[0] ? 0 : 255;
+				break;
+			case 2:
+				dst[0] = s[0];
+				dst[1] = s[bpc];
+				dst[2] = s[bpc * 2];
+				dst[3] = hasKey && sample(0) == key[0] && sample(1) == key[1] && sample(2) == key[2] ? 0 : 255;
+				break;
+			case 3:
+				std::memcpy(dst, palette[s[0] < paletteSize ? s[0] : 0], 4);
+				break;
+			case 4:
+				dst[0] = dst[1] = dst[2] = s[0];
+				dst[3] = s[bpc];
+				break;
+			case 6:
+				dst[0] = s[0];
+				dst[1] = s[bpc];
+				dst[2] = s[bpc * 2];
+				dst[3] = s[bpc * 3];
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TGA
+
+bool m3d::imagedecoder::DecodeTGA(const uint8 *data, size_t size, DecodedImage &img)
+{
+	if (size < 18)
+		return false;
+
+	uint32 idLength = data[0];
+	uint32 colorMapType = data[1];
+	uint32 imageType = data[2];
+	uint32 cmFirst = _le16(data + 3);
+	uint32 cmLength = _le16(data + 5);
+	uint32 cmDepth = data[7];
+	uint32 width = _le16(data + 12);
+	uint32 height = _le16(data + 14);
+	uint32 pixelDepth = data[16];
+	uint32 descriptor = data[17];
+
+	bool rle = imageType >= 9;
+	uint32 baseType = rle ? imageType - 8 : imageType;
+	if (baseType < 1 || baseType > 3 || width == 0 || height == 0)
+		return false;
+	if (baseType == 1 && (colorMapType != 1 || (pixelDepth != 8 && pixelDepth != 16)))
+		return false;
+	if (baseType == 2 && pixelDepth != 15 && pixelDepth != 16 && pixelDepth != 24 && pixelDepth != 32)
+		return false;
+	if (baseType == 3 && pixelDepth != 8 && pixelDepth != 16)
+		return false;
+
+	const bool hasAlpha = (descriptor & 0x0F) != 0;
+	const uint32 bytesPerPixel = (pixelDepth + 7) / 8;
+
+	// Converts a stored color of given depth to RGBA.
+	auto toRGBA = [hasAlpha](const uint8 *s, uint32 depth, bool gray, uint8 *d) {
+		if (gray) {
+			d[0] = d[1] = d[2] = s[0];
+			d[3] = depth == 16 ? s[1] : 255;
+		}
+		else if (depth == 15 || depth == 16) {
+			uint32 v = _le16(s);
+			d[0] = _expand5((v >> 10) & 0x1F);
+			d[1] = _expand5((v >> 5) & 0x1F);
+			d[2] = _expand5(v & 0x1F);
+			d[3] = depth == 16 && hasAlpha ? ((v & 0x8000) ? 255 : 0) : 255;
+		}
+		else {
+			d[0] = s[2];
+			d[1] = s[1];
+			d[2] = s[0];
+			d[3] = depth == 32 && hasAlpha ? s[3] : 255;
+		}
+	};
+
+	size_t p = 18 + idLength;
+
+	List<uint8> colorMap;
+	if (colorMapType == 1) {
+		uint32 cmBytes = (cmDepth + 7) / 8;
+		if (cmDepth != 15 && cmDepth != 16 && cmDepth != 24 && cmDepth != 32)
+			return false;
+		if (p + size_t(cmLength) * cmBytes > size)
+			return false;
+		colorMap.resize(size_t(cmLength) * 4);
+		for (uint32 i = 0; i < cmLength; i++)
+			toRGBA(data + p + size_t(i) * cmBytes, cmDepth, false, &colorMap[size_t(i) * 4]);
+		p += size_t(cmLength) * cmBytes;
+	}
+
+	img.InitRGBA8(width, height);
+
+	auto writePixel = [&](const uint8 *s, uint8 *d) -> bool {
+		if (baseType == 1) {
+			uint32 index = (pixelDepth == 8 ? s[0] : _le16(s));
+			if (index < cmFirst || index - cmFirst >= cmLength)
+				return false;
+			std::memcpy(d, &colorMap[size_t(index - cmFirst) * 4], 4);
+		}
+		else
+			toRGBA(s, pixelDepth, baseType == 3, d);
+		return true;
+	};
+
+	// Decode in stored order. The pixel order is fixed afterwards.
+	const size_t pixelCount = size_t(width) * height;
+	uint8 *dst = img.data.data();
+	size_t n = 0;
+	while (n < pixelCount) {
+		if (rle) {
+			if (p >= size)
+				return false;
+			uint8 h = data[p++];
+			uint32 count = (h & 0x7F) + 1;
+			if (n + count > pixelCount)
+				return false;
+			if (h & 0x80) {
+				if (p + bytesPerPixel > size)
+					return false;
+				uint8 px[4];
+				if (!writePixel(data + p, px))
+					return false;
+				for (uint32 i = 0; i < count; i++, n++)
+					std::memcpy(dst + n * 4, px, 4);
+				p += bytesPerPixel;
+			}
+			else {
+				if (p + size_t(count) * bytesPerPixel > size)
+					return false;
+				for (uint32 i = 0; i < count; i++, n++, p += bytesPerPixel)
+					if (!writePixel(data + p, dst + n * 4))
+						return false;
+			}
+		}
+		else {
+			if (p + pixelCount * bytesPerPixel > size)
+				return false;
+			for (; n < pixelCount; n++, p += bytesPerPixel)
+				if (!writePixel(data + p, dst + n * 4))
+					return false;
+		}
+	}
+
+	const size_t rowBytes = size_t(width) * 4;
+	if ((descriptor & 0x20) == 0) { // Bottom-up.
+		List<uint8> tmp(rowBytes);
+		for (uint32 y = 0; y < height / 2; y++) {
+			uint8 *a = dst + y * rowBytes, *b = dst + (height - 1 - y) * rowBytes;
+			std::memcpy(tmp.data(), a, rowBytes);
+			std::memcpy(a, b, rowBytes);
+			std::memcpy(b, tmp.data(), rowBytes);
+		}
+	}
+	if (descriptor & 0x10) { // Right-to-left.
+		for (uint32 y = 0; y < height; y++) {
+			uint32 *row = (uint32*)(dst + y * rowBytes);
+			std::reverse(row, row + width);
+		}
+	}
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// BMP
+
+bool m3d::imagedecoder::DecodeBMP(const uint8 *data, size_t size, DecodedImage &img)
+{
+	if (size < 26 || data[0] != 'B' || data[1] != 'M')
+		return false;
+
+	uint32 offBits = _le32(data + 10);
+	uint32 headerSize = _le32(data + 14);
+	const uint8 *h = data + 14;
+	if (size_t(14) + headerSize > size)
+		return false;
+
+	int32 width, height;
+	uint32 bpp, compression = 0, clrUsed = 0;
+	uint32 paletteEntrySize = 4;
+	if (headerSize == 12) { // BITMAPCOREHEADER
+		width = _le16(h + 4);
+		height = int16(_le16(h + 6));
+		bpp = _le16(h + 10);
+		paletteEntrySize = 3;
+	}
+	else if (headerSize >= 40) {
+		width = int32(_le32(h + 4));
+		height = int32(_le32(h + 8));
+		bpp = _le16(h + 14);
+		compression = _le32(h + 16);
+		clrUsed = _le32(h + 32);
+	}
+	else
+		return false;
+
+	bool topDown = height < 0;
+	if (height < 0)
+		height = -height;
+	if (width <= 0 || height <= 0 || uint32(width) > MAX_DIMENSION || uint32(height) > MAX_DIMENSION)
+		return false;
+	if (compression != 0 && compression != 3 && compression != 6)
+		return false; // RLE, JPEG and PNG compression are left to the platform decoder.
+
+	size_t afterHeader = 14 + headerSize;
+
+	uint32 rMask = 0, gMask = 0, bMask = 0, aMask = 0;
+	if (bpp == 16) {
+		rMask = 0x7C00; gMask = 0x03E0; bMask = 0x001F;
+	}
+	else if (bpp == 32) {
+		rMask = 0x00FF0000; gMask = 0x0000FF00; bMask = 0x000000FF;
+	}
+	if (compression == 3 || compression == 6) {
+		if (bpp != 16 && bpp != 32)
+			return false;
+		const uint8 *m = h + 40; // Masks follow the info header, or are part of the V2-V5 headers.
+		uint32 maskCount = compression == 6 ? 4 : 3;
+		if (headerSize == 40)
+			afterHeader += maskCount * 4;
+		if (size_t(14 + 40 + maskCount * 4) > size)
+			return false;
+		rMask = _le32(m);
+		gMask = _le32(m + 4);
+		bMask = _le32(m + 8);
+		if (maskCount == 4 || headerSize >= 56)
+			aMask = _le32(m + 12);
+	}
+
+	uint8 palette[256][4];
+	if (bpp <= 8) {
+		if (bpp != 1 && bpp != 4 && bpp != 8)
+			return false;
+		uint32 count = clrUsed ? std::min(clrUsed, 256u) : (1u << bpp);
+		if (afterHeader + size_t(count) * paletteEntrySize > size)
+			return false;
+		std::memset(palette, 0, sizeof(palette));
+		for (uint32 i = 0; i < count; i++) {
+			const uint8 *e = data + afterHeader + size_t(i) * paletteEntrySize;
+			palette[i][0] = e[2];
+			palette[i][1] = e[1];
+			palette[i][2] = e[0];
+			palette[i][3] = 255;
+		}
+	}
+	else if (bpp != 16 && bpp != 24 && bpp != 32)
+		return false;
+
+	const size_t stride = ((size_t(width) * bpp + 31) / 32) * 4;
+	if (offBits > size || size_t(offBits) + stride * height > size)
+		return false;
+
+	MaskChannel r(rMask), g(gMask), b(bMask), a(aMask);
+
+	img.InitRGBA8(uint32(width), uint32(height));
+
+	for (int32 y = 0; y < height; y++) {
+		const uint8 *src = data + offBits + stride * (topDown ? y : height - 1 - y);
+		uint8 *dst = img.data.data() + size_t(y) * width * 4;
+		for (int32 x = 0; x < width; x++, dst += 4) {
+			switch (bpp)
+			{
+			case 1:
+			case 4:
+			case 8:
+			{
+				uint32 bit = uint32(x) * bpp;
+				uint32 index = (src[bit >> 3] >> (8 - bpp - (bit & 7))) & ((1u << bpp) - 1);
+				std::memcpy(dst, palette[index], 4);
+				break;
+			}
+			case 16:
+			case 32:
+			{
+				uint32 px = bpp == 16 ? _le16(src + x * 2) : _le32(src + x * 4);
+				dst[0] = r.Get(px, 0);
+				dst[1] = g.Get(px, 0);
+				dst[2] = b.Get(px, 0);
+				dst[3] = a.Get(px, 255);
+				break;
+			}
+			case 24:
+				dst[0] = src[x * 3 + 2];
+				dst[1] = src[x * 3 + 1];
+				dst[2] = src[x * 3];
+				dst[3] = 255;
+				break;
+			}
+		}
+	}
+
+	return true;
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// DDS
+
+uint32 m3d::imagedecoder::GetBitsPerPixel(M3D_FORMAT fmt)
+{
+	switch (fmt)
+	{
+	case M3D_FORMAT_R32G32B32A32_FLOAT:
+	case M3D_FORMAT_R32G32B32A32_UINT:
+	case M3D_FORMAT_R32G32B32A32_SINT:
+		return 128;
+	case M3D_FORMAT_R16G16B16A16_FLOAT:
+	case M3D_FORMAT_R16G16B16A16_UNORM:
+	case M3D_FORMAT_R16G16B16A16_UINT:
+	case M3D_FORMAT_R16G16B16A16_SNORM:
+	case M3D_FORMAT_R16G16B16A16_SINT:
+	case M3D_FORMAT_R32G32_FLOAT:
+	case M3D_FORMAT_R32G32_UINT:
+	case M3D_FORMAT_R32G32_SINT:
+		return 64;
+	case M3D_FORMAT_R10G10B10A2_UNORM:
+	case M3D_FORMAT_R10G10B10A2_UINT:
+	case M3D_FORMAT_R11G11B10_FLOAT:
+	case M3D_FORMAT_R8G8B8A8_UNORM:
+	case M3D_FORMAT_R8G8B8A8_UNORM_SRGB:
+	case M3D_FORMAT_R8G8B8A8_UINT:
+	case M3D_FORMAT_R8G8B8A8_SNORM:
+	case M3D_FORMAT_R8G8B8A8_SINT:
+	case M3D_FORMAT_R16G16_FLOAT:
+	case M3D_FORMAT_R16G16_UNORM:
+	case M3D_FORMAT_R16G16_UINT:
+	case M3D_FORMAT_R16G16_SNORM:
+	case M3D_FORMAT_R16G16_SINT:
+	case M3D_FORMAT_R32_FLOAT:
+	case M3D_FORMAT_R32_UINT:
+	case M3D_FORMAT_R32_SINT:
+	case M3D_FORMAT_R9G9B9E5_SHAREDEXP:
+	case M3D_FORMAT_B8G8R8A8_UNORM:
+	case M3D_FORMAT_B8G8R8X8_UNORM:
+	case M3D_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case M3D_FORMAT_B8G8R8X8_UNORM_SRGB:
+		return 32;
+	case M3D_FORMAT_R8G8_UNORM:
+	case M3D_FORMAT_R8G8_UINT:
+	case M3D_FORMAT_R8G8_SNORM:
+	case M3D_FORMAT_R8G8_SINT:
+	case M3D_FORMAT_R16_FLOAT:
+	case M3D_FORMAT_R16_UNORM:
+	case M3D_FORMAT_R16_UINT:
+	case M3D_FORMAT_R16_SNORM:
+	case M3D_FORMAT_R16_SINT:
+	case M3D_FORMAT_B5G6R5_UNORM:
+	case M3D_FORMAT_B5G5R5A1_UNORM:
+	case M3D_FORMAT_B4G4R4A4_UNORM:
+		return 16;
+	case M3D_FORMAT_R8_UNORM:
+	case M3D_FORMAT_R8_UINT:
+	case M3D_FORMAT_R8_SNORM:
+	case M3D_FORMAT_R8_SINT:
+	case M3D_FORMAT_A8_UNORM:
+		return 8;
+	case M3D_FORMAT_BC1_UNORM:
+	case M3D_FORMAT_BC1_UNORM_SRGB:
+	case M3D_FORMAT_BC4_UNORM:
+	case M3D_FORMAT_BC4_SNORM:
+		return 64; // Per block
+	case M3D_FORMAT_BC2_UNORM:
+	case M3D_FORMAT_BC2_UNORM_SRGB:
+	case M3D_FORMAT_BC3_UNORM:
+	case M3D_FORMAT_BC3_UNORM_SRGB:
+	case M3D_FORMAT_BC5_UNORM:
+	case M3D_FORMAT_BC5_SNORM:
+	case M3D_FORMAT_BC6H_UF16:
+	case M3D_FORMAT_BC6H_SF16:
+	case M3D_FORMAT_BC7_UNORM:
+	case M3D_FORMAT_BC7_UNORM_SRGB:
+		return 128; // Per block
+	default:
+		return 0;
+	}
+}
+
+bool m3d::imagedecoder::IsBlockCompressed(M3D_FORMAT fmt)
+{
+	return (fmt >= M3D_FORMAT_BC1_TYPELESS && fmt <= M3D_FORMAT_BC5_SNORM) || (fmt >= M3D_FORMAT_BC6H_TYPELESS && fmt <= M3D_FORMAT_BC7_UNORM_SRGB);
+}
+
+void m3d::imagedecoder::GetSurfaceInfo(M3D_FORMAT fmt, uint32 width, uint32 height, uint32 &rowPitch, uint32 &rowCount)
+{
+	uint32 bits = GetBitsPerPixel(fmt);
+	if (IsBlockCompressed(fmt)) {
+		rowPitch = std::max(1u, (width + 3) / 4) * (bits / 8);
+		rowCount = std::max(1u, (height + 3) / 4);
+	}
+	else {
+		rowPitch = (width * bits + 7) / 8;
+		rowCount = height;
+	}
+}
+
+M3D_FORMAT m3d::imagedecoder::MakeSRGB(M3D_FORMAT fmt)
+{
+	switch (fmt)
+	{
+	case M3D_FORMAT_R8G8B8A8_UNORM: return M3D_FORMAT_R8G8B8A8_UNORM_SRGB;
+	case M3D_FORMAT_BC1_UNORM: return M3D_FORMAT_BC1_UNORM_SRGB;
+	case M3D_FORMAT_BC2_UNORM: return M3D_FORMAT_BC2_UNORM_SRGB;
+	case M3D_FORMAT_BC3_UNORM: return M3D_FORMAT_BC3_UNORM_SRGB;
+	case M3D_FORMAT_B8G8R8A8_UNORM: return M3D_FORMAT_B8G8R8A8_UNORM_SRGB;
+	case M3D_FORMAT_B8G8R8X8_UNORM: return M3D_FORMAT_B8G8R8X8_UNORM_SRGB;
+	case M3D_FORMAT_BC7_UNORM: return M3D_FORMAT_BC7_UNORM_SRGB;
+	default: return fmt;
+	}
+}
+
+namespace
+{
+
+M3D_FORMAT _getDDSFormat(const uint8 *pf)
+{
+	const uint32 DDPF_ALPHA = 0x2, DDPF_FOURCC = 0x4, DDPF_RGB = 0x40, DDPF_LUMINANCE = 0x20000;
+
+	uint32 flags = _le32(pf + 4);
+	uint32 fourCC = _le32(pf + 8);
+	uint32 bits = _le32(pf + 12);
+	uint32 r = _le32(pf + 16), g = _le32(pf + 20), b = _le32(pf + 24), a = _le32(pf + 28);
+
+	auto is = [=](uint32 rr, uint32 gg, uint32 bb, uint32 aa) { return r == rr && g == gg && b == bb && a == aa; };
+
+	if (flags & DDPF_RGB) {
+		switch (bits)
+		{
+		case 32:
+			if (is(0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000)) return M3D_FORMAT_R8G8B8A8_UNORM;
+			if (is(0x00ff0000, 0x0000ff00, 0x000000ff, 0xff000000)) return M3D_FORMAT_B8G8R8A8_UNORM;
+			if (is(0x00ff0000, 0x0000ff00, 0x000000ff, 0)) return M3D_FORMAT_B8G8R8X8_UNORM;
+			if (is(0x3ff00000, 0x000ffc00, 0x000003ff, 0xc0000000)) return M3D_FORMAT_R10G10B10A2_UNORM; // Stored reversed by many writers.
+			if (is(0x0000ffff, 0xffff0000, 0, 0)) return M3D_FORMAT_R16G16_UNORM;
+			if (is(0xffffffff, 0, 0, 0)) return M3D_FORMAT_R32_FLOAT;
+			break;
+		case 16:
+			if (is(0x7c00, 0x03e0, 0x001f, 0x8000)) return M3D_FORMAT_B5G5R5A1_UNORM;
+			if (is(0xf800, 0x07e0, 0x001f, 0)) return M3D_FORMAT_B5G6R5_UNORM;
+			if (is(0x0f00, 0x00f0, 0x000f, 0xf000)) return M3D_FORMAT_B4G4R4A4_UNORM;
+			break;
+		}
+		return M3D_FORMAT_UNKNOWN;
+	}
+	if (flags & DDPF_LUMINANCE) {
+		if (bits == 8 && r == 0xff) return M3D_FORMAT_R8_UNORM;
+		if (bits == 16 && r == 0xffff) return M3D_FORMAT_R16_UNORM;
+		if (bits == 16 && r == 0x00ff && a == 0xff00) return M3D_FORMAT_R8G8_UNORM;
+		return M3D_FORMAT_UNKNOWN;
+	}
+	if (flags & DDPF_ALPHA)
+		return bits == 8 ? M3D_FORMAT_A8_UNORM : M3D_FORMAT_UNKNOWN;
+	if (flags & DDPF_FOURCC) {
+		if (fourCC == _fourCC('D', 'X', 'T', '1')) return M3D_FORMAT_BC1_UNORM;
+		if (fourCC == _fourCC('D', 'X', 'T', '2') || fourCC == _fourCC('D', 'X', 'T', '3')) return M3D_FORMAT_BC2_UNORM;
+		if (fourCC == _fourCC('D', 'X', 'T', '4') || fourCC == _fourCC('D', 'X', 'T', '5')) return M3D_FORMAT_BC3_UNORM;
+		if (fourCC == _fourCC('A', 'T', 'I', '1') || fourCC == _fourCC('B', 'C', '4', 'U')) return M3D_FORMAT_BC4_UNORM;
+		if (fourCC == _fourCC('B', 'C', '4', 'S')) return M3D_FORMAT_BC4_SNORM;
+		if (fourCC == _fourCC('A', 'T', 'I', '2') || fourCC == _fourCC('B', 'C', '5', 'U')) return M3D_FORMAT_BC5_UNORM;
+		if (fourCC == _fourCC('B', 'C', '5', 'S')) return M3D_FORMAT_BC5_SNORM;
+		switch (fourCC) // D3DFORMAT values stored as fourCC.
+		{
+		case 36: return M3D_FORMAT_R16G16B16A16_UNORM;
+		case 110: return M3D_FORMAT_R16G16B16A16_SNORM;
+		case 111: return M3D_FORMAT_R16_FLOAT;
+		case 112: return M3D_FORMAT_R16G16_FLOAT;
+		case 113: return M3D_FORMAT_R16G16B16A16_FLOAT;
+		case 114: return M3D_FORMAT_R32_FLOAT;
+		case 115: return M3D_FORMAT_R32G32_FLOAT;
+		case 116: return M3D_FORMAT_R32G32B32A32_FLOAT;
+		}
+	}
+	return M3D_FORMAT_UNKNOWN;
+}
+
+}
+
+bool m3d::imagedecoder::DecodeDDS(const uint8 *data, size_t size, DecodedImage &img)
+{
+	const uint32 DDSD_MIPMAPCOUNT = 0x20000, DDSD_DEPTH = 0x800000;
+	const uint32 DDSCAPS2_CUBEMAP = 0x200, DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00, DDSCAPS2_VOLUME = 0x200000;
+
+	if (size < 128 || _le32(data) != _fourCC('D', 'D', 'S', ' ') || _le32(data + 4) != 124)
+		return false;
+
+	const uint8 *h = data + 4;
+	uint32 flags = _le32(h + 4);
+	uint32 height = _le32(h + 8);
+	uint32 width = _le32(h + 12);
+	uint32 depth = _le32(h + 20);
+	uint32 mipCount = (flags & DDSD_MIPMAPCOUNT) ? std::max(1u, _le32(h + 24)) : 1;
+	const uint8 *pf = h + 72;
+	uint32 caps2 = _le32(h + 108);
+
+	size_t offset = 128;
+	uint32 dimension = 2, arraySize = 1;
+	bool cubeMap = false;
+	M3D_FORMAT format;
+
+	if ((_le32(pf + 4) & 0x4) && _le32(pf + 8) == _fourCC('D', 'X', '1', '0')) {
+		if (size < 148)
+			return false;
+		const uint8 *d10 = data + 128;
+		format = (M3D_FORMAT)_le32(d10);
+		uint32 resDim = _le32(d10 + 4);
+		uint32 miscFlag = _le32(d10 + 8);
+		arraySize = _le32(d10 + 12);
+		offset = 148;
+		if (arraySize == 0)
+			return false;
+		switch (resDim)
+		{
+		case 2: dimension = 1; height = depth = 1; break;
+		case 3:
+			dimension = 2;
+			depth = 1;
+			if (miscFlag & 0x4) {
+				cubeMap = true;
+				arraySize *= 6;
+			}
+			break;
+		case 4:
+			dimension = 3;
+			if (arraySize > 1)
+				return false;
+			break;
+		default:
+			return false;
+		}
+	}
+	else {
+		format = _getDDSFormat(pf);
+		if ((flags & DDSD_DEPTH) && (caps2 & DDSCAPS2_VOLUME))
+			dimension = 3;
+		else {
+			depth = 1;
+			if (caps2 & DDSCAPS2_CUBEMAP) {
+				if ((caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES)
+					return false; // Partial cube maps are not supported.
+				cubeMap = true;
+				arraySize = 6;
+			}
+		}
+	}
+
+	uint32 bpp = GetBitsPerPixel(format);
+	if (bpp == 0)
+		return false;
+	depth = std::max(depth, 1u);
+	if (width == 0 || height == 0 || width > MAX_DIMENSION || height > MAX_DIMENSION || depth > 2048 || arraySize > 2048 || mipCount > 16)
+		return false;
+
+	img.dimension = dimension;
+	img.width = width;
+	img.height = height;
+	img.depth = depth;
+	img.arraySize = arraySize;
+	img.mipLevels = mipCount;
+	img.format = format;
+	img.cubeMap = cubeMap;
+	img.subresources.clear();
+	img.subresources.reserve(size_t(arraySize) * mipCount);
+
+	// Subresources are stored tightly packed in D3D12 order, so the data can be copied as is.
+	size_t total = 0;
+	for (uint32 i = 0; i < arraySize; i++) {
+		uint32 w = width, hh = height, d = depth;
+		for (uint32 m = 0; m < mipCount; m++) {
+			uint32 rowPitch, rowCount;
+			GetSurfaceInfo(format, w, hh, rowPitch, rowCount);
+			uint64 slicePitch = uint64(rowPitch) * rowCount;
+			if (slicePitch > 0xFFFFFFFFull)
+				return false;
+			img.subresources.push_back({ total, rowPitch, uint32(slicePitch), w, hh, d });
+			total += size_t(slicePitch) * d;
+			if (total > size - offset)
+				return false;
+			w = std::max(1u, w / 2);
+			hh = std::max(1u, hh / 2);
+			d = std::max(1u, d / 2);
+		}
+	}
+
+	img.data.assign(data + offset, data + offset + total);
+	return true;
+}
@@ -0,0 +1,89 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include <cstddef>
+#include "M3DCore/MTypes.h"
+#include "M3DCore/Containers.h"
+#include "GraphicsDefines.h"
+
+namespace m3d
+{
+
+// An image decoded into raw subresources, ready to be uploaded to a texture.
+// The decoders do not depend on D3D or Windows, so they can be tested and benchmarked on any platform.
+struct DecodedImage
+{
+	struct Subresource
+	{
+		size_t offset; // Offset into data.
+		uint32 rowPitch; // Bytes per row (or row of blocks).
+		uint32 slicePitch; // Bytes per depth slice.
+		uint32 width;
+		uint32 height;
+		uint32 depth;
+	};
+
+	uint32 dimension = 2; // 1, 2 or 3.
+	uint32 width = 0;
+	uint32 height = 0;
+	uint32 depth = 1;
+	uint32 arraySize = 1; // Number of array slices. Six for each cube in a cube map.
+	uint32 mipLevels = 1;
+	M3D_FORMAT format = M3D_FORMAT_UNKNOWN;
+	bool cubeMap = false;
+	List<Subresource> subresources; // D3D12 order: All mips of array slice 0, then all mips of slice 1 etc.
+	List<uint8> data;
+
+	// Sets up a single RGBA8 subresource of the given size.
+	void InitRGBA8(uint32 w, uint32 h);
+};
+
+namespace imagedecoder
+{
+	// The decoders return false if the data is invalid or uses a feature not supported here. The caller can then fall back to a platform decoder.
+
+	// DDS: Legacy and DX10 headers, 1D/2D/3D textures, arrays, cube maps and mip chains. Data is kept in its stored format (including BCn).
+	bool DecodeDDS(const uint8 *data, size_t size, DecodedImage &img);
+	// TGA: Uncompressed and RLE compressed true color, gray scale and color mapped images. Decoded to R8G8B8A8.
+	bool DecodeTGA(const uint8 *data, size_t size, DecodedImage &img);
+	// PNG: All color types and bit depths. Interlaced images are not supported. Decoded to R8G8B8A8.
+	bool DecodePNG(const uint8 *data, size_t size, DecodedImage &img);
+	// BMP: Uncompressed 1, 4, 8, 16, 24 and 32 bits per pixel, including bit fields. Decoded to R8G8B8A8.
+	bool DecodeBMP(const uint8 *data, size_t size, DecodedImage &img);
+
+	// Decompresses a zlib stream (RFC 1950/1951) into out, which must be exactly the size of the decompressed data.
+	bool Inflate(const uint8 *data, size_t size, uint8 *out, size_t outSize);
+
+	// Bits per pixel, or bits per 4x4 block for block compressed formats. 0 if the format is not supported by the decoders.
+	uint32 GetBitsPerPixel(M3D_FORMAT fmt);
+	// true for BC1-BC7.
+	bool IsBlockCompressed(M3D_FORMAT fmt);
+	// Bytes per row (or row of blocks) and number of rows (or rows of blocks) for a surface of the given size.
+	void GetSurfaceInfo(M3D_FORMAT fmt, uint32 width, uint32 height, uint32 &rowPitch, uint32 &rowCount);
+	// Returns the sRGB version of the format, or the format itself if it has none.
+	M3D_FORMAT MakeSRGB(M3D_FORMAT fmt);
+}
+
+}
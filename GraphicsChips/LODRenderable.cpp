@@ -0,0 +1,111 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "LODRenderable.h"
+#include "Geometry.h"
+#include "RenderSettings.h"
+#include "Graphics.h"
+#include "M3DEngine/DocumentSaveLoadUtil.h"
+#include "M3DEngine/Engine.h"
+
+using namespace m3d;
+
+
+CHIPDESCV1_DEF(LODRenderable, MTEXT("LOD Renderable"), LODRENDERABLE_GUID, RENDERABLE_GUID);
+
+
+LODRenderable::LODRenderable()
+{
+}
+
+LODRenderable::~LODRenderable()
+{
+}
+
+bool LODRenderable::CopyChip(Chip *chip)
+{
+	LODRenderable *c = dynamic_cast<LODRenderable*>(chip);
+	B_RETURN(Renderable::CopyChip(c));
+	_pixelError = c->_pixelError;
+	_forcedLOD = c->_forcedLOD;
+	return true;
+}
+
+bool LODRenderable::LoadChip(DocumentLoader &loader)
+{
+	B_RETURN(Renderable::LoadChip(loader));
+	LOADDEF("pixelError", _pixelError, 1.0f);
+	LOADDEF("forcedLOD", _forcedLOD, -1);
+	return true;
+}
+
+bool LODRenderable::SaveChip(DocumentSaver &saver) const
+{
+	B_RETURN(Renderable::SaveChip(saver));
+	SAVEDEF("pixelError", _pixelError, 1.0f);
+	SAVEDEF("forcedLOD", _forcedLOD, -1);
+	return true;
+}
+
+uint32 LODRenderable::_selectLOD(CXMMATRIX world, const List<GeometryLOD> &lods)
+{
+	if (_forcedLOD >= 0)
+		return _lastLOD = std::min((uint32)_forcedLOD, (uint32)lods.size());
+
+	_lastLOD = 0;
+
+	RenderSettings *rs = engine->GetGraphics()->rs();
+	if (rs->GetNumViewportsAndScissorRects() == 0 || _pixelError <= 0.0f)
+		return _lastLOD;
+
+	// Bounds of the mesh in view space.
+	AxisAlignedBox bb;
+	bb.SetNull();
+	for (const GeometrySubset &ss : lods.front().subsets)
+		bb.Merge(ss.boundingBox);
+	if (bb.IsInfinite() || bb.GetMin().x > bb.GetMax().x)
+		return _lastLOD; // No usable bounds.
+	bb.Transform(world * XMLoadFloat4x4(&rs->GetViewMatrix()));
+	XMVECTOR bbMin = XMLoadFloat3(&bb.GetMin()), bbMax = XMLoadFloat3(&bb.GetMax());
+	float32 radius = XMVectorGetX(XMVector3Length(bbMax - bbMin)) * 0.5f;
+	float32 depth = XMVectorGetZ(bbMin + bbMax) * 0.5f - radius; // Distance to the closest possible point.
+
+	// Pixels per object space unit at that depth. Errors are given in object space, so we scale by the largest axis of the world matrix.
+	const XMFLOAT4X4 &p = rs->GetProjectionMatrix();
+	float32 pixelsPerUnit = p._22 * rs->GetViewports()[0].Height * 0.5f;
+	if (p._34 != 0.0f) { // Perspective?
+		if (depth <= 0.0f)
+			return _lastLOD; // Camera is inside the bounds.
+		pixelsPerUnit /= depth;
+	}
+	float32 scale = std::max(XMVectorGetX(XMVector3Length(world.r[0])), std::max(XMVectorGetX(XMVector3Length(world.r[1])), XMVectorGetX(XMVector3Length(world.r[2]))));
+	pixelsPerUnit *= scale;
+
+	for (uint32 i = (uint32)lods.size(); i > 0; i--) {
+		if (lods[i - 1].error * pixelsPerUnit <= _pixelError)
+			return _lastLOD = i;
+	}
+	return _lastLOD;
+}
@@ -0,0 +1,70 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "Renderable.h"
+
+namespace m3d
+{
+
+
+static const Guid LODRENDERABLE_GUID = { 0x186d69c1, 0x51ff, 0x4cf2, { 0x8f, 0xba, 0x39, 0x24, 0xb2, 0x13, 0x7a, 0xb8 } };
+
+
+// A Renderable drawing the coarsest level of detail of the geometry whose error, projected to the screen, is within the given number of pixels.
+// See StdGeometry::GenerateLODs(...).
+class GRAPHICSCHIPS_API LODRenderable : public Renderable
+{
+	CHIPDESC_DECL;
+public:
+	LODRenderable();
+	~LODRenderable();
+
+	bool CopyChip(Chip *chip) override;
+	bool LoadChip(DocumentLoader &loader) override;
+	bool SaveChip(DocumentSaver &saver) const override;
+
+	// Get/Set max allowed screen space error in pixels.
+	virtual float32 GetPixelError() const { return _pixelError; }
+	virtual void SetPixelError(float32 e) { _pixelError = e; }
+	// Get/Set a fixed level of detail to draw. -1 for automatic selection.
+	virtual int32 GetForcedLOD() const { return _forcedLOD; }
+	virtual void SetForcedLOD(int32 lod) { _forcedLOD = lod; }
+
+	// Gets the level of detail selected last time we were rendered.
+	virtual uint32 GetLastLOD() const { return _lastLOD; }
+
+protected:
+	float32 _pixelError = 1.0f;
+	int32 _forcedLOD = -1;
+	uint32 _lastLOD = 0;
+
+	uint32 _selectLOD(CXMMATRIX world, const List<GeometryLOD> &lods) override;
+};
+
+
+
+}
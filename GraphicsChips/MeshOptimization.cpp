@@ -0,0 +1,1136 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "MeshOptimization.h"
+#include "M3DCore/Frustum.h"
+#include "M3DCore/Sphere.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+
+using namespace m3d;
+using namespace m3d::meshoptimization;
+
+
+namespace
+{
+
+// Size of the LRU cache used for scoring in OptimizeVertexCache. Larger than the FIFO caches of most GPUs, which is fine as the score decays.
+const uint32 FORSYTH_CACHE_SIZE = 32;
+const uint32 FORSYTH_MAX_VALENCE = 32;
+
+struct ForsythScores
+{
+	float32 cache[FORSYTH_CACHE_SIZE];
+	float32 valence[FORSYTH_MAX_VALENCE + 1];
+
+	ForsythScores()
+	{
+		for (uint32 i = 0; i < FORSYTH_CACHE_SIZE; i++)
+			cache[i] = i < 3 ? 0.75f : std::pow(1.0f - float32(i - 3) / float32(FORSYTH_CACHE_SIZE - 3), 1.5f); // The last triangle gets a fixed score.
+		valence[0] = 0.0f;
+		for (uint32 i = 1; i <= FORSYTH_MAX_VALENCE; i++)
+			valence[i] = 2.0f / std::sqrt(float32(i)); // Boost vertices with few triangles left, to avoid leaving lonely triangles behind.
+	}
+
+	float32 operator()(int32 cachePosition, uint32 remainingValence) const
+	{
+		if (remainingValence == 0)
+			return -1.0f;
+		return (cachePosition >= 0 ? cache[cachePosition] : 0.0f) + valence[std::min(remainingValence, FORSYTH_MAX_VALENCE)];
+	}
+};
+
+struct Vec3
+{
+	float32 x = 0.0f, y = 0.0f, z = 0.0f;
+	Vec3() {}
+	Vec3(float32 x, float32 y, float32 z) : x(x), y(y), z(z) {}
+	Vec3 operator+(const Vec3 &v) const { return Vec3(x + v.x, y + v.y, z + v.z); }
+	Vec3 operator-(const Vec3 &v) const { return Vec3(x - v.x, y - v.y, z - v.z); }
+	Vec3 operator*(float32 s) const { return Vec3(x * s, y * s, z * s); }
+	Vec3 &operator+=(const Vec3 &v) { x += v.x; y += v.y; z += v.z; return *this; }
+};
+
+inline float32 _dot(const Vec3 &a, const Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+inline Vec3 _cross(const Vec3 &a, const Vec3 &b) { return Vec3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x); }
+inline float32 _length(const Vec3 &v) { return std::sqrt(_dot(v, v)); }
+
+inline Vec3 _position(const float32 *positions, size_t stride, uint32 i)
+{
+	const float32 *p = (const float32*)((const uint8*)positions + stride * i);
+	return Vec3(p[0], p[1], p[2]);
+}
+
+// Symmetric 4x4 matrix for the squared distance to a set of planes, weighted by area.
+struct Quadric
+{
+	float64 a2 = 0.0, b2 = 0.0, c2 = 0.0, ab = 0.0, ac = 0.0, bc = 0.0, ad = 0.0, bd = 0.0, cd = 0.0, d2 = 0.0, w = 0.0;
+
+	void addPlane(float64 a, float64 b, float64 c, float64 d, float64 weight)
+	{
+		a2 += a * a * weight; b2 += b * b * weight; c2 += c * c * weight;
+		ab += a * b * weight; ac += a * c * weight; bc += b * c * weight;
+		ad += a * d * weight; bd += b * d * weight; cd += c * d * weight;
+		d2 += d * d * weight;
+		w += weight;
+	}
+	Quadric &operator+=(const Quadric &q)
+	{
+		a2 += q.a2; b2 += q.b2; c2 += q.c2; ab += q.ab; ac += q.ac; bc += q.bc; ad += q.ad; bd += q.bd; cd += q.cd; d2 += q.d2; w += q.w;
+		return *this;
+	}
+	// Mean squared distance from p to the planes.
+	float64 error(const Vec3 &p) const
+	{
+		if (w <= 0.0)
+			return 0.0;
+		float64 x = p.x, y = p.y, z = p.z;
+		float64 r = a2 * x * x + b2 * y * y + c2 * z * z + 2.0 * (ab * x * y + ac * x * z + bc * y * z) + 2.0 * (ad * x + bd * y + cd * z) + d2;
+		return std::abs(r) / w;
+	}
+};
+
+// Adds the plane through p with normal n (need not be normalized).
+void _addPlane(Quadric &q, const Vec3 &p, const Vec3 &n, float64 weight)
+{
+	float32 l = _length(n);
+	if (l <= 0.0f)
+		return;
+	Vec3 u = n * (1.0f / l);
+	q.addPlane(u.x, u.y, u.z, -_dot(u, p), weight);
+}
+
+// Squared distance from p to triangle abc (Ericson, "Real-Time Collision Detection").
+float32 _pointTriangleDistanceSq(const Vec3 &p, const Vec3 &a, const Vec3 &b, const Vec3 &c)
+{
+	Vec3 ab = b - a, ac = c - a, ap = p - a;
+	float32 d1 = _dot(ab, ap), d2 = _dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f)
+		return _dot(ap, ap);
+	Vec3 bp = p - b;
+	float32 d3 = _dot(ab, bp), d4 = _dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3)
+		return _dot(bp, bp);
+	float32 vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+		Vec3 q = a + ab * (d1 / (d1 - d3)) - p;
+		return _dot(q, q);
+	}
+	Vec3 cp = p - c;
+	float32 d5 = _dot(ab, cp), d6 = _dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6)
+		return _dot(cp, cp);
+	float32 vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+		Vec3 q = a + ac * (d2 / (d2 - d6)) - p;
+		return _dot(q, q);
+	}
+	float32 va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+		Vec3 q = b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))) - p;
+		return _dot(q, q);
+	}
+	float32 denom = va + vb + vc;
+	if (denom <= 0.0f) { // Degenerate triangle.
+		float32 e = std::min(_dot(ap, ap), std::min(_dot(bp, bp), _dot(cp, cp)));
+		return e;
+	}
+	Vec3 q = a + ab * (vb / denom) + ac * (vc / denom) - p;
+	return _dot(q, q);
+}
+
+// Uniform grid of triangles for closest point queries.
+class TriangleGrid
+{
+public:
+	TriangleGrid(const float32 *positions, size_t stride, const uint32 *indices, size_t indexCount) : _positions(positions), _stride(stride), _indices(indices)
+	{
+		size_t triCount = indexCount / 3;
+		if (triCount == 0)
+			return;
+		_min = Vec3(FLT_MAX, FLT_MAX, FLT_MAX);
+		Vec3 mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (size_t i = 0; i < triCount * 3; i++) {
+			Vec3 p = _position(positions, stride, indices[i]);
+			_min = Vec3(std::min(_min.x, p.x), std::min(_min.y, p.y), std::min(_min.z, p.z));
+			mx = Vec3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+		}
+		Vec3 e = mx - _min;
+		// Cells about twice the average triangle size, but no more cells than 4 per triangle.
+		float64 size = 0.0;
+		for (size_t i = 0; i < triCount; i++) {
+			Vec3 p0 = _position(positions, stride, indices[i * 3]), p1 = _position(positions, stride, indices[i * 3 + 1]), p2 = _position(positions, stride, indices[i * 3 + 2]);
+			size += std::max(std::max(_length(p1 - p0), _length(p2 - p1)), _length(p0 - p2));
+		}
+		_cell = float32(2.0 * size / triCount);
+		float32 maxExtent = std::max(std::max(e.x, e.y), e.z);
+		if (_cell <= 0.0f)
+			_cell = maxExtent > 0.0f ? maxExtent : 1.0f;
+		for (;;) {
+			for (uint32 i = 0; i < 3; i++)
+				_dim[i] = std::min(uint32((&e.x)[i] / _cell) + 1, 1024u);
+			if (uint64(_dim[0]) * _dim[1] * _dim[2] <= std::max(uint64(triCount) * 4, uint64(64)))
+				break;
+			_cell *= 1.25f;
+		}
+
+		// Count, then fill (CSR layout).
+		List<uint32> counts(_dim[0] * _dim[1] * _dim[2] + 1, 0);
+		for (int32 pass = 0; pass < 2; pass++) {
+			if (pass == 1) {
+				for (size_t i = 1; i < counts.size(); i++)
+					counts[i] += counts[i - 1];
+				_offsets = counts;
+				_cells.resize(counts.back());
+				std::fill(counts.begin(), counts.end(), 0);
+			}
+			for (uint32 t = 0; t < uint32(triCount); t++) {
+				uint32 lo[3], hi[3];
+				_bounds(t, lo, hi);
+				for (uint32 z = lo[2]; z <= hi[2]; z++)
+					for (uint32 y = lo[1]; y <= hi[1]; y++)
+						for (uint32 x = lo[0]; x <= hi[0]; x++) {
+							uint32 c = (z * _dim[1] + y) * _dim[0] + x;
+							if (pass == 0)
+								counts[c + 1]++;
+							else
+								_cells[_offsets[c] + counts[c]++] = t;
+						}
+			}
+		}
+	}
+
+	// Squared distance from p to the closest triangle.
+	float32 distanceSq(const Vec3 &p) const
+	{
+		if (_cells.empty())
+			return FLT_MAX;
+		int32 c[3];
+		_cellOf(p, c);
+		// Distance from p to the sides of its cell, if it is inside the grid.
+		float32 inner = FLT_MAX;
+		for (uint32 i = 0; i < 3; i++) {
+			float32 l = ((&p.x)[i] - (&_min.x)[i]) / _cell - c[i];
+			inner = std::min(inner, (l >= 0.0f && l <= 1.0f) ? std::min(l, 1.0f - l) * _cell : 0.0f);
+		}
+		float32 best = FLT_MAX;
+		int32 maxRing = int32(std::max(std::max(_dim[0], _dim[1]), _dim[2]));
+		for (int32 r = 0; r <= maxRing; r++) {
+			for (int32 z = c[2] - r; z <= c[2] + r; z++) {
+				if (z < 0 || z >= int32(_dim[2]))
+					continue;
+				for (int32 y = c[1] - r; y <= c[1] + r; y++) {
+					if (y < 0 || y >= int32(_dim[1]))
+						continue;
+					for (int32 x = c[0] - r; x <= c[0] + r; x++) {
+						if (x < 0 || x >= int32(_dim[0]))
+							continue;
+						if (std::max(std::max(std::abs(x - c[0]), std::abs(y - c[1])), std::abs(z - c[2])) != r)
+							continue; // Only the shell.
+						uint32 cell = (z * _dim[1] + y) * _dim[0] + x;
+						for (uint32 i = _offsets[cell]; i < _offsets[cell + 1]; i++) {
+							const uint32 *t = _indices + _cells[i] * 3;
+							best = std::min(best, _pointTriangleDistanceSq(p, _position(_positions, _stride, t[0]), _position(_positions, _stride, t[1]), _position(_positions, _stride, t[2])));
+						}
+					}
+				}
+			}
+			// Cells in the next shell are at least r cells away from the cell of the (clamped) point.
+			float32 bound = r * _cell + inner;
+			if (best <= bound * bound)
+				break;
+		}
+		return best;
+	}
+
+private:
+	const float32 *_positions;
+	size_t _stride;
+	const uint32 *_indices;
+	Vec3 _min;
+	float32 _cell = 1.0f;
+	uint32 _dim[3] = { 0, 0, 0 };
+	List<uint32> _offsets;
+	List<uint32> _cells;
+
+	void _cellOf(const Vec3 &p, int32 *c) const
+	{
+		Vec3 l = (p - _min) * (1.0f / _cell);
+		c[0] = std::min(std::max(int32(std::floor(l.x)), 0), int32(_dim[0]) - 1);
+		c[1] = std::min(std::max(int32(std::floor(l.y)), 0), int32(_dim[1]) - 1);
+		c[2] = std::min(std::max(int32(std::floor(l.z)), 0), int32(_dim[2]) - 1);
+	}
+
+	void _bounds(uint32 t, uint32 *lo, uint32 *hi) const
+	{
+		int32 a[3], b[3];
+		_cellOf(_position(_positions, _stride, _indices[t * 3]), a);
+		for (uint32 i = 0; i < 3; i++)
+			b[i] = a[i];
+		for (uint32 k = 1; k < 3; k++) {
+			int32 c[3];
+			_cellOf(_position(_positions, _stride, _indices[t * 3 + k]), c);
+			for (uint32 i = 0; i < 3; i++) {
+				a[i] = std::min(a[i], c[i]);
+				b[i] = std::max(b[i], c[i]);
+			}
+		}
+		for (uint32 i = 0; i < 3; i++) {
+			lo[i] = uint32(a[i]);
+			hi[i] = uint32(b[i]);
+		}
+	}
+};
+
+// Largest distance from the vertices and centroids of the triangles in a to the surface of b.
+float32 _oneSidedHausdorff(const float32 *positions, size_t stride, const uint32 *a, size_t countA, const TriangleGrid &b)
+{
+	float32 d = 0.0f;
+	for (size_t i = 0; i + 2 < countA; i += 3) {
+		Vec3 p0 = _position(positions, stride, a[i]), p1 = _position(positions, stride, a[i + 1]), p2 = _position(positions, stride, a[i + 2]);
+		d = std::max(d, b.distanceSq(p0));
+		d = std::max(d, b.distanceSq((p0 + p1 + p2) * (1.0f / 3.0f)));
+	}
+	return std::sqrt(d);
+}
+
+enum VertexKind : uint8 { VK_MANIFOLD, VK_BORDER, VK_SEAM, VK_LOCKED };
+
+const uint32 NO_VERTEX = uint32(-1);
+const uint32 MANY_VERTICES = uint32(-2);
+
+}
+
+
+VertexCacheStats meshoptimization::AnalyzeVertexCache(const uint32 *indices, size_t indexCount, size_t vertexCount, uint32 cacheSize)
+{
+	VertexCacheStats stats;
+	size_t triCount = indexCount / 3;
+	if (triCount == 0 || vertexCount == 0)
+		return stats;
+
+	// A vertex is in the FIFO cache if it was inserted within the last cacheSize insertions.
+	List<uint32> timestamps(vertexCount, 0);
+	uint32 time = cacheSize + 1;
+	size_t misses = 0, unique = 0;
+	for (size_t i = 0; i < triCount * 3; i++) {
+		uint32 v = indices[i];
+		if (v >= vertexCount)
+			continue;
+		if (timestamps[v] == 0)
+			unique++;
+		if (time - timestamps[v] > cacheSize) {
+			timestamps[v] = time++;
+			misses++;
+		}
+	}
+
+	stats.acmr = float32(misses) / float32(triCount);
+	stats.atvr = unique ? float32(misses) / float32(unique) : 0.0f;
+	return stats;
+}
+
+void meshoptimization::OptimizeVertexCache(uint32 *dst, const uint32 *indices, size_t indexCount, size_t vertexCount)
+{
+	static const ForsythScores score;
+
+	size_t triCount = indexCount / 3;
+	if (triCount == 0 || vertexCount == 0) {
+		if (dst != indices)
+			std::memmove(dst, indices, indexCount * sizeof(uint32));
+		return;
+	}
+
+	// Build the list of triangles using each vertex. The first remaining[v] entries are the triangles not yet emitted.
+	List<uint32> offsets(vertexCount + 1, 0);
+	for (size_t i = 0; i < triCount * 3; i++)
+		offsets[indices[i] + 1]++;
+	for (size_t i = 0; i < vertexCount; i++)
+		offsets[i + 1] += offsets[i];
+	List<uint32> remaining(vertexCount, 0);
+	List<uint32> adjacency(triCount * 3);
+	for (size_t i = 0; i < triCount * 3; i++) {
+		uint32 v = indices[i];
+		adjacency[offsets[v] + remaining[v]++] = uint32(i / 3);
+	}
+
+	List<int32> cachePosition(vertexCount, -1);
+	List<float32> vertexScores(vertexCount);
+	for (size_t i = 0; i < vertexCount; i++)
+		vertexScores[i] = score(-1, remaining[i]);
+
+	List<float32> triScores(triCount);
+	uint32 best = 0;
+	for (size_t i = 0; i < triCount; i++) {
+		triScores[i] = vertexScores[indices[i * 3]] + vertexScores[indices[i * 3 + 1]] + vertexScores[indices[i * 3 + 2]];
+		if (triScores[i] > triScores[best])
+			best = uint32(i);
+	}
+
+	List<uint8> emitted(triCount, 0);
+	List<uint32> out;
+	out.reserve(triCount * 3);
+	uint32 cache[FORSYTH_CACHE_SIZE + 3], newCache[FORSYTH_CACHE_SIZE + 3];
+	uint32 cacheCount = 0;
+	size_t cursor = 0;
+
+	for (size_t n = 0; n < triCount; n++) {
+		if (best == uint32(-1)) {
+			// Nothing in the cache has triangles left. Continue with the next triangle in input order.
+			while (emitted[cursor])
+				cursor++;
+			best = uint32(cursor);
+		}
+
+		const uint32 *tri = indices + best * 3;
+		emitted[best] = 1;
+		out.push_back(tri[0]);
+		out.push_back(tri[1]);
+		out.push_back(tri[2]);
+
+		// Remove the triangle from the adjacency of its vertices.
+		for (uint32 k = 0; k < 3; k++) {
+			uint32 v = tri[k];
+			uint32 *adj = &adjacency[offsets[v]];
+			for (uint32 i = 0; i < remaining[v]; i++) {
+				if (adj[i] == best) {
+					std::swap(adj[i], adj[remaining[v] - 1]);
+					remaining[v]--;
+					break;
+				}
+			}
+		}
+
+		// Move the vertices of the triangle to the front of the LRU cache.
+		uint32 newCount = 0;
+		for (uint32 k = 0; k < 3; k++)
+			if (std::find(newCache, newCache + newCount, tri[k]) == newCache + newCount)
+				newCache[newCount++] = tri[k];
+		for (uint32 i = 0; i < cacheCount; i++)
+			if (cache[i] != tri[0] && cache[i] != tri[1] && cache[i] != tri[2])
+				newCache[newCount++] = cache[i];
+
+		// Update the scores of the vertices in the cache, and those pushed out of it, and the triangles using them.
+		for (uint32 i = 0; i < newCount; i++) {
+			uint32 v = newCache[i];
+			int32 p = i < FORSYTH_CACHE_SIZE ? int32(i) : -1;
+			cachePosition[v] = p;
+			float32 s = score(p, remaining[v]);
+			float32 d = s - vertexScores[v];
+			vertexScores[v] = s;
+			const uint32 *adj = &adjacency[offsets[v]];
+			for (uint32 j = 0; j < remaining[v]; j++)
+				triScores[adj[j]] += d;
+		}
+		cacheCount = std::min(newCount, FORSYTH_CACHE_SIZE);
+		std::memcpy(cache, newCache, cacheCount * sizeof(uint32));
+
+		// The next triangle is the best one using a vertex in the cache.
+		best = uint32(-1);
+		float32 bestScore = -1.0f;
+		for (uint32 i = 0; i < cacheCount; i++) {
+			uint32 v = cache[i];
+			const uint32 *adj = &adjacency[offsets[v]];
+			for (uint32 j = 0; j < remaining[v]; j++) {
+				if (triScores[adj[j]] > bestScore) {
+					bestScore = triScores[adj[j]];
+					best = adj[j];
+				}
+			}
+		}
+	}
+
+	std::memcpy(dst, out.data(), out.size() * sizeof(uint32));
+}
+
+void meshoptimization::OptimizeOverdraw(uint32 *dst, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride, size_t vertexCount, float32 threshold, uint32 cacheSize)
+{
+	size_t triCount = indexCount / 3;
+	if (triCount < 2 || vertexCount == 0) {
+		if (dst != indices)
+			std::memmove(dst, indices, indexCount * sizeof(uint32));
+		return;
+	}
+
+	// Split into clusters where a triangle misses the cache for all its vertices. Reordering such clusters hardly affects the cache.
+	List<uint32> clusters;
+	List<uint32> timestamps(vertexCount, 0);
+	uint32 time = cacheSize + 1;
+	for (size_t i = 0; i < triCount; i++) {
+		uint32 misses = 0;
+		for (uint32 k = 0; k < 3; k++) {
+			uint32 v = indices[i * 3 + k];
+			if (time - timestamps[v] > cacheSize) {
+				timestamps[v] = time++;
+				misses++;
+			}
+		}
+		if (i == 0 || misses == 3)
+			clusters.push_back(uint32(i));
+	}
+	if (clusters.size() < 2) {
+		if (dst != indices)
+			std::memmove(dst, indices, indexCount * sizeof(uint32));
+		return;
+	}
+	clusters.push_back(uint32(triCount));
+
+	// Area weighted centroid and normal of each cluster, and the centroid of the mesh.
+	struct Cluster { uint32 start, end; Vec3 centroid, normal; float32 area, key; };
+	List<Cluster> c(clusters.size() - 1);
+	Vec3 meshCentroid;
+	float32 meshArea = 0.0f;
+	for (size_t i = 0; i < c.size(); i++) {
+		Cluster &cl = c[i];
+		cl.start = clusters[i];
+		cl.end = clusters[i + 1];
+		cl.area = 0.0f;
+		for (uint32 t = cl.start; t < cl.end; t++) {
+			Vec3 p0 = _position(positions, positionStride, indices[t * 3]);
+			Vec3 p1 = _position(positions, positionStride, indices[t * 3 + 1]);
+			Vec3 p2 = _position(positions, positionStride, indices[t * 3 + 2]);
+			Vec3 n = _cross(p1 - p0, p2 - p0);
+			float32 a = _length(n) * 0.5f;
+			cl.centroid += (p0 + p1 + p2) * (a / 3.0f);
+			cl.normal += n;
+			cl.area += a;
+		}
+		meshCentroid += cl.centroid;
+		meshArea += cl.area;
+		if (cl.area > 0.0f)
+			cl.centroid = cl.centroid * (1.0f / cl.area);
+	}
+	if (meshArea > 0.0f)
+		meshCentroid = meshCentroid * (1.0f / meshArea);
+
+	// Clusters facing away from the center are likely to occlude the others, so draw them first.
+	for (size_t i = 0; i < c.size(); i++) {
+		float32 l = _length(c[i].normal);
+		c[i].key = (c[i].area > 0.0f && l > 0.0f) ? _dot(c[i].centroid - meshCentroid, c[i].normal) / l : 0.0f;
+	}
+	std::stable_sort(c.begin(), c.end(), [](const Cluster &a, const Cluster &b) { return a.key > b.key; });
+
+	List<uint32> out;
+	out.reserve(triCount * 3);
+	for (size_t i = 0; i < c.size(); i++)
+		out.insert(out.end(), indices + c[i].start * 3, indices + c[i].end * 3);
+
+	VertexCacheStats before = AnalyzeVertexCache(indices, indexCount, vertexCount, cacheSize);
+	VertexCacheStats after = AnalyzeVertexCache(out.data(), out.size(), vertexCount, cacheSize);
+	if (after.acmr > before.acmr * threshold) {
+		if (dst != indices)
+			std::memmove(dst, indices, indexCount * sizeof(uint32));
+		return;
+	}
+
+	std::memcpy(dst, out.data(), out.size() * sizeof(uint32));
+}
+
+size_t meshoptimization::OptimizeVertexFetchRemap(uint32 *remap, const uint32 *indices, size_t indexCount, size_t vertexCount)
+{
+	std::fill(remap, remap + vertexCount, uint32(-1));
+	uint32 next = 0;
+	for (size_t i = 0; i < indexCount; i++) {
+		uint32 v = indices[i];
+		if (v < vertexCount && remap[v] == uint32(-1))
+			remap[v] = next++;
+	}
+	return next;
+}
+
+size_t meshoptimization::Simplify(uint32 *dst, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride, size_t vertexCount,
+	const float32 *attributes, size_t attributeStride, uint32 attributeCount, const float32 *attributeWeights, const uint32 *vertexGroups,
+	size_t targetIndexCount, float32 targetError, bool lockBorders, float32 *resultError)
+{
+	List<uint32> tris(indices, indices + indexCount / 3 * 3);
+	if (resultError)
+		*resultError = 0.0f;
+
+	if (tris.empty() || vertexCount == 0 || targetIndexCount >= tris.size()) {
+		std::memmove(dst, tris.data(), tris.size() * sizeof(uint32));
+		return tris.size();
+	}
+
+	// Work in a unit box, so that errors are relative to the extent of the mesh.
+	List<uint8> alive(vertexCount, 0);
+	for (uint32 v : tris)
+		alive[v] = 1;
+	Vec3 mn(FLT_MAX, FLT_MAX, FLT_MAX), mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (uint32 v = 0; v < vertexCount; v++) {
+		if (!alive[v])
+			continue;
+		Vec3 p = _position(positions, positionStride, v);
+		mn = Vec3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+		mx = Vec3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+	}
+	float32 extent = std::max(std::max(mx.x - mn.x, mx.y - mn.y), mx.z - mn.z);
+	if (extent <= 0.0f)
+		extent = 1.0f;
+	List<Vec3> pos(vertexCount);
+	for (uint32 v = 0; v < vertexCount; v++)
+		if (alive[v])
+			pos[v] = (_position(positions, positionStride, v) - mn) * (1.0f / extent);
+
+	// Weld vertices with identical positions. weld[v] is the first of them, and wedge[v] links all of them in a ring.
+	List<uint32> weld(vertexCount), wedge(vertexCount);
+	{
+		List<uint32> order;
+		for (uint32 v = 0; v < vertexCount; v++) {
+			weld[v] = wedge[v] = v;
+			if (alive[v])
+				order.push_back(v);
+		}
+		auto key = [&](uint32 v) { const float32 *p = (const float32*)((const uint8*)positions + positionStride * v); return std::make_tuple(p[0], p[1], p[2]); };
+		std::sort(order.begin(), order.end(), [&](uint32 a, uint32 b) { return key(a) < key(b) || (key(a) == key(b) && a < b); });
+		for (size_t i = 0, j; i < order.size(); i = j) {
+			for (j = i + 1; j < order.size() && key(order[j]) == key(order[i]); j++)
+				weld[order[j]] = order[i];
+			for (size_t k = i; k < j; k++)
+				wedge[order[k]] = order[k + 1 < j ? k + 1 : i];
+		}
+	}
+
+	auto attributeCost = [&](uint32 v, uint32 w) -> float64 {
+		float64 c = 0.0;
+		if (!attributes)
+			return c;
+		const float32 *a = (const float32*)((const uint8*)attributes + attributeStride * v);
+		const float32 *b = (const float32*)((const uint8*)attributes + attributeStride * w);
+		for (uint32 i = 0; i < attributeCount; i++)
+			c += attributeWeights[i] * (a[i] - b[i]) * (a[i] - b[i]);
+		return c;
+	};
+
+	// Open edges (in vertex space, so seams are open too) for the current triangles. openOut/openIn is the single neighbour along an open edge.
+	List<uint32> openOut(vertexCount), openIn(vertexCount);
+	UnorderedSet<uint64> edges;
+	auto findOpenEdges = [&]() {
+		std::fill(openOut.begin(), openOut.end(), NO_VERTEX);
+		std::fill(openIn.begin(), openIn.end(), NO_VERTEX);
+		edges.clear();
+		edges.reserve(tris.size());
+		for (size_t i = 0; i < tris.size(); i += 3)
+			for (uint32 k = 0; k < 3; k++)
+				edges.insert((uint64(tris[i + k]) << 32) | tris[i + (k + 1) % 3]);
+		for (size_t i = 0; i < tris.size(); i += 3) {
+			for (uint32 k = 0; k < 3; k++) {
+				uint32 a = tris[i + k], b = tris[i + (k + 1) % 3];
+				if (edges.count((uint64(b) << 32) | a))
+					continue;
+				openOut[a] = openOut[a] == NO_VERTEX ? b : MANY_VERTICES;
+				openIn[b] = openIn[b] == NO_VERTEX ? a : MANY_VERTICES;
+			}
+		}
+	};
+
+	// Plane quadrics of the triangles, and planes perpendicular to open edges to keep borders and seams in place.
+	List<Quadric> quadrics(vertexCount);
+	findOpenEdges();
+	for (size_t i = 0; i < tris.size(); i += 3) {
+		const Vec3 &p0 = pos[tris[i]], &p1 = pos[tris[i + 1]], &p2 = pos[tris[i + 2]];
+		Vec3 n = _cross(p1 - p0, p2 - p0);
+		float32 area = _length(n) * 0.5f;
+		Quadric q;
+		_addPlane(q, p0, n, area);
+		for (uint32 k = 0; k < 3; k++)
+			quadrics[weld[tris[i + k]]] += q;
+		for (uint32 k = 0; k < 3; k++) {
+			uint32 a = tris[i + k], b = tris[i + (k + 1) % 3];
+			if (edges.count((uint64(b) << 32) | a))
+				continue;
+			Vec3 e = pos[b] - pos[a];
+			Quadric qe;
+			_addPlane(qe, pos[a], _cross(e, n), _dot(e, e) * 10.0);
+			quadrics[weld[a]] += qe;
+			quadrics[weld[b]] += qe;
+		}
+	}
+
+	const float64 maxCost = float64(targetError) * targetError;
+	float64 maxGeometricError = 0.0;
+	List<uint8> kinds(vertexCount);
+	List<uint32> sibling(vertexCount);
+	List<uint32> adjOffsets(vertexCount + 1), adjacency;
+	List<uint32> remap(vertexCount);
+	List<uint8> locked(vertexCount);
+	struct Collapse { uint32 v, w; float64 cost, error; };
+	List<Collapse> collapses;
+
+	while (tris.size() > targetIndexCount) {
+		// Classify the vertices.
+		std::fill(alive.begin(), alive.end(), 0);
+		for (uint32 v : tris)
+			alive[v] = 1;
+		for (uint32 v = 0; v < vertexCount; v++) {
+			if (!alive[v])
+				continue;
+			uint32 count = 0;
+			sibling[v] = NO_VERTEX;
+			for (uint32 w = wedge[v]; w != v; w = wedge[w]) {
+				if (alive[w]) {
+					count++;
+					sibling[v] = w;
+				}
+			}
+			bool open = openOut[v] != NO_VERTEX || openIn[v] != NO_VERTEX;
+			bool single = openOut[v] < MANY_VERTICES && openIn[v] < MANY_VERTICES;
+			if (count == 0)
+				kinds[v] = !open ? VK_MANIFOLD : (single && !lockBorders ? VK_BORDER : VK_LOCKED);
+			else if (count == 1)
+				kinds[v] = single ? VK_SEAM : VK_LOCKED;
+			else
+				kinds[v] = VK_LOCKED;
+		}
+
+		// Triangles using each vertex.
+		std::fill(adjOffsets.begin(), adjOffsets.end(), 0);
+		for (uint32 v : tris)
+			adjOffsets[v + 1]++;
+		for (size_t i = 0; i < vertexCount; i++)
+			adjOffsets[i + 1] += adjOffsets[i];
+		adjacency.resize(tris.size());
+		{
+			List<uint32> fill(adjOffsets.begin(), adjOffsets.end() - 1);
+			for (size_t i = 0; i < tris.size(); i++)
+				adjacency[fill[tris[i]]++] = uint32(i / 3);
+		}
+
+		// The cheapest collapse for each vertex.
+		auto evaluate = [&](uint32 v, uint32 w, Collapse &c) -> bool {
+			if (kinds[v] == VK_LOCKED || weld[v] == weld[w])
+				return false;
+			if (vertexGroups && vertexGroups[v] != vertexGroups[w])
+				return false;
+			if (kinds[v] == VK_BORDER && w != openOut[v] && w != openIn[v])
+				return false;
+			float64 attr = attributeCost(v, w);
+			if (kinds[v] == VK_SEAM) {
+				if (w != openOut[v] && w != openIn[v])
+					return false;
+				uint32 s = sibling[v];
+				uint32 w2 = w == openOut[v] ? openIn[s] : openOut[s];
+				if (w2 >= MANY_VERTICES || weld[w2] != weld[w] || (vertexGroups && vertexGroups[s] != vertexGroups[w2]))
+					return false;
+				attr += attributeCost(s, w2);
+			}
+			c.v = v;
+			c.w = w;
+			c.error = quadrics[weld[v]].error(pos[w]);
+			c.cost = c.error + attr;
+			return c.cost <= maxCost;
+		};
+		collapses.clear();
+		for (uint32 v = 0; v < vertexCount; v++) {
+			if (!alive[v] || kinds[v] == VK_LOCKED)
+				continue;
+			Collapse best = { 0, 0, DBL_MAX, 0.0 }, c;
+			for (uint32 i = adjOffsets[v]; i < adjOffsets[v + 1]; i++) {
+				const uint32 *t = &tris[adjacency[i] * 3];
+				for (uint32 k = 0; k < 3; k++)
+					if (t[k] != v && evaluate(v, t[k], c) && c.cost < best.cost)
+						best = c;
+			}
+			if (best.cost < DBL_MAX)
+				collapses.push_back(best);
+		}
+		if (collapses.empty())
+			break;
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse &a, const Collapse &b) { return a.cost < b.cost; });
+
+		// Returns false if moving v to w flips any of the remaining triangles around v.
+		auto checkFlip = [&](uint32 v, uint32 w) -> bool {
+			for (uint32 i = adjOffsets[v]; i < adjOffsets[v + 1]; i++) {
+				const uint32 *t = &tris[adjacency[i] * 3];
+				uint32 a = remap[t[0]], b = remap[t[1]], c = remap[t[2]];
+				if (a == w || b == w || c == w)
+					continue; // This triangle is removed.
+				Vec3 p0 = pos[a], p1 = pos[b], p2 = pos[c];
+				Vec3 n0 = _cross(p1 - p0, p2 - p0);
+				if (a == v) p0 = pos[w];
+				if (b == v) p1 = pos[w];
+				if (c == v) p2 = pos[w];
+				Vec3 n1 = _cross(p1 - p0, p2 - p0);
+				if (_dot(n0, n1) <= 0.0f)
+					return false;
+			}
+			return true;
+		};
+
+		// Apply the cheapest collapses that do not touch each other.
+		for (uint32 v = 0; v < vertexCount; v++)
+			remap[v] = v;
+		std::fill(locked.begin(), locked.end(), 0);
+		size_t trianglesToRemove = (tris.size() - targetIndexCount) / 3, removed = 0, applied = 0;
+		for (const Collapse &c : collapses) {
+			if (removed >= trianglesToRemove)
+				break;
+			uint32 v = c.v, w = c.w, s = NO_VERTEX, w2 = NO_VERTEX;
+			if (kinds[v] == VK_SEAM) {
+				s = sibling[v];
+				w2 = w == openOut[v] ? openIn[s] : openOut[s];
+			}
+			if (locked[v] || locked[w] || (s != NO_VERTEX && (locked[s] || locked[w2])))
+				continue;
+			if (!checkFlip(v, w) || (s != NO_VERTEX && !checkFlip(s, w2)))
+				continue;
+			remap[v] = w;
+			locked[v] = locked[w] = 1;
+			if (s != NO_VERTEX) {
+				remap[s] = w2;
+				locked[s] = locked[w2] = 1;
+			}
+			quadrics[weld[w]] += quadrics[weld[v]];
+			maxGeometricError = std::max(maxGeometricError, c.error);
+			removed += kinds[v] == VK_BORDER ? 1 : 2;
+			applied++;
+		}
+		if (applied == 0)
+			break;
+
+		// Remove the triangles that collapsed, including those with two corners at the same position.
+		size_t n = 0;
+		for (size_t i = 0; i < tris.size(); i += 3) {
+			uint32 a = remap[tris[i]], b = remap[tris[i + 1]], c = remap[tris[i + 2]];
+			if (weld[a] == weld[b] || weld[b] == weld[c] || weld[a] == weld[c])
+				continue;
+			tris[n++] = a;
+			tris[n++] = b;
+			tris[n++] = c;
+		}
+		tris.resize(n);
+		findOpenEdges();
+	}
+
+	std::memmove(dst, tris.data(), tris.size() * sizeof(uint32));
+	if (resultError)
+		*resultError = float32(std::sqrt(maxGeometricError)) * extent;
+	return tris.size();
+}
+
+float32 meshoptimization::MeasureHausdorffDistance(const float32 *positions, size_t positionStride, size_t vertexCount, const uint32 *indicesA, size_t indexCountA, const uint32 *indicesB, size_t indexCountB)
+{
+	if (indexCountA < 3 || indexCountB < 3 || vertexCount == 0)
+		return 0.0f;
+	TriangleGrid a(positions, positionStride, indicesA, indexCountA), b(positions, positionStride, indicesB, indexCountB);
+	return std::max(_oneSidedHausdorff(positions, positionStride, indicesA, indexCountA, b), _oneSidedHausdorff(positions, positionStride, indicesB, indexCountB, a));
+}
+
+void meshoptimization::BuildMeshlets(MeshletList &meshlets, uint32 *dst, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride, size_t vertexCount,
+	uint32 indexOffset, const MeshletOptions &options)
+{
+	static const uint32 NONE = uint32(-1);
+
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+		return;
+
+	const uint32 maxVertices = std::max(options.maxVertices, 3u), maxTriangles = std::max(options.maxTriangles, 1u);
+	const float32 coneWeight = std::min(std::max(options.coneWeight, 0.0f), 1.0f);
+
+	List<uint32> tris(indices, indices + triangleCount * 3); // dst can be the same as indices.
+
+	// Unit normals and centroids of the triangles.
+	List<Vec3> normals(triangleCount), centroids(triangleCount);
+	float64 area = 0.0;
+	for (size_t t = 0; t < triangleCount; t++) {
+		Vec3 a = _position(positions, positionStride, tris[t * 3]), b = _position(positions, positionStride, tris[t * 3 + 1]), c = _position(positions, positionStride, tris[t * 3 + 2]);
+		Vec3 n = _cross(b - a, c - a);
+		float32 l = _length(n);
+		normals[t] = l > 0.0f ? n * (1.0f / l) : Vec3();
+		centroids[t] = (a + b + c) * (1.0f / 3.0f);
+		area += l * 0.5;
+	}
+
+	// Radius of a flat meshlet of maxTriangles average triangles. Used to make distances scale independent.
+	const float32 expectedRadius = std::max(float32(std::sqrt(area / triangleCount * maxTriangles / 3.14159265)), FLT_MIN);
+
+	// Triangles using each vertex.
+	List<uint32> offsets(vertexCount + 1, 0), adjacency(triangleCount * 3), live(vertexCount, 0);
+	for (size_t i = 0; i < triangleCount * 3; i++)
+		offsets[tris[i] + 1]++;
+	for (size_t v = 0; v < vertexCount; v++) {
+		live[v] = offsets[v + 1];
+		offsets[v + 1] += offsets[v];
+	}
+	{
+		List<uint32> fill(offsets.begin(), offsets.end() - 1);
+		for (size_t i = 0; i < triangleCount * 3; i++)
+			adjacency[fill[tris[i]]++] = uint32(i / 3);
+	}
+
+	List<bool> used(triangleCount, false);
+	List<uint32> stamp(vertexCount, NONE); // Meshlet the vertex was last added to.
+	List<uint32> vertices; // Vertices of the current meshlet.
+	vertices.reserve(maxVertices);
+	uint32 id = 0, meshletTriangles = 0;
+	size_t written = 0, meshletStart = 0, nextSeed = 0;
+	Vec3 normalSum, centroidSum;
+
+	auto extraVertices = [&](size_t t) -> uint32 {
+		return (stamp[tris[t * 3]] != id ? 1 : 0) + (stamp[tris[t * 3 + 1]] != id ? 1 : 0) + (stamp[tris[t * 3 + 2]] != id ? 1 : 0);
+	};
+
+	auto add = [&](size_t t) {
+		used[t] = true;
+		for (uint32 k = 0; k < 3; k++) {
+			uint32 v = tris[t * 3 + k];
+			if (stamp[v] != id) {
+				stamp[v] = id;
+				vertices.push_back(v);
+			}
+			live[v]--;
+			dst[written++] = v;
+		}
+		normalSum += normals[t];
+		centroidSum += centroids[t];
+		meshletTriangles++;
+	};
+
+	auto finish = [&]() {
+		Meshlet m;
+		m.startIndex = indexOffset + uint32(meshletStart);
+		m.indexCount = uint32(written - meshletStart);
+		m.vertexCount = uint32(vertices.size());
+
+		Vec3 mn(FLT_MAX, FLT_MAX, FLT_MAX), mx(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+		for (uint32 v : vertices) {
+			Vec3 p = _position(positions, positionStride, v);
+			mn = Vec3(std::min(mn.x, p.x), std::min(mn.y, p.y), std::min(mn.z, p.z));
+			mx = Vec3(std::max(mx.x, p.x), std::max(mx.y, p.y), std::max(mx.z, p.z));
+		}
+		Vec3 center = (mn + mx) * 0.5f;
+		float32 radius = 0.0f;
+		for (uint32 v : vertices)
+			radius = std::max(radius, _length(_position(positions, positionStride, v) - center));
+		m.center = XMFLOAT3(center.x, center.y, center.z);
+		m.radius = radius;
+
+		// The cone can be used when all normals are within about 84 degrees of the axis. Degenerate triangles are ignored.
+		float32 l = _length(normalSum);
+		if (l > 0.0f) {
+			Vec3 axis = normalSum * (1.0f / l);
+			float32 minDot = 1.0f;
+			for (size_t i = meshletStart; i < written; i += 3) {
+				Vec3 a = _position(positions, positionStride, dst[i]), b = _position(positions, positionStride, dst[i + 1]), c = _position(positions, positionStride, dst[i + 2]);
+				Vec3 n = _cross(b - a, c - a);
+				float32 nl = _length(n);
+				if (nl > 0.0f)
+					minDot = std::min(minDot, _dot(n, axis) / nl);
+			}
+			m.coneAxis = XMFLOAT3(axis.x, axis.y, axis.z);
+			m.coneCutoff = minDot <= 0.1f ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+		}
+		meshlets.push_back(m);
+
+		id++;
+		vertices.clear();
+		meshletTriangles = 0;
+		meshletStart = written;
+		normalSum = centroidSum = Vec3();
+	};
+
+	while (true) {
+		size_t best = NONE;
+
+		if (meshletTriangles > 0 && meshletTriangles < maxTriangles) {
+			// Grow from the triangles sharing a vertex with the meshlet, preferring those adding few vertices,
+			// facing the same way and being close to the center.
+			float32 l = _length(normalSum);
+			Vec3 axis = l > 0.0f ? normalSum * (1.0f / l) : Vec3();
+			Vec3 center = centroidSum * (1.0f / meshletTriangles);
+			float32 bestScore = FLT_MAX;
+			for (uint32 v : vertices) {
+				if (live[v] == 0)
+					continue;
+				for (uint32 j = offsets[v]; j < offsets[v + 1]; j++) {
+					uint32 t = adjacency[j];
+					if (used[t])
+						continue;
+					uint32 extra = extraVertices(t);
+					if (vertices.size() + extra > maxVertices)
+						continue;
+					float32 score = float32(extra) + coneWeight * (1.0f - _dot(normals[t], axis)) + (1.0f - coneWeight) * _length(centroids[t] - center) / expectedRadius;
+					if (score < bestScore) {
+						bestScore = score;
+						best = t;
+					}
+				}
+			}
+		}
+
+		if (best == NONE) {
+			// Start a new meshlet next to the last one, at the triangle with the fewest live neighbours to avoid leaving islands behind.
+			uint32 bestLive = NONE;
+			for (uint32 v : vertices) {
+				for (uint32 j = offsets[v]; j < offsets[v + 1]; j++) {
+					uint32 t = adjacency[j];
+					if (used[t])
+						continue;
+					uint32 n = live[tris[t * 3]] + live[tris[t * 3 + 1]] + live[tris[t * 3 + 2]];
+					if (n < bestLive) {
+						bestLive = n;
+						best = t;
+					}
+				}
+			}
+			if (meshletTriangles > 0)
+				finish();
+			if (best == NONE) {
+				while (nextSeed < triangleCount && used[nextSeed])
+					nextSeed++;
+				if (nextSeed == triangleCount)
+					break;
+				best = nextSeed;
+			}
+		}
+
+		add(best);
+	}
+
+	if (meshletTriangles > 0)
+		finish();
+}
+
+void meshoptimization::CullMeshlets(MeshletDrawList &drawList, const Meshlet *meshlets, size_t meshletCount, CXMMATRIX world, const Frustum *frustum, const XMFLOAT3 *cameraPosition, MeshletCullStats *stats)
+{
+	float32 sx = XMVectorGetX(XMVector3Length(world.r[0])), sy = XMVectorGetX(XMVector3Length(world.r[1])), sz = XMVectorGetX(XMVector3Length(world.r[2]));
+	float32 maxScale = std::max(sx, std::max(sy, sz)), minScale = std::min(sx, std::min(sy, sz));
+	bool backFaceCulling = cameraPosition && minScale > 0.0f && maxScale <= minScale * 1.001f && XMVectorGetX(XMMatrixDeterminant(world)) > 0.0f;
+	XMVECTOR eye = cameraPosition ? XMLoadFloat3(cameraPosition) : XMVectorZero();
+
+	Frustum::PlaneId plane = Frustum::LEFTP;
+	MeshletCullStats st;
+	size_t drawCount = drawList.size();
+
+	for (size_t i = 0; i < meshletCount; i++) {
+		const Meshlet &m = meshlets[i];
+		st.meshletCount++;
+
+		XMVECTOR center = XMVector3TransformCoord(XMLoadFloat3(&m.center), world);
+		float32 radius = m.radius * maxScale;
+
+		if (frustum) {
+			XMFLOAT3 c;
+			XMStoreFloat3(&c, center);
+			if (frustum->Test(Sphere(c, radius), &plane) == Frustum::OUTSIDE) {
+				st.frustumCulled++;
+				continue;
+			}
+		}
+
+		// The meshlet is back facing if the camera is inside the cone opposite to the normal cone, widened by the bounding sphere.
+		if (backFaceCulling && m.coneCutoff < 1.0f) {
+			XMVECTOR axis = XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&m.coneAxis), world));
+			XMVECTOR d = XMVectorSubtract(center, eye);
+			if (XMVectorGetX(XMVector3Dot(d, axis)) >= m.coneCutoff * XMVectorGetX(XMVector3Length(d)) + radius) {
+				st.backFaceCulled++;
+				continue;
+			}
+		}
+
+		if (drawList.size() > drawCount && drawList.back().startIndex + drawList.back().indexCount == m.startIndex)
+			drawList.back().indexCount += m.indexCount;
+		else {
+			MeshletDrawRange r;
+			r.startIndex = m.startIndex;
+			r.indexCount = m.indexCount;
+			drawList.push_back(r);
+		}
+		st.indexCount += m.indexCount;
+	}
+	st.drawCount = uint32(drawList.size() - drawCount);
+
+	if (stats) {
+		stats->meshletCount += st.meshletCount;
+		stats->frustumCulled += st.frustumCulled;
+		stats->backFaceCulled += st.backFaceCulled;
+		stats->drawCount += st.drawCount;
+		stats->indexCount += st.indexCount;
+	}
+}
+
+void meshoptimization::GenerateTangents(float32 *tangents, float32 *bitangents, size_t tangentStride, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride,
+	const float32 *normals, size_t normalStride, const float32 *texcoords, size_t texcoordStride, size_t vertexCount, bool flipV)
+{
+	List<Vec3> t(vertexCount), b(vertexCount);
+
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		uint32 v[3] = { indices[i], indices[i + 1], indices[i + 2] };
+		if (v[0] >= vertexCount || v[1] >= vertexCount || v[2] >= vertexCount)
+			continue;
+		Vec3 p0 = _position(positions, positionStride, v[0]), e1 = _position(positions, positionStride, v[1]) - p0, e2 = _position(positions, positionStride, v[2]) - p0;
+		const float32 *t0 = (const float32*)((const uint8*)texcoords + texcoordStride * v[0]);
+		const float32 *t1 = (const float32*)((const uint8*)texcoords + texcoordStride * v[1]);
+		const float32 *t2 = (const float32*)((const uint8*)texcoords + texcoordStride * v[2]);
+		float32 du1 = t1[0] - t0[0], dv1 = t1[1] - t0[1], du2 = t2[0] - t0[0], dv2 = t2[1] - t0[1];
+		if (flipV) {
+			dv1 = -dv1;
+			dv2 = -dv2;
+		}
+		float32 det = du1 * dv2 - du2 * dv1;
+		if (det == 0.0f)
+			continue; // Degenerate mapping.
+		Vec3 sdir = (e1 * dv2 - e2 * dv1) * (1.0f / det), tdir = (e2 * du1 - e1 * du2) * (1.0f / det);
+		float32 sl = _length(sdir), tl = _length(tdir), area = _length(_cross(e1, e2));
+		if (!(sl > 0.0f && tl > 0.0f && area > 0.0f && sl < FLT_MAX && tl < FLT_MAX))
+			continue;
+		// The directions are normalized, so that the uv scale of a triangle does not matter.
+		sdir = sdir * (area / sl);
+		tdir = tdir * (area / tl);
+		for (uint32 j = 0; j < 3; j++) {
+			t[v[j]] += sdir;
+			b[v[j]] += tdir;
+		}
+	}
+
+	for (size_t i = 0; i < vertexCount; i++) {
+		Vec3 n = _position(normals, normalStride, (uint32)i);
+		float32 nl = _length(n);
+		n = nl > 0.0f ? n * (1.0f / nl) : Vec3();
+		Vec3 tt = t[i] - n * _dot(n, t[i]), bb = b[i] - n * _dot(n, b[i]);
+		float32 tl = _length(tt), bl = _length(bb);
+		bool hasT = tl > 1.0e-20f, hasB = bl > 1.0e-20f;
+		if (hasT)
+			tt = tt * (1.0f / tl);
+		if (hasB)
+			bb = bb * (1.0f / bl);
+		if (!hasT) {
+			if (hasB && nl > 0.0f)
+				tt = _cross(bb, n); // Only the bitangent is known. Keep the handedness of the uv-mapping.
+			else { // Nothing usable. Any direction perpendicular to the normal will do.
+				Vec3 axis = std::abs(n.x) < 0.9f ? Vec3(1.0f, 0.0f, 0.0f) : Vec3(0.0f, 1.0f, 0.0f);
+				tt = axis - n * _dot(n, axis);
+				tt = tt * (1.0f / _length(tt));
+			}
+		}
+		if (!hasB)
+			bb = nl > 0.0f ? _cross(n, tt) : Vec3(0.0f, 1.0f, 0.0f);
+		float32 *dt = (float32*)((uint8*)tangents + tangentStride * i), *db = (float32*)((uint8*)bitangents + tangentStride * i);
+		dt[0] = tt.x; dt[1] = tt.y; dt[2] = tt.z;
+		db[0] = bb.x; db[1] = bb.y; db[2] = bb.z;
+	}
+}
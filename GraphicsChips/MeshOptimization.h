@@ -0,0 +1,180 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DCore/MMath.h"
+
+namespace m3d
+{
+
+class Frustum;
+
+// Post-transform vertex cache efficiency of an index buffer, simulated using a FIFO cache.
+struct VertexCacheStats
+{
+	float32 acmr = 0.0f; // Average cache miss ratio: Transformed vertices per triangle. 0.5 is optimal, 3.0 is worst case.
+	float32 atvr = 0.0f; // Average transformed vertex ratio: Transformed vertices per referenced vertex. 1.0 is optimal.
+};
+
+// Settings for optimizing indexed triangle lists.
+struct MeshOptimizationOptions
+{
+	bool vertexCache = true; // Reorder triangles for post-transform vertex cache efficiency.
+	bool overdraw = true; // Reorder clusters of triangles so that outward facing parts are drawn first.
+	bool vertexFetch = true; // Reorder vertices by first use and remove unreferenced vertices.
+	float32 overdrawThreshold = 1.05f; // Max relative increase in ACMR accepted by the overdraw optimization.
+	uint32 cacheSize = 16; // Size of the simulated FIFO cache used for analysis.
+};
+
+// Vertex and cache statistics before and after optimization.
+struct MeshOptimizationStats
+{
+	VertexCacheStats before;
+	VertexCacheStats after;
+	uint32 vertexCountBefore = 0;
+	uint32 vertexCountAfter = 0;
+	uint32 triangleCount = 0; // Number of triangles in the optimized subsets.
+	uint32 optimizedSubsets = 0; // Number of subsets that are triangle lists.
+	bool indices16 = false; // All indices fit into 16 bits after optimization.
+};
+
+// Settings for generating levels of detail. See StdGeometry::GenerateLODs(...).
+struct MeshLODOptions
+{
+	uint32 levelCount = 4; // Max number of levels in addition to the base mesh.
+	float32 reduction = 0.5f; // Target triangle count of each level relative to the previous level.
+	float32 maxError = 0.02f; // Max simplification error relative to the extent of the mesh. Levels stop when they can not be reduced within it.
+	float32 normalWeight = 0.01f; // Cost of normal differences when collapsing edges.
+	float32 texcoordWeight = 0.1f; // Cost of texture coordinate (set 0) differences when collapsing edges.
+	float32 blendWeightWeight = 1.0f; // Cost of blend weight differences when collapsing edges. Vertices with different main bones are never merged.
+	bool lockBorders = false; // Do not move vertices on open borders. Use for meshes that must match their neighbours, like terrain tiles.
+	bool measureError = false; // Measure the Hausdorff distance of each level against the base mesh. Slow for large meshes.
+};
+
+// Result for one level of detail.
+struct MeshLODStats
+{
+	uint32 triangleCount = 0;
+	float32 error = 0.0f; // Estimated max error compared to the base mesh, in object space units.
+	float32 hausdorff = -1.0f; // Measured symmetric Hausdorff distance to the base mesh, in object space units. -1 if not measured.
+	float64 time = 0.0; // Seconds spent simplifying.
+};
+
+// A cluster of triangles with bounds for culling. See meshoptimization::BuildMeshlets(...).
+struct Meshlet
+{
+	uint32 startIndex = 0; // Location of the first index of the meshlet.
+	uint32 indexCount = 0;
+	uint32 vertexCount = 0; // Number of unique vertices referenced.
+	XMFLOAT3 center = XMFLOAT3(0.0f, 0.0f, 0.0f); // Bounding sphere.
+	float32 radius = 0.0f;
+	XMFLOAT3 coneAxis = XMFLOAT3(0.0f, 0.0f, 1.0f); // Average normal of the triangles.
+	float32 coneCutoff = 1.0f; // Sine of the half angle of the normal cone. 1 if the meshlet can not be back face culled.
+};
+
+typedef List<Meshlet> MeshletList;
+
+// Settings for building meshlets.
+struct MeshletOptions
+{
+	uint32 maxVertices = 64;
+	uint32 maxTriangles = 124;
+	float32 coneWeight = 0.5f; // 0-1. Higher prefers triangles facing the same way (back face culling) over compact meshlets (frustum culling).
+};
+
+// Quality of built meshlets.
+struct MeshletStats
+{
+	uint32 meshletCount = 0;
+	uint32 triangleCount = 0;
+	float32 averageVertices = 0.0f;
+	float32 averageTriangles = 0.0f;
+	float32 averageRadius = 0.0f; // Relative to the radius of the bounding box of the subset.
+	float32 coneCullable = 0.0f; // Fraction of meshlets with a normal cone narrow enough for back face culling.
+	float32 averageConeAngle = 0.0f; // Average half angle in degrees of the cones of the cullable meshlets.
+	float64 time = 0.0; // Seconds.
+};
+
+// A range of indices to draw.
+struct MeshletDrawRange
+{
+	uint32 startIndex = 0;
+	uint32 indexCount = 0;
+};
+
+typedef List<MeshletDrawRange> MeshletDrawList;
+
+// Result of culling meshlets. Accumulated over calls to CullMeshlets(...).
+struct MeshletCullStats
+{
+	uint32 meshletCount = 0; // Number of meshlets tested.
+	uint32 frustumCulled = 0;
+	uint32 backFaceCulled = 0;
+	uint32 drawCount = 0; // Number of ranges emitted, after merging adjacent meshlets.
+	uint32 indexCount = 0; // Number of indices emitted.
+};
+
+// CPU mesh optimizations for indexed triangle lists.
+// Like textureprocessing, this does not depend on D3D or Windows, so the results can be measured on any platform.
+// All functions take indices in [0, vertexCount). dst can be the same as indices.
+namespace meshoptimization
+{
+	// Simulates a FIFO cache of given size on a triangle list.
+	VertexCacheStats AnalyzeVertexCache(const uint32 *indices, size_t indexCount, size_t vertexCount, uint32 cacheSize = 16);
+	// Reorders triangles for vertex cache efficiency (Tom Forsyth, "Linear-Speed Vertex Cache Optimisation").
+	void OptimizeVertexCache(uint32 *dst, const uint32 *indices, size_t indexCount, size_t vertexCount);
+	// Splits the triangles (already optimized for vertex cache) into clusters and sorts the clusters so that the ones facing away from
+	// the center of the mesh are drawn first (Sander et al, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+	// The input order is kept if the ACMR increases more than threshold. positions is vertexCount float triplets with given stride in bytes.
+	void OptimizeOverdraw(uint32 *dst, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride, size_t vertexCount, float32 threshold = 1.05f, uint32 cacheSize = 16);
+	// Fills remap (vertexCount elements) with the new location of each vertex, ordered by first use in indices. Unreferenced vertices get -1.
+	// Indices equal to -1 (strip cut) are ignored. Returns the number of referenced vertices.
+	size_t OptimizeVertexFetchRemap(uint32 *remap, const uint32 *indices, size_t indexCount, size_t vertexCount);
+	// Simplifies a triangle list using quadric error metric edge collapses (Garland and Heckbert). Vertices are only moved onto other
+	// vertices, so the vertex data is kept as is. Attribute seams (vertices sharing a position) and open borders are only collapsed along
+	// themselves. attributes is attributeCount floats per vertex with given stride in bytes, where differences add attributeWeights[i]*d^2 to
+	// the cost. Vertices with different vertexGroups (optional) are never merged. targetError is relative to the extent of the mesh.
+	// Writes the result to dst (can be the same as indices) and returns the new index count. resultError is set in the units of positions.
+	size_t Simplify(uint32 *dst, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride, size_t vertexCount,
+		const float32 *attributes, size_t attributeStride, uint32 attributeCount, const float32 *attributeWeights, const uint32 *vertexGroups,
+		size_t targetIndexCount, float32 targetError, bool lockBorders = false, float32 *resultError = nullptr);
+	// Symmetric Hausdorff distance between two triangle lists sharing the same vertices, sampled at vertices and triangle centroids.
+	float32 MeasureHausdorffDistance(const float32 *positions, size_t positionStride, size_t vertexCount, const uint32 *indicesA, size_t indexCountA, const uint32 *indicesB, size_t indexCountB);
+	// Partitions a triangle list into meshlets of bounded vertex and triangle count, growing each meshlet from neighbouring triangles.
+	// The triangles are written to dst grouped by meshlet, and the meshlets are appended to meshlets with startIndex offset by indexOffset.
+	void BuildMeshlets(MeshletList &meshlets, uint32 *dst, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride, size_t vertexCount,
+		uint32 indexOffset = 0, const MeshletOptions &options = MeshletOptions());
+	// Culls meshlets transformed by world against the frustum (optional) and, if cameraPosition is given, culls back facing meshlets.
+	// Both are in world space. Back face culling assumes clockwise front faces, and is skipped if world has non-uniform scale or mirrors.
+	// The surviving meshlets are appended to drawList, where adjacent ones are merged into one range.
+	void CullMeshlets(MeshletDrawList &drawList, const Meshlet *meshlets, size_t meshletCount, CXMMATRIX world, const Frustum *frustum, const XMFLOAT3 *cameraPosition, MeshletCullStats *stats = nullptr);
+	// Generates tangents along +u and bitangents along +v of texcoords (uv float pairs) for a triangle list, orthogonalized against the
+	// normals. Triangles are weighted by area. If flipV, bitangents point along -v, which is the convention of assimp after aiProcess_FlipUVs.
+	// Vertices without a usable direction get one perpendicular to the normal. tangents and bitangents are float triplets with given stride.
+	void GenerateTangents(float32 *tangents, float32 *bitangents, size_t tangentStride, const uint32 *indices, size_t indexCount, const float32 *positions, size_t positionStride,
+		const float32 *normals, size_t normalStride, const float32 *texcoords, size_t texcoordStride, size_t vertexCount, bool flipV = false);
+}
+
+}
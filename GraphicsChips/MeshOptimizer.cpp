@@ -0,0 +1,153 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include "StdChips/Value.h"
+
+using namespace m3d;
+
+
+CHIPDESCV1_DEF(MeshOptimizer, MTEXT("Mesh Optimizer"), MESHOPTIMIZER_GUID, CHIP_GUID);
+
+
+MeshOptimizer::MeshOptimizer()
+{
+	CREATE_CHILD(0, STDGEOMETRY_GUID, true, UP, MTEXT("Geometries"));
+	CREATE_CHILD(1, VALUE_GUID, false, DOWN, MTEXT("ACMR"));
+	CREATE_CHILD(2, VALUE_GUID, false, DOWN, MTEXT("ATVR"));
+}
+
+MeshOptimizer::~MeshOptimizer()
+{
+}
+
+bool MeshOptimizer::CopyChip(Chip *chip)
+{
+	MeshOptimizer *c = dynamic_cast<MeshOptimizer*>(chip);
+	B_RETURN(Chip::CopyChip(c));
+	SetOptions(c->_options);
+	SetGenerateLODs(c->_generateLODs);
+	SetLODOptions(c->_lodOptions);
+	SetBuildMeshlets(c->_buildMeshlets);
+	SetMeshletOptions(c->_meshletOptions);
+	return true;
+}
+
+bool MeshOptimizer::LoadChip(DocumentLoader &loader)
+{
+	B_RETURN(Chip::LoadChip(loader));
+	MeshOptimizationOptions d;
+	LOADDEF("vertexCache", _options.vertexCache, d.vertexCache);
+	LOADDEF("overdraw", _options.overdraw, d.overdraw);
+	LOADDEF("vertexFetch", _options.vertexFetch, d.vertexFetch);
+	LOADDEF("overdrawThreshold", _options.overdrawThreshold, d.overdrawThreshold);
+	LOADDEF("cacheSize", _options.cacheSize, d.cacheSize);
+	MeshLODOptions l;
+	LOADDEF("generateLODs", _generateLODs, false);
+	LOADDEF("lodLevelCount", _lodOptions.levelCount, l.levelCount);
+	LOADDEF("lodReduction", _lodOptions.reduction, l.reduction);
+	LOADDEF("lodMaxError", _lodOptions.maxError, l.maxError);
+	LOADDEF("lodNormalWeight", _lodOptions.normalWeight, l.normalWeight);
+	LOADDEF("lodTexcoordWeight", _lodOptions.texcoordWeight, l.texcoordWeight);
+	LOADDEF("lodBlendWeightWeight", _lodOptions.blendWeightWeight, l.blendWeightWeight);
+	LOADDEF("lodLockBorders", _lodOptions.lockBorders, l.lockBorders);
+	MeshletOptions m;
+	LOADDEF("buildMeshlets", _buildMeshlets, false);
+	LOADDEF("meshletMaxVertices", _meshletOptions.maxVertices, m.maxVertices);
+	LOADDEF("meshletMaxTriangles", _meshletOptions.maxTriangles, m.maxTriangles);
+	LOADDEF("meshletConeWeight", _meshletOptions.coneWeight, m.coneWeight);
+	return true;
+}
+
+bool MeshOptimizer::SaveChip(DocumentSaver &saver) const
+{
+	B_RETURN(Chip::SaveChip(saver));
+	MeshOptimizationOptions d;
+	SAVEDEF("vertexCache", _options.vertexCache, d.vertexCache);
+	SAVEDEF("overdraw", _options.overdraw, d.overdraw);
+	SAVEDEF("vertexFetch", _options.vertexFetch, d.vertexFetch);
+	SAVEDEF("overdrawThreshold", _options.overdrawThreshold, d.overdrawThreshold);
+	SAVEDEF("cacheSize", _options.cacheSize, d.cacheSize);
+	MeshLODOptions l;
+	SAVEDEF("generateLODs", _generateLODs, false);
+	SAVEDEF("lodLevelCount", _lodOptions.levelCount, l.levelCount);
+	SAVEDEF("lodReduction", _lodOptions.reduction, l.reduction);
+	SAVEDEF("lodMaxError", _lodOptions.maxError, l.maxError);
+	SAVEDEF("lodNormalWeight", _lodOptions.normalWeight, l.normalWeight);
+	SAVEDEF("lodTexcoordWeight", _lodOptions.texcoordWeight, l.texcoordWeight);
+	SAVEDEF("lodBlendWeightWeight", _lodOptions.blendWeightWeight, l.blendWeightWeight);
+	SAVEDEF("lodLockBorders", _lodOptions.lockBorders, l.lockBorders);
+	MeshletOptions m;
+	SAVEDEF("buildMeshlets", _buildMeshlets, false);
+	SAVEDEF("meshletMaxVertices", _meshletOptions.maxVertices, m.maxVertices);
+	SAVEDEF("meshletMaxTriangles", _meshletOptions.maxTriangles, m.maxTriangles);
+	SAVEDEF("meshletConeWeight", _meshletOptions.coneWeight, m.coneWeight);
+	return true;
+}
+
+void MeshOptimizer::CallChip()
+{
+	if (!Refresh)
+		return;
+
+	float64 acmr = 0.0, atvr = 0.0;
+	uint32 count = 0;
+	Map<ChipID, UpdateStamp> stamps;
+
+	for (uint32 i = 0, j = GetSubConnectionCount(0); i < j; i++) {
+		ChildPtr<StdGeometry> ch0 = GetChild(0, i);
+		if (!ch0)
+			continue;
+		auto n = _stamps.find(ch0->GetID());
+		if (n != _stamps.end() && n->second == ch0->GetUpdateStamp()) {
+			stamps.insert(*n);
+			continue; // Unchanged since last time.
+		}
+		MeshOptimizationStats stats;
+		if (ch0->Optimize(_options, &stats)) {
+			if (_generateLODs)
+				ch0->GenerateLODs(_lodOptions);
+			if (_buildMeshlets)
+				ch0->BuildMeshlets(_meshletOptions);
+			ch0->DestroyDeviceObjects(); // Recreated with the new data when used.
+			acmr += stats.after.acmr;
+			atvr += stats.after.atvr;
+			count++;
+		}
+		stamps.insert(std::make_pair(ch0->GetID(), ch0->GetUpdateStamp())); // Failures are not retried until the geometry changes.
+	}
+
+	_stamps = std::move(stamps);
+
+	if (count == 0)
+		return;
+
+	ChildPtr<Value> ch1 = GetChild(1);
+	if (ch1)
+		ch1->SetValue(acmr / count);
+	ChildPtr<Value> ch2 = GetChild(2);
+	if (ch2)
+		ch2->SetValue(atvr / count);
+}
@@ -0,0 +1,77 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "StdGeometry.h"
+
+namespace m3d
+{
+
+
+static const Guid MESHOPTIMIZER_GUID = { 0x3596605d, 0xa37e, 0x4d64, { 0xb4, 0x9d, 0x1a, 0x4c, 0x14, 0xde, 0x07, 0x0b } };
+
+
+// Runs StdGeometry::Optimize(...) on the connected geometries when refreshed. Each geometry is only processed again when its update stamp
+// changes (see Geometry) or the settings change, so generated geometry is optimized once per generation.
+// The resulting ACMR and ATVR (average for the geometries processed) are written to the value children.
+// Can also generate levels of detail (StdGeometry::GenerateLODs(...)) after optimizing. Use LODRenderable to draw them.
+// Finally, meshlets can be built for culling in Renderable (StdGeometry::BuildMeshlets(...)).
+class GRAPHICSCHIPS_API MeshOptimizer : public Chip
+{
+	CHIPDESC_DECL;
+public:
+	MeshOptimizer();
+	virtual ~MeshOptimizer();
+
+	bool CopyChip(Chip *chip) override;
+	bool LoadChip(DocumentLoader &loader) override;
+	bool SaveChip(DocumentSaver &saver) const override;
+
+	void CallChip() override;
+
+	virtual const MeshOptimizationOptions &GetOptions() const { return _options; }
+	virtual void SetOptions(const MeshOptimizationOptions &options) { _options = options; _stamps.clear(); }
+	virtual bool IsGenerateLODs() const { return _generateLODs; }
+	virtual void SetGenerateLODs(bool b) { _generateLODs = b; _stamps.clear(); }
+	virtual const MeshLODOptions &GetLODOptions() const { return _lodOptions; }
+	virtual void SetLODOptions(const MeshLODOptions &options) { _lodOptions = options; _stamps.clear(); }
+	virtual bool IsBuildMeshlets() const { return _buildMeshlets; }
+	virtual void SetBuildMeshlets(bool b) { _buildMeshlets = b; _stamps.clear(); }
+	virtual const MeshletOptions &GetMeshletOptions() const { return _meshletOptions; }
+	virtual void SetMeshletOptions(const MeshletOptions &options) { _meshletOptions = options; _stamps.clear(); }
+
+protected:
+	MeshOptimizationOptions _options;
+	bool _generateLODs = false;
+	MeshLODOptions _lodOptions;
+	bool _buildMeshlets = false;
+	MeshletOptions _meshletOptions;
+	Map<ChipID, UpdateStamp> _stamps; // Update stamps of the geometries after we last processed them.
+};
+
+
+
+}
@@ -0,0 +1,85 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Exports.h"
+#include "Graphics.h"
+#include "RenderState.h"
+
+
+namespace m3d
+{
+
+static const Guid NULLRENDERSTATE_GUID = { 0x7b41d2e6, 0x93a0, 0x4f1c, { 0xb5, 0x62, 0x0d, 0x8e, 0x27, 0xf4, 0x19, 0xa3 } };
+
+
+// Render state of the null graphics backend. Keeps track of the matrices, but draws nothing.
+class GRAPHICSCHIPS_API NullRenderState : public RenderState
+{
+	CHIPDESC_DECL;
+public:
+	void ClearGraphicsRootDescriptorTables() override {}
+	void IASetPrimitiveTopology(M3D_PRIMITIVE_TOPOLOGY pt) override {}
+	void PrepareDraw() override {}
+	void CommitResourceBarriers() override {}
+	void DrawIndexedInstanced(UINT IndexCountPerInstance, UINT InstanceCount, UINT StartIndexLocation, INT BaseVertexLocation, UINT StartInstanceLocation) override {}
+	void DrawInstanced(UINT VertexCountPerInstance, UINT InstanceCount, UINT StartVertexLocation, UINT StartInstanceLocation) override {}
+	void PushState() override {}
+	void PopState() override {}
+};
+
+
+// Graphics engine without a device or windows, used when the engine runs headless (Engine::SetHeadless()).
+// rs() is nullptr and CanRender() false, so chips that only render return early. GetDevice() throws.
+class GRAPHICSCHIPS_API NullGraphics : public Graphics
+{
+	CHIPDESC_DECL;
+public:
+	NullGraphics();
+
+	void OnNewFrame() override;
+
+	void ClearState() override {}
+	RenderWindowManager* GetRenderWindowManager() override { return nullptr; }
+	RenderWindow* CreateRenderWindow(Window* wnd) override { return nullptr; }
+	void DumpMessages() override {}
+	void PostFrame() override {}
+	void DestroyDevice() override {}
+
+	HRESULT CreateDXGIObjects() override { return S_OK; }
+	void ReleaseDXGIFactory() override {}
+	void SetAdapterIndex(uint32 adapterIndex) override {}
+	IDXGIAdapter1* GetAdapter() override { return nullptr; }
+	ID3D12Device* GetDevice() override;
+	bool HasDevice() const override { return false; }
+
+	void Flush() override {}
+	void Sync() override {}
+	UINT64 GetLastCompletedFrameIndex() const override { return GetCurrentFrameIndex(); }
+
+protected:
+	const Guid &GetRenderStateType() const override { return NULLRENDERSTATE_GUID; }
+};
+
+}
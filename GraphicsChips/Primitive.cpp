@@ -28,6 +28,7 @@
 #include "StdChips/VectorChip.h"
 #include "StdChips/MatrixChip.h"
 #include "Primitives/Primitives.h"
+#include "PrimitiveCache.h"
 #include "M3DEngine/ProjectDependencies.h"
 #include <d3d12.h>
 #include <DirectXTK12/SimpleMath.h>
@@ -124,35 +125,158 @@ void Primitive::Update()
 	}
 }
 
-void buildPrimitiveMesh(Primitive* p, const prim::Mesh& mesh, String name)
+namespace
 {
-	XMMATRIX transform = XMLoadFloat4x4(&p->GetTransform());
 
-	if (!XMMatrixIsIdentity(transform)) {
-		XMMATRIX ntransform = XMMatrixTranspose(XMMatrixInverse(nullptr, transform));
-		XMVector3TransformCoordStream((XMFLOAT3*)& mesh.p.front(), sizeof(XMFLOAT3), (XMFLOAT3*)& mesh.p.front(), sizeof(XMFLOAT3), mesh.p.size(), transform);
-		XMVector3TransformNormalStream((XMFLOAT3*)& mesh.n.front(), sizeof(XMFLOAT3), (XMFLOAT3*)& mesh.n.front(), sizeof(XMFLOAT3), mesh.n.size(), ntransform);
+// Generates the primitives of the Primitives library directly into the streams of a PrimitiveMeshData.
+class PrimitiveMeshStreams : public prim::MeshStreams
+{
+public:
+	PrimitiveMeshStreams(PrimitiveMeshData &mesh, Primitive::PrimitiveFlags flags) : _mesh(mesh), _flags(flags) {}
+
+	bool allocate(size_t vertexCount, size_t triangleCount, prim::MeshStreamPointers &streams) override
+	{
+		_mesh.positions.resize(vertexCount);
+		streams.p = (prim::Vec3*)_mesh.positions.data();
+		if ((_flags & Primitive::PrimitiveFlags::NORMALS) != Primitive::PrimitiveFlags::NONE) {
+			_mesh.normals.resize(vertexCount);
+			streams.n = (prim::Vec3*)_mesh.normals.data();
+		}
+		if ((_flags & Primitive::PrimitiveFlags::TEXCOORDS) != Primitive::PrimitiveFlags::NONE) {
+			_mesh.texcoords.resize(vertexCount);
+			streams.tc = (prim::Vec2*)_mesh.texcoords.data();
+		}
+		if ((_flags & Primitive::PrimitiveFlags::TANGENTS) != Primitive::PrimitiveFlags::NONE) {
+			_mesh.tangents.resize(vertexCount);
+			_mesh.bitangents.resize(vertexCount);
+			streams.t = (prim::Vec3*)_mesh.tangents.data();
+			streams.bt = (prim::Vec3*)_mesh.bitangents.data();
+		}
+		_mesh.indices.resize(triangleCount * 3);
+		streams.indices = (prim::uVec3*)_mesh.indices.data();
+		return true;
 	}
 
-	bool eN = (p->GetFlags() & Primitive::PrimitiveFlags::NORMALS) != Primitive::PrimitiveFlags::NONE;
-	bool eTC = (p->GetFlags() & Primitive::PrimitiveFlags::TEXCOORDS) != Primitive::PrimitiveFlags::NONE;
-	bool eT = (p->GetFlags() & Primitive::PrimitiveFlags::TANGENTS) != Primitive::PrimitiveFlags::NONE;
-
-	for (size_t i = 0; i < mesh.p.size(); i++) p->AddPosition((XMFLOAT3&)mesh.p[i]);
-	if (eN)
-		for (size_t i = 0; i < mesh.n.size(); i++) p->AddNormal((XMFLOAT3&)mesh.n[i]);
-	if (eTC)
-		for (size_t i = 0; i < mesh.tc.size(); i++) p->AddTexCoord((XMFLOAT2&)mesh.tc[i], 0);
-	if (eT) {
-		for (size_t i = 0; i < mesh.t.size(); i++) p->AddTangent((XMFLOAT3&)mesh.t[i]);
-		for (size_t i = 0; i < mesh.bt.size(); i++) p->AddBitangent((XMFLOAT3&)mesh.bt[i]);
+private:
+	PrimitiveMeshData &_mesh;
+	Primitive::PrimitiveFlags _flags;
+};
+
+// Generates a primitive of the Primitives library. Returns false for other types.
+bool generatePrimitiveMesh(Primitive::PrimitiveType pt, const XMUINT4 &s, const XMFLOAT4 &d, prim::MeshStreams &mesh)
+{
+	using prim::Primitives;
+	switch (pt)
+	{
+	case Primitive::PrimitiveType::BOX: return Primitives::boxMesh(mesh, { d.x, d.y, d.z }, { (int)s.x, (int)s.y, (int)s.z }); // 3xsize, 3xsegments
+	case Primitive::PrimitiveType::SPHERE: return Primitives::sphereMesh(mesh, d.x, s.x, s.y); // radius, slices, segments
+	case Primitive::PrimitiveType::CYLINDER: return Primitives::cylinderMesh(mesh, d.x, d.y, s.x, s.y); // radius, size, slices, segments
+	case Primitive::PrimitiveType::CONE: return Primitives::coneMesh(mesh, d.x, d.y, s.x, s.y); // radius, size, slices, segments
+	case Primitive::PrimitiveType::TORUS: return Primitives::torusMesh(mesh, d.y, d.x, s.x, s.y); // innerRadius, outerradius, slices, segments
+	case Primitive::PrimitiveType::CAPSULE: return Primitives::capsuleMesh(mesh, d.x, d.y, s.x, s.y, s.z); // radius, size, slices, segments, rings
+	case Primitive::PrimitiveType::CAPPED_CYLINDER: return Primitives::cappedCylinderMesh(mesh, d.x, d.y, s.x, s.y, s.z); // radius, size, slices, segments, rings
+	case Primitive::PrimitiveType::CAPPED_CONE: return Primitives::cappedConeMesh(mesh, d.x, d.y, s.x, s.y, s.z); // radius, size, slices, segments, rings
+	case Primitive::PrimitiveType::CAPPED_TUBE: return Primitives::cappedTubeMesh(mesh, d.x, d.y, d.z, s.x, s.y, s.z); // radius, innerRadius, size, slices, segments, rings
+	case Primitive::PrimitiveType::DODECAHEDRON: return Primitives::dodecahedronMesh(mesh, d.x, s.x, s.y); // radius, segments, rings
+	case Primitive::PrimitiveType::DISK: return Primitives::diskMesh(mesh, d.x, d.y, s.x, s.y); // radius, innerRadius, slices, rings
+	case Primitive::PrimitiveType::ICOSAHEDRON: return Primitives::icosahedronMesh(mesh, d.x, s.x); // radius, segments
+	case Primitive::PrimitiveType::ICOSPHERE: return Primitives::icoSphereMesh(mesh, d.x, s.x); // radius, segments
+	case Primitive::PrimitiveType::PLANE: return Primitives::planeMesh(mesh, { d.x, d.y }, { (int)s.x, (int)s.y }); // 2xsize, 2xsegments
+	case Primitive::PrimitiveType::ROUNDED_BOX: return Primitives::roundedBoxMesh(mesh, d.w, { d.x, d.y, d.z }, s.w, { (int)s.x, (int)s.y, (int)s.z }); // radius, 3xsize, slices, 3xsegments
+	case Primitive::PrimitiveType::SPHERICAL_CONE: return Primitives::sphericalConeMesh(mesh, d.x, d.y, s.x, s.y, s.z); // radius, size, slices, segments, rings
+	case Primitive::PrimitiveType::SPHEREICAL_TRIANGLE: return Primitives::sphericalTriangleMesh(mesh, d.x, s.x); // radius, segments (3xpoints, segments)
+	case Primitive::PrimitiveType::SPRING: return Primitives::springMesh(mesh, d.y, d.x, d.z, s.x, s.y); // minor, major, size, slice, segments
+	case Primitive::PrimitiveType::TEAPOT: return Primitives::teapotMesh(mesh, d.x, s.x); // segments
+	case Primitive::PrimitiveType::TORUS_KNOT: return Primitives::torusKnotMesh(mesh, s.w, s.z, s.x, s.y); // p, q, slices, segments
+	case Primitive::PrimitiveType::TRIANGLE: return Primitives::triangleMesh(mesh, d.x, s.x); // radius, segments (3xpoints, segments)
+	case Primitive::PrimitiveType::TUBE: return Primitives::tubeMesh(mesh, d.x, d.y, d.z, s.x, s.y); // radius, innerRadius, size, slices, segments
+	default: return false;
 	}
-	for (size_t i = 0; i < mesh.indices.size(); i++) {
-		p->AddIndex(mesh.indices[i].v0);
-		p->AddIndex(mesh.indices[i].v1);
-		p->AddIndex(mesh.indices[i].v2);
+}
+
+const Char *getPrimitiveName(Primitive::PrimitiveType pt)
+{
+	switch (pt)
+	{
+	case Primitive::PrimitiveType::BOX: return MTEXT("Box");
+	case Primitive::PrimitiveType::SPHERE: return MTEXT("Sphere");
+	case Primitive::PrimitiveType::CYLINDER: return MTEXT("Cylinder");
+	case Primitive::PrimitiveType::CONE: return MTEXT("Cone");
+	case Primitive::PrimitiveType::TORUS: return MTEXT("Torus");
+	case Primitive::PrimitiveType::CAPSULE: return MTEXT("Capsule");
+	case Primitive::PrimitiveType::CAPPED_CYLINDER: return MTEXT("Capped cylinder");
+	case Primitive::PrimitiveType::CAPPED_CONE: return MTEXT("Capped cone");
+	case Primitive::PrimitiveType::CAPPED_TUBE: return MTEXT("Capped tube");
+	case Primitive::PrimitiveType::DODECAHEDRON: return MTEXT("Dodecahedron");
+	case Primitive::PrimitiveType::DISK: return MTEXT("Disk");
+	case Primitive::PrimitiveType::ICOSAHEDRON: return MTEXT("Icosahedron");
+	case Primitive::PrimitiveType::ICOSPHERE: return MTEXT("Icosphere");
+	case Primitive::PrimitiveType::PLANE: return MTEXT("Plane");
+	case Primitive::PrimitiveType::ROUNDED_BOX: return MTEXT("Rounded box");
+	case Primitive::PrimitiveType::SPHERICAL_CONE: return MTEXT("Spherical cone");
+	case Primitive::PrimitiveType::SPHEREICAL_TRIANGLE: return MTEXT("Spherical triangle");
+	case Primitive::PrimitiveType::SPRING: return MTEXT("Spring");
+	case Primitive::PrimitiveType::TEAPOT: return MTEXT("Teapot");
+	case Primitive::PrimitiveType::TORUS_KNOT: return MTEXT("Torus knot");
+	case Primitive::PrimitiveType::TRIANGLE: return MTEXT("Triangle");
+	case Primitive::PrimitiveType::TUBE: return MTEXT("Tube");
+	default: return MTEXT("");
 	}
-	p->CommitSubset(M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, name);
+}
+
+}
+
+bool Primitive::_addPrimitiveMesh()
+{
+	PrimitiveCache::Key key;
+	key.type = (uint32)_pt;
+	key.subdivision = _subdivision;
+	key.dimensions = _dimensions;
+	key.flags = (uint32)_flags;
+
+	const PrimitiveType pt = _pt;
+	const XMUINT4 subdivision = _subdivision;
+	const XMFLOAT4 dimensions = _dimensions;
+	const PrimitiveFlags flags = _flags;
+	PrimitiveMeshPtr mesh = PrimitiveCache::GetInstance().Get(key, [pt, subdivision, dimensions, flags](PrimitiveMeshData &m) {
+		PrimitiveMeshStreams streams(m, flags);
+		return generatePrimitiveMesh(pt, subdivision, dimensions, streams);
+	});
+	if (!mesh)
+		return false;
+
+	// Copy the shared mesh into our streams, applying the transform on the way.
+	XMMATRIX transform = XMLoadFloat4x4(&_transform);
+	if (XMMatrixIsIdentity(transform)) {
+		_positions = mesh->positions;
+		_normals = mesh->normals;
+		_tangents = mesh->tangents;
+		_bitangents = mesh->bitangents;
+	}
+	else {
+		XMMATRIX ntransform = XMMatrixTranspose(XMMatrixInverse(nullptr, transform));
+		auto transformStream = [](List<XMFLOAT3> &dst, const List<XMFLOAT3> &src, CXMMATRIX m, bool coords) {
+			dst.resize(src.size());
+			if (src.empty())
+				return;
+			if (coords)
+				XMVector3TransformCoordStream(dst.data(), sizeof(XMFLOAT3), src.data(), sizeof(XMFLOAT3), src.size(), m);
+			else
+				XMVector3TransformNormalStream(dst.data(), sizeof(XMFLOAT3), src.data(), sizeof(XMFLOAT3), src.size(), m);
+		};
+		transformStream(_positions, mesh->positions, transform, true);
+		transformStream(_normals, mesh->normals, ntransform, false);
+		_tangents = mesh->tangents; // Not transformed. Same as before the cache was added.
+		_bitangents = mesh->bitangents;
+	}
+	_texcoords[0].clear();
+	if (mesh->texcoords.size())
+		AddTexCoords((const float32*)mesh->texcoords.data(), (uint32)mesh->texcoords.size(), 2, 0);
+	_indices = mesh->indices;
+
+	CommitSubset(M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, getPrimitiveName(_pt));
+
+	return true;
 }
 
 void Primitive::CreateDeviceObjects()
@@ -169,160 +293,6 @@ void Primitive::CreateDeviceObjects()
 		CommitSubset(M3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP, MTEXT("Square"));
 		break;
 	}
-	case PrimitiveType::BOX:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::boxMesh(mesh, { _dimensions.x, _dimensions.y, _dimensions.z }, { (int)_subdivision.x, (int)_subdivision.y, (int)_subdivision.z })) // 3xsize, 3xsegments
-			buildPrimitiveMesh(this, mesh, MTEXT("Box"));
-		break;
-	}
-	case PrimitiveType::SPHERE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::sphereMesh(mesh, _dimensions.x, _subdivision.x, _subdivision.y)) // radius, slices, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Sphere"));
-		break;
-	}
-	case PrimitiveType::CYLINDER:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::cylinderMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y)) // radius, size, slices, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Cylinder"));
-		break;
-	}
-	case PrimitiveType::CONE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::coneMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y)) // radius, size, slices, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Cone"));
-		break;
-	}
-	case PrimitiveType::TORUS:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::torusMesh(mesh, _dimensions.y, _dimensions.x, _subdivision.x, _subdivision.y)) // innerRadius, outerradius, slices, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Torus"));
-		break;
-	}
-	case PrimitiveType::CAPSULE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::capsuleMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y, _subdivision.z)) // radius, size, slices, segments, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Capsule"));
-		break;
-	}
-	case PrimitiveType::CAPPED_CYLINDER:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::cappedCylinderMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y, _subdivision.z)) // radius, size, slices, segments, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Capped cylinder"));
-		break;
-	}
-	case PrimitiveType::CAPPED_CONE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::cappedConeMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y, _subdivision.z)) // radius, size, slices, segments, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Capped cone"));
-		break;
-	}
-	case PrimitiveType::CAPPED_TUBE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::cappedTubeMesh(mesh, _dimensions.x, _dimensions.y, _dimensions.z, _subdivision.x, _subdivision.y, _subdivision.z)) // radius, innerRadius, size, slices, segments, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Capped tube"));
-		break;
-	}
-	case PrimitiveType::DODECAHEDRON:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::dodecahedronMesh(mesh, _dimensions.x, _subdivision.x, _subdivision.y)) // radius, segments, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Dodecahedron"));
-		break;
-	}
-	case PrimitiveType::DISK:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::diskMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y)) // radius, innerRadius, slices, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Disk"));
-		break;
-	}
-	case PrimitiveType::ICOSAHEDRON:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::icosahedronMesh(mesh, _dimensions.x, _subdivision.x)) // radius, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Icosahedron"));
-		break;
-	}
-	case PrimitiveType::ICOSPHERE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::icoSphereMesh(mesh, _dimensions.x, _subdivision.x)) // radius, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Icosphere"));
-		break;
-	}
-	case PrimitiveType::PLANE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::planeMesh(mesh, { _dimensions.x, _dimensions.y }, { (int)_subdivision.x, (int)_subdivision.y })) // 2xsize, 2xsegments
-			buildPrimitiveMesh(this, mesh, MTEXT("Plane"));
-		break;
-	}
-	case PrimitiveType::ROUNDED_BOX:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::roundedBoxMesh(mesh, _dimensions.w, { _dimensions.x, _dimensions.y, _dimensions.z }, _subdivision.w, { (int)_subdivision.x, (int)_subdivision.y, (int)_subdivision.z })) // radius, 3xsize, slices, 3xsegments
-			buildPrimitiveMesh(this, mesh, MTEXT("Rounded box"));
-		break;
-	}
-	case PrimitiveType::SPHERICAL_CONE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::sphericalConeMesh(mesh, _dimensions.x, _dimensions.y, _subdivision.x, _subdivision.y, _subdivision.z)) // radius, size, slices, segments, rings
-			buildPrimitiveMesh(this, mesh, MTEXT("Spherical cone"));
-		break;
-	}
-	case PrimitiveType::SPHEREICAL_TRIANGLE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::sphericalTriangleMesh(mesh, _dimensions.x, _subdivision.x)) // radius, segments (3xpoints, segments)
-			buildPrimitiveMesh(this, mesh, MTEXT("Spherical triangle"));
-		break;
-	}
-	case PrimitiveType::SPRING:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::springMesh(mesh, _dimensions.y, _dimensions.x, _dimensions.z, _subdivision.x, _subdivision.y)) // minor, major, size, slice, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Spring"));
-		break;
-	}
-	case PrimitiveType::TEAPOT:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::teapotMesh(mesh, _dimensions.x, _subdivision.x)) // segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Teapot"));
-		break;
-	}
-	case PrimitiveType::TORUS_KNOT:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::torusKnotMesh(mesh, _subdivision.w, _subdivision.z, _subdivision.x, _subdivision.y)) // p, q, slices, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Torus knot"));
-		break;
-	}
-	case PrimitiveType::TRIANGLE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::triangleMesh(mesh, _dimensions.x, _subdivision.x)) // radius, segments (3xpoints, segments)
-			buildPrimitiveMesh(this, mesh, MTEXT("Triangle"));
-		break;
-	}
-	case PrimitiveType::TUBE:
-	{
-		prim::Mesh mesh;
-		if (prim::Primitives::tubeMesh(mesh, _dimensions.x, _dimensions.y, _dimensions.z, _subdivision.x, _subdivision.y)) // radius, innerRadius, size, slices, segments
-			buildPrimitiveMesh(this, mesh, MTEXT("Tube"));
-		break;
-	}
 	case PrimitiveType::GEOMERTYLESS_POINTLIST:
 	{
 		GeometrySubset ss;
@@ -396,6 +366,7 @@ void Primitive::CreateDeviceObjects()
 	}
 	break;
 	default:
+		_addPrimitiveMesh();
 		break;
 	};
 
@@ -101,6 +101,9 @@ protected:
 	XMFLOAT4X4 _transform = XMFLOAT4X4(1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 	PrimitiveFlags _flags = PrimitiveFlags::NORMALS | PrimitiveFlags::TEXCOORDS | PrimitiveFlags::TANGENTS;
 
+	// Adds the mesh of a type generated by the Primitives library, shared with identical primitives through the PrimitiveCache.
+	bool _addPrimitiveMesh();
+
 	void _generateSphere(uint32 subdivU, uint32& indexBase, CXMMATRIX m);
 
 	void _generateSquare(uint32 subdivU, uint32 subdivV, uint32& indexBase, CXMMATRIX m);
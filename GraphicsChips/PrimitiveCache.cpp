@@ -0,0 +1,104 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "PrimitiveCache.h"
+
+using namespace m3d;
+
+
+size_t PrimitiveMeshData::GetByteSize() const
+{
+	return (positions.size() + normals.size() + tangents.size() + bitangents.size()) * sizeof(XMFLOAT3) + texcoords.size() * sizeof(XMFLOAT2) + indices.size() * sizeof(UINT);
+}
+
+
+PrimitiveCache::PrimitiveCache() : _capacity(64 * 1024 * 1024), _size(0), _useCounter(0), _hits(0), _misses(0)
+{
+}
+
+PrimitiveCache::~PrimitiveCache()
+{
+}
+
+PrimitiveCache &PrimitiveCache::GetInstance()
+{
+	static PrimitiveCache instance;
+	return instance;
+}
+
+PrimitiveMeshPtr PrimitiveCache::Get(const Key &key, const std::function<bool(PrimitiveMeshData&)> &generate)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		auto itr = _entries.find(key);
+		if (itr != _entries.end()) {
+			itr->second.lastUse = ++_useCounter;
+			_hits++;
+			return itr->second.mesh;
+		}
+		_misses++;
+	}
+
+	std::shared_ptr<PrimitiveMeshData> mesh = std::make_shared<PrimitiveMeshData>();
+	if (!generate(*mesh))
+		return nullptr;
+
+	std::lock_guard<std::mutex> lock(_lock);
+	Entry &e = _entries[key];
+	if (e.mesh)
+		return e.mesh; // Generated by another thread meanwhile.
+	e.mesh = mesh;
+	e.size = mesh->GetByteSize();
+	e.lastUse = ++_useCounter;
+	_size += e.size;
+	_evict();
+	return mesh; // Still valid if evicted right away (larger than the capacity).
+}
+
+void PrimitiveCache::SetCapacity(size_t bytes)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_capacity = bytes;
+	_evict();
+}
+
+void PrimitiveCache::Clear()
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_entries.clear();
+	_size = 0;
+}
+
+void PrimitiveCache::_evict()
+{
+	while (_size > _capacity && !_entries.empty()) {
+		auto lru = _entries.begin();
+		for (auto itr = _entries.begin(); itr != _entries.end(); itr++)
+			if (itr->second.lastUse < lru->second.lastUse)
+				lru = itr;
+		_size -= lru->second.size;
+		_entries.erase(lru);
+	}
+}
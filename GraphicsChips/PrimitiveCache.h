@@ -0,0 +1,109 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "M3DCore/MMath.h"
+#include "M3DCore/Containers.h"
+#include <mutex>
+#include <memory>
+#include <functional>
+#include <cstring>
+
+namespace m3d
+{
+
+// Vertex and index data of a generated primitive, before the transform of the Primitive chip is applied.
+// Streams not generated are empty.
+struct PrimitiveMeshData
+{
+	List<XMFLOAT3> positions;
+	List<XMFLOAT3> normals;
+	List<XMFLOAT2> texcoords;
+	List<XMFLOAT3> tangents;
+	List<XMFLOAT3> bitangents;
+	List<UINT> indices; // Triangle list.
+
+	size_t GetByteSize() const;
+};
+
+typedef std::shared_ptr<const PrimitiveMeshData> PrimitiveMeshPtr;
+
+// Process wide cache of generated primitive meshes, keyed by primitive type, parameters and generated streams.
+// Identical primitives share one mesh, so it is generated once instead of for each chip and each load.
+// Least recently used meshes are evicted when the total size exceeds the capacity.
+class GRAPHICSCHIPS_API PrimitiveCache
+{
+public:
+	struct Key
+	{
+		uint32 type;
+		XMUINT4 subdivision;
+		XMFLOAT4 dimensions;
+		uint32 flags;
+
+		bool operator<(const Key &rhs) const { return std::memcmp(this, &rhs, sizeof(Key)) < 0; }
+	};
+
+	PrimitiveCache();
+	~PrimitiveCache();
+
+	static PrimitiveCache &GetInstance();
+
+	// Returns the cached mesh for key, or calls generate(...) to create it. Returns null if generation fails.
+	// Generation happens outside the lock, so two threads may generate the same mesh. Only one is kept.
+	PrimitiveMeshPtr Get(const Key &key, const std::function<bool(PrimitiveMeshData&)> &generate);
+
+	// Max total size of the cached meshes in bytes. 0 disables caching.
+	size_t GetCapacity() const { return _capacity; }
+	void SetCapacity(size_t bytes);
+	// Total size of the cached meshes in bytes.
+	size_t GetSize() const { return _size; }
+
+	void Clear();
+
+	uint32 GetHitCount() const { return _hits; }
+	uint32 GetMissCount() const { return _misses; }
+
+private:
+	struct Entry
+	{
+		PrimitiveMeshPtr mesh;
+		size_t size;
+		uint64 lastUse;
+	};
+
+	mutable std::mutex _lock;
+	Map<Key, Entry> _entries;
+	size_t _capacity;
+	size_t _size;
+	uint64 _useCounter;
+	uint32 _hits;
+	uint32 _misses;
+
+	void _evict();
+};
+
+}
@@ -60,6 +60,8 @@ bool Renderable::CopyChip(Chip *chip)
 	B_RETURN(_3DObject::CopyChip(c));
 	_wholeObjectCulling = c->_wholeObjectCulling;
 	_subsetCulling = c->_subsetCulling;
+	_meshletCulling = c->_meshletCulling;
+	_meshletBackFaceCulling = c->_meshletBackFaceCulling;
 	_boundingBox = c->_boundingBox;
 	if (c->_subsets.empty())
 		MakeUniversal();
@@ -76,6 +78,8 @@ bool Renderable::LoadChip(DocumentLoader &loader)
 	B_RETURN(_3DObject::LoadChip(loader));
 	LOAD("useWholeObjectCulling|UseWholeObjectCulling", _wholeObjectCulling);
 	LOAD("useSubsetCulling|UseSubsetCulling", _subsetCulling);
+	LOADDEF("useMeshletCulling", _meshletCulling, true);
+	LOADDEF("useMeshletBackFaceCulling", _meshletBackFaceCulling, false);
 	LOAD("boundingBox|BoundingBox", _boundingBox);
 	List<std::pair<uint32, String>> subsets;
 	LOAD("subsets|Subsets", subsets);
@@ -100,6 +104,8 @@ bool Renderable::SaveChip(DocumentSaver &saver) const
 	B_RETURN(_3DObject::SaveChip(saver));
 	SAVE("useWholeObjectCulling", _wholeObjectCulling);
 	SAVE("useSubsetCulling", _subsetCulling);
+	SAVEDEF("useMeshletCulling", _meshletCulling, true);
+	SAVEDEF("useMeshletBackFaceCulling", _meshletBackFaceCulling, false);
 	SAVE("boundingBox", _boundingBox);
 	List<std::pair<uint32, String>> subsets;
 	if (!_subsets.empty()) {
@@ -117,6 +123,9 @@ bool Renderable::SaveChip(DocumentSaver &saver) const
 
 void Renderable::CallChip()
 {
+	if (!engine->GetGraphics()->CanRender())
+		return; // Null graphics engine. Nothing to render to.
+
 	try 
 	{
 		// Render without 3DObject using identity world matrix, imm. context and 1 instance.
@@ -177,9 +186,19 @@ void Renderable::Render(const XMFLOAT4X4 &parentMatrix, uint32 instanceCount, ui
 	bool subsetCulling = enableFrustumCulling && _subsetCulling && objIntersection == Frustum::INTERSECT;
 	bool specific = _subsets.size() > 0;
 
-	for (uint32 i = 0, j = specific ? (uint32)_subsets.size() : (uint32)chGeometry->GetSubsets().size(); i < j; i++) {
+	const GeometryLODList &lods = chGeometry->GetLODs();
+	const uint32 lod = lods.empty() ? 0 : _selectLOD(world, lods);
+	const GeometrySubsetList &subsets = chGeometry->GetLODSubsets(lod);
+
+	_meshletCullStats = MeshletCullStats();
+	bool meshletCulling = enableFrustumCulling && _meshletCulling && instanceCount == 1 && chGeometry->GetAPI() == DRAW_INDEXED;
+	XMFLOAT3 eye(0.0f, 0.0f, 0.0f);
+	if (meshletCulling && _meshletBackFaceCulling)
+		XMStoreFloat3(&eye, XMMatrixInverse(nullptr, XMLoadFloat4x4(&rs->GetViewMatrix())).r[3]);
+
+	for (uint32 i = 0, j = specific ? (uint32)_subsets.size() : (uint32)subsets.size(); i < j; i++) {
 		uint32 index = specific ? _subsets[i] : i;
-		if (index >= chGeometry->GetSubsets().size())
+		if (index >= subsets.size())
 			continue; // Invalid subset index
 
 		ChildPtr<Material> chMaterial = specific ? GetChild(FIRST_MATERIAL_CONNECTION + index) : GetChild(FIRST_MATERIAL_CONNECTION, index);
@@ -188,12 +207,14 @@ void Renderable::Render(const XMFLOAT4X4 &parentMatrix, uint32 instanceCount, ui
 			continue; // No material for this subset..
 		}
 
-		const GeometrySubset &ss = chGeometry->GetSubsets()[index];
+		const GeometrySubset &ss = subsets[index];
 
+		Frustum::Intersection ssIntersection = objIntersection;
 		if (subsetCulling) { // We also do culling by subset...
 			const AxisAlignedBox &localAABB = ss.boundingBox;
 			AxisAlignedBox aabb = localAABB * world;
-			if (rs->GetFrustum(0).Test(aabb, &(m3d::Frustum::PlaneId&)ss._cullingPlane) == Frustum::OUTSIDE)
+			ssIntersection = rs->GetFrustum(0).Test(aabb, &(m3d::Frustum::PlaneId&)ss._cullingPlane);
+			if (ssIntersection == Frustum::OUTSIDE)
 				continue; // This subset is outside the view frustum
 			if (g->IsRenderWorldSpaceAABB())
 				g->dg()->AddBox(XMMatrixIdentity(), aabb.GetMin(), aabb.GetMax(), WHITE);
@@ -201,6 +222,15 @@ void Renderable::Render(const XMFLOAT4X4 &parentMatrix, uint32 instanceCount, ui
 				g->dg()->AddBox(world, localAABB.GetMin(), localAABB.GetMax(), YELLOW);
 		}
 
+		bool drawMeshlets = meshletCulling && ss.meshlets.size() > 0;
+		if (drawMeshlets) { // ...and by meshlet. Only meshlets intersecting the frustum need testing if the subset is inside it.
+			_meshletDrawList.clear();
+			const Frustum *frustum = ssIntersection == Frustum::INSIDE ? nullptr : &rs->GetFrustum(0);
+			chGeometry->CullMeshlets(_meshletDrawList, index, lod, world, frustum, _meshletBackFaceCulling ? &eye : nullptr, &_meshletCullStats);
+			if (_meshletDrawList.empty())
+				continue; // All meshlets culled.
+		}
+
 		// Store current pipeline state (could have been set using GraphicsState::CallChip())
 		struct KeepPSO
 		{
@@ -226,6 +256,10 @@ void Renderable::Render(const XMFLOAT4X4 &parentMatrix, uint32 instanceCount, ui
 
 		if (chGeometry->GetAPI() == DRAW)
 			rs->DrawInstanced(ss.count, instanceCount, ss.startLocation + ss.baseVertexLocation, startInstanceLocation);
+		else if (drawMeshlets) {
+			for (const MeshletDrawRange &r : _meshletDrawList)
+				rs->DrawIndexedInstanced(r.indexCount, instanceCount, r.startIndex, ss.baseVertexLocation, startInstanceLocation);
+		}
 		else
 			rs->DrawIndexedInstanced(ss.count, instanceCount, ss.startLocation, ss.baseVertexLocation, startInstanceLocation);
 	}
@@ -27,6 +27,7 @@
 #include "M3DCore/Frustum.h"
 #include "M3DCore/AxisAlignedBox.h"
 #include "3DObject.h"
+#include "MeshOptimization.h"
 
 namespace m3d
 {
@@ -36,6 +37,8 @@ static const Guid RENDERABLE_GUID = { 0x5446a662, 0x18a8, 0x48e4, { 0xa2, 0x10,
 
 #define FIRST_MATERIAL_CONNECTION 2
 
+struct GeometryLOD;
+
 
 class GRAPHICSCHIPS_API Renderable : public _3DObject
 {
@@ -63,6 +66,17 @@ public:
 	bool IsUsingSubsetCulling() const { return _subsetCulling; }
 	void SetUseSubsetCulling(bool b) { _subsetCulling = b; }
 
+	// Get/Set use culling of the meshlets of the subsets (see StdGeometry::BuildMeshlets(...)). Only for single instances.
+	bool IsUsingMeshletCulling() const { return _meshletCulling; }
+	void SetUseMeshletCulling(bool b) { _meshletCulling = b; }
+
+	// Get/Set use back face culling of meshlets. Requires clockwise front faces and back face culling in the materials.
+	bool IsUsingMeshletBackFaceCulling() const { return _meshletBackFaceCulling; }
+	void SetUseMeshletBackFaceCulling(bool b) { _meshletBackFaceCulling = b; }
+
+	// Gets the meshlet culling results from the last time we were rendered.
+	const MeshletCullStats &GetMeshletCullStats() const { return _meshletCullStats; }
+
 	// Makes the renderable "universal" with growing material connections.
 	void MakeUniversal();
 	// Makes the renderable "specific" with the given subsets to draw. The string is the name of the subsets (only for convinience).
@@ -81,6 +95,10 @@ public:
 	// Calculate boundingbox from geometry.
 	void CalculateBoundingBox();
 
+protected:
+	// Selects the level of detail to draw given the levels of the geometry (not including the base mesh). 0 is the base mesh.
+	virtual uint32 _selectLOD(CXMMATRIX world, const List<GeometryLOD> &lods) { return 0; }
+
 private:
 	// This should be the bounding box for the subsets to draw. Can be calculated or set manually.
 	AxisAlignedBox _boundingBox; 
@@ -88,6 +106,14 @@ private:
 	bool _wholeObjectCulling = false;
 	// true if we are to cull each subset in the geometry.
 	bool _subsetCulling = true;
+	// true if we are to cull the meshlets of each subset, if any.
+	bool _meshletCulling = true;
+	// true if we are to also cull back facing meshlets.
+	bool _meshletBackFaceCulling = false;
+
+	// Meshlets to draw for the current subset. Kept to avoid allocations.
+	MeshletDrawList _meshletDrawList;
+	MeshletCullStats _meshletCullStats;
 
 	// Subsets to draw. If empty, we have generic growable material connections and should draw all subsets in the connected geometry.
 	// If not empty, each entry should have a material connection. The subsets are drawn in the order they appear in the list.
@@ -28,7 +28,11 @@
 #include <regex>
 #include "M3DEngine/DocumentSaveLoadUtil.h"
 #include "D3DSaveLoadUtil.h"
-#include "RenderSettings.h"
+#include "ShaderCache.h"
+#include "D3DShaderCompiler.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ClassManager.h"
+#include "M3DEngine/Class.h"
 
 using namespace m3d;
 
@@ -160,6 +164,7 @@ Shader::Shader()
 	_manualMode = true;
 	_compileFlags = 0;
 	_sm = ShaderModel::SM51;
+	_compiledKey = 0;
 }
 
 Shader::~Shader()
@@ -177,6 +182,7 @@ bool Shader::CopyChip(Chip* chip)
 	_source = c->_source;
 	_shader = c->_shader;
 	_messages = c->_messages;
+	_compiledKey = c->_compiledKey;
 	SetUpdateStamp();
 	return true;
 }
@@ -190,6 +196,7 @@ bool Shader::LoadChip(DocumentLoader& loader)
 	LOAD("shaderModel", _sm);
 	LOAD("sourceCode", _source);
 	LOAD("shader", _shader);
+	LOADDEF("compiledKey", _compiledKey, 0);
 	_messages.clear();
 	SetUpdateStamp();
 	return true;
@@ -204,6 +211,7 @@ bool Shader::SaveChip(DocumentSaver& saver) const
 	SAVE("shaderModel", _sm);
 	SAVE("sourceCode", _source);
 	SAVE("shader", _shader);
+	SAVEDEF("compiledKey", _compiledKey, 0);
 	return true;
 }
 
@@ -241,25 +249,6 @@ bool Shader::_validateInputParameters(const List<SignatureParameter>* outputPara
 	return true;
 }
 
-class ShaderInclude : public ID3DInclude
-{
-public:
-	ShaderInclude() {}
-	~ShaderInclude() {}
-
-	HRESULT Open(D3D_INCLUDE_TYPE IncludeType, LPCSTR pFileName, LPCVOID pParentData, LPCVOID* ppData, UINT* pBytes)
-	{
-		if (String("Std") == String(pFileName)) {
-			*ppData = STD_TEXT;
-			*pBytes = sizeof(STD_TEXT) - 1; // -1 to exclude final null.
-			return S_OK;
-		}
-		return E_FAIL;
-	}
-
-	HRESULT Close(LPCVOID pData) { return S_OK; }
-};
-
 bool _getTypeStr(const D3D12_SHADER_TYPE_DESC& tDesc, String& str)
 {
 	switch (tDesc.Type)
@@ -286,19 +275,43 @@ bool Shader::Compile()
 	SetUpdateStamp();
 
 	_shader = ShaderDesc();
+	_compiledKey = 0;
 
 	SetUpdateStamp();
 
-	ShaderDesc shader;
+	SID3DBlob byteCode;
 	String messages;
+	uint64 key = 0;
 
-	HRESULT hr = Compile(&shader.byteCode, _st, _sm, _compileFlags, _source, messages);
+	HRESULT hr = Compile(&byteCode, _st, _sm, _compileFlags, _source, messages, &key);
 
 	if (FAILED(hr)) {
 		_messages = messages;
 		return false;
 	}
 
+	if (!_setByteCode(byteCode, messages))
+		return false;
+
+	_compiledKey = key;
+	return true;
+}
+
+bool Shader::IsDirty()
+{
+	if (!_shader.byteCode || _compiledKey == 0)
+		return true;
+	ShaderCompileRequest request;
+	if (!GetCompileRequest(_st, _sm, _compileFlags, _source, request))
+		return true;
+	return GetShaderCache().GetKey(request) != _compiledKey;
+}
+
+bool Shader::_setByteCode(SID3DBlob byteCode, String messages)
+{
+	ShaderDesc shader;
+	shader.byteCode = byteCode;
+
 	_messages = "\n\nShader compiled, but an error happened during the shader reflection process! Most likely you are using syntax/features not supported by SnaX!";
 
 
@@ -483,21 +496,8 @@ bool Shader::Compile()
 
 }
 
-HRESULT Shader::Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compileFlags, String source, String& msg)
+bool Shader::GetCompileRequest(ShaderType st, ShaderModel sm, UINT compileFlags, String source, ShaderCompileRequest& request)
 {
-	msg.clear();
-
-	time_t now = time(NULL);
-	struct tm ts;
-	localtime_s(&ts, &now);
-	Char buf[64];
-	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &ts);
-
-	HighPrecisionTimer timer;
-	timer.Tick();
-
-	msg = strUtils::ConstructString("%1: Compiling...\n\n").arg(buf);
-
 	static const Mapping<ShaderType, uint32> ShaderIndex({ { ShaderType::VS, 0 },{ ShaderType::HS, 1 },{ ShaderType::DS, 2 },{ ShaderType::GS, 3 },{ ShaderType::PS, 4 },{ ShaderType::CS, 5 } }, 0);
 
 	const Char* profiles[7][6] =
@@ -515,46 +515,52 @@ HRESULT Shader::Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compi
 	static const Char* SHADER_STAGE_STR[6] = { "VS", "HS", "DS", "GS", "PS", "CS" };
 
 	const Char* profileStr = profiles[(uint32)sm][ShaderIndex[st]];
-	if (profileStr == nullptr) {
-		//msg += String(MTEXT("Error: %1 not supported for %2.\n")).arg(typeName[st]).arg(FROMQSTRING(ui.comboBox_profiles->currentText()));
-		msg += "Profile is not supported!\n";
-		return E_FAIL;
-	}
+	if (profileStr == nullptr)
+		return false;
 
-	List<D3D_SHADER_MACRO> macros;
+	request = ShaderCompileRequest();
+	request.source = String("#line 1 \"Main\"\n") + source;
+	request.entryPoint = "main";
+	request.profile = profileStr;
+	request.flags = compileFlags;
+	request.defines.push_back(std::make_pair("VERSION", SHADER_MODEL_STR[(uint32)sm]));
+	request.defines.push_back(std::make_pair(SHADER_STAGE_STR[ShaderIndex[st]], "1"));
+	if (compileFlags & D3DCOMPILE_DEBUG)
+		request.defines.push_back(std::make_pair("DEBUG", "1"));
+	return true;
+}
 
-	List<std::pair<String, String>> defines;
-	defines.push_back(std::make_pair("VERSION", SHADER_MODEL_STR[(uint32)sm]));
-	defines.push_back(std::make_pair(SHADER_STAGE_STR[ShaderIndex[st]], "1"));
+HRESULT Shader::Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compileFlags, String source, String& msg, uint64* key)
+{
+	msg.clear();
 
-	for (size_t i = 0; i < defines.size(); i++) {
-		D3D_SHADER_MACRO m = { defines[i].first.c_str(), defines[i].second.c_str() };
-		macros.push_back(m);
-	}
+	time_t now = time(NULL);
+	struct tm ts;
+	localtime_s(&ts, &now);
+	Char buf[64];
+	strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &ts);
 
-	if (compileFlags & D3DCOMPILE_DEBUG) {
-		D3D_SHADER_MACRO debugMacro = { "DEBUG", "1" };
-		macros.push_back(debugMacro);
-	}
+	HighPrecisionTimer timer;
+	timer.Tick();
 
-	D3D_SHADER_MACRO nullMacro = { nullptr, nullptr };
-	macros.push_back(nullMacro);
-
-	SID3DBlob errorMsgs;
-	/*
-	std::regex r("^(\\[.+\\]\\n)+"/*, std::regex_constants::ECMAScript | std::regex_constants::icase* /);
-	std::cmatch rmatch;
-	if (std::regex_search(_source.c_str(), _source.c_str() + _source.length(), rmatch, r)) {
-	for (size_t i = 0; i < rmatch.size(); i++) {
-	std::string fdf = rmatch.str(i);
-	int32 gg = 3;
-	}
+	msg = strUtils::ConstructString("%1: Compiling...\n\n").arg(buf);
+
+	ShaderCompileRequest request;
+	if (!GetCompileRequest(st, sm, compileFlags, source, request)) {
+		msg += "Profile is not supported!\n";
+		return E_FAIL;
 	}
-	*/
-	String src = String("#line 1 \"Main\"\n") + source;
 
-	ShaderInclude si;
-	HRESULT hr = D3DCompile2(src.c_str(), src.length(), nullptr, &macros.front(), &si, "main", profileStr, compileFlags, 0, 0, NULL, 0, bc, &errorMsgs);
+	// The cache returns the byte code directly if this shader was compiled before (also in an earlier session).
+	ShaderCompileResult result = GetShaderCache().Compile(request);
+
+	HRESULT hr = result.ok ? S_OK : E_FAIL;
+
+	if (SUCCEEDED(hr)) {
+		hr = D3DCreateBlob(result.byteCode.getBufferSize(), bc);
+		if (SUCCEEDED(hr))
+			std::memcpy((*bc)->GetBufferPointer(), result.byteCode.getConstBuffer(), result.byteCode.getBufferSize());
+	}
 
 	UINT instructionCount = 0;
 
@@ -568,14 +574,15 @@ HRESULT Shader::Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compi
 		}
 	}
 
-	if (errorMsgs)
-		msg += String((const Char*)errorMsgs->GetBufferPointer());
+	msg += result.messages;
 
 	timer.Tick();
 	int64 dt = timer.GetDt_us();
 
 	if (SUCCEEDED(hr)) {
-		msg += strUtils::ConstructString("Compile SUCCEEDED in %1 microseconds!\n\nShader is %2 instructions (%3 bytes) long.\n").arg(dt).arg(instructionCount).arg((*bc)->GetBufferSize());
+		msg += strUtils::ConstructString("Compile SUCCEEDED in %1 microseconds%4!\n\nShader is %2 instructions (%3 bytes) long.\n").arg(dt).arg(instructionCount).arg((*bc)->GetBufferSize()).arg(result.fromCache ? " (from shader cache)" : "");
+		if (key)
+			*key = result.key;
 	}
 	else {
 		msg += String("Compile FAILED!\n");
@@ -584,3 +591,101 @@ HRESULT Shader::Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compi
 	return hr;
 
 }
+
+uint32 Shader::CompileShaders(const List<Shader*>& shaders, bool dirtyOnly, uint32 threadCount)
+{
+	HighPrecisionTimer timer;
+	timer.Tick();
+
+	ShaderCache& cache = GetShaderCache();
+
+	List<Shader*> toCompile;
+	List<ShaderCompileRequest> requests;
+	for (Shader* n : shaders) {
+		ShaderCompileRequest request;
+		if (!GetCompileRequest(n->_st, n->_sm, n->_compileFlags, n->_source, request)) {
+			n->_shader = ShaderDesc();
+			n->_compiledKey = 0;
+			n->_messages = "Profile is not supported!\n";
+			n->SetUpdateStamp();
+			continue;
+		}
+		toCompile.push_back(n);
+		requests.push_back(request);
+	}
+
+	// The preprocessor runs in parallel too. The keys tells which shaders have changed.
+	List<uint64> keys = cache.GetKeys(requests, threadCount);
+
+	if (dirtyOnly) {
+		size_t j = 0;
+		for (size_t i = 0; i < toCompile.size(); i++) {
+			if (keys[i] != 0 && keys[i] == toCompile[i]->_compiledKey && toCompile[i]->_shader.byteCode)
+				continue;
+			toCompile[j] = toCompile[i];
+			requests[j] = std::move(requests[i]);
+			keys[j++] = keys[i];
+		}
+		toCompile.resize(j);
+		requests.resize(j);
+		keys.resize(j);
+	}
+
+	List<ShaderCompileResult> results = cache.CompileBatch(requests, threadCount, &keys);
+
+	// Reflection registers buffer layouts, and is done here, on the calling thread.
+	uint32 count = 0, cached = 0;
+	for (size_t i = 0; i < toCompile.size(); i++) {
+		Shader* n = toCompile[i];
+		const ShaderCompileResult& r = results[i];
+		n->_shader = ShaderDesc();
+		n->_compiledKey = 0;
+		n->SetUpdateStamp();
+		if (!r.ok) {
+			n->_messages = r.messages + String("Compile FAILED!\n");
+			continue;
+		}
+		SID3DBlob bc;
+		if (FAILED(D3DCreateBlob(r.byteCode.getBufferSize(), &bc)))
+			continue;
+		std::memcpy(bc->GetBufferPointer(), r.byteCode.getConstBuffer(), r.byteCode.getBufferSize());
+		if (!n->_setByteCode(bc, r.messages + String(r.fromCache ? "Compile SUCCEEDED (from shader cache)!\n" : "Compile SUCCEEDED!\n")))
+			continue;
+		n->_compiledKey = r.key;
+		if (n->GetClass())
+			n->GetClass()->SetDirty(); // The byte code is saved with the class.
+		count++;
+		if (r.fromCache)
+			cached++;
+	}
+
+	timer.Tick();
+	if (!toCompile.empty())
+		msg(NOTICE, strUtils::ConstructString(MTEXT("Compiled %1 of %2 shaders (%3 from shader cache) in %4 ms.")).arg(count).arg((uint32)toCompile.size()).arg(cached).arg(timer.GetDt_us() / 1000));
+
+	return count;
+}
+
+uint32 Shader::CompileProjectShaders(bool dirtyOnly, uint32 threadCount)
+{
+	List<Shader*> shaders;
+	for (const auto& n : engine->GetClassManager()->GetClasssByName())
+		for (const auto& m : n.second->GetChips())
+			if (Shader* s = dynamic_cast<Shader*>(m.second))
+				shaders.push_back(s);
+	return CompileShaders(shaders, dirtyOnly, threadCount);
+}
+
+// %TEMP%\SnaX\ShaderCache. Empty (memory only) if there is no temp directory.
+std::filesystem::path _getShaderCacheDirectory()
+{
+	std::error_code ec;
+	std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+	return ec ? std::filesystem::path() : dir / MTEXT("SnaX") / MTEXT("ShaderCache");
+}
+
+ShaderCache& Shader::GetShaderCache()
+{
+	static ShaderCache cache(std::make_shared<D3DShaderCompiler>(), _getShaderCacheDirectory());
+	return cache;
+}
@@ -31,6 +31,9 @@
 namespace m3d
 {
 
+struct ShaderCompileRequest;
+class ShaderCache;
+
 static const Guid SHADER_GUID = { 0x7d2c71e9, 0x5b6d, 0x403f,{ 0x99, 0xeb, 0xf0, 0x2, 0xaf, 0x26, 0xe0, 0x9e } };
 
 
@@ -60,12 +63,23 @@ public:
 	virtual ShaderModel GetShaderModel() const { return _sm; }
 	virtual void SetShaderModel(ShaderModel sm) { _sm = sm; }
 
+	// Compiles the shader through the shader cache.
 	virtual bool Compile();
+	// true if the source, model, type or flags (or the included code) have changed since the shader was compiled. Runs the preprocessor!
+	virtual bool IsDirty();
 
 	virtual SID3DBlob GetByteCode() const { return _shader.byteCode; }
 	virtual void SetByteCode(SID3DBlob bc) { _shader.byteCode = bc; }
 
-	static HRESULT Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compileFlags, String source, String& msg);
+	static HRESULT Compile(ID3DBlob** bc, ShaderType st, ShaderModel sm, UINT compileFlags, String source, String& msg, uint64* key = nullptr);
+	// Creates the request for the shader compiler. Returns false if the profile is not supported.
+	static bool GetCompileRequest(ShaderType st, ShaderModel sm, UINT compileFlags, String source, ShaderCompileRequest& request);
+	// Compiles the given shaders in parallel. Only shaders that are dirty if dirtyOnly. Returns the number of shaders compiled successfully. Call from the main thread.
+	static uint32 CompileShaders(const List<Shader*>& shaders, bool dirtyOnly = true, uint32 threadCount = 0);
+	// Compiles the shaders in all loaded classes. See CompileShaders().
+	static uint32 CompileProjectShaders(bool dirtyOnly = true, uint32 threadCount = 0);
+	// The cache used by the shader chips. Uses the D3D compiler and stores files in %TEMP%\SnaX\ShaderCache.
+	static ShaderCache& GetShaderCache();
 
 	String GetCompileMessages() const { return _messages; }
 	void SetCompileMessages(String msg) { _messages = msg; }
@@ -82,7 +96,10 @@ protected:
 
 	String _messages;
 	ShaderDesc _shader;
+	// Shader cache key of the source _shader was compiled from. 0 if unknown.
+	uint64 _compiledKey;
 
+	bool _setByteCode(SID3DBlob byteCode, String messages);
 	bool _validateInputParameters(const List<SignatureParameter>* outputParametersFromPrevStage);
 };
 
@@ -0,0 +1,189 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "ShaderCache.h"
+#include "M3DCore/ThreadPool.h"
+#include <cstring>
+
+using namespace m3d;
+
+
+// Cache files hold the byte code size (uint32), the byte code and the messages.
+static const uint32 CACHE_FILE_MAGIC = 0x43535853; // "SXSC"
+static const uint32 CACHE_FILE_VERSION = 2;
+
+
+ShaderCache::ShaderCache(std::shared_ptr<ShaderCompiler> compiler, std::filesystem::path directory) : _compiler(compiler), _disk(directory, MTEXT(".sxsc"), CACHE_FILE_MAGIC, CACHE_FILE_VERSION), _hits(0), _misses(0)
+{
+}
+
+ShaderCache::~ShaderCache()
+{
+}
+
+uint64 ShaderCache::GetKey(const ShaderCompileRequest &request, String *messages)
+{
+	String preprocessed, msg;
+	if (!_compiler->Preprocess(request, preprocessed, msg)) {
+		if (messages)
+			*messages = msg;
+		return 0;
+	}
+
+	// Everything that affects the byte code. The source name is not included, as it only shows up in messages.
+	String s = _compiler->GetIdentity() + MTEXT("\n") + request.profile + MTEXT("\n") + request.entryPoint + MTEXT("\n") + String(std::to_string(request.flags)) + MTEXT("\n");
+	for (const auto &n : request.defines)
+		s += n.first + MTEXT("=") + n.second + MTEXT("\n");
+	s += preprocessed;
+
+	uint64 key = DataBuffer::hash((const uint8*)s.c_str(), s.size() * sizeof(Char));
+	return key != 0 ? key : 1; // 0 is reserved for failures.
+}
+
+List<uint64> ShaderCache::GetKeys(const List<ShaderCompileRequest> &requests, uint32 threadCount)
+{
+	List<uint64> keys(requests.size(), 0);
+	ThreadPool::GetShared().ParallelFor((uint32)requests.size(), [&](uint32 i) { keys[i] = GetKey(requests[i]); }, threadCount);
+	return keys;
+}
+
+bool ShaderCache::_find(uint64 key, ShaderCompileResult &result)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		auto itr = _entries.find(key);
+		if (itr != _entries.end()) {
+			result.byteCode = itr->second.byteCode;
+			result.messages = itr->second.messages;
+			return true;
+		}
+	}
+
+	List<uint8> data;
+	uint32 byteCodeSize;
+	if (!_disk.Read(key, data) || data.size() < sizeof(uint32))
+		return false;
+	std::memcpy(&byteCodeSize, data.data(), sizeof(uint32));
+	if (byteCodeSize == 0 || byteCodeSize > data.size() - sizeof(uint32) || (data.size() - sizeof(uint32) - byteCodeSize) % sizeof(Char) != 0)
+		return false; // Damaged. It is overwritten when compiled again.
+	const uint8 *p = data.data() + sizeof(uint32);
+
+	Entry e;
+	e.byteCode = DataBuffer::createShared(p, byteCodeSize);
+	e.messages = String((const Char*)(p + byteCodeSize), (data.size() - sizeof(uint32) - byteCodeSize) / sizeof(Char));
+
+	result.byteCode = e.byteCode;
+	result.messages = e.messages;
+
+	std::lock_guard<std::mutex> lock(_lock);
+	_entries.insert(std::make_pair(key, std::move(e)));
+	return true;
+}
+
+void ShaderCache::_store(uint64 key, const ShaderCompileResult &result)
+{
+	Entry e;
+	e.byteCode = DataBuffer::createShared(result.byteCode.getConstBuffer(), result.byteCode.getBufferSize());
+	e.messages = result.messages;
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_entries[key] = e;
+	}
+
+	if (_disk.GetDirectory().empty())
+		return;
+	uint32 byteCodeSize = (uint32)e.byteCode.getBufferSize();
+	size_t messagesSize = e.messages.size() * sizeof(Char);
+	List<uint8> data(sizeof(uint32) + byteCodeSize + messagesSize);
+	std::memcpy(data.data(), &byteCodeSize, sizeof(uint32));
+	std::memcpy(data.data() + sizeof(uint32), e.byteCode.getConstBuffer(), byteCodeSize);
+	if (messagesSize)
+		std::memcpy(data.data() + sizeof(uint32) + byteCodeSize, e.messages.c_str(), messagesSize);
+	_disk.Write(key, data.data(), data.size());
+}
+
+ShaderCompileResult ShaderCache::_compile(const ShaderCompileRequest &request, uint64 key)
+{
+	ShaderCompileResult r;
+	r.key = key;
+	if (key == 0) {
+		GetKey(request, &r.messages); // Get the preprocessor messages.
+		return r;
+	}
+	if (_find(key, r)) {
+		_hits++;
+		r.ok = true;
+		r.fromCache = true;
+		return r;
+	}
+	_misses++;
+	r.ok = _compiler->Compile(request, r.byteCode, r.messages);
+	if (r.ok)
+		_store(key, r); // Only successful compilations are stored.
+	return r;
+}
+
+ShaderCompileResult ShaderCache::Compile(const ShaderCompileRequest &request)
+{
+	return _compile(request, GetKey(request));
+}
+
+List<ShaderCompileResult> ShaderCache::CompileBatch(const List<ShaderCompileRequest> &requests, uint32 threadCount, const List<uint64> *keys)
+{
+	List<uint64> k = keys && keys->size() == requests.size() ? *keys : GetKeys(requests, threadCount);
+
+	// Compile each key once only. Requests failing in the preprocessor are all "compiled", to get their messages.
+	List<uint32> unique;
+	Map<uint64, uint32> firstByKey;
+	for (uint32 i = 0; i < (uint32)requests.size(); i++)
+		if (k[i] == 0 || firstByKey.insert(std::make_pair(k[i], i)).second)
+			unique.push_back(i);
+
+	List<ShaderCompileResult> results(requests.size());
+	ThreadPool::GetShared().ParallelFor((uint32)unique.size(), [&](uint32 i) { results[unique[i]] = _compile(requests[unique[i]], k[unique[i]]); }, threadCount);
+
+	for (uint32 i = 0; i < (uint32)requests.size(); i++) {
+		if (k[i] == 0)
+			continue;
+		uint32 first = firstByKey[k[i]];
+		if (first != i) {
+			results[i] = results[first];
+			results[i].fromCache = true;
+		}
+	}
+
+	return results;
+}
+
+void ShaderCache::Clear(bool includeDisk)
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_entries.clear();
+	}
+	_hits = 0;
+	_misses = 0;
+	if (includeDisk)
+		_disk.Clear();
+}
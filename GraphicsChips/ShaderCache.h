@@ -0,0 +1,86 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "ShaderCompiler.h"
+#include "M3DCore/DiskCache.h"
+#include <filesystem>
+#include <mutex>
+#include <atomic>
+#include <memory>
+
+namespace m3d
+{
+
+// Compiled shaders by a hash of the preprocessed source, profile, defines, flags and compiler identity.
+// Entries are kept in memory and, if a directory is set, on disk, so they survive restarts.
+class GRAPHICSCHIPS_API ShaderCache
+{
+public:
+	ShaderCache(std::shared_ptr<ShaderCompiler> compiler, std::filesystem::path directory = std::filesystem::path());
+	~ShaderCache();
+
+	ShaderCompiler *GetCompiler() const { return _compiler.get(); }
+
+	// Directory for the persistent cache. Empty to keep entries in memory only.
+	const std::filesystem::path &GetDirectory() const { return _disk.GetDirectory(); }
+	void SetDirectory(std::filesystem::path directory) { _disk.SetDirectory(directory); }
+
+	// Returns the cache key of the request. Runs the preprocessor! Returns 0 if preprocessing fails.
+	uint64 GetKey(const ShaderCompileRequest &request, String *messages = nullptr);
+	// Returns the keys of all requests. The preprocessor is run on threadCount threads (0 for all hardware threads).
+	List<uint64> GetKeys(const List<ShaderCompileRequest> &requests, uint32 threadCount = 0);
+
+	// Returns the cached result, or compiles and stores it.
+	ShaderCompileResult Compile(const ShaderCompileRequest &request);
+	// Compiles all requests on threadCount threads (0 for all hardware threads). Requests with equal keys are compiled once.
+	// keys may be given if already found using GetKeys(). The results are in the same order as the requests.
+	List<ShaderCompileResult> CompileBatch(const List<ShaderCompileRequest> &requests, uint32 threadCount = 0, const List<uint64> *keys = nullptr);
+
+	// Removes all entries from memory, and if includeDisk, the files in the cache directory.
+	void Clear(bool includeDisk = false);
+
+	uint32 GetHitCount() const { return _hits; }
+	uint32 GetMissCount() const { return _misses; }
+
+private:
+	struct Entry
+	{
+		DataBuffer byteCode;
+		String messages;
+	};
+
+	std::shared_ptr<ShaderCompiler> _compiler;
+	DiskCache _disk;
+	std::mutex _lock;
+	Map<uint64, Entry> _entries;
+	std::atomic<uint32> _hits;
+	std::atomic<uint32> _misses;
+
+	bool _find(uint64 key, ShaderCompileResult &result);
+	void _store(uint64 key, const ShaderCompileResult &result);
+	ShaderCompileResult _compile(const ShaderCompileRequest &request, uint64 key);
+};
+
+}
@@ -0,0 +1,67 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Exports.h"
+#include "M3DCore/MString.h"
+#include "M3DCore/Containers.h"
+#include "M3DCore/DataBuffer.h"
+
+namespace m3d
+{
+
+// Everything needed to compile a shader. Not tied to D3D, so the cache and scheduling can be used with any compiler.
+struct ShaderCompileRequest
+{
+	String source;
+	String entryPoint = MTEXT("main");
+	String profile; // eg "ps_5_1"
+	List<std::pair<String, String>> defines;
+	uint32 flags = 0; // Compiler specific flags (D3DCOMPILE_*).
+};
+
+struct ShaderCompileResult
+{
+	bool ok = false;
+	bool fromCache = false; // true if no compilation was needed.
+	uint64 key = 0; // Cache key. 0 if preprocessing failed.
+	DataBuffer byteCode;
+	String messages; // Warnings and errors from the compiler.
+};
+
+// Interface for a shader compiler. Implementations must be thread safe.
+class GRAPHICSCHIPS_API ShaderCompiler
+{
+public:
+	virtual ~ShaderCompiler() {}
+
+	// Identifies the compiler and its version. Part of the cache key, so that changing compiler invalidates the cache.
+	virtual String GetIdentity() const = 0;
+	// Runs the preprocessor only. Includes and macros are expanded, so the result identifies the shader.
+	virtual bool Preprocess(const ShaderCompileRequest &request, String &preprocessed, String &messages) = 0;
+	// Compiles the request to byte code.
+	virtual bool Compile(const ShaderCompileRequest &request, DataBuffer &byteCode, String &messages) = 0;
+};
+
+}
@@ -107,6 +107,7 @@ namespace m3d
 
 Skeleton::Skeleton()
 {
+	_compiledDirty = true;
 }
 
 Skeleton::~Skeleton()
@@ -119,6 +120,7 @@ bool Skeleton::CopyChip(Chip *chip)
 	B_RETURN(Chip::CopyChip(c));
 	_root = c->_root;
 	_animations = c->_animations;
+	_compiledDirty = true;
 	return true;
 }
 
@@ -127,6 +129,7 @@ bool Skeleton::LoadChip(DocumentLoader &loader)
 	B_RETURN(Chip::LoadChip(loader));
 	LOAD("joints", _root);
 	LOAD("animations", _animations);
+	_compiledDirty = true;
 	return true;
 }
 
@@ -142,11 +145,13 @@ Skeleton::Animation *Skeleton::AddAnimation(String name)
 {
 	if (_animations.find(name) != _animations.end())
 		return nullptr;
+	_compiledDirty = true;
 	return &_animations.insert(std::make_pair(name, Animation())).first->second;
 }
 
 bool Skeleton::RemoveAnimation(String name)
 {
+	_compiledDirty = true;
 	return _animations.erase(name) == 1;
 }
 
@@ -164,6 +169,7 @@ bool Skeleton::RenameAnimation(String oldName, String newName)
 	a.priority = n->second.priority;
 	a.keyframes = std::move(n->second.keyframes);
 	_animations.erase(n);
+	_compiledDirty = true;
 	return true;
 }
 
@@ -172,6 +178,7 @@ Skeleton::Animation *Skeleton::GetAnimation(String name)
 	auto n = _animations.find(name);
 	if (n == _animations.end())
 		return nullptr;
+	_compiledDirty = true; // Caller may modify the animation.
 	return &n->second;
 }
 
@@ -185,152 +192,304 @@ float32 Skeleton::CalculateAnimationDuration(Animation* animation)
 	return animation->duration;
 }
 
-void Skeleton::UpdateSkinningMatrices(const ActiveAnimationSet &animations, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex, List<XMFLOAT4X4>* worldMatrices)
+void __flattenJoints(const Skeleton::Joint &joint, uint32 parent, List<const Skeleton::Joint*> &joints, List<uint32> &parents)
 {
-	return _updateSkinningMatrices(_root, XMMatrixIdentity(), animations, skinningMatrices, firstIndex, worldMatrices);
+	uint32 self = (uint32)joints.size();
+	joints.push_back(&joint);
+	parents.push_back(parent);
+	for (size_t i = 0; i < joint.children.size(); i++)
+		__flattenJoints(joint.children[i], self, joints, parents);
 }
 
-
-struct WeightedTransform : public Skeleton::Transform
+void Skeleton::CompileAnimations()
 {
-	float32 weight;
-	WeightedTransform(Transform t, float32 weight) : Transform(t), weight(weight) {}
-};
+	if (!_compiledDirty)
+		return;
+
+	_compiledClips.clear();
+	_flat = FlatSkeleton();
+
+	List<const Joint*> joints; // Depth-first order. Parents are always before their children. This is the order used for the tracks.
+	__flattenJoints(_root, uint32(-1), joints, _flat.parents);
+
+	for (size_t i = 0; i < joints.size(); i++) {
+		const Joint &j = *joints[i];
+		_flat.names.push_back(j.name);
+		_flat.indices.push_back(j.index);
+		_flat.jointTransforms.push_back(j.jointTransform);
+		_flat.inverseBindPoses.push_back(j.inverseBindPose);
+		XMFLOAT4X4 bindPose;
+		XMStoreFloat4x4(&bindPose, XMMatrixInverse(nullptr, XMLoadFloat4x4(&j.inverseBindPose)));
+		_flat.bindPoses.push_back(bindPose);
+		if (j.index != -1)
+			_flat.maxIndex = std::max(_flat.maxIndex, j.index);
+	}
 
+	// Children are always after their parents, so walk backwards to propagate heights upwards.
+	_flat.heights.resize(joints.size(), 0);
+	for (size_t i = joints.size(); i-- > 0;) {
+		uint32 p = _flat.parents[i];
+		if (p != -1)
+			_flat.heights[p] = std::max(_flat.heights[p], _flat.heights[i] + 1);
+	}
 
+	for (const auto &n : _animations) {
+		CompiledClip &c = _compiledClips[&n.second];
+		c.tracks.resize(joints.size(), { 0, 0 });
+		for (size_t i = 0; i < joints.size(); i++) {
+			auto m = n.second.keyframes.find(joints[i]->name);
+			if (m == n.second.keyframes.end() || m->second.empty())
+				continue; // This animation does not affect this joint!
+
+			KeyframeList kf = m->second;
+			std::stable_sort(kf.begin(), kf.end(), [](const Keyframe &a, const Keyframe &b) { return a.time < b.time; }); // Binary search needs them sorted.
 
-Skeleton::Transform _interpolateTransform(const Skeleton::Transform &t0, const Skeleton::Transform &t1, float32 d)
+			c.tracks[i].first = (uint32)c.times.size();
+			c.tracks[i].count = (uint32)kf.size();
+			for (size_t j = 0; j < kf.size(); j++) {
+				c.times.push_back(kf[j].time);
+				c.positions.push_back(kf[j].position);
+				c.rotations.push_back(kf[j].rotation);
+				c.scalings.push_back(kf[j].scaling);
+			}
+		}
+	}
+
+	_compiledDirty = false;
+}
+
+const Skeleton::CompiledClip *Skeleton::GetCompiledClip(const Animation *animation) const
 {
-	Skeleton::Transform t;
-	XMStoreFloat3(&t.position, XMVectorLerp(XMLoadFloat3(&t0.position), XMLoadFloat3(&t1.position), d));
-	XMStoreFloat4(&t.rotation, XMQuaternionSlerp(XMLoadFloat4(&t0.rotation), XMLoadFloat4(&t1.rotation), d));
-	XMStoreFloat3(&t.scaling, XMVectorLerp(XMLoadFloat3(&t0.scaling), XMLoadFloat3(&t1.scaling), d));
-	return t;
+	auto n = _compiledClips.find(animation);
+	return n != _compiledClips.end() ? &n->second : nullptr;
 }
 
-Skeleton::Transform _interpolateTransforms(const List<WeightedTransform> &transforms, size_t i)
+
+// A pose for all joints of a skeleton, stored as arrays for SIMD-friendly processing.
+struct PoseBuffer
 {
-	if (transforms[i].weight > 0.999f || i == 0)
-		return transforms[i];
-	return _interpolateTransform(_interpolateTransforms(transforms, i - 1), transforms[i], transforms[i].weight);
+	List<XMVECTOR> positions;
+	List<XMVECTOR> rotations;
+	List<XMVECTOR> scalings;
+	List<float32> weights;
+
+	void Resize(size_t n)
+	{
+		positions.resize(n);
+		rotations.resize(n);
+		scalings.resize(n);
+		weights.resize(n);
+	}
 };
 
-Skeleton::Transform _interpolateKeyframes(const Skeleton::KeyframeList &kf, float32 t)
+// Scratch buffers used when evaluating a skeleton. One set per thread, so that skeletons can be evaluated in parallel without allocations.
+struct SkeletonScratch
 {
-	if (kf.empty())
-		return Skeleton::Transform(); // should not happen!
-	
-	if (kf.size() == 1)
-		return kf.front();
-
-	size_t i = 0;
-	for (; i < kf.size(); i++)
-		if (kf[i].time > t)
-			break;
-
-	if (i == kf.size())
-		return kf.back();
-
-	if (i == 0) {
-		float32 d = t / kf.front().time;
-		return _interpolateTransform(kf.back(), kf.front(), d);
-	}
+	PoseBuffer sample; // Sampled pose for one clip. weight = 0 for joints not affected by the clip.
+	PoseBuffer layer; // Blended pose for the current priority layer. weight = sum of clip weights.
+	Skeleton::Pose pose; // Final blended pose, when the caller does not keep it.
+	List<float32> layerMax; // Max clip weight in current layer for each joint.
+	List<XMMATRIX> model; // Model space matrix for each joint.
+};
 
-	float32 d = (t - kf[i - 1].time) / (kf[i].time - kf[i - 1].time);
+static thread_local SkeletonScratch __scratch;
 
-	return _interpolateTransform(kf[i - 1], kf[i], d);
-}
 
-uint32 __findMaxIndex(const Skeleton::Joint& joint)
+// Samples the given track at time t. The cursor (if given) is the index of the first keyframe after t found by the last call.
+void _sampleTrack(const Skeleton::CompiledClip &c, const Skeleton::CompiledClip::Track &track, float32 t, uint32 *cursor, XMVECTOR &pos, XMVECTOR &rot, XMVECTOR &scl)
 {
-	uint32 n = joint.index != -1 ? joint.index : 0;
-	for (size_t i = 0; i < joint.children.size(); i++) {
-		uint32 nc = __findMaxIndex(joint.children[i]);
-		n = std::max(n, nc);
+	if (track.count == 1) {
+		pos = XMLoadFloat3(&c.positions[track.first]);
+		rot = XMLoadFloat4(&c.rotations[track.first]);
+		scl = XMLoadFloat3(&c.scalings[track.first]);
+		return;
 	}
-	return n;
-}
 
-void Skeleton::_updateSkinningMatrices(Joint &j, CXMMATRIX parentWorldMatrix, const ActiveAnimationSet &animations, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex, List<XMFLOAT4X4>* worldMatrices)
-{
-	Transform finalAnimatedTransform = j.jointTransform;
+	const float32 *times = &c.times[track.first];
+	const uint32 n = track.count;
+
+	// Is i the first keyframe with time > t?
+	auto isNext = [times, n, t](uint32 i) { return (i == n || times[i] > t) && (i == 0 || times[i - 1] <= t); };
+
+	uint32 i;
+	if (cursor && *cursor <= n && isNext(*cursor))
+		i = *cursor; // Same keyframe interval as last time.
+	else if (cursor && *cursor < n && isNext(*cursor + 1))
+		i = *cursor + 1; // Moved to next interval.
+	else
+		i = uint32(std::upper_bound(times, times + n, t) - times);
+
+	if (cursor)
+		*cursor = i;
+
+	if (i == n) {
+		uint32 k = track.first + n - 1;
+		pos = XMLoadFloat3(&c.positions[k]);
+		rot = XMLoadFloat4(&c.rotations[k]);
+		scl = XMLoadFloat3(&c.scalings[k]);
+		return;
+	}
 
-	struct WeightedAndPrioritizedTransform : public WeightedTransform
-	{
-		uint32 priority;
-		WeightedAndPrioritizedTransform(WeightedTransform t, uint32 priority) : WeightedTransform(t), priority(priority) {}
-	};
+	uint32 k0, k1;
+	float32 d;
+	if (i == 0) { // Interpolate from last keyframe.
+		k0 = track.first + n - 1;
+		k1 = track.first;
+		d = t / times[0];
+	}
+	else {
+		k0 = track.first + i - 1;
+		k1 = track.first + i;
+		d = (t - times[i - 1]) / (times[i] - times[i - 1]);
+	}
 
-	Transform t = { {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f, 1.0f}, {1.0f, 1.0f, 1.0f} };
+	pos = XMVectorLerp(XMLoadFloat3(&c.positions[k0]), XMLoadFloat3(&c.positions[k1]), d);
+	rot = XMQuaternionSlerp(XMLoadFloat4(&c.rotations[k0]), XMLoadFloat4(&c.rotations[k1]), d);
+	scl = XMVectorLerp(XMLoadFloat3(&c.scalings[k0]), XMLoadFloat3(&c.scalings[k1]), d);
+}
 
-	XMMATRIX worldMatrix;
+// Blends src into dst using weight d. d > 0.999 replaces dst.
+template<typename T>
+inline void _blend(T &dst, const PoseBuffer &src, size_t i, float32 d)
+{
+	if (d > 0.999f) {
+		dst.positions[i] = src.positions[i];
+		dst.rotations[i] = src.rotations[i];
+		dst.scalings[i] = src.scalings[i];
+	}
+	else {
+		dst.positions[i] = XMVectorLerp(dst.positions[i], src.positions[i], d);
+		dst.rotations[i] = XMQuaternionSlerp(dst.rotations[i], src.rotations[i], d);
+		dst.scalings[i] = XMVectorLerp(dst.scalings[i], src.scalings[i], d);
+	}
+}
 
-	if (animations.size()) {
-		List<WeightedAndPrioritizedTransform> transforms; // This contains list of transforms (one for each animation) after keyframe interpolation.
+void Skeleton::UpdateSkinningMatrices(const ActiveAnimationSet &animations, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex, List<XMFLOAT4X4>* worldMatrices, uint32 jointLOD)
+{
+	Pose &pose = __scratch.pose;
+	EvaluatePose(animations, pose, jointLOD);
+	UpdateSkinningMatrices(pose, skinningMatrices, firstIndex, worldMatrices);
+}
 
-		for (const auto &m : animations) { // Iterate all animations
-			auto n = m.animation->keyframes.find(j.name);
-			if (n == m.animation->keyframes.end())
-				continue; // This animation does not affect this joint!
-			if (n->second.empty())
-				continue; // No keyframes!
-			transforms.push_back(WeightedAndPrioritizedTransform(WeightedTransform(_interpolateKeyframes(n->second, (float32)m.time), (float32)m.weight), m.animation->priority));
+void Skeleton::EvaluatePose(const ActiveAnimationSet &animations, Pose &pose, uint32 jointLOD)
+{
+	CompileAnimations();
+
+	const size_t jointCount = _flat.parents.size();
+
+	pose.bindPose = true;
+
+	SkeletonScratch &s = __scratch;
+
+	// Stage 1 & 2: Sample clips and blend them, one priority layer at a time. Animations are ordered by priority low->high.
+	for (auto itr = animations.begin(); itr != animations.end(); ) {
+		if (pose.bindPose) {
+			// The joint transforms are the fallback for joints not affected by any animation.
+			pose.positions.resize(jointCount);
+			pose.rotations.resize(jointCount);
+			pose.scalings.resize(jointCount);
+			s.sample.Resize(jointCount);
+			s.layer.Resize(jointCount);
+			s.layerMax.resize(jointCount);
+			for (size_t i = 0; i < jointCount; i++) {
+				pose.positions[i] = XMLoadFloat3(&_flat.jointTransforms[i].position);
+				pose.rotations[i] = XMLoadFloat4(&_flat.jointTransforms[i].rotation);
+				pose.scalings[i] = XMLoadFloat3(&_flat.jointTransforms[i].scaling);
+			}
+			pose.bindPose = false;
 		}
 
-		List<WeightedTransform> vv; // This contains a transform for each priority.
-		vv.push_back(WeightedTransform(finalAnimatedTransform, 1.0f)); // <= This is the default fallback!
-
-		for (uint32 i = 0, j = 0; i < transforms.size(); i = j) { // Iterate transforms. NOTE: these are ordered by priority!
-			for (j = i + 1; j < transforms.size(); j++)
-				if (transforms[j].priority != transforms[i].priority)
-					break;
-			if (j - i > 1) { // More than one transform with this priority?
-				float32 sum = 0.0f;
-				float32 L = 0.0f;
-				List<WeightedTransform> v; // This list contains transforms of same priority ready to be interpolated based on their weight.
-				for (uint32 k = i; k < j; k++) {
-					sum += transforms[k].weight;
-					L = std::max(L, transforms[k].weight); // The highest weight will be used as the weight for this priority group.
-//					L += transforms[k].weight * transforms[k].weight;
-					v.push_back(WeightedTransform(transforms[k], transforms[k].weight / sum));
-				}
-				vv.push_back(WeightedTransform(_interpolateTransforms(v, v.size() - 1), L)); // L will weight this priority group with the rest.
-			}
-			else {
-				vv.push_back(transforms[i]);
+		uint32 priority = itr->animation->priority;
+
+		std::fill(s.layer.weights.begin(), s.layer.weights.end(), 0.0f);
+		std::fill(s.layerMax.begin(), s.layerMax.end(), 0.0f);
+
+		for (; itr != animations.end() && itr->animation->priority == priority; itr++) {
+			const CompiledClip *c = GetCompiledClip(itr->animation);
+			if (!c)
+				continue; // Not one of our animations!
+			if (itr->cursors)
+				itr->cursors->resize(jointCount, 0);
+			float32 w = (float32)itr->weight;
+			float32 t = (float32)itr->time;
+			for (size_t i = 0; i < jointCount; i++) {
+				const CompiledClip::Track &track = c->tracks[i];
+				if (track.count == 0)
+					continue; // This animation does not affect this joint!
+				if (_flat.heights[i] < jointLOD)
+					continue; // Masked by LOD.
+				_sampleTrack(*c, track, t, itr->cursors ? &itr->cursors->at(i) : nullptr, s.sample.positions[i], s.sample.rotations[i], s.sample.scalings[i]);
+				// Animations of same priority are interpolated based on their relative weights.
+				float32 sum = s.layer.weights[i] + w;
+				_blend(s.layer, s.sample, i, s.layer.weights[i] == 0.0f ? 1.0f : w / sum);
+				s.layer.weights[i] = sum;
+				s.layerMax[i] = std::max(s.layerMax[i], w); // The highest weight will be used as the weight for this priority layer.
 			}
 		}
 
-		// Calculate the final transform of all the animations. There is only one transform for each priority.
-		// If there are no animations, the default joint transform is used. (First index in vv)
-		t = _interpolateTransforms(vv, vv.size() - 1);
+		// Blend the layer with the lower priority layers.
+		for (size_t i = 0; i < jointCount; i++)
+			if (s.layer.weights[i] > 0.0f)
+				_blend(pose, s.layer, i, s.layerMax[i]);
+	}
+}
 
-		// Calculate matrix from animated transform.
-		worldMatrix = XMMatrixAffineTransformation(XMLoadFloat3(&t.scaling), XMVectorZero(), XMLoadFloat4(&t.rotation), XMLoadFloat3(&t.position));
-		worldMatrix *= parentWorldMatrix;
+void Skeleton::UpdateSkinningMatrices(const Pose &pose, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex, List<XMFLOAT4X4>* worldMatrices)
+{
+	CompileAnimations();
+
+	const size_t jointCount = _flat.parents.size();
+	if (jointCount == 0)
+		return;
+
+	if (skinningMatrices.size() < firstIndex + _flat.maxIndex + 1u)
+		skinningMatrices.resize(firstIndex + _flat.maxIndex + 1u);
+	if (worldMatrices && worldMatrices->size() < _flat.maxIndex + 1u)
+		worldMatrices->resize(_flat.maxIndex + 1u);
+
+	SkeletonScratch &s = __scratch;
+	s.model.resize(jointCount);
+
+	// Stage 3: Local -> model space. Parents are always before their children.
+	if (!pose.bindPose && pose.positions.size() == jointCount) {
+		for (size_t i = 0; i < jointCount; i++) {
+			XMMATRIX m = XMMatrixAffineTransformation(pose.scalings[i], XMVectorZero(), pose.rotations[i], pose.positions[i]);
+			uint32 p = _flat.parents[i];
+			s.model[i] = p != -1 ? XMMatrixMultiply(m, s.model[p]) : m;
+		}
 	}
 	else {
-		worldMatrix = XMMatrixInverse(nullptr, XMLoadFloat4x4(&j.inverseBindPose));
+		for (size_t i = 0; i < jointCount; i++)
+			s.model[i] = XMLoadFloat4x4(&_flat.bindPoses[i]);
+	}
+
+	// Stage 4: Skinning matrices.
+	for (size_t i = 0; i < jointCount; i++) {
+		uint32 index = _flat.indices[i];
+		if (index == -1)
+			continue; // Not in the matrix array.
+		XMStoreFloat4x4(&skinningMatrices[firstIndex + index], XMMatrixMultiply(XMLoadFloat4x4(&_flat.inverseBindPoses[i]), s.model[i]));
+		if (worldMatrices)
+			XMStoreFloat4x4(&(*worldMatrices)[index], s.model[i]);
 	}
+}
 
-	if (j.index != -1) { // Do we have an index into the matrix array?
-		XMFLOAT4X4 skinningMatrix;
-		XMStoreFloat4x4(&skinningMatrix, XMLoadFloat4x4(&j.inverseBindPose) * worldMatrix);
+void Skeleton::InterpolatePoses(const Pose &a, const Pose &b, float32 d, Pose &out)
+{
+	if (a.bindPose || b.bindPose || a.positions.size() != b.positions.size()) {
+		out = d < 0.5f ? a : b; // Can not interpolate to or from the bind pose.
+		return;
+	}
 
-		if (skinningMatrices.size() <= (j.index + firstIndex)) {
-			uint32 n = __findMaxIndex(_root);
-			skinningMatrices.resize(firstIndex + n + 1u);
-		}
-		if (worldMatrices) {
-			if (worldMatrices->size() <= j.index) {
-				uint32 n = __findMaxIndex(_root);
-				worldMatrices->resize(n + 1u);
-			}
-			XMStoreFloat4x4(&worldMatrices->at(j.index), worldMatrix);
-		}
+	const size_t jointCount = a.positions.size();
+	out.positions.resize(jointCount);
+	out.rotations.resize(jointCount);
+	out.scalings.resize(jointCount);
+	out.bindPose = false;
 
-		skinningMatrices[j.index] = skinningMatrix;
+	for (size_t i = 0; i < jointCount; i++) {
+		out.positions[i] = XMVectorLerp(a.positions[i], b.positions[i], d);
+		out.rotations[i] = XMQuaternionSlerp(a.rotations[i], b.rotations[i], d);
+		out.scalings[i] = XMVectorLerp(a.scalings[i], b.scalings[i], d);
 	}
-	for (size_t i = 0; i < j.children.size(); i++) // Iterate all subjoints
-		_updateSkinningMatrices(j.children[i], worldMatrix, animations, skinningMatrices, firstIndex, worldMatrices);  // Recursive!
 }
@@ -68,13 +68,56 @@ public:
 		Animation() : priority(0), multiplier(1.0f), duration(0.0f) {}
 	};
 
+	// An animation compiled for fast evaluation. Tracks are indexed by joint number (depth-first order of the joint hierarchy).
+	// Keyframes for all tracks are stored in separate arrays for time, position, rotation and scaling.
+	struct CompiledClip
+	{
+		struct Track
+		{
+			uint32 first; // Index of the first keyframe of this track.
+			uint32 count; // Number of keyframes. 0 if the animation does not affect the joint.
+		};
+
+		List<Track> tracks;
+		List<float32> times;
+		List<XMFLOAT3> positions;
+		List<XMFLOAT4> rotations;
+		List<XMFLOAT3> scalings;
+	};
+
+	// The joint hierarchy flattened into arrays. Parents are always before their children (depth-first order).
+	struct FlatSkeleton
+	{
+		List<uint32> parents; // Parent of each joint. -1 for the root.
+		List<String> names;
+		List<uint32> indices; // Joint::index of each joint.
+		List<Transform> jointTransforms;
+		List<XMFLOAT4X4> inverseBindPoses;
+		List<XMFLOAT4X4> bindPoses; // Inverse of inverseBindPose. Used when no animations are active.
+		List<uint32> heights; // Number of joints on the longest path down to a leaf. 0 for leaf joints. Used for joint LOD.
+		uint32 maxIndex = 0; // Max Joint::index.
+	};
+
+	// Local transform of each joint in depth-first order. This is the result of sampling and blending the active animations.
+	struct Pose
+	{
+		List<XMVECTOR> positions;
+		List<XMVECTOR> rotations;
+		List<XMVECTOR> scalings;
+		bool bindPose = true; // true if no animations were active. The bind pose is used instead of the local transforms.
+	};
+
+	// Keyframe cursor for each track of a compiled clip. Owned by the caller. Speeds up keyframe lookup when an animation is played forward.
+	typedef List<uint32> ClipCursors;
+
 	struct ActiveAnimation
 	{
 		const Animation *animation;
 		float64 weight;
 		float64 time;
+		ClipCursors *cursors; // Optional.
 
-		ActiveAnimation(const Animation *animation = nullptr, float64 weight = 0.0, float64 time = 0.0) : animation(animation), weight(weight), time(time) {}
+		ActiveAnimation(const Animation *animation = nullptr, float64 weight = 0.0, float64 time = 0.0, ClipCursors *cursors = nullptr) : animation(animation), weight(weight), time(time), cursors(cursors) {}
 
 		bool operator<(const ActiveAnimation &rhs) const { return animation->priority < rhs.animation->priority; }
 	};
@@ -92,7 +135,7 @@ public:
 	};
 	
 	// Returns the root joint which can be used to build the skeleton.
-	virtual Joint &GetRootJoint() { return _root; }
+	virtual Joint &GetRootJoint() { _compiledDirty = true; return _root; }
 	// Returns the map containing all animations ordered by name.
 	virtual const Map<String, Animation> &GetAnimations() const { return _animations; }
 	// Add an animation with the given name, and returns it. Returns null is exist.
@@ -105,17 +148,39 @@ public:
 	virtual Animation *GetAnimation(String name);
 	// Calculates the duration field using the keyframes for all joints.
 	virtual float32 CalculateAnimationDuration(Animation *animation);
-	// Updates the array of skinning matrices. NOTE: animations must be ordered by priority low->high.
-	virtual void UpdateSkinningMatrices(const ActiveAnimationSet &animations, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex = 0, List<XMFLOAT4X4>* worldMatrices = nullptr);
+	// Updates the array of skinning matrices. NOTE: animations must be ordered by priority low->high. See EvaluatePose() for jointLOD.
+	virtual void UpdateSkinningMatrices(const ActiveAnimationSet &animations, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex = 0, List<XMFLOAT4X4>* worldMatrices = nullptr, uint32 jointLOD = 0);
+	// Updates the array of skinning matrices from a pose evaluated earlier.
+	virtual void UpdateSkinningMatrices(const Pose &pose, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex = 0, List<XMFLOAT4X4>* worldMatrices = nullptr);
+	// Samples and blends the animations into pose. Joints with height (see FlatSkeleton) less than jointLOD are not animated, but keeps their joint transform.
+	virtual void EvaluatePose(const ActiveAnimationSet &animations, Pose &pose, uint32 jointLOD = 0);
+	// Interpolates between two poses of the same skeleton. d = 0 gives a, d = 1 gives b.
+	static void InterpolatePoses(const Pose &a, const Pose &b, float32 d, Pose &out);
 	// To be used by dialog's cancel function.
-	virtual void SetRootJoint(const Joint &j) { _root = j; }
-	virtual void SetAnimations(const Map<String, Animation> &a) { _animations = a; }
+	virtual void SetRootJoint(const Joint &j) { _root = j; _compiledDirty = true; }
+	virtual void SetAnimations(const Map<String, Animation> &a) { _animations = a; _compiledDirty = true; }
+	// Flattens the joint hierarchy and compiles all animations if joints or animations has changed. Called automatically by UpdateSkinningMatrices().
+	virtual void CompileAnimations();
+	// Returns the flattened joint hierarchy.
+	virtual const FlatSkeleton &GetFlatSkeleton() { CompileAnimations(); return _flat; }
+	// Returns the compiled version of the given animation, or nullptr if not found. CompileAnimations() must be called first.
+	virtual const CompiledClip *GetCompiledClip(const Animation *animation) const;
+	// Must be called if joints or animations are modified through a reference kept from earlier.
+	virtual void InvalidateCompiledAnimations() { _compiledDirty = true; }
+	// Number of joints in the hierarchy.
+	virtual uint32 GetJointCount() { CompileAnimations(); return (uint32)_flat.parents.size(); }
+	// Returns this. Worker threads must not call the skeleton through ChildPtr (the function stack is not thread safe).
+	virtual Skeleton *GetSkeleton() { return this; }
 protected:
 	Joint _root;
 	Map<String, Animation> _animations;
 
-	// Updates recursivly. NOTE: animations must be ordered by priority low->high.
-	void _updateSkinningMatrices(Joint &j, CXMMATRIX parentWorldMatrix, const ActiveAnimationSet &animations, List<XMFLOAT4X4> &skinningMatrices, uint32 firstIndex, List<XMFLOAT4X4>* worldMatrices);
+	// true if the compiled clips must be rebuilt.
+	bool _compiledDirty;
+	// The flattened joint hierarchy.
+	FlatSkeleton _flat;
+	// Compiled version of all animations.
+	UnorderedMap<const Animation*, CompiledClip> _compiledClips;
 };
 
 
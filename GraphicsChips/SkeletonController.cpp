@@ -23,8 +23,13 @@
 
 #include "pch.h"
 #include "SkeletonController.h"
+#include "Renderable.h"
+#include "Graphics.h"
+#include "RenderSettings.h"
 #include "M3DEngine/Engine.h"
+#include "M3DEngine/DocumentSaveLoadUtil.h"
 #include "StdChips/MatrixArray.h"
+#include "StdChips/MatrixChip.h"
 #include "StdChips/Value.h"
 
 using namespace m3d;
@@ -40,30 +45,58 @@ SkeletonController::SkeletonController()
 	CREATE_CHILD(2, MATRIXARRAY_GUID, false, DOWN, MTEXT("Skinning Matrix Array"));
 	CREATE_CHILD(3, VALUE_GUID, false, UP, MTEXT("First Index in Skinning Matrix Array"));
 	CREATE_CHILD(4, MATRIXARRAY_GUID, false, DOWN, MTEXT("World Matrix Array"));
+	CREATE_CHILD(5, RENDERABLE_GUID, false, UP, MTEXT("Renderable (Culling and LOD)"));
+	CREATE_CHILD(6, MATRIXCHIP_GUID, false, UP, MTEXT("World Matrix (Culling and LOD)"));
 }
 
 SkeletonController::~SkeletonController()
 {
 }
 
+bool SkeletonController::CopyChip(Chip *chip)
+{
+	SkeletonController *c = dynamic_cast<SkeletonController*>(chip);
+	B_RETURN(Chip::CopyChip(c));
+	SetLODSettings(c->_lod);
+	return true;
+}
+
+bool SkeletonController::LoadChip(DocumentLoader &loader)
+{
+	B_RETURN(Chip::LoadChip(loader));
+	LODSettings d;
+	LOADDEF("lodEnabled", _lod.enabled, d.enabled);
+	LOADDEF("lodCullInvisible", _lod.cullInvisible, d.cullInvisible);
+	LOADDEF("lodReducedRateDistance", _lod.reducedRateDistance, d.reducedRateDistance);
+	LOADDEF("lodReducedRateInterval", _lod.reducedRateInterval, d.reducedRateInterval);
+	LOADDEF("lodJointDistance", _lod.jointLODDistance, d.jointLODDistance);
+	LOADDEF("lodJointLevels", _lod.jointLODLevels, d.jointLODLevels);
+	_reducedRate = false;
+	return true;
+}
+
+bool SkeletonController::SaveChip(DocumentSaver &saver) const
+{
+	B_RETURN(Chip::SaveChip(saver));
+	LODSettings d;
+	SAVEDEF("lodEnabled", _lod.enabled, d.enabled);
+	SAVEDEF("lodCullInvisible", _lod.cullInvisible, d.cullInvisible);
+	SAVEDEF("lodReducedRateDistance", _lod.reducedRateDistance, d.reducedRateDistance);
+	SAVEDEF("lodReducedRateInterval", _lod.reducedRateInterval, d.reducedRateInterval);
+	SAVEDEF("lodJointDistance", _lod.jointLODDistance, d.jointLODDistance);
+	SAVEDEF("lodJointLevels", _lod.jointLODLevels, d.jointLODLevels);
+	return true;
+}
+
 void SkeletonController::CallChip()
 {
 	if (!Refresh)
 		return;
 
-	ChildPtr<Skeleton> ch0 = GetChild(0);
-	if (!ch0)
+	BatchItem item;
+	if (!PrepareBatchItem((float64)engine->GetAppTime() / 1000000.0, item))
 		return;
 
-	ChildPtr<Value> ch1 = GetChild(1);
-	float64 t = ch1 ? ch1->GetValue() : (float64)engine->GetAppTime() / 1000000.0;
-
-	const Map<String, Skeleton::Animation> &a = ch0->GetAnimations();
-
-	Skeleton::ActiveAnimationSet animations; // Active animations ordered by priority low-high.
-
-	_updateController(t, a, animations);
-
 	ChildPtr<MatrixArray> ch2 = GetChild(2);
 	if (!ch2)
 		return;
@@ -72,14 +105,133 @@ void SkeletonController::CallChip()
 
 	ChildPtr<Value> ch3 = GetChild(3);
 	uint32 firstIndex = ch3 ? (uint32)ch3->GetValue() : 0;
-	firstIndex = std::min(firstIndex, 0x00FFFFFFu); // Limit it to some "reasonable" value.
+	item.firstIndex = std::min(firstIndex, 0x00FFFFFFu); // Limit it to some "reasonable" value.
+
+	EvaluateBatchItem(item, skinningMatrices);
+}
+
+bool SkeletonController::PrepareBatchItem(float64 t, BatchItem &item)
+{
+	item.skeleton = nullptr;
+	item.culled = false;
+	item.animations.clear();
+	item.worldMatrices = nullptr;
+	item.matrixCount = 0;
+
+	ChildPtr<Skeleton> ch0 = GetChild(0);
+	if (!ch0)
+		return false;
+
+	ChildPtr<Value> ch1 = GetChild(1);
+	if (ch1)
+		t = ch1->GetValue();
+
+	const Map<String, Skeleton::Animation> &a = ch0->GetAnimations();
+
+	_updateController(t, a, item.animations);
+
+	// Compiles the skeleton here, on the main thread, so that evaluation is read-only.
+	const Skeleton::FlatSkeleton &flat = ch0->GetFlatSkeleton();
+	if (flat.parents.empty())
+		return false;
+
+	item.matrixCount = flat.maxIndex + 1;
+	item.skeleton = ch0->GetSkeleton();
 
-	List<XMFLOAT4X4> *worldMatrices = nullptr;
 	ChildPtr<MatrixArray> ch4 = GetChild(4);
 	if (ch4)
-		worldMatrices = &ch4->GetArray();
+		item.worldMatrices = &ch4->GetArray();
+
+	_updateLOD(item);
+
+	return true;
+}
+
+void SkeletonController::_updateLOD(BatchItem &item)
+{
+	item.culled = false;
+	item.jointLOD = 0;
+	item.poses = nullptr;
+	item.evaluate = true;
+	item.interpolation = 1.0f;
+
+	ChildPtr<Renderable> ch5 = GetChild(5);
+	ChildPtr<MatrixChip> ch6 = GetChild(6);
+	if (!ch5 && !ch6) {
+		_reducedRate = false;
+		return;
+	}
+
+	XMFLOAT4X4 world = ch6 ? ch6->GetMatrix() : MatrixChip::IDENTITY;
+
+	// NOTE: The frustum and view matrix are the ones last set, normally from the previous frame.
+	if (ch5 && _lod.cullInvisible && !ch5->CheckFrustumCulling(world)) {
+		item.culled = true;
+		_reducedRate = false; // Evaluate at once when visible again.
+		return;
+	}
+
+	Graphics *graphics = engine->GetGraphics();
+	if (!_lod.enabled || !graphics) {
+		_reducedRate = false;
+		return;
+	}
+
+	XMVECTOR center = XMVectorZero();
+	if (ch5) {
+		AxisAlignedBox aabb = ch5->GetBoundingBox();
+		center = XMVectorScale(XMVectorAdd(XMLoadFloat3(&aabb.GetMin()), XMLoadFloat3(&aabb.GetMax())), 0.5f);
+	}
+	XMMATRIX worldView = XMMatrixMultiply(XMLoadFloat4x4(&world), XMLoadFloat4x4(&graphics->rs()->GetViewMatrix()));
+	float32 distance = XMVectorGetX(XMVector3Length(XMVector3TransformCoord(center, worldView)));
+
+	if (distance > _lod.jointLODDistance)
+		item.jointLOD = _lod.jointLODLevels;
+
+	if (distance <= _lod.reducedRateDistance || _lod.reducedRateInterval < 2) {
+		_reducedRate = false;
+		return;
+	}
+
+	bool restart = !_reducedRate;
+	if (restart) {
+		_reducedRate = true;
+		_framesSinceEvaluation = _lod.reducedRateInterval; // Evaluate now!
+	}
+
+	item.evaluate = _framesSinceEvaluation >= _lod.reducedRateInterval;
+	if (item.evaluate) {
+		std::swap(_poses[0], _poses[1]);
+		if (restart)
+			_poses[0].bindPose = true; // Replaced by the new pose. Nothing to interpolate from yet.
+		_framesSinceEvaluation = 0;
+	}
+
+	item.poses = _poses;
+	item.interpolation = (float32)_framesSinceEvaluation / (float32)_lod.reducedRateInterval;
+	_framesSinceEvaluation++;
+}
+
+static thread_local Skeleton::Pose __interpolatedPose;
+
+void SkeletonController::EvaluateBatchItem(BatchItem &item, List<XMFLOAT4X4> &skinningMatrices)
+{
+	if (!item.skeleton || item.culled)
+		return;
+
+	if (!item.poses) {
+		item.skeleton->UpdateSkinningMatrices(item.animations, skinningMatrices, item.firstIndex, item.worldMatrices, item.jointLOD);
+		return;
+	}
+
+	if (item.evaluate) {
+		item.skeleton->EvaluatePose(item.animations, item.poses[1], item.jointLOD);
+		if (item.poses[0].bindPose)
+			item.poses[0] = item.poses[1];
+	}
 
-	ch0->UpdateSkinningMatrices(animations, skinningMatrices, firstIndex, worldMatrices);
+	Skeleton::InterpolatePoses(item.poses[0], item.poses[1], item.interpolation, __interpolatedPose);
+	item.skeleton->UpdateSkinningMatrices(__interpolatedPose, skinningMatrices, item.firstIndex, item.worldMatrices);
 }
 
 bool SkeletonController::AddCommand(String name, float64 multiplier, float64 fadein, float64 fadeout)
@@ -187,7 +339,7 @@ void SkeletonController::_updateController(float64 t, const Map<String, Skeleton
 		if (g < 0.0)
 			g += animationDuration;
 
-		activeAnimations.insert(Skeleton::ActiveAnimation(&m->second, std::min(inWeight, outWeight), g * m->second.multiplier));
+		activeAnimations.insert(Skeleton::ActiveAnimation(&m->second, std::min(inWeight, outWeight), g * m->second.multiplier, &n.second.cursors));
 	}
 
 	for (size_t i = 0; i < r.size(); i++) // Iterate commands to be removed!
@@ -41,8 +41,26 @@ public:
 	SkeletonController();
 	virtual ~SkeletonController();
 
+	virtual bool CopyChip(Chip *chip) override;
+	virtual bool LoadChip(DocumentLoader &loader) override;
+	virtual bool SaveChip(DocumentSaver &saver) const override;
+
 	virtual void CallChip() override;
 
+	// Animation LOD. Distances are measured from the camera to the center of the Renderable's bounding box (or the origin of the World Matrix).
+	struct LODSettings
+	{
+		bool enabled = false; // Enables distance based LOD. Requires the Renderable or World Matrix to be connected.
+		bool cullInvisible = true; // Do not evaluate the skeleton when the Renderable is frustum culled. The matrices are kept from last time.
+		float32 reducedRateDistance = 20.0f; // Beyond this distance the skeleton is evaluated at a reduced rate.
+		uint32 reducedRateInterval = 4; // Frames between evaluations at reduced rate. Poses are interpolated in between.
+		float32 jointLODDistance = 40.0f; // Beyond this distance the outermost joints (fingers, face etc) are not animated.
+		uint32 jointLODLevels = 2; // Number of joint levels, counted from the leaf joints, not animated beyond jointLODDistance.
+	};
+
+	virtual const LODSettings &GetLODSettings() const { return _lod; }
+	virtual void SetLODSettings(const LODSettings &lod) { _lod = lod; _reducedRate = false; }
+
 	struct AnimationCmd
 	{
 		float64 startTime; // Time of first update!
@@ -54,6 +72,7 @@ public:
 		bool justAdded; // true if this animation was just added to command list.
 		bool repeat; // true if this is a looped animation.
 		bool cancel; // true if asked to cancel this animation.
+		Skeleton::ClipCursors cursors; // Keyframe cursors for the compiled animation.
 
 		AnimationCmd(float64 multiplier = 1.0, float64 fadein = 0.0, float64 fadeout = 0.0, bool repeat = false) : startTime(0.0), multiplier(multiplier), currentTime(0.0), fadein(fadein), fadeout(fadeout), cancelTime(0.0), justAdded(true), repeat(repeat), cancel(false) {}
 	};
@@ -67,9 +86,39 @@ public:
 
 	virtual const Map<String, AnimationCmd> &GetCommands() const { return _commands; }
 
+	// Everything needed to evaluate a controller outside the function stack, eg on a worker thread. Used by SkeletonControllerBatch.
+	struct BatchItem
+	{
+		Skeleton *skeleton = nullptr;
+		Skeleton::ActiveAnimationSet animations;
+		List<XMFLOAT4X4> *worldMatrices = nullptr; // Optional.
+		uint32 matrixCount = 0; // Number of skinning matrices needed (max joint index + 1).
+		uint32 firstIndex = 0; // Set by the batch.
+		bool culled = false; // true if the skeleton should not be evaluated this frame.
+		uint32 jointLOD = 0; // See Skeleton::EvaluatePose().
+		Skeleton::Pose *poses = nullptr; // Reduced update rate only: The last two evaluated poses. The result is interpolated between them.
+		bool evaluate = true; // Reduced update rate only: true if poses[1] is to be evaluated this frame.
+		float32 interpolation = 1.0f; // Reduced update rate only.
+	};
+
+	// Updates the command list at time t (unless Custom Time is connected) and fills in item. Must be called from the main thread. Returns false if there is nothing to evaluate.
+	virtual bool PrepareBatchItem(float64 t, BatchItem &item);
+	// Evaluates a prepared item. Can be called from any thread, as long as each item is only evaluated once.
+	static void EvaluateBatchItem(BatchItem &item, List<XMFLOAT4X4> &skinningMatrices);
+
 protected:
 	Map<String, AnimationCmd> _commands;
 
+	LODSettings _lod;
+	// true if we were at reduced update rate last frame.
+	bool _reducedRate = false;
+	// Frames since the skeleton was last evaluated at reduced rate.
+	uint32 _framesSinceEvaluation = 0;
+	// The last two poses evaluated at reduced rate. [1] is the latest.
+	Skeleton::Pose _poses[2];
+
+	void _updateLOD(BatchItem &item);
+
 	void _updateController(float64 t, const Map<String, Skeleton::Animation> &animations, Skeleton::ActiveAnimationSet &activeAnimations);
 };
 
@@ -0,0 +1,115 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "SkeletonControllerBatch.h"
+#include "GraphicsBuffer.h"
+#include "M3DEngine/Engine.h"
+#include "StdChips/MatrixArray.h"
+#include "StdChips/Value.h"
+#include "StdChips/ValueArray.h"
+#include "M3DCore/ThreadPool.h"
+
+using namespace m3d;
+
+
+CHIPDESCV1_DEF(SkeletonControllerBatch, MTEXT("Skeleton Controller Batch"), SKELETONCONTROLLERBATCH_GUID, CHIP_GUID);
+
+
+SkeletonControllerBatch::SkeletonControllerBatch()
+{
+	CREATE_CHILD(0, SKELETONCONTROLLER_GUID, true, UP, MTEXT("Skeleton Controllers"));
+	CREATE_CHILD(1, VALUE_GUID, false, UP, MTEXT("Custom Time"));
+	CREATE_CHILD(2, MATRIXARRAY_GUID, false, DOWN, MTEXT("Skinning Matrix Array"));
+	CREATE_CHILD(3, VALUEARRAY_GUID, false, DOWN, MTEXT("First Index per Controller"));
+	CREATE_CHILD(4, GRAPHICSBUFFER_GUID, false, UP, MTEXT("Buffer to Update"));
+}
+
+SkeletonControllerBatch::~SkeletonControllerBatch()
+{
+}
+
+void SkeletonControllerBatch::CallChip()
+{
+	if (!Refresh)
+		return;
+
+	ChildPtr<MatrixArray> ch2 = GetChild(2);
+	if (!ch2)
+		return;
+
+	ChildPtr<Value> ch1 = GetChild(1);
+	float64 t = ch1 ? ch1->GetValue() : (float64)engine->GetAppTime() / 1000000.0;
+
+	const uint32 count = GetSubConnectionCount(0);
+	_items.resize(count);
+
+	ValueArray::ArrayType offsets(count, -1.0);
+	Set<const Chip*> controllers;
+	Set<List<XMFLOAT4X4>*> worldArrays;
+	List<uint32> serial;
+	List<uint8> isSerial(count, 0);
+
+	// Main thread: Update command lists, compile skeletons and assign ranges.
+	uint32 matrixCount = 0;
+	for (uint32 i = 0; i < count; i++) {
+		SkeletonController::BatchItem &item = _items[i];
+		item.skeleton = nullptr;
+		if (!controllers.insert(GetRawChild(0, i)).second)
+			continue; // Controllers connected more than once are only updated once.
+		ChildPtr<SkeletonController> ch0 = GetChild(0, i);
+		if (!ch0 || !ch0->PrepareBatchItem(t, item))
+			continue;
+		if (item.worldMatrices && !worldArrays.insert(item.worldMatrices).second) {
+			serial.push_back(i); // Shared world matrix arrays can not be written in parallel.
+			isSerial[i] = 1;
+		}
+		item.firstIndex = matrixCount;
+		offsets[i] = (value)matrixCount;
+		matrixCount += item.matrixCount;
+	}
+
+	// Resize once here. UpdateSkinningMatrices() will then only write to its own range.
+	List<XMFLOAT4X4> &skinningMatrices = ch2->GetArray();
+	if (skinningMatrices.size() < matrixCount)
+		skinningMatrices.resize(matrixCount);
+
+	// Worker threads: Evaluate the skeletons. Skeletons can be shared, because evaluation does not modify them.
+	ThreadPool::GetShared().ParallelFor(count, [&](uint32 i) {
+		if (!isSerial[i])
+			SkeletonController::EvaluateBatchItem(_items[i], skinningMatrices);
+	});
+
+	// Main thread: The controllers writing to a world matrix array already written by another one, in order of connection.
+	for (uint32 i : serial)
+		SkeletonController::EvaluateBatchItem(_items[i], skinningMatrices);
+
+	ChildPtr<ValueArray> ch3 = GetChild(3);
+	if (ch3)
+		ch3->SetArray(std::move(offsets));
+
+	// One upload for all characters.
+	ChildPtr<GraphicsBuffer> ch4 = GetChild(4);
+	if (ch4)
+		ch4->CallChip();
+}
@@ -0,0 +1,56 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+
+#include "Exports.h"
+#include "SkeletonController.h"
+
+namespace m3d
+{
+
+
+static const Guid SKELETONCONTROLLERBATCH_GUID = { 0xf3bb8ed7, 0x64b1, 0x4d57, { 0x8f, 0x3c, 0x5d, 0xa1, 0x85, 0xfc, 0xa8, 0xf } };
+
+
+// Updates many skeleton controllers into one contiguous skinning matrix array.
+// Command lists are updated on the main thread, then the skeletons are evaluated in parallel.
+// Each controller gets its own range of the array. The first index of each range is written to the offset array.
+// Controllers sharing a world matrix array are evaluated after the others, one at a time.
+class GRAPHICSCHIPS_API SkeletonControllerBatch : public Chip
+{
+	CHIPDESC_DECL;
+public:
+	SkeletonControllerBatch();
+	virtual ~SkeletonControllerBatch();
+
+	virtual void CallChip() override;
+
+protected:
+	List<SkeletonController::BatchItem> _items; // Kept between frames to avoid reallocations.
+};
+
+
+
+}
@@ -25,6 +25,7 @@
 #include "StdGeometry.h"
 #include "M3DEngine/DocumentSaveLoadUtil.h"
 #include "M3DCore/DataBuffer.h"
+#include "M3DCore/HighPrecisionTimer.h"
 #include "M3DEngine/Engine.h"
 #include "D3D12Formats.h"
 #include "Graphics.h"
@@ -80,6 +81,7 @@ bool StdGeometry::CopyChip(Chip* chip)
 	_blendWeights = c->_blendWeights;
 	_blendIndices = c->_blendIndices;
 	_indices = c->_indices;
+	_lodIndices = c->_lodIndices;
 	_streams = c->_streams;
 	_tsc = c->_tsc;
 	_packNormals = c->_packNormals;
@@ -100,6 +102,7 @@ bool StdGeometry::LoadChip(DocumentLoader& loader)
 	LOAD("blendWeights", _blendWeights);
 	LOAD("blendIndices", _blendIndices);
 	LOAD("indices", _indices);
+	LOADDEF("lodIndices", _lodIndices, List<UINT>());
 	LOADARRAY("streams", (uint32*)_streams.s, MAX_ELEMENTS);
 	LOAD("tangentSpaceCompression", (uint32&)_tsc);
 	LOAD("packNormals", _packNormals);
@@ -119,6 +122,8 @@ bool StdGeometry::SaveChip(DocumentSaver& saver) const
 	SAVE("blendWeights", _blendWeights);
 	SAVE("blendIndices", _blendIndices);
 	SAVE("indices", _indices);
+	if (_lodIndices.size())
+		SAVE("lodIndices", _lodIndices);
 	SAVEARRAY("streams", _streams.s, MAX_ELEMENTS);
 	SAVE("tangentSpaceCompression", (uint32)_tsc);
 	SAVE("packNormals", _packNormals);
@@ -139,11 +144,29 @@ void StdGeometry::Clear()
 	_blendWeights.clear();
 	_blendIndices.clear();
 	_indices.clear();
+	_lodIndices.clear();
 	memset(_streams.s, 0, sizeof(_streams));
 }
 
+void StdGeometry::AddTexCoords(const float32* tc, uint32 count, uint32 components, uint32 set)
+{
+	static const TexCoordSetType types[4] = { U, UV, UVW, UVWX };
+	if (components < 1 || components > 4 || (_texcoords[set].type != NONE && _texcoords[set].type != types[components - 1]))
+		return;
+	TexCoordSet &s = _texcoords[set];
+	s.type = types[components - 1];
+	switch (components)
+	{
+	case 1: s.u.insert(s.u.end(), tc, tc + count); break;
+	case 2: s.uv.insert(s.uv.end(), (const XMFLOAT2*)tc, (const XMFLOAT2*)tc + count); break;
+	case 3: s.uvw.insert(s.uvw.end(), (const XMFLOAT3*)tc, (const XMFLOAT3*)tc + count); break;
+	case 4: s.uvwx.insert(s.uvwx.end(), (const XMFLOAT4*)tc, (const XMFLOAT4*)tc + count); break;
+	}
+}
+
 void StdGeometry::CommitSubset(M3D_PRIMITIVE_TOPOLOGY pt, String name)
 {
+	ClearLODs(); // The levels of detail must match the base subsets.
 	GeometrySubset ss;
 	ss.name = name;
 	ss.pt = pt;
@@ -158,6 +181,8 @@ void StdGeometry::_calculateBoundingBox(GeometrySubset& ss)
 {
 	if (GetAPI() == DRAW)
 		ss.boundingBox.Set(ss.count, &_positions[ss.startLocation + ss.baseVertexLocation], sizeof(XMFLOAT3));
+	else if (ss.startLocation >= _indices.size()) // Level of detail.
+		ss.boundingBox.Set(ss.count, &_positions[ss.baseVertexLocation], sizeof(XMFLOAT3), &_lodIndices[ss.startLocation - _indices.size()]);
 	else
 		ss.boundingBox.Set(ss.count, &_positions[ss.baseVertexLocation], sizeof(XMFLOAT3), &_indices[ss.startLocation]);
 }
@@ -166,8 +191,24 @@ void StdGeometry::TransformPositions(CXMMATRIX m)
 {
 	if (_positions.size()) {
 		XMVector3TransformCoordStream(&_positions.front(), sizeof(XMFLOAT3), &_positions.front(), sizeof(XMFLOAT3), (UINT)_positions.size(), m);
-		for (size_t i = 0; i < GetSubsets().size(); i++)
-			SetBoundingBox(GetSubsets()[i].boundingBox * m, (uint32)i);
+		float32 scale = std::max(XMVectorGetX(XMVector3Length(m.r[0])), std::max(XMVectorGetX(XMVector3Length(m.r[1])), XMVectorGetX(XMVector3Length(m.r[2]))));
+		auto transform = [&](GeometrySubset &ss) {
+			ss.boundingBox *= m;
+			for (Meshlet &ml : ss.meshlets) { // Upper bound for the radius. The cone is exact for uniform scale only.
+				XMStoreFloat3(&ml.center, XMVector3TransformCoord(XMLoadFloat3(&ml.center), m));
+				XMStoreFloat3(&ml.coneAxis, XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&ml.coneAxis), m)));
+				ml.radius *= scale;
+			}
+		};
+		GeometrySubsetList subsets = GetSubsets();
+		for (GeometrySubset &ss : subsets)
+			transform(ss);
+		SetSubsets(subsets);
+		for (GeometryLOD &lod : _lods) {
+			lod.error *= scale; // Upper bound.
+			for (GeometrySubset &ss : lod.subsets)
+				transform(ss);
+		}
 	}
 }
 
@@ -179,6 +220,7 @@ void StdGeometry::TransformNormals(CXMMATRIX m)
 		XMVector3TransformNormalStream(&_tangents.front(), sizeof(XMFLOAT3), &_tangents.front(), sizeof(XMFLOAT3), (UINT)_tangents.size(), m);
 	if (_bitangents.size())
 		XMVector3TransformNormalStream(&_bitangents.front(), sizeof(XMFLOAT3), &_bitangents.front(), sizeof(XMFLOAT3), (UINT)_bitangents.size(), m);
+	SetUpdateStamp();
 }
 
 void StdGeometry::TransformTexCoordSet(CXMMATRIX m, uint32 set)
@@ -191,6 +233,7 @@ void StdGeometry::TransformTexCoordSet(CXMMATRIX m, uint32 set)
 	case UVWX: XMVector4TransformStream(&_texcoords[set].uvwx.front(), sizeof(XMFLOAT4), &_texcoords[set].uvwx.front(), sizeof(XMFLOAT4), (UINT)_texcoords[set].uvwx.size(), m); break;
 	default:;
 	}
+	SetUpdateStamp();
 }
 
 void StdGeometry::SwapTexcoords(uint32 set1, uint32 set2)
@@ -199,6 +242,7 @@ void StdGeometry::SwapTexcoords(uint32 set1, uint32 set2)
 		return;
 	std::swap(_texcoords[set1].type, _texcoords[set2].type);
 	std::swap(_texcoords[set1].u, _texcoords[set2].u); // NOTE: This is kinda nasty, but is should work. The formal way would be to swap the correct type of course! (std::move will prevent data copy!)
+	SetUpdateStamp();
 }
 
 void StdGeometry::ChangeTexCoordSetType(uint32 set, TexCoordSetType type)
@@ -277,6 +321,7 @@ void StdGeometry::ChangeTexCoordSetType(uint32 set, TexCoordSetType type)
 	}
 	_texcoords[set].type = type;
 	std::swap(_texcoords[set].u, s.u); // NOTE: This is kinda nasty, but is should work. The formal way would be to swap the correct type of course! (std::move will prevent data copy!)
+	SetUpdateStamp();
 }
 
 void StdGeometry::SetTexCoordSetFormat(uint32 set, TexCoordSetFormat fmt)
@@ -445,6 +490,348 @@ D3D12_PRIMITIVE_TOPOLOGY_TYPE __getPTT(D3D12_PRIMITIVE_TOPOLOGY pt)
 	return D3D12_PRIMITIVE_TOPOLOGY_TYPE_PATCH;
 }
 
+namespace
+{
+	// Moves element i to remap[i]. Streams not matching the vertex count are left as they are.
+	template<typename T>
+	void _remapStream(List<T> &data, const List<uint32> &remap, size_t newCount)
+	{
+		if (data.size() != remap.size())
+			return;
+		List<T> tmp(newCount);
+		for (size_t i = 0; i < remap.size(); i++)
+			if (remap[i] != uint32(-1))
+				tmp[remap[i]] = data[i];
+		data.swap(tmp);
+	}
+}
+
+bool StdGeometry::Optimize(const MeshOptimizationOptions &options, MeshOptimizationStats *stats)
+{
+	static const uint32 CUT = uint32(-1); // Strip cut value.
+
+	if (GetAPI() != DRAW_INDEXED || _positions.empty())
+		return false;
+
+	GeometrySubsetList subsets = GetSubsets();
+	const size_t vertexCount = _positions.size();
+
+	// Validate before touching anything.
+	for (const GeometrySubset &ss : subsets) {
+		if (size_t(ss.startLocation) + ss.count > _indices.size())
+			return false;
+		for (UINT i = ss.startLocation; i < ss.startLocation + ss.count; i++)
+			if (_indices[i] != CUT && (ss.baseVertexLocation + int64(_indices[i]) < 0 || ss.baseVertexLocation + int64(_indices[i]) >= int64(vertexCount)))
+				return false;
+	}
+
+	ClearLODs(); // Generate them after optimizing.
+
+	// Make all indices absolute, so that the vertex data can be reordered across subsets.
+	for (GeometrySubset &ss : subsets) {
+		for (UINT i = ss.startLocation; i < ss.startLocation + ss.count; i++)
+			if (_indices[i] != CUT)
+				_indices[i] += ss.baseVertexLocation;
+		ss.baseVertexLocation = 0;
+		ss.meshlets.clear(); // Build them after optimizing.
+	}
+
+	// ACMR/ATVR of all triangle list subsets.
+	auto analyze = [&]() -> VertexCacheStats {
+		List<uint32> triangles;
+		for (const GeometrySubset &ss : subsets)
+			if (ss.pt == M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+				triangles.insert(triangles.end(), _indices.begin() + ss.startLocation, _indices.begin() + ss.startLocation + ss.count);
+		return meshoptimization::AnalyzeVertexCache(triangles.data(), triangles.size(), vertexCount, options.cacheSize);
+	};
+
+	MeshOptimizationStats st;
+	st.vertexCountBefore = (uint32)vertexCount;
+	st.before = analyze();
+
+	// Optimize each triangle list, using only the range of vertices it references.
+	for (const GeometrySubset &ss : subsets) {
+		if (ss.pt != M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST || ss.count < 3)
+			continue;
+		UINT *idx = &_indices[ss.startLocation];
+		uint32 lo = *std::min_element(idx, idx + ss.count), hi = *std::max_element(idx, idx + ss.count);
+		for (UINT i = 0; i < ss.count; i++)
+			idx[i] -= lo;
+		if (options.vertexCache)
+			meshoptimization::OptimizeVertexCache(idx, idx, ss.count, hi - lo + 1);
+		if (options.overdraw)
+			meshoptimization::OptimizeOverdraw(idx, idx, ss.count, &_positions[lo].x, sizeof(XMFLOAT3), hi - lo + 1, options.overdrawThreshold, options.cacheSize);
+		for (UINT i = 0; i < ss.count; i++)
+			idx[i] += lo;
+		st.optimizedSubsets++;
+		st.triangleCount += ss.count / 3;
+	}
+
+	// Reorder the vertices by first use, in subset order. Unreferenced vertices are removed.
+	if (options.vertexFetch) {
+		List<uint32> used;
+		for (const GeometrySubset &ss : subsets)
+			used.insert(used.end(), _indices.begin() + ss.startLocation, _indices.begin() + ss.startLocation + ss.count);
+		List<uint32> remap(vertexCount);
+		size_t newCount = meshoptimization::OptimizeVertexFetchRemap(remap.data(), used.data(), used.size(), vertexCount);
+		for (const GeometrySubset &ss : subsets)
+			for (UINT i = ss.startLocation; i < ss.startLocation + ss.count; i++)
+				if (_indices[i] != CUT)
+					_indices[i] = remap[_indices[i]];
+		_remapStream(_normals, remap, newCount);
+		_remapStream(_tangents, remap, newCount);
+		_remapStream(_bitangents, remap, newCount);
+		_remapStream(_colors, remap, newCount);
+		for (uint32 i = 0; i < MAX_TEXCOORD_SETS; i++) {
+			_remapStream(_texcoords[i].u, remap, newCount);
+			_remapStream(_texcoords[i].uv, remap, newCount);
+			_remapStream(_texcoords[i].uvw, remap, newCount);
+			_remapStream(_texcoords[i].uvwx, remap, newCount);
+		}
+		_remapStream(_blendWeights, remap, newCount);
+		_remapStream(_blendIndices, remap, newCount);
+		_remapStream(_positions, remap, newCount);
+	}
+
+	st.vertexCountAfter = (uint32)_positions.size();
+	st.after = analyze();
+
+	// Make the indices of each subset relative to the first vertex it uses. This allows 16-bit indices as long as no subset spans 64K vertices.
+	uint32 maxIndex = 0;
+	for (GeometrySubset &ss : subsets) {
+		uint32 lo = CUT;
+		for (UINT i = ss.startLocation; i < ss.startLocation + ss.count; i++)
+			if (_indices[i] != CUT)
+				lo = std::min(lo, _indices[i]);
+		if (lo == CUT)
+			continue;
+		for (UINT i = ss.startLocation; i < ss.startLocation + ss.count; i++)
+			if (_indices[i] != CUT)
+				maxIndex = std::max(maxIndex, _indices[i] -= lo);
+		ss.baseVertexLocation = (INT)lo;
+	}
+	st.indices16 = maxIndex < 0xFFFF;
+
+	SetSubsets(subsets);
+	for (uint32 i = 0; i < subsets.size(); i++) {
+		GeometrySubset ss = GetSubsets()[i];
+		_calculateBoundingBox(ss);
+		SetSubset(ss, i);
+	}
+
+	if (stats)
+		*stats = st;
+
+	return true;
+}
+
+bool StdGeometry::GenerateLODs(const MeshLODOptions &options, List<MeshLODStats> *stats)
+{
+	ClearLODs();
+
+	if (GetAPI() != DRAW_INDEXED || _positions.empty() || options.levelCount == 0 || options.reduction <= 0.0f || options.reduction >= 1.0f)
+		return false;
+
+	const GeometrySubsetList &subsets = GetSubsets();
+	const size_t vertexCount = _positions.size();
+
+	// Vertex range used by each triangle list. Simplification is done on these local ranges.
+	List<uint32> lo(subsets.size(), 0), hi(subsets.size(), 0);
+	List<List<uint32>> current(subsets.size()); // Local indices of the last level for each subset.
+	for (uint32 i = 0; i < subsets.size(); i++) {
+		const GeometrySubset &ss = subsets[i];
+		if (ss.pt != M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST || ss.count < 3)
+			continue;
+		if (size_t(ss.startLocation) + ss.count > _indices.size())
+			return false;
+		const UINT *idx = &_indices[ss.startLocation];
+		lo[i] = *std::min_element(idx, idx + ss.count);
+		hi[i] = *std::max_element(idx, idx + ss.count);
+		if (ss.baseVertexLocation < 0 || ss.baseVertexLocation + int64(hi[i]) >= int64(vertexCount))
+			return false;
+		current[i].resize(ss.count);
+		for (UINT j = 0; j < ss.count; j++)
+			current[i][j] = idx[j] - lo[i];
+	}
+
+	// Attributes guarding discontinuities: normals, texture coordinates of set 0 and blend weights.
+	const bool hasNormals = _normals.size() == vertexCount;
+	const TexCoordSet &tc = _texcoords[0];
+	const uint32 tcCount = tc.size() == vertexCount ? std::min(uint32(tc.type), 2u) : 0; // Only u and v matter for seams.
+	const bool hasBlendWeights = _blendWeights.size() == vertexCount;
+	List<float32> weights;
+	weights.insert(weights.end(), hasNormals ? 3 : 0, options.normalWeight);
+	weights.insert(weights.end(), tcCount, options.texcoordWeight);
+	weights.insert(weights.end(), hasBlendWeights ? 4 : 0, options.blendWeightWeight);
+	const uint32 attributeCount = (uint32)weights.size();
+	List<float32> attributes(vertexCount * attributeCount);
+	List<uint32> groups; // Main bone of each vertex.
+	if (_blendIndices.size() == vertexCount)
+		groups.resize(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++) {
+		float32 *a = attributeCount ? &attributes[v * attributeCount] : nullptr;
+		if (hasNormals) {
+			*a++ = _normals[v].x; *a++ = _normals[v].y; *a++ = _normals[v].z;
+		}
+		if (tcCount > 0)
+			*a++ = tc.type == U ? tc.u[v] : tc.type == UV ? tc.uv[v].x : tc.type == UVW ? tc.uvw[v].x : tc.uvwx[v].x;
+		if (tcCount > 1)
+			*a++ = tc.type == UV ? tc.uv[v].y : tc.type == UVW ? tc.uvw[v].y : tc.uvwx[v].y;
+		uint8 w[4] = { 255, 0, 0, 0 };
+		if (hasBlendWeights) {
+			w[0] = _blendWeights[v].x; w[1] = _blendWeights[v].y; w[2] = _blendWeights[v].z; w[3] = _blendWeights[v].w;
+			for (uint32 j = 0; j < 4; j++)
+				*a++ = w[j] / 255.0f;
+		}
+		if (groups.size()) {
+			const uint16 b[4] = { _blendIndices[v].x, _blendIndices[v].y, _blendIndices[v].z, _blendIndices[v].w };
+			groups[v] = b[std::max_element(w, w + 4) - w];
+		}
+	}
+
+	List<float32> errors(subsets.size(), 0.0f);
+	GeometrySubsetList previous = subsets;
+
+	for (uint32 level = 0; level < options.levelCount; level++) {
+		HighPrecisionTimer timer;
+		timer.Tick();
+
+		GeometryLOD lod;
+		MeshLODStats st;
+		bool reduced = false;
+		for (uint32 i = 0; i < subsets.size(); i++) {
+			GeometrySubset ss = previous[i]; // Subsets that can not be reduced further are shared with the previous level.
+			if (current[i].size()) {
+				const size_t count = current[i].size(), localVertexCount = hi[i] - lo[i] + 1, first = subsets[i].baseVertexLocation + lo[i];
+				const size_t target = size_t(count / 3 * options.reduction) * 3;
+				List<uint32> next(count);
+				float32 error = 0.0f;
+				size_t n = meshoptimization::Simplify(next.data(), current[i].data(), count, &_positions[first].x, sizeof(XMFLOAT3), localVertexCount,
+					attributeCount ? &attributes[first * attributeCount] : nullptr, attributeCount * sizeof(float32), attributeCount, weights.data(),
+					groups.size() ? &groups[first] : nullptr, target, options.maxError, options.lockBorders, &error);
+				if (n == 0 || n >= count * 95 / 100) // Not worth a level.
+					current[i].clear();
+				else {
+					next.resize(n);
+					meshoptimization::OptimizeVertexCache(next.data(), next.data(), n, localVertexCount);
+					current[i].swap(next);
+					errors[i] += error; // Upper bound, as each level is simplified from the previous one.
+					ss.startLocation = UINT(_indices.size() + _lodIndices.size());
+					ss.count = (UINT)n;
+					ss.meshlets.clear();
+					for (uint32 index : current[i])
+						_lodIndices.push_back(index + lo[i]);
+					_calculateBoundingBox(ss);
+					if (options.measureError) {
+						List<uint32> base(_indices.begin() + subsets[i].startLocation, _indices.begin() + subsets[i].startLocation + subsets[i].count);
+						for (uint32 &index : base)
+							index -= lo[i];
+						st.hausdorff = std::max(st.hausdorff, meshoptimization::MeasureHausdorffDistance(&_positions[first].x, sizeof(XMFLOAT3), localVertexCount, base.data(), base.size(), current[i].data(), n));
+					}
+					reduced = true;
+				}
+			}
+			if (ss.pt == M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST)
+				st.triangleCount += ss.count / 3;
+			lod.error = std::max(lod.error, errors[i]);
+			lod.subsets.push_back(ss);
+		}
+
+		if (!reduced)
+			break;
+
+		timer.Tick();
+		st.error = lod.error;
+		st.time = timer.GetDt_us() / 1000000.0;
+		previous = lod.subsets;
+		_lods.push_back(lod);
+		if (stats)
+			stats->push_back(st);
+	}
+
+	return _lods.size() > 0;
+}
+
+bool StdGeometry::BuildMeshlets(const MeshletOptions &options, MeshletStats *stats)
+{
+	if (GetAPI() != DRAW_INDEXED || _positions.empty())
+		return false;
+
+	HighPrecisionTimer timer;
+	timer.Tick();
+
+	GeometrySubsetList subsets = GetSubsets();
+	GeometryLODList lods = GetLODs();
+	Map<UINT, MeshletList> built; // By start location, as a level of detail can share subsets with the previous level.
+	MeshletStats st;
+	float64 vertices = 0.0, radius = 0.0, coneAngle = 0.0;
+	uint32 cullable = 0;
+
+	auto build = [&](GeometrySubset &ss) -> bool {
+		ss.meshlets.clear();
+		if (ss.pt != M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST || ss.count < 3)
+			return true;
+		auto n = built.find(ss.startLocation);
+		if (n != built.end()) {
+			ss.meshlets = n->second;
+			return true;
+		}
+		const bool lod = ss.startLocation >= _indices.size();
+		if (lod ? size_t(ss.startLocation) + ss.count > _indices.size() + _lodIndices.size() : size_t(ss.startLocation) + ss.count > _indices.size())
+			return false;
+		UINT *idx = lod ? &_lodIndices[ss.startLocation - _indices.size()] : &_indices[ss.startLocation];
+		uint32 lo = *std::min_element(idx, idx + ss.count), hi = *std::max_element(idx, idx + ss.count);
+		if (ss.baseVertexLocation < 0 || ss.baseVertexLocation + int64(hi) >= int64(_positions.size()))
+			return false;
+		for (UINT i = 0; i < ss.count; i++)
+			idx[i] -= lo;
+		meshoptimization::BuildMeshlets(ss.meshlets, idx, idx, ss.count, &_positions[ss.baseVertexLocation + lo].x, sizeof(XMFLOAT3), hi - lo + 1, ss.startLocation, options);
+		for (UINT i = 0; i < ss.count; i++)
+			idx[i] += lo;
+		built.insert(std::make_pair(ss.startLocation, ss.meshlets));
+
+		float32 r = XMVectorGetX(XMVector3Length(XMLoadFloat3(&ss.boundingBox.GetMax()) - XMLoadFloat3(&ss.boundingBox.GetMin()))) * 0.5f;
+		for (const Meshlet &m : ss.meshlets) {
+			vertices += m.vertexCount;
+			radius += r > 0.0f ? m.radius / r : 0.0f;
+			if (m.coneCutoff < 1.0f) {
+				cullable++;
+				coneAngle += XMConvertToDegrees(asinf(m.coneCutoff));
+			}
+		}
+		st.meshletCount += (uint32)ss.meshlets.size();
+		st.triangleCount += ss.count / 3;
+		return true;
+	};
+
+	for (GeometrySubset &ss : subsets)
+		if (!build(ss))
+			return false;
+	for (GeometryLOD &lod : lods)
+		for (GeometrySubset &ss : lod.subsets)
+			if (!build(ss))
+				return false;
+
+	SetSubsets(subsets);
+	Geometry::SetLODs(lods);
+
+	timer.Tick();
+
+	if (stats) {
+		if (st.meshletCount) {
+			st.averageVertices = float32(vertices / st.meshletCount);
+			st.averageTriangles = float32(st.triangleCount) / st.meshletCount;
+			st.averageRadius = float32(radius / st.meshletCount);
+			st.coneCullable = float32(cullable) / st.meshletCount;
+			st.averageConeAngle = cullable ? float32(coneAngle / cullable) : 0.0f;
+		}
+		st.time = timer.GetDt_us() / 1000000.0;
+		*stats = st;
+	}
+
+	return true;
+}
+
 void StdGeometry::CreateDeviceObjects()
 {
 	// Destroy old data
@@ -495,6 +882,14 @@ void StdGeometry::CreateDeviceObjects()
 			throw GraphicsException(this, MTEXT("Primitive topology mismatch in subsets."), WARN);
 	}
 
+	for (const GeometryLOD& lod : GetLODs()) {
+		if (lod.subsets.size() != subsets.size())
+			throw GraphicsException(this, MTEXT("Subset count mismatch in level of detail."), WARN);
+		for (const GeometrySubset& s : lod.subsets)
+			if (size_t(s.startLocation) + s.count > indices.size() + GetLODIndices().size())
+				throw GraphicsException(this, MTEXT("Level of detail is out of range of the index data."), WARN);
+	}
+
 	bool use8bitBlendIndices = false; // We use 16-bits blend indices by default (Up to 64k joints), but we may manage with 8-bits (Up to 256 joints).
 	if (streams.active(BLENDINDICES)) {
 		size_t i = 0;
@@ -729,16 +1124,25 @@ void StdGeometry::CreateDeviceObjects()
 
 	// Set up index buffer if using it
 	if (GetAPI() == DRAW_INDEXED) {
-		bool i32 = positions.size() > 65535;
-		UINT byteWidth = (uint32)indices.size() * (i32 ? sizeof(UINT) : sizeof(USHORT));
+		// Use 16-bit indices when all indices fit. 0xFFFF is reserved for the strip cut value. Optimize() rebases subsets to make this more likely.
+		// The levels of detail are appended to the base indices.
+		const auto& lodIndices = GetLODIndices();
+		const size_t indexCount = indices.size() + lodIndices.size();
+		auto index = [&](size_t i) { return i < indices.size() ? indices[i] : lodIndices[i - indices.size()]; };
+		bool i32 = false;
+		for (size_t i = 0; i < indexCount && !i32; i++)
+			i32 = index(i) >= 0xFFFF && index(i) != UINT(-1);
+		UINT byteWidth = (uint32)indexCount * (i32 ? sizeof(UINT) : sizeof(USHORT));
 		ifmt = i32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
 		idata.realloc(byteWidth);
 		if (i32) {
-			std::memcpy(idata.getBuffer(), &indices.front(), byteWidth);
+			std::memcpy(idata.getBuffer(), &indices.front(), indices.size() * sizeof(UINT));
+			if (lodIndices.size())
+				std::memcpy((UINT*)idata.getBuffer() + indices.size(), &lodIndices.front(), lodIndices.size() * sizeof(UINT));
 		}
 		else {
-			for (uint32 i = 0; i < indices.size(); i++)
-				((USHORT*)idata.getBuffer())[i] = (USHORT)indices[i];
+			for (uint32 i = 0; i < indexCount; i++)
+				((USHORT*)idata.getBuffer())[i] = (USHORT)index(i);
 		}
 	}
 
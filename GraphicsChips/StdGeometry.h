@@ -25,6 +25,7 @@
 
 #include "Exports.h"
 #include "Geometry.h"
+#include "MeshOptimization.h"
 
 
 namespace m3d
@@ -129,6 +130,18 @@ public:
 	virtual void AddBlendWeights(const XMUBYTEN4& weights) { _blendWeights.push_back(weights); }
 	virtual void AddBlendIndices(const XMUSHORT4& indices) { _blendIndices.push_back(indices); }
 	virtual void AddIndex(UINT index) { _indices.push_back(index); }
+	// Appends count elements at once. Used by the importers.
+	virtual void AddPositions(const XMFLOAT3* positions, uint32 count) { _positions.insert(_positions.end(), positions, positions + count); }
+	virtual void AddNormals(const XMFLOAT3* normals, uint32 count) { _normals.insert(_normals.end(), normals, normals + count); }
+	virtual void AddTangents(const XMFLOAT3* tangents, uint32 count) { _tangents.insert(_tangents.end(), tangents, tangents + count); }
+	virtual void AddBitangents(const XMFLOAT3* bitangents, uint32 count) { _bitangents.insert(_bitangents.end(), bitangents, bitangents + count); }
+	virtual void AddColors(const XMCOLOR* colors, uint32 count) { _colors.insert(_colors.end(), colors, colors + count); }
+	// tc is count*components floats. components is 1-4.
+	virtual void AddTexCoords(const float32* tc, uint32 count, uint32 components, uint32 set = 0);
+	virtual void AddBlendWeights(const XMUBYTEN4* weights, uint32 count) { _blendWeights.insert(_blendWeights.end(), weights, weights + count); }
+	virtual void AddBlendIndices(const XMUSHORT4* indices, uint32 count) { _blendIndices.insert(_blendIndices.end(), indices, indices + count); }
+	// offset is added to each index.
+	virtual void AddIndices(const UINT* indices, uint32 count, UINT offset = 0) { _indices.reserve(_indices.size() + count); for (uint32 i = 0; i < count; i++) _indices.push_back(indices[i] + offset); }
 
 	virtual const List<XMFLOAT3>& GetPositions() const { return _positions; }
 	virtual const List<XMFLOAT3>& GetNormals() const { return _normals; }
@@ -140,6 +153,8 @@ public:
 	virtual const List<XMUBYTEN4>& GetBlendWeights() const { return _blendWeights; }
 	virtual const List<XMUSHORT4>& GetBlendIndices() const { return _blendIndices; }
 	virtual const List<UINT>& GetIndices() const { return _indices; }
+	// Index data for the levels of detail. Uploaded after GetIndices() in the same index buffer.
+	virtual const List<UINT>& GetLODIndices() const { return _lodIndices; }
 
 	virtual void ClearPositions() { _positions.clear(); }
 	virtual void ClearNormals() { _normals.clear(); }
@@ -149,7 +164,8 @@ public:
 	virtual void ClearTexcoords(uint32 set = 0) { _texcoords[set].clear(); }
 	virtual void ClearBlendWeights() { _blendWeights.clear(); }
 	virtual void ClearBlendIndices() { _blendIndices.clear(); }
-	virtual void ClearIndices() { _indices.clear(); }
+	virtual void ClearIndices() { _indices.clear(); ClearLODs(); }
+	void ClearLODs() override { Geometry::ClearLODs(); _lodIndices.clear(); }
 
 	virtual void TransformPositions(CXMMATRIX m);
 	virtual void TransformNormals(CXMMATRIX m);
@@ -159,6 +175,16 @@ public:
 	virtual void ChangeTexCoordSetType(uint32 set, TexCoordSetType type);
 	virtual void SetTexCoordSetFormat(uint32 set, TexCoordSetFormat fmt);
 
+	// Reorders the triangles of all triangle list subsets for vertex cache efficiency and reduced overdraw, reorders the vertex data by first use,
+	// and rebases the subsets so that 16-bit indices are used when possible. Requires DRAW_INDEXED. See MeshOptimization.h.
+	virtual bool Optimize(const MeshOptimizationOptions &options = MeshOptimizationOptions(), MeshOptimizationStats *stats = nullptr);
+	// Generates a chain of levels of detail by simplifying the triangle list subsets. Each level is simplified from the previous one.
+	// Existing levels are replaced. Stats are given for each generated level. Requires DRAW_INDEXED. See MeshOptimization.h.
+	virtual bool GenerateLODs(const MeshLODOptions &options = MeshLODOptions(), List<MeshLODStats> *stats = nullptr);
+	// Splits the triangle list subsets, including those of the levels of detail, into meshlets for culling. Reorders the triangles within
+	// each subset. Optimize(...) and GenerateLODs(...) remove the meshlets, so call this last. Requires DRAW_INDEXED. See MeshOptimization.h.
+	virtual bool BuildMeshlets(const MeshletOptions &options = MeshletOptions(), MeshletStats *stats = nullptr);
+
 	// Set/Get DISABLE_ELEMENT disables element. 
 	// stream must be < D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT (32). 
 	virtual uint32 GetElementStream(Element element) const { return _streams(element); }
@@ -215,6 +241,7 @@ protected:
 	List<XMUBYTEN4> _blendWeights; // 8-bits: 0.2% error (0.5 / 256)
 	List<XMUSHORT4> _blendIndices; // Can be compressed to 8-bits when uploaded to gpu.
 	List<UINT> _indices; // Can be compressed to 16-bits when uploaded to gpu.
+	List<UINT> _lodIndices; // Indices for the levels of detail. Subsets of the levels start at _indices.size().
 
 	Streams _streams;
 
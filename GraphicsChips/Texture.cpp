@@ -29,10 +29,45 @@
 #include "D3D12RenderWindow.h"
 #include "D3D12RenderWindowManager.h"
 #include "RenderSettings.h"
+#include "ImageDecoder.h"
+#include "TextureProcessing.h"
+#include "M3DCore/ThreadPool.h"
+#include <wincodec.h>
 
 using namespace m3d;
 
 
+namespace m3d
+{
+
+class TextureDecodeJob
+{
+public:
+	DataBuffer source; // Copy of the image data, so that the chip can change it while we are decoding.
+	ImageFileFormat format = IFF_UNKNOWN;
+	DecodedImage image;
+	bool decoded = false; // false if the format is not supported by our decoders. The platform decoders are used instead.
+	std::future<void> done;
+};
+
+}
+
+namespace
+{
+	// Texture created from shared image data. Textures with image data of equal content (eg loaded from the same blob in different documents) get the same resource, as long as it is read-only.
+	struct SharedTexture
+	{
+		DataBuffer data; // Keeps the image data, and thereby its address, alive.
+		ID3D12Device* device;
+		uint32 flagsEx;
+		RID3D12Resource res;
+		uint32 users; // Number of textures using res.
+	};
+
+	List<SharedTexture> _sharedTextures;
+}
+
+
 CHIPDESCV1_DEF(Texture, MTEXT("Texture"), TEXTURE_GUID, GRAPHICSRESOURCECHIP_GUID);
 
 
@@ -79,6 +114,11 @@ Texture::Texture()
 	ClearConnections();
 }
 
+Texture::~Texture()
+{
+	_releaseSharedResource();
+}
+
 bool Texture::CopyChip(Chip* chip)
 {
 	Texture* c = dynamic_cast<Texture*>(chip);
@@ -86,6 +126,9 @@ bool Texture::CopyChip(Chip* chip)
 	_initDesc = c->_initDesc;
 	_imageData = c->_imageData;
 	_imageFileFormat = c->_imageFileFormat;
+	_decodeJob = c->_decodeJob; // The decoded image is read-only, so it can be shared.
+	if (!_decodeJob)
+		_startDecodeJob();
 	//ClearResource();
 	return true;
 }
@@ -107,6 +150,8 @@ bool Texture::LoadChip(DocumentLoader& loader)
 	LOADDEF("flags", _initDesc.Flags, M3D_RESOURCE_FLAG_NONE);
 	LOADDEF("flagsEx", _initDesc.FlagsEx, 0);
 
+	_startDecodeJob();
+
 	return true;
 }
 
@@ -151,6 +196,26 @@ void Texture::OnReleasingBackBuffer(RenderWindow* rw)
 		ClearResource(); // Clear because size, format or multisampling is dependent on the back buffer!
 }
 
+void Texture::ClearResource()
+{
+	_releaseSharedResource();
+	GraphicsResourceChip::ClearResource();
+}
+
+void Texture::_releaseSharedResource()
+{
+	if (!_sharesResource)
+		return;
+	_sharesResource = false;
+	for (size_t i = 0; i < _sharedTextures.size(); i++) {
+		if (_sharedTextures[i].res == _res) {
+			if (--_sharedTextures[i].users == 0)
+				_sharedTextures.erase(_sharedTextures.begin() + i); // Last user. Forget the texture.
+			break;
+		}
+	}
+}
+
 void Texture::UpdateChip(BufferLayoutID /*layoutID*/)
 {
 	if (_res)
@@ -178,7 +243,11 @@ bool Texture::LoadImageDataFromFile(Path path)
 	if (!LoadDataBuffer(path, db)) {
 		return false;
 	}
-	return SetImageData(std::move(db), GetImageFileFormat(path));
+	if (!SetImageData(std::move(db), GetImageFileFormat(path)))
+		return false;
+	if (_initDesc.FlagsEx & TEXTURE_COMPRESS_IMAGE_DATA)
+		CompressImageData(); // On failure, the original image data is kept.
+	return true;
 }
 
 bool Texture::SetImageData(DataBuffer&& db, ImageFileFormat fmt, TextureDesc* descHint)
@@ -186,12 +255,6 @@ bool Texture::SetImageData(DataBuffer&& db, ImageFileFormat fmt, TextureDesc* de
 	if (fmt == IFF_UNKNOWN)
 		return false;
 
-	if (fmt == IFF_TGA)
-	{
-		msg(FATAL, MTEXT("TGA-images are only supported through Texture dialog import."));
-		return false;
-	}
-
 	if (descHint)
 		_initDesc = *descHint;
 	else {
@@ -205,10 +268,80 @@ bool Texture::SetImageData(DataBuffer&& db, ImageFileFormat fmt, TextureDesc* de
 	_imageData = std::move(db);
 	_imageFileFormat = fmt;
 	ClearResource(); // Clear texture and views!
+	_startDecodeJob();
 
 	return true;
 }
 
+// Decodes the formats our own decoders do not handle (JPG, TIFF, GIF, WMP) to R8G8B8A8.
+static bool _decodeWIC(const DataBuffer &db, DecodedImage &img)
+{
+	ComPtr<IWICImagingFactory> factory;
+	if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory))))
+		return false;
+	ComPtr<IWICStream> stream;
+	if (FAILED(factory->CreateStream(&stream)) || FAILED(stream->InitializeFromMemory(const_cast<BYTE*>(db.getConstBuffer()), (DWORD)db.getBufferSize())))
+		return false;
+	ComPtr<IWICBitmapDecoder> decoder;
+	if (FAILED(factory->CreateDecoderFromStream(stream, nullptr, WICDecodeMetadataCacheOnDemand, &decoder)))
+		return false;
+	ComPtr<IWICBitmapFrameDecode> frame;
+	if (FAILED(decoder->GetFrame(0, &frame)))
+		return false;
+	ComPtr<IWICBitmapSource> rgba;
+	if (FAILED(WICConvertBitmapSource(GUID_WICPixelFormat32bppRGBA, frame, &rgba)))
+		return false;
+	UINT w = 0, h = 0;
+	if (FAILED(rgba->GetSize(&w, &h)) || w == 0 || h == 0)
+		return false;
+	img.InitRGBA8(w, h);
+	return SUCCEEDED(rgba->CopyPixels(nullptr, w * 4, (UINT)img.data.size(), &img.data.front()));
+}
+
+bool Texture::ProcessImageData(const TextureProcessingOptions &options, TextureProcessingStats *stats)
+{
+	if (!HasImageData())
+		return false;
+
+	DecodedImage img;
+	bool decoded = false;
+	if (_decodeJob) {
+		_decodeJob->done.wait();
+		if (_decodeJob->decoded) {
+			img = _decodeJob->image; // Copy. The job may be shared with other textures.
+			decoded = true;
+		}
+	}
+	if (!decoded && GetImageCodecType(_imageFileFormat) == ICT_WIC)
+		decoded = _decodeWIC(_imageData, img);
+	if (!decoded) {
+		msg(WARN, MTEXT("Texture \'") + GetName() + MTEXT("\': The image data could not be decoded for processing."));
+		return false;
+	}
+
+	if (!textureprocessing::Process(img, options, stats)) {
+		msg(WARN, MTEXT("Texture \'") + GetName() + MTEXT("\': The image data could not be processed. It may already be block compressed."));
+		return false;
+	}
+
+	List<uint8> dds;
+	if (!textureprocessing::WriteDDS(img, dds))
+		return false;
+	if (stats)
+		stats->outputBytes = dds.size();
+
+	return SetImageData(DataBuffer(&dds.front(), dds.size()), IFF_DDS);
+}
+
+bool Texture::CompressImageData()
+{
+	TextureProcessingOptions options;
+	options.compression = TextureCompression::BC7;
+	options.sRGB = (_initDesc.FlagsEx & TEXTURE_FORCE_SRGB) != 0;
+	options.sRGBFormat = false; // TEXTURE_FORCE_SRGB selects the sRGB format when uploaded.
+	return ProcessImageData(options);
+}
+
 bool Texture::SaveTextureToImageData(ImageFileFormat fmt)
 {
 	return _saveTextureToImageData(GetResource(), fmt);
@@ -241,6 +374,48 @@ void Texture::ClearImageData()
 {
 	_imageData.clear();
 	_imageFileFormat = IFF_UNKNOWN;
+	_decodeJob = nullptr;
+}
+
+void Texture::_startDecodeJob()
+{
+	_decodeJob = nullptr;
+
+	switch (_imageFileFormat)
+	{
+	case IFF_DDS:
+	case IFF_PNG:
+	case IFF_BMP:
+	case IFF_TGA:
+		break;
+	default:
+		return; // Left to the platform decoders when the texture is created.
+	}
+
+	if (_imageData.getBufferSize() == 0)
+		return;
+
+	std::shared_ptr<TextureDecodeJob> job = std::make_shared<TextureDecodeJob>();
+	job->source = _imageData;
+	job->format = _imageFileFormat;
+	// The task only holds a weak reference, so the job does not keep itself alive through its future.
+	job->done = ThreadPool::GetShared().Submit([weak = std::weak_ptr<TextureDecodeJob>(job)]() {
+		std::shared_ptr<TextureDecodeJob> job = weak.lock();
+		if (!job)
+			return; // The texture is gone.
+		const uint8 *data = job->source.getConstBuffer();
+		size_t size = job->source.getBufferSize();
+		switch (job->format)
+		{
+		case IFF_DDS: job->decoded = imagedecoder::DecodeDDS(data, size, job->image); break;
+		case IFF_PNG: job->decoded = imagedecoder::DecodePNG(data, size, job->image); break;
+		case IFF_BMP: job->decoded = imagedecoder::DecodeBMP(data, size, job->image); break;
+		case IFF_TGA: job->decoded = imagedecoder::DecodeTGA(data, size, job->image); break;
+		default: break;
+		}
+		job->source.clear();
+	});
+	_decodeJob = job;
 }
 
 
@@ -260,7 +435,8 @@ void Texture::_createTexture()
 	//desc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R32G32B32A32_FLOAT, 64, 16, 1);
 
 	if (_initDesc.FlagsEx & (TEXTURE_USE_BACKBUFFER_SIZE_BY_PERCENT | TEXTURE_USE_BACKBUFFER_FORMAT)) {
-		D3D12RenderWindow* rw = (D3D12RenderWindow*)graphics()->GetRenderWindowManager()->GetRenderWindow();
+		RenderWindowManager* rwm = graphics()->GetRenderWindowManager();
+		D3D12RenderWindow* rw = rwm ? (D3D12RenderWindow*)rwm->GetRenderWindow() : nullptr;
 		if (!rw)
 			throw GraphicsException(this, MTEXT("Failed to create a back buffer dependent texture because we found no render window!"));
 		ID3D12Resource* bb = rw->GetBackBuffer();
@@ -389,50 +565,83 @@ void Texture::_loadTextureFromImageData()
 	DDS_ALPHA_MODE alphaMode;
 	bool isCubeMap;
 
-	HRESULT hr;
+	HRESULT hr = S_OK;
 
 	ResourceUploadBatch* rub = graphics()->GetResourceUploadBatch();
 
-	try
+	// The decoded image is only needed for this upload, so the job is released when done. If the texture is recreated
+	// later, eg after a device reset, the image data is decoded again.
+	std::shared_ptr<TextureDecodeJob> job = std::move(_decodeJob);
+
+	// Only read-only textures from shared image data can be shared. They are never written to, so they get no state tracker.
+	bool shareable = _imageData.isShared() && resFlags == D3D12_RESOURCE_FLAG_NONE;
+	bool shared = false;
+	if (shareable) {
+		for (SharedTexture& n : _sharedTextures) {
+			if (n.data.getConstBuffer() == _imageData.getConstBuffer() && n.device == d.get() && n.flagsEx == _initDesc.FlagsEx) {
+				_res = n.res;
+				n.users++;
+				_sharesResource = shared = true;
+				break;
+			}
+		}
+	}
+
+	if (!shared) {
+		if (!job) {
+			_startDecodeJob();
+			job = std::move(_decodeJob);
+		}
+		if (job)
+			job->done.wait(); // Normally done long ago!
+	}
+
+	if (!shared)
 	{
-		struct RUB
+		try
 		{
-			Graphics* g;
-			ResourceUploadBatch* rub;
-			RUB(Graphics* g, ResourceUploadBatch* rub) : g(g), rub(rub) { rub->Begin(); }
-			~RUB()
+			struct RUB
 			{
-				auto uploadResourcesFinished = rub->End(g->GetCommandQueue());
-
-				// Wait for the upload thread to terminate
-				uploadResourcesFinished.wait();
+				Graphics* g;
+				ResourceUploadBatch* rub;
+				RUB(Graphics* g, ResourceUploadBatch* rub) : g(g), rub(rub) { rub->Begin(); }
+				~RUB()
+				{
+					auto uploadResourcesFinished = rub->End(g->GetCommandQueue());
+
+					// Wait for the upload thread to terminate
+					uploadResourcesFinished.wait();
+				}
+			} Rub(graphics(), rub); // We need this to ensure End() is always called!
+
+			if (job && job->decoded)
+				_uploadDecodedImage(*rub, job->image); // Throws!
+			else switch (GetImageCodecType(_imageFileFormat))
+			{
+			case ICT_DDS:
+				hr = CreateDDSTextureFromMemoryEx(device(), *rub, _imageData.getConstBuffer(), _imageData.getBufferSize(), 0, resFlags, loadFlags, &_res, &alphaMode, &isCubeMap);
+				break;
+			case ICT_WIC:
+				hr = CreateWICTextureFromMemoryEx(device(), *rub, _imageData.getConstBuffer(), _imageData.getBufferSize(), 0, resFlags, loadFlagsWIC, &_res);
+				break;
+			case ICT_TGA:
+				throw GraphicsException(this, MTEXT("Failed to decode TGA image. Please convert to DDS using the Texture dialog!"));
+			case ICT_HDR:
+				throw GraphicsException(this, MTEXT("HDR files are not supported. Please convert to DDS using the Texture dialog!"));
+				break;
+			default:
+				break;
 			}
-		} Rub(graphics(), rub); // We need this to ensure End() is always called!
 
-		switch (GetImageCodecType(_imageFileFormat))
-		{
-		case ICT_DDS:
-			hr = CreateDDSTextureFromMemoryEx(device(), *rub, _imageData.getConstBuffer(), _imageData.getBufferSize(), 0, resFlags, loadFlags, &_res, &alphaMode, &isCubeMap);
-			break;
-		case ICT_WIC:
-			hr = CreateWICTextureFromMemoryEx(device(), *rub, _imageData.getConstBuffer(), _imageData.getBufferSize(), 0, resFlags, loadFlagsWIC, &_res);
-			break;
-		case ICT_TGA:
-		case ICT_HDR:
-			throw GraphicsException(this, MTEXT("TGA and HDR files are not supported. Please convert to DDS using the Texture dialog!"));
-			break;
-		default:
-			break;
+			if (FAILED(hr)) {
+				throw GraphicsException(this, MTEXT("Failed to create texture from image data!"));
+			}
 		}
-
-		if (FAILED(hr)) {
-			throw GraphicsException(this, MTEXT("Failed to create texture from image data!"));
+		catch (const std::exception& e)
+		{
+			throw GraphicsException(this, MTEXT("Failed to create texture from image data: ") + String(e.what()) + MTEXT("."));
 		}
 	}
-	catch (const std::exception& e)
-	{
-		throw GraphicsException(this, MTEXT("Failed to create texture from image data: ") + String(e.what()) + MTEXT("."));
-	}
 
 	D3D12_RESOURCE_DESC rd = _res->GetDesc();
 	_initDesc.Width = rd.Width;
@@ -448,10 +657,72 @@ void Texture::_loadTextureFromImageData()
 	// There is no need for a resource barrier as long as the resource is not RTV/DSV/UTV. The resource is promoted from common to shader resource state!
 	// ref: https://docs.microsoft.com/nb-no/windows/win32/direct3d12/using-resource-barriers-to-synchronize-resource-states-in-direct3d-12.
 	// It can even be used as copy src/dest without the need of barriers.
-	CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(_res, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COMMON);
-	graphics()->rs()->ResourceBarrier(1, &barrier);
+	if (!shared) {
+		CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(_res, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COMMON);
+		graphics()->rs()->ResourceBarrier(1, &barrier);
+
+		if (shareable) {
+			_sharedTextures.push_back({ _imageData, d.get(), _initDesc.FlagsEx, _res, 1 });
+			_sharesResource = true;
+		}
+		else
+			_createStateTracker(D3D12_RESOURCE_STATE_COMMON);
+	}
+}
+
+uint64 Texture::GetMemoryUsage() const
+{
+	return GraphicsResourceChip::GetMemoryUsage() + (sizeof(Texture) - sizeof(GraphicsResourceChip)) + _imageData.getBufferSize();
+}
+
+uint64 Texture::GetSubsystemMemoryUsage(MemorySubsystem subsystem) const
+{
+	if (subsystem != MemorySubsystem::TEXTURES || !_res)
+		return 0;
+	D3D12_RESOURCE_DESC desc = _res->GetDesc();
+	return device()->GetResourceAllocationInfo(0, 1, &desc).SizeInBytes;
+}
+
+void Texture::_uploadDecodedImage(ResourceUploadBatch &rub, const DecodedImage &img)
+{
+	DXGI_FORMAT format = (DXGI_FORMAT)img.format;
+	if (_initDesc.FlagsEx & TEXTURE_FORCE_SRGB)
+		format = (DXGI_FORMAT)imagedecoder::MakeSRGB(img.format);
+
+	UINT16 mipLevels = (UINT16)img.mipLevels;
+	bool genMips = (_initDesc.FlagsEx & TEXTURE_GEN_MIPMAPS) && img.mipLevels == 1 && img.arraySize == 1 && img.dimension == 2 && rub.IsSupportedForGenerateMips(format);
+	if (genMips) {
+		mipLevels = 1;
+		for (uint32 s = std::max(img.width, img.height); s > 1; s >>= 1)
+			mipLevels++;
+	}
+
+	D3D12_RESOURCE_FLAGS resFlags = (D3D12_RESOURCE_FLAGS)_initDesc.Flags;
+	D3D12_RESOURCE_DESC desc;
+	if (img.dimension == 3)
+		desc = CD3DX12_RESOURCE_DESC::Tex3D(format, img.width, img.height, (UINT16)img.depth, mipLevels, resFlags);
+	else if (img.dimension == 1)
+		desc = CD3DX12_RESOURCE_DESC::Tex1D(format, img.width, (UINT16)img.arraySize, mipLevels, resFlags);
+	else
+		desc = CD3DX12_RESOURCE_DESC::Tex2D(format, img.width, img.height, (UINT16)img.arraySize, mipLevels, 1, 0, resFlags);
+
+	CD3DX12_HEAP_PROPERTIES hp(D3D12_HEAP_TYPE_DEFAULT);
+	HRESULT hr = device()->CreateCommittedResource(&hp, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&_res));
+	if (FAILED(hr))
+		throw GraphicsException(this, MTEXT("Failed to create texture from image data!"));
+
+	List<D3D12_SUBRESOURCE_DATA> srd(img.subresources.size());
+	for (size_t i = 0; i < srd.size(); i++) {
+		const DecodedImage::Subresource &s = img.subresources[i];
+		srd[i].pData = img.data.data() + s.offset;
+		srd[i].RowPitch = s.rowPitch;
+		srd[i].SlicePitch = s.slicePitch;
+	}
 
-	_createStateTracker(D3D12_RESOURCE_STATE_COMMON);
+	rub.Upload(_res, 0, srd.data(), (UINT)srd.size());
+	rub.Transition(_res, D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE); // Same state as the DirectXTK loaders leave it in.
+	if (genMips)
+		rub.GenerateMips(_res);
 }
 
 bool Texture::_saveTextureToImageData(ID3D12Resource* res, ImageFileFormat fmt)
@@ -29,6 +29,11 @@
 #include "M3DCore/DataBuffer.h"
 #include "GraphicsDefines.h"
 
+namespace DirectX
+{
+	class ResourceUploadBatch;
+}
+
 namespace m3d
 {
 
@@ -42,6 +47,11 @@ enum ImageCodecType { ICT_UNKNOWN, ICT_DDS, ICT_WIC, ICT_TGA, ICT_HDR };
 ImageFileFormat GRAPHICSCHIPS_API GetImageFileFormat(Path file);
 ImageCodecType GRAPHICSCHIPS_API GetImageCodecType(ImageFileFormat fmt);
 
+struct DecodedImage;
+class TextureDecodeJob;
+struct TextureProcessingOptions;
+struct TextureProcessingStats;
+
 
 enum TEXTURE_DESC_FLAGS
 {
@@ -49,7 +59,8 @@ enum TEXTURE_DESC_FLAGS
 	TEXTURE_USE_BACKBUFFER_FORMAT = 2,
 	TEXTURE_unused = 4,
 	TEXTURE_FORCE_SRGB = 8,
-	TEXTURE_GEN_MIPMAPS = 16
+	TEXTURE_GEN_MIPMAPS = 16,
+	TEXTURE_COMPRESS_IMAGE_DATA = 32 // Generate mips and BC7 compress image data loaded from file. See CompressImageData().
 };
 
 
@@ -77,6 +88,7 @@ class GRAPHICSCHIPS_API Texture : public GraphicsResourceChip
 	CHIPDESC_DECL; 
 public:
 	Texture();
+	~Texture() override;
 
 	bool CopyChip(Chip* chip) override;
 	bool LoadChip(DocumentLoader& loader) override;
@@ -94,6 +106,10 @@ public:
 	virtual ImageFileFormat GetImageDataFileFormat() const { return _imageFileFormat; }
 
 	void OnReleasingBackBuffer(RenderWindow* rw) override;
+	void ClearResource() override;
+
+	uint64 GetMemoryUsage() const override;
+	uint64 GetSubsystemMemoryUsage(MemorySubsystem subsystem) const override;
 
 	// Creates the texture if it does not exist!
 	void UpdateChip(BufferLayoutID layoutID = InvalidBufferLayoutID) override;
@@ -102,6 +118,11 @@ public:
 	virtual bool LoadImageDataFromFile(Path path);
 	// Sets the image data, and clears current texture. Data is moved, not copied!
 	virtual bool SetImageData(DataBuffer&& db, ImageFileFormat fmt, TextureDesc* descHint = nullptr);
+	// Generates mips and block compresses the image data on the CPU, and stores the result back as DDS. Meant to be done at import time.
+	virtual bool ProcessImageData(const TextureProcessingOptions &options, TextureProcessingStats *stats = nullptr);
+	// Generates mips and compresses the image data to BC7, filtering in linear space if TEXTURE_FORCE_SRGB is set.
+	// Done by LoadImageDataFromFile() when TEXTURE_COMPRESS_IMAGE_DATA is set. On failure, the image data is kept.
+	virtual bool CompressImageData();
 	// Saves current texture to image data with given file format.
 	virtual bool SaveTextureToImageData(ImageFileFormat fmt = IFF_DDS);
 	// Saves current texture (not image data!) to file.
@@ -119,12 +140,19 @@ protected:
 	DataBuffer _imageData;
 	// The file format of the image data.
 	ImageFileFormat _imageFileFormat = IFF_UNKNOWN;
+	// Decodes the image data on a worker thread, so that creating the texture only has to upload it. Started when image data is set or loaded.
+	std::shared_ptr<TextureDecodeJob> _decodeJob;
+	// true if _res is shared with other textures created from the same image data.
+	bool _sharesResource = false;
 
 private:
 	void _createTexture();
+	void _startDecodeJob();
 	void _loadTextureFromImageData();
+	void _uploadDecodedImage(DirectX::ResourceUploadBatch &rub, const DecodedImage &img);
 	bool _saveTextureToImageData(ID3D12Resource* res, ImageFileFormat fmt = IFF_UNKNOWN);
 	void _createStateTracker(D3D12_RESOURCE_STATES initStates);
+	void _releaseSharedResource();
 };
 
 }
@@ -0,0 +1,1053 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "TextureProcessing.h"
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include "M3DCore/Clock.h"
+#include "M3DCore/ThreadPool.h"
+
+using namespace m3d;
+using namespace m3d::textureprocessing;
+
+
+namespace
+{
+
+bool _isRGBA8(M3D_FORMAT fmt)
+{
+	return fmt == M3D_FORMAT_R8G8B8A8_UNORM || fmt == M3D_FORMAT_R8G8B8A8_UNORM_SRGB;
+}
+
+template<typename T>
+inline T _clamp(T v, T lo, T hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Mip generation
+/////////////////////////////////////////////////////////////////////////////
+
+struct SRGBTable
+{
+	float32 toLinear[256];
+	SRGBTable()
+	{
+		for (uint32 i = 0; i < 256; i++) {
+			float32 c = i / 255.0f;
+			toLinear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+		}
+	}
+};
+
+const SRGBTable &_srgbTable()
+{
+	static const SRGBTable table;
+	return table;
+}
+
+inline float32 _linearToSRGB(float32 c)
+{
+	return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+inline uint8 _toUNORM8(float32 c)
+{
+	return uint8(_clamp(c, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+
+const float64 PI = 3.14159265358979323846;
+// Kaiser windowed sinc. The radius is in destination pixels.
+const float64 KAISER_RADIUS = 2.0;
+const float64 KAISER_ALPHA = 4.0;
+
+float64 _besselI0(float64 x)
+{
+	float64 sum = 1.0, term = 1.0;
+	for (uint32 k = 1; k < 50; k++) {
+		float64 f = x / (2.0 * k);
+		term *= f * f;
+		sum += term;
+		if (term < sum * 1.0e-12)
+			break;
+	}
+	return sum;
+}
+
+float64 _kaiser(float64 t)
+{
+	float64 x = t / KAISER_RADIUS;
+	if (std::abs(x) >= 1.0)
+		return 0.0;
+	float64 sinc = t == 0.0 ? 1.0 : std::sin(PI * t) / (PI * t);
+	return sinc * _besselI0(KAISER_ALPHA * std::sqrt(1.0 - x * x)) / _besselI0(KAISER_ALPHA);
+}
+
+// Filter weights for resampling one dimension. Taps outside the image are clamped to the edge.
+struct FilterTaps
+{
+	struct Tap
+	{
+		uint32 src;
+		float32 weight;
+	};
+	List<uint32> start; // Taps for destination i are [start[i], start[i + 1]).
+	List<Tap> taps;
+};
+
+void _buildTaps(uint32 srcSize, uint32 dstSize, TextureMipFilter filter, FilterTaps &ft)
+{
+	ft.start.clear();
+	ft.taps.clear();
+
+	float64 scale = float64(srcSize) / dstSize;
+	float64 radius = (filter == TextureMipFilter::BOX ? 0.5 : KAISER_RADIUS) * scale; // In source pixels.
+
+	for (uint32 x = 0; x < dstSize; x++) {
+		size_t first = ft.taps.size();
+		ft.start.push_back(uint32(first));
+
+		float64 center = (x + 0.5) * scale;
+		int32 i0 = int32(std::floor(center - radius)), i1 = int32(std::ceil(center + radius));
+		float64 sum = 0.0;
+		for (int32 i = i0; i < i1; i++) {
+			float64 w;
+			if (filter == TextureMipFilter::BOX) // Area of the source pixel covered by the footprint. Handles odd sizes.
+				w = std::max(0.0, std::min(i + 1.0, center + radius) - std::max(float64(i), center - radius));
+			else
+				w = _kaiser((i + 0.5 - center) / scale);
+			if (w == 0.0)
+				continue;
+			uint32 src = uint32(_clamp(i, 0, int32(srcSize) - 1));
+			size_t j = first;
+			for (; j < ft.taps.size() && ft.taps[j].src != src; j++);
+			if (j == ft.taps.size())
+				ft.taps.push_back({ src, 0.0f });
+			ft.taps[j].weight += float32(w);
+			sum += w;
+		}
+		for (size_t j = first; j < ft.taps.size(); j++)
+			ft.taps[j].weight = float32(ft.taps[j].weight / sum);
+	}
+	ft.start.push_back(uint32(ft.taps.size()));
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// Block compression
+/////////////////////////////////////////////////////////////////////////////
+
+typedef uint8 Block[16][4];
+
+// Principal axis of the points (first N channels), found by power iteration on the covariance matrix.
+template<uint32 N>
+void _principalAxis(const float32 (*p)[4], uint32 count, float32 mean[4], float32 axis[4])
+{
+	for (uint32 c = 0; c < 4; c++)
+		mean[c] = axis[c] = 0.0f;
+	for (uint32 i = 0; i < count; i++)
+		for (uint32 c = 0; c < N; c++)
+			mean[c] += p[i][c];
+	for (uint32 c = 0; c < N; c++)
+		mean[c] /= count;
+
+	float32 cov[N][N] = {};
+	for (uint32 i = 0; i < count; i++) {
+		float32 d[N];
+		for (uint32 c = 0; c < N; c++)
+			d[c] = p[i][c] - mean[c];
+		for (uint32 r = 0; r < N; r++)
+			for (uint32 c = 0; c < N; c++)
+				cov[r][c] += d[r] * d[c];
+	}
+
+	// Start with the row of the channel with the largest variance.
+	uint32 k = 0;
+	for (uint32 c = 1; c < N; c++)
+		if (cov[c][c] > cov[k][k])
+			k = c;
+	if (cov[k][k] <= 0.0f)
+		return; // All points are equal.
+
+	float32 v[N];
+	for (uint32 c = 0; c < N; c++)
+		v[c] = cov[k][c];
+	for (uint32 it = 0; it < 8; it++) {
+		float32 t[N] = {}, m = 0.0f;
+		for (uint32 r = 0; r < N; r++) {
+			for (uint32 c = 0; c < N; c++)
+				t[r] += cov[r][c] * v[c];
+			m = std::max(m, std::abs(t[r]));
+		}
+		if (m == 0.0f)
+			return;
+		for (uint32 c = 0; c < N; c++)
+			v[c] = t[c] / m;
+	}
+	float32 l = 0.0f;
+	for (uint32 c = 0; c < N; c++)
+		l += v[c] * v[c];
+	l = std::sqrt(l);
+	for (uint32 c = 0; c < N; c++)
+		axis[c] = v[c] / l;
+}
+
+// End points along the principal axis, spanning all points.
+template<uint32 N>
+void _fitEndpoints(const float32 (*p)[4], uint32 count, float32 e0[4], float32 e1[4])
+{
+	float32 mean[4], axis[4];
+	_principalAxis<N>(p, count, mean, axis);
+	float32 tMin = 0.0f, tMax = 0.0f;
+	for (uint32 i = 0; i < count; i++) {
+		float32 t = 0.0f;
+		for (uint32 c = 0; c < N; c++)
+			t += (p[i][c] - mean[c]) * axis[c];
+		tMin = std::min(tMin, t);
+		tMax = std::max(tMax, t);
+	}
+	for (uint32 c = 0; c < 4; c++) {
+		e0[c] = _clamp(mean[c] + axis[c] * tMin, 0.0f, 255.0f);
+		e1[c] = _clamp(mean[c] + axis[c] * tMax, 0.0f, 255.0f);
+	}
+}
+
+// Least squares end points for points p with interpolation weights t (0 gives e0, 1 gives e1). Returns false if the system is singular.
+template<uint32 N>
+bool _refineEndpoints(const float32 (*p)[4], const float32 *t, uint32 count, float32 e0[4], float32 e1[4])
+{
+	float32 a = 0.0f, b = 0.0f, c = 0.0f, x[N] = {}, y[N] = {};
+	for (uint32 i = 0; i < count; i++) {
+		float32 s = 1.0f - t[i];
+		a += s * s;
+		b += s * t[i];
+		c += t[i] * t[i];
+		for (uint32 j = 0; j < N; j++) {
+			x[j] += s * p[i][j];
+			y[j] += t[i] * p[i][j];
+		}
+	}
+	float32 det = a * c - b * b;
+	if (std::abs(det) < 1.0e-6f)
+		return false;
+	for (uint32 j = 0; j < N; j++) {
+		e0[j] = _clamp((c * x[j] - b * y[j]) / det, 0.0f, 255.0f);
+		e1[j] = _clamp((a * y[j] - b * x[j]) / det, 0.0f, 255.0f);
+	}
+	return true;
+}
+
+inline uint16 _to565(const float32 c[4])
+{
+	uint32 r = uint32(_clamp(c[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+	uint32 g = uint32(_clamp(c[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+	uint32 b = uint32(_clamp(c[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+	return uint16((r << 11) | (g << 5) | b);
+}
+
+inline void _from565(uint16 v, int32 c[3])
+{
+	int32 r = v >> 11, g = (v >> 5) & 63, b = v & 31;
+	c[0] = (r << 3) | (r >> 2);
+	c[1] = (g << 2) | (g >> 4);
+	c[2] = (b << 3) | (b >> 2);
+}
+
+// The BC1 palette. In three color mode (c0 <= c1), entry 3 is transparent black.
+void _bc1Palette(uint16 c0, uint16 c1, bool fourColors, int32 pal[4][4])
+{
+	_from565(c0, pal[0]);
+	_from565(c1, pal[1]);
+	pal[0][3] = pal[1][3] = 255;
+	for (uint32 c = 0; c < 3; c++) {
+		if (fourColors) {
+			pal[2][c] = (2 * pal[0][c] + pal[1][c] + 1) / 3;
+			pal[3][c] = (pal[0][c] + 2 * pal[1][c] + 1) / 3;
+		}
+		else {
+			pal[2][c] = (pal[0][c] + pal[1][c] + 1) / 2;
+			pal[3][c] = 0;
+		}
+	}
+	pal[2][3] = 255;
+	pal[3][3] = fourColors ? 255 : 0;
+}
+
+// Encodes the color part of a BC1/BC3 block. With allowTransparent, pixels with alpha below 128 use the transparent entry in three color mode.
+void _encodeBC1(const Block &px, uint8 *out, bool allowTransparent)
+{
+	float32 p[16][4];
+	uint32 map[16]; // Pixel to point, or 16 for transparent pixels.
+	uint32 count = 0;
+	for (uint32 i = 0; i < 16; i++) {
+		if (allowTransparent && px[i][3] < 128) {
+			map[i] = 16;
+			continue;
+		}
+		for (uint32 c = 0; c < 4; c++)
+			p[count][c] = px[i][c];
+		map[i] = count++;
+	}
+
+	bool fourColors = count == 16;
+	uint16 best0 = 0, best1 = 0;
+	uint32 bestIndices = 0xFFFFFFFF; // All transparent.
+
+	if (count > 0) {
+		static const float32 T4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+		static const float32 T3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+		float32 e0[4], e1[4];
+		_fitEndpoints<3>(p, count, e1, e0);
+
+		uint32 bestError = 0xFFFFFFFF;
+		for (uint32 it = 0; it < 3; it++) {
+			uint16 c0 = _to565(e0), c1 = _to565(e1);
+			if (fourColors ? c0 < c1 : c0 > c1)
+				std::swap(c0, c1);
+			bool equal = c0 == c1; // Decodes as three color mode. Only entry 0 is safe to use.
+
+			int32 pal[4][4];
+			_bc1Palette(c0, c1, fourColors && !equal, pal);
+			uint32 entries = equal ? 1 : (fourColors ? 4 : 3);
+
+			uint32 indices = 0, error = 0;
+			float32 t[16];
+			for (uint32 i = 0; i < 16; i++) {
+				uint32 idx = 3;
+				if (map[i] < 16) {
+					uint32 e = 0xFFFFFFFF;
+					for (uint32 j = 0; j < entries; j++) {
+						int32 dr = pal[j][0] - px[i][0], dg = pal[j][1] - px[i][1], db = pal[j][2] - px[i][2];
+						uint32 d = uint32(dr * dr + dg * dg + db * db);
+						if (d < e) {
+							e = d;
+							idx = j;
+						}
+					}
+					error += e;
+					t[map[i]] = (fourColors ? T4 : T3)[idx];
+				}
+				indices |= idx << (2 * i);
+			}
+			if (error < bestError) {
+				bestError = error;
+				best0 = c0;
+				best1 = c1;
+				bestIndices = indices;
+			}
+			if (error == 0 || equal)
+				break;
+			// The decoded end points are what matter, so refine from those.
+			if (!_refineEndpoints<3>(p, t, count, e0, e1))
+				break;
+		}
+	}
+
+	out[0] = uint8(best0);
+	out[1] = uint8(best0 >> 8);
+	out[2] = uint8(best1);
+	out[3] = uint8(best1 >> 8);
+	for (uint32 i = 0; i < 4; i++)
+		out[4 + i] = uint8(bestIndices >> (8 * i));
+}
+
+void _bc4Palette(uint8 a0, uint8 a1, int32 pal[8])
+{
+	pal[0] = a0;
+	pal[1] = a1;
+	if (a0 > a1) {
+		for (int32 i = 2; i < 8; i++)
+			pal[i] = ((8 - i) * a0 + (i - 1) * a1 + 3) / 7;
+	}
+	else {
+		for (int32 i = 2; i < 6; i++)
+			pal[i] = ((6 - i) * a0 + (i - 1) * a1 + 2) / 5;
+		pal[6] = 0;
+		pal[7] = 255;
+	}
+}
+
+uint32 _bc4Indices(uint8 a0, uint8 a1, const uint8 v[16], uint64 &indices)
+{
+	int32 pal[8];
+	_bc4Palette(a0, a1, pal);
+	uint32 error = 0;
+	indices = 0;
+	for (uint32 i = 0; i < 16; i++) {
+		uint32 idx = 0, e = 0xFFFFFFFF;
+		for (uint32 j = 0; j < 8; j++) {
+			uint32 d = uint32((pal[j] - v[i]) * (pal[j] - v[i]));
+			if (d < e) {
+				e = d;
+				idx = j;
+			}
+		}
+		error += e;
+		indices |= uint64(idx) << (3 * i);
+	}
+	return error;
+}
+
+// Encodes a single channel block (BC4, and the alpha of BC3).
+void _encodeBC4(const uint8 v[16], uint8 *out)
+{
+	uint8 lo = 255, hi = 0, lo6 = 255, hi6 = 0;
+	for (uint32 i = 0; i < 16; i++) {
+		lo = std::min(lo, v[i]);
+		hi = std::max(hi, v[i]);
+		if (v[i] > 0 && v[i] < 255) {
+			lo6 = std::min(lo6, v[i]);
+			hi6 = std::max(hi6, v[i]);
+		}
+	}
+
+	uint8 a0 = hi, a1 = lo;
+	uint64 indices = 0;
+	uint32 error = _bc4Indices(a0, a1, v, indices);
+
+	// Six value mode has exact 0 and 255, which helps when only a few pixels are at the extremes.
+	if (error > 0 && (lo == 0 || hi == 255) && lo6 <= hi6) {
+		uint64 indices6 = 0;
+		uint32 error6 = _bc4Indices(lo6, hi6, v, indices6);
+		if (error6 < error) {
+			a0 = lo6;
+			a1 = hi6;
+			indices = indices6;
+		}
+	}
+
+	out[0] = a0;
+	out[1] = a1;
+	for (uint32 i = 0; i < 6; i++)
+		out[2 + i] = uint8(indices >> (8 * i));
+}
+
+struct BitWriter
+{
+	uint8 *out;
+	uint32 pos = 0;
+	BitWriter(uint8 *out) : out(out) { std::memset(out, 0, 16); }
+	void Write(uint32 value, uint32 bits)
+	{
+		for (uint32 i = 0; i < bits; i++, pos++)
+			if ((value >> i) & 1)
+				out[pos >> 3] |= uint8(1 << (pos & 7));
+	}
+};
+
+struct BitReader
+{
+	const uint8 *in;
+	uint32 pos = 0;
+	BitReader(const uint8 *in) : in(in) {}
+	uint32 Read(uint32 bits)
+	{
+		uint32 v = 0;
+		for (uint32 i = 0; i < bits; i++, pos++)
+			v |= uint32((in[pos >> 3] >> (pos & 7)) & 1) << i;
+		return v;
+	}
+};
+
+const int32 BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+// Quantizes an end point to 7 bits per channel plus a shared p-bit, picking the p-bit that gives the smallest error.
+void _quantizeBC7Mode6(const float32 e[4], uint32 q[4], uint32 &pbit)
+{
+	float32 bestError = 1.0e30f;
+	for (uint32 p = 0; p < 2; p++) {
+		uint32 t[4];
+		float32 error = 0.0f;
+		for (uint32 c = 0; c < 4; c++) {
+			t[c] = uint32(_clamp(int32(std::floor((e[c] - p) * 0.5f + 0.5f)), 0, 127));
+			float32 d = float32((t[c] << 1) | p) - e[c];
+			error += d * d;
+		}
+		if (error < bestError) {
+			bestError = error;
+			pbit = p;
+			std::memcpy(q, t, sizeof(t));
+		}
+	}
+}
+
+// BC7 mode 6: One subset, RGBA end points with 7 bits + p-bit, and 4 bit indices.
+void _encodeBC7(const Block &px, uint8 *out)
+{
+	float32 p[16][4];
+	for (uint32 i = 0; i < 16; i++)
+		for (uint32 c = 0; c < 4; c++)
+			p[i][c] = px[i][c];
+
+	float32 e0[4], e1[4];
+	_fitEndpoints<4>(p, 16, e0, e1);
+
+	uint32 bestError = 0xFFFFFFFF, bestQ[2][4] = {}, bestP[2] = {}, bestIdx[16] = {};
+	for (uint32 it = 0; it < 3; it++) {
+		uint32 q[2][4], pb[2];
+		_quantizeBC7Mode6(e0, q[0], pb[0]);
+		_quantizeBC7Mode6(e1, q[1], pb[1]);
+
+		int32 ep[2][4];
+		for (uint32 c = 0; c < 4; c++) {
+			ep[0][c] = int32((q[0][c] << 1) | pb[0]);
+			ep[1][c] = int32((q[1][c] << 1) | pb[1]);
+		}
+		int32 pal[16][4];
+		for (uint32 j = 0; j < 16; j++)
+			for (uint32 c = 0; c < 4; c++)
+				pal[j][c] = ((64 - BC7_WEIGHTS4[j]) * ep[0][c] + BC7_WEIGHTS4[j] * ep[1][c] + 32) >> 6;
+
+		uint32 idx[16], error = 0;
+		float32 t[16];
+		for (uint32 i = 0; i < 16; i++) {
+			uint32 e = 0xFFFFFFFF;
+			for (uint32 j = 0; j < 16; j++) {
+				uint32 d = 0;
+				for (uint32 c = 0; c < 4; c++)
+					d += uint32((pal[j][c] - px[i][c]) * (pal[j][c] - px[i][c]));
+				if (d < e) {
+					e = d;
+					idx[i] = j;
+				}
+			}
+			error += e;
+			t[i] = BC7_WEIGHTS4[idx[i]] / 64.0f;
+		}
+		if (error < bestError) {
+			bestError = error;
+			std::memcpy(bestQ, q, sizeof(q));
+			std::memcpy(bestP, pb, sizeof(pb));
+			std::memcpy(bestIdx, idx, sizeof(idx));
+		}
+		if (error == 0 || !_refineEndpoints<4>(p, t, 16, e0, e1))
+			break;
+	}
+
+	// The MSB of the first index is implicitly 0. Swap the end points if needed.
+	if (bestIdx[0] & 8) {
+		for (uint32 c = 0; c < 4; c++)
+			std::swap(bestQ[0][c], bestQ[1][c]);
+		std::swap(bestP[0], bestP[1]);
+		for (uint32 i = 0; i < 16; i++)
+			bestIdx[i] = 15 - bestIdx[i];
+	}
+
+	BitWriter w(out);
+	w.Write(1 << 6, 7); // Mode 6.
+	for (uint32 c = 0; c < 4; c++) {
+		w.Write(bestQ[0][c], 7);
+		w.Write(bestQ[1][c], 7);
+	}
+	w.Write(bestP[0], 1);
+	w.Write(bestP[1], 1);
+	w.Write(bestIdx[0], 3);
+	for (uint32 i = 1; i < 16; i++)
+		w.Write(bestIdx[i], 4);
+}
+
+void _decodeBC1(const uint8 *in, Block &px, bool forceFourColors)
+{
+	uint16 c0 = uint16(in[0] | (in[1] << 8)), c1 = uint16(in[2] | (in[3] << 8));
+	int32 pal[4][4];
+	_bc1Palette(c0, c1, forceFourColors || c0 > c1, pal);
+	uint32 indices = uint32(in[4]) | (uint32(in[5]) << 8) | (uint32(in[6]) << 16) | (uint32(in[7]) << 24);
+	for (uint32 i = 0; i < 16; i++)
+		for (uint32 c = 0; c < 4; c++)
+			px[i][c] = uint8(pal[(indices >> (2 * i)) & 3][c]);
+}
+
+void _decodeBC4(const uint8 *in, Block &px, uint32 channel)
+{
+	int32 pal[8];
+	_bc4Palette(in[0], in[1], pal);
+	uint64 indices = 0;
+	for (uint32 i = 0; i < 6; i++)
+		indices |= uint64(in[2 + i]) << (8 * i);
+	for (uint32 i = 0; i < 16; i++)
+		px[i][channel] = uint8(pal[(indices >> (3 * i)) & 7]);
+}
+
+bool _decodeBC7(const uint8 *in, Block &px)
+{
+	BitReader r(in);
+	if (r.Read(7) != (1 << 6))
+		return false; // Only mode 6 is supported.
+	int32 ep[2][4];
+	for (uint32 c = 0; c < 4; c++) {
+		ep[0][c] = int32(r.Read(7)) << 1;
+		ep[1][c] = int32(r.Read(7)) << 1;
+	}
+	uint32 p0 = r.Read(1), p1 = r.Read(1);
+	for (uint32 c = 0; c < 4; c++) {
+		ep[0][c] |= p0;
+		ep[1][c] |= p1;
+	}
+	for (uint32 i = 0; i < 16; i++) {
+		int32 w = BC7_WEIGHTS4[r.Read(i == 0 ? 3 : 4)];
+		for (uint32 c = 0; c < 4; c++)
+			px[i][c] = uint8(((64 - w) * ep[0][c] + w * ep[1][c] + 32) >> 6);
+	}
+	return true;
+}
+
+// Calls fn(subresource index, z, block row) for all rows of blocks in the image, in parallel.
+template<typename F>
+void _forEachBlockRow(const DecodedImage &img, uint32 threadCount, F fn)
+{
+	struct Row { uint32 sub, z, y; };
+	List<Row> rows;
+	for (uint32 s = 0; s < img.subresources.size(); s++) {
+		const DecodedImage::Subresource &sr = img.subresources[s];
+		for (uint32 z = 0; z < sr.depth; z++)
+			for (uint32 y = 0; y < (sr.height + 3) / 4; y++)
+				rows.push_back({ s, z, y });
+	}
+	ThreadPool::GetShared().ParallelFor(uint32(rows.size()), [&](uint32 i) { fn(rows[i].sub, rows[i].z, rows[i].y); }, threadCount);
+}
+
+// Sets up dst with the same layout as src, but in another format.
+void _initLayout(const DecodedImage &src, DecodedImage &dst, M3D_FORMAT format)
+{
+	dst.dimension = src.dimension;
+	dst.width = src.width;
+	dst.height = src.height;
+	dst.depth = src.depth;
+	dst.arraySize = src.arraySize;
+	dst.mipLevels = src.mipLevels;
+	dst.format = format;
+	dst.cubeMap = src.cubeMap;
+	dst.subresources.clear();
+	size_t total = 0;
+	for (const DecodedImage::Subresource &sr : src.subresources) {
+		uint32 rowPitch, rowCount;
+		imagedecoder::GetSurfaceInfo(format, sr.width, sr.height, rowPitch, rowCount);
+		dst.subresources.push_back({ total, rowPitch, rowPitch * rowCount, sr.width, sr.height, sr.depth });
+		total += size_t(rowPitch) * rowCount * sr.depth;
+	}
+	dst.data.clear();
+	dst.data.resize(total);
+}
+
+}
+
+
+bool m3d::textureprocessing::GenerateMips(DecodedImage &img, TextureMipFilter filter, bool sRGB, bool normalMap, uint32 threadCount)
+{
+	if (!_isRGBA8(img.format) || img.dimension != 2 || img.arraySize != 1 || img.subresources.empty())
+		return false;
+	if (filter == TextureMipFilter::NONE)
+		return true;
+
+	const DecodedImage::Subresource top = img.subresources[0];
+	uint32 w = top.width, h = top.height;
+	const SRGBTable &srgb = _srgbTable();
+
+	// The top mip in linear space (or as vectors for normal maps).
+	List<float32> src(size_t(w) * h * 4);
+	List<uint8> data(size_t(w) * h * 4);
+	bool hasAlpha = false;
+	for (uint32 y = 0; y < h; y++) {
+		const uint8 *s = &img.data[top.offset + size_t(y) * top.rowPitch];
+		std::memcpy(&data[size_t(y) * w * 4], s, size_t(w) * 4);
+		float32 *d = &src[size_t(y) * w * 4];
+		for (uint32 x = 0; x < w; x++, s += 4, d += 4) {
+			for (uint32 c = 0; c < 3; c++)
+				d[c] = normalMap ? s[c] * (2.0f / 255.0f) - 1.0f : (sRGB ? srgb.toLinear[s[c]] : s[c] / 255.0f);
+			d[3] = s[3] / 255.0f;
+			hasAlpha = hasAlpha || s[3] < 255;
+		}
+	}
+
+	// Filter premultiplied colors, so that transparent pixels do not bleed into the visible ones.
+	bool premultiply = hasAlpha && !normalMap;
+	if (premultiply)
+		for (size_t i = 0; i < src.size(); i += 4)
+			for (uint32 c = 0; c < 3; c++)
+				src[i + c] *= src[i + 3];
+
+	List<DecodedImage::Subresource> subresources;
+	subresources.push_back({ 0, w * 4, w * h * 4, w, h, 1 });
+
+	List<float32> tmp, dst;
+	FilterTaps tx, ty;
+	while (w > 1 || h > 1) {
+		uint32 dw = std::max(1u, w / 2), dh = std::max(1u, h / 2);
+		_buildTaps(w, dw, filter, tx);
+		_buildTaps(h, dh, filter, ty);
+
+		// Horizontal pass.
+		tmp.resize(size_t(dw) * h * 4);
+		ThreadPool::GetShared().ParallelFor(h, [&](uint32 y) {
+			const float32 *s = &src[size_t(y) * w * 4];
+			float32 *d = &tmp[size_t(y) * dw * 4];
+			for (uint32 x = 0; x < dw; x++, d += 4) {
+				d[0] = d[1] = d[2] = d[3] = 0.0f;
+				for (uint32 t = tx.start[x]; t < tx.start[x + 1]; t++) {
+					const float32 *p = s + tx.taps[t].src * 4;
+					float32 wt = tx.taps[t].weight;
+					for (uint32 c = 0; c < 4; c++)
+						d[c] += p[c] * wt;
+				}
+			}
+		}, threadCount);
+
+		// Vertical pass, and conversion back to 8 bit.
+		dst.resize(size_t(dw) * dh * 4);
+		size_t offset = data.size();
+		data.resize(offset + size_t(dw) * dh * 4);
+		ThreadPool::GetShared().ParallelFor(dh, [&](uint32 y) {
+			float32 *d = &dst[size_t(y) * dw * 4];
+			std::fill(d, d + size_t(dw) * 4, 0.0f);
+			for (uint32 t = ty.start[y]; t < ty.start[y + 1]; t++) {
+				const float32 *s = &tmp[size_t(ty.taps[t].src) * dw * 4];
+				float32 wt = ty.taps[t].weight;
+				for (size_t i = 0; i < size_t(dw) * 4; i++)
+					d[i] += s[i] * wt;
+			}
+			uint8 *o = &data[offset + size_t(y) * dw * 4];
+			for (uint32 x = 0; x < dw; x++, d += 4, o += 4) {
+				d[3] = _clamp(d[3], 0.0f, 1.0f);
+				if (normalMap) {
+					float32 l = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+					if (l > 1.0e-6f) {
+						for (uint32 c = 0; c < 3; c++)
+							d[c] /= l;
+					}
+					else {
+						d[0] = d[1] = 0.0f;
+						d[2] = 1.0f;
+					}
+					for (uint32 c = 0; c < 3; c++)
+						o[c] = _toUNORM8(d[c] * 0.5f + 0.5f);
+				}
+				else {
+					float32 a = premultiply ? d[3] : 1.0f;
+					for (uint32 c = 0; c < 3; c++) {
+						d[c] = _clamp(d[c], 0.0f, a); // Kaiser has negative lobes.
+						float32 v = a > 0.0f ? d[c] / a : 0.0f;
+						o[c] = _toUNORM8(sRGB ? _linearToSRGB(v) : v);
+					}
+				}
+				o[3] = _toUNORM8(d[3]);
+			}
+		}, threadCount);
+
+		subresources.push_back({ offset, dw * 4, dw * dh * 4, dw, dh, 1 });
+		std::swap(src, dst);
+		w = dw;
+		h = dh;
+	}
+
+	img.data = std::move(data);
+	img.subresources = std::move(subresources);
+	img.mipLevels = uint32(img.subresources.size());
+	return true;
+}
+
+bool m3d::textureprocessing::Compress(const DecodedImage &src, DecodedImage &dst, TextureCompression compression, bool sRGB, uint32 threadCount)
+{
+	if (!_isRGBA8(src.format) || &src == &dst)
+		return false;
+
+	M3D_FORMAT format;
+	switch (compression)
+	{
+	case TextureCompression::NONE: format = M3D_FORMAT_R8G8B8A8_UNORM; break;
+	case TextureCompression::BC1: format = M3D_FORMAT_BC1_UNORM; break;
+	case TextureCompression::BC3: format = M3D_FORMAT_BC3_UNORM; break;
+	case TextureCompression::BC4: format = M3D_FORMAT_BC4_UNORM; break;
+	case TextureCompression::BC5: format = M3D_FORMAT_BC5_UNORM; break;
+	case TextureCompression::BC7: format = M3D_FORMAT_BC7_UNORM; break;
+	default: return false;
+	}
+	if (sRGB)
+		format = imagedecoder::MakeSRGB(format);
+
+	if (compression == TextureCompression::NONE) {
+		dst = src;
+		dst.format = format;
+		return true;
+	}
+
+	_initLayout(src, dst, format);
+	uint32 blockSize = imagedecoder::GetBitsPerPixel(format) / 8;
+
+	_forEachBlockRow(src, threadCount, [&](uint32 s, uint32 z, uint32 by) {
+		const DecodedImage::Subresource &ss = src.subresources[s], &ds = dst.subresources[s];
+		const uint8 *in = &src.data[ss.offset + size_t(z) * ss.slicePitch];
+		uint8 *out = &dst.data[ds.offset + size_t(z) * ds.slicePitch + size_t(by) * ds.rowPitch];
+		for (uint32 bx = 0; bx < (ss.width + 3) / 4; bx++, out += blockSize) {
+			// Edge blocks repeat the last row and column.
+			Block px;
+			uint8 r[16], g[16], a[16];
+			for (uint32 i = 0; i < 16; i++) {
+				uint32 x = std::min(bx * 4 + (i & 3), ss.width - 1), y = std::min(by * 4 + (i >> 2), ss.height - 1);
+				std::memcpy(px[i], in + size_t(y) * ss.rowPitch + x * 4, 4);
+				r[i] = px[i][0];
+				g[i] = px[i][1];
+				a[i] = px[i][3];
+			}
+			switch (compression)
+			{
+			case TextureCompression::BC1: _encodeBC1(px, out, true); break;
+			case TextureCompression::BC3: _encodeBC4(a, out); _encodeBC1(px, out + 8, false); break;
+			case TextureCompression::BC4: _encodeBC4(r, out); break;
+			case TextureCompression::BC5: _encodeBC4(r, out); _encodeBC4(g, out + 8); break;
+			case TextureCompression::BC7: _encodeBC7(px, out); break;
+			default: break;
+			}
+		}
+	});
+
+	return true;
+}
+
+bool m3d::textureprocessing::Decompress(const DecodedImage &src, DecodedImage &dst)
+{
+	if (&src == &dst)
+		return false;
+
+	M3D_FORMAT fmt = src.format;
+	bool sRGB = fmt == M3D_FORMAT_BC1_UNORM_SRGB || fmt == M3D_FORMAT_BC3_UNORM_SRGB || fmt == M3D_FORMAT_BC7_UNORM_SRGB;
+	switch (fmt)
+	{
+	case M3D_FORMAT_BC1_UNORM: case M3D_FORMAT_BC1_UNORM_SRGB: 
+	case M3D_FORMAT_BC3_UNORM: case M3D_FORMAT_BC3_UNORM_SRGB:
+	case M3D_FORMAT_BC4_UNORM:
+	case M3D_FORMAT_BC5_UNORM:
+	case M3D_FORMAT_BC7_UNORM: case M3D_FORMAT_BC7_UNORM_SRGB:
+		break;
+	default:
+		return false;
+	}
+
+	_initLayout(src, dst, sRGB ? M3D_FORMAT_R8G8B8A8_UNORM_SRGB : M3D_FORMAT_R8G8B8A8_UNORM);
+	uint32 blockSize = imagedecoder::GetBitsPerPixel(fmt) / 8;
+	std::atomic<bool> ok(true);
+
+	_forEachBlockRow(src, 0, [&](uint32 s, uint32 z, uint32 by) {
+		const DecodedImage::Subresource &ss = src.subresources[s], &ds = dst.subresources[s];
+		const uint8 *in = &src.data[ss.offset + size_t(z) * ss.slicePitch + size_t(by) * ss.rowPitch];
+		uint8 *out = &dst.data[ds.offset + size_t(z) * ds.slicePitch];
+		for (uint32 bx = 0; bx < (ss.width + 3) / 4; bx++, in += blockSize) {
+			Block px;
+			switch (fmt)
+			{
+			case M3D_FORMAT_BC1_UNORM: case M3D_FORMAT_BC1_UNORM_SRGB:
+				_decodeBC1(in, px, false);
+				break;
+			case M3D_FORMAT_BC3_UNORM: case M3D_FORMAT_BC3_UNORM_SRGB:
+				_decodeBC1(in + 8, px, true);
+				_decodeBC4(in, px, 3);
+				break;
+			case M3D_FORMAT_BC4_UNORM:
+			case M3D_FORMAT_BC5_UNORM:
+				for (uint32 i = 0; i < 16; i++) {
+					px[i][1] = px[i][2] = 0;
+					px[i][3] = 255;
+				}
+				_decodeBC4(in, px, 0);
+				if (fmt == M3D_FORMAT_BC5_UNORM)
+					_decodeBC4(in + 8, px, 1);
+				break;
+			default:
+				if (!_decodeBC7(in, px)) {
+					ok = false;
+					return;
+				}
+				break;
+			}
+			for (uint32 i = 0; i < 16; i++) {
+				uint32 x = bx * 4 + (i & 3), y = by * 4 + (i >> 2);
+				if (x < ds.width && y < ds.height)
+					std::memcpy(out + size_t(y) * ds.rowPitch + x * 4, px[i], 4);
+			}
+		}
+	});
+
+	return ok;
+}
+
+float64 m3d::textureprocessing::ComputePSNR(const DecodedImage &a, const DecodedImage &b, uint32 channelMask)
+{
+	if (!_isRGBA8(a.format) || !_isRGBA8(b.format) || a.subresources.empty() || b.subresources.empty())
+		return 0.0;
+	const DecodedImage::Subresource &sa = a.subresources[0], &sb = b.subresources[0];
+	if (sa.width != sb.width || sa.height != sb.height)
+		return 0.0;
+
+	uint64 sum = 0, count = 0;
+	for (uint32 y = 0; y < sa.height; y++) {
+		const uint8 *pa = &a.data[sa.offset + size_t(y) * sa.rowPitch], *pb = &b.data[sb.offset + size_t(y) * sb.rowPitch];
+		for (uint32 x = 0; x < sa.width * 4; x++) {
+			if (channelMask & (1 << (x & 3))) {
+				int32 d = int32(pa[x]) - int32(pb[x]);
+				sum += uint64(d * d);
+				count++;
+			}
+		}
+	}
+	if (count == 0)
+		return 0.0;
+	if (sum == 0)
+		return 100.0; // Identical.
+	float64 mse = float64(sum) / count;
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+uint32 m3d::textureprocessing::GetChannelMask(TextureCompression compression)
+{
+	switch (compression)
+	{
+	case TextureCompression::BC1: return 0x7;
+	case TextureCompression::BC4: return 0x1;
+	case TextureCompression::BC5: return 0x3;
+	default: return 0xF;
+	}
+}
+
+bool m3d::textureprocessing::ConvertToRGBA8(DecodedImage &img)
+{
+	switch (img.format)
+	{
+	case M3D_FORMAT_R8G8B8A8_UNORM:
+	case M3D_FORMAT_R8G8B8A8_UNORM_SRGB:
+		return true;
+	case M3D_FORMAT_R8G8B8A8_TYPELESS:
+		img.format = M3D_FORMAT_R8G8B8A8_UNORM;
+		return true;
+	case M3D_FORMAT_B8G8R8A8_UNORM:
+	case M3D_FORMAT_B8G8R8A8_TYPELESS:
+	case M3D_FORMAT_B8G8R8A8_UNORM_SRGB:
+	case M3D_FORMAT_B8G8R8X8_UNORM:
+	case M3D_FORMAT_B8G8R8X8_TYPELESS:
+	case M3D_FORMAT_B8G8R8X8_UNORM_SRGB:
+		break;
+	default:
+		return false;
+	}
+
+	bool opaque = img.format == M3D_FORMAT_B8G8R8X8_UNORM || img.format == M3D_FORMAT_B8G8R8X8_TYPELESS || img.format == M3D_FORMAT_B8G8R8X8_UNORM_SRGB;
+	bool sRGB = img.format == M3D_FORMAT_B8G8R8A8_UNORM_SRGB || img.format == M3D_FORMAT_B8G8R8X8_UNORM_SRGB;
+	for (const DecodedImage::Subresource &sr : img.subresources) {
+		for (uint32 z = 0; z < sr.depth; z++) {
+			for (uint32 y = 0; y < sr.height; y++) {
+				uint8 *p = &img.data[sr.offset + size_t(z) * sr.slicePitch + size_t(y) * sr.rowPitch];
+				for (uint32 x = 0; x < sr.width; x++, p += 4) {
+					std::swap(p[0], p[2]);
+					if (opaque)
+						p[3] = 255;
+				}
+			}
+		}
+	}
+	img.format = sRGB ? M3D_FORMAT_R8G8B8A8_UNORM_SRGB : M3D_FORMAT_R8G8B8A8_UNORM;
+	return true;
+}
+
+bool m3d::textureprocessing::WriteDDS(const DecodedImage &img, List<uint8> &out)
+{
+	if (img.subresources.empty() || imagedecoder::GetBitsPerPixel(img.format) == 0)
+		return false;
+
+	static const uint32 DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PITCH = 0x8, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_LINEARSIZE = 0x80000, DDSD_DEPTH = 0x800000;
+	static const uint32 DDPF_FOURCC = 0x4;
+	static const uint32 DDSCAPS_COMPLEX = 0x8, DDSCAPS_TEXTURE = 0x1000, DDSCAPS_MIPMAP = 0x400000;
+	static const uint32 DDSCAPS2_CUBEMAP_ALLFACES = 0xFE00, DDSCAPS2_VOLUME = 0x200000;
+
+	bool compressed = imagedecoder::IsBlockCompressed(img.format);
+	const DecodedImage::Subresource &top = img.subresources[0];
+
+	uint32 header[1 + 31 + 5] = {}; // Magic, DDS_HEADER and DDS_HEADER_DXT10.
+	header[0] = 0x20534444; // "DDS "
+	uint32 *h = header + 1;
+	h[0] = 124;
+	h[1] = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT | (compressed ? DDSD_LINEARSIZE : DDSD_PITCH) | (img.dimension == 3 ? DDSD_DEPTH : 0);
+	h[2] = img.height;
+	h[3] = img.width;
+	h[4] = compressed ? top.slicePitch : top.rowPitch;
+	h[5] = img.dimension == 3 ? img.depth : 0;
+	h[6] = img.mipLevels;
+	h[18] = 32; // DDS_PIXELFORMAT
+	h[19] = DDPF_FOURCC;
+	h[20] = 0x30315844; // "DX10"
+	h[26] = DDSCAPS_TEXTURE | (img.mipLevels > 1 ? DDSCAPS_MIPMAP | DDSCAPS_COMPLEX : 0) | (img.cubeMap || img.arraySize > 1 ? DDSCAPS_COMPLEX : 0);
+	h[27] = (img.cubeMap ? DDSCAPS2_CUBEMAP_ALLFACES : 0) | (img.dimension == 3 ? DDSCAPS2_VOLUME : 0);
+	uint32 *dx10 = header + 32;
+	dx10[0] = uint32(img.format);
+	dx10[1] = img.dimension + 1; // D3D10_RESOURCE_DIMENSION_TEXTURE1D is 2.
+	dx10[2] = img.cubeMap ? 0x4 : 0; // D3D11_RESOURCE_MISC_TEXTURECUBE
+	dx10[3] = img.cubeMap ? img.arraySize / 6 : img.arraySize;
+
+	out.resize(sizeof(header));
+	for (uint32 i = 0; i < sizeof(header) / 4; i++)
+		for (uint32 j = 0; j < 4; j++)
+			out[i * 4 + j] = uint8(header[i] >> (8 * j));
+	for (const DecodedImage::Subresource &sr : img.subresources) {
+		size_t size = size_t(sr.slicePitch) * sr.depth;
+		if (sr.offset + size > img.data.size())
+			return false;
+		out.insert(out.end(), img.data.begin() + sr.offset, img.data.begin() + sr.offset + size);
+	}
+	return true;
+}
+
+bool m3d::textureprocessing::Process(DecodedImage &img, const TextureProcessingOptions &options, TextureProcessingStats *stats)
+{
+	if (!ConvertToRGBA8(img))
+		return false; // Already compressed, or a format we do not handle.
+
+	bool sRGB = options.sRGB && !options.normalMap;
+	int64 t0 = Clock::GetTime_ns();
+
+	// Mips are only generated for plain 2D images. Others keep the mips they have.
+	if (options.mipFilter != TextureMipFilter::NONE && img.dimension == 2 && img.arraySize == 1)
+		if (!GenerateMips(img, options.mipFilter, sRGB, options.normalMap, options.threadCount))
+			return false;
+
+	int64 t1 = Clock::GetTime_ns();
+
+	DecodedImage result;
+	if (!Compress(img, result, options.compression, sRGB && options.sRGBFormat, options.threadCount))
+		return false;
+
+	int64 t2 = Clock::GetTime_ns();
+
+	if (stats) {
+		stats->sourceBytes = img.data.size();
+		stats->outputBytes = result.data.size();
+		stats->mipTime = Clock::ToSeconds(t1 - t0);
+		stats->compressTime = Clock::ToSeconds(t2 - t1);
+		stats->psnr = 100.0;
+		DecodedImage decompressed;
+		if (options.compression != TextureCompression::NONE)
+			stats->psnr = Decompress(result, decompressed) ? ComputePSNR(img, decompressed, GetChannelMask(options.compression)) : 0.0;
+	}
+
+	img = std::move(result);
+	return true;
+}
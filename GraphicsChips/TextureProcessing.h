@@ -0,0 +1,77 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "ImageDecoder.h"
+
+namespace m3d
+{
+
+enum class TextureMipFilter { NONE, BOX, KAISER };
+enum class TextureCompression { NONE, BC1, BC3, BC4, BC5, BC7 };
+
+// Settings for processing image data when it is imported.
+struct TextureProcessingOptions
+{
+	TextureMipFilter mipFilter = TextureMipFilter::KAISER;
+	TextureCompression compression = TextureCompression::BC7;
+	bool sRGB = true; // Color channels are gamma encoded. Mips are filtered in linear space.
+	bool sRGBFormat = true; // Store gamma encoded images in an sRGB format, so that sampling returns linear colors.
+	bool normalMap = false; // RGB is a normal (xyz mapped to [0,1]). Filtered without gamma and renormalized for each mip.
+	uint32 threadCount = 0; // Number of worker threads. 0 to use all hardware threads.
+};
+
+// Sizes, timings and quality of a processed image.
+struct TextureProcessingStats
+{
+	uint64 sourceBytes = 0; // Size of the uncompressed R8G8B8A8 mip chain.
+	uint64 outputBytes = 0; // Size of the resulting subresources.
+	float64 mipTime = 0.0; // Seconds spent generating mips.
+	float64 compressTime = 0.0; // Seconds spent block compressing.
+	float64 psnr = 0.0; // Top mip, compressed vs uncompressed, in dB. Only the channels stored by the format are compared.
+};
+
+// CPU texture processing: Mip generation, BCn compression and DDS writing.
+// Like the decoders, this does not depend on D3D or Windows, so quality and throughput can be measured on any platform.
+namespace textureprocessing
+{
+	// Replaces the mip chain of a 2D R8G8B8A8 image (array size 1) with a full chain generated from the top mip.
+	bool GenerateMips(DecodedImage &img, TextureMipFilter filter, bool sRGB, bool normalMap, uint32 threadCount = 0);
+	// Compresses all subresources of an R8G8B8A8 image into dst, using the sRGB version of the format if requested. BC7 uses mode 6 only.
+	bool Compress(const DecodedImage &src, DecodedImage &dst, TextureCompression compression, bool sRGB, uint32 threadCount = 0);
+	// Decompresses BC1-BC5 and BC7 (mode 6 blocks only) to R8G8B8A8. Used to measure the quality of the encoders.
+	bool Decompress(const DecodedImage &src, DecodedImage &dst);
+	// Peak signal to noise ratio of the top mips of two R8G8B8A8 images of the same size. channelMask has bit 0 for red to bit 3 for alpha.
+	float64 ComputePSNR(const DecodedImage &a, const DecodedImage &b, uint32 channelMask = 0xF);
+	// The channels compared by ComputePSNR for a given compression.
+	uint32 GetChannelMask(TextureCompression compression);
+	// Converts a decoded image to R8G8B8A8 if it is in another 8 bit RGBA layout. Fails for other formats.
+	bool ConvertToRGBA8(DecodedImage &img);
+	// Writes the image as a DDS file with a DX10 header.
+	bool WriteDDS(const DecodedImage &img, List<uint8> &out);
+	// Runs the full pipeline on an image (converting to R8G8B8A8, generating mips and compressing).
+	bool Process(DecodedImage &img, const TextureProcessingOptions &options, TextureProcessingStats *stats = nullptr);
+}
+
+}
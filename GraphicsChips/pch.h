@@ -23,6 +23,8 @@
 
 #pragma once
 
+// GRAPHICSCHIPS_STATIC is defined by the standalone targets (ImageDecoderTest, TextureBench) that build only the portable sources, like ImageDecoder.cpp.
+#if defined(_WIN32) && !defined(GRAPHICSCHIPS_STATIC)
 #include "targetver.h"
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
@@ -38,4 +40,5 @@
 #include <DirectXTK12/DDSTextureLoader.h>
 #include <DirectXTK12/WICTextureLoader.h>
 #include <DirectXTK12/ResourceUploadBatch.h>
+#endif
 // TODO: reference additional headers your program requires here
@@ -0,0 +1,39 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "StdAfx.h"
+#include "LODRenderable_Dlg.h"
+
+using namespace m3d;
+
+
+DIALOGDESC_DEF(LODRenderable_Dlg, LODRENDERABLE_GUID);
+
+
+void LODRenderable_Dlg::Init()
+{
+	auto chip = GetChip();
+	AddDoubleSpinBox(MTEXT("Max Screen Space Error (Pixels):"), chip->GetPixelError(), 0.0, 100.0, 0.5, [this, chip](Id id, RVariant v) { SetDirty(); chip->SetPixelError(v.ToFloat()); });
+	AddSpinBox(MTEXT("Forced Level of Detail (-1 for Automatic):"), chip->GetForcedLOD(), -1, 16, 1, [this, chip](Id id, RVariant v) { SetDirty(); chip->SetForcedLOD(v.ToInt()); });
+}
@@ -0,0 +1,60 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "StdAfx.h"
+#include "MeshOptimizer_Dlg.h"
+
+using namespace m3d;
+
+
+DIALOGDESC_DEF(MeshOptimizer_Dlg, MESHOPTIMIZER_GUID);
+
+
+void MeshOptimizer_Dlg::Init()
+{
+	auto chip = GetChip();
+	const auto &o = chip->GetOptions();
+	AddCheckBox(MTEXT("Optimize for Vertex Cache"), o.vertexCache ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); auto o = chip->GetOptions(); o.vertexCache = v.ToBool(); chip->SetOptions(o); });
+	AddCheckBox(MTEXT("Optimize for Overdraw"), o.overdraw ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); auto o = chip->GetOptions(); o.overdraw = v.ToBool(); chip->SetOptions(o); });
+	AddDoubleSpinBox(MTEXT("Max ACMR Increase for Overdraw:"), o.overdrawThreshold, 1.0, 3.0, 0.01, [this, chip](Id id, RVariant v) { SetDirty(); auto o = chip->GetOptions(); o.overdrawThreshold = v.ToFloat(); chip->SetOptions(o); });
+	AddCheckBox(MTEXT("Optimize for Vertex Fetch"), o.vertexFetch ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); auto o = chip->GetOptions(); o.vertexFetch = v.ToBool(); chip->SetOptions(o); });
+	AddLine();
+	AddSpinBox(MTEXT("Simulated Cache Size (for ACMR/ATVR):"), o.cacheSize, 3, 64, 1, [this, chip](Id id, RVariant v) { SetDirty(); auto o = chip->GetOptions(); o.cacheSize = v.ToUInt(); chip->SetOptions(o); });
+	AddLine();
+	const auto &l = chip->GetLODOptions();
+	AddCheckBox(MTEXT("Generate Levels of Detail"), chip->IsGenerateLODs() ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); chip->SetGenerateLODs(v.ToBool()); });
+	AddSpinBox(MTEXT("Max Number of Levels:"), l.levelCount, 1, 16, 1, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.levelCount = v.ToUInt(); chip->SetLODOptions(l); });
+	AddDoubleSpinBox(MTEXT("Triangle Reduction per Level:"), l.reduction, 0.05, 0.95, 0.05, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.reduction = v.ToFloat(); chip->SetLODOptions(l); });
+	AddDoubleSpinBox(MTEXT("Max Error (Relative to Extent):"), l.maxError, 0.0, 1.0, 0.005, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.maxError = v.ToFloat(); chip->SetLODOptions(l); });
+	AddDoubleSpinBox(MTEXT("Normal Weight:"), l.normalWeight, 0.0, 10.0, 0.01, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.normalWeight = v.ToFloat(); chip->SetLODOptions(l); });
+	AddDoubleSpinBox(MTEXT("Texture Coordinate Weight:"), l.texcoordWeight, 0.0, 10.0, 0.01, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.texcoordWeight = v.ToFloat(); chip->SetLODOptions(l); });
+	AddDoubleSpinBox(MTEXT("Blend Weight Weight:"), l.blendWeightWeight, 0.0, 10.0, 0.01, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.blendWeightWeight = v.ToFloat(); chip->SetLODOptions(l); });
+	AddCheckBox(MTEXT("Lock Borders"), l.lockBorders ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODOptions(); l.lockBorders = v.ToBool(); chip->SetLODOptions(l); });
+	AddLine();
+	const auto &m = chip->GetMeshletOptions();
+	AddCheckBox(MTEXT("Build Meshlets"), chip->IsBuildMeshlets() ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); chip->SetBuildMeshlets(v.ToBool()); });
+	AddSpinBox(MTEXT("Max Vertices per Meshlet:"), m.maxVertices, 3, 256, 1, [this, chip](Id id, RVariant v) { SetDirty(); auto m = chip->GetMeshletOptions(); m.maxVertices = v.ToUInt(); chip->SetMeshletOptions(m); });
+	AddSpinBox(MTEXT("Max Triangles per Meshlet:"), m.maxTriangles, 1, 512, 1, [this, chip](Id id, RVariant v) { SetDirty(); auto m = chip->GetMeshletOptions(); m.maxTriangles = v.ToUInt(); chip->SetMeshletOptions(m); });
+	AddDoubleSpinBox(MTEXT("Cone Weight (Back Face vs Frustum Culling):"), m.coneWeight, 0.0, 1.0, 0.05, [this, chip](Id id, RVariant v) { SetDirty(); auto m = chip->GetMeshletOptions(); m.coneWeight = v.ToFloat(); chip->SetMeshletOptions(m); });
+}
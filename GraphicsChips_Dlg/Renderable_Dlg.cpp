@@ -47,6 +47,8 @@ void Renderable_Dlg::Init()
 
 	ui.checkBox_culling->setChecked(_initWholeObjectCulling = GetChip()->IsUsingWholeObjectCulling());
 	ui.checkBox_subsetCulling->setChecked(_initSubsetCulling = GetChip()->IsUsingSubsetCulling());
+	ui.checkBox_meshletCulling->setChecked(_initMeshletCulling = GetChip()->IsUsingMeshletCulling());
+	ui.checkBox_meshletBackFaceCulling->setChecked(_initMeshletBackFaceCulling = GetChip()->IsUsingMeshletBackFaceCulling());
 
 	_initBB = GetChip()->GetBoundingBox();
 	_fillBB(_initBB);
@@ -72,6 +74,8 @@ void Renderable_Dlg::OnCancel()
 {
 	GetChip()->SetUseWholeObjectCulling(_initWholeObjectCulling);
 	GetChip()->SetUseSubsetCulling(_initSubsetCulling);
+	GetChip()->SetUseMeshletCulling(_initMeshletCulling);
+	GetChip()->SetUseMeshletBackFaceCulling(_initMeshletBackFaceCulling);
 	GetChip()->SetBoundingBox(_initBB);
 	GetChip()->MakeSpecific(_initSpecificSubsets);
 }
@@ -80,6 +84,8 @@ void Renderable_Dlg::AfterApply()
 {
 	_initWholeObjectCulling = GetChip()->IsUsingWholeObjectCulling();
 	_initSubsetCulling = GetChip()->IsUsingSubsetCulling();
+	_initMeshletCulling = GetChip()->IsUsingMeshletCulling();
+	_initMeshletBackFaceCulling = GetChip()->IsUsingMeshletBackFaceCulling();
 	_initBB = GetChip()->GetBoundingBox();
 	GetChip()->GetSpecificSubsets(_initSpecificSubsets);
 }
@@ -258,4 +264,12 @@ void Renderable_Dlg::cullingChanged()
 		GetChip()->SetUseSubsetCulling(ui.checkBox_subsetCulling->isChecked());
 		SetDirty();
 	}
+	if (GetChip()->IsUsingMeshletCulling() != ui.checkBox_meshletCulling->isChecked()) {
+		GetChip()->SetUseMeshletCulling(ui.checkBox_meshletCulling->isChecked());
+		SetDirty();
+	}
+	if (GetChip()->IsUsingMeshletBackFaceCulling() != ui.checkBox_meshletBackFaceCulling->isChecked()) {
+		GetChip()->SetUseMeshletBackFaceCulling(ui.checkBox_meshletBackFaceCulling->isChecked());
+		SetDirty();
+	}
 }
\ No newline at end of file
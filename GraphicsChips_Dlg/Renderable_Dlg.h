@@ -56,6 +56,8 @@ private:
 	List<std::pair<uint32, String>> _initSpecificSubsets;
 	bool _initWholeObjectCulling;
 	bool _initSubsetCulling;
+	bool _initMeshletCulling;
+	bool _initMeshletBackFaceCulling;
 	AxisAlignedBox _initBB;
 
 	void _fillBB(const AxisAlignedBox &aabb);
@@ -0,0 +1,44 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "StdAfx.h"
+#include "SkeletonController_Dlg.h"
+
+using namespace m3d;
+
+
+DIALOGDESC_DEF(SkeletonController_Dlg, SKELETONCONTROLLER_GUID);
+
+
+void SkeletonController_Dlg::Init()
+{
+	auto chip = GetChip();
+	const auto &l = chip->GetLODSettings();
+	AddCheckBox(MTEXT("Skip Evaluation when Renderable is Culled"), l.cullInvisible ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODSettings(); l.cullInvisible = v.ToBool(); chip->SetLODSettings(l); });
+	AddLine();
+	AddCheckBox(MTEXT("Enable Distance Based LOD"), l.enabled ? RCheckState::Checked : RCheckState::Unchecked, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODSettings(); l.enabled = v.ToBool(); chip->SetLODSettings(l); });
+	AddDoubleSpinBox(MTEXT("Reduced Update Rate Distance:"), l.reducedRateDistance, 0.0, 100000.0, 1.0, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODSettings(); l.reducedRateDistance = v.ToFloat(); chip->SetLODSettings(l); });
+	AddSpinBox(MTEXT("Frames between Updates at Reduced Rate:"), l.reducedRateInterval, 1, 60, 1, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODSettings(); l.reducedRateInterval = v.ToUInt(); chip->SetLODSettings(l); });
+	AddDoubleSpinBox(MTEXT("Joint LOD Distance:"), l.jointLODDistance, 0.0, 100000.0, 1.0, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODSettings(); l.jointLODDistance = v.ToFloat(); chip->SetLODSettings(l); });
+	AddSpinBox(MTEXT("Joint Levels to Skip (from Leaf Joints):"), l.jointLODLevels, 0, 16, 1, [this, chip](Id id, RVariant v) { SetDirty(); auto l = chip->GetLODSettings(); l.jointLODLevels = v.ToUInt(); chip->SetLODSettings(l); });
+}
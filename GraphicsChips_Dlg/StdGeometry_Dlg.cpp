@@ -177,6 +177,7 @@ void StdGeometry_Dlg::Init()
 	_texEnable();
 
 	ui.pushButton_transform->setEnabled(!d->GetPositions().empty());
+	ui.pushButton_optimize->setEnabled(d->GetAPI() == DRAW_INDEXED && !d->GetPositions().empty());
 
 	_block = false;
 }
@@ -447,6 +448,24 @@ void StdGeometry_Dlg::transformClicked()
 	delete d;
 }
 
+void StdGeometry_Dlg::optimizeClicked()
+{
+	MeshOptimizationStats stats;
+	if (!GetChip()->Optimize(MeshOptimizationOptions(), &stats)) {
+		QMessageBox::warning(this, "Standard Drawable", "Failed to optimize. The index data is not valid.");
+		return;
+	}
+	GetChip()->DestroyDeviceObjects();
+	SetDirty();
+	ui.label_vertexCount->setText(QString::number(GetChip()->GetPositions().size()));
+	QMessageBox::information(this, "Standard Drawable", QString("Optimized %1 of %2 subsets (%3 triangles).\n\nACMR: %4 -> %5\nATVR: %6 -> %7\nVertices: %8 -> %9\nIndex format: %10")
+		.arg(stats.optimizedSubsets).arg(GetChip()->GetSubsets().size()).arg(stats.triangleCount)
+		.arg(stats.before.acmr, 0, 'f', 3).arg(stats.after.acmr, 0, 'f', 3)
+		.arg(stats.before.atvr, 0, 'f', 3).arg(stats.after.atvr, 0, 'f', 3)
+		.arg(stats.vertexCountBefore).arg(stats.vertexCountAfter)
+		.arg(stats.indices16 ? "16-bit" : "32-bit"));
+}
+
 int32 StdGeometry_Dlg::_getNumberOfActiveTexSets() const
 {
 	int32 n = 0;
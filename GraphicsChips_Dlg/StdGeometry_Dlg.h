@@ -66,5 +66,6 @@ private slots:
 	void packTexSetsClicked();
 	void tscChanged();
 	void transformClicked();
+	void optimizeClicked();
 };
 }
\ No newline at end of file
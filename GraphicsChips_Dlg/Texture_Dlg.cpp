@@ -373,6 +373,16 @@ void Texture_Dlg::onGenMipsChanged()
 	_updateUI();
 }
 
+void Texture_Dlg::onCompressChanged()
+{
+	if (_skipSlots) return;
+	if (ui.checkBox_compress->isChecked())
+		_desc.FlagsEx |= TEXTURE_COMPRESS_IMAGE_DATA;
+	else
+		_desc.FlagsEx &= ~TEXTURE_COMPRESS_IMAGE_DATA;
+	_updateUI();
+}
+
 void Texture_Dlg::onForceSRGBChanged()
 {
 	if (_skipSlots) return;
@@ -470,6 +480,7 @@ void Texture_Dlg::_updateUI()
 	ui.checkBox_genMips->setChecked(_desc.FlagsEx & TEXTURE_GEN_MIPMAPS);
 	ui.checkBox_forceSRGB->setEnabled(_hasImage);
 	ui.checkBox_forceSRGB->setChecked(_desc.FlagsEx & TEXTURE_FORCE_SRGB);
+	ui.checkBox_compress->setChecked(_desc.FlagsEx & TEXTURE_COMPRESS_IMAGE_DATA);
 
 	ui.frame_settings->setEnabled(!_hasImage);
 
@@ -575,13 +586,16 @@ void Texture_Dlg::loadImage()
 	td.SampleDesc = {1, 0};
 	td.Flags = M3D_RESOURCE_FLAG_NONE;
 	if (nfo.mipLevels == 1)
-		td.FlagsEx = TEXTURE_GEN_MIPMAPS;
+		td.FlagsEx = TEXTURE_GEN_MIPMAPS | (_desc.FlagsEx & TEXTURE_COMPRESS_IMAGE_DATA);
 
 	if (!GetChip()->SetImageData(std::move(db), iff, &td)) {
 		QMessageBox::critical(this, "Texture", "Failed to set texture.");
 		return;
 	}
 
+	if ((td.FlagsEx & TEXTURE_COMPRESS_IMAGE_DATA) && !GetChip()->CompressImageData())
+		QMessageBox::warning(this, "Texture", "Failed to compress the image data. It is kept uncompressed.");
+
 	_setDesc(GetChip()->GetInitDesc(), true); // Set desc to UI
 	//Update();
 	SetDirty();
@@ -88,6 +88,7 @@ private slots:
 	void onDSVChanged();
 	void onUAVChanged();
 	void onGenMipsChanged();
+	void onCompressChanged();
 	void onForceSRGBChanged();
 
 	void loadImage();
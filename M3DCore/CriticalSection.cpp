@@ -29,15 +29,21 @@ using namespace m3d;
 
 CriticalSection::CriticalSection()
 {
+#ifdef _WIN32
 //	InitializeCriticalSection(&_cs);
 	InitializeCriticalSectionEx(&_cs, 0, 0); // WP8
+#endif
 }
 
 CriticalSection::~CriticalSection()
 {
+#ifdef _WIN32
 	DeleteCriticalSection(&_cs);
+#endif
 }
 
+#ifdef _WIN32
+
 void CriticalSection::Enter()
 {
 	EnterCriticalSection(&_cs);
@@ -57,3 +63,27 @@ CriticalBlock::~CriticalBlock()
 {
 	LeaveCriticalSection(_cs);
 }
+
+#else
+
+void CriticalSection::Enter()
+{
+	_cs.lock();
+}
+
+void CriticalSection::Leave()
+{
+	_cs.unlock();
+}
+
+CriticalBlock::CriticalBlock(CriticalSection &cs) : _cs(&cs._cs)
+{
+	_cs->lock();
+}
+
+CriticalBlock::~CriticalBlock()
+{
+	_cs->unlock();
+}
+
+#endif
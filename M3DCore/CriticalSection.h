@@ -24,7 +24,11 @@
 #pragma once
 
 #include "Exports.h"
+#ifdef _WIN32
 #include <Synchapi.h>
+#else
+#include <mutex>
+#endif
 
 namespace m3d
 {
@@ -40,7 +44,11 @@ public:
 	void Leave();
 
 private:
+#ifdef _WIN32
 	CRITICAL_SECTION _cs;
+#else
+	std::recursive_mutex _cs;
+#endif
 };
 
 
@@ -50,7 +58,11 @@ public:
 	CriticalBlock(CriticalSection &cs);
 	~CriticalBlock();
 private:
+#ifdef _WIN32
 	LPCRITICAL_SECTION _cs;
+#else
+	std::recursive_mutex *_cs;
+#endif
 };
 
 }
\ No newline at end of file
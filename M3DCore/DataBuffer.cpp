@@ -24,14 +24,152 @@
 #include "pch.h"
 #include "DataBuffer.h"
 #include "MemoryManager.h"
+#include "SlimRWLock.h"
 #include <cstring>
+#include <atomic>
+#include <unordered_map>
 
 
 using namespace m3d;
 
 
+namespace
+{
+	// Header in front of shared data. 32 bytes to keep the data 16-byte aligned.
+	struct SharedHeader
+	{
+		std::atomic<uint32> refCount;
+		uint32 reserved;
+		uint64 hash;
+		uint64 size;
+		uint64 reserved2;
+	};
+	static_assert(sizeof(SharedHeader) == 32, "SharedHeader should be 32 bytes.");
+
+	inline SharedHeader *_header(const void *data) { return (SharedHeader*)data - 1; }
+
+	// All live shared data by content hash.
+	struct SharedDataTable
+	{
+		SlimRWLock lock;
+		std::unordered_multimap<uint64, SharedHeader*> entries;
+	};
+
+	SharedDataTable &_table()
+	{
+		static SharedDataTable table;
+		return table;
+	}
+}
+
 void DataBuffer::DeallocData(void *data) { mmfree(data); }
 
+void DataBuffer::AddSharedDataRef(const void *data) { _header(data)->refCount.fetch_add(1); }
+
+void DataBuffer::ReleaseSharedData(void *data)
+{
+	SharedHeader *h = _header(data);
+	if (h->refCount.fetch_sub(1) != 1)
+		return;
+	// Last reference. createShared() never revives data with zero references, so we are the only one touching it now.
+	{
+		SharedDataTable &t = _table();
+		SlimWLockBlock lock(t.lock);
+		auto range = t.entries.equal_range(h->hash);
+		for (auto itr = range.first; itr != range.second; ++itr) {
+			if (itr->second == h) {
+				t.entries.erase(itr);
+				break;
+			}
+		}
+	}
+	mmfree(h);
+}
+
+uint64 DataBuffer::hash(const uint8 *data, size_t size)
+{
+	// MurmurHash64A
+	const uint64 m = 0xc6a4a7935bd1e995ull;
+	const int32 r = 47;
+	uint64 h = 0x9e3779b97f4a7c15ull ^ (size * m);
+
+	const uint8 *end = data + (size & ~size_t(7));
+	for (; data != end; data += 8) {
+		uint64 k;
+		std::memcpy(&k, data, 8);
+		k *= m;
+		k ^= k >> r;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+
+	switch (size & 7) {
+	case 7: h ^= uint64(data[6]) << 48; [[fallthrough]];
+	case 6: h ^= uint64(data[5]) << 40; [[fallthrough]];
+	case 5: h ^= uint64(data[4]) << 32; [[fallthrough]];
+	case 4: h ^= uint64(data[3]) << 24; [[fallthrough]];
+	case 3: h ^= uint64(data[2]) << 16; [[fallthrough]];
+	case 2: h ^= uint64(data[1]) << 8; [[fallthrough]];
+	case 1: h ^= uint64(data[0]);
+		h *= m;
+	}
+
+	h ^= h >> r;
+	h *= m;
+	h ^= h >> r;
+	return h;
+}
+
+uint64 DataBuffer::getHash() const
+{
+	if (isShared())
+		return _header(_cdata)->hash;
+	return hash(_cdata, _size);
+}
+
+DataBuffer DataBuffer::createShared(const uint8 *data, size_t size)
+{
+	DataBuffer db;
+	if (size == 0)
+		return db;
+
+	uint64 h = hash(data, size);
+
+	SharedDataTable &t = _table();
+	SlimWLockBlock lock(t.lock);
+
+	auto range = t.entries.equal_range(h);
+	for (auto itr = range.first; itr != range.second; ++itr) {
+		SharedHeader *e = itr->second;
+		if (e->size != size || std::memcmp(e + 1, data, size) != 0)
+			continue;
+		// Only take a reference if the data is still alive. It may be on its way out in ReleaseSharedData().
+		uint32 c = e->refCount.load();
+		while (c != 0 && !e->refCount.compare_exchange_weak(c, c + 1));
+		if (c == 0)
+			continue;
+		db._cdata = (const uint8*)(e + 1);
+		db._size = size;
+		db._dealloc = &ReleaseSharedData;
+		return db;
+	}
+
+	SharedHeader *e = (SharedHeader*)mmalloc(sizeof(SharedHeader) + size);
+	new (&e->refCount) std::atomic<uint32>(1);
+	e->reserved = 0;
+	e->hash = h;
+	e->size = size;
+	e->reserved2 = 0;
+	std::memcpy((uint8*)(e + 1), data, size);
+	t.entries.insert(std::make_pair(h, e));
+
+	db._cdata = (const uint8*)(e + 1);
+	db._size = size;
+	db._dealloc = &ReleaseSharedData;
+	return db;
+}
+
 DataBuffer::DataBuffer(size_t size) : _data(nullptr), _cdata(nullptr), _size(0), _dealloc(nullptr)
 {
 	realloc(size);
@@ -150,6 +288,11 @@ void DataBuffer::setBufferData(uint8 *data, size_t size, DeallocDataFunc dealloc
 		_size = size;
 		std::memcpy(_data, data, size);
 	}
+	else if (dealloc == &ReleaseSharedData) { // share the data, but keep it non-editable
+		AddSharedDataRef(data);
+		_cdata = data;
+		_size = size;
+	}
 	else {
 		_cdata = _data = data;
 		_size = size;
@@ -168,6 +311,8 @@ void DataBuffer::setBufferData(const uint8 *cdata, size_t size, DeallocDataFunc
 		std::memcpy(_data, cdata, size);
 	}
 	else {
+		if (dealloc == &ReleaseSharedData)
+			AddSharedDataRef(cdata);
 		//_data will be NULL. If editable version is needed, a data copy is performed.
 		_cdata = cdata;
 		_size = size;
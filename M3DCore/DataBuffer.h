@@ -25,6 +25,7 @@
 
 #include "Exports.h"
 #include "MTypes.h"
+#include <cstddef>
 
 namespace m3d
 {
@@ -42,6 +43,9 @@ private:
 	size_t _size;
 	DeallocDataFunc _dealloc;
 	static void DeallocData(void *data);
+	// Deallocator for shared (reference counted) data. See createShared().
+	static void ReleaseSharedData(void *data);
+	static void AddSharedDataRef(const void *data);
 
 public:
 	DataBuffer() : _data(nullptr), _cdata(nullptr), _size(0), _dealloc(nullptr) {}
@@ -85,6 +89,15 @@ public:
 	void setBufferData(const uint8 *cdata, size_t size, DeallocDataFunc dealloc = &DeallocData); // default third: copy data and be owner!
 	// Allocate memory to be able to keep size bytes of data.
 	void realloc(size_t size, bool keepData = false);
+
+	// true if the data is reference counted and possibly shared with other buffers. Shared data is always non-editable.
+	bool isShared() const { return _dealloc == &ReleaseSharedData; }
+	// Content hash of the data. Cached for shared buffers.
+	uint64 getHash() const;
+	// Returns a buffer with a reference counted copy of the data. All shared buffers with equal content use the same memory, until the last one is released.
+	static DataBuffer createShared(const uint8 *data, size_t size);
+	// 64-bit content hash used for deduplication. Not cryptographic!
+	static uint64 hash(const uint8 *data, size_t size);
 };
 
 
@@ -0,0 +1,146 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "DiskCache.h"
+#include <random>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+
+using namespace m3d;
+
+
+namespace
+{
+
+// Header of a cache file. Followed by the data.
+struct DiskCacheHeader
+{
+	uint32 magic;
+	uint32 version;
+	uint64 key;
+	uint64 size;
+};
+
+}
+
+
+bool m3d::ReadFileData(const std::filesystem::path &filename, List<uint8> &data)
+{
+	std::error_code ec;
+	uint64 size = std::filesystem::file_size(filename, ec);
+	if (ec)
+		return false;
+	data.resize((size_t)size);
+	std::ifstream file(filename, std::ios::binary);
+	return file && (size == 0 || file.read((char*)data.data(), (std::streamsize)size));
+}
+
+bool m3d::WriteFileAtomic(const std::filesystem::path &filename, const void *data, size_t size)
+{
+	// The temporary name must be unique among threads and processes writing the same file.
+	static thread_local std::mt19937_64 rnd(std::random_device{}() ^ ((uint64)std::random_device{}() << 32));
+	std::filesystem::path tmp = filename;
+	tmp += (MTEXT("_") + DiskCache::KeyToString(rnd()) + MTEXT(".tmp")).c_str();
+	{
+		std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+		if (!file || (size > 0 && !file.write((const char*)data, (std::streamsize)size)) || !file.flush()) {
+			file.close();
+			std::error_code ec;
+			std::filesystem::remove(tmp, ec);
+			return false;
+		}
+	}
+	std::error_code ec;
+	std::filesystem::rename(tmp, filename, ec); // Replaces an existing file.
+	if (ec) {
+		std::filesystem::remove(tmp, ec);
+		return false;
+	}
+	return true;
+}
+
+
+DiskCache::DiskCache(std::filesystem::path directory, String extension, uint32 magic, uint32 version) : _directory(directory), _extension(extension), _magic(magic), _version(version)
+{
+}
+
+String DiskCache::KeyToString(uint64 key)
+{
+	Char buff[17];
+	std::snprintf(buff, sizeof(buff), "%016llx", (unsigned long long)key);
+	return String(buff);
+}
+
+std::filesystem::path DiskCache::GetFileName(uint64 key) const
+{
+	if (_directory.empty())
+		return std::filesystem::path();
+	return _directory / (KeyToString(key) + _extension);
+}
+
+bool DiskCache::Read(uint64 key, List<uint8> &data) const
+{
+	std::filesystem::path fileName = GetFileName(key);
+	List<uint8> file;
+	if (fileName.empty() || !ReadFileData(fileName, file) || file.size() < sizeof(DiskCacheHeader))
+		return false;
+	DiskCacheHeader h;
+	std::memcpy(&h, file.data(), sizeof(DiskCacheHeader));
+	if (h.magic != _magic || h.version != _version || h.key != key || h.size != file.size() - sizeof(DiskCacheHeader))
+		return false; // Not ours, or damaged. It is replaced when written again.
+	data.assign(file.begin() + sizeof(DiskCacheHeader), file.end());
+	return true;
+}
+
+bool DiskCache::Write(uint64 key, const uint8 *data, size_t size) const
+{
+	std::filesystem::path fileName = GetFileName(key);
+	if (fileName.empty())
+		return false;
+	std::error_code ec;
+	std::filesystem::create_directories(_directory, ec);
+	if (ec)
+		return false;
+
+	DiskCacheHeader h = { _magic, _version, key, (uint64)size };
+	List<uint8> file(sizeof(DiskCacheHeader) + size);
+	std::memcpy(file.data(), &h, sizeof(DiskCacheHeader));
+	if (size)
+		std::memcpy(file.data() + sizeof(DiskCacheHeader), data, size);
+	return WriteFileAtomic(fileName, file.data(), file.size());
+}
+
+void DiskCache::Clear() const
+{
+	if (_directory.empty())
+		return;
+	std::error_code ec;
+	for (std::filesystem::directory_iterator itr(_directory, ec), end; !ec && itr != end; itr.increment(ec)) {
+		if (itr->path().extension() == _extension.c_str()) {
+			std::error_code rec;
+			std::filesystem::remove(itr->path(), rec);
+		}
+	}
+}
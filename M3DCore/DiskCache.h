@@ -0,0 +1,72 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Exports.h"
+#include "MString.h"
+#include "Containers.h"
+#include <filesystem>
+
+namespace m3d
+{
+
+// Reads a whole file. Returns false if it can not be read.
+extern bool M3DCORE_API ReadFileData(const std::filesystem::path &filename, List<uint8> &data);
+// Writes a file through a temporary file in the same folder that is renamed when complete, so other processes reading
+// the file see the old or the new content, never a partly written file. Returns false if it could not be written.
+extern bool M3DCORE_API WriteFileAtomic(const std::filesystem::path &filename, const void *data, size_t size);
+
+// A folder of files, each holding the data for a 64-bit key and named by the key in hex. A header identifies the cache,
+// its format version, the key and the data size, so files of other caches or versions, and damaged files, are ignored.
+// Files are written with WriteFileAtomic(), so the folder can be shared by processes running at the same time.
+class M3DCORE_API DiskCache
+{
+public:
+	// extension includes the dot, eg ".sxsc".
+	DiskCache(std::filesystem::path directory, String extension, uint32 magic, uint32 version);
+
+	// Empty for no disk cache. Read() and Write() then fail.
+	const std::filesystem::path &GetDirectory() const { return _directory; }
+	void SetDirectory(std::filesystem::path directory) { _directory = directory; }
+
+	// Returns the file for key, or an empty path if there is no directory.
+	std::filesystem::path GetFileName(uint64 key) const;
+	// Reads the data stored for key. Returns false if there is none, or the file is not valid.
+	bool Read(uint64 key, List<uint8> &data) const;
+	// Stores data for key, creating the directory if needed. Returns false if it could not be stored.
+	bool Write(uint64 key, const uint8 *data, size_t size) const;
+	// Removes the files of this cache from the directory.
+	void Clear() const;
+
+	// Formats the key as 16 hex digits.
+	static String KeyToString(uint64 key);
+
+private:
+	std::filesystem::path _directory;
+	String _extension;
+	uint32 _magic;
+	uint32 _version;
+};
+
+}
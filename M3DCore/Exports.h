@@ -25,7 +25,9 @@
 
 
 
-#ifdef M3DCore_EXPORTS
+#if defined(M3DCORE_STATIC) || !defined(_WIN32)
+#define M3DCORE_API
+#elif defined(M3DCore_EXPORTS)
 #define M3DCORE_API __declspec(dllexport)
 #else
 #define M3DCORE_API __declspec(dllimport)
@@ -23,12 +23,19 @@
 
 #include "pch.h"
 #include "GuidUtil.h"
+#ifdef _WIN32
 #include <Objbase.h> // Windows
+#else
+#include <random>
+#include <cstdio>
+#endif
 
 
 using namespace m3d;
 
 
+#ifdef _WIN32
+
 bool m3d::GenerateGuid(Guid &guid)
 {
 	return CoCreateGuid((GUID*)&guid) == S_OK;
@@ -53,4 +60,42 @@ bool m3d::StringToGUID(const String &str, Guid&guid)
 	HRESULT hr = CLSIDFromString(buff2, (LPCLSID)&guid);
 
 	return hr == S_OK;
-}
\ No newline at end of file
+}
+
+#else
+
+// Same format as StringFromGUID2(): {XXXXXXXX-XXXX-XXXX-XXXX-XXXXXXXXXXXX}.
+
+bool m3d::GenerateGuid(Guid &guid)
+{
+	static std::random_device rd;
+	uint32 r[4] = { rd(), rd(), rd(), rd() };
+	std::memcpy(&guid, r, sizeof(Guid));
+	guid.Data3 = (guid.Data3 & 0x0FFF) | 0x4000; // Version 4 (random).
+	guid.Data4[0] = (guid.Data4[0] & 0x3F) | 0x80;
+	return true;
+}
+
+String m3d::GuidToString(const Guid &guid)
+{
+	char buff[64];
+	std::snprintf(buff, sizeof(buff), "{%08X-%04X-%04X-%02X%02X-%02X%02X%02X%02X%02X%02X}", guid.Data1, guid.Data2, guid.Data3, 
+		guid.Data4[0], guid.Data4[1], guid.Data4[2], guid.Data4[3], guid.Data4[4], guid.Data4[5], guid.Data4[6], guid.Data4[7]);
+	return String(buff);
+}
+
+bool m3d::StringToGUID(const String &str, Guid &guid)
+{
+	uint32 d[11];
+	char end;
+	if (str.size() != 38 || std::sscanf(str.c_str(), "{%8x-%4x-%4x-%2x%2x-%2x%2x%2x%2x%2x%2x%c", &d[0], &d[1], &d[2], &d[3], &d[4], &d[5], &d[6], &d[7], &d[8], &d[9], &d[10], &end) != 12 || end != '}')
+		return false;
+	guid.Data1 = d[0];
+	guid.Data2 = (uint16)d[1];
+	guid.Data3 = (uint16)d[2];
+	for (uint32 i = 0; i < 8; i++)
+		guid.Data4[i] = (uint8)d[3 + i];
+	return true;
+}
+
+#endif
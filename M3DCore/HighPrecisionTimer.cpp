@@ -23,16 +23,12 @@
 
 #include "pch.h"
 #include "HighPrecisionTimer.h"
+#include "Clock.h"
 #include <algorithm>
 
 
 using namespace m3d;
 
-int64 queryFreq() { int64 i = 0; QueryPerformanceFrequency((LARGE_INTEGER*)&i); return i; }
-
-const int64 HighPrecisionTimer::_freq = queryFreq();
-
-
 HighPrecisionTimer::HighPrecisionTimer()
 {
 	_count = 0;
@@ -46,23 +42,17 @@ HighPrecisionTimer::~HighPrecisionTimer()
 {
 }
 
-int64 _gettime_us(int64 t, int64 f) { return int64(t / f) * int64(1000000) + int64(t % f) * int64(1000000) / f; }
-float64 _gettime_s(int64 t, int64 f) { return float64(t / f) + float64(t % f) / f; }
-
 void HighPrecisionTimer::Tick()
 {
-	int64 count;
-//	DWORD_PTR threadAffMask = SetThreadAffinityMask(GetCurrentThread(), 1);
-	QueryPerformanceCounter((LARGE_INTEGER*)&count);
-//	SetThreadAffinityMask(GetCurrentThread(),threadAffMask );
+	int64 count = Clock::GetTime_ns();
 
 	if (_count != 0) {
-		_dt = _gettime_s(count - _count, _freq);
-		_dt_us = _gettime_us(count - _count, _freq);
+		_dt = Clock::ToSeconds(count - _count);
+		_dt_us = (count - _count) / 1000;
 	}
 
-	_time = _gettime_s(count, _freq);
-	_time_us = _gettime_us(count, _freq);
+	_time = Clock::ToSeconds(count);
+	_time_us = count / 1000;
 	_count = count;
 }
 
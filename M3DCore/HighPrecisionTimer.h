@@ -29,6 +29,7 @@
 namespace m3d
 {
 
+// Measures the time between calls to Tick(). Based on Clock.
 class M3DCORE_API HighPrecisionTimer
 {
 private:
@@ -38,8 +39,6 @@ private:
 	float64 _dt;
 	float64 _time;
 
-	static const int64 _freq;
-
 public:
 	HighPrecisionTimer();
 	~HighPrecisionTimer();
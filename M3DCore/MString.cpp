@@ -28,6 +28,8 @@
 using namespace m3d;
 
 
+#ifdef _WIN32
+
 wchar_t* strUtils::widen(wchar_t* output, int32 outputSize, const Char* input)
 {
 	MultiByteToWideChar(CP_UTF8, 0, input, -1, output, outputSize);
@@ -40,6 +42,64 @@ Char* strUtils::narrow(Char* output, int32 outputSize, const wchar_t* input)
 	return output;
 }
 
+#else
+
+// UTF-8 to and from UTF-32 (wchar_t is 32 bits on these platforms). Invalid sequences are replaced by '?'.
+
+wchar_t* strUtils::widen(wchar_t* output, int32 outputSize, const Char* input)
+{
+	const uint8 *p = (const uint8*)input;
+	int32 n = 0;
+	while (*p && n < outputSize - 1) {
+		uint32 c = *p++, extra = c < 0x80 ? 0 : c < 0xE0 ? 1 : c < 0xF0 ? 2 : 3;
+		c = extra == 0 ? c : extra == 1 ? (c & 0x1F) : extra == 2 ? (c & 0x0F) : (c & 0x07);
+		for (; extra > 0 && (*p & 0xC0) == 0x80; extra--)
+			c = (c << 6) | (*p++ & 0x3F);
+		output[n++] = extra == 0 ? (wchar_t)c : L'?';
+	}
+	if (outputSize > 0)
+		output[n] = L'\0';
+	return output;
+}
+
+Char* strUtils::narrow(Char* output, int32 outputSize, const wchar_t* input)
+{
+	int32 n = 0;
+	for (; *input; input++) {
+		uint32 c = (uint32)*input;
+		Char b[4];
+		int32 len = 0;
+		if (c < 0x80)
+			b[len++] = (Char)c;
+		else if (c < 0x800) {
+			b[len++] = (Char)(0xC0 | (c >> 6));
+			b[len++] = (Char)(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000) {
+			b[len++] = (Char)(0xE0 | (c >> 12));
+			b[len++] = (Char)(0x80 | ((c >> 6) & 0x3F));
+			b[len++] = (Char)(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x110000) {
+			b[len++] = (Char)(0xF0 | (c >> 18));
+			b[len++] = (Char)(0x80 | ((c >> 12) & 0x3F));
+			b[len++] = (Char)(0x80 | ((c >> 6) & 0x3F));
+			b[len++] = (Char)(0x80 | (c & 0x3F));
+		}
+		else
+			b[len++] = MCHAR('?');
+		if (n + len > outputSize - 1)
+			break;
+		for (int32 i = 0; i < len; i++)
+			output[n++] = b[i];
+	}
+	if (outputSize > 0)
+		output[n] = MCHAR('\0');
+	return output;
+}
+
+#endif
+
 String strUtils::narrow2(const wchar_t* input)
 {
 	if (!input)
@@ -123,8 +183,61 @@ int32 strUtils::compareNoCase(const String& str1, const String& str2)
 }
 
 
+int32 strUtils::__getPrecisionOfFormat(const Char* fmt)
+{
+	if (fmt[0] != MCHAR('%'))
+		return -1;
+	if (fmt[1] == MCHAR('g') && fmt[2] == MCHAR('\0'))
+		return 6;
+	if (fmt[1] != MCHAR('.'))
+		return -1;
+	int32 precision = 0;
+	const Char* c = fmt + 2;
+	for (; *c >= MCHAR('0') && *c <= MCHAR('9') && precision < 100; c++)
+		precision = precision * 10 + (*c - MCHAR('0'));
+	return c != fmt + 2 && c[0] == MCHAR('g') && c[1] == MCHAR('\0') ? precision : -1;
+}
+
+template<typename T>
+Char* __toCharsFloat(Char* first, Char* last, T v, int32 precision)
+{
+	auto copy = [first, last](const Char* s) -> Char* { size_t n = std::strlen(s); if (size_t(last - first) < n) return nullptr; std::memcpy(first, s, n); return first + n; };
+	if (v != v)
+		return copy(MTEXT("nan"));
+	else if (v < -std::numeric_limits<T>::max())
+		return copy(MTEXT("-inf"));
+	else if (v > std::numeric_limits<T>::max())
+		return copy(MTEXT("+inf"));
+	else if (v == -std::numeric_limits<T>::max())
+		return copy(MTEXT("-max"));
+	else if (v == std::numeric_limits<T>::max())
+		return copy(MTEXT("+max"));
+	else if (v < std::numeric_limits<T>::min() && v > -std::numeric_limits<T>::min())
+		v = T(0); // Denormals and -0 are written as 0.
+	// With a precision, to_chars gives the same result as printf("%.<precision>g").
+	std::to_chars_result r = std::to_chars(first, last, v, std::chars_format::general, precision == 0 ? 1 : precision);
+	return r.ec == std::errc() ? r.ptr : nullptr;
+}
+
+Char* strUtils::toChars(Char* first, Char* last, float32 v, int32 precision)
+{
+	return __toCharsFloat(first, last, v, precision);
+}
+
+Char* strUtils::toChars(Char* first, Char* last, float64 v, int32 precision)
+{
+	return __toCharsFloat(first, last, v, precision);
+}
+
 String strUtils::fromNum(float32 v, const Char* fmt) // can return nan, +inf, -inf
 {
+	int32 precision = __getPrecisionOfFormat(fmt);
+	if (precision >= 0 && precision <= 40) {
+		Char tmp[64];
+		Char* end = toChars(tmp, tmp + 64, v, precision);
+		if (end)
+			return String(tmp, end);
+	}
 	if (v != v)
 		return MTEXT("nan");
 	else if (v < -std::numeric_limits<float32>::max())
@@ -142,6 +255,13 @@ String strUtils::fromNum(float32 v, const Char* fmt) // can return nan, +inf, -i
 
 String strUtils::fromNum(float64 v, const Char* fmt) // can return nan, +inf, -inf
 {
+	int32 precision = __getPrecisionOfFormat(fmt);
+	if (precision >= 0 && precision <= 40) {
+		Char tmp[64];
+		Char* end = toChars(tmp, tmp + 64, v, precision);
+		if (end)
+			return String(tmp, end);
+	}
 	if (v != v)
 		return MTEXT("nan");
 	else if (v < -std::numeric_limits<float64>::max())
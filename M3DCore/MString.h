@@ -35,6 +35,9 @@
 #include <algorithm>
 #include <ios>
 #include <sstream>
+#include <limits>
+#include <charconv>
+#include <cstring>
 
 
 namespace m3d
@@ -64,10 +67,11 @@ namespace m3d
 
 		enum class NumBase { OCT, DEC, HEX };
 
+		// The original implementation. Still used for bool and char sized types, where operator>> does not read numbers.
 		template<typename NumType>
 		static bool __toNumFromString(const String& string, NumType& v, NumBase base)
 		{
-			std::basic_istringstream<Char, String::traits_type, String::allocator_type> iss(string);
+			std::basic_istringstream<Char, String::traits_type, Allocator<Char>> iss(string); // Not String::allocator_type, which libstdc++ rebinds to std::allocator.
 			switch (base)
 			{
 			case NumBase::OCT: iss >> std::oct >> v; break;
@@ -77,28 +81,157 @@ namespace m3d
 			return iss.eof();
 		}
 
-		template<typename NumType, typename std::enable_if<std::is_floating_point<NumType>::value>::type* = nullptr>
-		static bool toNum(const String& string, NumType& v, NumBase base = NumBase::DEC)
+		template<typename NumType>
+		static constexpr bool __isCharConvType = std::is_arithmetic<NumType>::value && !std::is_same<NumType, bool>::value && sizeof(NumType) > 1;
+
+		static bool __isSpace(Char c) { return c == MCHAR(' ') || (c >= MCHAR('\t') && c <= MCHAR('\r')); }
+
+		// Parses [first, last) using from_chars, following the rules of __toNumFromString():
+		// Leading white space is skipped. Returns true if all characters are used. An empty string returns true without touching v.
+		// A failed number sets v to 0. A number out of range sets v to the max/lowest value (0 on float underflow).
+		template<typename NumType>
+		static bool __toNumFromChars(const Char* first, const Char* last, NumType& v, NumBase base)
+		{
+			while (first != last && __isSpace(*first))
+				first++;
+			if (first == last)
+				return true;
+			bool negative = *first == MCHAR('-');
+			if (negative || *first == MCHAR('+')) {
+				if (++first == last) { // operator>> fails, but reaches eof.
+					v = 0;
+					return true;
+				}
+			}
+			if constexpr (std::is_floating_point<NumType>::value) {
+				if (!((*first >= MCHAR('0') && *first <= MCHAR('9')) || *first == MCHAR('.'))) {
+					v = 0; // from_chars accepts inf and nan. operator>> does not.
+					return false;
+				}
+				NumType f;
+				std::from_chars_result r = std::from_chars(first, last, f, std::chars_format::general);
+				if (r.ec == std::errc::invalid_argument) {
+					v = 0;
+					return false;
+				}
+				if (r.ec == std::errc::result_out_of_range) {
+					// Too small if there is a negative exponent. Otherwise too large.
+					const Char* e = std::find_if(first, r.ptr, [](Char c) { return c == MCHAR('e') || c == MCHAR('E'); });
+					f = e != r.ptr && e + 1 != r.ptr && e[1] == MCHAR('-') ? NumType(0) : std::numeric_limits<NumType>::max();
+				}
+				else if (r.ptr != last && (*r.ptr == MCHAR('e') || *r.ptr == MCHAR('E'))) {
+					// operator>> takes an exponent without digits, like "1e+", and fails.
+					const Char* e = r.ptr + 1;
+					if (e != last && (*e == MCHAR('+') || *e == MCHAR('-')))
+						e++;
+					v = 0;
+					return e == last;
+				}
+				v = negative ? -f : f;
+				return r.ptr == last;
+			}
+			else {
+				using UNumType = typename std::make_unsigned<NumType>::type;
+				if (base == NumBase::HEX && last - first > 1 && first[0] == MCHAR('0') && (first[1] == MCHAR('x') || first[1] == MCHAR('X')))
+					first += 2;
+				if (first == last || *first == MCHAR('+') || *first == MCHAR('-')) {
+					v = 0;
+					return false;
+				}
+				UNumType u;
+				std::from_chars_result r = std::from_chars(first, last, u, base == NumBase::OCT ? 8 : (base == NumBase::HEX ? 16 : 10));
+				if (r.ec == std::errc::invalid_argument) {
+					v = 0;
+					return false;
+				}
+				if constexpr (std::is_signed<NumType>::value) {
+					if (r.ec == std::errc::result_out_of_range || u > UNumType(std::numeric_limits<NumType>::max()) + (negative ? 1u : 0u))
+						v = negative ? std::numeric_limits<NumType>::lowest() : std::numeric_limits<NumType>::max();
+					else
+						v = negative ? NumType(UNumType(0) - u) : NumType(u);
+				}
+				else {
+					if (r.ec == std::errc::result_out_of_range)
+						v = std::numeric_limits<NumType>::max();
+					else
+						v = negative ? NumType(UNumType(0) - u) : u; // Negative numbers wrap around, like strtoul().
+				}
+				return r.ptr == last;
+			}
+		}
+
+		// Parses the number in [first, last). Allocation free for all number types except bool and char sized ones.
+		// Same rules as toNum(const String&...). Floats also accept nan, +inf, -inf, +max and -max.
+		template<typename NumType>
+		static bool toNum(const Char* first, const Char* last, NumType& v, NumBase base = NumBase::DEC)
 		{
-			if (string == MTEXT("nan"))
-				v = std::numeric_limits<NumType>::quiet_NaN();
-			else if (string == MTEXT("+inf"))
-				v = std::numeric_limits<NumType>::infinity();
-			else if (string == MTEXT("-inf"))
-				v = -std::numeric_limits<NumType>::infinity();
-			else if (string == MTEXT("+max"))
-				v = std::numeric_limits<NumType>::max();
-			else if (string == MTEXT("-max"))
-				v = -std::numeric_limits<NumType>::max();
+			if constexpr (std::is_floating_point<NumType>::value) {
+				StringView s(first, last - first);
+				if (s == MTEXT("nan"))
+					v = std::numeric_limits<NumType>::quiet_NaN();
+				else if (s == MTEXT("+inf"))
+					v = std::numeric_limits<NumType>::infinity();
+				else if (s == MTEXT("-inf"))
+					v = -std::numeric_limits<NumType>::infinity();
+				else if (s == MTEXT("+max"))
+					v = std::numeric_limits<NumType>::max();
+				else if (s == MTEXT("-max"))
+					v = -std::numeric_limits<NumType>::max();
+				else
+					return __toNumFromChars(first, last, v, base);
+				return true;
+			}
+			else if constexpr (__isCharConvType<NumType>)
+				return __toNumFromChars(first, last, v, base);
 			else
-				return __toNumFromString(string, v, base);
-			return true;
+				return __toNumFromString(String(first, last), v, base);
 		}
 
-		template<typename NumType, typename std::enable_if<!std::is_floating_point<NumType>::value>::type* = nullptr>
+		template<typename NumType>
 		static bool toNum(const String& string, NumType& v, NumBase base = NumBase::DEC)
 		{
-			return __toNumFromString(string, v, base);
+			return toNum(string.data(), string.data() + string.size(), v, base);
+		}
+
+		// Parses a list of numbers in [first, last), calling callback(NumType) for each of them. The callback returns false to stop.
+		// The numbers are separated by white space and/or one of the delimiters. Empty fields between two delimiters are errors.
+		// Returns true if all numbers were parsed and the callback never returned false.
+		template<typename NumType, typename Callback>
+		static bool forEachNum(const Char* first, const Char* last, Callback&& callback, const Char* delimiters = MTEXT(","), NumBase base = NumBase::DEC)
+		{
+			const Char* delimitersEnd = delimiters + std::char_traits<Char>::length(delimiters);
+			auto isDelimiter = [&](Char c) { return std::find(delimiters, delimitersEnd, c) != delimitersEnd; };
+			bool needNumber = false; // true after a delimiter.
+			while (true) {
+				while (first != last && __isSpace(*first))
+					first++;
+				if (first == last)
+					return !needNumber;
+				const Char* end = first;
+				while (end != last && !__isSpace(*end) && !isDelimiter(*end))
+					end++;
+				NumType v;
+				if (end == first || !toNum(first, end, v, base) || !callback(v))
+					return false;
+				for (first = end; first != last && __isSpace(*first); first++);
+				needNumber = first != last && isDelimiter(*first);
+				if (needNumber)
+					first++;
+			}
+		}
+
+		// Parses a list of numbers like forEachNum(), and appends them to out (anything with push_back()).
+		// On failure, the numbers parsed before the failing one are left in out.
+		template<typename NumType, typename Container>
+		static bool toNums(const Char* first, const Char* last, Container& out, const Char* delimiters = MTEXT(","), NumBase base = NumBase::DEC)
+		{
+			return forEachNum<NumType>(first, last, [&out](NumType v) { out.push_back(v); return true; }, delimiters, base);
+		}
+
+		template<typename NumType, typename Container>
+		static bool toNums(const String& string, Container& out, const Char* delimiters = MTEXT(","), NumBase base = NumBase::DEC)
+		{
+			return toNums<NumType>(string.data(), string.data() + string.size(), out, delimiters, base);
 		}
 
 		template<int32 BufferSize = 4096>
@@ -114,14 +247,38 @@ namespace m3d
 			return tmp;
 		}
 
+		// Writes v to [first, last) like fromNum() does with a "%g" or "%.<precision>g" format, without allocating.
+		// Returns the end of the written characters, or nullptr if there is not enough room (32 characters is enough for a precision up to 17).
+		static Char* toChars(Char* first, Char* last, float32 v, int32 precision = 9); // can write nan, +inf, -inf
+		static Char* toChars(Char* first, Char* last, float64 v, int32 precision = 17); // can write nan, +inf, -inf
+		// Writes v to [first, last) in the given base, without allocating. Returns the end of the written characters, or nullptr if there is not enough room.
+		template<typename NumType, typename std::enable_if<!std::is_floating_point<NumType>::value>::type* = nullptr>
+		static Char* toChars(Char* first, Char* last, NumType v, NumBase base = NumBase::DEC)
+		{
+			std::to_chars_result r = std::to_chars(first, last, v, base == NumBase::OCT ? 8 : (base == NumBase::HEX ? 16 : 10));
+			return r.ec == std::errc() ? r.ptr : nullptr;
+		}
+		// Returns the precision of a "%g" or "%.<precision>g" format, or -1 for other formats.
+		static int32 __getPrecisionOfFormat(const Char* fmt);
+
+		// The float formats "%g" and "%.<precision>g", and the default formats of the integers, use toChars(). Others use format().
 		static String fromNum(float32 v, const Char* fmt = MTEXT("%.9g")); // can return nan, +inf, -inf
 		static String fromNum(float64 v, const Char* fmt = MTEXT("%.17g")); // can return nan, +inf, -inf
-		static String fromNum(int16 v, const Char* fmt = MTEXT("%hi")) { return format(fmt, v); }
-		static String fromNum(uint16 v, const Char* fmt = MTEXT("%hu")) { return format(fmt, v); }
-		static String fromNum(int32 v, const Char* fmt = MTEXT("%i")) { return format(fmt, v); }
-		static String fromNum(uint32 v, const Char* fmt = MTEXT("%u")) { return format(fmt, v); }
-		static String fromNum(int64 v, const Char* fmt = MTEXT("%I64d")) { return format(fmt, v); }
-		static String fromNum(uint64 v, const Char* fmt = MTEXT("%I64u")) { return format(fmt, v); }
+		static String fromNum(int16 v, const Char* fmt = MTEXT("%hi")) { return __fromNum(v, fmt, MTEXT("%hi")); }
+		static String fromNum(uint16 v, const Char* fmt = MTEXT("%hu")) { return __fromNum(v, fmt, MTEXT("%hu")); }
+		static String fromNum(int32 v, const Char* fmt = MTEXT("%i")) { return __fromNum(v, fmt, MTEXT("%i")); }
+		static String fromNum(uint32 v, const Char* fmt = MTEXT("%u")) { return __fromNum(v, fmt, MTEXT("%u")); }
+		static String fromNum(int64 v, const Char* fmt = MTEXT("%I64d")) { return __fromNum(v, fmt, MTEXT("%I64d")); }
+		static String fromNum(uint64 v, const Char* fmt = MTEXT("%I64u")) { return __fromNum(v, fmt, MTEXT("%I64u")); }
+
+		template<typename NumType>
+		static String __fromNum(NumType v, const Char* fmt, const Char* defaultFmt)
+		{
+			if (std::strcmp(fmt, defaultFmt) != 0)
+				return format(fmt, v);
+			Char tmp[24];
+			return String(tmp, toChars(tmp, tmp + 24, v));
+		}
 
 		struct ConstructString
 		{
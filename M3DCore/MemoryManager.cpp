@@ -25,7 +25,48 @@
 #include "MemoryManager.h"
 #include <set>
 #include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+#ifndef _WIN32
+// Replacements for the aligned allocation functions of the MSVC runtime. The block returned by malloc() 
+// and the requested size are stored in front of the returned memory.
+static void *_aligned_offset_malloc(size_t size, size_t alignment, size_t offset)
+{
+	const size_t header = sizeof(void*) + sizeof(size_t);
+	uint8_t *p = (uint8_t*)::malloc(size + alignment + header);
+	if (!p)
+		return nullptr;
+	uint8_t *m = (uint8_t*)((((uintptr_t)(p + header + offset) + alignment - 1) & ~(uintptr_t)(alignment - 1)) - offset);
+	std::memcpy(m - sizeof(void*), &p, sizeof(void*));
+	std::memcpy(m - header, &size, sizeof(size_t));
+	return m;
+}
+
+static void _aligned_free(void *mem)
+{
+	if (!mem)
+		return;
+	void *p;
+	std::memcpy(&p, (uint8_t*)mem - sizeof(void*), sizeof(void*));
+	::free(p);
+}
 
+static void *_aligned_offset_realloc(void *mem, size_t size, size_t alignment, size_t offset)
+{
+	if (!mem)
+		return _aligned_offset_malloc(size, alignment, offset);
+	size_t oldSize;
+	std::memcpy(&oldSize, (uint8_t*)mem - sizeof(void*) - sizeof(size_t), sizeof(size_t));
+	void *n = _aligned_offset_malloc(size, alignment, offset);
+	if (!n)
+		return nullptr;
+	std::memcpy(n, mem, std::min(size, oldSize));
+	_aligned_free(mem);
+	return n;
+}
+#endif
 
 using namespace m3d;
 
@@ -161,7 +202,7 @@ MemoryManager::~MemoryManager()
 			OutputDebugStringA(c);
 			OutputDebugStringA("): ");
 			v += DEBUG_EXTRA;
-			std::memcpy(c, v, std::min(size, 32ull));
+			std::memcpy(c, v, std::min(size, (size_t)32));
 			c[32] = '\0';
 			for (uint32 i = 0; i < 32; i++)
 				c[i] = std::max(c[i], (char)32);
@@ -283,7 +324,8 @@ void *MemoryManager::getDebug(size_t size, const char *file, int32 line)
 	*((int16*)(m + sizeof(size_t))) = (int16)line;
 	size_t e = sizeof(size_t) + sizeof(int16);
 	int32 n = int32(strlen(file) + 1) - int32(DEBUG_EXTRA - e);
-	strcpy_s(m + e, DEBUG_EXTRA - e, file + std::max(0, n));
+	const char *f = file + std::max(0, n); // Fits in DEBUG_EXTRA - e, including the null.
+	std::memcpy(m + e, f, std::strlen(f) + 1);
 
 	volatile CriticalBlock critical(_cs);
 	_stats->allocated.insert(m);
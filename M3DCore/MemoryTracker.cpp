@@ -0,0 +1,252 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "MemoryTracker.h"
+#include "Clock.h"
+#include <algorithm>
+
+using namespace m3d;
+
+
+namespace
+{
+
+String jsonEscape(const String &s)
+{
+	String r;
+	r.reserve(s.size());
+	for (Char c : s) {
+		if (c == MCHAR('\"') || c == MCHAR('\\'))
+			r += MCHAR('\\');
+		if ((uint8)c < 0x20)
+			r += strUtils::format(MTEXT("\\u%04x"), (uint32)(uint8)c);
+		else
+			r += c;
+	}
+	return r;
+}
+
+}
+
+
+struct MemoryTracker::Counters
+{
+	std::atomic<int64> live;
+	std::atomic<int64> peak;
+	std::atomic<uint64> allocations;
+	std::atomic<uint64> allocatedBytes;
+};
+
+
+MemoryTracker::MemoryTracker() : _enabled(false), _counters(new Counters[MAX_TAGS]), _tagCount(0)
+{
+	for (uint32 i = 0; i < MAX_TAGS; i++) {
+		_counters[i].live = 0;
+		_counters[i].peak = 0;
+		_counters[i].allocations = 0;
+		_counters[i].allocatedBytes = 0;
+	}
+	RegisterTag(MTEXT("Documents"));
+	RegisterTag(MTEXT("Geometry"));
+	RegisterTag(MTEXT("Textures"));
+	RegisterTag(MTEXT("Physics"));
+}
+
+MemoryTracker::~MemoryTracker()
+{
+}
+
+MemoryTag MemoryTracker::RegisterTag(const String &name)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	auto itr = _tagByName.find(name);
+	if (itr != _tagByName.end())
+		return itr->second;
+	MemoryTag tag = (MemoryTag)_names.size();
+	if (tag == MAX_TAGS)
+		return InvalidMemoryTag;
+	_names.push_back(name);
+	_tagByName.insert(std::make_pair(name, tag));
+	_tagCount.store(tag + 1, std::memory_order_release);
+	return tag;
+}
+
+String MemoryTracker::GetTagName(MemoryTag tag) const
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	return tag < _names.size() ? _names[tag] : String();
+}
+
+uint64 MemoryTracker::Allocate(MemoryTag tag, uint64 bytes)
+{
+	if (!IsEnabled() || tag >= MAX_TAGS)
+		return 0;
+	Counters &c = _counters[tag];
+	int64 live = c.live.fetch_add((int64)bytes, std::memory_order_relaxed) + (int64)bytes;
+	int64 peak = c.peak.load(std::memory_order_relaxed);
+	while (live > peak && !c.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+	c.allocations.fetch_add(1, std::memory_order_relaxed);
+	c.allocatedBytes.fetch_add(bytes, std::memory_order_relaxed);
+	return bytes;
+}
+
+void MemoryTracker::Free(MemoryTag tag, uint64 bytes)
+{
+	if (bytes == 0 || tag >= MAX_TAGS)
+		return;
+	_counters[tag].live.fetch_sub((int64)bytes, std::memory_order_relaxed);
+}
+
+void MemoryTracker::SetLive(MemoryTag tag, uint64 bytes)
+{
+	if (tag >= MAX_TAGS)
+		return;
+	Counters &c = _counters[tag];
+	int64 old = c.live.exchange((int64)bytes, std::memory_order_relaxed);
+	if ((int64)bytes > old)
+		c.allocatedBytes.fetch_add((int64)bytes - old, std::memory_order_relaxed);
+	int64 peak = c.peak.load(std::memory_order_relaxed);
+	while ((int64)bytes > peak && !c.peak.compare_exchange_weak(peak, (int64)bytes, std::memory_order_relaxed));
+}
+
+MemoryTagStats MemoryTracker::GetStats(MemoryTag tag) const
+{
+	MemoryTagStats s;
+	if (tag >= GetTagCount())
+		return s;
+	s.name = GetTagName(tag);
+	const Counters &c = _counters[tag];
+	s.live = c.live.load(std::memory_order_relaxed);
+	s.peak = c.peak.load(std::memory_order_relaxed);
+	s.allocations = c.allocations.load(std::memory_order_relaxed);
+	s.allocatedBytes = c.allocatedBytes.load(std::memory_order_relaxed);
+	return s;
+}
+
+void MemoryTracker::ResetCounters()
+{
+	for (uint32 i = 0, n = GetTagCount(); i < n; i++) {
+		_counters[i].peak = _counters[i].live.load(std::memory_order_relaxed);
+		_counters[i].allocations = 0;
+		_counters[i].allocatedBytes = 0;
+	}
+}
+
+void MemoryTracker::SetCollector(std::function<void()> collector)
+{
+	std::lock_guard<std::mutex> lock(_lock);
+	_collector = collector;
+}
+
+MemorySnapshot MemoryTracker::TakeSnapshot()
+{
+	std::function<void()> collector;
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		collector = _collector;
+	}
+	if (collector && IsEnabled())
+		collector();
+
+	MemorySnapshot s;
+	s.time = Clock::ToSeconds(Clock::GetTime_ns());
+	uint32 n = GetTagCount();
+	s.tags.reserve(n);
+	for (uint32 i = 0; i < n; i++)
+		s.tags.push_back(GetStats(i));
+	return s;
+}
+
+MemoryTracker &m3d::memoryTracker()
+{
+	static MemoryTracker tracker;
+	return tracker;
+}
+
+
+String MemorySnapshot::ToText() const
+{
+	String s = strUtils::format(MTEXT("%-48s %14s %14s %12s %16s\n"), MTEXT("Tag"), MTEXT("Live"), MTEXT("Peak"), MTEXT("Allocations"), MTEXT("Allocated"));
+	for (const MemoryTagStats &t : tags)
+		if (t.peak != 0 || t.allocations != 0)
+			s += strUtils::format(MTEXT("%-48s %14lld %14lld %12llu %16llu\n"), t.name.c_str(), t.live, t.peak, t.allocations, t.allocatedBytes);
+	return s;
+}
+
+String MemorySnapshot::ToJson() const
+{
+	String s = strUtils::format(MTEXT("{\"time\":%.6f,\"tags\":["), time);
+	bool first = true;
+	for (const MemoryTagStats &t : tags) {
+		if (t.peak == 0 && t.allocations == 0)
+			continue;
+		s += strUtils::format(MTEXT("%s\n{\"name\":\"%s\",\"live\":%lld,\"peak\":%lld,\"allocations\":%llu,\"allocatedBytes\":%llu}"), first ? MTEXT("") : MTEXT(","), jsonEscape(t.name).c_str(), t.live, t.peak, t.allocations, t.allocatedBytes);
+		first = false;
+	}
+	s += MTEXT("\n]}");
+	return s;
+}
+
+MemorySnapshotDiff MemorySnapshotDiff::Compute(const MemorySnapshot &from, const MemorySnapshot &to)
+{
+	MemorySnapshotDiff d;
+	d.duration = to.time - from.time;
+	for (size_t i = 0; i < to.tags.size(); i++) {
+		const MemoryTagStats &b = to.tags[i];
+		MemoryTagStats a; // Tags registered after the first snapshot starts at zero.
+		if (i < from.tags.size())
+			a = from.tags[i];
+		MemoryTagDiff t;
+		t.name = b.name;
+		t.live = b.live;
+		t.liveDelta = b.live - a.live;
+		t.allocations = b.allocations >= a.allocations ? b.allocations - a.allocations : b.allocations; // Counters may have been reset.
+		t.allocatedBytes = b.allocatedBytes >= a.allocatedBytes ? b.allocatedBytes - a.allocatedBytes : b.allocatedBytes;
+		t.allocationRate = d.duration > 0.0 ? t.allocatedBytes / d.duration : 0.0;
+		if (t.liveDelta != 0 || t.allocations != 0 || t.allocatedBytes != 0)
+			d.tags.push_back(t);
+	}
+	std::stable_sort(d.tags.begin(), d.tags.end(), [](const MemoryTagDiff &a, const MemoryTagDiff &b) { return a.liveDelta > b.liveDelta; });
+	return d;
+}
+
+String MemorySnapshotDiff::ToText() const
+{
+	String s = strUtils::format(MTEXT("Duration: %.3f s\n%-48s %14s %14s %12s %16s\n"), duration, MTEXT("Tag"), MTEXT("Live"), MTEXT("Change"), MTEXT("Allocations"), MTEXT("Bytes/s"));
+	for (const MemoryTagDiff &t : tags)
+		s += strUtils::format(MTEXT("%-48s %14lld %+14lld %12llu %16.0f\n"), t.name.c_str(), t.live, t.liveDelta, t.allocations, t.allocationRate);
+	return s;
+}
+
+String MemorySnapshotDiff::ToJson() const
+{
+	String s = strUtils::format(MTEXT("{\"duration\":%.6f,\"tags\":["), duration);
+	for (size_t i = 0; i < tags.size(); i++) {
+		const MemoryTagDiff &t = tags[i];
+		s += strUtils::format(MTEXT("%s\n{\"name\":\"%s\",\"live\":%lld,\"liveDelta\":%lld,\"allocations\":%llu,\"allocatedBytes\":%llu,\"allocationRate\":%.1f}"), i > 0 ? MTEXT(",") : MTEXT(""), jsonEscape(t.name).c_str(), t.live, t.liveDelta, t.allocations, t.allocatedBytes, t.allocationRate);
+	}
+	s += MTEXT("\n]}");
+	return s;
+}
@@ -0,0 +1,186 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "MTypes.h"
+#include "MString.h"
+#include "Containers.h"
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <memory>
+
+namespace m3d
+{
+
+// Predefined tags for memory owned by engine subsystems.
+enum class MemorySubsystem : uint32
+{
+	DOCUMENTS, // Document data held while loading.
+	GEOMETRY, // GPU vertex, index and other buffers.
+	TEXTURES, // GPU textures.
+	PHYSICS, // PhysX allocations.
+	COUNT
+};
+
+typedef uint32 MemoryTag;
+static const MemoryTag InvalidMemoryTag = MemoryTag(-1);
+
+struct MemoryTagStats
+{
+	String name;
+	// Bytes currently allocated.
+	int64 live = 0;
+	// Highest number of live bytes seen.
+	int64 peak = 0;
+	// Number of allocations and bytes allocated in total.
+	uint64 allocations = 0;
+	uint64 allocatedBytes = 0;
+};
+
+struct M3DCORE_API MemorySnapshot
+{
+	// Seconds. See Clock.
+	float64 time = 0.0;
+	// Indexed by MemoryTag.
+	List<MemoryTagStats> tags;
+
+	String ToText() const;
+	String ToJson() const;
+};
+
+struct MemoryTagDiff
+{
+	String name;
+	int64 live = 0;
+	int64 liveDelta = 0;
+	uint64 allocations = 0;
+	uint64 allocatedBytes = 0;
+	// Bytes allocated per second.
+	float64 allocationRate = 0.0;
+};
+
+// Difference between two snapshots. Use it to find memory growing between two frames.
+struct M3DCORE_API MemorySnapshotDiff
+{
+	float64 duration = 0.0;
+	// Only tags that has changed, ordered by decreasing liveDelta.
+	List<MemoryTagDiff> tags;
+
+	static MemorySnapshotDiff Compute(const MemorySnapshot &from, const MemorySnapshot &to);
+
+	String ToText() const;
+	String ToJson() const;
+};
+
+// Opt-in memory accounting by tag. Tags are registered by name, and are typically a chip type, a class or a subsystem.
+// Memory is counted in one of two ways:
+// - Allocate()/Free() when memory is allocated. This gives the allocation rate as well.
+// - SetLive() by the collector, that measures memory owned by chips and class instances when a snapshot is taken.
+//   For these, growth is counted as allocated bytes.
+// Counting is lock-free. Allocate() counts nothing while disabled, but Free() always does, so that the two can be paired
+// across enabling and disabling.
+class M3DCORE_API MemoryTracker
+{
+public:
+	static const uint32 MAX_TAGS = 4096;
+
+	MemoryTracker();
+	~MemoryTracker();
+
+	void SetEnabled(bool b) { _enabled.store(b, std::memory_order_relaxed); }
+	bool IsEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+	// Returns the tag with the given name, registering it if needed. InvalidMemoryTag if there are too many tags. THREAD SAFE!
+	MemoryTag RegisterTag(const String &name);
+	MemoryTag GetTag(MemorySubsystem subsystem) const { return (MemoryTag)subsystem; }
+	String GetTagName(MemoryTag tag) const;
+	uint32 GetTagCount() const { return _tagCount.load(std::memory_order_acquire); }
+
+	// Counts an allocation. Returns the number of bytes counted (0 if disabled), to be given to Free() later.
+	uint64 Allocate(MemoryTag tag, uint64 bytes);
+	void Free(MemoryTag tag, uint64 bytes);
+	// Sets the number of live bytes for a tag measured by the collector.
+	void SetLive(MemoryTag tag, uint64 bytes);
+
+	MemoryTagStats GetStats(MemoryTag tag) const;
+	// Clears peaks and allocation counts.
+	void ResetCounters();
+
+	// The collector is called by TakeSnapshot() when enabled. It should call SetLive() for the tags it measures.
+	void SetCollector(std::function<void()> collector);
+	MemorySnapshot TakeSnapshot();
+
+private:
+	struct Counters;
+
+	std::atomic<bool> _enabled;
+	std::unique_ptr<Counters[]> _counters;
+	std::atomic<uint32> _tagCount;
+
+// Class internal only
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable:4251)
+#endif
+	mutable std::mutex _lock;
+	List<String> _names;
+	Map<String, MemoryTag> _tagByName;
+	std::function<void()> _collector;
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+};
+
+// Global memory tracker.
+extern M3DCORE_API MemoryTracker &memoryTracker();
+
+// Counts bytes under a tag until destroyed, for memory held for a while like the document data while loading.
+// Nothing is counted if the tracker is disabled when Set() is called.
+class TrackedAllocation
+{
+public:
+	TrackedAllocation(MemoryTracker &mt, MemoryTag tag) : _mt(mt), _tag(tag), _bytes(0) {}
+	~TrackedAllocation() { _mt.Free(_tag, _bytes); }
+	TrackedAllocation(const TrackedAllocation&) = delete;
+	TrackedAllocation &operator=(const TrackedAllocation&) = delete;
+
+	// Replaces the number of bytes counted.
+	void Set(uint64 bytes)
+	{
+		_mt.Free(_tag, _bytes);
+		_bytes = bytes ? _mt.Allocate(_tag, bytes) : 0;
+	}
+	// Bytes counted now.
+	uint64 GetBytes() const { return _bytes; }
+
+private:
+	MemoryTracker &_mt;
+	MemoryTag _tag;
+	uint64 _bytes;
+};
+
+}
@@ -0,0 +1,437 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "MessageLog.h"
+#include "Clock.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+using namespace m3d;
+
+
+namespace
+{
+
+std::atomic<uint64> nextLogID(1);
+
+uint32 currentThreadID()
+{
+#ifdef _WIN32
+	return (uint32)GetCurrentThreadId();
+#else
+	return (uint32)std::hash<std::thread::id>()(std::this_thread::get_id());
+#endif
+}
+
+// FNV-1a. Only used to recognize repeated messages.
+uint64 hashMessage(const String &s)
+{
+	uint64 h = 14695981039346656037ull;
+	for (Char c : s)
+		h = (h ^ (uint8)c) * 1099511628211ull;
+	return h;
+}
+
+// Kept free of strUtils, so that the log can be built on its own.
+String toString(uint64 v)
+{
+	Char buff[24];
+	snprintf(buff, sizeof(buff), "%llu", (unsigned long long)v);
+	return buff;
+}
+
+}
+
+
+// Single producer (the posting thread), single consumer (the writer thread) ring buffer.
+struct MessageLog::Ring
+{
+	struct Slot
+	{
+		MessageRecord record;
+		// Repeats of the previous record not yet collected by the writer.
+		uint32 previousRepeats = 0;
+	};
+
+	List<Slot> slots;
+	const uint64 mask;
+	const uint32 threadID;
+
+	// Written by the producer.
+	alignas(64) std::atomic<uint64> tail;
+	// Sequence number (lower 32 bits) of the last record posted in the upper 32 bits, and the number of times it has been repeated in the lower.
+	std::atomic<uint64> repeats;
+	std::atomic<uint64> posted;
+	std::atomic<uint64> folded;
+	std::atomic<uint64> dropped;
+	// Dropped since the writer last reported it.
+	std::atomic<uint32> droppedReport;
+	// Set when the thread exits. The writer removes the ring when it is empty.
+	std::atomic<bool> orphaned;
+	// Set when the log is destroyed. The thread removes its reference on next lookup.
+	std::atomic<bool> closed;
+
+	// Written by the writer.
+	alignas(64) std::atomic<uint64> head;
+
+	// Owned by the producer: The last record posted, for folding repeats.
+	bool hasLast = false;
+	uint64 lastHash = 0;
+	uint32 lastSeverity = 0, lastClazzID = 0, lastChipID = 0;
+
+	// Owned by the writer: The last record taken, for reporting its repeats.
+	bool hasTaken = false;
+	uint32 takenSeq = 0;
+	MessageRecord taken;
+
+	Ring(uint32 capacity, uint32 threadID) : mask(capacity - 1), threadID(threadID), tail(0), repeats(0), posted(0), folded(0), dropped(0), droppedReport(0), orphaned(false), closed(false), head(0)
+	{
+		slots.resize(capacity);
+	}
+};
+
+// Per chip message counts for the current second, shared by all posting threads without locks.
+// Open addressing by chip id. Entries are never removed. When the table is full, chips not in it are not limited.
+struct MessageLog::RateLimit
+{
+	static const uint32 SIZE = 4096; // Power of 2.
+	static const uint32 MAX_PROBES = 32;
+
+	struct Counter
+	{
+		std::atomic<uint32> chipID;
+		std::atomic<uint32> clazzID;
+		// Window (seconds since start) in the upper 32 bits, messages posted in it in the lower.
+		std::atomic<uint64> count;
+		// Suppressed since the writer last reported it.
+		std::atomic<uint32> suppressed;
+	};
+
+	const int64 start;
+	// Owned by the writer thread.
+	int64 lastReport;
+	Counter counters[SIZE];
+
+	RateLimit() : start(Clock::GetTime_ns()), lastReport(start)
+	{
+		for (Counter &c : counters) {
+			c.chipID.store(0, std::memory_order_relaxed);
+			c.clazzID.store(0, std::memory_order_relaxed);
+			c.count.store(0, std::memory_order_relaxed);
+			c.suppressed.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	Counter *find(uint32 chipID, uint32 clazzID)
+	{
+		for (uint32 i = 0, j = chipID * 2654435761u; i < MAX_PROBES; i++, j++) {
+			Counter &c = counters[j & (SIZE - 1)];
+			uint32 id = c.chipID.load(std::memory_order_acquire);
+			if (id == 0 && c.chipID.compare_exchange_strong(id, chipID, std::memory_order_acq_rel)) {
+				c.clazzID.store(clazzID, std::memory_order_relaxed);
+				return &c;
+			}
+			if (id == chipID)
+				return &c;
+		}
+		return nullptr;
+	}
+
+	// Counts the message. Returns false if it exceeds the limit for the current second.
+	bool allow(uint32 chipID, uint32 clazzID, uint32 limit)
+	{
+		Counter *c = find(chipID, clazzID);
+		if (!c)
+			return true;
+		uint64 window = (uint64)((Clock::GetTime_ns() - start) / Clock::TICKS_PER_SECOND);
+		uint64 v = c->count.load(std::memory_order_relaxed), n;
+		do {
+			n = (v >> 32) == window ? v + 1 : ((window << 32) | 1);
+		} while (!c->count.compare_exchange_weak(v, n, std::memory_order_relaxed));
+		if ((uint32)n <= limit)
+			return true;
+		c->suppressed.fetch_add(1, std::memory_order_relaxed);
+		return false;
+	}
+};
+
+
+MessageLog::MessageLog(Sink sink, const Settings &settings) : _id(nextLogID++), _settings(settings), _sink(sink), _suppressed(0)
+{
+	_rateLimit = std::make_unique<RateLimit>();
+	_writer = std::thread(&MessageLog::_run, this);
+}
+
+MessageLog::~MessageLog()
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_stop = true;
+	}
+	_wake.notify_one();
+	_writer.join();
+
+	std::lock_guard<std::mutex> lock(_ringsLock);
+	for (const auto &r : _rings)
+		r->closed = true;
+	_rings.clear();
+}
+
+MessageLog::Ring *MessageLog::_getRing()
+{
+	struct ThreadRings
+	{
+		List<std::pair<uint64, std::shared_ptr<Ring>>> rings;
+		~ThreadRings()
+		{
+			for (const auto &r : rings)
+				r.second->orphaned = true;
+		}
+	};
+	static thread_local ThreadRings threadRings;
+
+	for (const auto &r : threadRings.rings)
+		if (r.first == _id)
+			return r.second.get();
+
+	// First message from this thread. Forget rings of logs destroyed since last time.
+	threadRings.rings.erase(std::remove_if(threadRings.rings.begin(), threadRings.rings.end(), [](const auto &r) { return r.second->closed.load(); }), threadRings.rings.end());
+
+	uint32 capacity = 1;
+	while (capacity < std::max(_settings.ringCapacity, 2u))
+		capacity <<= 1;
+	auto ring = std::make_shared<Ring>(capacity, currentThreadID());
+	{
+		std::lock_guard<std::mutex> lock(_ringsLock);
+		_rings.push_back(ring);
+	}
+	threadRings.rings.push_back(std::make_pair(_id, ring));
+	return ring.get();
+}
+
+void MessageLog::Post(uint32 severity, String message, uint32 clazzID, uint32 chipID)
+{
+	Ring *ring = _getRing();
+
+	// Only this thread writes these counters, so no need for an atomic increment.
+	ring->posted.store(ring->posted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	uint64 hash = 0;
+	if (_settings.deduplicate) {
+		hash = hashMessage(message);
+		if (ring->hasLast && ring->lastHash == hash && ring->lastSeverity == severity && ring->lastClazzID == clazzID && ring->lastChipID == chipID) {
+			ring->repeats.fetch_add(1, std::memory_order_relaxed);
+			ring->folded.store(ring->folded.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			return;
+		}
+	}
+
+	// Checked before the message takes a slot, so that a flooding chip can not fill the ring.
+	if (chipID != 0 && _settings.rateLimit > 0 && !_rateLimit->allow(chipID, clazzID, _settings.rateLimit)) {
+		_suppressed++;
+		return;
+	}
+
+	uint64 t = ring->tail.load(std::memory_order_relaxed);
+	if (t - ring->head.load(std::memory_order_acquire) > ring->mask) {
+		ring->dropped.store(ring->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		ring->droppedReport.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	Ring::Slot &slot = ring->slots[t & ring->mask];
+	slot.record.severity = severity;
+	slot.record.timestamp = time(0);
+	slot.record.threadID = ring->threadID;
+	slot.record.clazzID = clazzID;
+	slot.record.chipID = chipID;
+	slot.record.message = std::move(message);
+	// Start counting repeats of this record, collecting those of the previous one not yet taken by the writer.
+	slot.previousRepeats = (uint32)ring->repeats.exchange((uint64)(uint32)t << 32, std::memory_order_acq_rel);
+	ring->tail.store(t + 1, std::memory_order_release);
+
+	ring->hasLast = _settings.deduplicate;
+	ring->lastHash = hash;
+	ring->lastSeverity = severity;
+	ring->lastClazzID = clazzID;
+	ring->lastChipID = chipID;
+
+	if (severity >= _settings.wakeSeverity)
+		_wake.notify_one();
+}
+
+void MessageLog::Flush()
+{
+	if (std::this_thread::get_id() == _writer.get_id())
+		return;
+	std::unique_lock<std::mutex> lock(_lock);
+	uint64 request = ++_flushRequest;
+	_wake.notify_one();
+	_flushed.wait(lock, [&]() { return _flushDone >= request; });
+}
+
+uint64 MessageLog::GetPostedCount() const
+{
+	std::lock_guard<std::mutex> lock(_ringsLock);
+	uint64 n = _posted;
+	for (const auto &r : _rings)
+		n += r->posted.load(std::memory_order_relaxed);
+	return n;
+}
+
+uint64 MessageLog::GetFoldedCount() const
+{
+	std::lock_guard<std::mutex> lock(_ringsLock);
+	uint64 n = _folded;
+	for (const auto &r : _rings)
+		n += r->folded.load(std::memory_order_relaxed);
+	return n;
+}
+
+uint64 MessageLog::GetDroppedCount() const
+{
+	std::lock_guard<std::mutex> lock(_ringsLock);
+	uint64 n = _dropped;
+	for (const auto &r : _rings)
+		n += r->dropped.load(std::memory_order_relaxed);
+	return n;
+}
+
+void MessageLog::_run()
+{
+	while (true) {
+		uint64 request;
+		bool stop;
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			_wake.wait_for(lock, std::chrono::milliseconds(_settings.flushInterval), [this]() { return _stop || _flushRequest > _flushDone; });
+			request = _flushRequest;
+			stop = _stop;
+		}
+
+		_drain(stop);
+
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_flushDone = request;
+		}
+		_flushed.notify_all();
+
+		if (stop)
+			return;
+	}
+}
+
+void MessageLog::_drain(bool final)
+{
+	auto report = [this](const MessageRecord &about, String message) {
+		MessageRecord r;
+		r.severity = _settings.reportSeverity;
+		r.timestamp = time(0);
+		r.threadID = about.threadID;
+		r.clazzID = about.clazzID;
+		r.chipID = about.chipID;
+		r.message = std::move(message);
+		_batch.push_back(std::move(r));
+	};
+
+	List<std::shared_ptr<Ring>> rings;
+	{
+		std::lock_guard<std::mutex> lock(_ringsLock);
+		rings = _rings;
+	}
+
+	for (const auto &ring : rings) {
+		uint64 h = ring->head.load(std::memory_order_relaxed);
+		uint64 t = ring->tail.load(std::memory_order_acquire);
+		for (; h < t; h++) {
+			Ring::Slot &slot = ring->slots[h & ring->mask];
+			if (slot.previousRepeats > 0 && ring->hasTaken)
+				report(ring->taken, MTEXT("Last message repeated ") + toString(slot.previousRepeats) + MTEXT(" times."));
+			ring->hasTaken = true;
+			ring->takenSeq = (uint32)h;
+			ring->taken.severity = slot.record.severity;
+			ring->taken.threadID = slot.record.threadID;
+			ring->taken.clazzID = slot.record.clazzID;
+			ring->taken.chipID = slot.record.chipID;
+			_batch.push_back(std::move(slot.record));
+		}
+		ring->head.store(t, std::memory_order_release);
+
+		// Repeats of the last record taken. If the counter is tagged with a later record, it is collected with that one.
+		uint64 v = ring->repeats.load(std::memory_order_acquire);
+		while (ring->hasTaken && (uint32)v > 0 && (uint32)(v >> 32) == ring->takenSeq) {
+			if (ring->repeats.compare_exchange_weak(v, v & 0xFFFFFFFF00000000ull, std::memory_order_acq_rel)) {
+				report(ring->taken, MTEXT("Last message repeated ") + toString((uint32)v) + MTEXT(" times."));
+				break;
+			}
+		}
+
+		uint32 d = ring->droppedReport.exchange(0, std::memory_order_relaxed);
+		if (d > 0) {
+			MessageRecord about;
+			about.threadID = ring->threadID;
+			report(about, toString(d) + MTEXT(" messages dropped because the message queue of thread ") + toString(ring->threadID) + MTEXT(" was full."));
+		}
+	}
+
+	// Report messages suppressed by the rate limit once every second.
+	int64 now = Clock::GetTime_ns();
+	if (final || now - _rateLimit->lastReport >= Clock::TICKS_PER_SECOND) {
+		for (RateLimit::Counter &c : _rateLimit->counters) {
+			if (c.chipID.load(std::memory_order_acquire) == 0)
+				continue;
+			uint32 suppressed = c.suppressed.exchange(0, std::memory_order_relaxed);
+			if (suppressed > 0) {
+				MessageRecord about;
+				about.clazzID = c.clazzID.load(std::memory_order_relaxed);
+				about.chipID = c.chipID.load(std::memory_order_relaxed);
+				report(about, toString(suppressed) + MTEXT(" messages suppressed because the chip posted more than ") + toString(_settings.rateLimit) + MTEXT(" messages per second."));
+			}
+		}
+		_rateLimit->lastReport = now;
+	}
+
+	if (!_batch.empty()) {
+		if (_sink)
+			_sink(_batch.data(), _batch.size());
+		_batch.clear();
+	}
+
+	// Forget rings of threads that has exited, when there is nothing left in them.
+	std::lock_guard<std::mutex> lock(_ringsLock);
+	for (size_t i = 0; i < _rings.size();) {
+		Ring *r = _rings[i].get();
+		if (r->orphaned && r->head.load() == r->tail.load() && (uint32)r->repeats.load() == 0 && r->droppedReport.load() == 0) {
+			_posted += r->posted;
+			_folded += r->folded;
+			_dropped += r->dropped;
+			_rings.erase(_rings.begin() + i);
+		}
+		else
+			i++;
+	}
+}
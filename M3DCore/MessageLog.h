@@ -0,0 +1,142 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "MTypes.h"
+#include "MString.h"
+#include "Containers.h"
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <ctime>
+
+namespace m3d
+{
+
+// A message as posted by a thread. Formatting of timestamps etc. is left to the sink.
+struct MessageRecord
+{
+	uint32 severity = 0;
+	time_t timestamp = 0;
+	uint32 threadID = 0;
+	uint32 clazzID = 0;
+	uint32 chipID = 0;
+	String message;
+};
+
+// Settings for MessageLog.
+struct MessageLogSettings
+{
+	// Records per thread. Rounded up to a power of 2.
+	uint32 ringCapacity = 1024;
+	// Max time in milliseconds from a message is posted until it reaches the sink.
+	uint32 flushInterval = 10;
+	// Messages per chip per second. 0 for no limit.
+	uint32 rateLimit = 100;
+	// Fold repeated identical messages.
+	bool deduplicate = true;
+	// Messages of this severity or higher wakes the writer immediately.
+	uint32 wakeSeverity = 4;
+	// Severity of the records reporting folded, suppressed and dropped messages.
+	uint32 reportSeverity = 3;
+};
+
+// Asynchronous message log. Post() takes no locks: Each thread has its own fixed size ring buffer,
+// and a background thread drains all rings and hands the records to the sink in batches.
+// - Identical messages posted repeatedly by the same thread for the same chip are folded into one,
+//   followed by a "repeated n times" record.
+// - Messages regarding a chip are limited to rateLimit per second, counted over all threads. The rest are
+//   rejected by Post() before taking a ring slot, and counted and reported.
+// - When a ring is full the message is dropped and counted, so memory use is bounded by ringCapacity per thread.
+class M3DCORE_API MessageLog
+{
+public:
+	// Called on the writer thread only.
+	typedef std::function<void(const MessageRecord *records, size_t count)> Sink;
+
+	typedef MessageLogSettings Settings;
+
+	MessageLog(Sink sink, const Settings &settings = Settings());
+	// Delivers everything posted, then stops the writer thread.
+	~MessageLog();
+
+	// Posts a message. THREAD SAFE!
+	void Post(uint32 severity, String message, uint32 clazzID = 0, uint32 chipID = 0);
+	// Blocks until messages posted before the call has reached the sink. Returns immediately if called from the sink.
+	void Flush();
+
+	const Settings &GetSettings() const { return _settings; }
+
+	// Number of messages posted, including those folded, suppressed or dropped.
+	uint64 GetPostedCount() const;
+	// Number of repeated messages folded into the previous one.
+	uint64 GetFoldedCount() const;
+	// Number of messages suppressed by the rate limit.
+	uint64 GetSuppressedCount() const { return _suppressed; }
+	// Number of messages dropped because the ring of the posting thread was full.
+	uint64 GetDroppedCount() const;
+
+private:
+	struct Ring;
+	struct RateLimit;
+
+	// Unique id of this log, as thread local ring lookup can not rely on the address.
+	const uint64 _id;
+	const Settings _settings;
+	Sink _sink;
+
+	mutable std::mutex _ringsLock;
+	List<std::shared_ptr<Ring>> _rings;
+
+	std::mutex _lock;
+	std::condition_variable _wake;
+	std::condition_variable _flushed;
+	uint64 _flushRequest = 0;
+	uint64 _flushDone = 0;
+	bool _stop = false;
+	std::thread _writer;
+
+	// Counts from rings that has been removed. The rest is counted per ring.
+	uint64 _posted = 0;
+	uint64 _folded = 0;
+	uint64 _dropped = 0;
+	std::atomic<uint64> _suppressed;
+
+	// Shared by the posting threads.
+	std::unique_ptr<RateLimit> _rateLimit;
+
+	// Owned by the writer thread.
+	List<MessageRecord> _batch;
+
+	Ring *_getRing();
+	void _run();
+	void _drain(bool final);
+};
+
+}
@@ -23,7 +23,9 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include <winapifamily.h>
+#endif
 
 namespace m3d
 {
@@ -77,9 +79,13 @@ enum _PlatformFamily
 // WINDESKTOP will be defined for desktop applications.
 // WINPHONE8 will be defined for WP8 apps.
 // WINSTOREAPP will be defined for store apps.
+// Other platforms are only used by the portable standalone targets, and have PLATFORM_undefined.
 
 
-#if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
+#if !defined(_WIN32)
+	#define PLATFORM_FAMILY PLATFORM_undefined
+	#define PLATFORM PLATFORM_undefined
+#elif WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
 	#define PLATFORM_FAMILY PLATFORM_WINDESKTOP
 	#define WINDESKTOP
 	#ifdef _WIN64
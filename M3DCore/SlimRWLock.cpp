@@ -27,6 +27,8 @@
 using namespace m3d;
 
 
+#ifdef _WIN32
+
 SlimRWLock::SlimRWLock()
 {
 	InitializeSRWLock(&_lock);
@@ -74,4 +76,56 @@ SlimWLockBlock::SlimWLockBlock(SlimRWLock &lock) : _lock(&lock._lock)
 SlimWLockBlock::~SlimWLockBlock()
 {
 	ReleaseSRWLockExclusive(_lock);
-}
\ No newline at end of file
+}
+
+#else
+
+SlimRWLock::SlimRWLock()
+{
+}
+
+SlimRWLock::~SlimRWLock()
+{
+}
+
+void SlimRWLock::AquireReadLock()
+{
+	_lock.lock_shared();
+}
+
+void SlimRWLock::ReleaseReadLock()
+{
+	_lock.unlock_shared();
+}
+
+void SlimRWLock::AquireWriteLock()
+{
+	_lock.lock();
+}
+
+void SlimRWLock::ReleaseWriteLock()
+{
+	_lock.unlock();
+}
+
+SlimRLockBlock::SlimRLockBlock(SlimRWLock &lock) : _lock(&lock._lock)
+{
+	_lock->lock_shared();
+}
+
+SlimRLockBlock::~SlimRLockBlock()
+{
+	_lock->unlock_shared();
+}
+
+SlimWLockBlock::SlimWLockBlock(SlimRWLock &lock) : _lock(&lock._lock)
+{
+	_lock->lock();
+}
+
+SlimWLockBlock::~SlimWLockBlock()
+{
+	_lock->unlock();
+}
+
+#endif
@@ -24,7 +24,11 @@
 #pragma once
 
 #include "Exports.h"
+#ifdef _WIN32
 #include <Synchapi.h>
+#else
+#include <shared_mutex>
+#endif
 
 
 namespace m3d
@@ -46,7 +50,11 @@ public:
 	void ReleaseWriteLock();
 
 private:
+#ifdef _WIN32
 	SRWLOCK _lock;
+#else
+	std::shared_mutex _lock;
+#endif
 };
 
 class M3DCORE_API SlimRLockBlock
@@ -56,7 +64,11 @@ public:
 	~SlimRLockBlock();
 
 private:
+#ifdef _WIN32
 	PSRWLOCK _lock;
+#else
+	std::shared_mutex *_lock;
+#endif
 };
 
 class M3DCORE_API SlimWLockBlock
@@ -66,7 +78,11 @@ public:
 	~SlimWLockBlock();
 
 private:
+#ifdef _WIN32
 	PSRWLOCK _lock;
+#else
+	std::shared_mutex *_lock;
+#endif
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,187 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "MTypes.h"
+#include "Allocator.h"
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <cassert>
+
+namespace m3d
+{
+
+// A List with room for N elements inside the object itself. Small lists need no heap allocation, and their
+// elements are found next to their owner. Grows onto the heap like a List when it gets bigger, and stays there.
+// Only for trivially copyable types, as elements are moved with memcpy. Iterators are plain pointers.
+template<typename T, uint32 N>
+class SmallList
+{
+	static_assert(std::is_trivially_copyable<T>::value, "SmallList only supports trivially copyable types.");
+	static_assert(N > 0, "SmallList needs an inline capacity.");
+public:
+	typedef T value_type;
+	typedef T *iterator;
+	typedef const T *const_iterator;
+	typedef size_t size_type;
+
+	static const uint32 INLINE_CAPACITY = N;
+
+	SmallList() : _data(_inline()), _size(0), _capacity(N) {}
+	SmallList(const SmallList &rhs) : SmallList() { _assign(rhs); }
+	SmallList(SmallList &&rhs) noexcept : SmallList() { _move(rhs); }
+	~SmallList() { _free(); }
+
+	SmallList &operator=(const SmallList &rhs) { if (this != &rhs) _assign(rhs); return *this; }
+	SmallList &operator=(SmallList &&rhs) noexcept { if (this != &rhs) { _free(); _data = _inline(); _capacity = N; _move(rhs); } return *this; }
+
+	size_t size() const { return _size; }
+	size_t capacity() const { return _capacity; }
+	bool empty() const { return _size == 0; }
+	// True while the elements are stored inside the object.
+	bool is_inline() const { return _data == _inline(); }
+
+	T &operator[](size_t i) { assert(i < _size); return _data[i]; }
+	const T &operator[](size_t i) const { assert(i < _size); return _data[i]; }
+	T &front() { assert(_size > 0); return _data[0]; }
+	const T &front() const { assert(_size > 0); return _data[0]; }
+	T &back() { assert(_size > 0); return _data[_size - 1]; }
+	const T &back() const { assert(_size > 0); return _data[_size - 1]; }
+	T *data() { return _data; }
+	const T *data() const { return _data; }
+
+	iterator begin() { return _data; }
+	iterator end() { return _data + _size; }
+	const_iterator begin() const { return _data; }
+	const_iterator end() const { return _data + _size; }
+
+	void clear() { _size = 0; }
+
+	void reserve(size_t n)
+	{
+		if (n > _capacity)
+			_grow(n);
+	}
+
+	void resize(size_t n) { resize(n, T()); }
+	void resize(size_t n, const T &v)
+	{
+		if (n > _size) {
+			T t = v; // v may be in our storage.
+			reserve(n);
+			for (size_t i = _size; i < n; i++)
+				new (&_data[i]) T(t);
+		}
+		_size = (uint32)n;
+	}
+
+	void push_back(const T &v)
+	{
+		if (_size == _capacity) {
+			T t = v; // v may be in our storage.
+			_grow(_size + 1);
+			_data[_size++] = t;
+		}
+		else
+			_data[_size++] = v;
+	}
+
+	void pop_back() { assert(_size > 0); _size--; }
+
+	iterator insert(const_iterator pos, const T &v)
+	{
+		size_t i = pos - _data;
+		assert(i <= _size);
+		T t = v; // v may be in our storage.
+		if (_size == _capacity)
+			_grow(_size + 1);
+		std::memmove(_data + i + 1, _data + i, (_size - i) * sizeof(T));
+		_data[i] = t;
+		_size++;
+		return _data + i;
+	}
+
+	iterator erase(const_iterator pos)
+	{
+		size_t i = pos - _data;
+		assert(i < _size);
+		std::memmove(_data + i, _data + i + 1, (_size - i - 1) * sizeof(T));
+		_size--;
+		return _data + i;
+	}
+
+private:
+	T *_data;
+	uint32 _size;
+	uint32 _capacity;
+	alignas(T) unsigned char _buffer[N * sizeof(T)];
+
+	T *_inline() { return reinterpret_cast<T*>(_buffer); }
+	const T *_inline() const { return reinterpret_cast<const T*>(_buffer); }
+
+	void _grow(size_t n)
+	{
+		size_t c = std::max(n, (size_t)_capacity * 2);
+		T *d = Allocator<T>().allocate(c);
+		std::memcpy(d, _data, _size * sizeof(T));
+		_free();
+		_data = d;
+		_capacity = (uint32)c;
+	}
+
+	void _free()
+	{
+		if (!is_inline())
+			Allocator<T>().deallocate(_data, _capacity);
+	}
+
+	void _assign(const SmallList &rhs)
+	{
+		_size = 0;
+		reserve(rhs._size);
+		std::memcpy(_data, rhs._data, rhs._size * sizeof(T));
+		_size = rhs._size;
+	}
+
+	void _move(SmallList &rhs)
+	{
+		if (rhs.is_inline()) {
+			std::memcpy(_data, rhs._data, rhs._size * sizeof(T));
+			_size = rhs._size;
+		}
+		else {
+			_data = rhs._data;
+			_size = rhs._size;
+			_capacity = rhs._capacity;
+			rhs._data = rhs._inline();
+			rhs._capacity = N;
+		}
+		rhs._size = 0;
+	}
+};
+
+}
@@ -0,0 +1,162 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <exception>
+
+using namespace m3d;
+
+
+ThreadPool::ThreadPool(uint32 threadCount) : _running(0), _stop(false)
+{
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	for (uint32 i = 0; i < threadCount; i++)
+		_threads.push_back(std::thread(&ThreadPool::_worker, this));
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_stop = true;
+	}
+	_taskAvailable.notify_all();
+	for (std::thread &t : _threads)
+		t.join();
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> task)
+{
+	std::packaged_task<void()> pt(std::move(task));
+	std::future<void> f = pt.get_future();
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		_tasks.push_back(std::move(pt));
+	}
+	_taskAvailable.notify_one();
+	return f;
+}
+
+void ThreadPool::Wait()
+{
+	std::unique_lock<std::mutex> lock(_lock);
+	_idle.wait(lock, [this]() { return _tasks.empty() && _running == 0; });
+}
+
+void ThreadPool::ParallelFor(uint32 count, const std::function<void(uint32)> &fn, uint32 maxThreads)
+{
+	// Shared with the helper tasks, which may start after this call has returned. They must then not touch fn.
+	struct State
+	{
+		const std::function<void(uint32)> *fn;
+		uint32 count;
+		std::atomic<uint32> next;
+		std::atomic<uint32> done;
+		std::atomic<bool> failed;
+		std::exception_ptr exception;
+		std::mutex lock;
+		std::condition_variable allDone;
+	};
+
+	uint32 helpers = std::min(GetThreadCount(), count > 0 ? count - 1 : 0);
+	if (maxThreads > 0)
+		helpers = std::min(helpers, maxThreads - 1);
+	if (helpers == 0) {
+		for (uint32 i = 0; i < count; i++)
+			fn(i);
+		return;
+	}
+
+	auto state = std::make_shared<State>();
+	state->fn = &fn;
+	state->count = count;
+	state->next = 0;
+	state->done = 0;
+	state->failed = false;
+
+	auto run = [](State &s) {
+		for (uint32 i = s.next++; i < s.count; i = s.next++) {
+			if (!s.failed) {
+				try {
+					(*s.fn)(i);
+				}
+				catch (...) {
+					std::lock_guard<std::mutex> lock(s.lock);
+					if (!s.exception)
+						s.exception = std::current_exception();
+					s.failed = true;
+				}
+			}
+			if (++s.done == s.count) {
+				std::lock_guard<std::mutex> lock(s.lock);
+				s.allDone.notify_all();
+			}
+		}
+	};
+
+	for (uint32 i = 0; i < helpers; i++)
+		Submit([state, run]() { run(*state); });
+	run(*state);
+
+	// Only items already taken by the helpers are waited for.
+	std::unique_lock<std::mutex> lock(state->lock);
+	state->allDone.wait(lock, [&]() { return state->done == count; });
+	if (state->exception)
+		std::rethrow_exception(state->exception);
+}
+
+ThreadPool &ThreadPool::GetShared()
+{
+	// Never destroyed, as the threads must not be joined while the modules are unloaded at exit.
+	static ThreadPool *pool = new ThreadPool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+	return *pool;
+}
+
+void ThreadPool::_worker()
+{
+	while (true) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_lock);
+			_taskAvailable.wait(lock, [this]() { return _stop || !_tasks.empty(); });
+			if (_tasks.empty())
+				return; // Stopping, and nothing left to do.
+			task = std::move(_tasks.front());
+			_tasks.pop_front();
+			_running++;
+		}
+		task(); // Exceptions are stored in the future.
+		{
+			std::lock_guard<std::mutex> lock(_lock);
+			_running--;
+			if (_tasks.empty() && _running == 0)
+				_idle.notify_all();
+		}
+	}
+}
@@ -0,0 +1,78 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "MTypes.h"
+#include "Containers.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <deque>
+
+namespace m3d
+{
+
+// A fixed set of worker threads running queued tasks in submission order.
+// Based on std::thread, so unlike PPL it can be used in code that must build on other platforms.
+class M3DCORE_API ThreadPool
+{
+public:
+	// threadCount 0 uses all hardware threads.
+	ThreadPool(uint32 threadCount = 0);
+	// Waits for all queued tasks before stopping the threads.
+	~ThreadPool();
+
+	uint32 GetThreadCount() const { return (uint32)_threads.size(); }
+
+	// Queues a task. The future is ready when the task has run, and rethrows anything it throws.
+	std::future<void> Submit(std::function<void()> task);
+	// Waits until all submitted tasks are done.
+	void Wait();
+	// Runs fn(i) for all i in [0, count) on the pool threads and the calling thread, and returns when all are done.
+	// Items are handed out one at a time, so uneven work is balanced. At most maxThreads threads, including the calling
+	// thread, are used (0 for no limit). The calling thread never waits for tasks queued behind other work, so this can
+	// also be used from a task running on the pool. The first exception thrown by fn is rethrown.
+	void ParallelFor(uint32 count, const std::function<void(uint32)> &fn, uint32 maxThreads = 0);
+
+	// A pool for short parallel work done by the main thread, like ParallelFor() every frame. It has one thread less than
+	// the hardware, as the calling thread takes part in ParallelFor(). Created on first use.
+	static ThreadPool &GetShared();
+
+private:
+	List<std::thread> _threads;
+	std::deque<std::packaged_task<void()>> _tasks;
+	std::mutex _lock;
+	std::condition_variable _taskAvailable;
+	std::condition_variable _idle;
+	uint32 _running;
+	bool _stop;
+
+	void _worker();
+};
+
+}
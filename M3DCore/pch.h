@@ -23,6 +23,7 @@
 
 #pragma once
 
+#ifdef _WIN32
 #include "targetver.h"
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
@@ -30,6 +31,7 @@
 #define NOMINMAX
 
 #include <windows.h>
+#endif
 
 // TODO: reference additional headers your program requires here
 
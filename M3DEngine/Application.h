@@ -56,8 +56,10 @@ public:
 	virtual Path GetApplicationFile() const = 0;
 	// Ask the application to quit.
 	virtual void Quit() = 0;
-	// Called by the engine every time a new message is added.
+	// Called by the engine every time a new message is added. Called from the message writer thread.
 	virtual void MessagedAdded(const ApplicationMessage &msg) = 0;
+	// Called by the engine with the messages added since last time. Called from the message writer thread.
+	virtual void MessagesAdded(const ApplicationMessage *msgs, size_t count) { for (size_t i = 0; i < count; i++) MessagedAdded(msgs[i]); }
 	// Called by the engine when a message regarding the given chip is added. The message remain valid until removed.
 	virtual void ChipMessageAdded(Chip *chip, const ChipMessage &msg) = 0;
 	// Called by the engine when a message regarding the given chip is removed.
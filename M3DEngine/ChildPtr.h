@@ -25,6 +25,7 @@
 
 #include "FunctionStack.h"
 #include "Function.h"
+#include "Profiler.h"
 
 namespace m3d
 {
@@ -88,11 +89,14 @@ public:
 		T* const t;
 		//const Chip *const oldChildProvider;
 		const uint32 oldstackptr;
+		const bool profiled;
 
-		Call(T* const t/*, const Chip *const childProvider*/, uint32 stackptr) : t(t)/*, oldChildProvider(t->ReplaceChildProvider(childProvider))*/, oldstackptr(functionStack.SetStackPtr(stackptr))
+		Call(T* const t/*, const Chip *const childProvider*/, uint32 stackptr) : t(t)/*, oldChildProvider(t->ReplaceChildProvider(childProvider))*/, oldstackptr(functionStack.SetStackPtr(stackptr)), profiled(profiler.IsRecording())
 		{
 			// Enter function call! Called right before ANY function call on child (eg 'someChild->CallChip()') is executed. 
 			// Adjust the function stack frame.
+			if (profiled)
+				profiler.BeginChip(t, ProfilerCategory::CALL);
 		}
 
 		~Call()
@@ -101,6 +105,8 @@ public:
 			// Adjust the stack back!
 			//t->SetChildProvider(oldChildProvider);
 			//functionStack.SetStackPtr(oldstackptr);
+			if (profiled)
+				profiler.End();
 			functionStack.ResetStackPtr(oldstackptr);
 		}
 
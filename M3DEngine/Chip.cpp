@@ -54,7 +54,7 @@ std::atomic<ChipID> ids = 0;
 
 #pragma warning( push )
 #pragma warning( disable : 4355 ) // this in parameter list warning.
-Chip::Chip() : _id(++ids), _clazz(nullptr), _owner(this), _editorData(nullptr), _typeIndex(InvalidChipTypeIndex), _lastHit(0), _function(nullptr), _childProvider(this), _updateStamp(0), _messages(nullptr)
+Chip::Chip() : _id(++ids), _clazz(nullptr), _owner(this), _editorData(nullptr), _typeIndex(InvalidChipTypeIndex), _lastHit(0), _function(nullptr), _childProvider(this), _overridesProvideChildren(false), _updateStamp(0), _inputStamp(InvalidUpdateStamp), _inputStampAt(InvalidUpdateStamp), _inputStampVisiting(false), _messages(nullptr), Refresh(this)
 {
 	GenerateGuid(_globalID);
 }
@@ -119,6 +119,7 @@ bool Chip::_setChild(Chip *child, uint32 index, uint32 subIndex, bool insert)
 			cc->connections.resize(subIndex + 1);
 		cc->connections[subIndex] = child;
 	}
+	SetUpdateStamp(); // Our inputs changed.
 	return true;
 }
 
@@ -145,6 +146,7 @@ void Chip::_clearConnection(uint32 index)
 	if (child) {
 		mmdelete(child);
 		_children[index] = 0;
+		SetUpdateStamp();
 	}
 
 	for (size_t i = 0; i < _connectionClones.size(); i++)
@@ -189,6 +191,44 @@ void Chip::RemoveConnectionClone(Chip *chip)
 }
 
 
+UpdateStamp Chip::GetInputStamp()
+{
+	if (_inputStampAt == GetLastUpdateStamp())
+		return _inputStamp; // No chip has been updated since last time.
+	if (_inputStampVisiting)
+		return InvalidUpdateStamp; // Cyclic dependency. Can not be tracked.
+
+	UpdateStamp s = _updateStamp;
+	_inputStampVisiting = true;
+	const ChildConnectionList &ccl = GetChildren();
+	for (uint32 i = 0; i < ccl.size() && s != InvalidUpdateStamp; i++) {
+		const ChildConnection *cc = ccl[i];
+		if (!cc)
+			continue;
+		for (uint32 j = 0; j < cc->connections.size(); j++) {
+			Chip *c = cc->connections[j].chip;
+			if (c && c->AsShortcut())
+				c = c->AsShortcut()->GetOriginal();
+			if (!c)
+				continue;
+			UpdateStamp t = InvalidUpdateStamp;
+			if (c->IsUpdateStampTracked() || c->GetRefreshManager().GetRefreshMode() == RefreshManager::RefreshMode::OnInputChange)
+				t = c->GetInputStamp();
+			if (t == InvalidUpdateStamp) {
+				s = InvalidUpdateStamp;
+				break;
+			}
+			s = std::max(s, t);
+		}
+	}
+	_inputStampVisiting = false;
+
+	// Note: Results found while inside a cycle are conservative, so it is safe to cache them.
+	_inputStamp = s;
+	_inputStampAt = GetLastUpdateStamp();
+	return s;
+}
+
 ChipTypeIndex Chip::GetChipTypeIndex() const 
 { 
 	if (_typeIndex == -1)
@@ -229,6 +269,7 @@ bool Chip::MoveChild(uint32 index, uint32 fromSubIndex, uint32 toSubIndex)
 		cc->connections.push_back(ss);
 	else
 		cc->connections.insert(cc->connections.begin() + toSubIndex, ss);
+	SetUpdateStamp();
 	return true;
 }
 
@@ -237,11 +278,6 @@ void Chip::ClearConnections(uint32 fromIndex)
 	return _clearConnections(fromIndex);
 }
 
-uint32 Chip::GetConnectionCount() const 
-{ 
-	return (uint32)GetChildren().size(); 
-}
-
 uint32 Chip::GetSubConnectionCount(uint32 index) const 
 { 
 	const ChildConnectionList &ccl = GetChildren();
@@ -283,14 +319,26 @@ ChipChildPtr Chip::GetChild(uint32 index, uint32 subIndex) const
 			sc.lastHit = engine->GetFrameTime();
 			if (sc.chip) {
 				sc.chip->_lastHit = sc.lastHit;
+				if (profiler.IsRecording()) {
+					profiler.BeginChip(sc.chip, ProfilerCategory::GET);
+					ChipChildPtr ch = sc.chip->GetChip();
+					profiler.End();
+					return ch;
+				}
 				return sc.chip->GetChip();
 			}
 		}
-		else {
+		else if (!cc->connections.empty()) {
 			SubConnection& sc = cc->connections[0];
 			sc.lastHit = engine->GetFrameTime();
 			if (sc.chip) {
 				sc.chip->_lastHit = sc.lastHit;
+				if (profiler.IsRecording()) {
+					profiler.BeginChip(sc.chip, ProfilerCategory::GET);
+					ChipChildPtr ch = sc.chip->GetMultiConnectionChip(subIndex);
+					profiler.End();
+					return ch;
+				}
 				return sc.chip->GetMultiConnectionChip(subIndex);
 			}
 		}
@@ -501,6 +549,17 @@ List<Shortcut*> Chip::GetShortcuts() const
 	return r;
 }
 
+uint64 Chip::GetMemoryUsage() const
+{
+	uint64 r = sizeof(Chip) + _name.capacity() + (_children.is_inline() ? 0 : _children.capacity() * sizeof(ChildConnection*)) + _connectionClones.capacity() * sizeof(Chip*);
+	for (const ChildConnection *c : _children)
+		if (c)
+			r += sizeof(ChildConnection) + (c->connections.is_inline() ? 0 : c->connections.capacity() * sizeof(SubConnection));
+	if (_messages)
+		r += sizeof(ChipMessageList) + _messages->capacity() * sizeof(ChipMessage);
+	return r;
+}
+
 void Chip::SetClass(Class* clazz)
 { 
 	_clazz = clazz; 
@@ -31,6 +31,7 @@
 #include "M3DCore/DestructionObserver.h"
 #include "M3DCore/GUIDUtil.h"
 #include "M3DCore/Path.h"
+#include "M3DCore/MemoryTracker.h"
 
 
 
@@ -43,6 +44,7 @@ static const Guid CHIP_GUID = { 0x11111111, 0x1111, 0x1111, { 0x11, 0x11, 0x11,
 class M3DENGINE_API Chip : public DestructionObservable
 {
 	template<typename T> friend void mmdelete(const T*);
+	friend class ChipManager;
 public:
 	// These are some common messages.
 	CHIPMSG(NoInstanceException, WARN, MTEXT("No instance set!"))
@@ -90,6 +92,9 @@ private:
 	// It defaults to "this", but when the chip is used in eg a ClassInstance, it is
 	// another chip (the InstanceData) that will provide the children we should use. 
 	const Chip *_childProvider;
+	// True if ProvideChildren() is overridden. If not, GetChildren() reads the provider's _children directly.
+	// Set by the ChipManager from OverridesProvideChildren() when the chip is created.
+	bool _overridesProvideChildren;
 	// Timestamp of the last time our GetChip() was called. It is used to provide
 	// visual feedback of chip activity in the editor.
 	int32 _lastHit;
@@ -97,6 +102,11 @@ private:
 	Function *_function;
 	// A unique value that a derived chip can set when it is updated. This way, it's easy to see when a chip is updated.
 	UpdateStamp _updateStamp;
+	// Cached result of GetInputStamp(), valid as long as GetLastUpdateStamp() equals _inputStampAt.
+	UpdateStamp _inputStamp;
+	UpdateStamp _inputStampAt;
+	// Set while GetInputStamp() is visiting our children. Used to detect cycles.
+	bool _inputStampVisiting;
 	// List of chips (ie ShellChip) supposed to have exact the same connections as us. Any connection-modifications are relied to these.
 	ChipList _connectionClones;
 	// Chip Messages. NOTE: Will probably contain only one or two (or very few!) messages. Preferring list over map for searching! (mutable to be able to add messages from const func.)
@@ -121,6 +131,12 @@ protected:
 	// Normally this is our _children, but chips like the TemplateChip
 	// overrides it to get the list from its template.
 	virtual const ChildConnectionList &ProvideChildren() const { return _children; }
+	// Defined for all chips using the CHIPDESC_DECL macro. True if the chip, or one of its base classes, overrides ProvideChildren().
+	// The ChipManager asks when creating the chip, so that GetChildren() does not have to call ProvideChildren() for all others.
+	virtual bool OverridesProvideChildren() const { return false; }
+	// Used by CHIPDESC_DECL: Is the given ProvideChildren() declared by another class than Chip?
+	template<typename C>
+	static constexpr bool IsProvideChildrenOverride(const ChildConnectionList &(C::*)() const) { return !std::is_same<C, Chip>::value; }
 
 	virtual ~Chip();
 	virtual void OnRelease() {}
@@ -192,6 +208,11 @@ public:
 	virtual bool CopyChip(Chip *chip);
 	virtual bool LoadChip(DocumentLoader &loader) { return true; }
 	virtual bool SaveChip(DocumentSaver &saver) const { return true; }
+	// Called on instance data when its class instance is released to the instance pool of its class (see InstancePoolPolicy).
+	// Must put the chip back in the state CopyChip(chip) gives a new chip, chip being the template, and free anything created
+	// since (like physics actors or GPU resources). Returns false if not supported, which is the default, and the instance
+	// is destroyed instead.
+	virtual bool OnInstanceRecycled(Chip *chip) { return false; }
 
 	// Message system.
 	virtual bool HasMessages() const { return _messages != nullptr; }
@@ -206,15 +227,22 @@ public:
 	// Get/Set the update-stamp.
 	UpdateStamp GetUpdateStamp() const { return _updateStamp; }
 	UpdateStamp SetUpdateStamp() { return _updateStamp = GenerateUpdateStamp(); }
+	// Returns true if SetUpdateStamp() is called every time our data changes, so that our output is given by our update stamp and our children.
+	// Chips returning false are considered to change every time they are read by a chip using RefreshMode::OnInputChange.
+	virtual bool IsUpdateStampTracked() const { return false; }
+	// Returns the highest update stamp of us and all chips we depend on through our child connections, or
+	// InvalidUpdateStamp if any of them can not be tracked. Chips using RefreshMode::OnInputChange are tracked through their children.
+	UpdateStamp GetInputStamp();
 
 	virtual void OnDestroyDevice() {}
 	virtual void OnReleasingBackBuffer(RenderWindow *rw) {}
 
 
-	virtual const ChildConnectionList &GetChildren() const { return _childProvider->ProvideChildren(); }
+	// Child access is not virtual. It is on the hot path of every chip calling its children.
+	inline const ChildConnectionList &GetChildren() const { return _childProvider->_overridesProvideChildren ? _childProvider->ProvideChildren() : _childProvider->_children; }
 	inline const Chip *GetChildProvider() const { return _childProvider; }
-	inline void SetChildProvider(const Chip *chip) { _childProvider = chip; }
-	inline const Chip *ReplaceChildProvider(const Chip *chip) { const Chip *c = _childProvider; _childProvider = chip; return c; }
+	inline void SetChildProvider(const Chip *chip) { _childProvider = chip; SetUpdateStamp(); }
+	inline const Chip *ReplaceChildProvider(const Chip *chip) { const Chip *c = _childProvider; _childProvider = chip; SetUpdateStamp(); return c; }
 
 	// Removes all child connections in our _children list.
 	// It does NOT use the ChildConnectionList returned by our _childProvider!
@@ -229,10 +257,10 @@ public:
 	virtual bool InsertChild(Chip *child, uint32 index, uint32 subIndex);
 	virtual bool MoveChild(uint32 index, uint32 fromSubIndex, uint32 toSubIndex);
 	virtual void RemoveChild(Chip *child);
-	virtual ChipChildPtr GetChild(uint32 index, uint32 subIndex = 0) const;
-	virtual Chip *GetRawChild(uint32 index, uint32 subIndex = 0) const;
-	virtual uint32 GetConnectionCount() const;
-	virtual uint32 GetSubConnectionCount(uint32 index) const;
+	ChipChildPtr GetChild(uint32 index, uint32 subIndex = 0) const;
+	Chip *GetRawChild(uint32 index, uint32 subIndex = 0) const;
+	inline uint32 GetConnectionCount() const { return (uint32)GetChildren().size(); }
+	uint32 GetSubConnectionCount(uint32 index) const;
 	virtual void RemoveEmptyConnections();
 
 	void AddConnectionClone(Chip *chip);
@@ -264,6 +292,13 @@ public:
 
 	virtual void AddDependencies(ProjectDependencies &deps) {}
 
+	// Memory accounting. See MemoryTracker.
+	// Returns the approximate number of bytes of host memory owned by this chip, including the chip itself.
+	// Chips holding large amounts of data should add it to the value returned by their base class.
+	virtual uint64 GetMemoryUsage() const;
+	// Returns the approximate number of bytes owned by this chip in the given subsystem, eg GPU memory for textures.
+	virtual uint64 GetSubsystemMemoryUsage(MemorySubsystem subsystem) const { return 0; }
+
 	// Hidden chips (aka global chips) will be called at the start of each frame. 
 	// This is a single event that later may be part of a more advance event system.
 	virtual void OnNewFrame() {}
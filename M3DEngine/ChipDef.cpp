@@ -26,6 +26,8 @@
 #include "Engine.h"
 #include "FunctionStack.h"
 #include "FunctionStackRecord.h"
+#include "Chip.h"
+#include "Profiler.h"
 
 using namespace m3d;
 
@@ -45,10 +47,23 @@ Chip *m3d::ChipExceptionScope::currentChip = nullptr;
 // SOLUTION: I've created the RefreshT struct to overcome this using RAII.
 //           Not as beautiful maybe, but it works! And it is only neccessary where a function update a chip variable!
 
+// OnInputChange does not depend on frames or function calls. The chip is refreshed if the
+// combined update stamp of itself and its inputs has changed since the last refresh.
+// If any input can not be tracked, we always refresh. See Chip::GetInputStamp().
 RefreshManager::operator bool()
 {
 	if (_rm == RefreshManager::RefreshMode::Always)
 		return true;
+
+	if (_rm == RefreshManager::RefreshMode::OnInputChange) {
+		UpdateStamp s = _chip ? _chip->GetInputStamp() : InvalidUpdateStamp;
+		bool hit = s != InvalidUpdateStamp && s == _lastInput;
+		profiler.CountRefresh(hit);
+		if (hit)
+			return false;
+		_lastInput = s;
+		return true;
+	}
 //	if (_rm == NEVER)
 //		return false;
 
@@ -71,8 +86,17 @@ RefreshManager::operator bool()
 	return false;
 };
 
+void RefreshManager::SetRefreshMode(RefreshMode rm)
+{
+	_rm = rm;
+	if (_chip)
+		_chip->SetUpdateStamp(); // Chips depending on us must know that we might behave differently.
+}
+
 static UpdateStamp __us = 0;
 
 m3d::UpdateStamp m3d::GenerateUpdateStamp() { return ++__us; }
 
+m3d::UpdateStamp m3d::GetLastUpdateStamp() { return __us; }
+
 
@@ -26,8 +26,10 @@
 #include "Exports.h"
 #include "GlobalDef.h"
 #include "M3DCore/Containers.h"
+#include "M3DCore/SmallList.h"
 #include "M3DCore/MString.h"
 #include "M3DCore/GuidUtil.h"
+#include <type_traits>
 
 namespace m3d
 {
@@ -50,7 +52,7 @@ struct ChipDesc
 extern const ChipDesc &RegisterChipDesc(const Char *name, Guid type, Guid basetype, ChipDesc::Usage usage, uint32 version, const Char *factoryFunc, const Char *filters = MTEXT(""));
 
 // CHIPDESC_DECL is placed in all new chips.
-#define CHIPDESC_DECL public: static const m3d::ChipDesc DESC; virtual const m3d::ChipDesc &GetChipDesc() const override { return DESC; } 
+#define CHIPDESC_DECL public: static const m3d::ChipDesc DESC; virtual const m3d::ChipDesc &GetChipDesc() const override { return DESC; } protected: virtual bool OverridesProvideChildren() const override { using Self = std::remove_cv_t<std::remove_pointer_t<decltype(this)>>; return IsProvideChildrenOverride(&Self::ProvideChildren); } public: 
 // CHIPDESCV1_DEF, CHIPDESCV1_DEF_HIDDEN, CHIPDESCV1_DEF_VIRTUAL OR CHIPDESCV1_DEF_IMPORTER is placed in the cpp file of the chip, or in the exports.cpp of the packet.
 // TODO: If placed in cpp file of chip, confirm that RegisterChipDesc(...) is always called on library loading, and that this technique is safe!
 #define CHIPDESCV1_DEF(clazz, name, guid, baseGuid) const m3d::ChipDesc clazz::DESC = RegisterChipDesc(name, guid, baseGuid, m3d::ChipDesc::STANDARD, VERSION1, #clazz"_FACTORY"); extern "C" __declspec( dllexport ) m3d::Chip* __cdecl clazz##_FACTORY() throw(...) { return mmnew clazz(); }
@@ -87,19 +89,22 @@ struct SubConnection
 };
 
 
-typedef List<SubConnection> SubConnectionList;
+// SINGLE and MULTI connections have one sub connection, GROWING often few. Keep one inline in the ChildConnection.
+typedef SmallList<SubConnection, 1> SubConnectionList;
 
 typedef List<Chip*> ChipList;
 
 struct ChildConnection
 {
-	const ChildConnectionDesc desc;
-	const ChipTypeIndex chipTypeIndex;
+	// Ordered by use when getting children, to keep them close.
 	SubConnectionList connections;
-	ChildConnection(const ChildConnectionDesc &desc, ChipTypeIndex chipTypeIndex) : desc(desc), chipTypeIndex(chipTypeIndex) {}
+	const ChipTypeIndex chipTypeIndex;
+	const ChildConnectionDesc desc;
+	ChildConnection(const ChildConnectionDesc &desc, ChipTypeIndex chipTypeIndex) : chipTypeIndex(chipTypeIndex), desc(desc) {}
 };
 
-typedef List<ChildConnection*> ChildConnectionList;
+// Most chips have up to four connections. Keep them inline in the chip.
+typedef SmallList<ChildConnection*, 4> ChildConnectionList;
 
 
 #define CREATE_CHILD(index, type, growing, dataDirection, name) { m3d::ChildConnectionDesc desc = {type, (growing ? m3d::ChildConnectionDesc::GROWING : m3d::ChildConnectionDesc::SINGLE), m3d::ChildConnectionDesc::dataDirection, name}; SetConnection(index, desc, false); }
@@ -162,25 +167,38 @@ class DocumentSaver;
 
 
 
+typedef uint32 UpdateStamp;
+
+extern UpdateStamp M3DENGINE_API GenerateUpdateStamp();
+// Returns the last stamp generated. If unchanged, no chip has been updated.
+extern UpdateStamp M3DENGINE_API GetLastUpdateStamp();
+
+// Returned by Chip::GetInputStamp() when the inputs of a chip can not be tracked.
+static const UpdateStamp InvalidUpdateStamp = UpdateStamp(-1);
+
 class M3DENGINE_API RefreshManager
 {
 	friend struct RefreshT;
 public:
-	enum class RefreshMode { Always, OncePerFunctionCall, OncePerFrame, Once, Never };
+	// OnInputChange: Refresh only if the update stamps of the chips we depend on have changed since the last refresh.
+	enum class RefreshMode { Always, OncePerFunctionCall, OncePerFrame, Once, Never, OnInputChange };
 private:
 	RefreshMode _rm;
+	// The chip we belong to. Needed by OnInputChange.
+	Chip *_chip;
 
 	uint32 _lastFrame; // The last frame nr we where hit. 0 if unhit.
 	uint32 _lastStack; // The last stack nr we where hit.
+	UpdateStamp _lastInput; // The input stamp at our last refresh. Used by OnInputChange.
 
 public:
-	RefreshManager() : _rm(RefreshMode::OncePerFunctionCall), _lastFrame(0), _lastStack(0) {}
+	RefreshManager(Chip *chip = nullptr) : _rm(RefreshMode::OncePerFunctionCall), _chip(chip), _lastFrame(0), _lastStack(0), _lastInput(InvalidUpdateStamp) {}
 	operator bool();
 
 	RefreshMode GetRefreshMode() const { return _rm; }
-	void SetRefreshMode(RefreshMode rm) { _rm = rm; }
+	void SetRefreshMode(RefreshMode rm);
 
-	void Reset() { _lastFrame = 0; _lastStack = 0; }
+	void Reset() { _lastFrame = 0; _lastStack = 0; _lastInput = InvalidUpdateStamp; }
 };
 
 struct RefreshT
@@ -188,16 +206,13 @@ struct RefreshT
 	RefreshManager &rm;
 	bool b;
 	uint32 t1, t2;
-	RefreshT(RefreshManager &rm) : rm(rm), b(rm), t1(rm._lastFrame), t2(rm._lastStack) {}
-	~RefreshT() { rm._lastFrame = t1; rm._lastStack = t2; }
+	UpdateStamp t3;
+	RefreshT(RefreshManager &rm) : rm(rm), b(rm), t1(rm._lastFrame), t2(rm._lastStack), t3(rm._lastInput) {}
+	~RefreshT() { rm._lastFrame = t1; rm._lastStack = t2; rm._lastInput = t3; }
 	inline operator bool() const { return b; }
 };
 
 struct ChipEditorData;
 
-typedef uint32 UpdateStamp;
-
-extern UpdateStamp M3DENGINE_API GenerateUpdateStamp();
-
 
 }
\ No newline at end of file
@@ -26,11 +26,25 @@
 #include "Engine.h"
 #include "M3DCore/GuidUtil.h"
 #include "Chip.h"
+#include "M3DCore/ThreadPool.h"
+#include "M3DCore/Clock.h"
 
 using namespace m3d;
 
 
-ChipManager::ChipManager() : _guidIndices(0), _guidSupportMap(nullptr), _eventListener(nullptr)
+// The PacketModuleLoader and ChipRegistryCache use std::filesystem, the rest of the engine uses Path.
+static std::filesystem::path toFilesystemPath(Path p)
+{
+	return std::filesystem::path(p.AsString().c_str());
+}
+
+static String toString(const std::filesystem::path &p)
+{
+	return String(p.string().c_str());
+}
+
+
+ChipManager::ChipManager() : _guidIndices(0), _guidSupportMap(nullptr), _eventListener(nullptr), _loader(&PacketModuleLoader::GetDefault()), _registryCacheEnabled(true)
 {
 }
 
@@ -52,38 +66,75 @@ void ChipManager::_clear()
 	_chipsByGUIDMap.clear();
 	_chipsByGUIDIndexMap.clear();
 	for (const auto &n : _packetMap) {
-		ONPACKETUNLOAD onPacketUnloadFunc = (ONPACKETUNLOAD)GetProcAddress(n.second->module, "OnPacketUnload");
-		if (onPacketUnloadFunc)
-			(*onPacketUnloadFunc)();
-		FreeLibrary(n.second->module);
+		PacketModule module = n.second->module.load();
+		if (module) {
+			ONPACKETUNLOAD onPacketUnloadFunc = (ONPACKETUNLOAD)_loader->GetSymbol(module, "OnPacketUnload");
+			if (onPacketUnloadFunc)
+				(*onPacketUnloadFunc)();
+			_loader->Free(module);
+		}
 		mmdelete(n.second);
 	}
 	_packetMap.clear();
 }
 
-bool ChipManager::FindChips(Path folder)
+Path ChipManager::GetRegistryCacheFile() const
 {
-	//Char buff[MAX_PATH];
+	return _registryCacheFile.IsFile() ? _registryCacheFile : Path::File(Path(MTEXT("ChipRegistry.cache")), _chipsDirectory);
+}
 
-	WIN32_FIND_DATAA FindFileData;
-//	HANDLE hFind = FindFirstFile((folder.AsString() + MTEXT("*.dll")).c_str(), &FindFileData);
-	HANDLE hFind = FindFirstFileExA((folder.AsString() + MTEXT("*.dll")).c_str(), FindExInfoStandard, &FindFileData, FindExSearchNameMatch, NULL, 0);
+bool ChipManager::FindChips(Path folder)
+{
+	int64 start = Clock::GetTime_ns();
 
 	_chipsDirectory = folder;
 
-	// Process all DLLs in the specified directory
-	if (hFind != INVALID_HANDLE_VALUE) {
-//		if (::GetFullPathName((folder.AsString() + FindFileData.cFileName).c_str(), MAX_PATH, buff, 0)) {
-			_processDLL(Path(FindFileData.cFileName, folder));
-//		}
-		while (FindNextFileA(hFind, &FindFileData) != 0) {
-//			if (::GetFullPathName((folder.AsString() + FindFileData.cFileName).c_str(), MAX_PATH, buff, 0)) {
-				_processDLL(Path(FindFileData.cFileName, folder));
-//			}
+	List<std::filesystem::path> files = _loader->FindPackets(toFilesystemPath(folder));
+
+	ChipRegistryCache cache;
+	if (_registryCacheEnabled && !cache.Load(toFilesystemPath(GetRegistryCacheFile())))
+		msg(DINFO, String(MTEXT("No valid chip registry cache found at \'")) + GetRegistryCacheFile().AsString() + MTEXT("\'. All packets will be probed."));
+
+	// Check all packets against the cache, and probe the ones not found there, in parallel.
+	List<PacketDesc> packets(files.size());
+	List<uint8> stamped(files.size(), 0), probed(files.size(), 0), valid(files.size(), 0);
+	{
+		ThreadPool pool(std::max(1u, std::min((uint32)files.size(), std::thread::hardware_concurrency())));
+		for (size_t i = 0; i < files.size(); i++) {
+			pool.Submit([&, i]() {
+				PacketDesc &pd = packets[i];
+				stamped[i] = _loader->GetFileStamp(files[i], pd.fileSize, pd.fileTime);
+				const PacketDesc *cached = stamped[i] ? cache.Find(files[i], pd.fileSize, pd.fileTime) : nullptr;
+				if (cached) {
+					pd = *cached;
+					valid[i] = true;
+					return;
+				}
+				valid[i] = _probePacket(files[i], pd);
+				probed[i] = true;
+			});
 		}
-		FindClose(hFind);
+		pool.Wait();
 	}
 
+	// Register the packets in file order, so that chip type indices do not depend on timing.
+	ChipRegistryCache newCache;
+	uint32 probeCount = 0;
+	for (size_t i = 0; i < files.size(); i++) {
+		probeCount += probed[i];
+		if (!valid[i])
+			continue;
+		_addPacket(packets[i]);
+		if (stamped[i])
+			newCache.Add(packets[i]);
+	}
+	if (_registryCacheEnabled && (probeCount > 0 || newCache.GetPacketCount() != cache.GetPacketCount())) {
+		if (!newCache.Save(toFilesystemPath(GetRegistryCacheFile())))
+			msg(WARN, String(MTEXT("Failed to save chip registry cache to \'")) + GetRegistryCacheFile().AsString() + MTEXT("\'."));
+	}
+
+	msg(INFO, strUtils::ConstructString(MTEXT("Registered %1 packets (%2 probed, %3 from cache) in %4 ms.")).arg((uint32)_packetMap.size()).arg(probeCount).arg((uint32)files.size() - probeCount).arg(Clock::ToMilliseconds(Clock::GetTime_ns() - start), MTEXT("%.1f")));
+
 	// Allocate _guidSupportMap
 	if (_guidSupportMap)
 		mmfree(_guidSupportMap);
@@ -138,103 +189,62 @@ bool ChipManager::FindChips(Path folder)
 	return true;
 }
 
-// See MSDN for LoadLibraryEx()
-//#define LOAD_LIBRARY_SEARCH_DEFAULT_DIRS 0x00001000
-//#define LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR 0x00000100
-
-String GetLastErrorAsString()
+bool ChipManager::_probePacket(const std::filesystem::path &fileName, PacketDesc &pd)
 {
-	//Get the error message, if any.
-	DWORD errorMessageID = ::GetLastError();
-	if (errorMessageID == 0)
-		return String();
+	assert(fileName.is_absolute());
 
-	LPSTR messageBuffer = nullptr;
-	size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-		NULL, errorMessageID, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&messageBuffer, 0, NULL);
-
-	String message(messageBuffer, size);
-
-	//Free the buffer.
-	LocalFree(messageBuffer);
-
-	return message;
+	msg(DINFO, String(MTEXT("Searching for chips in \'")) + toString(fileName) + MTEXT("\'..."));
+	List<String> skippedChips;
+	if (!ProbePacket(*_loader, fileName, pd, &skippedChips)) {
+		msg(WARN, String(MTEXT("Unable to load \'")) + toString(fileName) + MTEXT("\' to search for chips. Reason: ") + _loader->GetLastError() + MTEXT("."));
+		return false;
+	}
+	for (const String &name : skippedChips)
+		msg(FATAL, String(MTEXT("Unable to use chip \'")) + name + MTEXT("\' in packet \'") + pd.name + MTEXT("\' because of missing factory function."));
+	msg(DINFO, String(MTEXT("Unloaded \'")) + toString(fileName) + MTEXT("\'."));
+	return true;
 }
 
-void ChipManager::_processDLL(Path fileName) 
+void ChipManager::_addPacket(const PacketDesc &pd)
 {
-#ifdef WINDESKTOP
-	assert(fileName.IsAbsolute());
-//	HMODULE hDLL = LoadLibraryA(fileName.AsString().c_str());
-	HMODULE hDLL = LoadLibraryExA(fileName.AsString().c_str(), 0, LOAD_LIBRARY_SEARCH_DEFAULT_DIRS | LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR);
-#else
-	HMODULE hDLL = LoadPackagedLibrary(fileName.AsString().c_str(), 0);
-#endif
-
-	msg(DINFO, String(MTEXT("Searching for chips in \'")) + fileName.AsString() + MTEXT("\'..."));
-	if (hDLL) {
-		GETCHIPCOUNT getChipCountFunc = (GETCHIPCOUNT)GetProcAddress(hDLL, "GetChipCount");
-		GETCHIPTYPE getChipTypeFunc = (GETCHIPTYPE)GetProcAddress(hDLL, "GetChipDesc");
-		GETPACKETNAME getPacketNameFunc = (GETPACKETNAME)GetProcAddress(hDLL, "GetPacketName");
-		GETSUPPORTEDPLATFORMS getSupportedPlatformsFunc = (GETSUPPORTEDPLATFORMS)GetProcAddress(hDLL, "GetSupportedPlatforms");
-		if (getChipCountFunc && getChipTypeFunc && getPacketNameFunc && getSupportedPlatformsFunc) {
-			uint32 supportedPlatforms = (*getSupportedPlatformsFunc)();
-			uint32 cCount = (*getChipCountFunc)();
-			String packetName = (*getPacketNameFunc)();
-			auto n = _packetMap.find(packetName);
-			if (n == _packetMap.end()) {
-				Packet *p = mmnew Packet();
-				p->filename = fileName.AsString();
-				p->name = packetName;
-				p->chipCount = cCount;
-				p->supportedPlatforms = supportedPlatforms; 
-				_packetMap.insert(std::make_pair(p->name, p)); // always true
-				for (uint32 i = 0; i < cCount; i++) {
-					const ChipDesc &cd = (*getChipTypeFunc)(i);
-					ChipInfo *ci = mmnew ChipInfo();
-					ci->packet = p;
-					ci->chipDesc.name = cd.name;
-					ci->chipDesc.type = cd.type;
-					ci->chipDesc.basetype = cd.basetype;
-					ci->chipDesc.usage = cd.usage;
-					ci->chipDesc.version = cd.version;
-					ci->chipDesc.factoryFunc = cd.factoryFunc;
-					ci->chipDesc.filters = cd.filters;
-					ci->chipTypeIndex = _guidIndices++;
-					CHIPFACTORY cf = (CHIPFACTORY)GetProcAddress(hDLL, ci->chipDesc.factoryFunc.c_str());
-					if (!cf) {
-						// Corrupt chip?
-						msg(FATAL, String(MTEXT("Unable to use chip \'")) + ci->chipDesc.name + MTEXT("\' in packet \'") + packetName + MTEXT("\' because of missing factory function."));
-						_guidIndices--;
-						mmdelete(ci);
-						continue; 
-					}
-					if (!_chipsByGUIDMap.insert(std::make_pair(ci->chipDesc.type, ci)).second) {
-						// Found another chip with this guid!
-						msg(FATAL, String(MTEXT("Unable to use chip \'")) + ci->chipDesc.name + MTEXT("\' in packet \'") + packetName + MTEXT("\'. Its type \'") + GuidToString(ci->chipDesc.type) + MTEXT("\' already exist."));
-						_guidIndices--;
-						mmdelete(ci);
-						continue; 
-					}
-					_chipsByGUIDIndexMap.insert(std::make_pair(ci->chipTypeIndex, ci)); // always true
-					p->chips.insert(std::make_pair(ci->chipDesc.type, ci)); // always true
-				}
-				msg(INFO, String(MTEXT("Found ")) + strUtils::fromNum(p->chips.size()) + MTEXT(" chips in packet \'") + packetName +  MTEXT("\' (") + fileName.AsString() + MTEXT(")."));
-			}
-			else {
-				// Packet already exist => conflict!
-				msg(FATAL, String(MTEXT("Packet \'")) + packetName + MTEXT("\' already exist. Skipping packet in \'") + fileName.AsString() + MTEXT("\'."));
-			}
-		}
-		else {
-			msg(WARN, String(MTEXT("Skipping search for chips in \'")) + fileName.AsString() + MTEXT("\'. It does not appear to be a valid chip dll."));
-		}
-		msg(DINFO, String(MTEXT("Unloading \'")) + fileName.AsString() + MTEXT("\'..."));
-		FreeLibrary(hDLL);
+	if (pd.name.empty()) {
+		msg(WARN, String(MTEXT("Skipping search for chips in \'")) + toString(pd.filename) + MTEXT("\'. It does not appear to be a valid chip dll."));
+		return;
+	}
+	if (_packetMap.find(pd.name) != _packetMap.end()) {
+		// Packet already exist => conflict!
+		msg(FATAL, String(MTEXT("Packet \'")) + pd.name + MTEXT("\' already exist. Skipping packet in \'") + toString(pd.filename) + MTEXT("\'."));
+		return;
 	}
-	else {
-		msg(WARN, String(MTEXT("Unable to load \'")) + fileName.AsString() + MTEXT("\' to search for chips. Reason: ") + GetLastErrorAsString() + MTEXT("."));
+
+	Packet *p = mmnew Packet();
+	p->filename = Path(toString(pd.filename));
+	p->name = pd.name;
+	p->chipCount = pd.chipCount;
+	p->supportedPlatforms = pd.supportedPlatforms; 
+	_packetMap.insert(std::make_pair(p->name, p)); // always true
+	for (const PacketDesc::Chip &cd : pd.chips) {
+		ChipInfo *ci = mmnew ChipInfo();
+		ci->packet = p;
+		ci->chipDesc.name = cd.name;
+		ci->chipDesc.type = cd.type;
+		ci->chipDesc.basetype = cd.basetype;
+		ci->chipDesc.usage = cd.usage;
+		ci->chipDesc.version = cd.version;
+		ci->chipDesc.factoryFunc = cd.factoryFunc;
+		ci->chipDesc.filters = cd.filters;
+		ci->chipTypeIndex = _guidIndices++;
+		if (!_chipsByGUIDMap.insert(std::make_pair(ci->chipDesc.type, ci)).second) {
+			// Found another chip with this guid!
+			msg(FATAL, String(MTEXT("Unable to use chip \'")) + ci->chipDesc.name + MTEXT("\' in packet \'") + pd.name + MTEXT("\'. Its type \'") + GuidToString(ci->chipDesc.type) + MTEXT("\' already exist."));
+			_guidIndices--;
+			mmdelete(ci);
+			continue; 
+		}
+		_chipsByGUIDIndexMap.insert(std::make_pair(ci->chipTypeIndex, ci)); // always true
+		p->chips.insert(std::make_pair(ci->chipDesc.type, ci)); // always true
 	}
+	msg(INFO, String(MTEXT("Found ")) + strUtils::fromNum((uint32)p->chips.size()) + MTEXT(" chips in packet \'") + pd.name +  MTEXT("\' (") + toString(pd.filename) + MTEXT(")."));
 }
 
 Chip *ChipManager::CreateChip(const Guid &chipType)
@@ -245,7 +255,7 @@ Chip *ChipManager::CreateChip(const Guid &chipType)
 		return nullptr; // no such chip!
 	}
 
-	HMODULE hm = n->second->packet->module.load();
+	PacketModule hm = n->second->packet->module.load();
 
 	if (hm == 0) { // not loaded? (Double-checked locking...)
 		SlimWLockBlock lock(_lock);
@@ -255,16 +265,12 @@ Chip *ChipManager::CreateChip(const Guid &chipType)
 		if (hm == 0) { // still not loaded?
 			// load dll
 			msg(DINFO, String(MTEXT("Trying to load chip dll \'")) + n->second->packet->filename.AsString() + MTEXT("\'..."));
-#ifdef WINDESKTOP
-			HMODULE hDLL = LoadLibraryExA(n->second->packet->filename.AsString().c_str(), 0, LOAD_LIBRARY_SEARCH_DEFAULT_DIRS | LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR);
-#else
-			HMODULE hDLL = LoadPackagedLibrary(n->second->packet->filename.AsString().c_str(), 0);
-#endif
+			PacketModule hDLL = _loader->Load(toFilesystemPath(n->second->packet->filename));
 			if (hDLL) {
-				GETCHIPCOUNT getChipCountFunc = (GETCHIPCOUNT)GetProcAddress(hDLL, "GetChipCount");
-				GETPACKETNAME getPacketNameFunc = (GETPACKETNAME)GetProcAddress(hDLL, "GetPacketName");
-				ADDDEPENDENCIES addDependenciesFunc = (ADDDEPENDENCIES)GetProcAddress(hDLL, "AddDependencies");
-				// confirm packet name & count
+				GETCHIPCOUNT getChipCountFunc = (GETCHIPCOUNT)_loader->GetSymbol(hDLL, "GetChipCount");
+				GETPACKETNAME getPacketNameFunc = (GETPACKETNAME)_loader->GetSymbol(hDLL, "GetPacketName");
+				ADDDEPENDENCIES addDependenciesFunc = (ADDDEPENDENCIES)_loader->GetSymbol(hDLL, "AddDependencies");
+				// confirm packet name & count. A mismatch means the registry cache was outdated.
 				if (getChipCountFunc && getPacketNameFunc) {
 					uint32 cCount = (*getChipCountFunc)();
 					String packetName = (*getPacketNameFunc)();
@@ -273,12 +279,12 @@ Chip *ChipManager::CreateChip(const Guid &chipType)
 						msg(FATAL, String(MTEXT("Packet \'")) + n->second->packet->name + MTEXT("\' appears to be different from when first loaded."));
 					}
 					else {
-						ONPACKETLOAD onPacketLoadFunc = (ONPACKETLOAD)GetProcAddress(hDLL, "OnPacketLoad");
+						ONPACKETLOAD onPacketLoadFunc = (ONPACKETLOAD)_loader->GetSymbol(hDLL, "OnPacketLoad");
 						bool loadOK = onPacketLoadFunc ? (*onPacketLoadFunc)() : true;
 						if (loadOK) { // Packet loaded!!
 							// Load chip factory functions...
 							for (const auto &m : n->second->packet->chips) {
-								m.second->chipFactoryFunc = (CHIPFACTORY)GetProcAddress(hDLL, m.second->chipDesc.factoryFunc.c_str());
+								m.second->chipFactoryFunc = (CHIPFACTORY)_loader->GetSymbol(hDLL, m.second->chipDesc.factoryFunc.c_str());
 								if (m.second->chipFactoryFunc == 0) {  // could not find factory func!
 									msg(FATAL, String(MTEXT("Unable to find factory function for chip \'")) + m.second->chipDesc.name + MTEXT("\'."));
 								}
@@ -298,7 +304,7 @@ Chip *ChipManager::CreateChip(const Guid &chipType)
 				}
 				if (n->second->packet->module.load() == 0) {
 					msg(FATAL, String(MTEXT("Unable to use packet \'")) + n->second->packet->name + MTEXT("\'. It appears to be invalid."));
-					FreeLibrary(hDLL);
+					_loader->Free(hDLL);
 					return nullptr; // Invalid dll?
 				}
 			}
@@ -321,6 +327,8 @@ Chip *ChipManager::CreateChip(const Guid &chipType)
 			msg(FATAL, String(MTEXT("Factory function returned null for chip \'")) + n->second->chipDesc.name + MTEXT("\'."));
 			// could not create the chip for some reason!?
 		}
+		else
+			ch->_overridesProvideChildren = ch->OverridesProvideChildren();
 	}
 	catch(...) {
 		ch = nullptr;
@@ -29,21 +29,19 @@
 #include "M3DCore/Containers.h"
 #include "M3DCore/Path.h"
 #include "M3DCore/SlimRWLock.h"
+#include "PacketModuleLoader.h"
+#include "ChipRegistryCache.h"
 #include <atomic>
 
 
 namespace m3d
 {
 
-typedef const Char* (*GETPACKETNAME)();
-typedef uint32 (*GETCHIPCOUNT)();
-typedef const ChipDesc &(*GETCHIPTYPE)(uint32);
 typedef bool (*ONPACKETQUERY)();
 typedef bool (*ONPACKETLOAD)();
 typedef void (*ONPACKETUNLOAD)();
 typedef Chip *(*CHIPFACTORY)();
 typedef void (*ADDDEPENDENCIES)(ProjectDependencies &deps);
-typedef uint32 (*GETSUPPORTEDPLATFORMS)();
 
 
 struct Packet;
@@ -81,7 +79,7 @@ struct Packet
 	// Note: The supportedPlatforms-flag is mostly for use by the publisher! 
 	// We don't do any testing on load! If the dll is present and loads for a given platform it is assumed to be supported!
 	uint32 supportedPlatforms; 
-	std::atomic<HMODULE> module; // The dll-module. Atomic because we load it on demand, possibly from any thread.
+	std::atomic<PacketModule> module; // The dll-module. Atomic because we load it on demand, possibly from any thread.
 	ChipInfoPtrByGUIDMap chips; 
 	ADDDEPENDENCIES addDependenciesFunc;
 
@@ -112,11 +110,17 @@ protected:
 
 	Path _chipsDirectory;
 
+	PacketModuleLoader *_loader;
+	bool _registryCacheEnabled;
+	Path _registryCacheFile;
+
 	SlimRWLock _lock;
 	SlimRWLock _globalChipsLock;
 
 	void _clear();
-	void _processDLL(Path fileName);
+	// Loads the module to get its packet description. Thread safe. Returns false if the module could not be loaded.
+	bool _probePacket(const std::filesystem::path &fileName, PacketDesc &pd);
+	void _addPacket(const PacketDesc &pd);
 
 	bool &_isChipGuidSupported(ChipTypeIndex guidRequired, ChipTypeIndex guidToCheck) const { return _guidSupportMap[guidRequired * _guidIndices + guidToCheck]; }
 
@@ -126,8 +130,19 @@ public:
 
 	void SetEventListener(ChipManagerEventListener *eventListener) { _eventListener = eventListener; }
 
+	// Registers the chips of all packets in folder. Packets found in the registry cache are registered without loading their modules.
+	// Modules are loaded when their first chip is created.
 	bool FindChips(Path folder);
 
+	// Replaces the platform layer used to find and load packets. Must be called before FindChips(). nullptr for the default.
+	void SetModuleLoader(PacketModuleLoader *loader) { _loader = loader ? loader : &PacketModuleLoader::GetDefault(); }
+	PacketModuleLoader *GetModuleLoader() const { return _loader; }
+	// The registry cache is enabled by default, and stored as ChipRegistry.cache in the chips directory if no file is set.
+	void SetRegistryCacheEnabled(bool enabled) { _registryCacheEnabled = enabled; }
+	bool IsRegistryCacheEnabled() const { return _registryCacheEnabled; }
+	void SetRegistryCacheFile(Path file) { _registryCacheFile = file; }
+	Path GetRegistryCacheFile() const;
+
 	Path GetChipsDirectory() const { return _chipsDirectory; }
 
 	// THREAD SAFE!
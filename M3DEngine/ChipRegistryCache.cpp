@@ -0,0 +1,172 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "ChipRegistryCache.h"
+#include "PacketModuleLoader.h"
+#include "M3DCore/GuidUtil.h"
+#include "M3DCore/DiskCache.h"
+
+using namespace m3d;
+
+
+// Text file, one record per line with tab separated fields:
+//   SnaXChipRegistry <format version>
+//   packet <filename (UTF-8)> <size> <time> <name> <supported platforms> <chip count> <number of chip records>
+//   chip <name> <type> <base type> <usage> <version> <factory function> <filters>
+// Chip records follow their packet record.
+#define REGISTRY_HEADER MTEXT("SnaXChipRegistry")
+#define REGISTRY_FORMAT 1u
+
+
+bool m3d::ProbePacket(PacketModuleLoader &loader, const std::filesystem::path &fileName, PacketDesc &pd, List<String> *skippedChips)
+{
+	pd.filename = fileName;
+
+	PacketModule module = loader.Load(fileName);
+	if (!module)
+		return false;
+
+	GETCHIPCOUNT getChipCountFunc = (GETCHIPCOUNT)loader.GetSymbol(module, "GetChipCount");
+	GETCHIPTYPE getChipTypeFunc = (GETCHIPTYPE)loader.GetSymbol(module, "GetChipDesc");
+	GETPACKETNAME getPacketNameFunc = (GETPACKETNAME)loader.GetSymbol(module, "GetPacketName");
+	GETSUPPORTEDPLATFORMS getSupportedPlatformsFunc = (GETSUPPORTEDPLATFORMS)loader.GetSymbol(module, "GetSupportedPlatforms");
+	if (getChipCountFunc && getChipTypeFunc && getPacketNameFunc && getSupportedPlatformsFunc) {
+		pd.supportedPlatforms = (*getSupportedPlatformsFunc)();
+		pd.chipCount = (*getChipCountFunc)();
+		pd.name = (*getPacketNameFunc)();
+		for (uint32 i = 0; i < pd.chipCount; i++) {
+			const ChipDesc &cd = (*getChipTypeFunc)(i);
+			if (!loader.GetSymbol(module, cd.factoryFunc)) {
+				// Corrupt chip?
+				if (skippedChips)
+					skippedChips->push_back(cd.name);
+				continue;
+			}
+			pd.chips.push_back({ cd.name, cd.type, cd.basetype, cd.usage, cd.version, cd.factoryFunc, cd.filters });
+		}
+	}
+
+	loader.Free(module);
+	return true;
+}
+
+
+static List<String> splitFields(const String &line)
+{
+	List<String> fields;
+	size_t s = 0;
+	for (size_t i = 0; i <= line.size(); i++) {
+		if (i == line.size() || line[i] == MCHAR('\t')) {
+			fields.push_back(line.substr(s, i - s));
+			s = i + 1;
+		}
+	}
+	return fields;
+}
+
+static bool isField(const String &s)
+{
+	return s.find_first_of(MTEXT("\t\r\n")) == String::npos;
+}
+
+bool ChipRegistryCache::Load(const std::filesystem::path &file)
+{
+	_packets.clear();
+
+	List<uint8> data;
+	if (!ReadFileData(file, data))
+		return false;
+
+	List<String> lines;
+	for (size_t s = 0, i; s < data.size(); s = i + 1) {
+		for (i = s; i < data.size() && data[i] != '\n'; i++);
+		lines.push_back(String((const Char*)data.data() + s, i - s));
+	}
+
+	uint32 format = 0;
+	if (lines.empty() || splitFields(lines[0]).size() != 2 || splitFields(lines[0])[0] != REGISTRY_HEADER || !strUtils::toNum(splitFields(lines[0])[1], format) || format != REGISTRY_FORMAT)
+		return false;
+
+	for (size_t i = 1; i < lines.size();) {
+		List<String> p = splitFields(lines[i++]);
+		PacketDesc pd;
+		uint32 chipRecords = 0;
+		if (p.size() != 8 || p[0] != MTEXT("packet") || !strUtils::toNum(p[2], pd.fileSize) || !strUtils::toNum(p[3], pd.fileTime) || !strUtils::toNum(p[5], pd.supportedPlatforms) || !strUtils::toNum(p[6], pd.chipCount) || !strUtils::toNum(p[7], chipRecords) || i + chipRecords > lines.size()) {
+			_packets.clear();
+			return false;
+		}
+		pd.filename = std::filesystem::u8path(p[1].c_str());
+		pd.name = p[4];
+		for (uint32 j = 0; j < chipRecords; j++) {
+			List<String> c = splitFields(lines[i++]);
+			PacketDesc::Chip cd;
+			uint32 usage = 0;
+			if (c.size() != 8 || c[0] != MTEXT("chip") || !StringToGUID(c[2], cd.type) || !StringToGUID(c[3], cd.basetype) || !strUtils::toNum(c[4], usage) || !strUtils::toNum(c[5], cd.version.version)) {
+				_packets.clear();
+				return false;
+			}
+			cd.name = c[1];
+			cd.usage = (ChipDesc::Usage)usage;
+			cd.factoryFunc = c[6];
+			cd.filters = c[7];
+			pd.chips.push_back(cd);
+		}
+		_packets[pd.filename] = pd;
+	}
+	return true;
+}
+
+bool ChipRegistryCache::Save(const std::filesystem::path &file) const
+{
+	String s = strUtils::format(MTEXT("%s\t%u\n"), REGISTRY_HEADER, REGISTRY_FORMAT);
+	for (const auto &n : _packets) {
+		const PacketDesc &pd = n.second;
+		String filename = String(pd.filename.u8string().c_str());
+		bool ok = !filename.empty() && isField(filename) && isField(pd.name);
+		for (size_t i = 0; ok && i < pd.chips.size(); i++)
+			ok = isField(pd.chips[i].name) && isField(pd.chips[i].factoryFunc) && isField(pd.chips[i].filters);
+		if (!ok)
+			continue; // Can not be stored. The packet will be probed on next startup.
+		s += strUtils::format(MTEXT("packet\t%s\t%llu\t%lld\t%s\t%u\t%u\t%u\n"), filename.c_str(), pd.fileSize, pd.fileTime, pd.name.c_str(), pd.supportedPlatforms, pd.chipCount, (uint32)pd.chips.size());
+		for (const PacketDesc::Chip &cd : pd.chips)
+			s += strUtils::format(MTEXT("chip\t%s\t%s\t%s\t%u\t%u\t%s\t%s\n"), cd.name.c_str(), GuidToString(cd.type).c_str(), GuidToString(cd.basetype).c_str(), (uint32)cd.usage, cd.version.version, cd.factoryFunc.c_str(), cd.filters.c_str());
+	}
+
+	// Written to a temporary file first, so a crash or another instance saving at the same time never leaves a truncated registry.
+	return WriteFileAtomic(file, s.c_str(), s.size());
+}
+
+const PacketDesc *ChipRegistryCache::Find(const std::filesystem::path &filename, uint64 fileSize, int64 fileTime) const
+{
+	auto n = _packets.find(filename);
+	if (n == _packets.end() || n->second.fileSize != fileSize || n->second.fileTime != fileTime)
+		return nullptr;
+	return &n->second;
+}
+
+void ChipRegistryCache::Add(const PacketDesc &packet)
+{
+	_packets[packet.filename] = packet;
+}
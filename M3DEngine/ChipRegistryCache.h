@@ -0,0 +1,96 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "ChipDef.h"
+#include "M3DCore/Containers.h"
+#include <filesystem>
+
+
+namespace m3d
+{
+
+class PacketModuleLoader;
+
+typedef const Char* (*GETPACKETNAME)();
+typedef uint32 (*GETCHIPCOUNT)();
+typedef const ChipDesc &(*GETCHIPTYPE)(uint32);
+typedef uint32 (*GETSUPPORTEDPLATFORMS)();
+
+// What the ChipManager learns about a packet by probing its module.
+struct PacketDesc
+{
+	struct Chip
+	{
+		String name;
+		Guid type;
+		Guid basetype;
+		ChipDesc::Usage usage;
+		Version version;
+		String factoryFunc;
+		String filters;
+	};
+
+	std::filesystem::path filename;
+	// Size and modification time of the file when probed.
+	uint64 fileSize = 0;
+	int64 fileTime = 0;
+	// Empty if the module is not a chip packet.
+	String name;
+	uint32 supportedPlatforms = 0;
+	// Chip count reported by the packet. Chips with missing factory functions are not in chips.
+	uint32 chipCount = 0;
+	List<Chip> chips;
+};
+
+// Loads the module of a packet and reads its name, supported platforms and chips into pd. Chips without a factory function
+// are left out, with their names added to skippedChips if given. pd.name is left empty if the module is not a chip packet.
+// Returns false if the module could not be loaded (see PacketModuleLoader::GetLastError()). The file stamp in pd is not set.
+extern bool M3DENGINE_API ProbePacket(PacketModuleLoader &loader, const std::filesystem::path &fileName, PacketDesc &pd, List<String> *skippedChips = nullptr);
+
+// Persistent cache of probed packets, keyed by file name, size and modification time.
+// Lets the ChipManager register the chips of unchanged packets without loading their modules.
+class M3DENGINE_API ChipRegistryCache
+{
+public:
+	// Clears the cache and loads it from file. Returns false if the file is missing, outdated or corrupt, leaving the cache empty.
+	bool Load(const std::filesystem::path &file);
+	bool Save(const std::filesystem::path &file) const;
+	void Clear() { _packets.clear(); }
+
+	// Returns the cached packet if its file still has the given size and time.
+	const PacketDesc *Find(const std::filesystem::path &filename, uint64 fileSize, int64 fileTime) const;
+	void Add(const PacketDesc &packet);
+
+	size_t GetPacketCount() const { return _packets.size(); }
+	const Map<std::filesystem::path, PacketDesc> &GetPackets() const { return _packets; }
+
+private:
+	Map<std::filesystem::path, PacketDesc> _packets;
+};
+
+
+}
@@ -70,6 +70,7 @@ Class::~Class()
 	assert(_instanceData.empty());
 	assert(_instances.empty());
 	assert(_instancesByGlobalID.empty());
+	assert(_instancePool.IsEmpty());
 	assert(_clazzChips.empty());
 	assert(_loadInfo == nullptr);
 }
@@ -80,6 +81,8 @@ void Class::Clear()
 
 	DeleteLoadInfo();
 
+	TrimInstancePool();
+
 	// Remove all chips!
 	// Removing the chip will cause its function to be deleted and removed from us!
 	// All parameters, instanceData and functionCalls will also be removed!
@@ -114,6 +117,7 @@ bool Class::RegisterInstance(ClassInstance *instance)
 		return false; // instance already exist.. this should really not happen...
 	}
 	_instancesByGlobalID.insert(std::make_pair(instance->GetID(), instance));
+	_instancePool.OnLive((uint32)_instances.size());
 	if (_eventListener)
 		_eventListener->OnInstanceRegistered(instance);
 	return true;
@@ -139,6 +143,61 @@ ClassInstance *Class::FindInstance(const Guid &instanceID)
 	return itr != _instancesByGlobalID.end() ? itr->second : nullptr;
 }
 
+void Class::SetInstancePoolPolicy(InstancePoolPolicy policy)
+{
+	_instancePool.SetPolicy(policy);
+	TrimInstancePool(_instancePool.GetLimit());
+}
+
+void Class::SetInstancePoolCapacity(uint32 capacity)
+{
+	_instancePool.SetCapacity(capacity);
+	TrimInstancePool(_instancePool.GetLimit());
+}
+
+void Class::PrewarmInstancePool(uint32 count)
+{
+	_instancePool.Prewarm(count, [this]() { return mmnew ClassInstance(this); });
+}
+
+void Class::TrimInstancePool(uint32 count)
+{
+	// Releasing the data of an instance may release other instances of us. InstancePool handles that.
+	_instancePool.Trim(count, [](ClassInstance *instance) { mmdelete(instance); }, (uint32)_instances.size());
+}
+
+void Class::ResetInstancePoolStats()
+{
+	_instancePool.ResetStats((uint32)_instances.size());
+}
+
+ClassInstance *Class::_acquirePooledInstance(Chip *owner)
+{
+	ClassInstance *instance = _instancePool.Take();
+	if (!instance)
+		return nullptr;
+	instance->_reuse(owner);
+	if (!RegisterInstance(instance)) {
+		instance->_pooled = true; // Not registered!
+		mmdelete(instance);
+		return nullptr;
+	}
+	return instance;
+}
+
+bool Class::_poolInstance(ClassInstance *instance)
+{
+	if (_instancePool.GetPolicy() == InstancePoolPolicy::NONE)
+		return false;
+	if (!_instancePool.HasRoom() || !instance->_recycle()) {
+		_instancePool.OnDiscarded();
+		return false;
+	}
+	UnregisterInstance(instance);
+	instance->_pooled = true;
+	_instancePool.Put(instance);
+	return true;
+}
 
 void Class::RemoveChipAsChildOrParameter(Chip *ch)
 {
@@ -343,12 +402,16 @@ void Class::OnDestroyDevice()
 {
 	for (const auto &n : _chips)
 		n.second->OnDestroyDevice();
+	for (const auto &n : _instancePool.GetInstances())
+		n->OnDestroyDevice();
 }
 
 void Class::OnReleasingBackBuffer(RenderWindow *rw)
 {
 	for (const auto &n : _chips)
 		n.second->OnReleasingBackBuffer(rw);
+	for (const auto &n : _instancePool.GetInstances())
+		n->OnReleasingBackBuffer(rw);
 }
 
 void Class::_findInstanceData(Class *base, Set<InstanceData*> &instanceData, uint32 nBaseOccurences) const
@@ -383,6 +446,8 @@ void Class::_onBaseClassAdded(Class *base, Class *directBase)
 	Set<InstanceData*> newInstanceData;
 	_findInstanceData(base, newInstanceData, 1);
 
+	TrimInstancePool(); // Pooled instances are not updated. Just get rid of them.
+
 	for (const auto &n : _instances)
 		for (const auto m : newInstanceData)
 			n->_addInstanceData(m);
@@ -405,6 +470,8 @@ void Class::_onBaseClassRemoved(Class *base, Class *directBase)
 
 	Set<InstanceData*> oldInstanceData;
 	_findInstanceData(base, oldInstanceData, 0);
+
+	TrimInstancePool();
 	
 	for (const auto &n : _instances)
 		for (const auto &m : oldInstanceData)
@@ -500,6 +567,7 @@ void Class::OnInstanceDataTypeSet(InstanceData *data)
 
 void Class::_onInstanceDataAdded(InstanceData *data)
 {
+	TrimInstancePool();
 	for (const auto &n : _instances)
 		n->_addInstanceData(data);
 	for (const auto &n : _subClasses)
@@ -508,6 +576,7 @@ void Class::_onInstanceDataAdded(InstanceData *data)
 
 void Class::_onInstanceDataRemoved(InstanceData *data)
 {
+	TrimInstancePool();
 	for (const auto &n : _instances)
 		n->_removeInstanceData(data);
 	for (const auto &n : _subClasses)
@@ -583,6 +652,8 @@ void Class::OnRemovedFromClassManager()
 		(*_clazzChips.begin())->SetCG(nullptr);
 
 	// Remove all instances
+	_instancePool.SetPolicy(InstancePoolPolicy::NONE); // Released instances must not end up in the pool now!
+	TrimInstancePool();
 	while (_instances.size())
 		(*_instances.begin())->Release(); // This will unregister at us.
 
@@ -27,12 +27,14 @@
 #include "ChipDef.h"
 #include "M3DCore/Containers.h"
 #include "M3DCore/Path.h"
+#include "InstancePool.h"
 
 
 
 namespace m3d
 {
-	static const Version DocumentVersion = Version(1, 2, 7, 0); // magic enums.
+	static const Version DocumentVersion = Version(1, 2, 8, 0); // Added tag 'Blobs' for content-hash deduplication of large data.
+//static const Version DocumentVersion = Version(1, 2, 7, 0); // magic enums.
 //static const Version DocumentVersion = Version(1, 2, 6, 0); // Added tag 'Classes', 'Parameters', 'Content', integer positions (added json saver/loader) etc.
 //static const Version DocumentVersion = Version(1, 2, 5, 0); // Fixed bug where tag 'Description' was written as 'Publish'
 //static const Version DocumentVersion = Version(1, 2, 4, 0); // Added multiconnections
@@ -97,6 +99,7 @@ struct M3DENGINE_API ClassLoadInfo
 
 class M3DENGINE_API Class
 {
+	friend class ClassInstance;
 public:
 	Class();
 	virtual ~Class();
@@ -169,6 +172,23 @@ public:
 	const ClassInstancePtrSet &GetInstances() const { return _instances; }
 	// Finds an instance using the global id.
 	ClassInstance *FindInstance(const Guid &instanceID);
+	// Returns the released instances kept for reuse. These are not registered and have no owner.
+	const List<ClassInstance*> &GetPooledInstances() const { return _instancePool.GetInstances(); }
+	// Sets how released instances are kept for reuse. NONE empties the pool. Saved with the class. Instances are only pooled
+	// if all their instance data supports Chip::OnInstanceRecycled(). The others are destroyed and counted as discarded.
+	void SetInstancePoolPolicy(InstancePoolPolicy policy);
+	InstancePoolPolicy GetInstancePoolPolicy() const { return _instancePool.GetPolicy(); }
+	// Sets the maximum number of instances kept in the pool. The pool is trimmed if needed.
+	void SetInstancePoolCapacity(uint32 capacity);
+	uint32 GetInstancePoolCapacity() const { return _instancePool.GetCapacity(); }
+	// Constructs instances until the pool holds count of them (limited by the capacity). Does nothing if the policy is NONE.
+	void PrewarmInstancePool(uint32 count);
+	// Destroys pooled instances until at most count are left, and restarts the peak tracking used by ADAPTIVE.
+	void TrimInstancePool(uint32 count = 0);
+	// Returns the pool statistics.
+	const InstancePoolStats &GetInstancePoolStats() const { return _instancePool.GetStats(); }
+	// Resets the pool counters. The peaks are set to the current values.
+	void ResetInstancePoolStats();
 	// Searches all chips for dependencies when publishing.
 	void AddDependencies(ProjectDependencies &packets, ProjectDependencies &third);
 	// Calls RestoreChip() on all chips. 
@@ -183,9 +203,9 @@ public:
 	virtual bool SaveEditorData(DocumentSaver &saver) const { return true; }
 	// Loads editor data. Overridden in ClassExt.
 	virtual bool LoadEditorData(DocumentLoader &loader) { return true; }
-	// Called when the d3d-device is destroyed. Relayed to all chips.
+	// Called when the d3d-device is destroyed. Relayed to all chips and pooled instances.
 	void OnDestroyDevice();
-	// Called when the back buffer is released. Relayed to all chips.
+	// Called when the back buffer is released. Relayed to all chips and pooled instances.
 	void OnReleasingBackBuffer(RenderWindow *rw);
 
 	const ClassChipPtrSet &GetClassChips() const { return _clazzChips; }
@@ -242,6 +262,8 @@ private:
 	ClassInstancePtrSet _instances;
 	// This contains all instances of us ordered by their global id.
 	ClassInstancePtrByGUIDMap _instancesByGlobalID;
+	// Released instances kept for reuse. They are unregistered, and their data is reset to the instance data templates.
+	InstancePool<ClassInstance> _instancePool;
 	// A set of ClassChips pointing to us.
 	ClassChipPtrSet _clazzChips;
 	// Each function data in a clazz get its own id>=0. This is used for fast lookup in FunctionStack.
@@ -259,6 +281,11 @@ private:
 	void _onInstanceDataAdded(InstanceData *data);
 	void _onInstanceDataRemoved(InstanceData *data);
 
+	// Called by ClassInstance::Create(). Returns a pooled instance given to owner and registered, or nullptr if the pool is empty.
+	ClassInstance *_acquirePooledInstance(Chip *owner);
+	// Called by ClassInstance::Release(). Returns true if the instance was reset and taken by the pool.
+	bool _poolInstance(ClassInstance *instance);
+
 	virtual void _onInstanceRegistered(ClassInstance *instance) {}
 	virtual void _onInstanceUnregistered(ClassInstance *instance) {}
 
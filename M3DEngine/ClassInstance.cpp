@@ -35,7 +35,7 @@ using namespace m3d;
 
 std::atomic<ClassInstanceID> runtimeIDs = 0;
 
-ClassInstance::ClassInstance(const Guid &id, const Guid &clazzid, Path filename) : _id(id), _runtimeID(++runtimeIDs), _owner(nullptr), _clazz(nullptr), _delayDestruction(false), _releaseCallback(nullptr)
+ClassInstance::ClassInstance(const Guid &id, const Guid &clazzid, Path filename) : _id(id), _runtimeID(++runtimeIDs), _owner(nullptr), _clazz(nullptr), _delayDestruction(false), _releaseCallback(nullptr), _pooled(false)
 {
 	_serialization = mmnew ClassInstanceSerialization();
 	_serialization->clazzid = clazzid;
@@ -43,7 +43,7 @@ ClassInstance::ClassInstance(const Guid &id, const Guid &clazzid, Path filename)
 	_serialization->atManager = false;
 }
 
-ClassInstance::ClassInstance(const Guid &id, const Guid & clazzid, Path filename, ChipPtrByGUIDMap &&data, Chip *owner, String name) : _id(id), _runtimeID(++runtimeIDs), _owner(owner), _clazz(nullptr), _delayDestruction(false), _name(name), _releaseCallback(nullptr)
+ClassInstance::ClassInstance(const Guid &id, const Guid & clazzid, Path filename, ChipPtrByGUIDMap &&data, Chip *owner, String name) : _id(id), _runtimeID(++runtimeIDs), _owner(owner), _clazz(nullptr), _delayDestruction(false), _name(name), _releaseCallback(nullptr), _pooled(false)
 {
 	assert(owner);
 	_serialization = mmnew ClassInstanceSerialization();
@@ -53,7 +53,7 @@ ClassInstance::ClassInstance(const Guid &id, const Guid & clazzid, Path filename
 	_serialization->atManager = false;
 }
 
-ClassInstance::ClassInstance(Class *cg, Chip *owner) : _runtimeID(++runtimeIDs), _clazz(cg), _owner(owner), _serialization(nullptr), _delayDestruction(false), _releaseCallback(nullptr)
+ClassInstance::ClassInstance(Class *cg, Chip *owner) : _runtimeID(++runtimeIDs), _clazz(cg), _owner(owner), _serialization(nullptr), _delayDestruction(false), _releaseCallback(nullptr), _pooled(false)
 {
 	assert(cg);
 	assert(owner);
@@ -61,7 +61,13 @@ ClassInstance::ClassInstance(Class *cg, Chip *owner) : _runtimeID(++runtimeIDs),
 	_initInstanceData(_clazz); // create our instance data!
 }
 
-ClassInstance::ClassInstance(ClassInstance *original, Chip *ownerOfNewInstance) : _runtimeID(++runtimeIDs), _clazz(original->_clazz), _owner(ownerOfNewInstance), _serialization(nullptr), _delayDestruction(false), _releaseCallback(nullptr)
+ClassInstance::ClassInstance(Class *cg) : _id(NullGUID), _runtimeID(0), _clazz(cg), _owner(nullptr), _serialization(nullptr), _delayDestruction(false), _releaseCallback(nullptr), _pooled(true)
+{
+	assert(cg);
+	_initInstanceData(_clazz); // The data is owned by the instance data templates until we are reused.
+}
+
+ClassInstance::ClassInstance(ClassInstance *original, Chip *ownerOfNewInstance) : _runtimeID(++runtimeIDs), _clazz(original->_clazz), _owner(ownerOfNewInstance), _serialization(nullptr), _delayDestruction(false), _releaseCallback(nullptr), _pooled(false)
 {
 	GenerateGuid(_id);
 	if (original->_serialization) {
@@ -106,7 +112,7 @@ ClassInstance::ClassInstance(ClassInstance *original, Chip *ownerOfNewInstance)
 
 ClassInstance::~ClassInstance()
 {
-	if (_clazz)
+	if (_clazz && !_pooled)
 		_clazz->UnregisterInstance(this);
 
 	for (const auto &n : _instanceData)
@@ -127,6 +133,8 @@ void ClassInstance::Release() const
 	if (_ref.empty()) {
 		if (_releaseCallback)
 			_releaseCallback->OnRelease((ClassInstance*)this);
+		if (_clazz && !_serialization && !_delayDestruction && _clazz->_poolInstance((ClassInstance*)this))
+			return;
 		return mmdelete(this);
 	}
 	while (_ref.size() > 1)
@@ -206,9 +214,11 @@ void ClassInstance::_addInstanceData(InstanceData *instanceData)
 		msg(WARN, MTEXT("Failed to add instance data (") + instanceData->GetName() + MTEXT(")."), _owner);
 		return; 
 	}
-	assert(_owner && _owner->GetClass());
-	data->SetClass(_owner->GetClass());
-	data->SetOwner(_owner);
+	if (_owner) { // No owner if we are created for the pool. Then the template stays owner.
+		assert(_owner->GetClass());
+		data->SetClass(_owner->GetClass());
+		data->SetOwner(_owner);
+	}
 	_instanceData.insert(std::make_pair(instanceData, data));
 }
 
@@ -229,7 +239,12 @@ ClassInstanceRef ClassInstance::Create(Class *cg, Chip *owner)
 	assert(cg);
 	assert(owner);
 
-	ClassInstance *instance = mmnew ClassInstance(cg, owner);
+	ClassInstance *instance = cg->_acquirePooledInstance(owner);
+	if (instance)
+		return ClassInstanceRef(instance, true);
+
+	instance = mmnew ClassInstance(cg, owner);
+	cg->_instancePool.OnCreated();
 	if (cg->RegisterInstance(instance))
 		return ClassInstanceRef(instance, true);
 	mmdelete(instance);
@@ -274,6 +289,44 @@ bool ClassInstance::_deserialize()
 	return true;
 }
 
+bool ClassInstance::_recycle()
+{
+	assert(!_serialization);
+	assert(_ref.empty());
+
+	// Resetting the data chips we already have is far cheaper than creating them again, but only the chip knows what it
+	// holds besides what CopyChip() sets. Chips not supporting it make us be destroyed instead.
+	for (const auto &n : _instanceData) {
+		Chip *t = n.first->GetTemplate();
+		if (!t || !n.second || n.second->GetChipDesc().type != t->GetChipDesc().type)
+			return false; // The type of the instance data has changed.
+		// The old owner may be deleted while we are in the pool. The template owns the data until we are reused.
+		n.second->SetOwner(n.first);
+		n.second->SetClass(n.first->GetClass());
+		n.second->ClearMessages();
+		if (!n.second->OnInstanceRecycled(t))
+			return false;
+		n.second->SetUpdateStamp(); // Not the data seen by whoever used us before!
+		n.second->SetChildProvider(t);
+		n.second->GetRefreshManager().Reset();
+	}
+	_owner = nullptr;
+	_name.clear();
+	_releaseCallback = nullptr;
+	return true;
+}
+
+void ClassInstance::_reuse(Chip *owner)
+{
+	assert(_pooled);
+	assert(owner);
+	// We get a new identity so that references saved to the previous one are not resolved to us.
+	GenerateGuid(_id);
+	_runtimeID = ++runtimeIDs;
+	_pooled = false;
+	SetOwner(owner);
+}
+
 void ClassInstance::CompleteLoading(bool changeID)
 {
 	assert(_serialization);
@@ -380,6 +433,13 @@ void ClassInstance::SetDelayDestruction(bool b)
 		Release();
 }
 
+uint64 ClassInstance::GetMemoryUsage() const
+{
+	// Nodes of the std::map/set are estimated to 4 pointers (including color) in addition to the value.
+	const uint64 NODE_SIZE = 4 * sizeof(void*);
+	return sizeof(ClassInstance) + _name.capacity() + _instanceData.size() * (NODE_SIZE + sizeof(ChipPtrByInstanceDataPtrMap::value_type)) + _ref.size() * (NODE_SIZE + sizeof(ClassInstanceRef*)) + (_serialization ? sizeof(ClassInstanceSerialization) : 0);
+}
+
 void ClassInstance::SetName(String name)
 {
 	if (_name == name)
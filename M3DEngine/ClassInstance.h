@@ -91,6 +91,8 @@ protected:
 	bool _delayDestruction;
 	// Callback for release notification. Used by editor.
 	ClassInstanceReleaseCallback *_releaseCallback;
+	// true while kept in the instance pool of our class. We are not registered at the class then!
+	bool _pooled;
 
 	// Internal!
 	void _initInstanceData(Class *clazz, ChipPtrByGUIDMap *fromSerialization = nullptr);
@@ -104,6 +106,10 @@ protected:
 	void _removeRef(ClassInstanceRef *ref);
 	// Called by ClassInstanceRef only!
 	bool _deserialize();
+	// Called by Class when we are put in the pool. Resets our data to the instance data templates. Returns false if not possible.
+	bool _recycle();
+	// Called by Class when we are taken from the pool. Gives us a new identity and owner.
+	void _reuse(Chip *owner);
 
 	// Creates a serialized instance (refOnly).
 	ClassInstance(const Guid &id, const Guid &clazzid, Path filename);
@@ -111,14 +117,16 @@ protected:
 	ClassInstance(const Guid &id, const Guid &clazzid, Path filename, ChipPtrByGUIDMap &&data, Chip *owner, String name);
 	// Creates the instance. Is the Create()-method!
 	ClassInstance(Class *clazz, Chip *owner);
+	// Creates an instance for the pool of the given class. It has no owner until reused.
+	ClassInstance(Class *clazz);
 	// Clone!
 	ClassInstance(ClassInstance *original, Chip *ownerOfNewInstance);
 public:
 	// Use Release() instead of mmdelete!
 	~ClassInstance();
-	// Creates an instance of the given class.
+	// Creates an instance of the given class. Takes one from the pool of the class if possible.
 	static ClassInstanceRef Create(Class *clazz, Chip *owner);
-	// Call on destruction! This will clear all references to us!
+	// Call on destruction! This will clear all references to us! We may be kept in the pool of our class instead of being deleted.
 	void Release() const;
 	// Makes a clone of this instance.
 	ClassInstanceRef Clone(Chip *ownerOfNewInstance);
@@ -157,6 +165,8 @@ public:
 	void RestoreChip();
 	void AddDependencies(ProjectDependencies &deps);
 	Chip *FindChip(ChipID chipID);
+	// Approximate number of bytes of host memory used by the instance itself, not counting the chips holding its data.
+	uint64 GetMemoryUsage() const;
 
 };
 
@@ -27,6 +27,7 @@
 #include "Engine.h"
 #include "ClassInstance.h"
 #include "ClassInstanceRef.h"
+#include "Chip.h"
 #include "DocumentManager.h"
 #include "Document.h"
 
@@ -35,14 +36,17 @@ using namespace m3d;
 
 
 
-ClassManager::ClassManager() : _clazzStart(nullptr), _factory(&DefaultClassFactory), _eventListener(nullptr)
+ClassManager::ClassManager() : _clazzStart(nullptr), _factory(&DefaultClassFactory), _eventListener(nullptr), _memoryCollector(memoryTracker())
 {
+	memoryTracker().SetCollector([this]() { CollectMemoryUsage(); });
 }
 
 ClassManager::~ClassManager()
 {
 	msg(DINFO, MTEXT("ClassManager::~ClassManager() called."));
 
+	memoryTracker().SetCollector(nullptr);
+
 	assert(_clazzByName.empty());
 	assert(_clazzByGuid.empty());
 	assert(_clazzById.empty());
@@ -432,3 +436,8 @@ ClassInstance *ClassManager::FindInstance(ClassInstanceID instanceID, ClassID cg
 
 	return nullptr;
 }
+
+void ClassManager::CollectMemoryUsage()
+{
+	_memoryCollector.Collect(_clazzById);
+}
@@ -28,6 +28,8 @@
 #include "M3DCore/Containers.h"
 #include "M3DCore/GuidUtil.h"
 #include "M3DCore/Path.h"
+#include "M3DCore/MemoryTracker.h"
+#include "MemoryUsageCollector.h"
 #include "Class.h"
 
 
@@ -121,6 +123,10 @@ public:
 	// Searches for an instance. ClassID is optional.
 	ClassInstance *FindInstance(ClassInstanceID instanceID, ClassID clazzID = InvalidClassID);
 
+	// Measures the memory used by all classes, their instances and chips, and updates the MemoryTracker.
+	// This is the collector of the memory tracker, called when a snapshot is taken.
+	void CollectMemoryUsage();
+
 private:
 	// The factory used when creating classes!
 	ClassFactory *_factory;
@@ -139,6 +145,8 @@ private:
 	ClassManagerEventListener *_eventListener;
 
 	Set<Class*> _classesBeingLoaded;
+	// Remembers the tags set by the last call to CollectMemoryUsage().
+	MemoryUsageCollector _memoryCollector;
 
 	bool _confirmNameAndGuid(String &name, Guid &guid);
 	void _addClazz(Class *clazz);
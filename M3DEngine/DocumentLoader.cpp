@@ -55,6 +55,24 @@ bool DocumentLoader::_init()
 	if (_version < Version(1,1,0,1))
 		return true; // TODO: Remove this check!
 
+	if (_version > Version(1, 2, 7, 0) && EnterGroup(DocumentTags::Blobs)) {
+		uint32 count = 0;
+		DataBuffer tmp;
+		check(LoadData(MTEXT("count"), count), goto lFail, FATAL, MTEXT("Failed to read the number of blobs in data group Document/Blobs."));
+		for (uint32 i = 0; i < count; i++) {
+			uint64 hash = 0;
+			uint32 size = 0;
+			check(EnterGroup(DocumentTags::Data, DocumentTags::id, strUtils::fromNum(i)), goto lFail, FATAL, MTEXT("Failed to find blob in data group Document/Blobs."));
+			check(LoadData(MTEXT("hash"), hash) && LoadData(MTEXT("size"), size), goto lFail, FATAL, MTEXT("Failed to read blob in data group Document/Blobs."));
+			if (tmp.getBufferSize() < size)
+				tmp.realloc(size);
+			check(LoadData(MTEXT("data"), (void*)tmp.getBuffer(), size), goto lFail, FATAL, MTEXT("Failed to read blob in data group Document/Blobs."));
+			check(LeaveGroup(DocumentTags::Data), goto lFail, FATAL, MTEXT("Failed to leave data group Document/Blobs/Data."));
+			_blobs[hash] = DataBuffer::createShared(tmp.getConstBuffer(), size); // Equal content already in memory (eg from another document) is reused!
+		}
+		check(LeaveGroup(DocumentTags::Blobs), goto lFail, FATAL, MTEXT("Failed to leave data group Document/Blobs."));
+	}
+
 	check(EnterGroup(DocumentTags::Chips), return false, FATAL, MTEXT("Could not find the list of chips used in the document (Document/Chips)."));
 
 	while (EnterGroup(DocumentTags::Chip)) { // While we have chips in the list.
@@ -90,6 +108,15 @@ void DocumentLoader::lmsg(MessageSeverity severity, String message, const Chip *
 	msg(severity, message, chip); // TODO: Remove!
 }
 
+bool DocumentLoader::GetBlob(uint64 hash, DataBuffer &data) const
+{
+	auto itr = _blobs.find(hash);
+	if (itr == _blobs.end())
+		return false;
+	data = itr->second;
+	return true;
+}
+
 Version DocumentLoader::GetChipTypeVersion(const Guid &type) const
 {
 	if (_version < Version(1,1,0,1))
@@ -283,6 +310,13 @@ bool DocumentLoader::LoadClass(Class **cg, Document *doc)
 	check(LeaveGroup(DocumentTags::Inheritance), goto lFail, FATAL, MTEXT("Failed to leave data group Document/Class/Inheritance."));
 
 lSkipInheritance:
+	{
+		uint32 poolPolicy = (uint32)InstancePoolPolicy::NONE, poolCapacity = (*cg)->GetInstancePoolCapacity();
+		check(LoadData(MTEXT("instancePoolPolicy"), poolPolicy, true) && LoadData(MTEXT("instancePoolCapacity"), poolCapacity, true) && poolPolicy <= (uint32)InstancePoolPolicy::ADAPTIVE, poolPolicy = (uint32)InstancePoolPolicy::NONE, WARN, MTEXT("Failed reading the instance pool settings. Pooling is disabled."));
+		(*cg)->SetInstancePoolCapacity(poolCapacity);
+		(*cg)->SetInstancePoolPolicy((InstancePoolPolicy)poolPolicy);
+	}
+
 	check(LoadChips(*cg, &(*cg)->GetLoadInfo()->instances),, WARN, MTEXT("Failed to load chips."));
 	check((*cg)->LoadEditorData(*this),, WARN, MTEXT("Failed loading editor data."));
 	
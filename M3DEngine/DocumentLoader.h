@@ -27,6 +27,7 @@
 #include "M3DCore/GuidUtil.h"
 #include "M3DCore/Containers.h"
 #include "M3DCore/Path.h"
+#include "M3DCore/DataBuffer.h"
 #include "DocumentTags.h"
 #include "Function.h"
 #include "Class.h"
@@ -49,7 +50,6 @@ struct LoadDataT<T*>
 };
 
 class ClassFactory;
-class DataBuffer;
 
 struct FunctionMeta
 {
@@ -107,6 +107,7 @@ typedef Map<ChipID, ConnectionMap> ConnectionMapByChipIDMap;
 typedef Map<ChipID, FunctionDesc> FunctionDescByChipIDMap;
 typedef Map<Shortcut*, Guid> ShortcutPtrByGUIDMap;
 typedef Map<Guid, Version> GUIDByVersionMap;
+typedef Map<uint64, DataBuffer> DataBufferByHashMap;
 typedef List<LMsg> LMsgList;
 
 
@@ -135,6 +136,8 @@ private:
 	Version _version;
 	// The version of the chip types loaded.
 	GUIDByVersionMap _chipVersions;
+	// Large data referenced by content hash (Document/Blobs). These are shared buffers.
+	DataBufferByHashMap _blobs;
 
 	bool _readAttr;
 	DocumentTags::Tag _attrTag;
@@ -185,6 +188,8 @@ public:
 
 	Version GetDocumentVersion() const { return _version; }
 	Version GetChipTypeVersion(const Guid &type) const;
+	// Gets data stored in the blob section of the document. The data is shared with all other buffers of equal content.
+	bool GetBlob(uint64 hash, DataBuffer &data) const;
 
 	// Searches for classes and return a list of clazz-names.
 	bool SearchForClasses(ClassMetaList& classList, bool includeFunctions);
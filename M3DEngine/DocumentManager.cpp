@@ -31,6 +31,8 @@
 #include "Engine.h"
 #include "ClassManager.h"
 #include "Environment.h"
+#include "M3DCore/MemoryTracker.h"
+#include <filesystem>
 
 
 using namespace m3d;
@@ -469,8 +471,15 @@ std::shared_ptr<DocumentManager::LoadTask> DocumentManager::_getLoadTask(Path fi
 
 		loader->SetLoadRelatedDocumentsAsync(true); // Let us also load the base graphs right away!
 
+		// The document data is held by the loader until it is freed.
+		std::error_code ec;
+		uint64 fileSize = std::filesystem::file_size(lt->fileName.AsString(), ec);
+		TrackedAllocation documentData(memoryTracker(), memoryTracker().GetTag(MemorySubsystem::DOCUMENTS));
+
 		// Load cg using the loader.
 		if (loader->OpenFile(lt->fileName)) {
+			documentData.Set(ec ? 0 : fileSize);
+
 			doc = mmnew Document(engine->GetClassManager()->GetClassFactory());
 			doc->SetFileName(lt->fileName);
 
@@ -484,6 +493,7 @@ std::shared_ptr<DocumentManager::LoadTask> DocumentManager::_getLoadTask(Path fi
 			msg(FATAL, MTEXT("Failed to open document \'") + lt->fileName.AsString() + MTEXT("\'. Failed on loading."));
 
 		DocumentFileTypes::Free(loader);
+		documentData.Set(0);
 
 	//	msg(INFO, String(MTEXT("Ending load at thread %1.")).arg(String::fromNum((uint32)GetCurrentThreadId())));
 
@@ -108,6 +108,11 @@ bool m3d::DeserializeDocumentData(DocumentLoader &loader, Chip *&chip)
 
 bool m3d::SerializeDocumentData(DocumentSaver &saver, const DataBuffer &data)
 {
+	uint64 blob = 0;
+	if (data.getBufferSize() >= BLOB_SIZE_LIMIT && saver.AddBlob(data, blob)) {
+		SAVE(MTEXT("blob"), blob); // Stored once in Document/Blobs.
+		return true;
+	}
 	SAVE(MTEXT("size"), (uint32)data.getBufferSize());
 	if (data.getBufferSize())
 		SAVEARRAY(MTEXT("data"), (void*)data.getConstBuffer(), (uint32)data.getBufferSize());
@@ -118,6 +123,11 @@ bool m3d::DeserializeDocumentData(DocumentLoader &loader, DataBuffer &data)
 {
 	uint32 size = 0;
 	data.clear();
+	if (loader.GetDocumentVersion() > Version(1, 2, 7, 0)) {
+		uint64 blob = 0;
+		if (loader.LoadData(MTEXT("blob"), blob))
+			return loader.GetBlob(blob, data);
+	}
 	LOAD(MTEXT("size"), size);
 	if (size == 0)
 		return true;
@@ -30,9 +30,44 @@
 #include "Engine.h"
 #include "ChipManager.h"
 #include "Environment.h"
+#include "M3DCore/DataBuffer.h"
+#include "M3DCore/SlimRWLock.h"
 
 using namespace m3d;
 
+namespace m3d
+{
+	struct DocumentBlobStore
+	{
+		SlimRWLock lock;
+		Map<uint64, DataBuffer> blobs;
+	};
+}
+
+DocumentSaver::DocumentSaver() : _chipSaver(false), _saveEditorData(true), _useMultithreading(true), _compression(DocumentCompressionLevel::DCL_NONE), _writeAttr(false), _attrTag((DocumentTags::Tag)0), _currentChip(nullptr), _blobs(std::make_shared<DocumentBlobStore>())
+{
+}
+
+DocumentSaver::DocumentSaver(DocumentSaver *parent) : _chipSaver(true), _saveEditorData(parent->_saveEditorData), _useMultithreading(false), _compression(parent->_compression), _writeAttr(false), _attrTag((DocumentTags::Tag)0), _currentChip(nullptr), _blobs(parent->_blobs)
+{
+}
+
+DocumentSaver::~DocumentSaver()
+{
+}
+
+bool DocumentSaver::AddBlob(const DataBuffer &data, uint64 &hash)
+{
+	hash = data.getHash();
+	SlimWLockBlock lock(_blobs->lock);
+	auto itr = _blobs->blobs.find(hash);
+	if (itr != _blobs->blobs.end())
+		return itr->second == data; // Same hash, different content: Write inline!
+	// Shared data is kept alive by a reference. Other data is owned by the chip being saved, and is not touched until we are done.
+	_blobs->blobs.insert(std::make_pair(hash, data.isShared() ? data : DataBuffer(data.getConstBuffer(), data.getBufferSize(), nullptr)));
+	return true;
+}
+
 bool DocumentSaver::_finalize()
 {
 	GUIDByVersionMap chipTypes;
@@ -67,6 +102,23 @@ bool DocumentSaver::_finalize()
 	}
 	ok = ok && PopGroup(DocumentTags::Chips);
 
+	// Write the data referenced by content hash. The map keeps them sorted by hash, so the output is the same no matter the order the chips were saved in.
+	if (!_blobs->blobs.empty()) {
+		ok = ok && PushGroup(DocumentTags::Blobs);
+		ok = ok && SaveData(MTEXT("count"), (uint32)_blobs->blobs.size());
+		uint32 i = 0;
+		for (const auto &n : _blobs->blobs) {
+			ok = ok && PushGroup(DocumentTags::Data);
+			ok = ok && SetAttribute(DocumentTags::id, strUtils::fromNum(i++));
+			ok = ok && SaveData(MTEXT("hash"), n.first);
+			ok = ok && SaveData(MTEXT("size"), (uint32)n.second.getBufferSize());
+			ok = ok && SaveData(MTEXT("data"), (const void*)n.second.getConstBuffer(), (uint32)n.second.getBufferSize());
+			ok = ok && PopGroup(DocumentTags::Data);
+		}
+		ok = ok && PopGroup(DocumentTags::Blobs);
+		_blobs->blobs.clear();
+	}
+
 	return true;
 }
 
@@ -129,6 +181,12 @@ bool DocumentSaver::SaveClass(Class *cg)
 		ok = ok && PopGroup(DocumentTags::Inheritance);
 	}
 
+	// Instance pooling. Nothing is written for the default policy.
+	if (cg->GetInstancePoolPolicy() != InstancePoolPolicy::NONE) {
+		ok = ok && SaveData(MTEXT("instancePoolPolicy"), (uint32)cg->GetInstancePoolPolicy());
+		ok = ok && SaveData(MTEXT("instancePoolCapacity"), cg->GetInstancePoolCapacity());
+	}
+
 	ok = ok && SaveChips(cg->GetChips());
 	ok = ok && cg->SaveEditorData(*this);
 	ok = ok && PopGroup(DocumentTags::Class);
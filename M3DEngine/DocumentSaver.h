@@ -37,6 +37,7 @@ namespace m3d
 {
 
 class DataBuffer;
+struct DocumentBlobStore;
 
 template<typename T>
 struct SaveDataT
@@ -84,11 +85,12 @@ private:
 	DocumentTags::Tag _attrTag;
 	// The Chip currently being loaded. (Pr thread variable)
 	Chip *_currentChip;
+	// Large data stored by content hash. Shared with the chip-savers.
+	std::shared_ptr<DocumentBlobStore> _blobs;
 
 protected:
-	DocumentSaver() : _chipSaver(false), _saveEditorData(true), _useMultithreading(true), _compression(DocumentCompressionLevel::DCL_NONE), _writeAttr(false), _attrTag((DocumentTags::Tag)0), _currentChip(nullptr) {}
-
-	DocumentSaver(DocumentSaver *parent) : _chipSaver(true), _saveEditorData(parent->_saveEditorData), _useMultithreading(false), _compression(parent->_compression), _writeAttr(false), _attrTag((DocumentTags::Tag)0), _currentChip(nullptr) {}
+	DocumentSaver();
+	DocumentSaver(DocumentSaver *parent);
 
 	bool _finalize();
 
@@ -97,7 +99,7 @@ protected:
 	inline ChipTypeIndexSet &GetChipTypes() { return _chipTypes; }
 
 public:
-	virtual ~DocumentSaver() { }
+	virtual ~DocumentSaver();
 
 	// true if we are to save editor data like formatting, comments, shortcuts etc. 
 	// Chips can use this flag to skip saving stuff not neccessary outside the editor (eg. shader source code)
@@ -127,6 +129,9 @@ public:
 
 	bool AddInstance(const Guid &instanceID);
 
+	// Adds data to the blob section of the document. hash is the reference to write. Returns false if the data can not be stored as a blob (hash collision).
+	bool AddBlob(const DataBuffer &data, uint64 &hash);
+
 
 //	Class *GetCurrentClass() const { return _currentClazz; }
 	Chip *GetCurrentChip() const { return _currentChip; } 
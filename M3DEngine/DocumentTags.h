@@ -25,6 +25,8 @@
 
 // For XML only. When storing large arrays (eg float32*) this is the size of the array before we switch to base64 to help performance!
 #define ARRAY_LIMIT_BEFORE_BASE64 (uint32)1000
+// DataBuffers of at least this size are stored once in Document/Blobs and referenced by content hash.
+#define BLOB_SIZE_LIMIT (size_t)4096
 
 
 namespace m3d
@@ -68,6 +70,7 @@ namespace DocumentTags
 		Classes,
 		Parameters,
 		Content,
+		Blobs, // Large data shared by content hash. (1.2.8.0)
 		name = 32, // Attributes from 32-63
 		startclassid,
 		startchipid,
@@ -127,8 +130,8 @@ namespace DocumentTags
 		MTEXT("Profile"),
 		MTEXT("Classes"),
 		MTEXT("Parameters"),
-		MTEXT("Content")
-		,MTEXT(""),
+		MTEXT("Content"),
+		MTEXT("Blobs"),
 		MTEXT("name"),
 		MTEXT("startclassid"),
 		MTEXT("startchipid"),
@@ -192,8 +195,8 @@ namespace DocumentTags
 		MTEXT("profile"),
 		MTEXT("classes"),
 		MTEXT("parameters"),
-		MTEXT("content")
-		,MTEXT(""),
+		MTEXT("content"),
+		MTEXT("blobs"),
 		MTEXT("name"),
 		MTEXT("startClassId"),
 		MTEXT("startChipId"),
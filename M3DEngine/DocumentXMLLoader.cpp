@@ -356,14 +356,9 @@ bool DocumentXMLLoader::ReadData(int8 *data, uint32 size)
 	if (!c)
 		return false;
 
-	bool ok = true;
-	int16 f;
 	uint32 count = 0;
-	for (Char *co = 0, *token = strtok_s((Char*)c, MTEXT(" "), &co); token; token = strtok_s(0, MTEXT(" "), &co), count++) {
-		if (!(ok = (strUtils::toNum(String(token), f) && count < size)))
-			break;
-		data[count] = (int8)f;
-	}
+	const Char *str = (const Char*)c;
+	bool ok = strUtils::forEachNum<int16>(str, str + std::strlen(str), [&](int16 f) { if (count == size) return false; data[count++] = (int8)f; return true; }, MTEXT(""));
 	xmlFree(c);
 	return ok && size == count;
 }
@@ -378,14 +373,9 @@ bool DocumentXMLLoader::ReadData(uint8 *data, uint32 size)
 	if (!c)
 		return false;
 
-	bool ok = true;
-	uint16 f;
 	uint32 count = 0;
-	for (Char*co = 0, *token = strtok_s((Char*)c, MTEXT(" "), &co); token; token = strtok_s(0, MTEXT(" "), &co), count++) {
-		if (!(ok = (strUtils::toNum(String(token), f) && count < size)))
-			break;
-		data[count] = (uint8)f;
-	}
+	const Char *str = (const Char*)c;
+	bool ok = strUtils::forEachNum<uint16>(str, str + std::strlen(str), [&](uint16 f) { if (count == size) return false; data[count++] = (uint8)f; return true; }, MTEXT(""));
 	xmlFree(c);
 	return ok && size == count;
 }
@@ -440,14 +430,10 @@ bool DocumentXMLLoader::_readData(T *data, uint32 size)
 	if (!c)
 		return false;
 
-	bool ok = true;
-	T f;
+	// Parse the numbers in place. No strings per number!
 	uint32 count = 0;
-	for (Char *co = 0, *token = strtok_s((Char*)c, MTEXT(" "), &co); token; token = strtok_s(0, MTEXT(" "), &co), count++) {
-		if (!(ok = (strUtils::toNum(String(token), f) && count < size)))
-			break;
-		data[count] = f;
-	}
+	const Char *str = (const Char*)c;
+	bool ok = strUtils::forEachNum<T>(str, str + std::strlen(str), [&](T f) { if (count == size) return false; data[count++] = f; return true; }, MTEXT(""));
 	xmlFree(c);
 	return ok && size == count;
 }
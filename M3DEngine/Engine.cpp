@@ -31,6 +31,10 @@
 #include "Application.h"
 #include "M3DCore/PlatformDef.h"
 #include "M3DCore/HighPrecisionTimer.h"
+#include "M3DCore/MessageLog.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "M3DCore/Clock.h"
 #include "Environment.h"
 #include <fstream>
 #include <mutex>
@@ -45,14 +49,19 @@ namespace m3d
 {
 struct EngineImpl
 {
-	// CS for adding messages. (keep it on top to make it be destroyed last!)
+	// CS for the message file and application, used by the message writer thread. (keep it on top to make it be destroyed last!)
 	std::mutex csMsg;
 	// Class internal only
 	std::wofstream msgfile;
-	// Manager keeping track of d3d-stuff.
-	Graphics* graphics = nullptr;
 	// Application environment.
 	Application* application = nullptr;
+	// This is the lowest message severity reported.
+	MessageSeverity vsDbgLevel = DINFO;
+	// Messages are posted here, and written to file and application by its writer thread.
+	// Declared after what the writer uses, and before anything that might post messages when destroyed.
+	MessageLog log{ [this](const MessageRecord *records, size_t count) { WriteMessages(records, count); } };
+	// Manager keeping track of d3d-stuff.
+	Graphics* graphics = nullptr;
 	// Mananger keeping track of documents.
 	DocumentManager dm;
 	// Manager keeping track of chips.
@@ -75,16 +84,14 @@ struct EngineImpl
 	int64 appTimeStoppedTime = 0;
 	// Time to substract from the timer.
 	int64 appTimeSubTime = 0;
-	// This is the lowest message severity reported.
-	MessageSeverity vsDbgLevel = DINFO;
 	// This is the current frame number. Incremented for every new frame.
 	uint32 frameNr = 0;
 	// This is a timestamp set at the beginning of a new frame using the GetClockTime() function.
 	int32 frameTime = 0;
-	// The time when the frame time was stopped.
-	int32 frameTimeStoppedTime = -1;
-	// Time to substract from clock() function.
-	int32 frameTimeSub = 0;
+	// The time (Clock::GetTime_ns()) when the frame time was stopped.
+	int64 frameTimeStoppedTime = -1;
+	// Time to substract from Clock::GetTime_ns(). Starts at the creation of the engine, and grows by the time stopped.
+	int64 frameTimeSub = Clock::GetTime_ns();
 	// The directory for 3rd-party dependencies
 	Path thirdDir;
 	// The command line arguments set when starting the viewer.
@@ -95,10 +102,64 @@ struct EngineImpl
 	EditMode editMode = EditMode::EM_EDIT_RUN;
 	//
 	bool isRunning = false;
+	// Run with the null graphics engine. See Engine::SetHeadless().
+	bool headless = false;
+	// Fixed time step in microseconds. 0 to use the measured frame interval.
+	int64 fixedTimestep = 0;
+
+	// Called by the message writer thread.
+	void WriteMessages(const MessageRecord *records, size_t count);
 };
 }
 
 
+void EngineImpl::WriteMessages(const MessageRecord *records, size_t count)
+{
+	static const Char *MSG[6] = {MTEXT(" - DEBUG: "), MTEXT(" - INFO: "), MTEXT(" - NOTICE: "), MTEXT(" - WARNING: "), MTEXT(" - FATAL: "), MTEXT(" - ")};
+
+	std::unique_lock<std::mutex> cb(csMsg);
+
+	String s;
+	List<ApplicationMessage> msgs;
+	if (application)
+		msgs.reserve(count);
+
+	for (size_t i = 0; i < count; i++) {
+		const MessageRecord &r = records[i];
+		MessageSeverity severity = (MessageSeverity)std::min(r.severity, (uint32)ALWAYS);
+
+		if (severity >= vsDbgLevel) {
+			Char buff[64];
+
+			tm tt;
+			localtime_s(&tt, &r.timestamp);
+
+			strftime(buff, 64, MTEXT("%d/%m/%y %H:%M:%S"), &tt);
+
+			String line = String(buff) + strUtils::format(MTEXT(" [% 5i]"), r.threadID) + MSG[severity] + r.message + MTEXT("\n");
+
+#if defined( DEBUG ) || defined( _DEBUG )
+			OutputDebugStringA(line.c_str()); // Also try writing to output window in Visual Studio. NOTE: OutputDebugStringA is not allowed when submitting app to AppStore!!
+#endif
+			s += line;
+		}
+
+		if (application) {
+			ApplicationMessage msg = { severity, r.timestamp, r.threadID, r.message, r.clazzID, r.chipID };
+			msgs.push_back(msg);
+		}
+	}
+
+	if (msgfile.is_open() && !s.empty()) {
+		msgfile << s.c_str();
+		msgfile.flush();
+	}
+
+	if (application && !msgs.empty())
+		application->MessagesAdded(msgs.data(), msgs.size());
+}
+
+
 bool Engine::Create()
 {
 	if (engine)
@@ -140,7 +201,10 @@ bool Engine::Init(Application *application, Path chipDir, Path thirdDir, const L
 {
 	assert(application != nullptr);
 
-	_impl->application = application;
+	{
+		std::unique_lock<std::mutex> cb(_impl->csMsg);
+		_impl->application = application;
+	}
 	if (!_impl->env.Init(libDirs)) {
 		msg(WARN, MTEXT("Engine: Failed to initialize environment."));
 		return false;
@@ -182,7 +246,10 @@ bool Engine::Init(Application *application, Path chipDir, Path thirdDir, const L
 
 	static const Guid GRAPHICS_GUID = { 0x13278213, 0x8360, 0x4a1b, { 0xa8, 0x5d, 0xc7, 0x8c, 0x42, 0xb3, 0xed, 0x94 } };
 
-	Guid graphics = GRAPHICS_GUID; // The only thing to switch between the engines.
+	Guid graphics = _impl->headless ? NULLGRAPHICS_GUID : GRAPHICS_GUID; // The only thing to switch between the engines.
+
+	if (_impl->headless)
+		msg(INFO, MTEXT("Engine: Running headless with the null graphics engine."));
 
 	// Set up the graphics engine.
 	_impl->graphics = (Graphics*)_impl->cm.CreateChip(graphics);
@@ -208,6 +275,8 @@ void Engine::Clear()
 {
 	Reset();
 	SAFE_RELEASE(_impl->graphics);
+	_impl->log.Flush();
+	std::unique_lock<std::mutex> cb(_impl->csMsg);
 	_impl->application = nullptr;
 }
 
@@ -231,10 +300,16 @@ const List<String>& Engine::GetCmdLineArguments() const { return _impl->cmdLineA
 void Engine::SetCmdLineArguements(const List<String>& args) { _impl->cmdLineArguments = args; }
 EditMode Engine::GetEditMode() const { return _impl->editMode; }
 void Engine::SetEditMode(EditMode editMode) { _impl->editMode = editMode; }
+void Engine::SetHeadless(bool headless) { assert(!_impl->graphics); _impl->headless = headless; }
+bool Engine::IsHeadless() const { return _impl->headless; }
+void Engine::SetFixedTimestep(int64 dt_us) { _impl->fixedTimestep = std::max(dt_us, 0ll); }
+int64 Engine::GetFixedTimestep() const { return _impl->fixedTimestep; }
 
 
 void Engine::SetMessageFile(Path p)
 {
+	_impl->log.Flush();
+	std::unique_lock<std::mutex> cb(_impl->csMsg);
 	if (_impl->msgfile.is_open())
 		_impl->msgfile.close();
 	if (p.IsFile())
@@ -243,38 +318,12 @@ void Engine::SetMessageFile(Path p)
 
 void Engine::Message(MessageSeverity severity, String message, ClassID cgID, ChipID chipID)
 {
-	static const Char *MSG[6] = {MTEXT(" - DEBUG: "), MTEXT(" - INFO: "), MTEXT(" - NOTICE: "), MTEXT(" - WARNING: "), MTEXT(" - FATAL: "), MTEXT(" - ")};
-
-	uint32 threadID = (uint32)GetCurrentThreadId(); // todo: use standard C?? std::this_thread...
-
-	std::unique_lock<std::mutex> cb(_impl->csMsg);
-
-	time_t t = time(0);
-
-	if (severity >= _impl->vsDbgLevel) {
-		Char buff[64];
-
-		tm tt;
-		localtime_s(&tt, &t);
-
-		strftime(buff, 64, MTEXT("%d/%m/%y %H:%M:%S"), &tt);
-
-		String s = String(buff) + strUtils::format(MTEXT(" [% 5i]"), threadID) + MSG[severity] + message + MTEXT("\n");
-
-#if defined( DEBUG ) || defined( _DEBUG )
-		OutputDebugStringA(s.c_str()); // Also try writing to output window in Visual Studio. NOTE: OutputDebugStringA is not allowed when submitting app to AppStore!!
-#endif
-
-		if (_impl->msgfile.is_open()) {
-			_impl->msgfile << s.c_str();
-			_impl->msgfile.flush();
-		}
-	}
+	_impl->log.Post(severity, std::move(message), cgID, chipID);
+}
 
-	if (_impl->application) {
-		ApplicationMessage msg = { severity, t, threadID, message, cgID, chipID };
-		_impl->application->MessagedAdded(msg);
-	}
+void Engine::FlushMessages()
+{
+	_impl->log.Flush();
 }
 
 void Engine::ChipMessageAdded(Chip *chip, const ChipMessage &msg)
@@ -299,55 +348,96 @@ void Engine::Run()
 
 	_impl->isRunning = true;
 
+	int64 frameStart = Clock::GetTime_us();
+
 	_impl->timer.Tick();
 
-	_impl->dt = std::min(std::max(_impl->timer.GetDt_us(), 100ll), 500000ll); // clamp dt to 2 hz - 10000 hz
+	if (_impl->timer.GetDt_us() > 0) // Not on the first frame.
+		frameStats.Record(FrameStatsSeries::FRAME_INTERVAL, _impl->timer.GetDt_us());
+
+	if (_impl->fixedTimestep > 0)
+		_impl->dt = _impl->fixedTimestep;
+	else
+		_impl->dt = std::min(std::max(_impl->timer.GetDt_us(), 100ll), 500000ll); // clamp dt to 2 hz - 10000 hz
 	_impl->appTime += _impl->dt;
 
 	_impl->fps.NewFrame(_impl->timer.GetTime_us());
 
 	_impl->frameTime = GetClockTime();
 
+	profiler.BeginFrame(_impl->frameNr);
+
 	functionStack.StartOfFrame();
 
-	_impl->graphics->ClearState();
+	{
+		ProfilerScope ps(MTEXT("OnNewFrame"));
+
+		int64 t0 = Clock::GetTime_us();
+
+		_impl->graphics->ClearState();
+
+		int64 t1 = Clock::GetTime_us();
+
+		_impl->cm.OnNewFrame();
+
+		int64 t2 = Clock::GetTime_us();
+
+		_impl->graphics->OnNewFrame();
+
+		int64 t3 = Clock::GetTime_us();
+
+		frameStats.Record(FrameStatsSeries::CHIPS_ON_NEW_FRAME, t2 - t1);
+		frameStats.Record(FrameStatsSeries::GRAPHICS, (t1 - t0) + (t3 - t2));
+	}
+
+	{
+		ProfilerScope ps(MTEXT("ClassManager::Run"));
+
+		int64 t0 = Clock::GetTime_us();
 
-	_impl->cm.OnNewFrame();
+		GetClassManager()->Run();
+
+		frameStats.Record(FrameStatsSeries::CLASS_MANAGER_RUN, Clock::GetTime_us() - t0);
+	}
 
-	_impl->graphics->OnNewFrame();
+	{
+		ProfilerScope ps(MTEXT("PostFrame"));
 
-	GetClassManager()->Run();
+		int64 t0 = Clock::GetTime_us();
 
-	_impl->graphics->PostFrame();
+		_impl->graphics->PostFrame();
+
+		frameStats.Record(FrameStatsSeries::POST_FRAME, Clock::GetTime_us() - t0);
+	}
 
 	_impl->isRunning = false;
 
 	bool endOfFrameOK = functionStack.EndOfFrame();
 
 	assert(endOfFrameOK);
+
+	frameStats.Record(FrameStatsSeries::FRAME, Clock::GetTime_us() - frameStart);
+
+	profiler.EndFrame();
 }
 
 int32 Engine::GetClockTime() const
 {
-	if (_impl->frameTimeStoppedTime != -1)
-		return _impl->frameTimeStoppedTime - _impl->frameTimeSub + (_impl->frameTimeStoppedTime < _impl->frameTimeSub ? (std::numeric_limits<int32>::max() + 1) : 0);
-	int32 t = (int32)clock();
-	return t - _impl->frameTimeSub + (t < _impl->frameTimeSub ? (std::numeric_limits<int32>::max() + 1) : 0); // / CLOCKS_PER_SEC
+	int64 t = _impl->frameTimeStoppedTime != -1 ? _impl->frameTimeStoppedTime : Clock::GetTime_ns();
+	// Wall time, in CLOCKS_PER_SEC units like clock() on Windows. (clock() is CPU time on other platforms.)
+	return (int32)((t - _impl->frameTimeSub) / (Clock::TICKS_PER_SECOND / CLOCKS_PER_SEC));
 }
 
 void Engine::StopClockTime()
 {
 	if (_impl->frameTimeStoppedTime == -1) // Timer not stopped?
-		_impl->frameTimeStoppedTime = clock(); // Set stopped time!
+		_impl->frameTimeStoppedTime = Clock::GetTime_ns(); // Set stopped time!
 }
 
 void Engine::StartClockTime()
 {
 	if (_impl->frameTimeStoppedTime != -1) { // Stopped?
-		int32 t = (int32)clock(); // Get current time
-		_impl->frameTimeSub += t - _impl->frameTimeStoppedTime + (t < _impl->frameTimeStoppedTime ? (std::numeric_limits<int32>::max() + 1) : 0); // Get time since timer was stopped (taking possible loop into account)!
-		if (_impl->frameTimeSub < 0)
-			_impl->frameTimeSub += (std::numeric_limits<int32>::max() + 1);
+		_impl->frameTimeSub += Clock::GetTime_ns() - _impl->frameTimeStoppedTime; // Time since the timer was stopped.
 		_impl->frameTimeStoppedTime = -1; // Timer not stopped!
 	}
 }
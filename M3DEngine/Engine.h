@@ -60,7 +60,7 @@ public:
 
 	// Get the application running this thing. Qt editor, viewer, WP-viewer etc.
 	Application* GetApplication() const;
-	// Returns the graphics engine. Loaded at startup.
+	// Returns the graphics engine. Loaded at startup. The null graphics engine when running headless.
 	Graphics* GetGraphics();
 	// Returns the manager keeping track of documents.
 	DocumentManager* GetDocumentManager();
@@ -75,8 +75,10 @@ public:
 
 	// Sets the file to write debug messages to.
 	void SetMessageFile(Path p);
-	// Adds a new debug message. THREAD SAFE!
+	// Adds a new debug message. THREAD SAFE! Written to file and application asynchronously.
 	void Message(MessageSeverity severity, String message, ClassID clazzID = InvalidClassID, ChipID chipID = InvalidChipID);
+	// Blocks until the messages added so far are written to file and application.
+	void FlushMessages();
 	// Called by a chip when reporting an issue. 
 	void ChipMessageAdded(Chip *chip, const ChipMessage &msg);
 	// Called to remove a chip message.
@@ -88,7 +90,7 @@ public:
 	uint32 GetFrameNr() const;
 	// Coarse frame timer updated every time Run() is called.
 	int32 GetFrameTime() const;
-	// Used for GetFrameTime.
+	// Used for GetFrameTime. Time since the engine was created, in CLOCKS_PER_SEC units, not counting the time stopped.
 	int32 GetClockTime() const;
 	// Stops the clock timer. (To be used for break points)
 	void StopClockTime();
@@ -96,8 +98,11 @@ public:
 	void StartClockTime();
 	// Timer ticked every frame.
 	const HighPrecisionTimer& GetTimer() const;
-	// Gets frame time limited to 2 hz - 10000 hz.
+	// Gets frame time limited to 2 hz - 10000 hz, or the fixed time step if set.
 	int64 GetDt() const;
+	// Sets a fixed time step in microseconds used as dt for every frame, making runs repeatable. 0 to use the measured frame time.
+	void SetFixedTimestep(int64 dt_us);
+	int64 GetFixedTimestep() const;
 	// Gets current application time.
 	int64 GetAppTime() const;
 	// Called when normal execution is halted, eg when application loses focus, at breakpoints etc.
@@ -123,6 +128,10 @@ public:
 
 	EditMode GetEditMode() const;
 	void SetEditMode(EditMode editMode);
+	// Runs the engine with the null graphics engine, eg for benchmarks on machines without a GPU. Must be set before Init().
+	// Nothing is rendered, and chips needing a device will fail.
+	void SetHeadless(bool headless);
+	bool IsHeadless() const;
 
 	// This call will be distributed to the system to destroy all device objects. Mostly called by device itself.
 	void DestroyDeviceObjects();
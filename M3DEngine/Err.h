@@ -32,7 +32,9 @@ namespace m3d
 	// mode 0: Only message
 	// mode 1: Message box is shown
 	// mode 2: DebugBreak() is always called.
+#ifdef _WIN32
 	HRESULT M3DENGINE_API Trace(const Char *file, uint32 line, HRESULT hr, const Char *msg, int32 mode = 0); // Returns hr
+#endif
 	bool M3DENGINE_API Trace(const Char *file, uint32 line, bool b, const Char *msg, int32 mode = 0); // returns b
 
 }
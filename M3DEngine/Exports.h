@@ -25,7 +25,9 @@
 
 
 
-#ifdef M3DEngine_EXPORTS
+#if defined(M3DENGINE_STATIC)
+#define M3DENGINE_API
+#elif defined(M3DEngine_EXPORTS)
 #define M3DENGINE_API __declspec(dllexport)
 #else
 #define M3DENGINE_API __declspec(dllimport)
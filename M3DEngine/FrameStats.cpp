@@ -0,0 +1,249 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "FrameStats.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+using namespace m3d;
+
+
+FrameStats m3d::frameStats = FrameStats();
+
+
+uint32 TimeHistogram::GetBucket(int64 us)
+{
+	uint64 v = (uint64)std::clamp(us, 0ll, MAX_VALUE);
+	if (v < LINEAR_COUNT)
+		return (uint32)v;
+	uint32 msb = 63;
+	while ((v >> msb) == 0)
+		msb--;
+	uint32 shift = msb - 5; // v >> shift is in [32, 63].
+	return LINEAR_COUNT + (shift - 1) * SUB_BUCKET_COUNT + uint32((v >> shift) - SUB_BUCKET_COUNT);
+}
+
+int64 TimeHistogram::GetBucketMax(uint32 bucket)
+{
+	if (bucket < LINEAR_COUNT)
+		return bucket;
+	uint32 k = bucket - LINEAR_COUNT;
+	uint32 shift = k / SUB_BUCKET_COUNT + 1;
+	int64 m = k % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+	return ((m + 1) << shift) - 1;
+}
+
+void TimeHistogram::Add(int64 us)
+{
+	us = std::clamp(us, 0ll, MAX_VALUE);
+	_buckets[GetBucket(us)].fetch_add(1, std::memory_order_relaxed);
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sum.fetch_add(us, std::memory_order_relaxed);
+	int64 m = _max.load(std::memory_order_relaxed);
+	while (us > m && !_max.compare_exchange_weak(m, us, std::memory_order_relaxed));
+}
+
+void TimeHistogram::Remove(int64 us)
+{
+	us = std::clamp(us, 0ll, MAX_VALUE);
+	_buckets[GetBucket(us)].fetch_sub(1, std::memory_order_relaxed);
+	_count.fetch_sub(1, std::memory_order_relaxed);
+	_sum.fetch_sub(us, std::memory_order_relaxed);
+}
+
+void TimeHistogram::Clear()
+{
+	for (uint32 i = 0; i < BUCKET_COUNT; i++)
+		_buckets[i].store(0, std::memory_order_relaxed);
+	_count = 0;
+	_sum = 0;
+	_max = 0;
+}
+
+float64 TimeHistogram::GetMean() const
+{
+	uint64 c = GetCount();
+	return c ? float64(_sum.load(std::memory_order_relaxed)) / c : 0.0;
+}
+
+int64 TimeHistogram::GetPercentile(float64 percentile) const
+{
+	uint64 c = GetCount();
+	if (c == 0)
+		return 0;
+	uint64 target = std::max(1ull, (uint64)std::ceil(std::clamp(percentile, 0.0, 100.0) * 0.01 * c));
+	uint64 n = 0;
+	for (uint32 i = 0; i < BUCKET_COUNT; i++) {
+		n += _buckets[i].load(std::memory_order_relaxed);
+		if (n >= target)
+			return GetBucketMax(i);
+	}
+	return GetBucketMax(BUCKET_COUNT - 1); // Only if recorded concurrently.
+}
+
+
+// Window entries are stored in a ring, with the hitch flag in the highest bit.
+#define HITCH_BIT 0x80000000u
+#define RING_MAX_VALUE 0x7FFFFFFFll
+// Number of window values required before hitches are counted.
+#define HITCH_MIN_WINDOW 8u
+
+struct FrameStats::Series
+{
+	TimeHistogram total;
+	TimeHistogram window;
+	std::unique_ptr<std::atomic<uint32>[]> ring;
+	std::atomic<uint32> ringCount;
+	uint32 ringPos = 0;
+	std::atomic<uint64> hitches;
+	// Median of the window. Updated every 16th value.
+	int64 median = 0;
+	uint32 recordCount = 0;
+};
+
+FrameStats::FrameStats() : _series(new Series[(uint32)FrameStatsSeries::COUNT]), _windowSize(0), _hitchFactor(2.0), _hitchMinimum(5000)
+{
+	SetWindowSize(600);
+}
+
+FrameStats::~FrameStats()
+{
+}
+
+void FrameStats::SetWindowSize(uint32 frames)
+{
+	_windowSize = std::max(frames, 1u);
+	for (uint32 i = 0; i < (uint32)FrameStatsSeries::COUNT; i++) {
+		Series &s = _series[i];
+		s.ring.reset(new std::atomic<uint32>[_windowSize]);
+		for (uint32 j = 0; j < _windowSize; j++)
+			s.ring[j] = 0;
+		s.ringCount = 0;
+		s.ringPos = 0;
+		s.window.Clear();
+		s.median = 0;
+		s.recordCount = 0;
+	}
+}
+
+void FrameStats::Record(FrameStatsSeries series, int64 us)
+{
+	Series &s = _series[(uint32)series];
+	us = std::clamp(us, 0ll, RING_MAX_VALUE);
+
+	bool hitch = s.ringCount >= HITCH_MIN_WINDOW && us > _hitchMinimum && us > int64(s.median * _hitchFactor);
+	if (hitch)
+		s.hitches.fetch_add(1, std::memory_order_relaxed);
+	s.total.Add(us);
+
+	if (s.ringCount == _windowSize)
+		s.window.Remove(s.ring[s.ringPos] & ~HITCH_BIT);
+	else
+		s.ringCount++;
+	s.ring[s.ringPos].store(uint32(us) | (hitch ? HITCH_BIT : 0u), std::memory_order_relaxed);
+	s.window.Add(us);
+	s.ringPos = (s.ringPos + 1) % _windowSize;
+
+	if ((s.recordCount++ & 15) == 0)
+		s.median = s.window.GetPercentile(50.0);
+}
+
+FrameStatsReport FrameStats::GetReport(FrameStatsSeries series, bool window) const
+{
+	const Series &s = _series[(uint32)series];
+	const TimeHistogram &h = window ? s.window : s.total;
+	FrameStatsReport r;
+	r.count = h.GetCount();
+	int64 max = h.GetMax();
+	r.hitches = s.hitches;
+	if (window) {
+		max = 0;
+		r.hitches = 0;
+		for (uint32 i = 0, n = std::min(s.ringCount.load(), _windowSize); i < n; i++) {
+			uint32 v = s.ring[i].load(std::memory_order_relaxed);
+			max = std::max(max, int64(v & ~HITCH_BIT));
+			r.hitches += (v & HITCH_BIT) ? 1 : 0;
+		}
+	}
+	// Bucket bounds are capped by the max value recorded.
+	r.p50 = std::min(h.GetPercentile(50.0), max) / 1000.0;
+	r.p95 = std::min(h.GetPercentile(95.0), max) / 1000.0;
+	r.p99 = std::min(h.GetPercentile(99.0), max) / 1000.0;
+	r.max = max / 1000.0;
+	r.mean = h.GetMean() / 1000.0;
+	return r;
+}
+
+const TimeHistogram &FrameStats::GetHistogram(FrameStatsSeries series, bool window) const
+{
+	const Series &s = _series[(uint32)series];
+	return window ? s.window : s.total;
+}
+
+void FrameStats::Reset()
+{
+	for (uint32 i = 0; i < (uint32)FrameStatsSeries::COUNT; i++) {
+		_series[i].total.Clear();
+		_series[i].hitches = 0;
+	}
+	SetWindowSize(_windowSize);
+}
+
+const Char *FrameStats::GetSeriesName(FrameStatsSeries series)
+{
+	static const Char *NAMES[(uint32)FrameStatsSeries::COUNT] = { MTEXT("frameInterval"), MTEXT("frame"), MTEXT("chipsOnNewFrame"), MTEXT("graphics"), MTEXT("classManagerRun"), MTEXT("postFrame") };
+	return series < FrameStatsSeries::COUNT ? NAMES[(uint32)series] : MTEXT("");
+}
+
+static String reportToJson(const FrameStatsReport &r)
+{
+	return strUtils::format(MTEXT("{\"count\":%llu,\"p50\":%.3f,\"p95\":%.3f,\"p99\":%.3f,\"max\":%.3f,\"mean\":%.3f,\"hitches\":%llu}"), r.count, r.p50, r.p95, r.p99, r.max, r.mean, r.hitches);
+}
+
+String FrameStats::ExportJson() const
+{
+	String s = strUtils::format(MTEXT("{\"unit\":\"ms\",\"windowSize\":%u,\"hitchFactor\":%.3f,\"hitchMinimum\":%.3f,\"series\":{"), _windowSize, _hitchFactor, GetHitchMinimum());
+	for (uint32 i = 0; i < (uint32)FrameStatsSeries::COUNT; i++) {
+		FrameStatsSeries series = (FrameStatsSeries)i;
+		s += strUtils::format(MTEXT("%s\n\"%s\":{\"total\":"), i > 0 ? MTEXT(",") : MTEXT(""), GetSeriesName(series));
+		s += reportToJson(GetReport(series, false));
+		s += MTEXT(",\"window\":");
+		s += reportToJson(GetReport(series, true));
+		s += MCHAR('}');
+	}
+	s += MTEXT("\n}}\n");
+	return s;
+}
+
+bool FrameStats::ExportJson(Path file) const
+{
+	String s = ExportJson();
+	std::ofstream f(file.AsString().c_str(), std::ios::out | std::ios::binary);
+	if (!f)
+		return false;
+	f.write(s.c_str(), s.size());
+	return f.good();
+}
@@ -0,0 +1,137 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "GlobalDef.h"
+#include "M3DCore/Path.h"
+#include <atomic>
+#include <memory>
+
+
+namespace m3d
+{
+
+// Log-linear histogram of durations in microseconds. Values below 64 are exact, above that each power of two
+// is split in 32 buckets, giving about 3% resolution up to about 71 minutes.
+// Recording is lock-free, and may be read from other threads while recording.
+class M3DENGINE_API TimeHistogram
+{
+public:
+	static const uint32 LINEAR_COUNT = 64;
+	static const uint32 SUB_BUCKET_COUNT = 32;
+	static const uint32 BUCKET_COUNT = LINEAR_COUNT + 26 * SUB_BUCKET_COUNT;
+	static const int64 MAX_VALUE = 0xFFFFFFFFll;
+
+	TimeHistogram() { Clear(); }
+
+	void Add(int64 us);
+	// Removes a value previously added. Used for rolling windows. The max value is not updated.
+	void Remove(int64 us);
+	void Clear();
+
+	uint64 GetCount() const { return _count.load(std::memory_order_relaxed); }
+	int64 GetMax() const { return _max.load(std::memory_order_relaxed); }
+	float64 GetMean() const;
+	// Returns the highest value in the bucket containing the given percentile (0-100). 0 if empty.
+	int64 GetPercentile(float64 percentile) const;
+
+	static uint32 GetBucket(int64 us);
+	static int64 GetBucketMax(uint32 bucket);
+
+private:
+	std::atomic<uint32> _buckets[BUCKET_COUNT];
+	std::atomic<uint64> _count;
+	std::atomic<int64> _sum;
+	std::atomic<int64> _max;
+};
+
+
+enum class FrameStatsSeries : uint32 
+{ 
+	FRAME_INTERVAL, // Time between the start of two frames, including the time spent outside the engine.
+	FRAME, // Time spent in Engine::Run().
+	CHIPS_ON_NEW_FRAME, // ChipManager::OnNewFrame().
+	GRAPHICS, // Graphics::ClearState() and Graphics::OnNewFrame().
+	CLASS_MANAGER_RUN, // ClassManager::Run().
+	POST_FRAME, // Graphics::PostFrame().
+	COUNT 
+};
+
+// All times in milliseconds.
+struct FrameStatsReport
+{
+	uint64 count = 0;
+	float64 p50 = 0.0;
+	float64 p95 = 0.0;
+	float64 p99 = 0.0;
+	float64 max = 0.0;
+	float64 mean = 0.0;
+	uint64 hitches = 0;
+};
+
+// Collects frame and engine phase times. Each series has a histogram of all times recorded since the last reset,
+// and one of the times in a rolling window of the latest frames.
+// A time is counted as a hitch when it is longer than the hitch factor times the median of the window, and longer than the hitch minimum.
+// Recorded by the engine thread. Reports can be read from any thread.
+class M3DENGINE_API FrameStats
+{
+public:
+	FrameStats();
+	~FrameStats();
+
+	// Number of latest frames in the rolling window. Clears the window.
+	void SetWindowSize(uint32 frames);
+	uint32 GetWindowSize() const { return _windowSize; }
+	void SetHitchFactor(float64 factor) { _hitchFactor = factor; }
+	float64 GetHitchFactor() const { return _hitchFactor; }
+	void SetHitchMinimum(float64 ms) { _hitchMinimum = int64(ms * 1000.0); }
+	float64 GetHitchMinimum() const { return _hitchMinimum / 1000.0; }
+
+	// Called by Engine::Run().
+	void Record(FrameStatsSeries series, int64 us);
+
+	FrameStatsReport GetReport(FrameStatsSeries series, bool window) const;
+	const TimeHistogram &GetHistogram(FrameStatsSeries series, bool window) const;
+	void Reset();
+
+	// Machine-readable dump of all series as json.
+	String ExportJson() const;
+	bool ExportJson(Path file) const;
+
+	static const Char *GetSeriesName(FrameStatsSeries series);
+
+private:
+	struct Series;
+
+	std::unique_ptr<Series[]> _series;
+	uint32 _windowSize;
+	float64 _hitchFactor;
+	int64 _hitchMinimum;
+};
+
+extern FrameStats M3DENGINE_API frameStats;
+
+}
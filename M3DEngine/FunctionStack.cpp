@@ -28,6 +28,8 @@
 #include "Function.h" // for performance monitoring!
 #include "ClassInstance.h" // For SetDelayDestruction()
 #include "FunctionStackRecord.h"
+#include "Profiler.h"
+#include "M3DCore/Clock.h"
 
 using namespace m3d;
 
@@ -48,7 +50,7 @@ FunctionStack::FunctionStack()
 	_perfTime = 0;
 	_perfCPPHitCount = 0;
 	_perfFrame = 0;
-	QueryPerformanceFrequency((LARGE_INTEGER*)&_qFreq);
+	_qFreq = Clock::TICKS_PER_SECOND;
 
 	_functionStack = new FunctionStackRecord[FUNCTION_STACK_SIZE];
 
@@ -182,11 +184,14 @@ uint32 FunctionStack::SetStackPtr(uint32 stackptr)
 		if (stackptr != _stackptr) {
 			// We are now doing a c++ function call on a chip we got from a FunctionCall-chip as a ChildPtr<>.
 			// This means we should start monitoring how long that FunctionCall is taking us.			
-			QueryPerformanceCounter((LARGE_INTEGER*)&_functionStack[stackptr].start);
+			_functionStack[stackptr].start = Clock::GetTime_ns();
 		}
 		_functionStack[stackptr].ccpHitCount++;
 	}
 
+	if (profiler.IsRecording() && stackptr != _stackptr && _functionStack[stackptr].original > _functionStack[stackptr].prevRecord)
+		profiler.BeginFunction(_functionStack[stackptr].f.function); // Entering a chip we got from a FunctionCall.
+
 	std::swap(_stackptr, stackptr); // Set stackptr to be current record.
 
 	return stackptr; // return index of old record.
@@ -201,12 +206,14 @@ void FunctionStack::ResetStackPtr(uint32 stackptr)
 		if (stackptr != _stackptr) {
 			// We are now leaving the c++ function call we did on a chip we got from a FunctionCall-chip.
 			// We now accumulate the time we spent on the call to the FunctionCalls stack-record.
-			int64 stop;
-			QueryPerformanceCounter((LARGE_INTEGER*)&stop);
+			int64 stop = Clock::GetTime_ns();
 			_functionStack[_stackptr].accum += stop - _functionStack[_stackptr].start;
 		}
 	}
 
+	if (profiler.IsRecording() && stackptr != _stackptr && _functionStack[_stackptr].original > _functionStack[_stackptr].prevRecord)
+		profiler.End(); // Leaving the function entered in SetStackPtr().
+
 	_stackptr = stackptr;
 }
 
@@ -252,7 +259,7 @@ void FunctionStack::StartOfFrame()
 	_functionStack[0].refCount = 1;
 	_functionStack[0].recordnr = ++_recordnrs;
 
-	QueryPerformanceCounter((LARGE_INTEGER*)&_functionStack[0].start);
+	_functionStack[0].start = Clock::GetTime_ns();
 	_functionStack[0].accum = 0;
 	_functionStack[0].subAccum = 0;
 	_functionStack[0].ccpHitCount = 0;
@@ -280,8 +287,7 @@ bool FunctionStack::EndOfFrame()
 	_popStack();
 
 	if (_perfMon != PerfMon::PERF_NONE) {
-		int64 stop;
-		QueryPerformanceCounter((LARGE_INTEGER*)&stop);
+		int64 stop = Clock::GetTime_ns();
 		_perfTime += stop - _functionStack[0].start;
 		_perfCPPHitCount += _functionStack[0].ccpHitCount;
 	}
@@ -148,7 +148,7 @@ public:
 	inline int64 GetPerfTime() const { return _perfTime; }
 	// The number of ChildPtr-> done last frame.
 	inline uint32 GetPerfCPPCount() const { return _perfCPPHitCount; }
-	// Returns the system query freq. To get time in seconds use: (stop-end)/GetQFreq()
+	// Returns the ticks per second of the times above (Clock::TICKS_PER_SECOND). To get time in seconds use: (stop-end)/GetQFreq()
 	inline int64 GetQFreq() const { return _qFreq; }
 
 };
@@ -0,0 +1,163 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "M3DCore/MTypes.h"
+#include "M3DCore/Containers.h"
+#include <algorithm>
+
+namespace m3d
+{
+
+// How a class keeps released instances for reuse by ClassInstance::Create().
+enum class InstancePoolPolicy
+{
+	NONE,		// Released instances are destroyed. (default)
+	FIXED,		// Keep released instances up to the pool capacity.
+	ADAPTIVE	// Keep released instances up to the peak number of live instances since the last trim, limited by the pool capacity.
+};
+
+struct InstancePoolStats
+{
+	// Instances constructed by ClassInstance::Create() because the pool was empty.
+	uint64 created = 0;
+	// Instances constructed by PrewarmInstancePool().
+	uint64 prewarmed = 0;
+	// Instances handed out from the pool.
+	uint64 reused = 0;
+	// Released instances that were reset and put in the pool.
+	uint64 recycled = 0;
+	// Released instances destroyed because the pool was full or they could not be reset.
+	uint64 discarded = 0;
+	// Number of instances in the pool now.
+	uint32 pooled = 0;
+	// Highest number of instances in the pool.
+	uint32 peakPooled = 0;
+	// Highest number of live instances since the last trim.
+	uint32 peakLive = 0;
+};
+
+// The released instances kept by a Class, with the sizing policy and statistics. The owner creates, resets, registers and
+// destroys the instances; this only does the bookkeeping. It does not depend on the rest of the engine, so that the pooling
+// can be benchmarked on its own (see InstancePoolBench).
+template<typename T>
+class InstancePool
+{
+public:
+	InstancePool(uint32 capacity = 256) : _policy(InstancePoolPolicy::NONE), _capacity(capacity) {}
+
+	void SetPolicy(InstancePoolPolicy policy) { _policy = policy; }
+	InstancePoolPolicy GetPolicy() const { return _policy; }
+	void SetCapacity(uint32 capacity) { _capacity = capacity; }
+	uint32 GetCapacity() const { return _capacity; }
+	const List<T*> &GetInstances() const { return _instances; }
+	const InstancePoolStats &GetStats() const { return _stats; }
+	bool IsEmpty() const { return _instances.empty(); }
+
+	// Returns the number of instances the pool may hold now.
+	uint32 GetLimit() const
+	{
+		switch (_policy)
+		{
+		case InstancePoolPolicy::FIXED: return _capacity;
+		case InstancePoolPolicy::ADAPTIVE: return std::min(_capacity, _stats.peakLive);
+		default: return 0;
+		}
+	}
+	// Returns true if a released instance may be put in the pool.
+	bool HasRoom() const { return _instances.size() < GetLimit(); }
+
+	// Called when the number of live instances has grown.
+	void OnLive(uint32 live) { _stats.peakLive = std::max(_stats.peakLive, live); }
+	// Called when an instance was constructed because the pool was empty.
+	void OnCreated() { _stats.created++; }
+	// Called when a released instance was destroyed instead of pooled.
+	void OnDiscarded() { _stats.discarded++; }
+
+	// Takes an instance from the pool. Returns nullptr if empty.
+	T *Take()
+	{
+		if (_instances.empty())
+			return nullptr;
+		T *instance = _instances.back();
+		_instances.pop_back();
+		_stats.pooled = (uint32)_instances.size();
+		_stats.reused++;
+		return instance;
+	}
+	// Puts a released and reset instance in the pool. Check HasRoom() first.
+	void Put(T *instance)
+	{
+		_instances.push_back(instance);
+		_stats.recycled++;
+		_updatePooled();
+	}
+	// Constructs instances using create() until the pool holds count of them, limited by the capacity. Does nothing if the policy is NONE.
+	template<typename F>
+	void Prewarm(uint32 count, F create)
+	{
+		if (_policy == InstancePoolPolicy::NONE)
+			return;
+		count = std::min(count, _capacity); // Not the ADAPTIVE limit. Prewarming is how the user tells us the expected peak!
+		while (_instances.size() < count) {
+			_instances.push_back(create());
+			_stats.prewarmed++;
+		}
+		_updatePooled();
+	}
+	// Destroys instances using destroy() until at most count are left, and restarts the peak tracking used by ADAPTIVE at live.
+	template<typename F>
+	void Trim(uint32 count, F destroy, uint32 live)
+	{
+		// Destroying an instance may release others to the pool, so do not hold on to iterators here!
+		while (_instances.size() > count) {
+			T *instance = _instances.back();
+			_instances.pop_back();
+			destroy(instance);
+		}
+		_stats.pooled = (uint32)_instances.size();
+		_stats.peakLive = live;
+	}
+	// Resets the counters. The peaks are set to the current values.
+	void ResetStats(uint32 live)
+	{
+		_stats = InstancePoolStats();
+		_stats.pooled = _stats.peakPooled = (uint32)_instances.size();
+		_stats.peakLive = live;
+	}
+
+private:
+	List<T*> _instances;
+	InstancePoolPolicy _policy;
+	uint32 _capacity;
+	InstancePoolStats _stats;
+
+	void _updatePooled()
+	{
+		_stats.pooled = (uint32)_instances.size();
+		_stats.peakPooled = std::max(_stats.peakPooled, _stats.pooled);
+	}
+};
+
+}
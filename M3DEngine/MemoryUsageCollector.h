@@ -0,0 +1,98 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "M3DCore/MemoryTracker.h"
+#include "M3DCore/Containers.h"
+
+namespace m3d
+{
+
+// Measures the memory owned by classes, their instances (live and pooled) and all their chips by walking them, and sets the
+// "Class/<name>", "Chip/<type>" and GEOMETRY/TEXTURES subsystem tags of a MemoryTracker. It only uses the accessors of Class,
+// ClassInstance and Chip, so that it can be tested on a graph of stand-ins without the engine (see MemoryCollectorTest).
+class MemoryUsageCollector
+{
+public:
+	MemoryUsageCollector(MemoryTracker &mt) : _mt(mt) {}
+
+	// classes maps to Class pointers, like ClassManager::GetClasssById(). Tags set by the last call, but not found now
+	// (removed classes and chip types), are set to 0.
+	template<typename ClassMap>
+	void Collect(const ClassMap &classes)
+	{
+		Map<MemoryTag, uint64> usage;
+		uint64 geometry = 0, textures = 0;
+
+		auto addChip = [&](const auto *chip) -> uint64
+		{
+			uint64 bytes = chip->GetMemoryUsage();
+			usage[_mt.RegisterTag(MTEXT("Chip/") + String(chip->GetChipDesc().name))] += bytes;
+			geometry += chip->GetSubsystemMemoryUsage(MemorySubsystem::GEOMETRY);
+			textures += chip->GetSubsystemMemoryUsage(MemorySubsystem::TEXTURES);
+			return bytes;
+		};
+
+		for (const auto &n : classes) {
+			const auto *clazz = n.second;
+			uint64 bytes = 0;
+			for (const auto &m : clazz->GetChips())
+				bytes += addChip(m.second);
+			for (const auto *instance : clazz->GetInstances()) {
+				bytes += instance->GetMemoryUsage();
+				for (const auto &m : instance->GetData())
+					bytes += addChip(m.second);
+			}
+			for (const auto *instance : clazz->GetPooledInstances()) {
+				bytes += instance->GetMemoryUsage();
+				for (const auto &m : instance->GetData())
+					bytes += addChip(m.second);
+			}
+			usage[_mt.RegisterTag(MTEXT("Class/") + clazz->GetName())] += bytes;
+		}
+
+		usage.erase(InvalidMemoryTag); // In case we ran out of tags.
+
+		for (MemoryTag tag : _tags)
+			if (usage.find(tag) == usage.end())
+				_mt.SetLive(tag, 0);
+		_tags.clear();
+		for (const auto &n : usage) {
+			_mt.SetLive(n.first, n.second);
+			_tags.insert(n.first);
+		}
+
+		_mt.SetLive(_mt.GetTag(MemorySubsystem::GEOMETRY), geometry);
+		_mt.SetLive(_mt.GetTag(MemorySubsystem::TEXTURES), textures);
+	}
+
+	// Tags set by the last call to Collect().
+	const Set<MemoryTag> &GetTags() const { return _tags; }
+
+private:
+	MemoryTracker &_mt;
+	Set<MemoryTag> _tags;
+};
+
+}
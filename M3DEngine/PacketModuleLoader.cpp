@@ -0,0 +1,136 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "PacketModuleLoader.h"
+#include <algorithm>
+#ifndef _WIN32
+#include <dlfcn.h>
+#endif
+
+using namespace m3d;
+
+
+static bool _isPacketFile(const std::filesystem::path &file)
+{
+#ifdef _WIN32
+	return _wcsicmp(file.extension().c_str(), L".dll") == 0; // File names are not case sensitive on Windows.
+#else
+	return file.extension() == ".so";
+#endif
+}
+
+
+List<std::filesystem::path> PacketModuleLoader::FindPackets(const std::filesystem::path &folder)
+{
+	List<std::filesystem::path> packets;
+	std::error_code ec;
+	for (std::filesystem::directory_iterator itr(folder, ec), end; !ec && itr != end; itr.increment(ec)) {
+		if (itr->is_regular_file(ec) && _isPacketFile(itr->path()))
+			packets.push_back(itr->path());
+	}
+	std::sort(packets.begin(), packets.end());
+	return packets;
+}
+
+bool PacketModuleLoader::GetFileStamp(const std::filesystem::path &file, uint64 &size, int64 &time)
+{
+	std::error_code ec;
+	size = (uint64)std::filesystem::file_size(file, ec);
+	if (ec)
+		return false;
+	time = (int64)std::filesystem::last_write_time(file, ec).time_since_epoch().count();
+	return !ec;
+}
+
+#ifdef _WIN32
+
+PacketModule PacketModuleLoader::Load(const std::filesystem::path &file)
+{
+#ifdef WINDESKTOP
+	return (PacketModule)LoadLibraryExW(file.c_str(), 0, LOAD_LIBRARY_SEARCH_DEFAULT_DIRS | LOAD_LIBRARY_SEARCH_DLL_LOAD_DIR);
+#else
+	return (PacketModule)LoadPackagedLibrary(file.c_str(), 0);
+#endif
+}
+
+void PacketModuleLoader::Free(PacketModule module)
+{
+	if (module)
+		FreeLibrary((HMODULE)module);
+}
+
+void *PacketModuleLoader::GetSymbol(PacketModule module, const char *name)
+{
+	return module ? (void*)GetProcAddress((HMODULE)module, name) : nullptr;
+}
+
+String PacketModuleLoader::GetLastError()
+{
+	DWORD errorMessageID = ::GetLastError();
+	if (errorMessageID == 0)
+		return String();
+
+	LPSTR messageBuffer = nullptr;
+	size_t size = FormatMessageA(FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
+		NULL, errorMessageID, MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT), (LPSTR)&messageBuffer, 0, NULL);
+
+	String message(messageBuffer, size);
+
+	LocalFree(messageBuffer);
+
+	return message;
+}
+
+#else
+
+PacketModule PacketModuleLoader::Load(const std::filesystem::path &file)
+{
+	return dlopen(file.c_str(), RTLD_NOW | RTLD_LOCAL);
+}
+
+void PacketModuleLoader::Free(PacketModule module)
+{
+	if (module)
+		dlclose(module);
+}
+
+void *PacketModuleLoader::GetSymbol(PacketModule module, const char *name)
+{
+	return module ? dlsym(module, name) : nullptr;
+}
+
+String PacketModuleLoader::GetLastError()
+{
+	const char *e = dlerror();
+	return e ? String(e) : String();
+}
+
+#endif
+
+PacketModuleLoader &PacketModuleLoader::GetDefault()
+{
+	static PacketModuleLoader loader;
+	return loader;
+}
@@ -0,0 +1,62 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "GlobalDef.h"
+#include "M3DCore/Containers.h"
+#include <filesystem>
+
+
+namespace m3d
+{
+
+// Handle of a loaded packet module (HMODULE on Windows).
+typedef void *PacketModule;
+
+// The platform layer used by the ChipManager to find, inspect and load chip packets.
+// The default implementation uses LoadLibraryEx on Windows and dlopen on other platforms.
+// It can be replaced through ChipManager::SetModuleLoader(), eg to run against stub packets.
+class M3DENGINE_API PacketModuleLoader
+{
+public:
+	virtual ~PacketModuleLoader() {}
+
+	// Returns the packet files in the given folder, sorted by name.
+	virtual List<std::filesystem::path> FindPackets(const std::filesystem::path &folder);
+	// Gets the size and last modification time of a file. Returns false if not found.
+	virtual bool GetFileStamp(const std::filesystem::path &file, uint64 &size, int64 &time);
+	// Loads a module. Returns nullptr on failure. See GetLastError().
+	virtual PacketModule Load(const std::filesystem::path &file);
+	virtual void Free(PacketModule module);
+	virtual void *GetSymbol(PacketModule module, const char *name);
+	// Describes why the last call to Load() on this thread failed.
+	virtual String GetLastError();
+
+	static PacketModuleLoader &GetDefault();
+};
+
+
+}
@@ -0,0 +1,428 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "Profiler.h"
+#include "Engine.h"
+#include "ClassManager.h"
+#include "Class.h"
+#include "Chip.h"
+#include "Function.h"
+#include "M3DCore/Clock.h"
+#include <fstream>
+#include <thread>
+
+using namespace m3d;
+
+
+Profiler m3d::profiler = Profiler();
+
+
+struct Profiler::ThreadBuffer
+{
+	List<ProfilerEvent> events;
+	// Number of events recorded. Only written by the owning thread.
+	std::atomic<uint32> count;
+	std::atomic<uint64> generation;
+	std::atomic<uint64> dropped;
+	uint32 threadID;
+	// Begin events recorded with no end yet. Space is always kept for their ends.
+	uint32 depth = 0;
+	// Begin events dropped with no end yet. Their ends are dropped as well.
+	uint32 droppedDepth = 0;
+
+	ThreadBuffer(uint32 threadID) : count(0), generation(0), dropped(0), threadID(threadID) {}
+};
+
+
+namespace
+{
+
+void appendJsonString(String &s, const String &str)
+{
+	s += MCHAR('\"');
+	for (Char c : str) {
+		switch (c) {
+		case MCHAR('\"'): s += MTEXT("\\\""); break;
+		case MCHAR('\\'): s += MTEXT("\\\\"); break;
+		case MCHAR('\n'): s += MTEXT("\\n"); break;
+		case MCHAR('\r'): s += MTEXT("\\r"); break;
+		case MCHAR('\t'): s += MTEXT("\\t"); break;
+		default:
+			if ((uint8)c < 0x20)
+				s += strUtils::format(MTEXT("\\u%04x"), (uint32)c);
+			else
+				s += c;
+		}
+	}
+	s += MCHAR('\"');
+}
+
+const Char *categoryName(ProfilerCategory c)
+{
+	switch (c) {
+	case ProfilerCategory::FRAME: return MTEXT("frame");
+	case ProfilerCategory::PHASE: return MTEXT("phase");
+	case ProfilerCategory::FUNCTION: return MTEXT("function");
+	case ProfilerCategory::CALL: return MTEXT("call");
+	case ProfilerCategory::GET: return MTEXT("get");
+	}
+	return MTEXT("");
+}
+
+}
+
+
+Profiler::Profiler() : _recording(false), _generation(1), _refreshHits(0), _refreshMisses(0)
+{
+}
+
+Profiler::~Profiler()
+{
+}
+
+int64 Profiler::GetTime()
+{
+	return Clock::GetTime_ns();
+}
+
+void Profiler::CaptureFrames(uint32 frameCount)
+{
+	_requestMode = Mode::FRAMES;
+	_requestFrames = std::max(frameCount, 1u);
+	_requestThreshold = 0;
+	_stopRequested = false;
+}
+
+void Profiler::CaptureSlowFrames(float64 thresholdMs, uint32 frameCount)
+{
+	_requestMode = Mode::SLOW_FRAMES;
+	_requestFrames = std::max(frameCount, 1u);
+	_requestThreshold = (int64)(thresholdMs * 1000000.0);
+	_stopRequested = false;
+}
+
+void Profiler::StopCapture()
+{
+	_requestMode = Mode::NONE;
+	if (IsRecording())
+		_stopRequested = true;
+	else if (_mode != Mode::NONE)
+		_stop();
+}
+
+void Profiler::Clear()
+{
+	assert(!IsRecording());
+	_generation++;
+	_frames.clear();
+}
+
+void Profiler::SetBufferCapacity(uint32 capacity)
+{
+	assert(!IsRecording());
+	_capacity = std::max(capacity, 16u);
+	_generation++; // Buffers are resized on next use.
+	_frames.clear();
+}
+
+uint64 Profiler::GetDroppedEventCount() const
+{
+	std::lock_guard<std::mutex> lock(_buffersLock);
+	uint64 g = _generation;
+	uint64 n = 0;
+	for (const auto &b : _buffers)
+		if (b->generation == g)
+			n += b->dropped;
+	return n;
+}
+
+uint64 Profiler::GetEventCount(ProfilerCategory category) const
+{
+	std::lock_guard<std::mutex> lock(_buffersLock);
+	uint64 g = _generation;
+	uint64 n = 0;
+	for (const auto &b : _buffers) {
+		if (b->generation != g)
+			continue;
+		uint32 count = b->count.load(std::memory_order_acquire);
+		for (uint32 i = 0; i < count; i++)
+			if (b->events[i].begin && b->events[i].category == category)
+				n++;
+	}
+	return n;
+}
+
+Map<String, uint64> Profiler::GetChipCallCounts() const
+{
+	std::lock_guard<std::mutex> lock(_buffersLock);
+	uint64 g = _generation;
+
+	// Count by id first, and look up the types once per chip. Chips might have been destroyed since recorded.
+	Map<std::pair<ClassID, ChipID>, uint64> calls;
+	for (const auto &b : _buffers) {
+		if (b->generation != g)
+			continue;
+		uint32 count = b->count.load(std::memory_order_acquire);
+		for (uint32 i = 0; i < count; i++) {
+			const ProfilerEvent &e = b->events[i];
+			if (e.begin && (e.category == ProfilerCategory::CALL || e.category == ProfilerCategory::GET))
+				calls[std::make_pair(e.clazzID, e.chipID)]++;
+		}
+	}
+
+	Map<String, uint64> m;
+	for (const auto &n : calls) {
+		Class *clazz = engine ? engine->GetClassManager()->GetClass(n.first.first) : nullptr;
+		Chip *chip = clazz ? clazz->GetChip(n.first.second) : nullptr;
+		m[chip ? chip->GetChipDesc().name : String(MTEXT("<destroyed>"))] += n.second;
+	}
+	return m;
+}
+
+void Profiler::BeginFrame(uint32 frameNr)
+{
+	if (_requestMode != Mode::NONE) {
+		Clear();
+		_mode = _requestMode;
+		_framesLeft = _requestFrames;
+		_threshold = _requestThreshold;
+		_requestMode = Mode::NONE;
+	}
+	if (_mode == Mode::NONE)
+		return;
+
+	_frameBuffer = _getBuffer();
+	_frameStart = _frameBuffer->count;
+	_frameNr = frameNr;
+	_frameStartTime = GetTime();
+	_frameRefreshHits = GetRefreshHitCount();
+	_frameRefreshMisses = GetRefreshMissCount();
+	_recording = true;
+	_add({ _frameStartTime, true, ProfilerCategory::FRAME, InvalidClassID, frameNr, MTEXT("Frame") });
+}
+
+void Profiler::EndFrame()
+{
+	if (!IsRecording())
+		return;
+
+	int64 end = GetTime();
+	_add({ end, false, ProfilerCategory::FRAME, InvalidClassID, InvalidChipID, nullptr });
+	_recording = false;
+
+	bool keep = _mode != Mode::SLOW_FRAMES || end - _frameStartTime >= _threshold;
+	if (keep)
+		_frames.push_back({ _frameNr, _frameStartTime, end, GetRefreshHitCount() - _frameRefreshHits, GetRefreshMissCount() - _frameRefreshMisses });
+	else
+		_frameBuffer->count = _frameStart; // Not slow enough. Forget the frame. Other threads keep their events, as only the owner can rewind a buffer.
+
+	if ((keep && --_framesLeft == 0) || _stopRequested)
+		_stop();
+}
+
+void Profiler::_stop()
+{
+	_mode = Mode::NONE;
+	_framesLeft = 0;
+	_stopRequested = false;
+	if (_autoExportFile.IsFile()) {
+		if (ExportChromeTrace(_autoExportFile))
+			msg(INFO, strUtils::ConstructString(MTEXT("Profiler: %1 frames exported to \'%2\'.")).arg((uint32)_frames.size()).arg(_autoExportFile.AsString()));
+		else
+			msg(WARN, strUtils::ConstructString(MTEXT("Profiler: Failed to export to \'%1\'.")).arg(_autoExportFile.AsString()));
+	}
+}
+
+Profiler::ThreadBuffer *Profiler::_getBuffer()
+{
+	static thread_local const Profiler *owner = nullptr;
+	static thread_local ThreadBuffer *buffer = nullptr;
+
+	if (owner != this) {
+		std::lock_guard<std::mutex> lock(_buffersLock);
+		_buffers.push_back(std::make_unique<ThreadBuffer>((uint32)std::hash<std::thread::id>()(std::this_thread::get_id())));
+		owner = this;
+		buffer = _buffers.back().get();
+	}
+
+	uint64 g = _generation.load(std::memory_order_relaxed);
+	if (buffer->generation.load(std::memory_order_relaxed) != g) {
+		// First event of a new capture.
+		buffer->count.store(0, std::memory_order_relaxed);
+		buffer->dropped.store(0, std::memory_order_relaxed);
+		buffer->depth = 0;
+		buffer->droppedDepth = 0;
+		if (buffer->events.size() != _capacity)
+			buffer->events.resize(_capacity);
+		buffer->generation.store(g, std::memory_order_release);
+	}
+
+	return buffer;
+}
+
+void Profiler::_add(const ProfilerEvent &e)
+{
+	ThreadBuffer *b = _getBuffer();
+	uint32 n = b->count.load(std::memory_order_relaxed);
+	if (e.begin) {
+		if (b->droppedDepth > 0 || n + b->depth + 2 > _capacity) { // Keep space for the end of this and the open events.
+			b->droppedDepth++;
+			b->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		b->depth++;
+	}
+	else {
+		if (b->droppedDepth > 0) {
+			b->droppedDepth--;
+			b->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		if (b->depth == 0)
+			return; // Begin was recorded in an earlier capture.
+		b->depth--;
+	}
+	b->events[n] = e;
+	b->count.store(n + 1, std::memory_order_release);
+}
+
+void Profiler::BeginChip(const Chip *chip, ProfilerCategory category)
+{
+	_add({ GetTime(), true, category, chip->GetClass() ? chip->GetClass()->GetID() : InvalidClassID, chip->GetID(), nullptr });
+}
+
+void Profiler::BeginFunction(const Function *function)
+{
+	BeginChip(function->GetChip(), ProfilerCategory::FUNCTION);
+}
+
+void Profiler::Begin(const Char *name, ProfilerCategory category)
+{
+	_add({ GetTime(), true, category, InvalidClassID, InvalidChipID, name });
+}
+
+void Profiler::End()
+{
+	_add({ GetTime(), false, ProfilerCategory::PHASE, InvalidClassID, InvalidChipID, nullptr });
+}
+
+String Profiler::ExportChromeTrace() const
+{
+	std::lock_guard<std::mutex> lock(_buffersLock);
+
+	uint64 g = _generation;
+
+	int64 t0 = std::numeric_limits<int64>::max();
+	for (const auto &b : _buffers)
+		if (b->generation == g && b->count > 0)
+			t0 = std::min(t0, b->events[0].time);
+
+	// Chips are looked up by id, as they might have been destroyed since recorded.
+	Map<std::pair<ClassID, ChipID>, std::pair<String, String>> names; // name, args
+	auto lookup = [&](const ProfilerEvent &e) -> const std::pair<String, String>& {
+		auto k = std::make_pair(e.clazzID, e.chipID);
+		auto itr = names.find(k);
+		if (itr != names.end())
+			return itr->second;
+		std::pair<String, String> &v = names[k];
+		Class *clazz = engine ? engine->GetClassManager()->GetClass(e.clazzID) : nullptr;
+		Chip *chip = clazz ? clazz->GetChip(e.chipID) : nullptr;
+		if (chip) {
+			v.first = chip->GetName();
+			if (v.first.empty())
+				v.first = chip->GetChipDesc().name;
+			v.second = MTEXT(",\"args\":{\"type\":");
+			appendJsonString(v.second, chip->GetChipDesc().name);
+			v.second += MTEXT(",\"class\":");
+			appendJsonString(v.second, clazz->GetName());
+			v.second += strUtils::ConstructString(MTEXT(",\"chip\":%1}")).arg(e.chipID).string;
+		}
+		else {
+			v.first = strUtils::ConstructString(MTEXT("Chip %1")).arg(e.chipID);
+			v.second = strUtils::ConstructString(MTEXT(",\"args\":{\"class\":%1,\"chip\":%2}")).arg(e.clazzID).arg(e.chipID);
+		}
+		return v;
+	};
+
+	String s = MTEXT("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	for (size_t i = 0; i < _buffers.size(); i++) {
+		const ThreadBuffer &b = *_buffers[i];
+		if (b.generation != g)
+			continue;
+		uint32 count = b.count.load(std::memory_order_acquire);
+		if (count == 0)
+			continue;
+		uint32 tid = (uint32)i + 1;
+		s += first ? MTEXT("") : MTEXT(",\n");
+		first = false;
+		s += strUtils::ConstructString(MTEXT("{\"ph\":\"M\",\"pid\":1,\"tid\":%1,\"name\":\"thread_name\",\"args\":{\"name\":\"%2\"}}")).arg(tid).arg(_frameBuffer == &b ? String(MTEXT("Engine")) : strUtils::ConstructString(MTEXT("Thread %1")).arg(b.threadID).string);
+		for (uint32 j = 0; j < count; j++) {
+			const ProfilerEvent &e = b.events[j];
+			s += strUtils::format(MTEXT(",\n{\"ph\":\"%s\",\"pid\":1,\"tid\":%u,\"ts\":%.3f"), e.begin ? MTEXT("B") : MTEXT("E"), tid, (e.time - t0) / 1000.0);
+			if (e.begin) {
+				s += MTEXT(",\"cat\":\"");
+				s += categoryName(e.category);
+				s += MTEXT("\",\"name\":");
+				switch (e.category) {
+				case ProfilerCategory::FRAME:
+					appendJsonString(s, strUtils::ConstructString(MTEXT("Frame %1")).arg(e.chipID));
+					break;
+				case ProfilerCategory::PHASE:
+					appendJsonString(s, e.name ? e.name : MTEXT(""));
+					break;
+				default:
+					{
+						const auto &n = lookup(e);
+						appendJsonString(s, e.category == ProfilerCategory::GET ? MTEXT("GetChip: ") + n.first : n.first);
+						s += n.second;
+					}
+					break;
+				}
+			}
+			s += MCHAR('}');
+		}
+	}
+	// The OnInputChange refresh counters of each frame, shown as a counter track.
+	if (t0 != std::numeric_limits<int64>::max()) {
+		for (const Frame &f : _frames) {
+			s += first ? MTEXT("") : MTEXT(",\n");
+			first = false;
+			s += strUtils::format(MTEXT("{\"ph\":\"C\",\"pid\":1,\"ts\":%.3f,\"name\":\"OnInputChange\",\"args\":{\"hits\":%llu,\"misses\":%llu}}"), (f.start - t0) / 1000.0, (unsigned long long)f.refreshHits, (unsigned long long)f.refreshMisses);
+		}
+	}
+	s += MTEXT("\n]}\n");
+	return s;
+}
+
+bool Profiler::ExportChromeTrace(Path file) const
+{
+	String s = ExportChromeTrace();
+	std::ofstream f(file.AsString().c_str(), std::ios::out | std::ios::binary);
+	if (!f)
+		return false;
+	f.write(s.c_str(), s.size());
+	return f.good();
+}
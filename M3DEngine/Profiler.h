@@ -0,0 +1,184 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "Exports.h"
+#include "GlobalDef.h"
+#include <atomic>
+#include <mutex>
+#include <memory>
+
+
+namespace m3d
+{
+
+enum class ProfilerCategory : uint16 { FRAME, PHASE, FUNCTION, CALL, GET };
+
+// A begin or end record. Begin and end records are nested per thread.
+struct ProfilerEvent
+{
+	// Nanoseconds, see Profiler::GetTime().
+	int64 time;
+	bool begin;
+	ProfilerCategory category;
+	// The chip called, or the chip of the function called. For frames, chipID is the frame number.
+	ClassID clazzID;
+	ChipID chipID;
+	// For frames and engine phases. Must be a static string!
+	const Char *name;
+};
+
+// Instrumenting profiler recording function calls, chip calls (ChildPtr->...), GetChip() and the engine phases of each frame.
+// Records into a buffer per thread, and exports to the Chrome trace format (chrome://tracing, ui.perfetto.dev).
+// When not recording, the cost of each instrumentation point is a check of IsRecording().
+class M3DENGINE_API Profiler
+{
+public:
+	enum class Mode { NONE, FRAMES, SLOW_FRAMES };
+
+	struct Frame
+	{
+		uint32 frameNr;
+		int64 start;
+		int64 end;
+		// RefreshMode::OnInputChange cache hits and misses during the frame.
+		uint64 refreshHits;
+		uint64 refreshMisses;
+	};
+
+	Profiler();
+	~Profiler();
+
+	// True between BeginFrame() and EndFrame() of a frame being recorded.
+	inline bool IsRecording() const { return _recording.load(std::memory_order_relaxed); }
+
+	// Records the next frameCount frames, starting with the next frame. Previous recordings are cleared.
+	void CaptureFrames(uint32 frameCount);
+	// Records every frame, but keeps only those taking at least thresholdMs milliseconds, until frameCount frames are kept.
+	// Starts with the next frame. Previous recordings are cleared.
+	void CaptureSlowFrames(float64 thresholdMs, uint32 frameCount);
+	// Stops the capture after the current frame. Frames recorded so far are kept.
+	void StopCapture();
+	// Clears all recordings. Should not be called while capturing.
+	void Clear();
+	// Returns true until the requested number of frames are recorded or StopCapture() is called.
+	bool IsCapturing() const { return _mode != Mode::NONE; }
+	Mode GetMode() const { return _mode; }
+	// The frames kept by the last capture.
+	const List<Frame> &GetFrames() const { return _frames; }
+	// Sets a file to export to when a capture completes. Empty path for none.
+	void SetAutoExportFile(Path p) { _autoExportFile = p; }
+	Path GetAutoExportFile() const { return _autoExportFile; }
+	// Max number of events per thread and capture. The rest are counted as dropped.
+	void SetBufferCapacity(uint32 capacity);
+	uint32 GetBufferCapacity() const { return _capacity; }
+	uint64 GetDroppedEventCount() const;
+	// Number of begin events of the given category in the recordings. Should not be called while capturing.
+	uint64 GetEventCount(ProfilerCategory category) const;
+	// Number of chip calls (ChildPtr->... and GetChip()) in the recordings by chip type. Should not be called while capturing.
+	Map<String, uint64> GetChipCallCounts() const;
+
+	// Exports the recorded events in the Chrome trace json format. Should not be called while capturing.
+	String ExportChromeTrace() const;
+	bool ExportChromeTrace(Path file) const;
+
+	// Called by Engine::Run().
+	void BeginFrame(uint32 frameNr);
+	void EndFrame();
+
+	// Instrumentation. Only call these when IsRecording() is true!
+	void BeginChip(const Chip *chip, ProfilerCategory category);
+	void BeginFunction(const Function *function);
+	void Begin(const Char *name, ProfilerCategory category = ProfilerCategory::PHASE);
+	void End();
+
+	// Counts RefreshMode::OnInputChange checks. Counted also when not recording, and from any thread.
+	inline void CountRefresh(bool hit) { (hit ? _refreshHits : _refreshMisses).fetch_add(1, std::memory_order_relaxed); }
+	uint64 GetRefreshHitCount() const { return _refreshHits.load(std::memory_order_relaxed); }
+	uint64 GetRefreshMissCount() const { return _refreshMisses.load(std::memory_order_relaxed); }
+
+	// Monotonic time in nanoseconds. See Clock.
+	static int64 GetTime();
+
+private:
+	struct ThreadBuffer;
+
+	std::atomic<bool> _recording;
+	Mode _mode = Mode::NONE;
+	uint32 _framesLeft = 0;
+	int64 _threshold = 0;
+	// Capture requested, started on next frame.
+	Mode _requestMode = Mode::NONE;
+	uint32 _requestFrames = 0;
+	int64 _requestThreshold = 0;
+	bool _stopRequested = false;
+	List<Frame> _frames;
+	Path _autoExportFile;
+	uint32 _capacity = 1 << 18;
+	// Incremented when recordings are cleared. Buffers from earlier generations are ignored and reset on next use.
+	std::atomic<uint64> _generation;
+
+	mutable std::mutex _buffersLock;
+	List<std::unique_ptr<ThreadBuffer>> _buffers;
+
+	// Buffer of the thread running the frame, and where the current frame started in it.
+	ThreadBuffer *_frameBuffer = nullptr;
+	uint32 _frameStart = 0;
+	uint32 _frameNr = 0;
+	int64 _frameStartTime = 0;
+	uint64 _frameRefreshHits = 0;
+	uint64 _frameRefreshMisses = 0;
+
+	std::atomic<uint64> _refreshHits;
+	std::atomic<uint64> _refreshMisses;
+
+	ThreadBuffer *_getBuffer();
+	void _add(const ProfilerEvent &e);
+	void _stop();
+};
+
+extern Profiler M3DENGINE_API profiler;
+
+
+// Records a named scope, typically an engine phase, if the profiler is recording.
+class ProfilerScope
+{
+public:
+	ProfilerScope(const Char *name, ProfilerCategory category = ProfilerCategory::PHASE) : _recording(profiler.IsRecording())
+	{
+		if (_recording)
+			profiler.Begin(name, category);
+	}
+	~ProfilerScope()
+	{
+		if (_recording)
+			profiler.End();
+	}
+
+private:
+	const bool _recording;
+};
+
+}
@@ -23,6 +23,8 @@
 
 #pragma once
 
+// M3DENGINE_STATIC is defined by the standalone targets (ChipRegistryTest) that build only the portable sources, like ChipRegistryCache.cpp.
+#if defined(_WIN32) && !defined(M3DENGINE_STATIC)
 #include "targetver.h"
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
@@ -44,6 +46,7 @@
 #include <libxml/tree.h>
 #include <libxml/encoding.h>
 #include <libxml/xmlsave.h>
+#endif
 
 // TODO: reference additional headers your program requires here
 
@@ -734,6 +734,10 @@ HRESULT ClassRenderer2::_renderChip9(ID3D11Device *device, ID3D11DeviceContext *
 			_cbData.color1 = Color(0.2f, 0.2f, 1.0f, 0.7f); // SYMBOL COLOR
 			context->PSSetShaderResources(0, 1, &(const SID3D11ShaderResourceView&)_srvOnce);
 			break;
+		case RefreshManager::RefreshMode::OnInputChange:
+			_cbData.color1 = Color(0.2f, 0.8f, 0.2f, 0.7f); // SYMBOL COLOR
+			context->PSSetShaderResources(0, 1, &(const SID3D11ShaderResourceView&)_srvRefresh);
+			break;
 		case RefreshManager::RefreshMode::Never:
 			_cbData.color1 = Color(0.2f, 0.2f, 1.0f, 0.7f); // SYMBOL COLOR
 			context->PSSetShaderResources(0, 1, &(const SID3D11ShaderResourceView&)_srvConstant);
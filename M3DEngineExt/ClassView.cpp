@@ -1045,6 +1045,8 @@ void ClassView::PostRenderProcssing(InputManager *im, ClassViewCallback *cb)
 					rm = RefreshManager::RefreshMode::OncePerFunctionCall;
 				else if (rm == RefreshManager::RefreshMode::OncePerFunctionCall)
 					rm = RefreshManager::RefreshMode::Always;
+				else if (rm == RefreshManager::RefreshMode::Always)
+					rm = RefreshManager::RefreshMode::OnInputChange;
 				else
 					rm = RefreshManager::RefreshMode::Once;
 				b = true;
@@ -53,6 +53,12 @@ bool PhysXActor::CopyChip(Chip *chip)
 	return true;
 }
 
+bool PhysXActor::OnInstanceRecycled(Chip *chip)
+{
+	DestroyActor();
+	return CopyChip(chip);
+}
+
 bool PhysXActor::LoadChip(DocumentLoader &loader)
 {
 	B_RETURN(Chip::LoadChip(loader));
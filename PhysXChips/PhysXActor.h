@@ -44,6 +44,8 @@ public:
 	virtual ~PhysXActor();
 
 	virtual bool CopyChip(Chip *chip) override;
+	// Releases the actor, so that a pooled instance does not keep a body in the scene.
+	virtual bool OnInstanceRecycled(Chip *chip) override;
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
@@ -23,6 +23,7 @@
 
 #include "pch.h"
 #include "PhysXSDK.h"
+#include "M3DCore/MemoryTracker.h"
 
 
 using namespace m3d;
@@ -51,8 +52,37 @@ class Allocer : public PxAllocatorCallback
 #endif
         }
 };
+
+// Forwards to the default allocator, and counts the allocations in the memory tracker.
+// A header in front of each allocation holds the number of bytes counted. It is 16 bytes to keep the alignment PhysX requires.
+class TrackingAllocer : public PxAllocatorCallback
+{
+public:
+	void* allocate(size_t size, const Char *typeName, const char *file, int32 line) override
+	{
+		uint8 *mem = (uint8*)_allocer.allocate(size + HEADER_SIZE, typeName, file, line);
+		if (!mem)
+			return nullptr;
+		*(uint64*)mem = memoryTracker().Allocate(memoryTracker().GetTag(MemorySubsystem::PHYSICS), size);
+		return mem + HEADER_SIZE;
+	}
+
+	void deallocate(void* ptr) override
+	{
+		if (!ptr)
+			return;
+		uint8 *mem = (uint8*)ptr - HEADER_SIZE;
+		memoryTracker().Free(memoryTracker().GetTag(MemorySubsystem::PHYSICS), *(uint64*)mem);
+		_allocer.deallocate(mem);
+	}
+
+private:
+	static const size_t HEADER_SIZE = 16;
+	PxDefaultAllocator _allocer;  // Note using default allocator to avoid 16-byte alignement issues for x86.
+};
+
 //static Allocer gDefaultAllocatorCallback;
-static PxDefaultAllocator gDefaultAllocatorCallback;  // Note using default allocator to avoid 16-byte alignement issues for x86. TODO: fix it!
+static TrackingAllocer gDefaultAllocatorCallback;
 
 class Errors : public PxErrorCallback
 {
@@ -178,6 +208,19 @@ PxCudaContextManager *PhysXSDK::GetCudaContextManager()
 	return _cudaContextManager->contextIsValid() ? _cudaContextManager : nullptr;
 }
 
+void PhysXSDK::RegisterScene(PhysXScene *scene)
+{
+	if (std::find(_scenes.begin(), _scenes.end(), scene) == _scenes.end())
+		_scenes.push_back(scene);
+}
+
+void PhysXSDK::UnregisterScene(PhysXScene *scene)
+{
+	auto itr = std::find(_scenes.begin(), _scenes.end(), scene);
+	if (itr != _scenes.end())
+		_scenes.erase(itr);
+}
+
 
 PhysXUsage::PhysXUsage() : _sdk(nullptr)
 {
@@ -38,6 +38,25 @@ static const Guid PHYSXSDK_GUID = { 0x4a56e38e, 0xe6d0, 0x4e25, { 0x95, 0x7c, 0x
 
 #define PX_RELEASE(x) if (x) { x->release(); x = nullptr; }
 
+class PhysXScene;
+
+// Settings forced upon every scene by the benchmark harness. Must be set before the scenes are created.
+struct PhysXBenchmarkSettings
+{
+	// Number of fixed substeps per frame. 0 means no override (the scene's own settings are used).
+	uint32 substepsPerFrame = 0;
+	// Number of worker threads for the cpu dispatcher. 0 means no override.
+	uint32 dispatcherThreads = 0;
+	// Broad phase to use instead of the scene's setting.
+	bool overrideBroadPhaseType = false;
+	PxBroadPhaseType::Enum broadPhaseType = PxBroadPhaseType::eABP;
+	// Solver to use instead of the scene's setting.
+	bool overrideSolverType = false;
+	PxSolverType::Enum solverType = PxSolverType::ePGS;
+	// Record the time used by every simulation step.
+	bool recordStepTimes = false;
+};
+
 
 class PHYSXCHIPS_API PhysXSDK : public Chip
 {
@@ -54,6 +73,14 @@ public:
 
 	virtual const PxTolerancesScale &GetToleranceScale() const { return _toleranceScale; }
 
+	virtual const PhysXBenchmarkSettings &GetBenchmarkSettings() const { return _benchmarkSettings; }
+	virtual void SetBenchmarkSettings(const PhysXBenchmarkSettings &settings) { _benchmarkSettings = settings; }
+
+	// Scenes register themselves here when their PxScene is created. Kept in creation order.
+	virtual void RegisterScene(PhysXScene *scene);
+	virtual void UnregisterScene(PhysXScene *scene);
+	virtual const List<PhysXScene*> &GetScenes() const { return _scenes; }
+
 protected:
 	PxTolerancesScale _toleranceScale;
 
@@ -65,6 +92,9 @@ protected:
 	PxCooking *_cooking;
 	PxCudaContextManager *_cudaContextManager;
 
+	PhysXBenchmarkSettings _benchmarkSettings;
+	List<PhysXScene*> _scenes;
+
 };
 
 class PHYSXCHIPS_API PhysXUsage
@@ -24,6 +24,7 @@
 #include "pch.h"
 #include "PhysXScene.h"
 #include "PhysX.h"
+#include "M3DCore/Clock.h"
 #include <mutex>
 
 using namespace m3d;
@@ -55,6 +56,8 @@ PhysXScene::PhysXScene()
 	_broadPhaseType = PxBroadPhaseType::eABP;
 	_frictionType = PxFrictionType::ePATCH;
 	_flags = PxSceneFlag::eENABLE_PCM;
+	_deterministic = false;
+	_substepsPerFrame = 2;
 
 	_simulateEvent = CreateEvent(0, FALSE, FALSE, 0);
 	_simulateDoneEvent = CreateEvent(0, FALSE, FALSE, 0);
@@ -94,6 +97,8 @@ bool PhysXScene::CopyChip(Chip *chip)
 	_broadPhaseType = c->_broadPhaseType;
 	_frictionType = c->_frictionType;
 	_flags = c->_flags;
+	_deterministic = c->_deterministic;
+	_substepsPerFrame = c->_substepsPerFrame;
 	return true;
 }
 
@@ -106,6 +111,10 @@ bool PhysXScene::LoadChip(DocumentLoader &loader)
 	LOADDEF("broadPhaseType", _broadPhaseType, PxBroadPhaseType::eABP);
 	LOADDEF("frictionType", _frictionType, PxFrictionType::ePATCH);
 	LOADDEF("flags", (uint32&)_flags, PxSceneFlag::eENABLE_PCM);
+	LOADDEF("deterministic", _deterministic, false);
+	uint32 substepsPerFrame;
+	LOADDEF("substepsPerFrame", substepsPerFrame, 2);
+	SetSubstepsPerFrame(substepsPerFrame); // Clamped to at least 1. A damaged document must not give 0 steps per frame.
 	return true;
 }
 
@@ -118,6 +127,8 @@ bool PhysXScene::SaveChip(DocumentSaver &saver) const
 	SAVEDEF("broadPhaseType", _broadPhaseType, PxBroadPhaseType::eABP);
 	SAVEDEF("frictionType", _frictionType, PxFrictionType::ePATCH);
 	SAVEDEF("flags", (uint32)_flags, PxSceneFlag::eENABLE_PCM);
+	SAVEDEF("deterministic", _deterministic, false);
+	SAVEDEF("substepsPerFrame", _substepsPerFrame, 2);
 	return true;
 }
 
@@ -132,20 +143,24 @@ PxScene *PhysXScene::GetScene()
 
 	PhysXSDK *sdk = (PhysXSDK*)engine->GetChipManager()->GetGlobalChip(PHYSXSDK_GUID);
 
+	const PhysXBenchmarkSettings &bs = sdk->GetBenchmarkSettings();
+
 	if (!_cpuDispatcher) {
-		_cpuDispatcher = PxDefaultCpuDispatcherCreate(1);
+		_cpuDispatcher = PxDefaultCpuDispatcherCreate(bs.dispatcherThreads > 0 ? bs.dispatcherThreads : 1);
 		if(!_cpuDispatcher) {}
 	}
 
 	PxSceneDesc sceneDesc(sdk->GetPhysics()->getTolerancesScale());
 	sceneDesc.gravity = PxVec3(0.0f, -9.81f, 0.0f);
 	sceneDesc.cpuDispatcher = _cpuDispatcher;
-	sceneDesc.solverType = _solverType;
-	sceneDesc.broadPhaseType = _broadPhaseType;
+	sceneDesc.solverType = bs.overrideSolverType ? bs.solverType : _solverType;
+	sceneDesc.broadPhaseType = bs.overrideBroadPhaseType ? bs.broadPhaseType : _broadPhaseType;
 	sceneDesc.flags = _flags;
 	sceneDesc.flags.set(PxSceneFlag::eENABLE_ACTIVE_ACTORS);
+	if (_deterministic || bs.substepsPerFrame > 0)
+		sceneDesc.flags.set(PxSceneFlag::eENABLE_ENHANCED_DETERMINISM);
 
-	if (_broadPhaseType == PxBroadPhaseType::eGPU || _flags.isSet(PxSceneFlag::eENABLE_GPU_DYNAMICS)) {
+	if (sceneDesc.broadPhaseType == PxBroadPhaseType::eGPU || _flags.isSet(PxSceneFlag::eENABLE_GPU_DYNAMICS)) {
 		PxCudaContextManager *cuda = sdk->GetCudaContextManager();
 
 		if (cuda) {
@@ -158,7 +173,7 @@ PxScene *PhysXScene::GetScene()
 		else {
 			msg(WARN, MTEXT("Failed to enable GPU-accelerated PhysX."));
 			sceneDesc.flags.clear(PxSceneFlag::eENABLE_GPU_DYNAMICS);
-			if (_broadPhaseType == PxBroadPhaseType::eGPU)
+			if (sceneDesc.broadPhaseType == PxBroadPhaseType::eGPU)
 				sceneDesc.broadPhaseType = PxBroadPhaseType::eABP; // Fallback
 		}
 	}
@@ -176,6 +191,8 @@ PxScene *PhysXScene::GetScene()
 	
 	_scene->setVisualizationParameter(PxVisualizationParameter::eJOINT_LOCAL_FRAMES, 1.0f);
 	_scene->setVisualizationParameter(PxVisualizationParameter::eJOINT_LIMITS, 1.0f);
+
+	sdk->RegisterScene(this);
 	
 	return _scene;
 }
@@ -186,10 +203,15 @@ void PhysXScene::DestroyScene()
 		FetchResults(true);
 	assert(_isSimulating == false);
 
-	if (_scene)
+	if (_scene) {
 		_scene->release();
+		PhysXSDK *sdk = (PhysXSDK*)engine->GetChipManager()->GetGlobalChip(PHYSXSDK_GUID);
+		if (sdk)
+			sdk->UnregisterScene(this);
+	}
 	_scene = nullptr;
 	_isRunning = false;
+	ClearStepTimes();
 
 	for (const auto &n : _sceneObjects)
 		n->OnSceneDestroyed();
@@ -247,7 +269,7 @@ bool PhysXScene::FetchResults(bool block)
 	if (!_isSimulating)
 		return false;
 
-	auto start = std::chrono::high_resolution_clock::now();
+	int64 start = Clock::GetTime_ns();
 
 	std::unique_lock<std::mutex> lock(_mutex);
 
@@ -255,9 +277,7 @@ bool PhysXScene::FetchResults(bool block)
 	while (!_simDone)
 		_simulateDoneCondition.wait(lock);
 
-	auto stop = std::chrono::high_resolution_clock::now();
-	std::chrono::duration<float64> diff = stop - start;
-	_simulationWait = floor(diff.count() * 10000.0) / 10.0;
+	_simulationWait = floor(Clock::ToSeconds(Clock::GetTime_ns() - start) * 10000.0) / 10.0;
 
 
 
@@ -285,6 +305,51 @@ bool PhysXScene::FetchResults(bool block)
 	return true;
 }
 
+List<float64> PhysXScene::GetStepTimes() const
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	return _stepTimes;
+}
+
+void PhysXScene::ClearStepTimes()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_stepTimes.clear();
+}
+
+uint64 PhysXScene::GetStateHash() const
+{
+	// 64-bit FNV-1a over the raw bits of poses and velocities. Actors are visited in the order they were added to the scene.
+	uint64 h = 14695981039346656037ull;
+	auto hashBytes = [&h](const void *data, size_t size) 
+	{
+		for (size_t i = 0; i < size; i++) {
+			h ^= ((const uint8*)data)[i];
+			h *= 1099511628211ull;
+		}
+	};
+
+	if (!_scene || _isSimulating)
+		return h;
+
+	PxActor *a = nullptr;
+	List<PxActor*> actors(_scene->getNbActors(PxActorTypeFlag::eRIGID_DYNAMIC), a);
+	if (actors.empty())
+		return h;
+	_scene->getActors(PxActorTypeFlag::eRIGID_DYNAMIC, &actors.front(), (physx::PxU32)actors.size());
+	for (size_t i = 0; i < actors.size(); i++) {
+		PxRigidDynamic *rd = actors[i]->is<PxRigidDynamic>();
+		if (!rd)
+			continue;
+		PxTransform t = rd->getGlobalPose();
+		PxVec3 lv = rd->getLinearVelocity();
+		PxVec3 av = rd->getAngularVelocity();
+		hashBytes(&t, sizeof(t));
+		hashBytes(&lv, sizeof(lv));
+		hashBytes(&av, sizeof(av));
+	}
+	return h;
+}
 
 
 uint32 PhysXScene::__threadEnter()
@@ -333,9 +398,23 @@ void PhysXScene::_simulate(float64 &realTimeIndex, float64 &simIndex)
 
 	realTimeIndex = 1.0;
 
-	uint32 steps = uint32(_accum / stepSize);
+	const PhysXBenchmarkSettings &bs = ((PhysXSDK*)engine->GetChipManager()->GetGlobalChip(PHYSXSDK_GUID))->GetBenchmarkSettings();
 
-	auto start = std::chrono::high_resolution_clock::now();
+	// In deterministic mode we run a fixed number of steps every frame. Frame time is ignored, and we never truncate.
+	bool deterministic = _deterministic || bs.substepsPerFrame > 0;
+
+	uint32 steps = 0;
+	if (deterministic) {
+		steps = bs.substepsPerFrame > 0 ? bs.substepsPerFrame : _substepsPerFrame;
+		_accum = steps * stepSize;
+	}
+	else
+		steps = uint32(_accum / stepSize);
+
+	List<float64> stepTimes;
+
+	int64 start = Clock::GetTime_ns();
+	int64 stepStart = start;
 
 	for (uint32 i = 0; i < steps; i++) {
 		_accum -= stepSize;
@@ -395,12 +474,17 @@ void PhysXScene::_simulate(float64 &realTimeIndex, float64 &simIndex)
 		for (PxU32 i = 0; i < nbActiveActors; i++)
 			_updatedActors.insert(activeActors[i]);
 
-		auto stop = std::chrono::high_resolution_clock::now();
+		int64 stop = Clock::GetTime_ns();
 
-		std::chrono::duration<float64> diff = stop - start;
+		if (bs.recordStepTimes) {
+			stepTimes.push_back(Clock::ToSeconds(stop - stepStart));
+			stepStart = stop;
+		}
+
+		float64 diff = Clock::ToSeconds(stop - start);
 
 		// Is total time used so far + estimated time for next step larger than max allowed simulation time?
-		if (i < (steps - 1) && (diff.count() / (i + 1) * (i + 2)) > (_maxSimulationTime * 0.001)) {
+		if (!deterministic && i < (steps - 1) && (diff / (i + 1) * (i + 2)) > (_maxSimulationTime * 0.001)) {
 			float64 workDone = stepSize * (i + 1);
 			realTimeIndex = workDone / (workDone + _accum);
 			_accum = 0.0;
@@ -408,9 +492,12 @@ void PhysXScene::_simulate(float64 &realTimeIndex, float64 &simIndex)
 		}
 	}
 
-	auto stop = std::chrono::high_resolution_clock::now();
+	float64 diff = Clock::ToSeconds(Clock::GetTime_ns() - start);
 
-	std::chrono::duration<float64> diff = stop - start;
+	simIndex = diff / (_maxSimulationTime * 0.001);
 
-	simIndex = diff.count() / (_maxSimulationTime * 0.001);
+	if (!stepTimes.empty()) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_stepTimes.insert(_stepTimes.end(), stepTimes.begin(), stepTimes.end());
+	}
 }
\ No newline at end of file
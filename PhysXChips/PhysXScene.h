@@ -67,6 +67,8 @@ public:
 	virtual float64 GetRealTimeIndex() const { return _realTimeIndex; }
 	virtual float64 GetSimulationIndex() const { return _simIndex; }
 	virtual float64 GetSimulationWaitingTime() const { return _simulationWait; }
+	virtual bool IsDeterministic() const { return _deterministic; }
+	virtual uint32 GetSubstepsPerFrame() const { return _substepsPerFrame; }
 
 	virtual void SetSimulationRate(float64 stepSize) { _stepSize = stepSize; }
 	virtual void SetMaxSimulationTime(float64 timeInMS) { _maxSimulationTime = timeInMS; }
@@ -74,6 +76,9 @@ public:
 	virtual void SetBroadPhaseAlgorithm(PxBroadPhaseType::Enum broadPhase) { _broadPhaseType = broadPhase; }
 	virtual void SetFrictionType(PxFrictionType::Enum frictionType) { _frictionType = frictionType; }
 	virtual void SetSceneFlags(PxSceneFlags flags) { _flags = flags; }
+	// In deterministic mode, every frame runs exactly the given number of substeps, regardless of frame time and maximum simulation time.
+	virtual void SetDeterministic(bool deterministic) { _deterministic = deterministic; }
+	virtual void SetSubstepsPerFrame(uint32 substeps) { _substepsPerFrame = std::max(substeps, 1u); }
 
 
 	virtual void Simulate(bool sync = false);
@@ -82,6 +87,12 @@ public:
 	virtual void RegisterSceneObject(PhysXSceneObject *obj) { _sceneObjects.insert(obj); }
 	virtual void UnregisterSceneObject(PhysXSceneObject *obj) { _sceneObjects.erase(obj); }
 
+	// Time in seconds used by every simulation step since last cleared. Only recorded when enabled through PhysXBenchmarkSettings.
+	virtual List<float64> GetStepTimes() const;
+	virtual void ClearStepTimes();
+	// Hash of the poses and velocities of all dynamic actors. Useful for verifying that a simulation is reproducible.
+	virtual uint64 GetStateHash() const;
+
 	uint32 __threadEnter();
 
 protected:
@@ -111,6 +122,10 @@ protected:
 	PxBroadPhaseType::Enum _broadPhaseType;
 	PxFrictionType::Enum _frictionType;
 	PxSceneFlags _flags;
+	bool _deterministic;
+	uint32 _substepsPerFrame;
+
+	List<float64> _stepTimes;
 
 	Set<PxActor*> _updatedActors;
 	Set<PhysXSceneObject*> _sceneObjects;
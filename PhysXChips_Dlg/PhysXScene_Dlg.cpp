@@ -32,7 +32,7 @@ DIALOGDESC_DEF(PhysXScene_Dlg, PHYSXSCENE_GUID);
 
 void PhysXScene_Dlg::Init()
 {
-	ComboBoxInitList rate, simLimit, solverType, bpType, frictionType;
+	ComboBoxInitList rate, simLimit, substeps, solverType, bpType, frictionType;
 	rate.push_back(std::make_pair(String(MTEXT("30 Hz")), 30.0));
 	rate.push_back(std::make_pair(String(MTEXT("50 Hz")), 50.0));
 	rate.push_back(std::make_pair(String(MTEXT("60 Hz")), 60.0));
@@ -52,6 +52,13 @@ void PhysXScene_Dlg::Init()
 	simLimit.push_back(std::make_pair(String(MTEXT("100 ms")), 100.0));
 	simLimit.push_back(std::make_pair(String(MTEXT("200 ms")), 200.0));
 
+	substeps.push_back(std::make_pair(String(MTEXT("1")), 1u));
+	substeps.push_back(std::make_pair(String(MTEXT("2")), 2u));
+	substeps.push_back(std::make_pair(String(MTEXT("3")), 3u));
+	substeps.push_back(std::make_pair(String(MTEXT("4")), 4u));
+	substeps.push_back(std::make_pair(String(MTEXT("6")), 6u));
+	substeps.push_back(std::make_pair(String(MTEXT("8")), 8u));
+
 	bpType.push_back(std::make_pair(String(MTEXT("SAP (3-axes sweep-and-prune)")), (uint32)PxBroadPhaseType::eSAP));
 	bpType.push_back(std::make_pair(String(MTEXT("MBP (Multi box pruning)")), (uint32)PxBroadPhaseType::eMBP));
 	bpType.push_back(std::make_pair(String(MTEXT("ABP (Automatic box pruning)")), (uint32)PxBroadPhaseType::eABP));
@@ -66,6 +73,7 @@ void PhysXScene_Dlg::Init()
 
 	AddComboBox(MTEXT("Simulation Rate:"), rate, GetChip()->GetSimulationRate(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetSimulationRate(v.ToDouble()); });
 	AddComboBox(MTEXT("Maximum Simulation Time:"), simLimit, GetChip()->GetMaxSimulationTime(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetMaxSimulationTime(v.ToDouble()); });
+	AddComboBox(MTEXT("Substeps per Frame (Deterministic):"), substeps, GetChip()->GetSubstepsPerFrame(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetSubstepsPerFrame(v.ToUInt()); });
 	AddComboBox(MTEXT("Solver Type:"), solverType, (uint32)GetChip()->GetSolverType(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetSolverType((physx::PxSolverType::Enum)v.ToUInt()); });
 	AddComboBox(MTEXT("Broad Phase Type:"), bpType, (uint32)GetChip()->GetBroadPhaseAlgorithm(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetBroadPhaseAlgorithm((physx::PxBroadPhaseType::Enum)v.ToUInt()); });
 	AddComboBox(MTEXT("Friction Type:"), frictionType, (uint32)GetChip()->GetFrictionType(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetFrictionType((physx::PxFrictionType::Enum)v.ToUInt()); });
@@ -96,7 +104,8 @@ void PhysXScene_Dlg::Init()
 	AddCheckBox(7, MTEXT("Enable Stabilization"), (flags & PxSceneFlag::eENABLE_STABILIZATION) != 0 ? RCheckState::Checked : RCheckState::Unchecked, F);
 	AddCheckBox(8, MTEXT("Enable Adaptive Forces"), (flags & PxSceneFlag::eADAPTIVE_FORCE) != 0 ? RCheckState::Checked : RCheckState::Unchecked, F);
 	AddCheckBox(9, MTEXT("Enable Average Points"), (flags & PxSceneFlag::eENABLE_AVERAGE_POINT) != 0 ? RCheckState::Checked : RCheckState::Unchecked, F);
-//	AddCheckBox(10, MTEXT("Enable Debug Visualization"), RCheckState::Checked, [this](Id id, RVariant v) {});
+	AddCheckBox(10, MTEXT("Deterministic (Fixed Substeps per Frame)"), GetChip()->IsDeterministic() ? RCheckState::Checked : RCheckState::Unchecked, [this](Id id, RVariant v) { SetDirty(); GetChip()->SetDeterministic(v.ToUInt() == RCheckState::Checked); });
+//	AddCheckBox(11, MTEXT("Enable Debug Visualization"), RCheckState::Checked, [this](Id id, RVariant v) {});
 
 	AddLine();
 	AddPushButton(MTEXT("Start"), [this](Id id, RVariant v) { GetChip()->GetScene(); GetChip()->StartSimulation(); });
@@ -4,7 +4,9 @@
 // License as published by the Free Software Foundation; either
 // version 2.1 of the License, or (at your option) any later version.
 
-#ifdef Primitives_EXPORTS
+#if defined(PRIMITIVES_STATIC) || !defined(_WIN32)
+#define PRIMITIVES_API
+#elif defined(Primitives_EXPORTS)
 #define PRIMITIVES_API __declspec(dllexport)
 #else
 #define PRIMITIVES_API __declspec(dllimport)
@@ -6,199 +6,283 @@
 
 #include "stdafx.h"
 #include "Primitives.h"
-//#include <generator\BezierMesh.hpp>
-#include <generator\BoxMesh.hpp>
-#include <generator\CappedCylinderMesh.hpp>
-#include <generator\CappedConeMesh.hpp>
-#include <generator\CappedTubeMesh.hpp>
-#include <generator\ConeMesh.hpp>
-#include <generator\CapsuleMesh.hpp>
-//#include <generator\ConvexPolygonMesh.hpp>
-#include <generator\CylinderMesh.hpp>
-#include <generator\DodecahedronMesh.hpp>
-#include <generator\DiskMesh.hpp>
-#include <generator\IcosahedronMesh.hpp>
-#include <generator\IcoSphereMesh.hpp>
-#include <generator\PlaneMesh.hpp>
-#include <generator\RoundedBoxMesh.hpp>
-#include <generator\SphereMesh.hpp>
-#include <generator\SphericalConeMesh.hpp>
-#include <generator\SphericalTriangleMesh.hpp>
-#include <generator\SpringMesh.hpp>
-#include <generator\TeapotMesh.hpp>
-#include <generator\TorusKnotMesh.hpp>
-#include <generator\TorusMesh.hpp>
-#include <generator\TubeMesh.hpp>
-#include <generator\utils.hpp>
-#include <generator\ScaleMesh.hpp>
-#include <generator\RotateMesh.hpp>
-#include "tgen.h"
+//#include <generator/BezierMesh.hpp>
+#include <generator/BoxMesh.hpp>
+#include <generator/CappedCylinderMesh.hpp>
+#include <generator/CappedConeMesh.hpp>
+#include <generator/CappedTubeMesh.hpp>
+#include <generator/ConeMesh.hpp>
+#include <generator/CapsuleMesh.hpp>
+//#include <generator/ConvexPolygonMesh.hpp>
+#include <generator/CylinderMesh.hpp>
+#include <generator/DodecahedronMesh.hpp>
+#include <generator/DiskMesh.hpp>
+#include <generator/IcosahedronMesh.hpp>
+#include <generator/IcoSphereMesh.hpp>
+#include <generator/PlaneMesh.hpp>
+#include <generator/RoundedBoxMesh.hpp>
+#include <generator/SphereMesh.hpp>
+#include <generator/SphericalConeMesh.hpp>
+#include <generator/SphericalTriangleMesh.hpp>
+#include <generator/SpringMesh.hpp>
+#include <generator/TeapotMesh.hpp>
+#include <generator/TorusKnotMesh.hpp>
+#include <generator/TorusMesh.hpp>
+#include <generator/TubeMesh.hpp>
+#include <generator/utils.hpp>
+#include <generator/ScaleMesh.hpp>
+#include <generator/RotateMesh.hpp>
+#include <cmath>
+
+
+namespace
+{
+	inline prim::Vec3 sub(const prim::Vec3 &a, const prim::Vec3 &b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	inline prim::FLOAT dot(const prim::Vec3 &a, const prim::Vec3 &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+	inline prim::Vec3 cross(const prim::Vec3 &a, const prim::Vec3 &b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+
+	inline void normalize(prim::Vec3 &v)
+	{
+		prim::FLOAT l = std::sqrt(dot(v, v));
+		if (l > 0) {
+			v.x /= l; v.y /= l; v.z /= l;
+		}
+	}
+
+	// Same tangent space as tgen (computeCornerTSpace, computeVertexTSpace and orthogonalizeTSpace), but the corner tangents are
+	// accumulated directly into the vertices and the bitangents are only computed at the end, so no temporary arrays are needed.
+	void computeTangents(const prim::uVec3 *triangles, size_t triangleCount, const prim::Vec3 *p, const prim::Vec2 *tc, const prim::Vec3 *n, size_t vertexCount, prim::Vec3 *t, prim::Vec3 *bt)
+	{
+		const prim::FLOAT DenomEps = (prim::FLOAT)1e-10;
+
+		for (size_t i = 0; i < vertexCount; i++)
+			t[i] = { 0, 0, 0 };
+
+		for (size_t i = 0; i < triangleCount; i++) {
+			const unsigned v[3] = { triangles[i].v0, triangles[i].v1, triangles[i].v2 };
+			prim::Vec3 edge3D[3];
+			prim::Vec2 edgeUV[3];
+			for (size_t j = 0; j < 3; j++) {
+				edge3D[j] = sub(p[v[(j + 1) % 3]], p[v[j]]);
+				edgeUV[j] = { tc[v[(j + 1) % 3]].x - tc[v[j]].x, tc[v[(j + 1) % 3]].y - tc[v[j]].y };
+			}
+			for (size_t j = 0; j < 3; j++) {
+				const size_t prev = (j + 2) % 3;
+				const prim::Vec3 &dPos0 = edge3D[j], &dPos1Neg = edge3D[prev];
+				const prim::Vec2 &dUV0 = edgeUV[j], &dUV1Neg = edgeUV[prev];
+				prim::FLOAT denom = dUV0.x * -dUV1Neg.y - dUV0.y * -dUV1Neg.x;
+				prim::FLOAT r = std::abs(denom) > DenomEps ? 1 / denom : 0;
+				prim::Vec3 &tV = t[v[j]];
+				tV.x += dPos0.x * -dUV1Neg.y * r - dPos1Neg.x * -dUV0.y * r;
+				tV.y += dPos0.y * -dUV1Neg.y * r - dPos1Neg.y * -dUV0.y * r;
+				tV.z += dPos0.z * -dUV1Neg.y * r - dPos1Neg.z * -dUV0.y * r;
+			}
+		}
+
+		for (size_t i = 0; i < vertexCount; i++) {
+			prim::FLOAT d = dot(n[i], t[i]);
+			t[i] = { t[i].x - n[i].x * d, t[i].y - n[i].y * d, t[i].z - n[i].z * d };
+			normalize(t[i]);
+			if (bt)
+				bt[i] = cross(n[i], t[i]);
+		}
+	}
+}
 
+bool prim::Mesh::allocate(size_t vertexCount, size_t triangleCount, MeshStreamPointers &streams)
+{
+	p.resize(vertexCount);
+	n.resize(vertexCount);
+	tc.resize(vertexCount);
+	t.resize(vertexCount);
+	bt.resize(vertexCount);
+	indices.resize(triangleCount);
+
+	streams.p = p.data();
+	streams.n = n.data();
+	streams.tc = tc.data();
+	streams.t = t.data();
+	streams.bt = bt.data();
+	streams.indices = indices.data();
+
+	return true;
+}
 
 template<typename T>
-bool buildMesh(prim::Mesh &mesh, const T &n)
+bool buildMesh(prim::MeshStreams &mesh, const T &n)
 {
 //	auto m = generator::rotateMesh(n, glm::dquat(sqrt(0.5), -sqrt(0.5), 0.0, 0.0));
 
 	int vertexCount = generator::count(n.vertices());
-	int indexCount = generator::count(n.triangles());
+	int triangleCount = generator::count(n.triangles());
+
+	if (vertexCount < 1 || triangleCount < 3)
+		return false;
 
-	if (vertexCount < 1 || indexCount < 3)
+	prim::MeshStreamPointers s;
+	if (!mesh.allocate(vertexCount, triangleCount, s) || !s.p || !s.indices)
 		return false;
 
-	mesh.p.clear();
-	mesh.n.clear();
-	mesh.tc.clear();
-	mesh.t.clear();
-	mesh.bt.clear();
-	mesh.tc.clear();
-	mesh.indices.clear();
-
-	mesh.p.reserve(vertexCount);
-	mesh.n.reserve(vertexCount);
-	mesh.tc.reserve(vertexCount);
-	mesh.bt.reserve(vertexCount);
-	mesh.tc.reserve(vertexCount);
-	mesh.indices.reserve(indexCount);
-
-	for (auto vertices = n.vertices(); !vertices.done(); vertices.next()) {
+	// Tangents need normals, texture coordinates and the tangents themselves (for the bitangents), even if these are not wanted.
+	std::vector<prim::Vec3> tmpN, tmpT;
+	std::vector<prim::Vec2> tmpTC;
+	const bool tangents = s.t || s.bt;
+	prim::Vec3 *normals = s.n;
+	prim::Vec2 *texCoords = s.tc;
+	prim::Vec3 *t = s.t;
+	if (tangents && !normals) {
+		tmpN.resize(vertexCount);
+		normals = tmpN.data();
+	}
+	if (tangents && !texCoords) {
+		tmpTC.resize(vertexCount);
+		texCoords = tmpTC.data();
+	}
+	if (tangents && !t) {
+		tmpT.resize(vertexCount);
+		t = tmpT.data();
+	}
+
+	size_t i = 0;
+	for (auto vertices = n.vertices(); !vertices.done() && i < (size_t)vertexCount; vertices.next(), i++) {
 		auto vertex = vertices.generate();
 		// Transform from RH til LH. y-axis is up in both cases.
-		mesh.p.push_back({ (FLOAT)vertex.position.y, (FLOAT)vertex.position.z, (FLOAT)-vertex.position.x }); 
-		mesh.n.push_back({ (FLOAT)vertex.normal.y, (FLOAT)vertex.normal.z, (FLOAT)-vertex.normal.x });
+		s.p[i] = { (prim::FLOAT)vertex.position.y, (prim::FLOAT)vertex.position.z, (prim::FLOAT)-vertex.position.x };
+		if (normals)
+			normals[i] = { (prim::FLOAT)vertex.normal.y, (prim::FLOAT)vertex.normal.z, (prim::FLOAT)-vertex.normal.x };
 		// Swap s and t for texture coordinates.
-		mesh.tc.push_back({(FLOAT)vertex.texCoord.y, (FLOAT)vertex.texCoord.x });
+		if (texCoords)
+			texCoords[i] = { (prim::FLOAT)vertex.texCoord.y, (prim::FLOAT)vertex.texCoord.x };
 	}
 
-	for (auto triangles = n.triangles(); !triangles.done(); triangles.next()) {
+	i = 0;
+	for (auto triangles = n.triangles(); !triangles.done() && i < (size_t)triangleCount; triangles.next(), i++) {
 		auto triangle = triangles.generate();
-		mesh.indices.push_back({ (unsigned)triangle.vertices.x, (unsigned)triangle.vertices.z, (unsigned)triangle.vertices.y }); // Reverse winding!
+		s.indices[i] = { (unsigned)triangle.vertices.x, (unsigned)triangle.vertices.z, (unsigned)triangle.vertices.y }; // Reverse winding!
 	}
 
-	std::vector<prim::Vec3> t, bt;
-	tgen::computeCornerTSpace((const std::vector<tgen::VIndexT>&)mesh.indices, (const std::vector<tgen::VIndexT>&)mesh.indices, (const std::vector<tgen::Vec3>&)mesh.p, (const std::vector<tgen::Vec2>&)mesh.tc, (std::vector<tgen::Vec3>&)t, (std::vector<tgen::Vec3>&)bt);
-	tgen::computeVertexTSpace((const std::vector<tgen::VIndexT>&)mesh.indices, (const std::vector<tgen::Vec3>&)t, (const std::vector<tgen::Vec3>&)bt, mesh.p.size(), (std::vector<tgen::Vec3>&)mesh.t, (std::vector<tgen::Vec3>&)mesh.bt);
-	tgen::orthogonalizeTSpace((const std::vector<tgen::Vec3>&)mesh.n, (std::vector<tgen::Vec3>&)mesh.t, (std::vector<tgen::Vec3>&)mesh.bt);
+	if (tangents)
+		computeTangents(s.indices, triangleCount, s.p, texCoords, normals, vertexCount, t, s.bt);
 
 	return true;
 }
 
-bool prim::Primitives::boxMesh(Mesh &mesh, const dVec3& size, const iVec3& segments)
+bool prim::Primitives::boxMesh(MeshStreams &mesh, const dVec3& size, const iVec3& segments)
 {
 	return buildMesh(mesh, generator::BoxMesh((const glm::dvec3&)size, (const glm::ivec3&)segments));
 }
 
-bool prim::Primitives::cappedCylinderMesh(Mesh &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
+bool prim::Primitives::cappedCylinderMesh(MeshStreams &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
 {
 	return buildMesh(mesh, generator::CappedCylinderMesh(radius, size, slices, segments, rings, start, sweep));
 }
 
-bool prim::Primitives::cappedConeMesh(Mesh &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
+bool prim::Primitives::cappedConeMesh(MeshStreams &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
 {
 	return buildMesh(mesh, generator::CappedConeMesh(radius, size, slices, segments, rings, start, sweep));
 }
 
-bool prim::Primitives::cappedTubeMesh(Mesh &mesh, double radius, double innerRadius, double size, int slices, int segments, int rings, double start, double sweep)
+bool prim::Primitives::cappedTubeMesh(MeshStreams &mesh, double radius, double innerRadius, double size, int slices, int segments, int rings, double start, double sweep)
 {
 	return buildMesh(mesh, generator::CappedTubeMesh(radius, innerRadius, size, slices, segments, rings, start, sweep));
 }
 
-bool prim::Primitives::coneMesh(Mesh &mesh, double radius, double size, int slices, int segments, double start, double sweep)
+bool prim::Primitives::coneMesh(MeshStreams &mesh, double radius, double size, int slices, int segments, double start, double sweep)
 {
 	return buildMesh(mesh, generator::ConeMesh(radius, size, slices, segments, start, sweep));
 }
 
-bool prim::Primitives::capsuleMesh(Mesh &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
+bool prim::Primitives::capsuleMesh(MeshStreams &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
 {
 	return buildMesh(mesh, generator::CapsuleMesh(radius, size, slices, segments, rings, start, sweep));
 }
 
-bool prim::Primitives::cylinderMesh(Mesh &mesh, double radius, double size, int slices, int segments, double start, double sweep)
+bool prim::Primitives::cylinderMesh(MeshStreams &mesh, double radius, double size, int slices, int segments, double start, double sweep)
 {
 	return buildMesh(mesh, generator::CylinderMesh(radius, size, slices, segments, start, sweep));
 }
 
-bool prim::Primitives::dodecahedronMesh(Mesh &mesh, double radius, int segments, int rings)
+bool prim::Primitives::dodecahedronMesh(MeshStreams &mesh, double radius, int segments, int rings)
 {
 	return buildMesh(mesh, generator::DodecahedronMesh(radius, segments, rings));
 }
 
-bool prim::Primitives::diskMesh(Mesh &mesh, double radius, double innerRadius, int slices, int rings, double start, double sweep)
+bool prim::Primitives::diskMesh(MeshStreams &mesh, double radius, double innerRadius, int slices, int rings, double start, double sweep)
 {
 	return buildMesh(mesh, generator::DiskMesh(radius, innerRadius, slices, rings, start, sweep));
 }
 
-bool prim::Primitives::icosahedronMesh(Mesh &mesh, double radius, int segments)
+bool prim::Primitives::icosahedronMesh(MeshStreams &mesh, double radius, int segments)
 {
 	return buildMesh(mesh, generator::IcosahedronMesh(radius, segments));
 }
 
-bool prim::Primitives::icoSphereMesh(Mesh &mesh, double radius, int segments)
+bool prim::Primitives::icoSphereMesh(MeshStreams &mesh, double radius, int segments)
 {
 	return buildMesh(mesh, generator::IcoSphereMesh(radius, segments));
 }
 
-bool prim::Primitives::planeMesh(Mesh &mesh, const dVec2& size, const iVec2& segments)
+bool prim::Primitives::planeMesh(MeshStreams &mesh, const dVec2& size, const iVec2& segments)
 {
 	return buildMesh(mesh, generator::PlaneMesh((const glm::dvec2&)size, (const glm::ivec2&)segments));
 }
 
-bool prim::Primitives::roundedBoxMesh(Mesh &mesh, double radius, const dVec3& size, int slices, const iVec3& segments)
+bool prim::Primitives::roundedBoxMesh(MeshStreams &mesh, double radius, const dVec3& size, int slices, const iVec3& segments)
 {
 	return buildMesh(mesh, generator::RoundedBoxMesh(radius, (const glm::dvec3&)size, slices, (const glm::ivec3&)segments));
 }
 
-bool prim::Primitives::sphereMesh(Mesh &mesh, double radius, int slices, int segments, double sliceStart, double sliceSweep, double segmentStart, double segmentSweep)
+bool prim::Primitives::sphereMesh(MeshStreams &mesh, double radius, int slices, int segments, double sliceStart, double sliceSweep, double segmentStart, double segmentSweep)
 {
 	return buildMesh(mesh, generator::SphereMesh(radius, slices, segments, sliceStart, sliceSweep, segmentStart, segmentSweep));
 }
 
-bool prim::Primitives::sphericalConeMesh(Mesh &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
+bool prim::Primitives::sphericalConeMesh(MeshStreams &mesh, double radius, double size, int slices, int segments, int rings, double start, double sweep)
 {
 	return buildMesh(mesh, generator::SphericalConeMesh(radius, size, slices, segments, rings, start, sweep));
 }
 
-bool prim::Primitives::sphericalTriangleMesh(Mesh &mesh, double radius, int segments)
+bool prim::Primitives::sphericalTriangleMesh(MeshStreams &mesh, double radius, int segments)
 {
 	return buildMesh(mesh, generator::SphericalTriangleMesh(radius, segments));
 }
 
-bool prim::Primitives::sphericalTriangleMesh(Mesh &mesh, const dVec3& v0, const dVec3& v1, const dVec3& v2, int segments)
+bool prim::Primitives::sphericalTriangleMesh(MeshStreams &mesh, const dVec3& v0, const dVec3& v1, const dVec3& v2, int segments)
 {
 	return buildMesh(mesh, generator::SphericalTriangleMesh((const glm::dvec3&)v0, (const glm::dvec3&)v1, (const glm::dvec3&)v2, segments));
 }
 
-bool prim::Primitives::springMesh(Mesh &mesh, double minor, double major, double size, int slices, int segments, double minorStart, double minorSweep, double majorStart, double majorSweep)
+bool prim::Primitives::springMesh(MeshStreams &mesh, double minor, double major, double size, int slices, int segments, double minorStart, double minorSweep, double majorStart, double majorSweep)
 {
 	return buildMesh(mesh, generator::SpringMesh(minor, major, size, slices, segments, minorStart, minorSweep, majorStart, majorSweep));
 }
 
-bool prim::Primitives::teapotMesh(Mesh &mesh, double size, int segments)
+bool prim::Primitives::teapotMesh(MeshStreams &mesh, double size, int segments)
 {
 	return buildMesh(mesh, generator::scaleMesh(generator::TeapotMesh(segments), { size * 0.5, size * 0.5, size * 0.5 }));
 }
 
-bool prim::Primitives::torusKnotMesh(Mesh &mesh, int p, int q, int slices, int segments)
+bool prim::Primitives::torusKnotMesh(MeshStreams &mesh, int p, int q, int slices, int segments)
 {
 	return buildMesh(mesh, generator::TorusKnotMesh(p, q, slices, segments));
 }
 
-bool prim::Primitives::torusMesh(Mesh &mesh, double minor, double major, int slices, int segments, double minorStart, double minorSweep, double majorStart, double majorSweep)
+bool prim::Primitives::torusMesh(MeshStreams &mesh, double minor, double major, int slices, int segments, double minorStart, double minorSweep, double majorStart, double majorSweep)
 {
 	return buildMesh(mesh, generator::TorusMesh(minor, major, slices, segments, minorStart, minorSweep, majorStart, majorSweep));
 }
 
-bool prim::Primitives::triangleMesh(Mesh &mesh, double radius, int segments)
+bool prim::Primitives::triangleMesh(MeshStreams &mesh, double radius, int segments)
 {
 	return buildMesh(mesh, generator::TriangleMesh(radius, segments));
 }
 
-bool prim::Primitives::triangleMesh(Mesh &mesh, const dVec3& v0, const dVec3& v1, const dVec3& v2, int segments)
+bool prim::Primitives::triangleMesh(MeshStreams &mesh, const dVec3& v0, const dVec3& v1, const dVec3& v2, int segments)
 {
 	return buildMesh(mesh, generator::TriangleMesh((const glm::dvec3&)v0, (const glm::dvec3&)v1, (const glm::dvec3&)v2, segments));
 }
 
-bool prim::Primitives::tubeMesh(Mesh &mesh, double radius, double innerRadius, double size, int slices, int segments, double start, double sweep)
+bool prim::Primitives::tubeMesh(MeshStreams &mesh, double radius, double innerRadius, double size, int slices, int segments, double start, double sweep)
 {
 	return buildMesh(mesh, generator::TubeMesh(radius, innerRadius, size, slices, segments, start, sweep));
 }
\ No newline at end of file
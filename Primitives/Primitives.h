@@ -8,6 +8,7 @@
 
 #include "Exports.h"
 #include <vector>
+#include <cstddef>
 
 namespace prim
 {
@@ -49,7 +50,32 @@ struct iVec3
 	int x, y, z;
 };
 
-struct Mesh
+/// Destinations of the streams of a generated mesh.
+struct MeshStreamPointers
+{
+	Vec3 *p = nullptr;
+	Vec3 *n = nullptr;
+	Vec2 *tc = nullptr;
+	Vec3 *t = nullptr;
+	Vec3 *bt = nullptr;
+	uVec3 *indices = nullptr;
+};
+
+/// Receives a generated mesh as separate streams (structure of arrays),
+/// written directly into storage owned by the implementation.
+class PRIMITIVES_API MeshStreams
+{
+public:
+	virtual ~MeshStreams() {}
+
+	/// Called once with the final counts, before any data is written.
+	/// Must set p and indices. The other streams are generated only if set.
+	/// Returns false to cancel the generation.
+	virtual bool allocate(size_t vertexCount, size_t triangleCount, MeshStreamPointers &streams) = 0;
+};
+
+/// A mesh with all streams, owning its data.
+struct PRIMITIVES_API Mesh : public MeshStreams
 {
 	std::vector<Vec3> p;
 	std::vector<Vec3> n;
@@ -57,6 +83,8 @@ struct Mesh
 	std::vector<Vec3> t;
 	std::vector<Vec3> bt;
 	std::vector<uVec3> indices;
+
+	bool allocate(size_t vertexCount, size_t triangleCount, MeshStreamPointers &streams) override;
 };
 
 #define TORAD(x) ((x) / 180.0 * 3.1415926535898)
@@ -71,7 +99,7 @@ public:
 	/// directions. All should be >= 1. If any one is zero faces in that
 	/// direction are not genereted. If more than one is zero the mesh is empty.
 	static bool boxMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		const dVec3& size = { 1.0, 1.0, 1.0 },
 		const iVec3& segments = { 8, 8, 8 }
 	);
@@ -85,7 +113,7 @@ public:
 	/// @param start Counterclockwise angle around the z-axis relative to x-axis.
 	/// @param sweep Counterclockwise angle around the z-axis.
 	static bool cappedCylinderMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double size = 1.0,
 		int slices = 32,
@@ -105,7 +133,7 @@ public:
 	/// positive x-axis.
 	/// @param sweep Counterclockwise angle around the z-axis.
 	static bool cappedConeMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double size = 1.0,
 		int slices = 32,
@@ -125,7 +153,7 @@ public:
 	/// @param start Counterclockwise angle around the z-axis relative to the x-axis.
 	/// @param sweep Counterclockwise angle around the z-axis.
 	static bool cappedTubeMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double innerRadius = 0.75,
 		double size = 1.0,
@@ -144,7 +172,7 @@ public:
 	///@param start Counterclockwise angle around the z-axis relative to the x-axis.
 	///@param sweep Counterclockwise angle around the z-axis.
 	static bool coneMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double size = 1.0,
 		int slices = 32,
@@ -161,7 +189,7 @@ public:
 	/// @param start Counterclockwise angle relative to the x-axis.
 	/// @param sweep Counterclockwise angle.
 	static bool capsuleMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double size = 0.5,
 		int slices = 32,
@@ -179,7 +207,7 @@ public:
 	/// @param start Counterclockwise angle around the z-axis relative to the x-axis.
 	/// @param sweep Counterclockwise angle around the z-axis.
 	static bool cylinderMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double size = 1.0,
 		int slices = 32,
@@ -196,7 +224,7 @@ public:
 	/// @param rings The number of radial segments on each face. Should be >= 1.
 	/// If <1 an empty mesh is generated.
 	static bool dodecahedronMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		int segments = 1, 
 		int rings = 1
@@ -210,7 +238,7 @@ public:
 	/// @param start Counterclockwise angle relative to the x-axis
 	/// @param sweep Counterclockwise angle.
 	static bool diskMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double innerRadius = 0.0,
 		int slices = 32,
@@ -223,7 +251,7 @@ public:
 	/// @param radius The radius of the enclosing sphere.
 	/// @param segments The number segments along each edge. Must be >= 1.
 	static bool icosahedronMesh(
-		Mesh &mesh, 
+		MeshStreams &mesh, 
 		double radius = 1.0, 
 		int segments = 1
 	);
@@ -232,7 +260,7 @@ public:
 	/// @param radius The radius of the containing sphere.
 	/// @param segments The number of segments per icosahedron edge. Must be >= 1.
 	static bool icoSphereMesh(
-		Mesh &mesh, 
+		MeshStreams &mesh, 
 		double radius = 1.0, 
 		int segments = 4
 	);
@@ -241,7 +269,7 @@ public:
 	/// @param size Half of the side length in x (0) and y (1) direction.
 	/// @param segments Number of subdivisions in the x (0) and y (1) direction.
 	static bool planeMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		const dVec2& size = { 1.0, 1.0 },
 		const iVec2& segments = { 8, 8 }
 	);
@@ -253,7 +281,7 @@ public:
 	/// @param segments Number of subdivisons in x (0), y (1) and z (2)
 	/// direction for the flat faces.
 	static bool roundedBoxMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 0.25,
 		const dVec3& size = { 0.75, 0.75, 0.75 },
 		int slices = 4,
@@ -269,7 +297,7 @@ public:
 	/// @param segmentStart Counterclockwise angle relative to the z-axis.
 	/// @param segmentSweep Counterclockwise angle.
 	static bool sphereMesh(
-		Mesh &mesh, 
+		MeshStreams &mesh, 
 		double radius = 1.0,
 		int slices = 32,
 		int segments = 16,
@@ -288,7 +316,7 @@ public:
 	/// @param start Counterclockwise angle around the z-axis relative to the positive x-axis.
 	/// @param sweep Counterclockwise angle around the z-axis.
 	static bool sphericalConeMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double size = 1.0,
 		int slices = 32,
@@ -301,7 +329,7 @@ public:
 	/// @param radius Radius of the containing sphere.
 	/// @param segments Number of subdivisions along each edge.
 	static bool sphericalTriangleMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		int segments = 4
 	);
@@ -309,7 +337,7 @@ public:
 	/// A triangular region on a surface of a sphere.
 	/// @param segments Number of subdivisions along each edge.
 	static bool sphericalTriangleMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		const dVec3& v0,
 		const dVec3& v1, 
 		const dVec3& v2,
@@ -325,7 +353,7 @@ public:
 	/// @param majorStart Counterclockwise angle around the z-axis relative to the x-axis.
 	/// @param majorSweep Counterclockwise angle arounf the z-axis.
 	static bool springMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double minor = 0.25,
 		double major = 1.0,
 		double size = 1.0,
@@ -341,7 +369,7 @@ public:
 	/// @param segments The number segments along each patch. Should be >= 1.
 	/// If zero empty mesh is generated.
 	static bool teapotMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double size = 1.0,
 		int segments = 8);
 
@@ -349,7 +377,7 @@ public:
 	/// @param slices Number subdivisions around the circle.
 	/// @param segments Number of subdivisions around the path.
 	static bool torusKnotMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		int p = 2,
 		int q = 3,
 		int slices = 8,
@@ -365,7 +393,7 @@ public:
 	/// @param majorStart Counterclockwise angle around the z-axis relative to the x-axis.
 	/// @param majorSweep Counterclockwise angle around the z-axis.
 	static bool torusMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double minor = 0.25,
 		double major = 1.0,
 		int slices = 16,
@@ -380,7 +408,7 @@ public:
 	/// @param radius The radius of the containing circle.
 	/// @param segments The number of segments along each edge. Must be >= 1.
 	static bool triangleMesh(
-		Mesh &mesh, 
+		MeshStreams &mesh, 
 		double radius = 1.0, 
 		int segments = 4
 	);
@@ -388,7 +416,7 @@ public:
 	/// A triangular mesh on the xy -plane.
 	/// @param v0,v1,v2 The vertex positions of the triangle.
 	/// @param segments The number of segments along each edge. Must be >= 1.
-	static bool triangleMesh(Mesh &mesh,
+	static bool triangleMesh(MeshStreams &mesh,
 		const dVec3& v0, 
 		const dVec3& v1, 
 		const dVec3& v2,
@@ -405,7 +433,7 @@ public:
 	/// @param start Counterclockwise angle around the z-axis relative to the x-axis.
 	/// @param sweep Counterclockwise angle around the z-axis.
 	static bool tubeMesh(
-		Mesh &mesh,
+		MeshStreams &mesh,
 		double radius = 1.0,
 		double innerRadius = 0.75,
 		double size = 1.0,
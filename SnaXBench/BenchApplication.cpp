@@ -0,0 +1,130 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "BenchApplication.h"
+#include "M3DEngine/ChipManager.h"
+#include "M3DEngine/ClassManager.h"
+#include "M3DEngine/DocumentManager.h"
+#include "M3DEngine/Document.h"
+#include "GraphicsChips/Graphics.h"
+#include <iostream>
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+using namespace m3d;
+
+
+#define CHIPS_PATH MTEXT("Chips\\")
+#define THIRD_PATH MTEXT("3rd\\")
+#define LIB_PATH MTEXT("Libraries\\")
+
+
+BenchApplication::BenchApplication() : _verbosity(WARN), _engineCreated(false), _quit(false)
+{
+}
+
+BenchApplication::~BenchApplication()
+{
+	assert(!_engineCreated);
+}
+
+bool BenchApplication::Init(bool initGraphics, bool headless)
+{
+	if (!Engine::Create())
+		return false;
+	_engineCreated = true;
+
+	engine->SetHeadless(headless);
+
+	Path appPath = GetApplicationFile().GetDirectory();
+
+	List<Path> libPaths;
+	libPaths.push_back(Path::Dir(Path(LIB_PATH), appPath));
+
+	if (!engine->Init(this, Path::Dir(Path(CHIPS_PATH), appPath), Path::Dir(Path(THIRD_PATH), appPath), libPaths)) {
+		msg(FATAL, MTEXT("Failed to set up directories"));
+		return false;
+	}
+
+	// Initialize graphics! No render window is created, so nothing is presented.
+	if (initGraphics && !engine->GetGraphics()->Init()) {
+		msg(FATAL, MTEXT("Failed to initialize graphics."));
+		return false;
+	}
+
+	return true;
+}
+
+bool BenchApplication::LoadProject(Path project)
+{
+	Document *doc = engine->GetDocumentManager()->GetDocument(project);
+	if (!doc) {
+		msg(FATAL, MTEXT("Failed to load project: ") + project.AsString() + MTEXT("."));
+		return false;
+	}
+
+	Class *cg = doc->GetStartClass();
+	if (!cg) {
+		msg(FATAL, MTEXT("Document did not contain an entry point: ") + project.AsString() + MTEXT("."));
+		return false;
+	}
+
+	return engine->GetClassManager()->SetStartClass(cg);
+}
+
+void BenchApplication::Destroy()
+{
+	if (!_engineCreated)
+		return;
+	engine->Reset();
+	engine->Clear();
+	Engine::Destroy();
+	_engineCreated = false;
+}
+
+Path BenchApplication::GetApplicationFile() const
+{
+	Path p;
+#ifdef _WIN32
+	CHAR s[MAX_PATH] = { MCHAR('\0') };
+	if (GetModuleFileNameA(NULL, s, MAX_PATH) > 0)
+		p = Path::File(s);
+#else
+	Char s[4096] = { MCHAR('\0') };
+	ssize_t n = readlink("/proc/self/exe", s, sizeof(s) - 1);
+	if (n > 0) {
+		s[n] = MCHAR('\0');
+		p = Path::File(s);
+	}
+#endif
+	return p;
+}
+
+void BenchApplication::MessagedAdded(const ApplicationMessage &msg)
+{
+	static const Char *MSG[6] = { MTEXT("DEBUG: "), MTEXT("INFO: "), MTEXT("NOTICE: "), MTEXT("WARNING: "), MTEXT("FATAL: "), MTEXT("") };
+	if (msg.severity >= _verbosity)
+		std::cerr << MSG[msg.severity] << msg.message << std::endl;
+}
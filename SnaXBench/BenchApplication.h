@@ -0,0 +1,74 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "M3DCore/Path.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/Application.h"
+
+namespace m3d
+{
+
+// Application used for running projects without any window or user input.
+class BenchApplication : public Application
+{
+public:
+	BenchApplication();
+	~BenchApplication();
+
+	// Creates the engine, searches for chips and initializes graphics (without any render window).
+	// CPU only benchmarks can skip graphics. When headless, the null graphics engine is used, needing no GPU.
+	bool Init(bool initGraphics = true, bool headless = false);
+	// Loads the given project and makes its start class the entry point.
+	bool LoadProject(Path project);
+	// Clears and destroys the engine.
+	void Destroy();
+
+	// Print engine messages with at least the given severity to stderr.
+	void SetVerbosity(MessageSeverity severity) { _verbosity = severity; }
+
+	ExeEnvironment GetExeEnvironment() const override { return ExeEnvironment::EXE_VIEWER; }
+	Path GetExeFile() const override { return Path(); }
+	Path GetApplicationFile() const override;
+	void Quit() override { _quit = true; }
+	void MessagedAdded(const ApplicationMessage &msg) override;
+	void ChipMessageAdded(Chip *chip, const ChipMessage &msg) override {}
+	void ChipMessageRemoved(Chip *chip, const ChipMessage &msg) override {}
+	void DestroyDeviceObjects() override {}
+	int32 GetDisplayOrientation() override { return 0; }
+	InputManager *GetInputManager() override { return nullptr; }
+	void Break(Chip *chip) override {}
+	bool IsBreakPointsEnabled() const override { return false; }
+	uint32 GetFeatureMask() const override { return 0xFFFFFFFF; }
+
+	bool IsQuitRequested() const { return _quit; }
+
+protected:
+	MessageSeverity _verbosity;
+	bool _engineCreated;
+	bool _quit;
+};
+
+
+}
@@ -0,0 +1,294 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "ChildBenchmark.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/Chip.h"
+#include "M3DCore/Clock.h"
+#include <algorithm>
+
+using namespace m3d;
+
+
+namespace
+{
+
+// Which chip is connected where. Nodes are numbered in the order they are created. Node 0 is the root.
+struct GraphPlan
+{
+	ChildConnectionDesc::ConnectionType type;
+	uint32 chips;
+	uint32 connections; // Per chip.
+	uint32 slots; // Children per chip. Connections for SINGLE, children in the first connection for GROWING.
+	bool chain;
+
+	// Returns the node connected at the given slot of node i, or chips if none.
+	uint32 GetChild(uint32 i, uint32 slot) const
+	{
+		uint64 c = chain ? (slot == 0 ? uint64(i) + 1 : chips) : uint64(i) * slots + slot + 1;
+		return c < chips ? (uint32)c : chips;
+	}
+};
+
+GraphPlan getPlan(ChildGraphShape shape, const ChildBenchmarkOptions &options)
+{
+	GraphPlan p;
+	p.chips = std::max(options.chips, 1u);
+	p.chain = shape == ChildGraphShape::DEEP;
+	if (shape == ChildGraphShape::GROWING) {
+		p.type = ChildConnectionDesc::GROWING;
+		p.connections = 1;
+		p.slots = std::max(options.growing, 1u);
+	}
+	else {
+		p.type = ChildConnectionDesc::SINGLE;
+		p.connections = std::max(options.connections, 1u);
+		p.slots = p.connections;
+	}
+	return p;
+}
+
+
+struct ReferenceNode;
+
+struct ReferenceSubConnection
+{
+	ReferenceNode *chip;
+	int32 lastHit;
+	ReferenceSubConnection(ReferenceNode *chip = nullptr) : chip(chip), lastHit(0) {}
+};
+
+struct ReferenceConnection
+{
+	const ChildConnectionDesc desc;
+	const ChipTypeIndex chipTypeIndex;
+	List<ReferenceSubConnection> connections;
+	ReferenceConnection(const ChildConnectionDesc &desc) : desc(desc), chipTypeIndex(InvalidChipTypeIndex) {}
+};
+
+typedef List<ReferenceConnection*> ReferenceConnectionList;
+
+// Child storage and access the way Chip did it before small-buffer storage.
+struct ReferenceNode
+{
+	ReferenceConnectionList _children;
+	const ReferenceNode *_childProvider;
+	int32 _lastHit;
+
+	ReferenceNode() : _childProvider(this), _lastHit(0) {}
+	virtual ~ReferenceNode() { for (ReferenceConnection *c : _children) mmdelete(c); }
+
+	virtual const ReferenceConnectionList &ProvideChildren() const { return _children; }
+	virtual const ReferenceConnectionList &GetChildren() const { return _childProvider->ProvideChildren(); }
+	virtual uint32 GetConnectionCount() const { return (uint32)GetChildren().size(); }
+
+	virtual uint32 GetSubConnectionCount(uint32 index) const
+	{
+		const ReferenceConnectionList &ccl = GetChildren();
+		if (index < ccl.size() && ccl[index] && ccl[index]->desc.connType != ChildConnectionDesc::MULTI)
+			return (uint32)ccl[index]->connections.size();
+		return 0;
+	}
+
+	virtual ReferenceNode *GetRawChild(uint32 index, uint32 subIndex) const
+	{
+		const ReferenceConnectionList &ccl = GetChildren();
+		if (index >= ccl.size())
+			return nullptr;
+		ReferenceConnection *cc = ccl[index];
+		if (!cc)
+			return nullptr;
+		if (subIndex >= cc->connections.size())
+			return nullptr;
+		ReferenceSubConnection &sc = cc->connections[subIndex];
+		sc.lastHit = engine->GetFrameTime();
+		if (sc.chip)
+			sc.chip->_lastHit = sc.lastHit;
+		return sc.chip;
+	}
+
+	void SetConnection(uint32 index, const ChildConnectionDesc &desc)
+	{
+		if (index >= _children.size())
+			_children.resize(index + 1);
+		_children[index] = mmnew ReferenceConnection(desc);
+	}
+
+	bool SetChild(ReferenceNode *child, uint32 index, uint32 subIndex)
+	{
+		ReferenceConnection *cc = _children[index];
+		if (subIndex >= cc->connections.size())
+			cc->connections.resize(subIndex + 1);
+		cc->connections[subIndex] = child;
+		return true;
+	}
+
+	void Release() { mmdelete(this); }
+};
+
+
+template<typename T>
+bool build(const GraphPlan &plan, List<T*> &nodes)
+{
+	ChildConnectionDesc desc = { CHIP_GUID, plan.type, ChildConnectionDesc::DOWN, MTEXT("Child") };
+	nodes.reserve(plan.chips);
+	for (uint32 i = 0; i < plan.chips; i++) {
+		T *n = mmnew T();
+		for (uint32 j = 0; j < plan.connections; j++)
+			n->SetConnection(j, desc);
+		nodes.push_back(n);
+	}
+	for (uint32 i = 0; i < plan.chips; i++) {
+		for (uint32 j = 0; j < plan.slots; j++) {
+			uint32 c = plan.GetChild(i, j);
+			if (c == plan.chips)
+				continue;
+			if (!nodes[i]->SetChild(nodes[c], plan.type == ChildConnectionDesc::GROWING ? 0 : j, plan.type == ChildConnectionDesc::GROWING ? j : 0))
+				return false;
+		}
+	}
+	return true;
+}
+
+template<typename T>
+void release(List<T*> &nodes)
+{
+	for (T *n : nodes)
+		n->Release();
+	nodes.clear();
+}
+
+// Visits all chips reachable from the root, depth first. Returns the number of chips visited.
+template<typename T>
+uint64 traverse(T *root, List<T*> &stack, uint64 &childAccesses)
+{
+	uint64 visited = 0;
+	stack.clear();
+	stack.push_back(root);
+	while (!stack.empty()) {
+		T *n = stack.back();
+		stack.pop_back();
+		visited++;
+		for (uint32 i = 0, c = n->GetConnectionCount(); i < c; i++) {
+			for (uint32 j = 0, d = n->GetSubConnectionCount(i); j < d; j++) {
+				childAccesses++;
+				T *ch = n->GetRawChild(i, j);
+				if (ch)
+					stack.push_back(ch);
+			}
+		}
+	}
+	return visited;
+}
+
+// Returns the time of the fastest traversal in seconds.
+template<typename T>
+float64 measure(const List<T*> &nodes, uint32 iterations, uint64 &visited, uint64 &childAccesses)
+{
+	List<T*> stack;
+	float64 best = std::numeric_limits<float64>::max();
+	for (uint32 i = 0; i < std::max(iterations, 1u); i++) {
+		childAccesses = 0;
+		int64 start = Clock::GetTime_ns();
+		visited = traverse(nodes[0], stack, childAccesses);
+		best = std::min(best, Clock::ToSeconds(Clock::GetTime_ns() - start));
+	}
+	return best;
+}
+
+}
+
+
+ChildBenchmark::ChildBenchmark()
+{
+}
+
+ChildBenchmark::~ChildBenchmark()
+{
+}
+
+List<ChildBenchmarkResult> ChildBenchmark::Run(const ChildBenchmarkOptions &options, const List<ChildGraphShape> &shapes, uint32 iterations)
+{
+	List<ChildBenchmarkResult> results;
+
+	for (ChildGraphShape shape : shapes) {
+		GraphPlan plan = getPlan(shape, options);
+
+		ChildBenchmarkResult r;
+		r.shape = shape;
+		r.chips = plan.chips;
+
+		// Built and measured one layout at a time, so that they get the same chance at a fresh heap.
+		uint64 visited = 0, referenceVisited = 0, referenceAccesses = 0;
+		{
+			List<Chip*> chips;
+			if (build(plan, chips))
+				r.time = measure(chips, iterations, visited, r.childAccesses);
+			else
+				msg(FATAL, MTEXT("Failed to connect chips. Is the chip type available?"));
+			release(chips);
+		}
+		{
+			List<ReferenceNode*> nodes;
+			build(plan, nodes);
+			r.referenceTime = measure(nodes, iterations, referenceVisited, referenceAccesses);
+			release(nodes);
+		}
+
+		r.succeeded = visited == plan.chips && referenceVisited == visited && referenceAccesses == r.childAccesses;
+		results.push_back(r);
+	}
+
+	return results;
+}
+
+String ChildBenchmark::ToString(ChildGraphShape shape)
+{
+	switch (shape)
+	{
+	case ChildGraphShape::WIDE: return MTEXT("WIDE");
+	case ChildGraphShape::GROWING: return MTEXT("GROWING");
+	default: return MTEXT("DEEP");
+	}
+}
+
+String ChildBenchmark::ToJSON(const List<ChildBenchmarkResult> &results, const ChildBenchmarkOptions &options)
+{
+	String s = MTEXT("\t\"children\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"connections\": %u,\n"), options.connections);
+	s += strUtils::format(MTEXT("\t\t\"growing\": %u,\n"), options.growing);
+	s += MTEXT("\t\t\"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const ChildBenchmarkResult &r = results[i];
+		float64 ns = r.childAccesses > 0 ? r.time * 1.0e9 / r.childAccesses : 0.0;
+		float64 referenceNs = r.childAccesses > 0 ? r.referenceTime * 1.0e9 / r.childAccesses : 0.0;
+		s += strUtils::format(MTEXT("\t\t\t{ \"shape\": \"%s\", \"succeeded\": %s, \"chips\": %u, \"childAccesses\": %llu, \"timeMs\": %.3f, \"referenceTimeMs\": %.3f, \"nsPerAccess\": %.2f, \"referenceNsPerAccess\": %.2f, \"speedup\": %.2f }%s\n"),
+			ToString(r.shape).c_str(), r.succeeded ? MTEXT("true") : MTEXT("false"), r.chips, r.childAccesses, r.time * 1000.0, r.referenceTime * 1000.0,
+			ns, referenceNs, r.time > 0.0 ? r.referenceTime / r.time : 0.0, i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
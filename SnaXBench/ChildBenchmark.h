@@ -0,0 +1,73 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DEngine/GlobalDef.h"
+
+namespace m3d
+{
+
+enum class ChildGraphShape
+{
+	DEEP, // A chain. Each chip has its first connection set.
+	WIDE, // A tree. Each chip has all its connections set.
+	GROWING, // A tree. Each chip has a single growing connection with several children.
+	COUNT
+};
+
+struct ChildBenchmarkOptions
+{
+	uint32 chips = 100000; // Approximate number of chips in each graph.
+	uint32 connections = 4; // Single connections per chip for DEEP and WIDE.
+	uint32 growing = 8; // Children in the growing connection for GROWING.
+};
+
+struct ChildBenchmarkResult
+{
+	ChildGraphShape shape = ChildGraphShape::DEEP;
+	bool succeeded = false; // Both layouts visited the same number of chips.
+	uint32 chips = 0;
+	uint64 childAccesses = 0; // GetRawChild() calls per traversal, including empty connections.
+	float64 time = 0.0; // Seconds, from the fastest traversal.
+	float64 referenceTime = 0.0; // The same for the reference layout.
+};
+
+// Measures traversal of chip graphs built in code through GetConnectionCount(), GetSubConnectionCount() and GetRawChild().
+// The same graphs are built with a reference layout mirroring how Chip stored its children before small-buffer
+// storage: a List of heap allocated connections, each with a List of children, reached through virtual calls.
+// Only engine data structures are involved, so graphics does not have to be initialized.
+class ChildBenchmark
+{
+public:
+	ChildBenchmark();
+	~ChildBenchmark();
+
+	List<ChildBenchmarkResult> Run(const ChildBenchmarkOptions &options, const List<ChildGraphShape> &shapes, uint32 iterations);
+
+	static String ToString(ChildGraphShape shape);
+	static String ToJSON(const List<ChildBenchmarkResult> &results, const ChildBenchmarkOptions &options);
+};
+
+}
@@ -0,0 +1,149 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "InstanceBenchmark.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ChipManager.h"
+#include "M3DEngine/ClassInstance.h"
+#include "M3DEngine/ClassInstanceRef.h"
+#include "StdChips/InstanceData.h"
+#include "StdChips/Value.h"
+#include "StdChips/Text.h"
+#include "StdChips/ValueArray.h"
+#include "M3DCore/Clock.h"
+
+using namespace m3d;
+
+
+InstanceBenchmark::InstanceBenchmark() : _clazz(nullptr), _owner(nullptr)
+{
+}
+
+InstanceBenchmark::~InstanceBenchmark()
+{
+	if (_clazz) {
+		_clazz->SetInstancePoolPolicy(InstancePoolPolicy::NONE);
+		_clazz->Clear();
+		mmdelete(_clazz);
+	}
+}
+
+bool InstanceBenchmark::Setup(const InstanceBenchmarkOptions &options)
+{
+	// The class is not added to the class manager. We only need it to own chips and instances.
+	_clazz = DefaultClassFactory.Create();
+	_clazz->SetName(MTEXT("InstanceBenchmark"));
+
+	ChipManager *cm = engine->GetChipManager();
+	_owner = _clazz->AddChip(cm->GetChipTypeIndex(VALUE_GUID));
+	if (!_owner) {
+		msg(FATAL, MTEXT("Standard chips are not available."));
+		return false;
+	}
+
+	const Guid types[3] = { VALUE_GUID, TEXT_GUID, VALUEARRAY_GUID };
+	for (uint32 i = 0; i < options.dataMembers; i++) {
+		Chip *c = _clazz->AddChip(cm->GetChipTypeIndex(INSTANCEDATA_GUID));
+		if (!c || !c->AsInstanceData() || !c->AsInstanceData()->SetChipType(types[i % 3])) {
+			msg(FATAL, MTEXT("Failed to create instance data."));
+			return false;
+		}
+	}
+	return _clazz->GetInstanceData().size() == options.dataMembers;
+}
+
+List<InstanceBenchmarkResult> InstanceBenchmark::Run(const InstanceBenchmarkOptions &options, const List<InstancePoolPolicy> &policies, uint32 iterations)
+{
+	List<InstanceBenchmarkResult> results;
+
+	List<ClassInstanceRef> instances;
+	instances.reserve(options.batchSize);
+
+	for (InstancePoolPolicy policy : policies) {
+		InstanceBenchmarkResult r;
+		r.policy = policy;
+		r.succeeded = true;
+		r.time = std::numeric_limits<float64>::max();
+
+		_clazz->SetInstancePoolPolicy(policy);
+		_clazz->SetInstancePoolCapacity(options.batchSize);
+		_clazz->TrimInstancePool(); // Each policy starts with an empty pool.
+		_clazz->ResetInstancePoolStats();
+
+		for (uint32 i = 0; i < std::max(iterations, 1u); i++) {
+			if (options.prewarm)
+				_clazz->PrewarmInstancePool(options.batchSize);
+
+			int64 start = Clock::GetTime_ns();
+			for (uint32 j = 0; j < options.rounds; j++) {
+				for (uint32 k = 0; k < options.batchSize; k++)
+					instances.push_back(ClassInstance::Create(_clazz, _owner));
+				instances.clear(); // Destroys or pools the instances.
+			}
+			r.time = std::min(r.time, Clock::ToSeconds(Clock::GetTime_ns() - start));
+
+			r.succeeded = r.succeeded && _clazz->GetInstances().empty();
+
+			_clazz->TrimInstancePool(); // Do not let the pool carry over to the next iteration.
+		}
+
+		r.instancesPerSecond = r.time > 0.0 ? float64(options.rounds) * options.batchSize / r.time : 0.0;
+		r.stats = _clazz->GetInstancePoolStats();
+		results.push_back(r);
+	}
+
+	_clazz->SetInstancePoolPolicy(InstancePoolPolicy::NONE);
+
+	return results;
+}
+
+String InstanceBenchmark::ToString(InstancePoolPolicy policy)
+{
+	switch (policy)
+	{
+	case InstancePoolPolicy::FIXED: return MTEXT("FIXED");
+	case InstancePoolPolicy::ADAPTIVE: return MTEXT("ADAPTIVE");
+	default: return MTEXT("NONE");
+	}
+}
+
+String InstanceBenchmark::ToJSON(const List<InstanceBenchmarkResult> &results, const InstanceBenchmarkOptions &options)
+{
+	String s = MTEXT("\t\"instances\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"dataMembers\": %u,\n"), options.dataMembers);
+	s += strUtils::format(MTEXT("\t\t\"batchSize\": %u,\n"), options.batchSize);
+	s += strUtils::format(MTEXT("\t\t\"rounds\": %u,\n"), options.rounds);
+	s += strUtils::format(MTEXT("\t\t\"prewarm\": %s,\n"), options.prewarm ? MTEXT("true") : MTEXT("false"));
+	s += MTEXT("\t\t\"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const InstanceBenchmarkResult &r = results[i];
+		s += strUtils::format(MTEXT("\t\t\t{ \"policy\": \"%s\", \"succeeded\": %s, \"timeMs\": %.3f, \"instancesPerSecond\": %.0f, \"created\": %llu, \"prewarmed\": %llu, \"reused\": %llu, \"recycled\": %llu, \"discarded\": %llu, \"peakPooled\": %u }%s\n"),
+			ToString(r.policy).c_str(), r.succeeded ? MTEXT("true") : MTEXT("false"), r.time * 1000.0, r.instancesPerSecond,
+			r.stats.created, r.stats.prewarmed, r.stats.reused, r.stats.recycled, r.stats.discarded, r.stats.peakPooled, i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
@@ -0,0 +1,71 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DEngine/GlobalDef.h"
+#include "M3DEngine/Class.h"
+
+namespace m3d
+{
+
+struct InstanceBenchmarkOptions
+{
+	uint32 dataMembers = 8; // Number of instance data members of the class. Cycles through values, texts and value arrays.
+	uint32 batchSize = 1000; // Number of instances alive at the same time.
+	uint32 rounds = 100; // Number of times a batch is created and destroyed per iteration.
+	bool prewarm = false; // Fill the pool before measuring.
+};
+
+struct InstanceBenchmarkResult
+{
+	InstancePoolPolicy policy = InstancePoolPolicy::NONE;
+	bool succeeded = false;
+	float64 time = 0.0; // Seconds, from the fastest iteration.
+	float64 instancesPerSecond = 0.0; // Created and destroyed, from the fastest iteration.
+	InstancePoolStats stats; // Accumulated over all iterations.
+};
+
+// Measures ClassInstance create/destroy throughput for a class built in code, with and without instance pooling.
+// Only engine data structures are involved, so graphics does not have to be initialized.
+class InstanceBenchmark
+{
+public:
+	InstanceBenchmark();
+	~InstanceBenchmark();
+
+	bool Setup(const InstanceBenchmarkOptions &options);
+	// Creates and destroys batches of instances once per iteration for each of the policies.
+	List<InstanceBenchmarkResult> Run(const InstanceBenchmarkOptions &options, const List<InstancePoolPolicy> &policies, uint32 iterations);
+
+	static String ToString(InstancePoolPolicy policy);
+	static String ToJSON(const List<InstanceBenchmarkResult> &results, const InstanceBenchmarkOptions &options);
+
+private:
+	Class *_clazz;
+	// The chip owning the instances. Instances must be owned by a chip in a class.
+	Chip *_owner;
+};
+
+}
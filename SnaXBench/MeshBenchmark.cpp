@@ -0,0 +1,254 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "MeshBenchmark.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ChipManager.h"
+#include "M3DCore/Frustum.h"
+#include "M3DCore/Clock.h"
+
+using namespace m3d;
+
+
+MeshBenchmark::MeshBenchmark() : _geometry(nullptr)
+{
+}
+
+MeshBenchmark::~MeshBenchmark()
+{
+	if (_geometry)
+		_geometry->Release();
+}
+
+bool MeshBenchmark::Setup()
+{
+	// Note: As for textures, we only call virtual functions on the geometry, so we do not need to link with the packet.
+	Chip *c = engine->GetChipManager()->CreateChip(STDGEOMETRY_GUID);
+	if (!c || c->GetChipType() != STDGEOMETRY_GUID) {
+		msg(FATAL, MTEXT("Geometries are not available."));
+		return false;
+	}
+	_geometry = static_cast<StdGeometry*>(c);
+	return true;
+}
+
+bool MeshBenchmark::_createMesh(String mesh)
+{
+	_geometry->Clear();
+	_views.clear();
+
+	if (mesh == MTEXT("terrain")) {
+		// 256x256 quads of rolling hills with some high frequency detail. Open borders.
+		const uint32 n = 256;
+		for (uint32 y = 0; y <= n; y++) {
+			for (uint32 x = 0; x <= n; x++) {
+				float32 u = float32(x) / n, v = float32(y) / n;
+				float32 h = 0.08f * sinf(u * 6.0f) * cosf(v * 5.0f) + 0.02f * sinf(u * 31.0f + v * 17.0f) + 0.005f * sinf(u * 97.0f) * sinf(v * 89.0f);
+				_geometry->AddPosition(XMFLOAT3(u, h, v));
+				_geometry->AddNormal(XMFLOAT3(0.0f, 1.0f, 0.0f));
+				_geometry->AddTexCoord(XMFLOAT2(u, v));
+			}
+		}
+		for (uint32 y = 0; y < n; y++) {
+			for (uint32 x = 0; x < n; x++) {
+				uint32 i = y * (n + 1) + x;
+				_geometry->AddIndex(i); _geometry->AddIndex(i + n + 1); _geometry->AddIndex(i + 1);
+				_geometry->AddIndex(i + 1); _geometry->AddIndex(i + n + 1); _geometry->AddIndex(i + n + 2);
+			}
+		}
+		// Standing on the terrain, looking around and slightly down.
+		for (uint32 i = 0; i < 8; i++) {
+			float32 a = i * XM_2PI / 8;
+			_views.push_back(std::make_pair(XMFLOAT3(0.5f, 0.15f, 0.5f), XMFLOAT3(0.5f + cosf(a), -0.4f, 0.5f + sinf(a))));
+		}
+	}
+	else if (mesh == MTEXT("sphere")) {
+		// UV sphere with a texture seam (duplicated vertices) along u=0/1, and 8 bone groups along the y axis.
+		const uint32 slices = 128, stacks = 64;
+		for (uint32 j = 0; j <= stacks; j++) {
+			for (uint32 i = 0; i <= slices; i++) {
+				float32 u = float32(i) / slices, v = float32(j) / stacks;
+				float32 theta = u * XM_2PI, phi = v * XM_PI;
+				XMFLOAT3 p(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+				_geometry->AddPosition(p);
+				_geometry->AddNormal(p);
+				_geometry->AddTexCoord(XMFLOAT2(u, v));
+				_geometry->AddBlendWeights(XMUBYTEN4(1.0f, 0.0f, 0.0f, 0.0f));
+				_geometry->AddBlendIndices(XMUSHORT4(uint16(std::min(v * 8.0f, 7.0f)), 0, 0, 0));
+			}
+		}
+		for (uint32 j = 0; j < stacks; j++) {
+			for (uint32 i = 0; i < slices; i++) {
+				uint32 a = j * (slices + 1) + i, b = a + slices + 1;
+				if (j > 0) {
+					_geometry->AddIndex(a); _geometry->AddIndex(a + 1); _geometry->AddIndex(b);
+				}
+				if (j + 1 < stacks) {
+					_geometry->AddIndex(a + 1); _geometry->AddIndex(b + 1); _geometry->AddIndex(b);
+				}
+			}
+		}
+		// Orbiting the sphere.
+		for (uint32 i = 0; i < 8; i++) {
+			float32 a = i * XM_2PI / 8;
+			_views.push_back(std::make_pair(XMFLOAT3(3.0f * cosf(a), 1.0f, 3.0f * sinf(a)), XMFLOAT3(0.0f, 0.0f, 0.0f)));
+		}
+	}
+	else {
+		msg(FATAL, MTEXT("Unknown mesh: ") + mesh + MTEXT("."));
+		return false;
+	}
+
+	_geometry->CommitSubset(M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, mesh);
+	return true;
+}
+
+List<MeshBenchmarkResult> MeshBenchmark::Run(const MeshLODOptions &options, const List<String> &meshes, uint32 iterations)
+{
+	List<MeshBenchmarkResult> results;
+	if (!_geometry)
+		return results;
+
+	for (const String &mesh : meshes) {
+		MeshBenchmarkResult r;
+		r.mesh = mesh;
+		if (_createMesh(mesh)) {
+			const GeometrySubset &ss = _geometry->GetSubsets().front();
+			r.vertexCount = (uint32)_geometry->GetPositions().size();
+			r.triangleCount = ss.count / 3;
+			r.extent = XMVectorGetX(XMVector3Length(XMLoadFloat3(&ss.boundingBox.GetMax()) - XMLoadFloat3(&ss.boundingBox.GetMin())));
+			for (uint32 i = 0; i < std::max(iterations, 1u); i++) {
+				List<MeshLODStats> lods;
+				if (!_geometry->GenerateLODs(options, &lods))
+					break;
+				float64 t = 0.0, best = 0.0;
+				for (const MeshLODStats &l : lods)
+					t += l.time;
+				for (const MeshLODStats &l : r.lods)
+					best += l.time;
+				if (!r.succeeded || t < best)
+					r.lods = lods;
+				r.succeeded = true;
+			}
+		}
+		results.push_back(r);
+	}
+	return results;
+}
+
+List<MeshletBenchmarkResult> MeshBenchmark::RunMeshlets(const MeshletOptions &options, const List<String> &meshes, uint32 iterations)
+{
+	List<MeshletBenchmarkResult> results;
+	if (!_geometry)
+		return results;
+
+	const XMMATRIX world = XMMatrixIdentity();
+	const XMMATRIX projection = XMMatrixPerspectiveFovLH(XMConvertToRadians(60.0f), 16.0f / 9.0f, 0.01f, 100.0f);
+
+	for (const String &mesh : meshes) {
+		MeshletBenchmarkResult r;
+		r.mesh = mesh;
+		if (_createMesh(mesh)) {
+			for (uint32 i = 0; i < std::max(iterations, 1u); i++) {
+				MeshletStats stats;
+				if (!_geometry->BuildMeshlets(options, &stats))
+					break;
+				if (!r.succeeded || stats.time < r.stats.time)
+					r.stats = stats;
+				r.succeeded = true;
+			}
+		}
+		if (r.succeeded && r.stats.meshletCount > 0) {
+			const uint32 indexCount = _geometry->GetSubsets().front().count;
+			MeshletDrawList drawList;
+			r.viewCount = (uint32)_views.size();
+			for (uint32 i = 0; i < std::max(iterations, 1u); i++) {
+				MeshletCullStats total;
+				int64 start = Clock::GetTime_ns();
+				for (const auto &v : _views) {
+					XMFLOAT4X4 vp;
+					XMStoreFloat4x4(&vp, XMMatrixLookAtLH(XMLoadFloat3(&v.first), XMLoadFloat3(&v.second), XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f)) * projection);
+					Frustum frustum(vp);
+					drawList.clear();
+					_geometry->CullMeshlets(drawList, 0, 0, world, &frustum, &v.first, &total);
+				}
+				float64 t = Clock::ToSeconds(Clock::GetTime_ns() - start);
+				if (i == 0 || t / r.viewCount < r.cullTime)
+					r.cullTime = t / r.viewCount;
+				if (i == 0) {
+					r.frustumCulled = float32(total.frustumCulled) / total.meshletCount;
+					r.backFaceCulled = float32(total.backFaceCulled) / total.meshletCount;
+					r.indicesDrawn = float32(total.indexCount) / (float32(indexCount) * r.viewCount);
+					r.drawCount = float32(total.drawCount) / r.viewCount;
+				}
+			}
+		}
+		results.push_back(r);
+	}
+	return results;
+}
+
+String MeshBenchmark::ToJSON(const List<MeshBenchmarkResult> &results, const MeshLODOptions &options)
+{
+	String s = MTEXT("\t\"simplify\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"levelCount\": %u,\n"), options.levelCount);
+	s += strUtils::format(MTEXT("\t\t\"reduction\": %.3f,\n"), options.reduction);
+	s += strUtils::format(MTEXT("\t\t\"maxError\": %.5f,\n"), options.maxError);
+	s += MTEXT("\t\t\"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const MeshBenchmarkResult &r = results[i];
+		s += strUtils::format(MTEXT("\t\t\t{ \"mesh\": \"%s\", \"succeeded\": %s, \"vertices\": %u, \"triangles\": %u, \"extent\": %.5f, \"levels\": [\n"),
+			r.mesh.c_str(), r.succeeded ? MTEXT("true") : MTEXT("false"), r.vertexCount, r.triangleCount, r.extent);
+		for (size_t j = 0; j < r.lods.size(); j++) {
+			const MeshLODStats &l = r.lods[j];
+			s += strUtils::format(MTEXT("\t\t\t\t{ \"triangles\": %u, \"error\": %.6f, \"hausdorff\": %.6f, \"relativeHausdorff\": %.6f, \"timeMs\": %.3f }%s\n"),
+				l.triangleCount, l.error, l.hausdorff, r.extent > 0.0f && l.hausdorff >= 0.0f ? l.hausdorff / r.extent : -1.0f, l.time * 1000.0, j + 1 < r.lods.size() ? MTEXT(",") : MTEXT(""));
+		}
+		s += strUtils::format(MTEXT("\t\t\t] }%s\n"), i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
+
+String MeshBenchmark::ToJSON(const List<MeshletBenchmarkResult> &results, const MeshletOptions &options)
+{
+	String s = MTEXT("\t\"meshlets\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"maxVertices\": %u,\n"), options.maxVertices);
+	s += strUtils::format(MTEXT("\t\t\"maxTriangles\": %u,\n"), options.maxTriangles);
+	s += strUtils::format(MTEXT("\t\t\"coneWeight\": %.3f,\n"), options.coneWeight);
+	s += MTEXT("\t\t\"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const MeshletBenchmarkResult &r = results[i];
+		const MeshletStats &m = r.stats;
+		s += strUtils::format(MTEXT("\t\t\t{ \"mesh\": \"%s\", \"succeeded\": %s, \"triangles\": %u, \"meshlets\": %u, \"averageVertices\": %.2f, \"averageTriangles\": %.2f, \"averageRadius\": %.4f, \"coneCullable\": %.3f, \"averageConeAngle\": %.2f, \"buildTimeMs\": %.3f, ")
+			MTEXT("\"views\": %u, \"frustumCulled\": %.3f, \"backFaceCulled\": %.3f, \"indicesDrawn\": %.3f, \"drawCalls\": %.2f, \"cullTimeUs\": %.3f }%s\n"),
+			r.mesh.c_str(), r.succeeded ? MTEXT("true") : MTEXT("false"), m.triangleCount, m.meshletCount, m.averageVertices, m.averageTriangles, m.averageRadius, m.coneCullable, m.averageConeAngle, m.time * 1000.0,
+			r.viewCount, r.frustumCulled, r.backFaceCulled, r.indicesDrawn, r.drawCount, r.cullTime * 1000000.0, i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
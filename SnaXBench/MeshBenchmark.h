@@ -0,0 +1,81 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DEngine/GlobalDef.h"
+#include "GraphicsChips/StdGeometry.h"
+
+namespace m3d
+{
+
+struct MeshBenchmarkResult
+{
+	String mesh;
+	uint32 vertexCount = 0;
+	uint32 triangleCount = 0;
+	float32 extent = 0.0f; // Diagonal of the bounding box.
+	bool succeeded = false;
+	List<MeshLODStats> lods; // From the fastest iteration.
+};
+
+struct MeshletBenchmarkResult
+{
+	String mesh;
+	bool succeeded = false;
+	MeshletStats stats; // From the fastest iteration.
+	uint32 viewCount = 0;
+	float32 frustumCulled = 0.0f; // Fraction of the meshlets, averaged over the views.
+	float32 backFaceCulled = 0.0f; // Fraction of the meshlets, averaged over the views.
+	float32 indicesDrawn = 0.0f; // Fraction of the indices, averaged over the views.
+	float32 drawCount = 0.0f; // Draw calls, averaged over the views.
+	float64 cullTime = 0.0; // Seconds per view, from the fastest iteration.
+};
+
+// Generates levels of detail for procedural meshes, and measures quality (Hausdorff distance) and speed.
+// Also builds meshlets and measures how many are culled by the frustum and back face culling.
+// Only CPU work is measured, so graphics does not have to be initialized.
+class MeshBenchmark
+{
+public:
+	MeshBenchmark();
+	~MeshBenchmark();
+
+	bool Setup();
+	// Generates the levels of detail once per iteration for each of the meshes ("terrain", "sphere").
+	List<MeshBenchmarkResult> Run(const MeshLODOptions &options, const List<String> &meshes, uint32 iterations);
+	// Builds meshlets once per iteration for each of the meshes, and culls them from a set of views typical for the mesh.
+	List<MeshletBenchmarkResult> RunMeshlets(const MeshletOptions &options, const List<String> &meshes, uint32 iterations);
+
+	static String ToJSON(const List<MeshBenchmarkResult> &results, const MeshLODOptions &options);
+	static String ToJSON(const List<MeshletBenchmarkResult> &results, const MeshletOptions &options);
+
+private:
+	StdGeometry *_geometry;
+	List<std::pair<XMFLOAT3, XMFLOAT3>> _views; // Camera position and target for the current mesh.
+
+	bool _createMesh(String mesh);
+};
+
+}
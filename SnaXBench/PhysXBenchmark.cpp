@@ -0,0 +1,115 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "PhysXBenchmark.h"
+#include "PhysXChips/PhysXScene.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ChipManager.h"
+#include <algorithm>
+
+using namespace m3d;
+
+
+PhysXBenchmark::PhysXBenchmark() : _sdk(nullptr)
+{
+}
+
+bool PhysXBenchmark::Setup(const PhysXBenchmarkSettings &settings)
+{
+	// Note: We only call virtual functions on the chips. That way we do not need to link with the packet.
+	Chip *c = engine->GetChipManager()->GetGlobalChip(PHYSXSDK_GUID);
+	if (!c || c->GetChipType() != PHYSXSDK_GUID) {
+		msg(FATAL, MTEXT("PhysX is not available."));
+		return false;
+	}
+	_sdk = static_cast<PhysXSDK*>(c);
+	_sdk->SetBenchmarkSettings(settings);
+	return true;
+}
+
+void PhysXBenchmark::ClearStepTimes()
+{
+	if (!_sdk)
+		return;
+	for (PhysXScene *s : _sdk->GetScenes())
+		s->ClearStepTimes();
+}
+
+PhysXBenchmarkResult PhysXBenchmark::Collect() const
+{
+	PhysXBenchmarkResult r;
+	if (!_sdk)
+		return r;
+
+	List<float64> times;
+	uint64 h = 14695981039346656037ull;
+	for (PhysXScene *s : _sdk->GetScenes()) {
+		List<float64> t = s->GetStepTimes();
+		times.insert(times.end(), t.begin(), t.end());
+		uint64 sh = s->GetStateHash();
+		for (uint32 i = 0; i < 8; i++) {
+			h ^= (sh >> (i * 8)) & 0xFF;
+			h *= 1099511628211ull;
+		}
+		r.sceneCount++;
+	}
+	r.stateHash = h;
+	r.stepCount = (uint32)times.size();
+
+	if (times.empty())
+		return r;
+
+	std::sort(times.begin(), times.end());
+
+	auto percentile = [&times](float64 p) { return times[std::min(size_t(p * times.size()), times.size() - 1)]; };
+
+	for (float64 t : times)
+		r.totalStepTime += t;
+	r.meanStepTime = r.totalStepTime / times.size();
+	r.p50StepTime = percentile(0.50);
+	r.p90StepTime = percentile(0.90);
+	r.p99StepTime = percentile(0.99);
+	r.maxStepTime = times.back();
+
+	return r;
+}
+
+String PhysXBenchmark::ToJSON(const PhysXBenchmarkResult &r, const PhysXBenchmarkSettings &settings)
+{
+	static const Char *BP[] = { MTEXT("SAP"), MTEXT("MBP"), MTEXT("ABP"), MTEXT("GPU") };
+	static const Char *SOLVER[] = { MTEXT("PGS"), MTEXT("TGS") };
+
+	String s = MTEXT("\t\"physx\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"substepsPerFrame\": %u,\n"), settings.substepsPerFrame);
+	s += strUtils::format(MTEXT("\t\t\"dispatcherThreads\": %u,\n"), settings.dispatcherThreads);
+	s += strUtils::format(MTEXT("\t\t\"broadPhase\": \"%s\",\n"), settings.overrideBroadPhaseType && settings.broadPhaseType < 4 ? BP[settings.broadPhaseType] : MTEXT("scene"));
+	s += strUtils::format(MTEXT("\t\t\"solver\": \"%s\",\n"), settings.overrideSolverType && settings.solverType < 2 ? SOLVER[settings.solverType] : MTEXT("scene"));
+	s += strUtils::format(MTEXT("\t\t\"scenes\": %u,\n"), r.sceneCount);
+	s += strUtils::format(MTEXT("\t\t\"steps\": %u,\n"), r.stepCount);
+	s += strUtils::format(MTEXT("\t\t\"stepTimeMs\": { \"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f, \"total\": %.4f },\n"), 
+		r.meanStepTime * 1000.0, r.p50StepTime * 1000.0, r.p90StepTime * 1000.0, r.p99StepTime * 1000.0, r.maxStepTime * 1000.0, r.totalStepTime * 1000.0);
+	s += strUtils::format(MTEXT("\t\t\"stateHash\": \"%016llx\"\n"), r.stateHash);
+	s += MTEXT("\t}");
+	return s;
+}
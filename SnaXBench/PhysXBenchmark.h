@@ -0,0 +1,64 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "M3DEngine/GlobalDef.h"
+#include "PhysXChips/PhysXSDK.h"
+
+namespace m3d
+{
+
+struct PhysXBenchmarkResult
+{
+	uint32 sceneCount = 0;
+	uint32 stepCount = 0;
+	float64 meanStepTime = 0.0;
+	float64 p50StepTime = 0.0;
+	float64 p90StepTime = 0.0;
+	float64 p99StepTime = 0.0;
+	float64 maxStepTime = 0.0;
+	float64 totalStepTime = 0.0;
+	uint64 stateHash = 0;
+};
+
+// Forces all PhysX scenes into deterministic mode and collects per-step timings and state hashes.
+// Must be set up before the project is loaded, so that the settings apply when the scenes are created.
+class PhysXBenchmark
+{
+public:
+	PhysXBenchmark();
+
+	bool Setup(const PhysXBenchmarkSettings &settings);
+	// Discards the step times recorded so far. Used to skip warm-up frames.
+	void ClearStepTimes();
+	// Collects step times and state hashes from all scenes.
+	PhysXBenchmarkResult Collect() const;
+
+	static String ToJSON(const PhysXBenchmarkResult &r, const PhysXBenchmarkSettings &settings);
+
+private:
+	PhysXSDK *_sdk;
+};
+
+}
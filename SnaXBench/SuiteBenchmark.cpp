@@ -0,0 +1,288 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "SuiteBenchmark.h"
+#include "BenchApplication.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/Profiler.h"
+#include "M3DEngine/DocumentFileTypes.h"
+#include "M3DCore/Clock.h"
+#include "M3DCore/MemoryTracker.h"
+#include <rapidjson/document.h>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <iostream>
+
+using namespace m3d;
+
+
+namespace
+{
+
+String escape(const String &str)
+{
+	String s;
+	for (Char c : str) {
+		if (c == MCHAR('\"') || c == MCHAR('\\'))
+			s += MCHAR('\\');
+		s += c;
+	}
+	return s;
+}
+
+String reportToJSON(const FrameStatsReport &r)
+{
+	return strUtils::format(MTEXT("{ \"p50\": %.3f, \"p95\": %.3f, \"p99\": %.3f, \"max\": %.3f, \"mean\": %.3f, \"hitches\": %llu }"), r.p50, r.p95, r.p99, r.max, r.mean, r.hitches);
+}
+
+float64 perFrame(uint64 count, uint32 frames)
+{
+	return frames > 0 ? float64(count) / frames : 0.0;
+}
+
+// The metrics compared to the baseline. Names are paths in the project objects of the report.
+List<std::pair<String, float64>> getMetrics(const SuiteBenchmarkResult &r)
+{
+	List<std::pair<String, float64>> m;
+	m.push_back(std::make_pair(String(MTEXT("loadTimeMs")), r.loadTime * 1000.0));
+	m.push_back(std::make_pair(String(MTEXT("frameTime.p50")), r.frameTime.p50));
+	m.push_back(std::make_pair(String(MTEXT("frameTime.p95")), r.frameTime.p95));
+	m.push_back(std::make_pair(String(MTEXT("allocationsPerFrame")), perFrame(r.allocations, r.frames)));
+	if (r.callFrames > 0)
+		m.push_back(std::make_pair(String(MTEXT("chipCallsPerFrame")), perFrame(r.chipCalls + r.getChipCalls, r.callFrames)));
+	return m;
+}
+
+const rapidjson::Value *findMember(const rapidjson::Value &v, const String &path)
+{
+	const rapidjson::Value *n = &v;
+	for (size_t start = 0; n; ) {
+		size_t end = path.find(MCHAR('.'), start);
+		String key = path.substr(start, end == String::npos ? String::npos : end - start);
+		if (!n->IsObject())
+			return nullptr;
+		auto itr = n->FindMember(key.c_str());
+		n = itr != n->MemberEnd() ? &itr->value : nullptr;
+		if (end == String::npos)
+			break;
+		start = end + 1;
+	}
+	return n;
+}
+
+}
+
+
+SuiteBenchmark::SuiteBenchmark()
+{
+}
+
+SuiteBenchmark::~SuiteBenchmark()
+{
+}
+
+List<Path> SuiteBenchmark::FindProjects(Path dir)
+{
+	List<Path> projects;
+	std::error_code ec;
+	for (std::filesystem::recursive_directory_iterator itr(dir.AsString().c_str(), ec), end; !ec && itr != end; itr.increment(ec)) {
+		if (!itr->is_regular_file(ec))
+			continue;
+		Path p = Path::File(String(itr->path().string().c_str()));
+		if (DocumentFileTypes::GetFileType(p))
+			projects.push_back(p);
+	}
+	std::sort(projects.begin(), projects.end());
+	return projects;
+}
+
+SuiteBenchmarkResult SuiteBenchmark::Run(BenchApplication &app, Path project, const SuiteBenchmarkOptions &options)
+{
+	SuiteBenchmarkResult r;
+	r.project = project.GetName();
+
+	// Start every project from the same state.
+	engine->Reset();
+	engine->SetFixedTimestep(options.timestep);
+
+	int64 loadStart = Clock::GetTime_ns();
+	if (!app.LoadProject(project))
+		return r;
+	r.loadTime = Clock::ToSeconds(Clock::GetTime_ns() - loadStart);
+	r.loaded = true;
+
+	for (uint32 i = 0; i < options.warmupFrames && !app.IsQuitRequested(); i++)
+		engine->Run();
+
+	frameStats.Reset();
+	MemorySnapshot memoryBefore = memoryTracker().TakeSnapshot();
+
+	for (; r.frames < options.frames && !app.IsQuitRequested(); r.frames++)
+		engine->Run();
+
+	MemorySnapshot memoryAfter = memoryTracker().TakeSnapshot();
+
+	r.frameTime = frameStats.GetReport(FrameStatsSeries::FRAME, false);
+	r.classManagerTime = frameStats.GetReport(FrameStatsSeries::CLASS_MANAGER_RUN, false);
+
+	for (const MemoryTagDiff &t : MemorySnapshotDiff::Compute(memoryBefore, memoryAfter).tags) {
+		r.allocations += t.allocations;
+		r.allocatedBytes += t.allocatedBytes;
+		r.liveBytesDelta += t.liveDelta;
+	}
+
+	// Counting calls needs the profiler to record, which adds to the frame times. Therefore they are counted in separate frames.
+	if (options.callFrames > 0 && !app.IsQuitRequested()) {
+		profiler.CaptureFrames(options.callFrames);
+		for (uint32 i = 0; i < options.callFrames && !app.IsQuitRequested(); i++)
+			engine->Run();
+		profiler.StopCapture();
+
+		r.callFrames = (uint32)profiler.GetFrames().size();
+		r.functionCalls = profiler.GetEventCount(ProfilerCategory::FUNCTION);
+		r.chipCalls = profiler.GetEventCount(ProfilerCategory::CALL);
+		r.getChipCalls = profiler.GetEventCount(ProfilerCategory::GET);
+		r.droppedEvents = profiler.GetDroppedEventCount();
+		r.callsByChipType = profiler.GetChipCallCounts();
+		profiler.Clear();
+	}
+
+	return r;
+}
+
+bool SuiteBenchmark::Compare(Path baseline, const List<SuiteBenchmarkResult> &results, float64 threshold, List<SuiteBenchmarkComparison> &comparisons)
+{
+	std::ifstream f(baseline.AsString().c_str(), std::ios::in | std::ios::binary);
+	if (!f.is_open()) {
+		std::cerr << "Failed to open baseline: " << baseline.AsString() << std::endl;
+		return false;
+	}
+	String json((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+	rapidjson::Document doc;
+	doc.Parse(json.c_str());
+	const rapidjson::Value *projects = doc.HasParseError() ? nullptr : findMember(doc, MTEXT("suite.projects"));
+	if (!projects || !projects->IsArray()) {
+		std::cerr << "Invalid baseline: " << baseline.AsString() << std::endl;
+		return false;
+	}
+
+	for (const SuiteBenchmarkResult &r : results) {
+		if (!r.loaded)
+			continue;
+		const rapidjson::Value *b = nullptr;
+		for (const rapidjson::Value &p : projects->GetArray()) {
+			const rapidjson::Value *name = findMember(p, MTEXT("project"));
+			const rapidjson::Value *loaded = findMember(p, MTEXT("loaded"));
+			if (name && name->IsString() && r.project == name->GetString() && loaded && loaded->IsBool() && loaded->GetBool()) {
+				b = &p;
+				break;
+			}
+		}
+		if (!b)
+			continue; // New project, or not loaded in the baseline.
+
+		for (const auto &m : getMetrics(r)) {
+			const rapidjson::Value *v = findMember(*b, m.first);
+			if (!v || !v->IsNumber())
+				continue;
+			SuiteBenchmarkComparison c;
+			c.project = r.project;
+			c.metric = m.first;
+			c.baseline = v->GetDouble();
+			c.current = m.second;
+			if (c.baseline > 0.0)
+				c.change = (c.current - c.baseline) / c.baseline * 100.0;
+			else
+				c.change = c.current > 0.0 ? 100.0 : 0.0;
+			c.regressed = c.change > threshold;
+			comparisons.push_back(c);
+		}
+	}
+
+	return true;
+}
+
+String SuiteBenchmark::ToJSON(const List<SuiteBenchmarkResult> &results, const SuiteBenchmarkOptions &options)
+{
+	String s = MTEXT("\t\"suite\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"warmupFrames\": %u,\n"), options.warmupFrames);
+	s += strUtils::format(MTEXT("\t\t\"frames\": %u,\n"), options.frames);
+	s += strUtils::format(MTEXT("\t\t\"timestepUs\": %lld,\n"), options.timestep);
+	s += strUtils::format(MTEXT("\t\t\"headless\": %s,\n"), engine && engine->IsHeadless() ? MTEXT("true") : MTEXT("false"));
+	s += MTEXT("\t\t\"projects\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const SuiteBenchmarkResult &r = results[i];
+		s += MTEXT("\t\t\t{\n");
+		s += MTEXT("\t\t\t\t\"project\": \"") + escape(r.project) + MTEXT("\",\n");
+		s += strUtils::format(MTEXT("\t\t\t\t\"loaded\": %s,\n"), r.loaded ? MTEXT("true") : MTEXT("false"));
+		s += strUtils::format(MTEXT("\t\t\t\t\"frames\": %u,\n"), r.frames);
+		s += strUtils::format(MTEXT("\t\t\t\t\"loadTimeMs\": %.3f,\n"), r.loadTime * 1000.0);
+		s += MTEXT("\t\t\t\t\"frameTime\": ") + reportToJSON(r.frameTime) + MTEXT(",\n");
+		s += MTEXT("\t\t\t\t\"classManagerTime\": ") + reportToJSON(r.classManagerTime) + MTEXT(",\n");
+		s += strUtils::format(MTEXT("\t\t\t\t\"allocationsPerFrame\": %.3f,\n"), perFrame(r.allocations, r.frames));
+		s += strUtils::format(MTEXT("\t\t\t\t\"allocatedBytesPerFrame\": %.1f,\n"), perFrame(r.allocatedBytes, r.frames));
+		s += strUtils::format(MTEXT("\t\t\t\t\"liveBytesDelta\": %lld,\n"), r.liveBytesDelta);
+		s += strUtils::format(MTEXT("\t\t\t\t\"callFrames\": %u,\n"), r.callFrames);
+		if (r.callFrames > 0) {
+			s += strUtils::format(MTEXT("\t\t\t\t\"functionCallsPerFrame\": %.3f,\n"), perFrame(r.functionCalls, r.callFrames));
+			s += strUtils::format(MTEXT("\t\t\t\t\"chipCallsPerFrame\": %.3f,\n"), perFrame(r.chipCalls + r.getChipCalls, r.callFrames));
+			s += strUtils::format(MTEXT("\t\t\t\t\"getChipCallsPerFrame\": %.3f,\n"), perFrame(r.getChipCalls, r.callFrames));
+			s += strUtils::format(MTEXT("\t\t\t\t\"droppedEvents\": %llu,\n"), r.droppedEvents);
+		}
+		s += MTEXT("\t\t\t\t\"callsByChipType\": {");
+		size_t j = 0;
+		for (const auto &n : r.callsByChipType)
+			s += strUtils::format(MTEXT("%s\n\t\t\t\t\t\"%s\": %llu"), j++ > 0 ? MTEXT(",") : MTEXT(""), escape(n.first).c_str(), n.second);
+		s += j > 0 ? MTEXT("\n\t\t\t\t}\n") : MTEXT("}\n");
+		s += strUtils::format(MTEXT("\t\t\t}%s\n"), i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
+
+String SuiteBenchmark::ToJSON(const List<SuiteBenchmarkComparison> &comparisons, Path baseline, float64 threshold)
+{
+	uint32 regressions = 0;
+	for (const SuiteBenchmarkComparison &c : comparisons)
+		regressions += c.regressed ? 1 : 0;
+
+	String s = MTEXT("\t\"comparison\": {\n");
+	s += MTEXT("\t\t\"baseline\": \"") + escape(baseline.AsString()) + MTEXT("\",\n");
+	s += strUtils::format(MTEXT("\t\t\"thresholdPercent\": %.1f,\n"), threshold);
+	s += strUtils::format(MTEXT("\t\t\"regressions\": %u,\n"), regressions);
+	s += MTEXT("\t\t\"metrics\": [\n");
+	for (size_t i = 0; i < comparisons.size(); i++) {
+		const SuiteBenchmarkComparison &c = comparisons[i];
+		s += strUtils::format(MTEXT("\t\t\t{ \"project\": \"%s\", \"metric\": \"%s\", \"baseline\": %.3f, \"current\": %.3f, \"changePercent\": %.1f, \"regressed\": %s }%s\n"),
+			escape(c.project).c_str(), c.metric.c_str(), c.baseline, c.current, c.change, c.regressed ? MTEXT("true") : MTEXT("false"), i + 1 < comparisons.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
@@ -0,0 +1,97 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DCore/Path.h"
+#include "M3DEngine/FrameStats.h"
+
+namespace m3d
+{
+
+class BenchApplication;
+
+struct SuiteBenchmarkOptions
+{
+	uint32 warmupFrames = 60; // Frames run after loading, before measuring.
+	uint32 frames = 600; // Frames measured.
+	int64 timestep = 16667; // Fixed time step given to the engine, in microseconds.
+	uint32 callFrames = 10; // Frames recorded by the profiler after measuring, to count chip calls. 0 for none.
+};
+
+struct SuiteBenchmarkResult
+{
+	String project; // File name of the project.
+	bool loaded = false;
+	uint32 frames = 0;
+	float64 loadTime = 0.0; // Seconds.
+	FrameStatsReport frameTime; // Engine::Run().
+	FrameStatsReport classManagerTime; // ClassManager::Run().
+	// Counted by the memory tracker during the measured frames.
+	uint64 allocations = 0;
+	uint64 allocatedBytes = 0;
+	int64 liveBytesDelta = 0;
+	// Counted by the profiler during the call frames.
+	uint32 callFrames = 0;
+	uint64 functionCalls = 0;
+	uint64 chipCalls = 0; // ChildPtr->...
+	uint64 getChipCalls = 0; // GetChip()
+	uint64 droppedEvents = 0;
+	Map<String, uint64> callsByChipType; // Chip calls and GetChip() by chip type.
+};
+
+struct SuiteBenchmarkComparison
+{
+	String project;
+	String metric;
+	float64 baseline = 0.0;
+	float64 current = 0.0;
+	float64 change = 0.0; // Percent. Positive is worse.
+	bool regressed = false;
+};
+
+// Loads projects one by one and runs a fixed number of frames with a fixed time step, measuring load time,
+// frame times, allocations and chip calls. Each project is run in the same engine, which is reset in between.
+// Results can be compared to a previous report to find regressions.
+class SuiteBenchmark
+{
+public:
+	SuiteBenchmark();
+	~SuiteBenchmark();
+
+	// Finds the project files in the given directory and its subdirectories, ordered by path.
+	static List<Path> FindProjects(Path dir);
+
+	// The engine must be initialized. Projects failing to load are reported as not loaded.
+	SuiteBenchmarkResult Run(BenchApplication &app, Path project, const SuiteBenchmarkOptions &options);
+
+	// Compares to the projects in a report written by ToJSON(). A metric is regressed when it is more than threshold percent worse.
+	// Returns false if the baseline could not be read.
+	static bool Compare(Path baseline, const List<SuiteBenchmarkResult> &results, float64 threshold, List<SuiteBenchmarkComparison> &comparisons);
+
+	static String ToJSON(const List<SuiteBenchmarkResult> &results, const SuiteBenchmarkOptions &options);
+	static String ToJSON(const List<SuiteBenchmarkComparison> &comparisons, Path baseline, float64 threshold);
+};
+
+}
@@ -0,0 +1,118 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "TextureBenchmark.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ChipManager.h"
+
+using namespace m3d;
+
+
+TextureBenchmark::TextureBenchmark() : _texture(nullptr)
+{
+}
+
+TextureBenchmark::~TextureBenchmark()
+{
+	if (_texture)
+		_texture->Release();
+}
+
+bool TextureBenchmark::Setup(Path image)
+{
+	_image = image;
+
+	// Note: As for PhysX, we only call virtual functions on the texture, so we do not need to link with the packet.
+	Chip *c = engine->GetChipManager()->CreateChip(TEXTURE_GUID);
+	if (!c || c->GetChipType() != TEXTURE_GUID) {
+		msg(FATAL, MTEXT("Textures are not available."));
+		return false;
+	}
+	_texture = static_cast<Texture*>(c);
+	_texture->SetName(image.GetName());
+	return true;
+}
+
+List<TextureBenchmarkResult> TextureBenchmark::Run(const TextureProcessingOptions &options, const List<TextureCompression> &compressions, uint32 iterations)
+{
+	List<TextureBenchmarkResult> results;
+	if (!_texture)
+		return results;
+
+	for (TextureCompression compression : compressions) {
+		TextureBenchmarkResult r;
+		r.compression = compression;
+		TextureProcessingOptions o = options;
+		o.compression = compression;
+		for (uint32 i = 0; i < std::max(iterations, 1u); i++) {
+			if (!_texture->LoadImageDataFromFile(_image)) {
+				msg(FATAL, MTEXT("Failed to load image: ") + _image.AsString() + MTEXT("."));
+				break;
+			}
+			TextureProcessingStats stats;
+			if (!_texture->ProcessImageData(o, &stats))
+				break;
+			if (!r.succeeded || stats.mipTime + stats.compressTime < r.stats.mipTime + r.stats.compressTime)
+				r.stats = stats;
+			r.succeeded = true;
+		}
+		results.push_back(r);
+	}
+	return results;
+}
+
+const Char *TextureBenchmark::ToString(TextureCompression compression)
+{
+	switch (compression)
+	{
+	case TextureCompression::BC1: return MTEXT("BC1");
+	case TextureCompression::BC3: return MTEXT("BC3");
+	case TextureCompression::BC4: return MTEXT("BC4");
+	case TextureCompression::BC5: return MTEXT("BC5");
+	case TextureCompression::BC7: return MTEXT("BC7");
+	default: return MTEXT("NONE");
+	}
+}
+
+String TextureBenchmark::ToJSON(const List<TextureBenchmarkResult> &results, const TextureProcessingOptions &options)
+{
+	static const Char *FILTER[] = { MTEXT("NONE"), MTEXT("BOX"), MTEXT("KAISER") };
+
+	String s = MTEXT("\t\"texture\": {\n");
+	s += strUtils::format(MTEXT("\t\t\"mipFilter\": \"%s\",\n"), FILTER[uint32(options.mipFilter)]);
+	s += strUtils::format(MTEXT("\t\t\"sRGB\": %s,\n"), options.sRGB ? MTEXT("true") : MTEXT("false"));
+	s += strUtils::format(MTEXT("\t\t\"normalMap\": %s,\n"), options.normalMap ? MTEXT("true") : MTEXT("false"));
+	s += strUtils::format(MTEXT("\t\t\"threads\": %u,\n"), options.threadCount);
+	s += MTEXT("\t\t\"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const TextureBenchmarkResult &r = results[i];
+		const TextureProcessingStats &t = r.stats;
+		s += strUtils::format(MTEXT("\t\t\t{ \"format\": \"%s\", \"succeeded\": %s, \"psnr\": %.3f, \"mipTimeMs\": %.3f, \"compressTimeMs\": %.3f, \"compressMBps\": %.3f, \"sourceBytes\": %llu, \"outputBytes\": %llu }%s\n"),
+			ToString(r.compression), r.succeeded ? MTEXT("true") : MTEXT("false"), t.psnr, t.mipTime * 1000.0, t.compressTime * 1000.0,
+			t.compressTime > 0.0 ? t.sourceBytes / t.compressTime / 1.0e6 : 0.0, t.sourceBytes, t.outputBytes, i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t\t]\n");
+	s += MTEXT("\t}");
+	return s;
+}
@@ -0,0 +1,60 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "M3DEngine/GlobalDef.h"
+#include "GraphicsChips/Texture.h"
+#include "GraphicsChips/TextureProcessing.h"
+
+namespace m3d
+{
+
+struct TextureBenchmarkResult
+{
+	TextureCompression compression = TextureCompression::NONE;
+	bool succeeded = false;
+	TextureProcessingStats stats; // From the fastest iteration.
+};
+
+// Runs the import time texture processing (mips and BCn compression) on an image, and measures quality (PSNR) and throughput (MB/s).
+// Only CPU work is measured, so graphics does not have to be initialized.
+class TextureBenchmark
+{
+public:
+	TextureBenchmark();
+	~TextureBenchmark();
+
+	bool Setup(Path image);
+	// Processes the image once per iteration for each of the compressions.
+	List<TextureBenchmarkResult> Run(const TextureProcessingOptions &options, const List<TextureCompression> &compressions, uint32 iterations);
+
+	static const Char *ToString(TextureCompression compression);
+	static String ToJSON(const List<TextureBenchmarkResult> &results, const TextureProcessingOptions &options);
+
+private:
+	Texture *_texture;
+	Path _image;
+};
+
+}
@@ -0,0 +1,671 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "pch.h"
+#include "BenchApplication.h"
+#include "PhysXBenchmark.h"
+#include "TextureBenchmark.h"
+#include "MeshBenchmark.h"
+#include "InstanceBenchmark.h"
+#include "SuiteBenchmark.h"
+#include "ChildBenchmark.h"
+#include "M3DEngine/Engine.h"
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include "M3DCore/Clock.h"
+#include "M3DCore/MemoryTracker.h"
+
+using namespace m3d;
+
+
+void PrintUsage()
+{
+	std::cout << 
+		"Usage: SnaXBench <project> [options]\n"
+		"  -frames <n>       Number of frames to run (default 600).\n"
+		"  -warmup <n>       Number of frames to run before measuring (default 60).\n"
+		"  -substeps <n>     Fixed PhysX substeps per frame (default 2).\n"
+		"  -threads <n>      Number of PhysX dispatcher threads (default 1).\n"
+		"  -broadphase <bp>  Override broad phase: SAP, MBP, ABP or GPU.\n"
+		"  -solver <s>       Override solver: PGS or TGS.\n"
+		"  -memory           Track memory by class, chip type and subsystem, and report the changes after warmup.\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n"
+		"\n"
+		"Usage: SnaXBench -texture <image> [options]\n"
+		"  Measures CPU mip generation and block compression (PSNR and MB/s).\n"
+		"  -format <f>       BC1, BC3, BC4, BC5, BC7, NONE or ALL (default ALL).\n"
+		"  -mipfilter <f>    NONE, BOX or KAISER (default KAISER).\n"
+		"  -linear           The image is not gamma encoded.\n"
+		"  -normalmap        The image is a normal map.\n"
+		"  -iterations <n>   Number of times to process the image per format (default 3).\n"
+		"  -threads <n>      Number of worker threads. 0 for all (default 0).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n"
+		"\n"
+		"Usage: SnaXBench -simplify [options]\n"
+		"  Generates levels of detail for procedural meshes (Hausdorff distance and time).\n"
+		"  -mesh <m>         terrain, sphere or ALL (default ALL).\n"
+		"  -levels <n>       Max number of levels (default 4).\n"
+		"  -reduction <r>    Triangle count of each level relative to the previous (default 0.5).\n"
+		"  -maxerror <e>     Max error relative to the mesh extent (default 0.02).\n"
+		"  -iterations <n>   Number of times to generate the levels per mesh (default 3).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n"
+		"\n"
+		"Usage: SnaXBench -meshlets [options]\n"
+		"  Builds meshlets for procedural meshes and culls them from a set of views (quality, culling rates and time).\n"
+		"  -mesh <m>         terrain, sphere or ALL (default ALL).\n"
+		"  -maxvertices <n>  Max vertices per meshlet (default 64).\n"
+		"  -maxtriangles <n> Max triangles per meshlet (default 124).\n"
+		"  -coneweight <w>   0-1. Favour back face culling over frustum culling (default 0.5).\n"
+		"  -iterations <n>   Number of times to build and cull per mesh (default 3).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n"
+		"\n"
+		"Usage: SnaXBench -instances [options]\n"
+		"  Creates and destroys class instances with and without instance pooling (instances per second).\n"
+		"  -policy <p>       NONE, FIXED, ADAPTIVE or ALL (default ALL).\n"
+		"  -members <n>      Number of instance data members (default 8).\n"
+		"  -batch <n>        Number of instances alive at the same time (default 1000).\n"
+		"  -rounds <n>       Number of batches created and destroyed per iteration (default 100).\n"
+		"  -prewarm          Fill the pool before measuring.\n"
+		"  -iterations <n>   Number of times to run the rounds per policy (default 3).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n"
+		"\n"
+		"Usage: SnaXBench -suite <project|directory>... [options]\n"
+		"  Loads each project, also those found in the directories, and runs it headless with a fixed time step\n"
+		"  (load time, frame times, allocations and chip calls).\n"
+		"  -frames <n>       Number of frames to measure (default 600).\n"
+		"  -warmup <n>       Number of frames to run before measuring (default 60).\n"
+		"  -timestep <us>    Fixed time step in microseconds (default 16667).\n"
+		"  -callframes <n>   Number of extra frames to count chip calls in. 0 for none (default 10).\n"
+		"  -graphics         Initialize graphics instead of running headless.\n"
+		"  -baseline <file>  Compare to a report written earlier. Exits with 1 on regressions.\n"
+		"  -threshold <p>    Percent a metric can be worse than the baseline before it is a regression (default 10).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n"
+		"\n"
+		"Usage: SnaXBench -children [options]\n"
+		"  Traverses chip graphs built in code, and the same graphs in the child layout chips used before (time per child access).\n"
+		"  -shape <s>        DEEP, WIDE, GROWING or ALL (default ALL).\n"
+		"  -chips <n>        Approximate number of chips per graph (default 100000).\n"
+		"  -connections <n>  Single connections per chip for DEEP and WIDE (default 4).\n"
+		"  -growing <n>      Children in the growing connection for GROWING (default 8).\n"
+		"  -iterations <n>   Number of traversals per graph (default 5).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"  -verbose          Print all engine messages.\n";
+}
+
+bool WriteReport(const String &json, Path out)
+{
+	if (out.IsFile()) {
+		std::ofstream f(out.AsString().c_str(), std::ios::out);
+		if (!f.is_open()) {
+			std::cerr << "Failed to open output file: " << out.AsString() << std::endl;
+			return false;
+		}
+		f << json;
+	}
+	else
+		std::cout << json;
+	return true;
+}
+
+int RunTextureBenchmark(int argc, char *argv[])
+{
+	if (argc < 3) {
+		PrintUsage();
+		return -1;
+	}
+
+	Path image = Path::File(argv[2]);
+	TextureProcessingOptions options;
+	List<TextureCompression> compressions = { TextureCompression::NONE, TextureCompression::BC1, TextureCompression::BC3, TextureCompression::BC4, TextureCompression::BC5, TextureCompression::BC7 };
+	uint32 iterations = 3;
+	Path out;
+	bool verbose = false;
+
+	for (int i = 3; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-format") && !v.empty()) {
+			if (v != MTEXT("ALL")) {
+				compressions.clear();
+				for (uint32 j = 0; j <= uint32(TextureCompression::BC7); j++)
+					if (v == TextureBenchmark::ToString(TextureCompression(j)))
+						compressions.push_back(TextureCompression(j));
+				if (compressions.empty()) {
+					std::cerr << "Invalid format: " << v << std::endl;
+					return -1;
+				}
+			}
+			i++;
+		}
+		else if (a == MTEXT("-mipfilter") && (v == MTEXT("NONE") || v == MTEXT("BOX") || v == MTEXT("KAISER"))) {
+			options.mipFilter = v == MTEXT("NONE") ? TextureMipFilter::NONE : (v == MTEXT("BOX") ? TextureMipFilter::BOX : TextureMipFilter::KAISER);
+			i++;
+		}
+		else if (a == MTEXT("-linear")) options.sRGB = false;
+		else if (a == MTEXT("-normalmap")) options.normalMap = true;
+		else if (a == MTEXT("-iterations") && strUtils::toNum(v, iterations)) i++;
+		else if (a == MTEXT("-threads") && strUtils::toNum(v, options.threadCount)) i++;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	if (!image.IsFile()) {
+		std::cerr << "Invalid image: " << argv[2] << std::endl;
+		return -1;
+	}
+
+#ifdef _WIN32
+	CoInitializeEx(nullptr, COINIT_MULTITHREADED); // For the WIC decoders (JPG etc).
+#endif
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init(false)) {
+		app.Destroy();
+		return -1;
+	}
+
+	List<TextureBenchmarkResult> results;
+	{
+		TextureBenchmark texture;
+		if (texture.Setup(image))
+			results = texture.Run(options, compressions, iterations);
+	}
+
+	app.Destroy();
+
+	String json = MTEXT("{\n");
+	json += MTEXT("\t\"image\": \"") + image.GetName() + MTEXT("\",\n");
+	json += TextureBenchmark::ToJSON(results, options) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	bool succeeded = !results.empty();
+	for (const TextureBenchmarkResult &r : results)
+		succeeded = succeeded && r.succeeded;
+	return succeeded ? 0 : 1;
+}
+int RunSimplifyBenchmark(int argc, char *argv[])
+{
+	MeshLODOptions options;
+	options.measureError = true;
+	List<String> meshes = { MTEXT("terrain"), MTEXT("sphere") };
+	uint32 iterations = 3;
+	Path out;
+	bool verbose = false;
+
+	for (int i = 2; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-mesh") && (v == MTEXT("terrain") || v == MTEXT("sphere") || v == MTEXT("ALL"))) {
+			if (v != MTEXT("ALL"))
+				meshes = { v };
+			i++;
+		}
+		else if (a == MTEXT("-levels") && strUtils::toNum(v, options.levelCount)) i++;
+		else if (a == MTEXT("-reduction") && strUtils::toNum(v, options.reduction)) i++;
+		else if (a == MTEXT("-maxerror") && strUtils::toNum(v, options.maxError)) i++;
+		else if (a == MTEXT("-iterations") && strUtils::toNum(v, iterations)) i++;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init(false)) {
+		app.Destroy();
+		return -1;
+	}
+
+	List<MeshBenchmarkResult> results;
+	{
+		MeshBenchmark mesh;
+		if (mesh.Setup())
+			results = mesh.Run(options, meshes, iterations);
+	}
+
+	app.Destroy();
+
+	String json = MTEXT("{\n");
+	json += MeshBenchmark::ToJSON(results, options) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	bool succeeded = !results.empty();
+	for (const MeshBenchmarkResult &r : results)
+		succeeded = succeeded && r.succeeded;
+	return succeeded ? 0 : 1;
+}
+
+int RunMeshletBenchmark(int argc, char *argv[])
+{
+	MeshletOptions options;
+	List<String> meshes = { MTEXT("terrain"), MTEXT("sphere") };
+	uint32 iterations = 3;
+	Path out;
+	bool verbose = false;
+
+	for (int i = 2; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-mesh") && (v == MTEXT("terrain") || v == MTEXT("sphere") || v == MTEXT("ALL"))) {
+			if (v != MTEXT("ALL"))
+				meshes = { v };
+			i++;
+		}
+		else if (a == MTEXT("-maxvertices") && strUtils::toNum(v, options.maxVertices)) i++;
+		else if (a == MTEXT("-maxtriangles") && strUtils::toNum(v, options.maxTriangles)) i++;
+		else if (a == MTEXT("-coneweight") && strUtils::toNum(v, options.coneWeight)) i++;
+		else if (a == MTEXT("-iterations") && strUtils::toNum(v, iterations)) i++;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init(false)) {
+		app.Destroy();
+		return -1;
+	}
+
+	List<MeshletBenchmarkResult> results;
+	{
+		MeshBenchmark mesh;
+		if (mesh.Setup())
+			results = mesh.RunMeshlets(options, meshes, iterations);
+	}
+
+	app.Destroy();
+
+	String json = MTEXT("{\n");
+	json += MeshBenchmark::ToJSON(results, options) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	bool succeeded = !results.empty();
+	for (const MeshletBenchmarkResult &r : results)
+		succeeded = succeeded && r.succeeded;
+	return succeeded ? 0 : 1;
+}
+
+int RunInstanceBenchmark(int argc, char *argv[])
+{
+	InstanceBenchmarkOptions options;
+	List<InstancePoolPolicy> policies = { InstancePoolPolicy::NONE, InstancePoolPolicy::FIXED, InstancePoolPolicy::ADAPTIVE };
+	uint32 iterations = 3;
+	Path out;
+	bool verbose = false;
+
+	for (int i = 2; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-policy") && (v == MTEXT("NONE") || v == MTEXT("FIXED") || v == MTEXT("ADAPTIVE") || v == MTEXT("ALL"))) {
+			if (v != MTEXT("ALL"))
+				policies = { v == MTEXT("NONE") ? InstancePoolPolicy::NONE : (v == MTEXT("FIXED") ? InstancePoolPolicy::FIXED : InstancePoolPolicy::ADAPTIVE) };
+			i++;
+		}
+		else if (a == MTEXT("-members") && strUtils::toNum(v, options.dataMembers)) i++;
+		else if (a == MTEXT("-batch") && strUtils::toNum(v, options.batchSize)) i++;
+		else if (a == MTEXT("-rounds") && strUtils::toNum(v, options.rounds)) i++;
+		else if (a == MTEXT("-prewarm")) options.prewarm = true;
+		else if (a == MTEXT("-iterations") && strUtils::toNum(v, iterations)) i++;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init(false)) {
+		app.Destroy();
+		return -1;
+	}
+
+	List<InstanceBenchmarkResult> results;
+	{
+		InstanceBenchmark instances;
+		if (instances.Setup(options))
+			results = instances.Run(options, policies, iterations);
+	}
+
+	app.Destroy();
+
+	String json = MTEXT("{\n");
+	json += InstanceBenchmark::ToJSON(results, options) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	bool succeeded = !results.empty();
+	for (const InstanceBenchmarkResult &r : results)
+		succeeded = succeeded && r.succeeded;
+	return succeeded ? 0 : 1;
+}
+
+int RunSuiteBenchmark(int argc, char *argv[])
+{
+	List<Path> projects;
+	SuiteBenchmarkOptions options;
+	Path baseline;
+	float64 threshold = 10.0;
+	bool graphics = false;
+	Path out;
+	bool verbose = false;
+
+	for (int i = 2; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-frames") && strUtils::toNum(v, options.frames)) i++;
+		else if (a == MTEXT("-warmup") && strUtils::toNum(v, options.warmupFrames)) i++;
+		else if (a == MTEXT("-timestep") && strUtils::toNum(v, options.timestep)) i++;
+		else if (a == MTEXT("-callframes") && strUtils::toNum(v, options.callFrames)) i++;
+		else if (a == MTEXT("-graphics")) graphics = true;
+		else if (a == MTEXT("-baseline") && !v.empty()) { baseline = Path::File(v); i++; }
+		else if (a == MTEXT("-threshold") && strUtils::toNum(v, threshold)) i++;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else if (!a.empty() && a[0] != MCHAR('-')) {
+			std::error_code ec;
+			if (std::filesystem::is_regular_file(a.c_str(), ec))
+				projects.push_back(Path::File(a));
+			else {
+				List<Path> found = SuiteBenchmark::FindProjects(Path::Dir(a));
+				projects.insert(projects.end(), found.begin(), found.end());
+			}
+		}
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	if (projects.empty()) {
+		std::cerr << "No projects found." << std::endl;
+		return -1;
+	}
+
+	options.timestep = std::max(options.timestep, 1ll);
+
+	memoryTracker().SetEnabled(true);
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init(graphics, !graphics)) {
+		app.Destroy();
+		return -1;
+	}
+
+	SuiteBenchmark suite;
+	List<SuiteBenchmarkResult> results;
+	for (size_t i = 0; i < projects.size() && !app.IsQuitRequested(); i++) {
+		if (verbose)
+			std::cerr << "Running " << projects[i].AsString() << std::endl;
+		results.push_back(suite.Run(app, projects[i], options));
+	}
+
+	String json = MTEXT("{\n");
+	json += SuiteBenchmark::ToJSON(results, options);
+
+	app.Destroy();
+
+	List<SuiteBenchmarkComparison> comparisons;
+	if (baseline.IsFile()) {
+		if (!SuiteBenchmark::Compare(baseline, results, threshold, comparisons))
+			return -1;
+		json += MTEXT(",\n") + SuiteBenchmark::ToJSON(comparisons, baseline, threshold);
+	}
+	json += MTEXT("\n}\n");
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	bool succeeded = true;
+	for (const SuiteBenchmarkResult &r : results)
+		succeeded = succeeded && r.loaded;
+	for (const SuiteBenchmarkComparison &c : comparisons)
+		succeeded = succeeded && !c.regressed;
+	return succeeded ? 0 : 1;
+}
+
+int RunChildBenchmark(int argc, char *argv[])
+{
+	ChildBenchmarkOptions options;
+	List<ChildGraphShape> shapes = { ChildGraphShape::DEEP, ChildGraphShape::WIDE, ChildGraphShape::GROWING };
+	uint32 iterations = 5;
+	Path out;
+	bool verbose = false;
+
+	for (int i = 2; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-shape") && (v == MTEXT("DEEP") || v == MTEXT("WIDE") || v == MTEXT("GROWING") || v == MTEXT("ALL"))) {
+			if (v != MTEXT("ALL"))
+				shapes = { v == MTEXT("DEEP") ? ChildGraphShape::DEEP : (v == MTEXT("WIDE") ? ChildGraphShape::WIDE : ChildGraphShape::GROWING) };
+			i++;
+		}
+		else if (a == MTEXT("-chips") && strUtils::toNum(v, options.chips)) i++;
+		else if (a == MTEXT("-connections") && strUtils::toNum(v, options.connections)) i++;
+		else if (a == MTEXT("-growing") && strUtils::toNum(v, options.growing)) i++;
+		else if (a == MTEXT("-iterations") && strUtils::toNum(v, iterations)) i++;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init(false)) {
+		app.Destroy();
+		return -1;
+	}
+
+	ChildBenchmark children;
+	List<ChildBenchmarkResult> results = children.Run(options, shapes, iterations);
+
+	app.Destroy();
+
+	String json = MTEXT("{\n");
+	json += ChildBenchmark::ToJSON(results, options) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	bool succeeded = !results.empty();
+	for (const ChildBenchmarkResult &r : results)
+		succeeded = succeeded && r.succeeded;
+	return succeeded ? 0 : 1;
+}
+
+
+int main(int argc, char *argv[])
+{
+#ifdef _WIN32
+	SetErrorMode(SEM_FAILCRITICALERRORS); // Without this, calling LoadLibrary() that fail, will quit the application...
+#endif
+
+	if (argc < 2) {
+		PrintUsage();
+		return -1;
+	}
+
+	if (String(argv[1]) == MTEXT("-texture"))
+		return RunTextureBenchmark(argc, argv);
+	if (String(argv[1]) == MTEXT("-simplify"))
+		return RunSimplifyBenchmark(argc, argv);
+	if (String(argv[1]) == MTEXT("-meshlets"))
+		return RunMeshletBenchmark(argc, argv);
+	if (String(argv[1]) == MTEXT("-instances"))
+		return RunInstanceBenchmark(argc, argv);
+	if (String(argv[1]) == MTEXT("-suite"))
+		return RunSuiteBenchmark(argc, argv);
+	if (String(argv[1]) == MTEXT("-children"))
+		return RunChildBenchmark(argc, argv);
+
+	Path project = Path::File(argv[1]);
+	uint32 frames = 600, warmup = 60;
+	PhysXBenchmarkSettings settings;
+	settings.substepsPerFrame = 2;
+	settings.recordStepTimes = true;
+	Path out;
+	bool verbose = false;
+	bool memory = false;
+
+	for (int i = 2; i < argc; i++) {
+		String a = argv[i];
+		String v = i + 1 < argc ? argv[i + 1] : MTEXT("");
+		if (a == MTEXT("-frames") && strUtils::toNum(v, frames)) i++;
+		else if (a == MTEXT("-warmup") && strUtils::toNum(v, warmup)) i++;
+		else if (a == MTEXT("-substeps") && strUtils::toNum(v, settings.substepsPerFrame)) i++;
+		else if (a == MTEXT("-threads") && strUtils::toNum(v, settings.dispatcherThreads)) i++;
+		else if (a == MTEXT("-broadphase") && (v == MTEXT("SAP") || v == MTEXT("MBP") || v == MTEXT("ABP") || v == MTEXT("GPU"))) {
+			settings.overrideBroadPhaseType = true;
+			settings.broadPhaseType = v == MTEXT("SAP") ? PxBroadPhaseType::eSAP : (v == MTEXT("MBP") ? PxBroadPhaseType::eMBP : (v == MTEXT("ABP") ? PxBroadPhaseType::eABP : PxBroadPhaseType::eGPU));
+			i++;
+		}
+		else if (a == MTEXT("-solver") && (v == MTEXT("PGS") || v == MTEXT("TGS"))) {
+			settings.overrideSolverType = true;
+			settings.solverType = v == MTEXT("PGS") ? PxSolverType::ePGS : PxSolverType::eTGS;
+			i++;
+		}
+		else if (a == MTEXT("-memory")) memory = true;
+		else if (a == MTEXT("-out") && !v.empty()) { out = Path::File(v); i++; }
+		else if (a == MTEXT("-verbose")) verbose = true;
+		else {
+			std::cerr << "Invalid argument: " << a << std::endl;
+			PrintUsage();
+			return -1;
+		}
+	}
+
+	if (!project.IsFile()) {
+		std::cerr << "Invalid project: " << argv[1] << std::endl;
+		return -1;
+	}
+
+	settings.substepsPerFrame = std::max(settings.substepsPerFrame, 1u);
+
+	memoryTracker().SetEnabled(memory);
+
+	BenchApplication app;
+	app.SetVerbosity(verbose ? DINFO : WARN);
+
+	if (!app.Init()) {
+		app.Destroy();
+		return -1;
+	}
+
+	PhysXBenchmark physx;
+	if (!physx.Setup(settings)) {
+		app.Destroy();
+		return -1;
+	}
+
+	int64 loadStart = Clock::GetTime_ns();
+	if (!app.LoadProject(project)) {
+		app.Destroy();
+		return -1;
+	}
+	float64 loadTime = Clock::ToSeconds(Clock::GetTime_ns() - loadStart);
+
+	for (uint32 i = 0; i < warmup && !app.IsQuitRequested(); i++)
+		engine->Run();
+
+	physx.ClearStepTimes();
+
+	MemorySnapshot memoryAfterWarmup = memoryTracker().TakeSnapshot();
+
+	uint32 framesRun = 0;
+	int64 runStart = Clock::GetTime_ns();
+	for (; framesRun < frames && !app.IsQuitRequested(); framesRun++)
+		engine->Run();
+	float64 runTime = Clock::ToSeconds(Clock::GetTime_ns() - runStart);
+
+	PhysXBenchmarkResult r = physx.Collect();
+
+	MemorySnapshot memoryAtEnd = memoryTracker().TakeSnapshot();
+
+	String json = MTEXT("{\n");
+	json += MTEXT("\t\"project\": \"") + project.GetName() + MTEXT("\",\n");
+	json += strUtils::format(MTEXT("\t\"frames\": %u,\n"), framesRun);
+	json += strUtils::format(MTEXT("\t\"warmupFrames\": %u,\n"), warmup);
+	json += strUtils::format(MTEXT("\t\"loadTimeMs\": %.3f,\n"), loadTime * 1000.0);
+	json += strUtils::format(MTEXT("\t\"runTimeMs\": %.3f,\n"), runTime * 1000.0);
+	if (memory) {
+		json += MTEXT("\t\"memory\": ") + memoryAtEnd.ToJson() + MTEXT(",\n");
+		json += MTEXT("\t\"memoryChanges\": ") + MemorySnapshotDiff::Compute(memoryAfterWarmup, memoryAtEnd).ToJson() + MTEXT(",\n");
+	}
+	json += PhysXBenchmark::ToJSON(r, settings) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	app.Destroy();
+
+	if (!WriteReport(json, out))
+		return -1;
+
+	return r.sceneCount > 0 ? 0 : 1;
+}
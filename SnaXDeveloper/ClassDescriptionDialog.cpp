@@ -46,6 +46,10 @@ void ClassDescriptionDialog::SetClass(class ClassExt* cl)
 	_initDesc = TOQSTRING(_class->GetDescription());
 	ui.textEdit->setPlainText(_initDesc);
 
+	ui.comboBox_poolPolicy->setCurrentIndex((int)_class->GetInstancePoolPolicy());
+	ui.spinBox_poolCapacity->setValue((int)_class->GetInstancePoolCapacity());
+	_updatePoolStats();
+
 	UpdateWindowTitle();
 }
 
@@ -62,5 +66,19 @@ void ClassDescriptionDialog::accept()
 		_class->SetDirty();
 	}
 
+	InstancePoolPolicy policy = (InstancePoolPolicy)ui.comboBox_poolPolicy->currentIndex();
+	uint32 capacity = (uint32)ui.spinBox_poolCapacity->value();
+	if (policy != _class->GetInstancePoolPolicy() || capacity != _class->GetInstancePoolCapacity()) {
+		_class->SetInstancePoolCapacity(capacity);
+		_class->SetInstancePoolPolicy(policy);
+		_class->SetDirty();
+	}
+
 	QDialog::accept();
-}
\ No newline at end of file
+}
+void ClassDescriptionDialog::_updatePoolStats()
+{
+	const InstancePoolStats &s = _class->GetInstancePoolStats();
+	ui.label_poolStats->setText(QString("Created: %1, Prewarmed: %2, Reused: %3, Recycled: %4, Discarded: %5\nPooled: %6 (peak %7), Peak live: %8")
+		.arg(s.created).arg(s.prewarmed).arg(s.reused).arg(s.recycled).arg(s.discarded).arg(s.pooled).arg(s.peakPooled).arg(s.peakLive));
+}
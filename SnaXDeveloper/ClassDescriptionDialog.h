@@ -47,6 +47,8 @@ private:
 	class ClassExt* _class = nullptr;
 
 	QString _initDesc;
+
+	void _updatePoolStats();
 };
 
 
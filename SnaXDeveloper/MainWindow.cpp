@@ -131,6 +131,9 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 	_actions.profilingAccumulate = new QAction("Floating", this);
 	_actions.profilingAccumulate->setCheckable(true);
 	_actions.profilingReset = new QAction("Reset", this);
+	_actions.profilerCaptureFrames = new QAction("Capture Frames...", this);
+	_actions.profilerCaptureSlowFrames = new QAction("Capture Slow Frames...", this);
+	_actions.compileShaders = new QAction("Compile Changed Shaders", this);
 	_actions.options = new QAction(QIcon(":/EditorApp/Resources/gears.png"), "Settings...", this);
 	_actions.limit_Frame_Rate = new QAction("Limit Frame Rate to V-Sync", this);
 	_actions.limit_Frame_Rate->setCheckable(true);
@@ -149,6 +152,9 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 	connect(_actions.render_World_Space_AABB, &QAction::triggered, this, &MainWindow::updateDebugGeometryFromMenu);
 	connect(_actions.render_Local_Space_AABB, &QAction::triggered, this, &MainWindow::updateDebugGeometryFromMenu);
 	connect(_actions.profilingReset, &QAction::triggered, this, &MainWindow::onResetProfiling);
+	connect(_actions.profilerCaptureFrames, &QAction::triggered, this, [this]() { onProfilerCapture(false); });
+	connect(_actions.profilerCaptureSlowFrames, &QAction::triggered, this, [this]() { onProfilerCapture(true); });
+	connect(_actions.compileShaders, &QAction::triggered, this, &MainWindow::onCompileShaders);
 	connect(_actions.options, &QAction::triggered, this, &MainWindow::onOptions);
 	connect(_actions.limit_Frame_Rate, &QAction::triggered, this, &MainWindow::onLimitFPSChanged);
 	connect(_actions.help, &QAction::triggered, this, &MainWindow::showHelp);
@@ -197,6 +203,7 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 	ui.menuFile->addAction(ActionManager::instance().getAction(ActionID::SAVE_ALL));
 	ui.menuFile->addSeparator();
 	ui.menuFile->addAction(ActionManager::instance().getAction(ActionID::LOAD_ALL));
+	ui.menuFile->addAction(_actions.compileShaders);
 	ui.menuFile->addSeparator();
 	ui.menuFile->addAction(ActionManager::instance().getAction(ActionID::PUBLISH));
 	ui.menuFile->addSeparator();
@@ -228,6 +235,9 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 	profilingMenu->addAction(_actions.profilingAccumulate);
 	profilingMenu->addSeparator();
 	profilingMenu->addAction(_actions.profilingReset);
+	profilingMenu->addSeparator();
+	profilingMenu->addAction(_actions.profilerCaptureFrames);
+	profilingMenu->addAction(_actions.profilerCaptureSlowFrames);
 	ui.menuView->addSeparator();
 	QAction *externalAction = ui.menuView->addAction(QIcon(":/EditorApp/Resources/windows-couple.png"), "External Project View");
 	QMenu *externalMenu = new QMenu();
@@ -180,6 +180,9 @@ private:
 		QAction *profilingPrFrame;
 		QAction *profilingAccumulate;
 		QAction *profilingReset;
+		QAction *profilerCaptureFrames;
+		QAction *profilerCaptureSlowFrames;
+		QAction *compileShaders;
 		QAction *options;
 		QAction *limit_Frame_Rate;
 		QAction *help;
@@ -257,12 +260,14 @@ private:
 	void onOpenRecentProject(QAction*);
 	void onProfilingChanged(QAction*);
 	void onResetProfiling();
+	void onProfilerCapture(bool slowFrames);
 	void onLimitFPSChanged();
 	void onPublish();
 	void showChipDialog(Chip*, bool=false, unsigned=0);
 	void showClassDescriptionDialog(ClassExt*);
 	void showInstanceDialog(ClassInstance*);
 	void onLoadAllProjectFiles();
+	void onCompileShaders();
 	void updateDebugGeometryMenu();
 	void updateDebugGeometryFromMenu();
 	void onShowRecoveryDlg(QString msg, int *result);
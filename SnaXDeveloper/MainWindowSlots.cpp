@@ -37,7 +37,9 @@
 #include "M3DEngine/Application.h"
 #include "StdChips\Importer.h"
 #include "M3DEngine/ClassInstance.h"
+#include "M3DEngine/Profiler.h"
 #include "GraphicsChips\Graphics.h"
+#include "GraphicsChips\Shader.h"
 #include "StdChips\ProxyChip.h"
 #include "PublishWizard.h"
 #include "AboutDialog.h"
@@ -456,6 +458,16 @@ void MainWindow::onLoadAllProjectFiles()
 	_restoringClasss = false;
 }
 
+void MainWindow::onCompileShaders()
+{
+	ScopedOverrideCursor oc(Qt::WaitCursor);
+
+	// Only shaders changed since last compiled, including changes to the code they include. Unchanged shaders are found
+	// by the cache key, and changed shaders often hit the shader cache too. The result is written to the message log.
+	if (Graphics *g = engine->GetGraphics())
+		g->CompileProjectShaders(true);
+}
+
 void MainWindow::showChipDialog(Chip *chip, bool showComment, unsigned embeddedID)
 {
 	// If asked for dialog for instance data, check if an instance is selected in instance list (If selected in tab!), and show dialog for its instance data instead......
@@ -515,6 +527,40 @@ void MainWindow::onResetProfiling()
 	functionStack.ResetPerfFrame();
 }
 
+void MainWindow::onProfilerCapture(bool slowFrames)
+{
+	if (profiler.IsCapturing()) {
+		if (QMessageBox::question(this, "Profiler", "A capture is already running. Stop it?") == QMessageBox::Yes)
+			profiler.StopCapture();
+		return;
+	}
+
+	bool ok = false;
+	float64 thresholdMs = 0.0;
+	if (slowFrames) {
+		thresholdMs = QInputDialog::getDouble(this, "Capture Slow Frames", "Keep frames taking at least (ms):", 33.3, 0.1, 10000.0, 1, &ok);
+		if (!ok)
+			return;
+	}
+	int frameCount = QInputDialog::getInt(this, slowFrames ? "Capture Slow Frames" : "Capture Frames", "Number of frames to keep:", slowFrames ? 10 : 60, 1, 100000, 1, &ok);
+	if (!ok)
+		return;
+
+	_frameTimer->stop(); // FIX: Got to stop the timer for the file-dialog to refresh correctly!
+	QString fn = QFileDialog::getSaveFileName(this, "Export Profiler Trace", _currentDir + "\\Profile.json", "Chrome Trace (*.json)", 0, QFileDialog::Options());
+	_frameTimer->start();
+	if (fn.isEmpty())
+		return;
+
+	// The trace is exported when the capture completes. Open it in chrome://tracing or ui.perfetto.dev.
+	profiler.SetAutoExportFile(Path::File(FROMQSTRING(fn)));
+	if (slowFrames)
+		profiler.CaptureSlowFrames(thresholdMs, (uint32)frameCount);
+	else
+		profiler.CaptureFrames((uint32)frameCount);
+	msg(INFO, strUtils::ConstructString(MTEXT("Profiler: Capturing %1 frames to \'%2\'.")).arg((uint32)frameCount).arg(FROMQSTRING(fn)));
+}
+
 void MainWindow::onLimitFPSChanged()
 {
 	_limitFPS = _actions.limit_Frame_Rate->isChecked();
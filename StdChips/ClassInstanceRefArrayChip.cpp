@@ -162,6 +162,11 @@ void ClassInstanceRefArrayChip::ClearContainer()
 	_clear();
 }
 
+uint64 ClassInstanceRefArrayChip::GetMemoryUsage() const
+{
+	return ArrayChip::GetMemoryUsage() + (sizeof(ClassInstanceRefArrayChip) - sizeof(ArrayChip)) + _array.capacity() * sizeof(ClassInstanceRef);
+}
+
 ClassInstanceRef ClassInstanceRefArrayChip::GetInstance(uint32 index)
 {
 	if (index < _array.size())
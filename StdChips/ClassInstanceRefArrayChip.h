@@ -56,6 +56,7 @@ public:
 	uint32 GetContainerSize() override;
 	void SetContainerSize(uint32 size) override;
 	void ClearContainer() override;
+	uint64 GetMemoryUsage() const override;
 
 	void SetClass(Class* clazz) override;
 
@@ -119,7 +119,10 @@ void Command::CallChip()
 			ChildPtr<Value> ch4 = GetChild(4);
 			ChildPtr<Value> ch5 = GetChild(5);
 			ChildPtr<Value> ch6 = GetChild(6);
-			Window *w = engine->GetGraphics()->GetRenderWindowManager()->GetWindow();
+			RenderWindowManager *rwm = engine->GetGraphics()->GetRenderWindowManager();
+			Window *w = rwm ? rwm->GetWindow() : nullptr;
+			if (!w)
+				return; // No window, eg when running headless.
 			if (w->GetParentWindow() != NULL)
 				return; // Not supported for non top level windows.
 			if (ch0) {
@@ -129,7 +132,7 @@ void Command::CallChip()
 					flags |= SWP_NOMOVE;
 				if (!w->CanResize())
 					flags |= SWP_NOSIZE;
-				engine->GetGraphics()->GetRenderWindowManager()->GetWindow()->SetWindowPos((INT)v.x, (INT)v.y, (INT)v.z, (INT)v.w, flags);
+				w->SetWindowPos((INT)v.x, (INT)v.y, (INT)v.z, (INT)v.w, flags);
 			}
 			String title;
 			if (ch1)
@@ -0,0 +1,95 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "FrameStatistics.h"
+#include "M3DEngine/DocumentSaveLoadUtil.h"
+
+
+using namespace m3d;
+
+
+CHIPDESCV1_DEF(FrameStatistics, MTEXT("Frame Statistics"), FRAMESTATISTICS_GUID, VALUE_GUID);
+
+
+FrameStatistics::FrameStatistics()
+{
+	_series = FrameStatsSeries::FRAME_INTERVAL;
+	_statistic = Statistic::P50;
+	_window = true;
+}
+
+FrameStatistics::~FrameStatistics()
+{
+}
+
+bool FrameStatistics::CopyChip(Chip *chip)
+{
+	FrameStatistics *c = dynamic_cast<FrameStatistics*>(chip);
+	B_RETURN(Value::CopyChip(c));
+	_series = c->_series;
+	_statistic = c->_statistic;
+	_window = c->_window;
+	return true;
+}
+
+bool FrameStatistics::LoadChip(DocumentLoader &loader) 
+{ 
+	B_RETURN(Value::LoadChip(loader));
+	LOAD(MTEXT("series"), _series);
+	LOAD(MTEXT("statistic"), _statistic);
+	LOAD(MTEXT("window"), _window);
+	return true;
+}
+
+bool FrameStatistics::SaveChip(DocumentSaver &saver) const 
+{
+	B_RETURN(Value::SaveChip(saver));
+	SAVE(MTEXT("series"), _series);
+	SAVE(MTEXT("statistic"), _statistic);
+	SAVE(MTEXT("window"), _window);
+	return true;
+}
+
+value FrameStatistics::GetValue()
+{
+	RefreshT refresh(Refresh);
+	if (refresh) {
+		if (_series >= FrameStatsSeries::COUNT)
+			return _value = 0.0;
+		FrameStatsReport r = frameStats.GetReport(_series, _window);
+		switch (_statistic) 
+		{
+		case Statistic::P50: _value = r.p50; break;
+		case Statistic::P95: _value = r.p95; break;
+		case Statistic::P99: _value = r.p99; break;
+		case Statistic::MAX: _value = r.max; break;
+		case Statistic::MEAN: _value = r.mean; break;
+		case Statistic::COUNT: _value = (value)r.count; break;
+		case Statistic::HITCHES: _value = (value)r.hitches; break;
+		default: _value = 0.0; break;
+		}
+	}
+	return _value;
+}
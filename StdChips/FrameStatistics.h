@@ -0,0 +1,81 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+
+#include "Exports.h"
+#include "Value.h"
+#include "M3DEngine/FrameStats.h"
+
+
+namespace m3d
+{
+
+
+static const Guid FRAMESTATISTICS_GUID = { 0xd404ed65, 0xf999, 0x4db4, { 0x94, 0xbe, 0xf5, 0x6a, 0x98, 0xc0, 0xad, 0x64 } };
+
+// Gives a statistic (in milliseconds, or a count) of one of the engine frame time series. See FrameStats.
+class STDCHIPS_API FrameStatistics : public Value
+{
+	CHIPDESC_DECL;
+public:
+	FrameStatistics();
+	virtual ~FrameStatistics();
+
+	virtual bool CopyChip(Chip *chip) override;
+	virtual bool LoadChip(DocumentLoader &loader) override;
+	virtual bool SaveChip(DocumentSaver &saver) const override;
+
+	virtual value GetValue() override;
+	virtual void SetValue(value v) override {}
+
+	enum class Statistic
+	{
+		P50,
+		P95,
+		P99,
+		MAX,
+		MEAN,
+		COUNT,
+		HITCHES
+	};
+
+	virtual FrameStatsSeries GetSeries() const { return _series; }
+	virtual void SetSeries(FrameStatsSeries series) { _series = series; }
+	virtual Statistic GetStatistic() const { return _statistic; }
+	virtual void SetStatistic(Statistic statistic) { _statistic = statistic; }
+	// true to use the rolling window of the latest frames, false for all frames since last reset.
+	virtual bool IsWindow() const { return _window; }
+	virtual void SetWindow(bool window) { _window = window; }
+
+protected:
+	FrameStatsSeries _series;
+	Statistic _statistic;
+	bool _window;
+};
+
+
+
+}
@@ -76,6 +76,11 @@ void MatrixArray::ClearContainer()
 	_array.clear(); 
 }
 
+uint64 MatrixArray::GetMemoryUsage() const
+{
+	return ArrayChip::GetMemoryUsage() + (sizeof(MatrixArray) - sizeof(ArrayChip)) + _array.capacity() * sizeof(XMFLOAT4X4);
+}
+
 void MatrixArray::SetArray(const ArrayType &a)
 { 
 	_array = a; 
@@ -46,12 +46,14 @@ public:
 	virtual ~MatrixArray();
 
 	virtual bool CopyChip(Chip *chip) override;
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == MATRIXARRAY_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
 	virtual uint32 GetContainerSize() override;
 	virtual void SetContainerSize(uint32 size) override;
 	virtual void ClearContainer() override;
+	virtual uint64 GetMemoryUsage() const override;
 
 	virtual const ArrayType &GetArray() const { return _array; }
 	virtual ArrayType &GetArray() { return _array; }
@@ -45,6 +45,8 @@ public:
 
 	virtual bool InitChip() override;
 	virtual bool CopyChip(Chip *chip) override;
+	// Only plain Matrix chips, as derived chips may hold more than CopyChip() sets.
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == MATRIXCHIP_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
@@ -0,0 +1,101 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "pch.h"
+#include "MemoryStatistics.h"
+#include "M3DEngine/DocumentSaveLoadUtil.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ClassManager.h"
+
+
+using namespace m3d;
+
+
+CHIPDESCV1_DEF(MemoryStatistics, MTEXT("Memory Statistics"), MEMORYSTATISTICS_GUID, VALUE_GUID);
+
+
+MemoryStatistics::MemoryStatistics()
+{
+	_tag = InvalidMemoryTag;
+	_statistic = Statistic::LIVE;
+}
+
+MemoryStatistics::~MemoryStatistics()
+{
+}
+
+bool MemoryStatistics::CopyChip(Chip *chip)
+{
+	MemoryStatistics *c = dynamic_cast<MemoryStatistics*>(chip);
+	B_RETURN(Value::CopyChip(c));
+	SetTagName(c->_tagName);
+	_statistic = c->_statistic;
+	return true;
+}
+
+bool MemoryStatistics::LoadChip(DocumentLoader &loader) 
+{ 
+	B_RETURN(Value::LoadChip(loader));
+	String tagName;
+	LOAD(MTEXT("tagName"), tagName);
+	LOAD(MTEXT("statistic"), _statistic);
+	SetTagName(tagName);
+	return true;
+}
+
+bool MemoryStatistics::SaveChip(DocumentSaver &saver) const 
+{
+	B_RETURN(Value::SaveChip(saver));
+	SAVE(MTEXT("tagName"), _tagName);
+	SAVE(MTEXT("statistic"), _statistic);
+	return true;
+}
+
+void MemoryStatistics::SetTagName(String tagName)
+{
+	_tagName = tagName;
+	_tag = _tagName.empty() ? InvalidMemoryTag : memoryTracker().RegisterTag(_tagName);
+}
+
+value MemoryStatistics::GetValue()
+{
+	RefreshT refresh(Refresh);
+	if (refresh) {
+		static uint32 lastCollectedFrame = 0;
+		if (memoryTracker().IsEnabled() && lastCollectedFrame != engine->GetFrameNr()) {
+			engine->GetClassManager()->CollectMemoryUsage();
+			lastCollectedFrame = engine->GetFrameNr();
+		}
+		MemoryTagStats s = memoryTracker().GetStats(_tag);
+		switch (_statistic) 
+		{
+		case Statistic::LIVE: _value = (value)s.live; break;
+		case Statistic::PEAK: _value = (value)s.peak; break;
+		case Statistic::ALLOCATIONS: _value = (value)s.allocations; break;
+		case Statistic::ALLOCATED_BYTES: _value = (value)s.allocatedBytes; break;
+		default: _value = 0.0; break;
+		}
+	}
+	return _value;
+}
@@ -0,0 +1,80 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+
+#include "Exports.h"
+#include "Value.h"
+
+
+namespace m3d
+{
+
+
+static const Guid MEMORYSTATISTICS_GUID = { 0xb951a3c5, 0xee48, 0x4cb9, { 0x99, 0x66, 0x69, 0x98, 0xd0, 0x3d, 0xbc, 0xb1 } };
+
+// Gives a statistic of a memory tag, eg "Class/MyClass", "Chip/Value Array" or "Textures". See MemoryTracker.
+// Memory used by chips and classes is measured at most once per frame when read.
+class STDCHIPS_API MemoryStatistics : public Value
+{
+	CHIPDESC_DECL;
+public:
+	MemoryStatistics();
+	virtual ~MemoryStatistics();
+
+	virtual bool CopyChip(Chip *chip) override;
+	virtual bool LoadChip(DocumentLoader &loader) override;
+	virtual bool SaveChip(DocumentSaver &saver) const override;
+
+	virtual value GetValue() override;
+	virtual void SetValue(value v) override {}
+
+	enum class Statistic
+	{
+		LIVE,
+		PEAK,
+		ALLOCATIONS,
+		ALLOCATED_BYTES
+	};
+
+	virtual String GetTagName() const { return _tagName; }
+	virtual void SetTagName(String tagName);
+	virtual Statistic GetStatistic() const { return _statistic; }
+	virtual void SetStatistic(Statistic statistic) { _statistic = statistic; }
+
+	// Snapshot to compare the current state to. Kept by the chip for the dialog.
+	virtual const MemorySnapshot &GetSnapshot() const { return _snapshot; }
+	virtual void SetSnapshot(MemorySnapshot &&snapshot) { _snapshot = std::move(snapshot); }
+
+protected:
+	String _tagName;
+	MemoryTag _tag;
+	Statistic _statistic;
+	MemorySnapshot _snapshot;
+};
+
+
+
+}
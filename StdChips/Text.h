@@ -42,6 +42,8 @@ public:
 	virtual ~Text();
 
 	virtual bool CopyChip(Chip *chip) override;
+	// Only plain Text chips, as derived chips may hold more than CopyChip() sets.
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == TEXT_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
@@ -54,6 +56,8 @@ public:
 
 	virtual String GetValueAsString() const override;
 
+	// Only plain Text chips. Derived chips override GetText().
+	virtual bool IsUpdateStampTracked() const override { return GetChipDesc().type == TEXT_GUID; }
 
 private:
 	String _text;
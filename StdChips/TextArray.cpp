@@ -76,6 +76,14 @@ void TextArray::ClearContainer()
 	_array.clear();
 }
 
+uint64 TextArray::GetMemoryUsage() const
+{
+	uint64 r = ArrayChip::GetMemoryUsage() + (sizeof(TextArray) - sizeof(ArrayChip)) + _array.capacity() * sizeof(String);
+	for (const String &t : _array)
+		r += t.capacity();
+	return r;
+}
+
 const TextArray::ArrayType& TextArray::GetArray()
 {
 	return _array;
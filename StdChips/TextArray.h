@@ -44,6 +44,7 @@ public:
 	~TextArray();
 	
 	bool CopyChip(Chip* chip) override;
+	bool OnInstanceRecycled(Chip* chip) override { return GetChipDesc().type == TEXTARRAY_GUID && CopyChip(chip); }
 	bool LoadChip(DocumentLoader& loader) override;
 	bool SaveChip(DocumentSaver& saver) const override;
 
@@ -51,6 +52,7 @@ public:
 	uint32 GetContainerSize() override;
 	void SetContainerSize(uint32 size) override;
 	void ClearContainer() override;
+	uint64 GetMemoryUsage() const override;
 
 	virtual const ArrayType& GetArray();
 	virtual void SetArray(const ArrayType& a);
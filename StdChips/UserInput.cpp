@@ -130,6 +130,15 @@ value UserInput::GetValue()
 	return _value;
 }
 
+// The window rendered to. nullptr if there is none, eg when running headless.
+static Window *GetRenderWindowWindow()
+{
+	Graphics *g = engine->GetGraphics();
+	RenderWindowManager *rwm = g ? g->GetRenderWindowManager() : nullptr;
+	RenderWindow *rw = rwm ? rwm->GetRenderWindow() : nullptr;
+	return rw ? rw->GetWindow() : nullptr;
+}
+
 value UserInput::_getMouseInput()
 {
 	InputManager *im = engine->GetApplication()->GetInputManager();
@@ -174,32 +183,36 @@ value UserInput::_getMouseInput()
 		ret = im->GetMousePos().y;
 		break;
 	case MouseType::CURSOR_X: 
+		if (Window *w = GetRenderWindowWindow())
 		{
 			POINT mp = {(LONG)im->GetMousePos().x, (LONG)im->GetMousePos().y};
-			POINT p = engine->GetGraphics()->GetRenderWindowManager()->GetRenderWindow()->GetWindow()->ScreenToClient(mp);
+			POINT p = w->ScreenToClient(mp);
 			ret = (value)p.x;
 		}
 		break;
 	case MouseType::CURSOR_Y:
+		if (Window *w = GetRenderWindowWindow())
 		{
 			POINT mp = {(LONG)im->GetMousePos().x, (LONG)im->GetMousePos().y};
-			POINT p = engine->GetGraphics()->GetRenderWindowManager()->GetRenderWindow()->GetWindow()->ScreenToClient(mp);
+			POINT p = w->ScreenToClient(mp);
 			ret = (value)p.y;
 		}
 		break;
 	case MouseType::CURSOR_REL_X:
+		if (Window *w = GetRenderWindowWindow())
 		{
 			POINT mp = {(LONG)im->GetMousePos().x, (LONG)im->GetMousePos().y};
-			POINT p = engine->GetGraphics()->GetRenderWindowManager()->GetRenderWindow()->GetWindow()->ScreenToClient(mp);
-			RECT r =  engine->GetGraphics()->GetRenderWindowManager()->GetRenderWindow()->GetWindow()->GetClientRect();
+			POINT p = w->ScreenToClient(mp);
+			RECT r = w->GetClientRect();
 			ret = (value)p.x / (value)(r.right - r.left);
 		}
 		break;
 	case MouseType::CURSOR_REL_Y:
+		if (Window *w = GetRenderWindowWindow())
 		{
 			POINT mp = {(LONG)im->GetMousePos().x, (LONG)im->GetMousePos().y};
-			POINT p = engine->GetGraphics()->GetRenderWindowManager()->GetRenderWindow()->GetWindow()->ScreenToClient(mp);
-			RECT r =  engine->GetGraphics()->GetRenderWindowManager()->GetRenderWindow()->GetWindow()->GetClientRect();
+			POINT p = w->ScreenToClient(mp);
+			RECT r = w->GetClientRect();
 			ret = (value)p.y / (value)(r.bottom - r.top);
 		}
 		break;
@@ -81,6 +81,8 @@ value Value::GetValue()
 
 void Value::SetValue(value v) 
 { 
+	if (_value != v)
+		SetUpdateStamp();
 	_value = v; 
 }
 
@@ -43,6 +43,8 @@ public:
 	virtual ~Value();
 
 	virtual bool CopyChip(Chip *chip) override;
+	// Only plain Value chips, as derived chips may hold more than CopyChip() sets.
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == VALUE_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
@@ -59,6 +61,9 @@ public:
 
 	virtual String GetValueAsString() const override;
 
+	// Only plain Value chips. Derived chips update _value without a new update stamp.
+	virtual bool IsUpdateStampTracked() const override { return GetChipDesc().type == VALUE_GUID; }
+
 protected:
 	value _value;
 };
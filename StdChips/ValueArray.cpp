@@ -87,6 +87,11 @@ void ValueArray::ClearContainer()
 	_array.clear(); 
 }
 
+uint64 ValueArray::GetMemoryUsage() const
+{
+	return ArrayChip::GetMemoryUsage() + (sizeof(ValueArray) - sizeof(ArrayChip)) + _array.capacity() * sizeof(value);
+}
+
 const ValueArray::ArrayType &ValueArray::GetArray() const 
 { 
 	return _array; 
@@ -102,6 +107,16 @@ void ValueArray::SetArray(ValueArray::ArrayType &&a)
 	_array = std::move(a); 
 }
 
+bool ValueArray::ParseArray(const String &text, const Char *delimiters)
+{
+	ArrayType a;
+	a.reserve(std::count_if(text.begin(), text.end(), [](Char c) { return c == MCHAR(',') || c == MCHAR(' ') || c == MCHAR('\n'); }) + 1); // Rough estimate.
+	if (!strUtils::toNums<value>(text, a, delimiters))
+		return false;
+	_array = std::move(a);
+	return true;
+}
+
 value ValueArray::GetValue(uint32 index) const 
 { 
 	return (value)_array[index]; 
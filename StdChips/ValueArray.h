@@ -45,16 +45,20 @@ public:
 	virtual ~ValueArray();
 
 	virtual bool CopyChip(Chip *chip) override;
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == VALUEARRAY_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
 	virtual uint32 GetContainerSize() override;
 	virtual void SetContainerSize(uint32 size) override;
 	virtual void ClearContainer() override;
+	virtual uint64 GetMemoryUsage() const override;
 
 	virtual const ArrayType &GetArray() const;
 	virtual void SetArray(const ArrayType &a);
 	virtual void SetArray(ArrayType &&a);
+	// Sets the array from a list of numbers separated by white space and/or one of the delimiters. The array is unchanged on failure.
+	virtual bool ParseArray(const String &text, const Char *delimiters = MTEXT(","));
 
 	virtual value GetValue(uint32 index) const;
 	virtual void SetValue(uint32 index, value v);
@@ -76,6 +76,11 @@ void VectorArray::ClearContainer()
 	_array.clear(); 
 }
 
+uint64 VectorArray::GetMemoryUsage() const
+{
+	return ArrayChip::GetMemoryUsage() + (sizeof(VectorArray) - sizeof(ArrayChip)) + _array.capacity() * sizeof(XMFLOAT4);
+}
+
 const List<XMFLOAT4> &VectorArray::GetArray() 
 { 
 	return _array; 
@@ -91,6 +96,26 @@ void VectorArray::SetArray(List<XMFLOAT4> &&a)
 	_array = std::move(a); 
 }
 
+bool VectorArray::ParseArray(const String &text, uint32 components, const Char *delimiters)
+{
+	if (components < 1 || components > 4)
+		return false;
+	List<XMFLOAT4> a;
+	uint32 n = 0;
+	bool ok = strUtils::forEachNum<float32>(text.data(), text.data() + text.size(), [&](float32 f) 
+		{
+			if (n == 0)
+				a.push_back(XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f));
+			(&a.back().x)[n] = f;
+			n = (n + 1) % components;
+			return true;
+		}, delimiters);
+	if (!ok || n != 0)
+		return false; // Failed, or the last vector is not complete.
+	_array = std::move(a);
+	return true;
+}
+
 void VectorArray::GetVector(uint32 index, XMFLOAT4 &v) 
 { 
 	v = _array[index]; 
@@ -44,6 +44,7 @@ public:
 	virtual ~VectorArray();
 
 	virtual bool CopyChip(Chip *chip) override;
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == VECTORARRAY_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
@@ -51,10 +52,14 @@ public:
 	virtual uint32 GetContainerSize() override;
 	virtual void SetContainerSize(uint32 size) override;
 	virtual void ClearContainer() override;
+	virtual uint64 GetMemoryUsage() const override;
 
 	virtual const List<XMFLOAT4> &GetArray();
 	virtual void SetArray(const List<XMFLOAT4> &a);
 	virtual void SetArray(List<XMFLOAT4> &&a);
+	// Sets the array from a list of numbers separated by white space and/or one of the delimiters.
+	// Each vector takes components (1-4) numbers. The rest are 0. The array is unchanged on failure.
+	virtual bool ParseArray(const String &text, uint32 components = 4, const Char *delimiters = MTEXT(","));
 
 	virtual void GetVector(uint32 index, XMFLOAT4 &v);
 	virtual void SetVector(uint32 index, const XMFLOAT4 &v);
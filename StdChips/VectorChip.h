@@ -43,6 +43,8 @@ public:
 
 	virtual bool InitChip() override;
 	virtual bool CopyChip(Chip *chip) override;
+	// Only plain Vector chips, as derived chips may hold more than CopyChip() sets.
+	virtual bool OnInstanceRecycled(Chip *chip) override { return GetChipDesc().type == VECTORCHIP_GUID && CopyChip(chip); }
 	virtual bool LoadChip(DocumentLoader &loader) override;
 	virtual bool SaveChip(DocumentSaver &saver) const override;
 
@@ -58,6 +58,7 @@ void Chip_Dlg::Init()
 	ui.radioButton_rm1->setChecked(_initRM == RefreshManager::RefreshMode::OncePerFrame);
 	ui.radioButton_rm2->setChecked(_initRM == RefreshManager::RefreshMode::OncePerFunctionCall);
 	ui.radioButton_rm3->setChecked(_initRM == RefreshManager::RefreshMode::Always);
+	ui.radioButton_rm4->setChecked(_initRM == RefreshManager::RefreshMode::OnInputChange);
 	ui.pushButton_resetRM->setEnabled(_initRM == RefreshManager::RefreshMode::Once);
 	ui.radioButton_4->setChecked(function == NULL);
 	ui.radioButton_5->setChecked(function == NULL ? false : (function->GetType() == Function::Type::Static));
@@ -182,7 +183,7 @@ void Chip_Dlg::AfterApply()
 
 void Chip_Dlg::onRefreshModeChange(QAbstractButton *btn)
 {
-	RefreshManager::RefreshMode rm = (btn == ui.radioButton_rm2 ? RefreshManager::RefreshMode::OncePerFunctionCall : (btn == ui.radioButton_rm1 ? RefreshManager::RefreshMode::OncePerFrame : (btn == ui.radioButton_rm0 ? RefreshManager::RefreshMode::Once : RefreshManager::RefreshMode::Always)));
+	RefreshManager::RefreshMode rm = (btn == ui.radioButton_rm2 ? RefreshManager::RefreshMode::OncePerFunctionCall : (btn == ui.radioButton_rm1 ? RefreshManager::RefreshMode::OncePerFrame : (btn == ui.radioButton_rm0 ? RefreshManager::RefreshMode::Once : (btn == ui.radioButton_rm4 ? RefreshManager::RefreshMode::OnInputChange : RefreshManager::RefreshMode::Always))));
 	ui.pushButton_resetRM->setEnabled(rm == RefreshManager::RefreshMode::Once);
 	if (GetChip()->GetRefreshManager().GetRefreshMode() == rm)
 		return;
@@ -0,0 +1,73 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "stdafx.h"
+#include "FrameStatistics_Dlg.h"
+#include "ChipDialogs/ChipDialogManager.h"
+#include <qfiledialog.h>
+#include <qmessagebox.h>
+
+
+using namespace m3d;
+
+
+DIALOGDESC_DEF(FrameStatistics_Dlg, FRAMESTATISTICS_GUID);
+
+
+void FrameStatistics_Dlg::Init()
+{
+	ComboBoxInitList series, statistic;
+	series.push_back(std::make_pair(String(MTEXT("Frame Interval")), (uint32)FrameStatsSeries::FRAME_INTERVAL));
+	series.push_back(std::make_pair(String(MTEXT("Frame (Engine::Run)")), (uint32)FrameStatsSeries::FRAME));
+	series.push_back(std::make_pair(String(MTEXT("Chips OnNewFrame")), (uint32)FrameStatsSeries::CHIPS_ON_NEW_FRAME));
+	series.push_back(std::make_pair(String(MTEXT("Graphics")), (uint32)FrameStatsSeries::GRAPHICS));
+	series.push_back(std::make_pair(String(MTEXT("ClassManager::Run")), (uint32)FrameStatsSeries::CLASS_MANAGER_RUN));
+	series.push_back(std::make_pair(String(MTEXT("Post Frame")), (uint32)FrameStatsSeries::POST_FRAME));
+
+	statistic.push_back(std::make_pair(String(MTEXT("Median (ms)")), (uint32)FrameStatistics::Statistic::P50));
+	statistic.push_back(std::make_pair(String(MTEXT("95th Percentile (ms)")), (uint32)FrameStatistics::Statistic::P95));
+	statistic.push_back(std::make_pair(String(MTEXT("99th Percentile (ms)")), (uint32)FrameStatistics::Statistic::P99));
+	statistic.push_back(std::make_pair(String(MTEXT("Maximum (ms)")), (uint32)FrameStatistics::Statistic::MAX));
+	statistic.push_back(std::make_pair(String(MTEXT("Mean (ms)")), (uint32)FrameStatistics::Statistic::MEAN));
+	statistic.push_back(std::make_pair(String(MTEXT("Frame Count")), (uint32)FrameStatistics::Statistic::COUNT));
+	statistic.push_back(std::make_pair(String(MTEXT("Hitch Count")), (uint32)FrameStatistics::Statistic::HITCHES));
+
+	AddComboBox(MTEXT("Series:"), series, (uint32)GetChip()->GetSeries(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetSeries((FrameStatsSeries)v.ToUInt()); });
+	AddComboBox(MTEXT("Statistic:"), statistic, (uint32)GetChip()->GetStatistic(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetStatistic((FrameStatistics::Statistic)v.ToUInt()); });
+	AddCheckBox(MTEXT("Rolling Window of Latest Frames"), GetChip()->IsWindow() ? RCheckState::Checked : RCheckState::Unchecked, [this](Id id, RVariant v) { SetDirty(); GetChip()->SetWindow(v.ToUInt() == RCheckState::Checked); });
+
+	AddLine();
+	AddPushButton(MTEXT("Reset Statistics"), [this](Id id, RVariant v) { frameStats.Reset(); });
+	AddPushButton(MTEXT("Export as JSON..."), [this](Id id, RVariant v) 
+		{
+			GetDialogManager()->DisableFrameTimer(true);
+			QString filename = QFileDialog::getSaveFileName(this, "Export Frame Statistics", TOQSTRING(GetDialogManager()->GetCurrentPath().AsString()), "JSON (*.json)", 0, QFileDialog::Options());
+			GetDialogManager()->DisableFrameTimer(false);
+			if (filename.isEmpty())
+				return;
+			GetDialogManager()->SetCurrentPath(Path(FROMQSTRING(filename)).GetDirectory());
+			if (!frameStats.ExportJson(Path(FROMQSTRING(filename))))
+				QMessageBox::critical(this, "Frame Statistics", "Failed to export frame statistics to \'" + filename + "\'.");
+		});
+}
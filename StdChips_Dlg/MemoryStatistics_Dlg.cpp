@@ -0,0 +1,80 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "stdafx.h"
+#include "MemoryStatistics_Dlg.h"
+#include "ChipDialogs/ChipDialogManager.h"
+#include "M3DEngine/Engine.h"
+#include "M3DEngine/ClassManager.h"
+#include <fstream>
+#include <qfiledialog.h>
+#include <qmessagebox.h>
+
+
+using namespace m3d;
+
+
+DIALOGDESC_DEF(MemoryStatistics_Dlg, MEMORYSTATISTICS_GUID);
+
+
+void MemoryStatistics_Dlg::Init()
+{
+	ComboBoxInitList statistic;
+	statistic.push_back(std::make_pair(String(MTEXT("Live Bytes")), (uint32)MemoryStatistics::Statistic::LIVE));
+	statistic.push_back(std::make_pair(String(MTEXT("Peak Bytes")), (uint32)MemoryStatistics::Statistic::PEAK));
+	statistic.push_back(std::make_pair(String(MTEXT("Allocations")), (uint32)MemoryStatistics::Statistic::ALLOCATIONS));
+	statistic.push_back(std::make_pair(String(MTEXT("Allocated Bytes")), (uint32)MemoryStatistics::Statistic::ALLOCATED_BYTES));
+
+	AddLineEdit(MTEXT("Tag (eg Class/Name, Chip/Type or Textures):"), GetChip()->GetTagName(), false, [this](Id id, RVariant v) { SetDirty(); GetChip()->SetTagName(v.ToString()); });
+	AddComboBox(MTEXT("Statistic:"), statistic, (uint32)GetChip()->GetStatistic(), [this](Id id, RVariant v) { SetDirty(); GetChip()->SetStatistic((MemoryStatistics::Statistic)v.ToUInt()); });
+
+	AddLine();
+	AddCheckBox(MTEXT("Enable Memory Tracking"), memoryTracker().IsEnabled() ? RCheckState::Checked : RCheckState::Unchecked, [this](Id id, RVariant v) { memoryTracker().SetEnabled(v.ToUInt() == RCheckState::Checked); });
+	AddPushButton(MTEXT("Take Snapshot"), [this](Id id, RVariant v) { GetChip()->SetSnapshot(memoryTracker().TakeSnapshot()); });
+	AddPushButton(MTEXT("Export Current State..."), [this](Id id, RVariant v) 
+		{
+			MemorySnapshot s = memoryTracker().TakeSnapshot();
+			_export(MTEXT("Export Memory Statistics"), [&s](bool json) { return json ? s.ToJson() : s.ToText(); });
+		});
+	AddPushButton(MTEXT("Export Changes Since Snapshot..."), [this](Id id, RVariant v) 
+		{
+			MemorySnapshotDiff d = MemorySnapshotDiff::Compute(GetChip()->GetSnapshot(), memoryTracker().TakeSnapshot());
+			_export(MTEXT("Export Memory Changes"), [&d](bool json) { return json ? d.ToJson() : d.ToText(); });
+		});
+}
+
+void MemoryStatistics_Dlg::_export(String title, std::function<String(bool)> toString)
+{
+	GetDialogManager()->DisableFrameTimer(true);
+	QString filename = QFileDialog::getSaveFileName(this, TOQSTRING(title), TOQSTRING(GetDialogManager()->GetCurrentPath().AsString()), "JSON (*.json);;Text (*.txt)", 0, QFileDialog::Options());
+	GetDialogManager()->DisableFrameTimer(false);
+	if (filename.isEmpty())
+		return;
+	Path p(FROMQSTRING(filename));
+	GetDialogManager()->SetCurrentPath(p.GetDirectory());
+	String s = toString(p.CompareFileExtention(MTEXT("json")));
+	std::ofstream f(p.AsString().c_str(), std::ios::out | std::ios::binary);
+	if (!f.write(s.c_str(), s.size()))
+		QMessageBox::critical(this, "Memory Statistics", "Failed to write \'" + filename + "\'.");
+}
@@ -27,12 +27,16 @@
 #include "M3DEngine/ClassManager.h"
 #include "M3DEngine/ChipManager.h"
 #include "M3DEngine/DocumentManager.h"
+#include "M3DCore/ThreadPool.h"
+#include "M3DCore/HighPrecisionTimer.h"
 #include "StdChips/Text.h"
 #include "GraphicsChips/Texture.h"
+#include "GraphicsChips/StdGeometry.h"
+#include "GraphicsChips/Renderable.h"
 
-#include <ppl.h>
 #include <fstream>
-#include <sstream>
+#include <deque>
+#include <memory>
 #include <DirectXTex.h>
 #include <DirectXTK12/SimpleMath.h>
 
@@ -44,7 +48,7 @@ CHIPDESCV1_DEF_IMPORTER(DEMImporter, MTEXT("DEM Importer"), DEMIMPORTER_GUID, IM
 
 
 
-DEMImporter::DEMImporter()
+DEMImporter::DEMImporter() : _generateGeometry(true), _generateTextures(false), _threadCount(0)
 {
 }
 
@@ -54,97 +58,25 @@ DEMImporter::~DEMImporter()
 
 Class *DEMImporter::Import(Chip **mainChip)
 {
-	std::ifstream demFile(GetFilename().AsString().c_str(), std::ios::ate);
+	HighPrecisionTimer timer;
+	timer.Tick();
+
+	std::ifstream demFile(GetFilename().AsString().c_str(), std::ios::binary);
 	if (!demFile.is_open())
 		return nullptr;
 
-	memset(&_aRec, 0, sizeof(_aRec));
-	char block[1024]; // standard block size.
-
-	std::ifstream::pos_type demFileByteSize = demFile.tellg();
-
-	demFile.seekg(0);
-
-	demFile.read(block, 1024); // Read A-block (file header).
-
-	// Parse A-block
-	_parseString(_aRec.file_name, block + 0, 40);
-	_parseString(_aRec.free_text_format, block + 40, 40);
-	_parseString(_aRec.SE_geographic_corner_S, block + 109, 13);
-	_parseString(_aRec.SE_geographic_corner_E, block + 122, 13);
-	_aRec.process_code = block[135];
-	_parseString(_aRec.origin_code, block + 140, 4);
-	_aRec.dem_level_code = _parseInt(block + 144);
-	_aRec.elevation_pattern = _parseInt(block + 150);
-	_aRec.ground_ref_system = _parseInt(block + 156);
-	_aRec.ground_ref_zone = _parseInt(block + 162);
-	for (uint32 i = 0; i < 15; i++)
-		_aRec.projection[i] = _parseDouble(block + 168 + i * 24);
-	_aRec.ground_unit = _parseInt(block + 528);
-	_aRec.elevation_unit = _parseInt(block + 534);
-	_aRec.side_count = _parseInt(block + 540);
-	_aRec.sw_coord[0] = _parseDouble(block + 546); // UTM grid (measured in meters)
-	_aRec.sw_coord[1] = _parseDouble(block + 570);
-	_aRec.nw_coord[0] = _parseDouble(block + 594);
-	_aRec.nw_coord[1] = _parseDouble(block + 618);
-	_aRec.ne_coord[0] = _parseDouble(block + 642);
-	_aRec.ne_coord[1] = _parseDouble(block + 666);
-	_aRec.se_coord[0] = _parseDouble(block + 690);
-	_aRec.se_coord[1] = _parseDouble(block + 714);
-	_aRec.elevation_min = _parseDouble(block + 738);
-	_aRec.elevation_max = _parseDouble(block + 762);
-	_aRec.ccw_angle = _parseDouble(block + 786);
-	_aRec.elevation_accuracy = _parseInt(block + 810);
-	_aRec.xyz_resolution[0] = _parseFloat(block + 816);
-	_aRec.xyz_resolution[1] = _parseFloat(block + 828);
-	_aRec.xyz_resolution[2] = _parseFloat(block + 840);
-	_aRec.northings_rows = _parseInt(block + 852);
-	_aRec.eastings_cols = _parseInt(block + 858);
-	_aRec.suspect_void = _parseInt(block + 886, 2);
-	_aRec.percent_void = _parseInt(block + 896);
-	
-	_aRec.northings_rows = _aRec.eastings_cols; // WARNING. SHOULD NOT USE THIS VALUE. BUT WE ASSUME IS THE SAME WITH eastings SINCE IT IS ALWAYS THE CASE.
-
-	// Elevation points. South->North for each profile West->East.
-	DataBuffer db(_aRec.eastings_cols * _aRec.northings_rows * sizeof(float32));
-	float32 *points = (float32*)db.getBuffer();
-
-	int32 _format = 1; // 1=16-bit uint32, 0=32-bit floating point.
-	float32 _minAlt = 0.0f; // for _format=1.
-	float32 _maxAlt = 0.0f; // for _format=1.
-	bool _generateNormalMap = true; 
-
-	// Parse profiles. Each profile is a row of points going from south to north.
-	for (int32 j = 0; j < _aRec.eastings_cols; j++) { // Iterate profiles. West->East.
-		demFile.read(block, 1024); // Read first block (there may be many). First block contains header of profile (B-Block).
-		int32 cn = _parseInt(block + 0);
-		int32 ce = _parseInt(block + 6);
-		int32 rows = _parseInt(block + 12);
-		int32 columns = _parseInt(block + 18);
-		float64 n = _parseDouble(block + 24);
-		float64 e = _parseDouble(block + 48);
-		float64 z = _parseDouble(block + 72);
-		float64 l = _parseDouble(block + 96);
-		float64 h = _parseDouble(block + 120);
-		for (int32 i = 0, o = 144; i < rows; o = 0) { // Iterate blocks to get all points in profile.
-			for (; o < 1020 && i < rows; o += 6, i++) // Iterate points in current block. South->North.
-				points[j * rows + i] = float32(_aRec.xyz_resolution[2] * _parseInt(block + o) + z); // TODO: value can also -32767, which means it is a false value.
-			if (i < rows)
-				demFile.read(block, 1024); // Need to read a new block for current profile.
-		}
-	}
-	// Done reading file. It may contain an additional C-Block, but we don't need that.
-
-	demFile.close(); // close file manually and free up resources for rest of the process!
-
-	// Calculate min/max elevation.
-	float32 minElevation = std::numeric_limits<float32>::max(), maxElevation = -std::numeric_limits<float32>::max();
-	for (int32 i = 0; i < _aRec.eastings_cols * _aRec.northings_rows; i++) {
-		minElevation = std::min(minElevation, points[i]);
-		maxElevation = std::max(maxElevation, points[i]);
+	// Only the header of the file and of each profile is read here. The elevations are read tile by tile.
+	DEMReader reader;
+	if (!reader.Open(demFile)) {
+		msg(WARN, MTEXT("Failed to read DEM file. Only regular grids of profiles are supported."));
+		return nullptr;
 	}
+	demFile.close();
 
-	// xml: UTM-zone, four corners, xres, yres, mine, maxe
+	const DEMARecord &aRec = reader.GetARecord();
+	const DEMTileOptions options = _tileOptions;
+	const uint32 sx = reader.GetSampleCountX(options.step), sy = reader.GetSampleCountY(options.step);
+	const uint32 tilesX = reader.GetTileCountX(options), tilesY = reader.GetTileCountY(options);
 
 	// Create the class
 	Document *doc = engine->GetDocumentManager()->CreateDocument();
@@ -158,122 +90,187 @@ Class *DEMImporter::Import(Chip **mainChip)
 		return nullptr; // TODO: what about doc?
 	}
 
-	// Generate heightmap texture.
+	// The heightmap is normalized to the elevation range given by the A-record. If the range is missing, elevations are stored as floats.
+	const bool normalizeHeights = aRec.elevation_max > aRec.elevation_min;
+	const float32 a = (float32)aRec.elevation_min, b = (float32)(aRec.elevation_max - aRec.elevation_min);
+	const float32 dx = (aRec.xyz_resolution[0] > 0.0f ? aRec.xyz_resolution[0] : 1.0f) * options.step, dy = (aRec.xyz_resolution[1] > 0.0f ? aRec.xyz_resolution[1] : 1.0f) * options.step;
+
+	ScratchImage heightImg, normalImg;
+	const Image *heightData = nullptr, *normalData = nullptr;
+	if (_generateTextures) {
+		// The textures cover the whole terrain, so this allocation may fail for large files.
+		if (SUCCEEDED(heightImg.Initialize2D(normalizeHeights ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R32_FLOAT, sx, sy, 1, 1)) && SUCCEEDED(normalImg.Initialize2D(DXGI_FORMAT_R8G8_SNORM, sx, sy, 1, 1))) {
+			heightData = heightImg.GetImage(0, 0, 0);
+			normalData = normalImg.GetImage(0, 0, 0);
+		}
+		if (!heightData || !normalData) {
+			msg(WARN, strUtils::ConstructString(MTEXT("Failed to allocate %1x%2 terrain textures. No textures are generated.")).arg(sx).arg(sy));
+			heightImg.Release();
+			normalImg.Release();
+			heightData = normalData = nullptr;
+		}
+	}
+
+	struct TileJob
 	{
-		ScratchImage img;
-		if (_format == 0) {
-			img.Initialize2D(DXGI_FORMAT_R32_FLOAT, _aRec.eastings_cols, _aRec.northings_rows, 1, 1);
-			const Image *data = img.GetImage(0, 0, 0);
-			for (int32 j = 0; j < _aRec.northings_rows; j++) {
-				for (int32 i = 0; i < _aRec.eastings_cols; i++) {
-					((float32*)(data->pixels + data->rowPitch * j))[i] = points[_aRec.northings_rows - j - 1 + _aRec.eastings_cols * i];
+		DEMTile tile;
+		bool ok = false;
+		std::future<void> done;
+	};
+
+	// Builds a tile and writes the texels it owns. Tiles share their edge samples, so the east and north edges are owned by the next tile, if any.
+	String filename = GetFilename().AsString();
+	auto buildTile = [&, filename](TileJob *job, uint32 tx, uint32 ty) {
+		std::ifstream file(filename.c_str(), std::ios::binary); // One stream for each task, so tiles are read in parallel.
+		if (!file.is_open() || !reader.BuildTile(file, tx, ty, options, job->tile))
+			return;
+		const DEMTile &tile = job->tile;
+		if (heightData) {
+			uint32 w = tx == tilesX - 1 ? tile.width : tile.width - 1, h = ty == tilesY - 1 ? tile.height : tile.height - 1;
+			for (uint32 j = 0; j < h; j++) {
+				size_t row = sy - 1 - (tile.sampleY + j); // Textures are stored north to south.
+				for (uint32 i = 0; i < w; i++) {
+					size_t col = tile.sampleX + i;
+					float32 e = tile.GetHeight(i, j);
+					if (normalizeHeights)
+						((uint16*)(heightData->pixels + heightData->rowPitch * row))[col] = uint16(std::min(std::max((e - a) / b, 0.0f), 1.0f) * 65535.0f);
+					else
+						((float32*)(heightData->pixels + heightData->rowPitch * row))[col] = e;
+					float32 eN = tile.GetHeight(i, j + 1), eE = tile.GetHeight(i + 1, j), eS = tile.GetHeight(i, j - 1), eW = tile.GetHeight(i - 1, j);
+					XMVECTOR n = XMVector3Normalize(XMVectorSet(eW - eE, eS - eN, 2.0f * dx + 2.0f * dy, 0.0f)) * 127.0f;
+					XMStoreByte2((XMBYTE2*)(normalData->pixels + normalData->rowPitch * row) + col, n);
 				}
 			}
 		}
-		else if (_format == 1) {
-			float32 a = minElevation, b = maxElevation - minElevation;
-			if (_minAlt != 0.0f || _maxAlt != 0.0f) { // Custom range?
-				a = _minAlt;
-				b = _maxAlt - _minAlt;
-			}
-			img.Initialize2D(DXGI_FORMAT_R16_UNORM, _aRec.eastings_cols, _aRec.northings_rows, 1, 1);
-			const Image *data = img.GetImage(0, 0, 0);
-			concurrency::parallel_for(0, _aRec.northings_rows, [=](int32 j) {
-//			for (int32 j = 0; j < _aRec.northings_rows; j++) {
-				float32 c = 0.0f;
-				for (int32 i = 0; i < _aRec.eastings_cols; i++) {
-					c = (points[_aRec.northings_rows - j - 1 + _aRec.eastings_cols * i] - a) / b;
-					c = std::min(std::max(c, 0.0f), 1.0f);
-					((uint16*)(data->pixels + data->rowPitch * j))[i] = uint16(c * 65535.0f);
-				}
-			});
-		}
-		//HRESULT gr = SaveToDDSFile(*data, DDS_FLAGS_NONE, MTEXT("c:\\M3D\\jalla2.dds"));
-		Blob blob;
-		HRESULT hr = SaveToDDSMemory(*img.GetImage(0, 0, 0), DDS_FLAGS_NONE, blob);
-		DataBuffer heightmapDDS;
-		heightmapDDS.setBufferData((const uint8*)blob.GetBufferPointer(), blob.GetBufferSize());
-
-		Texture *heightmap = dynamic_cast<Texture*>(importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(TEXTURE_GUID)));
-		heightmap->SetName(MTEXT("Heightmap"));
-		heightmap->SetImageData(std::move(heightmapDDS), IFF_DDS);
+		job->ok = true;
+	};
+
+	_3DObject *terrain = nullptr;
+	if (_generateGeometry) {
+		terrain = dynamic_cast<_3DObject*>(importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(_3DOBJECT_GUID)));
+		if (terrain)
+			terrain->SetName(MTEXT("Terrain"));
 	}
 
-	// Generate normal map texture.
-	if (_generateNormalMap) {
-		ScratchImage img;
-		img.Initialize2D(DXGI_FORMAT_R8G8_SNORM, _aRec.eastings_cols, _aRec.northings_rows, 1, 1);
-		const Image *data = img.GetImage(0, 0, 0);
-		concurrency::parallel_for(1, _aRec.northings_rows - 1, [=](int32 j) {
-		//for (int32 j = 1; j < _aRec.northings_rows - 1; j++) {
-			for (int32 i = 1; i < _aRec.eastings_cols - 1; i++) {
-				float32 eN = points[_aRec.northings_rows - j - 0 + _aRec.eastings_cols * (i + 0)];
-				float32 eE = points[_aRec.northings_rows - j - 1 + _aRec.eastings_cols * (i + 1)];
-				float32 eS = points[_aRec.northings_rows - j - 2 + _aRec.eastings_cols * (i + 0)];
-				float32 eW = points[_aRec.northings_rows - j - 1 + _aRec.eastings_cols * (i - 1)];
-				XMVECTOR n = XMVector3Normalize(XMVectorSet(eW - eE, eS - eN, 2.0f * _aRec.xyz_resolution[0] + 2.0f * _aRec.xyz_resolution[1], 0.0f)) * 127.0f;
-				XMStoreByte2((XMBYTE2*)(data->pixels + data->rowPitch * j) + i, n);
+	// Tiles are built in parallel while this thread creates the chips for finished tiles in order.
+	// The number of tiles in flight is limited, so memory is bounded by the tile size and not the file size.
+	std::deque<std::unique_ptr<TileJob>> jobs; // Declared before the pool, so the pool finishes any tasks before the jobs are freed.
+	ThreadPool pool(_threadCount);
+	const size_t maxTilesInFlight = pool.GetThreadCount() * 2;
+	float32 minElevation = std::numeric_limits<float32>::max(), maxElevation = -std::numeric_limits<float32>::max();
+	uint32 tileCount = 0, failedTiles = 0, renderableCount = 0;
+	uint64 vertexCount = 0, triangleCount = 0;
+
+	auto finishTile = [&]() {
+		std::unique_ptr<TileJob> job = std::move(jobs.front());
+		jobs.pop_front();
+		job->done.get();
+		if (!job->ok) {
+			failedTiles++;
+			return;
+		}
+		const DEMTile &tile = job->tile;
+		tileCount++;
+		minElevation = std::min(minElevation, tile.minElevation);
+		maxElevation = std::max(maxElevation, tile.maxElevation);
+		if (!terrain)
+			return;
+		vertexCount += tile.positions.size();
+		triangleCount += tile.indices.size() / 3;
+
+		String name = strUtils::ConstructString(MTEXT("Tile %1_%2")).arg(tile.tileX).arg(tile.tileY);
+		StdGeometry *geometry = dynamic_cast<StdGeometry*>(importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(STDGEOMETRY_GUID)));
+		Renderable *renderable = dynamic_cast<Renderable*>(importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(RENDERABLE_GUID)));
+		if (!geometry || !renderable) {
+			msg(WARN, MTEXT("Failed to create StdGeometry."));
+			return;
+		}
+		geometry->SetName(name);
+		geometry->AddPositions(tile.positions.data(), (uint32)tile.positions.size());
+		geometry->AddNormals(tile.normals.data(), (uint32)tile.normals.size());
+		geometry->AddTexCoords(tile.texCoords.data(), (uint32)tile.positions.size(), 2, 0);
+		geometry->AddIndices(tile.indices.data(), (uint32)tile.indices.size());
+		geometry->CommitSubset(M3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST, name); // Bounds are calculated for each tile.
+		renderable->SetName(name);
+		renderable->SetChild(geometry, 0, 0);
+		terrain->SetChild(renderable, 2, renderableCount++);
+	};
+
+	for (uint32 ty = 0; ty < tilesY; ty++) {
+		for (uint32 tx = 0; tx < tilesX; tx++) {
+			while (jobs.size() >= maxTilesInFlight)
+				finishTile();
+			std::unique_ptr<TileJob> job(new TileJob());
+			TileJob *j = job.get();
+			job->done = pool.Submit([&buildTile, j, tx, ty]() { buildTile(j, tx, ty); });
+			jobs.push_back(std::move(job));
+		}
+	}
+	while (jobs.size())
+		finishTile();
+
+	if (failedTiles > 0)
+		msg(WARN, strUtils::ConstructString(MTEXT("Failed to read %1 of %2 tiles from the DEM file.")).arg(failedTiles).arg(tilesX * tilesY));
+
+	if (heightData) {
+		auto addTexture = [&](const Image &img, String name) {
+			Blob blob;
+			if (FAILED(SaveToDDSMemory(img, DDS_FLAGS_NONE, blob))) {
+				msg(WARN, strUtils::ConstructString(MTEXT("Failed to save %1 texture.")).arg(name));
+				return;
 			}
-		});
-		Blob blob;
-		HRESULT hr = SaveToDDSMemory(*data, DDS_FLAGS_NONE, blob);
-		DataBuffer normalmapDDS;
-		normalmapDDS.setBufferData((const uint8*)blob.GetBufferPointer(), blob.GetBufferSize());
-
-		Texture *normalmap = dynamic_cast<Texture*>(importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(TEXTURE_GUID)));
-		normalmap->SetName(MTEXT("Normalmap"));
-		normalmap->SetImageData(std::move(normalmapDDS), IFF_DDS);
+			DataBuffer dds;
+			dds.setBufferData((const uint8*)blob.GetBufferPointer(), blob.GetBufferSize());
+
+			Texture *texture = dynamic_cast<Texture*>(importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(TEXTURE_GUID)));
+			if (!texture)
+				return;
+			texture->SetName(name);
+			texture->SetImageData(std::move(dds), IFF_DDS);
+		};
+
+		// Generate heightmap texture.
+		addTexture(*heightData, MTEXT("Heightmap"));
+		heightImg.Release();
+
+		// Generate normal map texture.
+		addTexture(*normalData, MTEXT("Normalmap"));
+		normalImg.Release();
 	}
 
 	// Write xml-description
 	{
 		String units[4] = {MTEXT("radians"), MTEXT("feet"), MTEXT("meters"), MTEXT("arc-seconds")};
 
-		String d = strUtils::ConstructString(MTEXT("<?xml version=\"1.0\"?>\n<dem file=\"%1\" zone=\"%2\" ground_unit=\"%3\" elev_unit=\"%4\" %5 %6 elev_min=\"%7\" elev_max=\"%8\"/>\n"))
-			.arg(_aRec.file_name)
-			.arg(strUtils::fromNum(_aRec.ground_ref_zone))
-			.arg((_aRec.ground_unit >= 0 && _aRec.ground_unit < 4) ? units[_aRec.ground_unit] : MTEXT("unknown"))
-			.arg((_aRec.elevation_unit >= 0 && _aRec.elevation_unit < 4) ? units[_aRec.elevation_unit] : MTEXT("unknown"))
+		String d = strUtils::ConstructString(MTEXT("<?xml version=\"1.0\"?>\n<dem file=\"%1\" zone=\"%2\" ground_unit=\"%3\" elev_unit=\"%4\" %5 %6 elev_min=\"%7\" elev_max=\"%8\" %9/>\n"))
+			.arg(aRec.file_name)
+			.arg(strUtils::fromNum(aRec.ground_ref_zone))
+			.arg((aRec.ground_unit >= 0 && aRec.ground_unit < 4) ? units[aRec.ground_unit] : MTEXT("unknown"))
+			.arg((aRec.elevation_unit >= 0 && aRec.elevation_unit < 4) ? units[aRec.elevation_unit] : MTEXT("unknown"))
 			.arg(strUtils::ConstructString(MTEXT("sw_x=\"%1\" sw_y=\"%2\" nw_x=\"%3\" nw_y=\"%4\" ne_x=\"%5\" ne_y=\"%6\" se_x=\"%7\" se_y=\"%8\""))
-				.arg(strUtils::fromNum(_aRec.sw_coord[0])).arg(strUtils::fromNum(_aRec.sw_coord[1]))
-				.arg(strUtils::fromNum(_aRec.nw_coord[0])).arg(strUtils::fromNum(_aRec.nw_coord[1]))
-				.arg(strUtils::fromNum(_aRec.ne_coord[0])).arg(strUtils::fromNum(_aRec.ne_coord[1]))
-				.arg(strUtils::fromNum(_aRec.se_coord[0])).arg(strUtils::fromNum(_aRec.se_coord[1])))
+				.arg(strUtils::fromNum(aRec.sw_coord[0])).arg(strUtils::fromNum(aRec.sw_coord[1]))
+				.arg(strUtils::fromNum(aRec.nw_coord[0])).arg(strUtils::fromNum(aRec.nw_coord[1]))
+				.arg(strUtils::fromNum(aRec.ne_coord[0])).arg(strUtils::fromNum(aRec.ne_coord[1]))
+				.arg(strUtils::fromNum(aRec.se_coord[0])).arg(strUtils::fromNum(aRec.se_coord[1])))
 			.arg(strUtils::ConstructString(MTEXT("dx=\"%1\" dy=\"%2\" nx=\"%3\" ny=\"%4\""))
-				.arg(strUtils::fromNum(_aRec.xyz_resolution[0])).arg(strUtils::fromNum(_aRec.xyz_resolution[1]))
-				.arg(strUtils::fromNum(_aRec.eastings_cols)).arg(strUtils::fromNum(_aRec.northings_rows)))
+				.arg(strUtils::fromNum(dx)).arg(strUtils::fromNum(dy))
+				.arg(strUtils::fromNum(sx)).arg(strUtils::fromNum(sy)))
 			.arg(strUtils::fromNum(minElevation))
-			.arg(strUtils::fromNum(maxElevation));
+			.arg(strUtils::fromNum(maxElevation))
+			.arg(strUtils::ConstructString(MTEXT("step=\"%1\" tile_size=\"%2\" tiles_x=\"%3\" tiles_y=\"%4\""))
+				.arg(strUtils::fromNum(options.step)).arg(strUtils::fromNum(options.tileSize))
+				.arg(strUtils::fromNum(tilesX)).arg(strUtils::fromNum(tilesY)));
 
 		Text *xmlDesc = (Text*)importedCG->AddChip(engine->GetChipManager()->GetChipTypeIndex(TEXT_GUID));
 		xmlDesc->SetName(MTEXT("Description"));
 		xmlDesc->SetText(d);
 	}
 
-	return importedCG;
-}
+	if (mainChip)
+		*mainChip = terrain;
 
-void DEMImporter::_parseString(char *dest, const char *buffer, uint32 count)
-{
-	std::memcpy(dest, buffer, count); // count is without terminating 0.
-	for (; count > 0; count--)
-		if (dest[count - 1] != ' ')
-			break;
-	dest[count] = '\0';
-}
+	timer.Tick();
+	msg(NOTICE, strUtils::ConstructString(MTEXT("Imported %1 tiles (%2 vertices, %3 triangles) in %4 s.")).arg(tileCount).arg(vertexCount).arg(triangleCount).arg(timer.GetDt_us() / 1000000.0, MTEXT("%.3f")));
 
-int32 DEMImporter::_parseInt(const char *buffer, uint32 count)
-{
-	char tmp[64];
-	_parseString(tmp, buffer, count);
-	for (char *c = tmp; *c; c++) if (*c == 'D') *c = 'E';
-	return atoi(tmp);
+	return importedCG;
 }
-
-float64 DEMImporter::_parseDouble(const char *buffer, uint32 count)
-{
-	char tmp[64];
-	_parseString(tmp, buffer, count);
-	for (char *c = tmp; *c; c++) if (*c == 'D') *c = 'E';
-	return atof(tmp);
-}
\ No newline at end of file
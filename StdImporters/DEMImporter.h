@@ -26,6 +26,7 @@
 
 #include "Exports.h"
 #include "StdChips/Importer.h"
+#include "DEMReader.h"
 
 
 namespace m3d
@@ -35,6 +36,8 @@ namespace m3d
 static const Guid DEMIMPORTER_GUID = { 0x55ab0f53, 0x727e, 0x45de, { 0x9c, 0x50, 0x93, 0xa0, 0x2e, 0xe6, 0xb0, 0x2b } };
 
 
+// Imports USGS DEM files as a terrain of tiles, each a StdGeometry with its own bounds.
+// Tiles are read from the file and built in parallel, a few at a time, so memory used while importing is bounded by the tile size.
 class STDIMPORTERS_API DEMImporter : public Importer
 {
 	CHIPDESC_DECL;
@@ -44,87 +47,30 @@ public:
 
 	virtual Class *Import(Chip **mainChip = nullptr);
 
-protected:
-	struct ARecord
-	{
-		/// <summary>
-		/// The authorized digital cell name followed by a comma, space, and the two-character State designator(s) separated by hyphens.
-		/// Abbreviations for other countries, such as Canada and Mexico, shall not be represented in the DEM header.
-		/// </summary>
-		char file_name[41];
-		/// <summary>
-		/// Free format descriptor field, contains useful information related to digital process such as digitizing instrument, photo codes, slot widths, etc.
-		/// </summary>
-		char free_text_format[41];
-		/// <summary>
-		/// Southing of the southeast geographic corner
-		/// SE geographic quadrangle corner ordered as:
-		///     x = Longitude = SDDDMMSS.SSSS
-		///     y = Latitude = SDDDMMSS.SSSS
-		/// (neg sign (S) right justified, no leading zeroes, plus sign (S) implied)
-		/// </summary>
-		char SE_geographic_corner_S[14];
-		/// <summary>
-		/// Easting of the southeast geographic corner
-		/// SE geographic quadrangle corner ordered as:
-		///     x = Longitude = SDDDMMSS.SSSS
-		///     y = Latitude = SDDDMMSS.SSSS
-		/// (neg sign (S) right justified, no leading zeroes, plus sign (S) implied)
-		/// </summary>
-		char SE_geographic_corner_E[14];
-		/// <summary>
-		/// 1=Autocorrelation RESAMPLE Simple bilinear
-		/// 2=Manual profile GRIDEM Simple bilinear
-		/// 3=DLG/hypsography CTOG 8-direction linear
-		/// 4=Interpolation from photogrammetric system contours DCASS 4-direction linear
-		/// 5=DLG/hypsography LINETRACE, LT4X Complex linear
-		/// 6=DLG/hypsography CPS-3, ANUDEM, GRASS Complex polynomial
-		/// 7=Electronic imaging (non-photogrametric), active or passive, sensor systems.
-		/// </summary>
-		char process_code;
-		/// <summary>
-		/// Free format Mapping Origin Code. Example: MAC, WMC, MCMC, RMMC, FS, BLM, CONT (contractor), XX (state postal code).
-		/// </summary>
-		char origin_code[5];
-		/// <summary>
-		/// Code 1=DEM-1
-		/// 2=DEM-2
-		/// 3=DEM-3
-		/// 4=DEM-4
-		/// </summary>
-		int32 dem_level_code;
-		/// <summary>
-		/// 1 = regular
-		/// 2 = random
-		/// </summary>
-		int32 elevation_pattern;
-		int32 ground_ref_system;
-		int32 ground_ref_zone;
-		float64 projection[15];
-		int32 ground_unit;
-		int32 elevation_unit;
-		int32 side_count;
-		// pairs of easting-northings
-		float64 sw_coord[2];
-		float64 nw_coord[2];
-		float64 ne_coord[2];
-		float64 se_coord[2];
-		float64 ccw_angle;
-		float64 elevation_min;
-		float64 elevation_max;
-		int32 elevation_accuracy;
-		float32 xyz_resolution[3];
-		int32 northings_rows;
-		int32 eastings_cols;
-		int32 suspect_void;
-		int32 percent_void;
-	};
-	ARecord _aRec;
+	// Number of quads along each edge of a tile.
+	virtual uint32 GetTileSize() const { return _tileOptions.tileSize; }
+	virtual void SetTileSize(uint32 size) { _tileOptions.tileSize = std::max(size, 1u); }
+	// Only every step'th elevation is imported. 1 is full resolution.
+	virtual uint32 GetStep() const { return _tileOptions.step; }
+	virtual void SetStep(uint32 step) { _tileOptions.step = std::max(step, 1u); }
+	// Depth of the skirts hiding cracks between tiles, in sample spacings. 0 for no skirts.
+	virtual float32 GetSkirtDepth() const { return _tileOptions.skirtDepth; }
+	virtual void SetSkirtDepth(float32 depth) { _tileOptions.skirtDepth = std::max(depth, 0.0f); }
+	// Create the tile geometries.
+	virtual bool GetGenerateGeometry() const { return _generateGeometry; }
+	virtual void SetGenerateGeometry(bool b) { _generateGeometry = b; }
+	// Create heightmap and normal map textures. These cover the whole DEM, so memory is proportional to the number of samples imported.
+	virtual bool GetGenerateTextures() const { return _generateTextures; }
+	virtual void SetGenerateTextures(bool b) { _generateTextures = b; }
+	// Threads building tiles. 0 uses all hardware threads.
+	virtual uint32 GetThreadCount() const { return _threadCount; }
+	virtual void SetThreadCount(uint32 count) { _threadCount = count; }
 
-	void _parseString(char *dest, const char *buffer, uint32 count);
-	int32 _parseInt(const char *buffer, uint32 count = 6);
-	float64 _parseDouble(const char *buffer, uint32 count = 24);
-	float32 _parseFloat(const char *buffer, uint32 count = 12) { return (float32)_parseDouble(buffer, count); }
+protected:
+	DEMTileOptions _tileOptions;
+	bool _generateGeometry;
+	bool _generateTextures;
+	uint32 _threadCount;
 };
 
-}
\ No newline at end of file
+}
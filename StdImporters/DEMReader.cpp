@@ -0,0 +1,339 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "stdafx.h"
+#include "DEMReader.h"
+#include "GraphicsChips/MeshOptimization.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+
+using namespace m3d;
+
+
+namespace
+{
+	const uint32 BLOCK_SIZE = 1024; // DEM files are stored in blocks of 1024 characters.
+	const uint32 VALUE_SIZE = 6; // Each elevation is 6 characters.
+	const uint32 FIRST_BLOCK_OFFSET = 144; // Elevations in the first block of a profile follow the B-record header.
+	const uint32 FIRST_BLOCK_VALUES = (BLOCK_SIZE - 4 - FIRST_BLOCK_OFFSET) / VALUE_SIZE; // 146
+	const uint32 BLOCK_VALUES = (BLOCK_SIZE - 4) / VALUE_SIZE; // 170
+
+	// Position of elevation r relative to the start of its profile.
+	uint64 _valueOffset(uint32 r)
+	{
+		if (r < FIRST_BLOCK_VALUES)
+			return FIRST_BLOCK_OFFSET + r * VALUE_SIZE;
+		r -= FIRST_BLOCK_VALUES;
+		return uint64(1 + r / BLOCK_VALUES) * BLOCK_SIZE + (r % BLOCK_VALUES) * VALUE_SIZE;
+	}
+
+	uint32 _blockCount(uint32 rows)
+	{
+		return rows <= FIRST_BLOCK_VALUES ? 1 : 1 + (rows - FIRST_BLOCK_VALUES + BLOCK_VALUES - 1) / BLOCK_VALUES;
+	}
+}
+
+
+DEMReader::DEMReader() : _rows(0)
+{
+	std::memset(&_aRec, 0, sizeof(_aRec));
+}
+
+bool DEMReader::Open(std::istream &file)
+{
+	std::memset(&_aRec, 0, sizeof(_aRec));
+	_profiles.clear();
+	_rows = 0;
+
+	char block[BLOCK_SIZE];
+
+	file.clear();
+	file.seekg(0);
+
+	if (!file.read(block, BLOCK_SIZE)) // Read A-block (file header).
+		return false;
+
+	// Parse A-block
+	ParseString(_aRec.file_name, block + 0, 40);
+	ParseString(_aRec.free_text_format, block + 40, 40);
+	ParseString(_aRec.SE_geographic_corner_S, block + 109, 13);
+	ParseString(_aRec.SE_geographic_corner_E, block + 122, 13);
+	_aRec.process_code = block[135];
+	ParseString(_aRec.origin_code, block + 140, 4);
+	_aRec.dem_level_code = ParseInt(block + 144);
+	_aRec.elevation_pattern = ParseInt(block + 150);
+	_aRec.ground_ref_system = ParseInt(block + 156);
+	_aRec.ground_ref_zone = ParseInt(block + 162);
+	for (uint32 i = 0; i < 15; i++)
+		_aRec.projection[i] = ParseDouble(block + 168 + i * 24);
+	_aRec.ground_unit = ParseInt(block + 528);
+	_aRec.elevation_unit = ParseInt(block + 534);
+	_aRec.side_count = ParseInt(block + 540);
+	_aRec.sw_coord[0] = ParseDouble(block + 546); // UTM grid (measured in meters)
+	_aRec.sw_coord[1] = ParseDouble(block + 570);
+	_aRec.nw_coord[0] = ParseDouble(block + 594);
+	_aRec.nw_coord[1] = ParseDouble(block + 618);
+	_aRec.ne_coord[0] = ParseDouble(block + 642);
+	_aRec.ne_coord[1] = ParseDouble(block + 666);
+	_aRec.se_coord[0] = ParseDouble(block + 690);
+	_aRec.se_coord[1] = ParseDouble(block + 714);
+	_aRec.elevation_min = ParseDouble(block + 738);
+	_aRec.elevation_max = ParseDouble(block + 762);
+	_aRec.ccw_angle = ParseDouble(block + 786);
+	_aRec.elevation_accuracy = ParseInt(block + 810);
+	_aRec.xyz_resolution[0] = ParseFloat(block + 816);
+	_aRec.xyz_resolution[1] = ParseFloat(block + 828);
+	_aRec.xyz_resolution[2] = ParseFloat(block + 840);
+	_aRec.northings_rows = ParseInt(block + 852);
+	_aRec.eastings_cols = ParseInt(block + 858);
+	_aRec.suspect_void = ParseInt(block + 886, 2);
+	_aRec.percent_void = ParseInt(block + 896);
+
+	if (_aRec.eastings_cols < 2)
+		return false;
+
+	// Index the profiles (west->east). Only the B-record header of each profile is read.
+	_profiles.reserve(_aRec.eastings_cols);
+	uint64 offset = BLOCK_SIZE;
+	for (int32 j = 0; j < _aRec.eastings_cols; j++) {
+		file.seekg(offset);
+		if (!file.read(block, FIRST_BLOCK_OFFSET))
+			return false;
+		Profile p;
+		p.offset = offset;
+		p.rows = (uint32)std::max(0, ParseInt(block + 12));
+		p.z = ParseDouble(block + 72);
+		if (p.rows == 0)
+			return false;
+		_profiles.push_back(p);
+		_rows = std::max(_rows, p.rows);
+		offset += uint64(_blockCount(p.rows)) * BLOCK_SIZE;
+	}
+	// The file may contain an additional C-Block, but we don't need that.
+
+	if (_rows < 2)
+		return false;
+
+	_aRec.northings_rows = _rows; // The A-record stores 1 here (one row of profiles). The number of elevations in the longest profile is more useful.
+
+	return true;
+}
+
+bool DEMReader::ReadRegion(std::istream &file, uint32 x0, uint32 y0, uint32 w, uint32 h, uint32 step, float32 *dst) const
+{
+	if (w == 0 || h == 0)
+		return true;
+	step = std::max(step, 1u);
+	if (x0 + (w - 1) * step >= GetColumns())
+		return false;
+
+	List<char> buffer;
+	for (uint32 i = 0; i < w; i++) {
+		const Profile &p = _profiles[x0 + i * step];
+		uint32 rFirst = std::min(y0, p.rows - 1);
+		uint32 rLast = std::min(y0 + (h - 1) * step, p.rows - 1);
+		uint64 start = _valueOffset(rFirst), end = _valueOffset(rLast) + VALUE_SIZE;
+
+		// Read all blocks covering the region in one go. Only the needed part of the profile is loaded.
+		buffer.resize(size_t(end - start));
+		file.clear();
+		file.seekg(p.offset + start);
+		if (!file.read(buffer.data(), buffer.size()))
+			return false;
+
+		for (uint32 j = 0; j < h; j++) {
+			uint32 r = std::min(y0 + j * step, p.rows - 1);
+			dst[j * w + i] = float32(_aRec.xyz_resolution[2] * ParseInt(buffer.data() + size_t(_valueOffset(r) - start)) + p.z); // TODO: value can also -32767, which means it is a false value.
+		}
+	}
+
+	return true;
+}
+
+uint32 DEMReader::GetTileCountX(const DEMTileOptions &options) const
+{
+	uint32 n = GetSampleCountX(std::max(options.step, 1u)), t = std::max(options.tileSize, 1u);
+	return n < 2 ? 0 : (n - 1 + t - 1) / t;
+}
+
+uint32 DEMReader::GetTileCountY(const DEMTileOptions &options) const
+{
+	uint32 n = GetSampleCountY(std::max(options.step, 1u)), t = std::max(options.tileSize, 1u);
+	return n < 2 ? 0 : (n - 1 + t - 1) / t;
+}
+
+float32 DEMReader::_spacingX() const
+{
+	return _aRec.xyz_resolution[0] > 0.0f ? _aRec.xyz_resolution[0] : 1.0f;
+}
+
+float32 DEMReader::_spacingY() const
+{
+	return _aRec.xyz_resolution[1] > 0.0f ? _aRec.xyz_resolution[1] : 1.0f;
+}
+
+bool DEMReader::BuildTile(std::istream &file, uint32 tx, uint32 ty, const DEMTileOptions &options, DEMTile &tile) const
+{
+	const uint32 step = std::max(options.step, 1u), tileSize = std::max(options.tileSize, 1u);
+	const uint32 sx = GetSampleCountX(step), sy = GetSampleCountY(step);
+	if (tx >= GetTileCountX(options) || ty >= GetTileCountY(options))
+		return false;
+
+	tile.tileX = tx;
+	tile.tileY = ty;
+	tile.sampleX = tx * tileSize;
+	tile.sampleY = ty * tileSize;
+	tile.width = std::min(tile.sampleX + tileSize, sx - 1) - tile.sampleX + 1;
+	tile.height = std::min(tile.sampleY + tileSize, sy - 1) - tile.sampleY + 1;
+
+	const uint32 w = tile.width, h = tile.height;
+
+	// Read the tile and an apron of one sample used for the normals. The apron is clamped at the border of the DEM.
+	{
+		uint32 ax0 = tile.sampleX > 0 ? tile.sampleX - 1 : 0, ay0 = tile.sampleY > 0 ? tile.sampleY - 1 : 0;
+		uint32 ax1 = std::min(tile.sampleX + w, sx - 1), ay1 = std::min(tile.sampleY + h, sy - 1);
+		uint32 aw = ax1 - ax0 + 1, ah = ay1 - ay0 + 1;
+		List<float32> region(aw * ah);
+		if (!ReadRegion(file, ax0 * step, ay0 * step, aw, ah, step, region.data()))
+			return false;
+		tile.heights.resize((w + 2) * (h + 2));
+		for (uint32 j = 0; j < h + 2; j++) {
+			uint32 y = std::min(std::max(tile.sampleY + j, ay0 + 1), ay1 + 1) - ay0 - 1;
+			for (uint32 i = 0; i < w + 2; i++) {
+				uint32 x = std::min(std::max(tile.sampleX + i, ax0 + 1), ax1 + 1) - ax0 - 1;
+				tile.heights[j * (w + 2) + i] = region[y * aw + x];
+			}
+		}
+	}
+
+	const float32 dx = _spacingX() * step, dy = _spacingY() * step;
+	const uint32 ringCount = options.skirtDepth > 0.0f ? 2 * (w - 1) + 2 * (h - 1) : 0;
+	const uint32 vertexCount = w * h + ringCount;
+
+	tile.positions.resize(vertexCount);
+	tile.normals.resize(vertexCount);
+	tile.texCoords.resize(vertexCount * 2);
+	tile.minElevation = std::numeric_limits<float32>::max();
+	tile.maxElevation = -std::numeric_limits<float32>::max();
+
+	// Surface vertices.
+	for (uint32 j = 0; j < h; j++) {
+		uint32 gy = tile.sampleY + j;
+		int32 jS = gy > 0 ? (int32)j - 1 : (int32)j, jN = gy < sy - 1 ? (int32)j + 1 : (int32)j;
+		for (uint32 i = 0; i < w; i++) {
+			uint32 gx = tile.sampleX + i, v = j * w + i;
+			int32 iW = gx > 0 ? (int32)i - 1 : (int32)i, iE = gx < sx - 1 ? (int32)i + 1 : (int32)i;
+			float32 e = tile.GetHeight(i, j);
+			tile.positions[v] = XMFLOAT3(gx * dx, e, gy * dy);
+			float32 dhdx = (tile.GetHeight(iE, j) - tile.GetHeight(iW, j)) / (float32(iE - iW) * dx);
+			float32 dhdz = (tile.GetHeight(i, jN) - tile.GetHeight(i, jS)) / (float32(jN - jS) * dy);
+			XMStoreFloat3(&tile.normals[v], XMVector3Normalize(XMVectorSet(-dhdx, 1.0f, -dhdz, 0.0f)));
+			tile.texCoords[v * 2 + 0] = float32(gx) / float32(sx - 1);
+			tile.texCoords[v * 2 + 1] = 1.0f - float32(gy) / float32(sy - 1);
+			tile.minElevation = std::min(tile.minElevation, e);
+			tile.maxElevation = std::max(tile.maxElevation, e);
+		}
+	}
+
+	List<uint32> indices;
+	indices.reserve((w - 1) * (h - 1) * 6 + ringCount * 6);
+	for (uint32 j = 0; j < h - 1; j++) {
+		for (uint32 i = 0; i < w - 1; i++) {
+			uint32 a = j * w + i, b = a + 1, c = a + w, d = c + 1; // SW, SE, NW, NE
+			indices.push_back(a); indices.push_back(c); indices.push_back(b);
+			indices.push_back(b); indices.push_back(c); indices.push_back(d);
+		}
+	}
+
+	// Skirts: The border is walked counter clockwise as seen from above (outside on the right), and each border vertex gets a lowered copy.
+	if (ringCount > 0) {
+		List<uint32> ring;
+		ring.reserve(ringCount);
+		for (uint32 i = 0; i < w - 1; i++)
+			ring.push_back(i); // South edge, west->east.
+		for (uint32 j = 0; j < h - 1; j++)
+			ring.push_back(j * w + w - 1); // East edge, south->north.
+		for (uint32 i = w - 1; i > 0; i--)
+			ring.push_back((h - 1) * w + i); // North edge, east->west.
+		for (uint32 j = h - 1; j > 0; j--)
+			ring.push_back(j * w); // West edge, north->south.
+
+		const float32 depth = options.skirtDepth * std::max(dx, dy);
+		for (uint32 k = 0; k < ringCount; k++) {
+			uint32 s = w * h + k;
+			tile.positions[s] = tile.positions[ring[k]];
+			tile.positions[s].y -= depth;
+			tile.normals[s] = tile.normals[ring[k]];
+			tile.texCoords[s * 2 + 0] = tile.texCoords[ring[k] * 2 + 0];
+			tile.texCoords[s * 2 + 1] = tile.texCoords[ring[k] * 2 + 1];
+		}
+		for (uint32 k = 0; k < ringCount; k++) {
+			uint32 l = (k + 1) % ringCount;
+			uint32 p = ring[k], q = ring[l], ps = w * h + k, qs = w * h + l;
+			indices.push_back(p); indices.push_back(q); indices.push_back(qs);
+			indices.push_back(p); indices.push_back(qs); indices.push_back(ps);
+		}
+	}
+
+	tile.indices.resize(indices.size());
+	meshoptimization::OptimizeVertexCache(tile.indices.data(), indices.data(), indices.size(), vertexCount);
+
+	XMVECTOR bMin = XMLoadFloat3(&tile.positions[0]), bMax = bMin;
+	for (uint32 v = 1; v < vertexCount; v++) {
+		XMVECTOR p = XMLoadFloat3(&tile.positions[v]);
+		bMin = XMVectorMin(bMin, p);
+		bMax = XMVectorMax(bMax, p);
+	}
+	XMStoreFloat3(&tile.boundsMin, bMin);
+	XMStoreFloat3(&tile.boundsMax, bMax);
+
+	return true;
+}
+
+void DEMReader::ParseString(char *dest, const char *buffer, uint32 count)
+{
+	std::memcpy(dest, buffer, count); // count is without terminating 0.
+	for (; count > 0; count--)
+		if (dest[count - 1] != ' ')
+			break;
+	dest[count] = '\0';
+}
+
+int32 DEMReader::ParseInt(const char *buffer, uint32 count)
+{
+	char tmp[64];
+	ParseString(tmp, buffer, count);
+	for (char *c = tmp; *c; c++) if (*c == 'D') *c = 'E';
+	return atoi(tmp);
+}
+
+float64 DEMReader::ParseDouble(const char *buffer, uint32 count)
+{
+	char tmp[64];
+	ParseString(tmp, buffer, count);
+	for (char *c = tmp; *c; c++) if (*c == 'D') *c = 'E';
+	return atof(tmp);
+}
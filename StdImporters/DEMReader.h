@@ -0,0 +1,185 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DCore/MMath.h"
+#include <istream>
+
+namespace m3d
+{
+
+// A-record (file header) of a USGS DEM file.
+struct DEMARecord
+{
+	/// <summary>
+	/// The authorized digital cell name followed by a comma, space, and the two-character State designator(s) separated by hyphens.
+	/// Abbreviations for other countries, such as Canada and Mexico, shall not be represented in the DEM header.
+	/// </summary>
+	char file_name[41];
+	/// <summary>
+	/// Free format descriptor field, contains useful information related to digital process such as digitizing instrument, photo codes, slot widths, etc.
+	/// </summary>
+	char free_text_format[41];
+	/// <summary>
+	/// Southing of the southeast geographic corner
+	/// SE geographic quadrangle corner ordered as:
+	///     x = Longitude = SDDDMMSS.SSSS
+	///     y = Latitude = SDDDMMSS.SSSS
+	/// (neg sign (S) right justified, no leading zeroes, plus sign (S) implied)
+	/// </summary>
+	char SE_geographic_corner_S[14];
+	/// <summary>
+	/// Easting of the southeast geographic corner
+	/// SE geographic quadrangle corner ordered as:
+	///     x = Longitude = SDDDMMSS.SSSS
+	///     y = Latitude = SDDDMMSS.SSSS
+	/// (neg sign (S) right justified, no leading zeroes, plus sign (S) implied)
+	/// </summary>
+	char SE_geographic_corner_E[14];
+	/// <summary>
+	/// 1=Autocorrelation RESAMPLE Simple bilinear
+	/// 2=Manual profile GRIDEM Simple bilinear
+	/// 3=DLG/hypsography CTOG 8-direction linear
+	/// 4=Interpolation from photogrammetric system contours DCASS 4-direction linear
+	/// 5=DLG/hypsography LINETRACE, LT4X Complex linear
+	/// 6=DLG/hypsography CPS-3, ANUDEM, GRASS Complex polynomial
+	/// 7=Electronic imaging (non-photogrametric), active or passive, sensor systems.
+	/// </summary>
+	char process_code;
+	/// <summary>
+	/// Free format Mapping Origin Code. Example: MAC, WMC, MCMC, RMMC, FS, BLM, CONT (contractor), XX (state postal code).
+	/// </summary>
+	char origin_code[5];
+	/// <summary>
+	/// Code 1=DEM-1
+	/// 2=DEM-2
+	/// 3=DEM-3
+	/// 4=DEM-4
+	/// </summary>
+	int32 dem_level_code;
+	/// <summary>
+	/// 1 = regular
+	/// 2 = random
+	/// </summary>
+	int32 elevation_pattern;
+	int32 ground_ref_system;
+	int32 ground_ref_zone;
+	float64 projection[15];
+	int32 ground_unit;
+	int32 elevation_unit;
+	int32 side_count;
+	// pairs of easting-northings
+	float64 sw_coord[2];
+	float64 nw_coord[2];
+	float64 ne_coord[2];
+	float64 se_coord[2];
+	float64 ccw_angle;
+	float64 elevation_min;
+	float64 elevation_max;
+	int32 elevation_accuracy;
+	float32 xyz_resolution[3];
+	int32 northings_rows;
+	int32 eastings_cols;
+	int32 suspect_void;
+	int32 percent_void;
+};
+
+// Settings for splitting a DEM into tiles.
+struct DEMTileOptions
+{
+	uint32 tileSize = 128; // Quads along each edge of a tile.
+	uint32 step = 1; // Only every step'th sample is used. 2 halves the resolution.
+	float32 skirtDepth = 2.0f; // Depth of the skirts hiding cracks between tiles, in sample spacings. 0 for no skirts.
+};
+
+// Geometry of one tile. Positions are relative to the south west corner of the DEM, with x east, y up (elevation) and z north.
+struct DEMTile
+{
+	uint32 tileX = 0, tileY = 0; // (0,0) is the south west tile.
+	uint32 sampleX = 0, sampleY = 0; // First sample of the tile, counted in steps.
+	uint32 width = 0, height = 0; // Samples along each edge. Neighbouring tiles share their edge samples.
+	List<float32> heights; // (width + 2) * (height + 2) elevations, south to north rows of west to east samples, including a one sample apron clamped at the DEM border.
+	List<XMFLOAT3> positions; // width * height surface vertices, followed by the skirt vertices.
+	List<XMFLOAT3> normals;
+	List<float32> texCoords; // 2 per vertex, spanning the whole DEM with v = 0 in the north.
+	List<uint32> indices; // Clockwise triangles as seen from above.
+	float32 minElevation = 0.0f, maxElevation = 0.0f; // Of the surface vertices.
+	XMFLOAT3 boundsMin = XMFLOAT3(0.0f, 0.0f, 0.0f), boundsMax = XMFLOAT3(0.0f, 0.0f, 0.0f); // Including skirts.
+
+	float32 GetHeight(int32 x, int32 y) const { return heights[(y + 1) * (width + 2) + x + 1]; } // -1 to width/height.
+};
+
+// Reads USGS DEM files without loading them into memory.
+// Open(...) indexes where each profile is stored, so any region can be read by seeking directly to it.
+// Reading is const and takes the stream as argument, so several threads can read tiles using a stream each.
+class DEMReader
+{
+public:
+	DEMReader();
+
+	// Reads the A-record and indexes the profiles. Returns false if the file is not a regular grid DEM.
+	bool Open(std::istream &file);
+
+	const DEMARecord &GetARecord() const { return _aRec; }
+	// Number of profiles (west to east).
+	uint32 GetColumns() const { return (uint32)_profiles.size(); }
+	// Number of elevations in the longest profile (south to north).
+	uint32 GetRows() const { return _rows; }
+
+	// Reads w * h elevations starting at column x0 and row y0, taking every step'th sample.
+	// dst is filled south to north with rows of west to east samples. Rows missing in short profiles repeat the last elevation of the profile.
+	bool ReadRegion(std::istream &file, uint32 x0, uint32 y0, uint32 w, uint32 h, uint32 step, float32 *dst) const;
+
+	// Number of samples along each axis when taking every step'th sample.
+	uint32 GetSampleCountX(uint32 step) const { return _profiles.empty() ? 0 : (GetColumns() - 1) / step + 1; }
+	uint32 GetSampleCountY(uint32 step) const { return _rows == 0 ? 0 : (_rows - 1) / step + 1; }
+	uint32 GetTileCountX(const DEMTileOptions &options) const;
+	uint32 GetTileCountY(const DEMTileOptions &options) const;
+
+	// Reads the samples of tile (tx,ty) and builds its vertices and indices. The vertex cache is optimized.
+	bool BuildTile(std::istream &file, uint32 tx, uint32 ty, const DEMTileOptions &options, DEMTile &tile) const;
+
+	static void ParseString(char *dest, const char *buffer, uint32 count);
+	static int32 ParseInt(const char *buffer, uint32 count = 6);
+	static float64 ParseDouble(const char *buffer, uint32 count = 24);
+	static float32 ParseFloat(const char *buffer, uint32 count = 12) { return (float32)ParseDouble(buffer, count); }
+
+private:
+	struct Profile
+	{
+		uint64 offset; // File offset of the first block.
+		uint32 rows; // Number of elevations.
+		float64 z; // Datum elevation added to all elevations.
+	};
+
+	DEMARecord _aRec;
+	List<Profile> _profiles;
+	uint32 _rows;
+
+	float32 _spacingX() const;
+	float32 _spacingY() const;
+};
+
+}
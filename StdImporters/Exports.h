@@ -24,7 +24,9 @@
 #pragma once
 
 
-#ifdef StdImporters_EXPORTS
+#if defined(STDIMPORTERS_STATIC)
+#define STDIMPORTERS_API
+#elif defined(StdImporters_EXPORTS)
 #define STDIMPORTERS_API __declspec(dllexport)
 #else
 #define STDIMPORTERS_API __declspec(dllimport)
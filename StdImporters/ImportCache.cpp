@@ -0,0 +1,140 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "stdafx.h"
+#include "ImportCache.h"
+#include "M3DCore/DataBuffer.h"
+#include <cstring>
+
+using namespace m3d;
+
+
+namespace
+{
+
+// Cache files hold the dependency count (uint32), the dependencies and the data.
+// Each dependency is a uint64 hash of the file, a uint32 length and the path (UTF-8).
+static const uint32 CACHE_FILE_MAGIC = 0x43495853; // "SXIC"
+static const uint32 CACHE_FILE_VERSION = 3;
+
+uint64 _hashFile(const std::filesystem::path &filename, bool &ok)
+{
+	List<uint8> data;
+	ok = ReadFileData(filename, data);
+	return ok ? DataBuffer::hash(data.data(), data.size()) : 0;
+}
+
+}
+
+
+ImportCache::ImportCache(std::filesystem::path directory) : _disk(directory, MTEXT(".sxic"), CACHE_FILE_MAGIC, CACHE_FILE_VERSION)
+{
+}
+
+ImportCache::~ImportCache()
+{
+}
+
+ImportCache &ImportCache::GetInstance()
+{
+	static ImportCache cache([]() {
+		std::error_code ec;
+		std::filesystem::path dir = std::filesystem::temp_directory_path(ec);
+		return ec ? std::filesystem::path() : dir / MTEXT("SnaX") / MTEXT("ImportCache"); // No temp dir: no cache.
+		}());
+	return cache;
+}
+
+uint64 ImportCache::GetKey(const std::filesystem::path &filename, const String &settings) const
+{
+	bool ok;
+	uint64 fileHash = _hashFile(filename, ok);
+	if (!ok)
+		return 0;
+	String s = settings + MTEXT("\n") + DiskCache::KeyToString(fileHash);
+	uint64 key = DataBuffer::hash((const uint8*)s.c_str(), s.size() * sizeof(Char));
+	return key != 0 ? key : 1; // 0 is reserved for failures.
+}
+
+bool ImportCache::Load(uint64 key, List<uint8> &data) const
+{
+	List<uint8> file;
+	if (!_disk.Read(key, file) || file.size() < sizeof(uint32))
+		return false;
+	const uint8 *p = file.data(), *end = p + file.size();
+	uint32 dependencyCount;
+	std::memcpy(&dependencyCount, p, sizeof(uint32));
+	p += sizeof(uint32);
+
+	for (uint32 i = 0; i < dependencyCount; i++) {
+		uint64 hash;
+		uint32 length;
+		if (size_t(end - p) < sizeof(uint64) + sizeof(uint32))
+			return false;
+		std::memcpy(&hash, p, sizeof(uint64));
+		std::memcpy(&length, p + sizeof(uint64), sizeof(uint32));
+		p += sizeof(uint64) + sizeof(uint32);
+		if (size_t(end - p) < length)
+			return false;
+		std::filesystem::path dependency = std::filesystem::u8path((const char*)p, (const char*)p + length);
+		p += length;
+		bool ok;
+		if (_hashFile(dependency, ok) != hash || !ok)
+			return false; // Changed or removed.
+	}
+
+	if (p == end)
+		return false;
+
+	data.assign(p, end);
+	return true;
+}
+
+bool ImportCache::Store(uint64 key, const uint8 *data, size_t size, const List<std::filesystem::path> &dependencies)
+{
+	if (_disk.GetDirectory().empty() || key == 0 || size == 0)
+		return false;
+
+	List<uint8> file(sizeof(uint32));
+	uint32 dependencyCount = (uint32)dependencies.size();
+	std::memcpy(file.data(), &dependencyCount, sizeof(uint32));
+	for (const std::filesystem::path &dependency : dependencies) {
+		bool ok;
+		uint64 hash = _hashFile(dependency, ok);
+		if (!ok)
+			return false;
+		std::string s = dependency.u8string();
+		uint32 length = uint32(s.size());
+		file.insert(file.end(), (const uint8*)&hash, (const uint8*)&hash + sizeof(uint64));
+		file.insert(file.end(), (const uint8*)&length, (const uint8*)&length + sizeof(uint32));
+		file.insert(file.end(), (const uint8*)s.c_str(), (const uint8*)s.c_str() + length);
+	}
+	file.insert(file.end(), data, data + size);
+
+	return _disk.Write(key, file.data(), file.size());
+}
+
+void ImportCache::Clear()
+{
+	_disk.Clear();
+}
@@ -0,0 +1,66 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "Exports.h"
+#include "M3DCore/MString.h"
+#include "M3DCore/Containers.h"
+#include "M3DCore/DiskCache.h"
+#include <filesystem>
+
+namespace m3d
+{
+
+// Imported data by a hash of the source file and the import settings, so that reimports can skip reading and post processing.
+// OpenAssetImpLib stores the post processed assimp scenes in assimp's binary format (assbin). The other files read for an import
+// (like .mtl or .bin files) are stored with their hashes in the entry, and an entry is only used if all of them are unchanged.
+// This does not depend on assimp, so it can be tested on any platform.
+class STDIMPORTERS_API ImportCache
+{
+public:
+	ImportCache(std::filesystem::path directory);
+	~ImportCache();
+
+	// The shared cache, in %TEMP%\SnaX\ImportCache.
+	static ImportCache &GetInstance();
+
+	const std::filesystem::path &GetDirectory() const { return _disk.GetDirectory(); }
+	void SetDirectory(std::filesystem::path directory) { _disk.SetDirectory(directory); }
+
+	// Returns the key for reading filename. settings must identify everything else affecting the result, like the reader version
+	// and flags. Returns 0 if the file can not be read.
+	uint64 GetKey(const std::filesystem::path &filename, const String &settings) const;
+	// Returns the data stored for key, if the files it depends on are unchanged.
+	bool Load(uint64 key, List<uint8> &data) const;
+	// Stores data for key. dependencies are the other files read to produce it. Returns false if it could not be stored.
+	bool Store(uint64 key, const uint8 *data, size_t size, const List<std::filesystem::path> &dependencies);
+
+	// Removes all entries from the cache directory.
+	void Clear();
+
+private:
+	DiskCache _disk;
+};
+
+}
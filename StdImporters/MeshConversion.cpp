@@ -0,0 +1,155 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "stdafx.h"
+#include "MeshConversion.h"
+#include "GraphicsChips/MeshOptimization.h"
+#include "M3DCore/ThreadPool.h"
+#include <assimp/scene.h>
+#include <algorithm>
+
+using namespace m3d;
+using namespace m3d::meshconversion;
+
+
+bool meshconversion::Convert(const aiMesh *mesh, ConvertedMesh &out, const MeshConversionOptions &options)
+{
+	out = ConvertedMesh();
+	out.tcMap.fill(uint32(-1));
+
+	if (mesh->mPrimitiveTypes != aiPrimitiveType_POINT && mesh->mPrimitiveTypes != aiPrimitiveType_LINE && mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE)
+		return false; // Polygons are not supported, neither are mixed types within a single subset! (aiProcess_Triangulate takes care of n-sided polygons)
+
+	const uint32 n = mesh->mNumVertices;
+	out.vertexCount = n;
+
+	if (mesh->HasPositions())
+		out.positions.assign((const XMFLOAT3*)mesh->mVertices, (const XMFLOAT3*)mesh->mVertices + n);
+
+	if (mesh->HasNormals())
+		out.normals.assign((const XMFLOAT3*)mesh->mNormals, (const XMFLOAT3*)mesh->mNormals + n);
+
+	for (uint32 k = 0; k < mesh->GetNumColorChannels(); k++) {
+		if (mesh->HasVertexColors(k)) {
+			if (out.colors.size()) {
+				out.skippedColorSets++;
+				continue;
+			}
+			out.colors.reserve(n);
+			for (uint32 j = 0; j < n; j++)
+				out.colors.push_back(XMCOLOR((const float32*)&mesh->mColors[k][j]));
+		}
+	}
+
+	uint32 tcCount = 0;
+	for (uint32 k = 0; k < AI_MAX_NUMBER_OF_TEXTURECOORDS; k++) {
+		if (!mesh->HasTextureCoords(k))
+			continue;
+		if (tcCount == ConvertedMesh::MAX_TEXCOORD_SETS) {
+			out.skippedTexCoordSets.push_back(k);
+			continue;
+		}
+		uint32 components = options.force2CompTexcoords ? 2 : mesh->mNumUVComponents[k];
+		if (components >= 1 && components <= 3) { // 4 is not supported by assimp!
+			List<float32> &tc = out.texCoords[tcCount];
+			tc.resize(size_t(n) * components);
+			for (uint32 j = 0; j < n; j++)
+				for (uint32 c = 0; c < components; c++)
+					tc[size_t(j) * components + c] = mesh->mTextureCoords[k][j][c];
+			out.texCoordComponents[tcCount] = components;
+		}
+		out.tcMap[k] = tcCount++;
+	}
+
+	if (mesh->HasFaces()) { // Should ALWAYS be present!
+		out.indices.reserve(size_t(mesh->mNumFaces) * (mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE ? 3 : mesh->mPrimitiveTypes == aiPrimitiveType_LINE ? 2 : 1));
+		for (uint32 j = 0; j < mesh->mNumFaces; j++) {
+			const aiFace &face = mesh->mFaces[j];
+			out.indices.insert(out.indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
+		}
+	}
+
+	if (mesh->HasTangentsAndBitangents()) {
+		// NOTE: Sometimes, if the model contains triangles with two equal vertices/texcoord, mTangents/mBitangents will contain -1.#IND.
+		// Check CalcTangentsProcess.cpp (ca line 200) in assimp. For now, set them to the normal if found. (degenerates not visible anyway)...
+		out.tangents.resize(n);
+		out.bitangents.resize(n);
+		for (uint32 j = 0; j < n; j++) {
+			const XMFLOAT3 &t = (const XMFLOAT3&)mesh->mTangents[j];
+			const XMFLOAT3 &b = (const XMFLOAT3&)mesh->mBitangents[j];
+			if (t.x != t.x || b.y != b.y) { // Checks only x. Should be enough! (Checks for -1.#IND)
+				if (mesh->HasNormals())
+					out.tangents[j] = out.bitangents[j] = out.normals[j];
+				else {
+					out.tangents[j] = XMFLOAT3(1.0f, 0.0f, 0.0f);
+					out.bitangents[j] = XMFLOAT3(0.0f, 1.0f, 0.0f);
+				}
+				continue;
+			}
+			out.tangents[j] = t;
+			out.bitangents[j] = b;
+		}
+	}
+	else if (options.generateTangents && mesh->mPrimitiveTypes == aiPrimitiveType_TRIANGLE && mesh->HasNormals() && mesh->HasTextureCoords(0) && out.positions.size()) {
+		out.tangents.resize(n);
+		out.bitangents.resize(n);
+		meshoptimization::GenerateTangents(&out.tangents.front().x, &out.bitangents.front().x, sizeof(XMFLOAT3), out.indices.data(), out.indices.size(), &out.positions.front().x, sizeof(XMFLOAT3),
+			&out.normals.front().x, sizeof(XMFLOAT3), &mesh->mTextureCoords[0][0].x, sizeof(aiVector3D), n, options.flipV);
+		out.tangentsGenerated = true;
+	}
+
+	if (mesh->HasBones()) {
+		List<XMFLOAT4> weights(n, XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f)); // Should add up to 1.0 for each vertex.
+		out.blendIndices.resize(n, XMUSHORT4(ConvertedMesh::UNUSED_BONE, ConvertedMesh::UNUSED_BONE, ConvertedMesh::UNUSED_BONE, ConvertedMesh::UNUSED_BONE));
+		for (uint32 j = 0; j < mesh->mNumBones; j++) {
+			const aiBone *bone = mesh->mBones[j];
+			for (uint32 k = 0; k < bone->mNumWeights; k++) { // These should be limited to 4 by aiProcess_LimitBoneWeights!
+				const aiVertexWeight &w = bone->mWeights[k];
+				if (w.mVertexId >= n)
+					continue;
+				float32 *vw = &weights[w.mVertexId].x;
+				uint16 *vi = &out.blendIndices[w.mVertexId].x;
+				for (uint32 p = 0; p < 4; p++) {
+					if (vw[p] == 0.0f) {
+						vi[p] = (uint16)j;
+						vw[p] = w.mWeight;
+						break;
+					}
+				}
+			}
+		}
+		out.blendWeights.reserve(n);
+		for (uint32 j = 0; j < n; j++)
+			out.blendWeights.push_back(XMUBYTEN4(&weights[j].x));
+	}
+
+	return true;
+}
+
+void meshconversion::ConvertScene(const aiScene *scene, List<ConvertedMesh> &out, const MeshConversionOptions &options)
+{
+	out.clear();
+	out.resize(scene->mNumMeshes);
+	ThreadPool::GetShared().ParallelFor(scene->mNumMeshes, [&](uint32 i) { Convert(scene->mMeshes[i], out[i], options); }, options.threadCount);
+}
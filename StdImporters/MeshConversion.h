@@ -0,0 +1,77 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DCore/MMath.h"
+#include <assimp/mesh.h>
+
+struct aiScene;
+
+namespace m3d
+{
+
+// Vertex and index data of an aiMesh, in the formats used by StdGeometry.
+struct ConvertedMesh
+{
+	static const uint32 MAX_TEXCOORD_SETS = 4; // Same as StdGeometry::MAX_TEXCOORD_SETS.
+	static const uint16 UNUSED_BONE = 0xFFFF; // Blend index of unused weights.
+
+	uint32 vertexCount = 0;
+	List<XMFLOAT3> positions;
+	List<XMFLOAT3> normals;
+	List<XMFLOAT3> tangents;
+	List<XMFLOAT3> bitangents;
+	List<XMCOLOR> colors; // Only the first color set is used.
+	List<float32> texCoords[MAX_TEXCOORD_SETS]; // texCoordComponents[i] floats per vertex.
+	uint32 texCoordComponents[MAX_TEXCOORD_SETS] = {}; // 1-3. 0 if the set is not used.
+	Array<uint32, AI_MAX_NUMBER_OF_TEXTURECOORDS> tcMap; // Mapping from assimp texture coordinate set to ours. -1 if not mapped.
+	List<XMUSHORT4> blendIndices; // Indices into aiMesh::mBones. Must be mapped to skeleton joints by the importer.
+	List<XMUBYTEN4> blendWeights;
+	List<uint32> indices; // Relative to the first vertex of the mesh.
+	bool tangentsGenerated = false;
+	uint32 skippedColorSets = 0; // Number of color sets not imported.
+	List<uint32> skippedTexCoordSets; // Assimp texture coordinate sets not imported.
+};
+
+// Settings for converting meshes.
+struct MeshConversionOptions
+{
+	bool force2CompTexcoords = false; // Import all texture coordinate sets as uv.
+	bool generateTangents = false; // Generate tangents for triangle meshes having normals and texture coordinates, but no tangents.
+	bool flipV = true; // The v-coordinates have been flipped by aiProcess_FlipUVs. Used for generating tangents.
+	uint32 threadCount = 0; // Number of worker threads. 0 to use all hardware threads.
+};
+
+// Conversion of assimp meshes to StdGeometry data. Each mesh is independent of the others, so the scene is converted in parallel.
+// This depends on assimp only, not on D3D or the engine, so it can be tested on any platform.
+namespace meshconversion
+{
+	// Converts a mesh. Returns false if the mesh has mixed or unsupported primitive types.
+	bool Convert(const aiMesh *mesh, ConvertedMesh &out, const MeshConversionOptions &options = MeshConversionOptions());
+	// Converts all meshes of a scene. out is indexed as scene->mMeshes. Unsupported meshes get vertexCount 0.
+	void ConvertScene(const aiScene *scene, List<ConvertedMesh> &out, const MeshConversionOptions &options = MeshConversionOptions());
+}
+
+}
@@ -40,6 +40,7 @@
 #include "StdChips/VectorOperator.h"
 #include "StdChips/MatrixOperator.h"
 #include "GraphicsChips/Texture.h"
+#include "GraphicsChips/TextureProcessing.h"
 #include "GraphicsChips/Material.h"
 #include "GraphicsChips/Renderable.h"
 #include "GraphicsChips/StdGeometry.h"
@@ -52,14 +53,83 @@
 #include "GraphicsChips/Shader.h"
 #include "GraphicsChips/GraphicsMatrix.h"
 #include "GraphicsChips/SkeletonController.h"
+#include "M3DCore/HighPrecisionTimer.h"
+#include "M3DCore/ThreadPool.h"
+#include "ImportCache.h"
 
 #include <assimp\LogStream.hpp>
 #include <assimp\DefaultLogger.hpp>
+#include <assimp\Exporter.hpp>
+#include <assimp\DefaultIOSystem.h>
+#include <assimp\version.h>
 #include <typeinfo>
 
 using namespace m3d;
 
 
+namespace
+{
+
+// Records the files opened by assimp.
+class RecordingIOSystem : public Assimp::DefaultIOSystem
+{
+public:
+	Set<Path> files;
+
+	Assimp::IOStream *Open(const char *file, const char *mode) override
+	{
+		Assimp::IOStream *s = Assimp::DefaultIOSystem::Open(file, mode);
+		if (s)
+			files.insert(Path(String(file)));
+		return s;
+	}
+};
+
+// Loads the post processed scene from the import cache, or else reads filename using importer and stores the result in assbin format.
+// The scene is owned by importer. fromCache is set if the scene was loaded from the cache.
+const aiScene *_readFileCached(ImportCache &cache, Assimp::Importer &importer, Path filename, uint32 flags, uint32 removeComponents, bool useCache, bool *fromCache)
+{
+	*fromCache = false;
+
+	// The assimp version is included, as the readers and post processing steps change between versions.
+	std::filesystem::path fn(filename.AsString().c_str());
+	String settings = strUtils::ConstructString(MTEXT("assimp %1.%2.%3\n%4\n%5")).arg(aiGetVersionMajor()).arg(aiGetVersionMinor()).arg(aiGetVersionRevision()).arg(flags).arg(removeComponents);
+	uint64 key = useCache ? cache.GetKey(fn, settings) : 0;
+
+	if (key != 0) {
+		List<uint8> data;
+		if (cache.Load(key, data)) {
+			const aiScene *scene = importer.ReadFileFromMemory(data.data(), data.size(), 0, "assbin");
+			if (scene) {
+				*fromCache = true;
+				return scene;
+			}
+		}
+	}
+
+	// The importer does not take ownership of the handler. SetIOHandler(nullptr) hands it back to us and restores the default.
+	std::unique_ptr<RecordingIOSystem> io(new RecordingIOSystem());
+	importer.SetIOHandler(io.get());
+	const aiScene *scene = importer.ReadFile(filename.AsString().c_str(), flags);
+	List<std::filesystem::path> dependencies;
+	for (const Path &p : io->files)
+		if (!(p == filename))
+			dependencies.push_back(std::filesystem::path(p.AsString().c_str()));
+	importer.SetIOHandler(nullptr);
+
+	if (scene && key != 0) {
+		Assimp::Exporter exporter;
+		const aiExportDataBlob *blob = exporter.ExportToBlob(scene, "assbin");
+		if (blob)
+			cache.Store(key, (const uint8*)blob->data, blob->size, dependencies);
+	}
+
+	return scene;
+}
+
+}
+
+
 
 CHIPDESCV1_DEF_IMPORTER(OpenAssetImpLib, MTEXT("Open Asset Import Library"), OPENASSETIMPLIB_GUID, IMPORTER_GUID, MTEXT("3D;3DS;3MF;AC;AC3D;ACC;AMJ;ASE;ASK;B3D;BLEND;BVH;CMS;COB;DAE;DXF;ENFF;FBX;GLB;glTF;HMB;IFC;STEP;IRR;IRRMESH;LWO;LWS;LXO;MD2;MD3;MD5;MDC;MDL;MESH;MESH.XML;MOT;MS3D;NDO;NFF;OBJ;OFF;OGEX;PLY;PMX;PRJ;Q3O;Q3S;RAW;SCN;SIB;SMD;STP;STL;TER;UC;VTA;X;X3D;XGL;ZGL"));
 	
@@ -81,7 +151,10 @@ OpenAssetImpLib::OpenAssetImpLib()
 	_postProcessFlags = aiProcess_JoinIdenticalVertices | aiProcess_ImproveCacheLocality | aiProcess_RemoveRedundantMaterials | aiProcess_GenUVCoords | aiProcess_TransformUVCoords;
 	_removeComps = 0;
 	_useShortcuts = true;
+	_compressTextures = false;
+	_optimizeMeshes = true;
 	_numBones = 0;
+	_useImportCache = true;
 }
 
 OpenAssetImpLib::~OpenAssetImpLib()
@@ -92,6 +165,7 @@ void OpenAssetImpLib::_readTextures(const aiScene* scene, const aiMaterial *mate
 {
 	for (uint32 i = 0, j = material->GetTextureCount(type); i < j; i++) {
 		TexDesc t;
+		t.type = type;
 		aiString p;
 		material->GetTexture(type, i, &p, &t.mapping, &t.uvindex, &t.blend, &t.op, t.mapMode);
 		if (t.blend == 0.0f)
@@ -165,9 +239,11 @@ Chip *OpenAssetImpLib::_loadTexture(const TexDesc &td, const Array<uint32, AI_MA
 							msg(WARN, MTEXT("Unknown file format for embedded texture (\'") + p.AsString() + MTEXT("\')."));
 						}
 						if (ifm != ImageFileFormat::IFF_UNKNOWN) {
-							if (!tex->SetImageData(std::move(db), ImageFileFormat::IFF_JPG)) {
+							if (!tex->SetImageData(std::move(db), ifm)) {
 								msg(WARN, MTEXT("Invalid data for embedded texture (\'") + p.AsString() + MTEXT("\')."));
 							}
+							else
+								_processTexture(tex, td);
 						}
 					}
 				}
@@ -177,6 +253,8 @@ Chip *OpenAssetImpLib::_loadTexture(const TexDesc &td, const Array<uint32, AI_MA
 					if (!tex->LoadImageDataFromFile(p)) {
 						msg(WARN, MTEXT("Failed to load texture \'") + p.AsString() + MTEXT("\'."));
 					}
+					else
+						_processTexture(tex, td);
 				}
 			}
 			n = _textureMap.insert(std::make_pair(p, tex)).first;
@@ -393,6 +471,37 @@ Chip *OpenAssetImpLib::_getGraphicsState(const StateDesc &sd)
 	return n->second;
 }
 
+void OpenAssetImpLib::_processTexture(Texture *tex, const TexDesc &td)
+{
+	if (!_compressTextures)
+		return;
+
+	TextureProcessingOptions options;
+	options.compression = TextureCompression::BC7;
+	// The generated shaders sample all maps as stored (no sRGB formats), so color maps are only filtered in linear space.
+	options.sRGBFormat = false;
+	switch (td.type)
+	{
+	case aiTextureType_DIFFUSE:
+	case aiTextureType_AMBIENT:
+	case aiTextureType_SPECULAR:
+	case aiTextureType_EMISSIVE:
+	case aiTextureType_REFLECTION:
+	case aiTextureType_LIGHTMAP:
+		options.sRGB = true;
+		break;
+	case aiTextureType_NORMALS:
+		options.sRGB = false;
+		options.normalMap = true;
+		break;
+	default:
+		options.sRGB = false;
+		break;
+	}
+
+	tex->ProcessImageData(options); // On failure, the original image data is kept.
+}
+
 Chip *OpenAssetImpLib::_processMaterial(const MaterialDesc &md, const aiScene* scene)
 {
 	auto n = _materialMap.find(md); // Check if we have processed this material before.
@@ -712,135 +821,69 @@ Renderable *OpenAssetImpLib::_processMeshList(const MeshList &meshes, BoneMap &b
 
 	uint32 baseIndex = 0;
 
-	// Iterate meshes in the list.
+	// Iterate meshes in the list. They are already converted by meshconversion::ConvertScene(...).
 	for (size_t i = 0; i < meshes.size(); i++) {
-		aiMesh *mesh = meshes[i];
+		const aiMesh *mesh = scene->mMeshes[meshes[i]];
+		const ConvertedMesh &cm = _convertedMeshes[meshes[i]];
 
 		VertexLayout vl = { 0 };
 
 		if (mesh->mPrimitiveTypes != aiPrimitiveType_POINT && mesh->mPrimitiveTypes != aiPrimitiveType_LINE && mesh->mPrimitiveTypes != aiPrimitiveType_TRIANGLE)
 			return nullptr; // Skip it, polygons not supported, neighter are mixed types within a single subset! (We have set the flag aiProcess_Triangulate to take care of n-sided polygons)
 
-		if (vl.hasPositions = mesh->HasPositions())
-			for (uint32 j = 0; j < mesh->mNumVertices; j++)
-				geometry->AddPosition((const XMFLOAT3&)mesh->mVertices[j]);
+		const uint32 n = cm.vertexCount;
 
-		if (vl.hasNormals = mesh->HasNormals())
-			for (uint32 j = 0; j < mesh->mNumVertices; j++)
-				geometry->AddNormal((const XMFLOAT3&)mesh->mNormals[j]);
-
-		bool colorFound = false;
-		for (uint32 k = 0; k < mesh->GetNumColorChannels(); k++) {
-			if (mesh->HasVertexColors(k)) {
-				if (colorFound) {
-					msg(WARN, MTEXT("Skipping color set. Only one color set is supported!"));
-				}
-				else {
-					for (uint32 j = 0; j < mesh->mNumVertices; j++)
-						geometry->AddColor(XMCOLOR((const float32*)&mesh->mColors[k][j]));
-					colorFound = vl.hasColors = true;
-				}
-			}
-		}
+		if (vl.hasPositions = cm.positions.size() > 0)
+			geometry->AddPositions(cm.positions.data(), n);
 
-		if (mesh->HasTangentsAndBitangents()) {
-			// NOTE: Sometimes, if the model contains triangles with two equal vertices/texcoord, mTangents/mBitangents will contain -1.#IND.
-			// Check CalcTangentsProcess.cpp (ca line 200) in assimp. Is this a bug/issue in that lib that can be fixed somehow?
-			// For now, I check for #IND in (bi)tangents, and just set to normal if found. (degenerates not visible anyway)...
+		if (vl.hasNormals = cm.normals.size() > 0)
+			geometry->AddNormals(cm.normals.data(), n);
 
-			vl.hasBitangents = vl.hasTangent = true;
+		if (vl.hasColors = cm.colors.size() > 0)
+			geometry->AddColors(cm.colors.data(), n);
+		for (uint32 k = 0; k < cm.skippedColorSets; k++)
+			msg(WARN, MTEXT("Skipping color set. Only one color set is supported!"));
 
-			for (uint32 j = 0; j < mesh->mNumVertices; j++) {
-				const XMFLOAT3 &t = (const XMFLOAT3&)mesh->mTangents[j];
-				const XMFLOAT3 &b = (const XMFLOAT3&)mesh->mBitangents[j];
-				if (t.x != t.x || b.y != b.y) { // Checks only x. Should be enough! (Checks for -1.#IND)
-					if (mesh->HasNormals()) {
-						geometry->AddTangent((const XMFLOAT3&)mesh->mNormals[j]);
-						geometry->AddBitangent((const XMFLOAT3&)mesh->mNormals[j]);
-					}
-					else {
-						geometry->AddTangent(XMFLOAT3(1.0f, 0.0f, 0.0f));
-						geometry->AddBitangent(XMFLOAT3(0.0f, 1.0f, 0.0f));
-					}
-					continue;
-				}
-				geometry->AddTangent(t);
-				geometry->AddBitangent(b);
-			}
-		} 
-		
-		uint32 tcCount = 0;
+		if (vl.hasTangent = vl.hasBitangents = cm.tangents.size() > 0) {
+			geometry->AddTangents(cm.tangents.data(), n);
+			geometry->AddBitangents(cm.bitangents.data(), n);
+		}
 
 		MaterialDesc md;
 		md.material = scene->mMaterials[mesh->mMaterialIndex];
 		md.sg = nullptr;
+		md.tcMap = cm.tcMap;
 
-		for (uint32 k = 0; k < AI_MAX_NUMBER_OF_TEXTURECOORDS; k++) {
-			if (mesh->HasTextureCoords(k)) {
-				if (tcCount < StdGeometry::MAX_TEXCOORD_SETS) { // Within max number of coord-sets?
-					switch ((_postProcessFlags & EXTRAFLAG_force2CompTexcoords) ? 2 : mesh->mNumUVComponents[k])
-					{
-					case 1:
-						for (uint32 j = 0; j < mesh->mNumVertices; j++)
-							geometry->AddTexCoord((const float32&)mesh->mTextureCoords[k][j], tcCount);
-						vl.hasTexCoords[tcCount] = 1;
-						break;
-					case 2: 
-						for (uint32 j = 0; j < mesh->mNumVertices; j++)
-							geometry->AddTexCoord((const XMFLOAT2&)mesh->mTextureCoords[k][j], tcCount);
-						vl.hasTexCoords[tcCount] = 2;
-						break;
-					case 3:
-						for (uint32 j = 0; j < mesh->mNumVertices; j++)
-							geometry->AddTexCoord((const XMFLOAT3&)mesh->mTextureCoords[k][j], tcCount);
-						vl.hasTexCoords[tcCount] = 3;
-						break;
-					case 4: // Not supported by assimp!
-					default: break; // Invalid!
-					}
-					md.tcMap[k] = tcCount++; // Mapping from assimp-coordset to us.
-					continue;
-				}
-				msg(WARN, strUtils::format(MTEXT("Skipping texture set %i for Geometry because of too many texture sets."), k), geometry);
+		for (uint32 k = 0; k < ConvertedMesh::MAX_TEXCOORD_SETS; k++) {
+			if (cm.texCoordComponents[k]) {
+				geometry->AddTexCoords(cm.texCoords[k].data(), n, cm.texCoordComponents[k], k);
+				vl.hasTexCoords[k] = cm.texCoordComponents[k];
 			}
-			md.tcMap[k] = -1; // Set k does not map!
 		}
+		for (uint32 k : cm.skippedTexCoordSets)
+			msg(WARN, strUtils::format(MTEXT("Skipping texture set %i for Geometry because of too many texture sets."), k), geometry);
 
 		// Process bones, if any.
 		if (mesh->HasBones()) {
-			List<std::pair<XMUSHORT4, XMFLOAT4>> blends; // BlendIndices (bonenr), BlendWeights for each vertex (weights should add up to 1.0)
-			blends.resize(mesh->mNumVertices, std::make_pair(XMUSHORT4(0.0f, 0.0f, 0.0f, 0.0f), XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f)));
-			
+			// Create the mapping from the boneNode to the boneIndex and jointMatrix (offsetMatrix). 
+			// NOTE: what if different bones refering the same node have different mOffsetMatrix (inverse bind-pose)?!? Weakness in assimplib?!
+			// boneNode may already exist, leaving our mOffsetMatrix unused and possible different from the existing one. Dunno if this is a real world problem, though....
+			List<uint16> boneIndices(mesh->mNumBones);
 			for (uint32 j = 0; j < mesh->mNumBones; j++) { // Iterate bones
 				aiBone *bone = mesh->mBones[j];
-
 				aiNode *boneNode = scene->mRootNode->FindNode(bone->mName); // Find the node representing this bone.
-
-				// Create the mapping from the boneNode to the boneIndex and jointMatrix (offsetMatrix). 
-				// NOTE: what if different bones refering the same node have different mOffsetMatrix (inverse bind-pose)?!? Weakness in assimplib?!
-				// boneNode may already exist, leaving our mOffsetMatrix unused and possible different from the existing one. Dunno if this is a real world problem, though....
-				uint16 boneIndex = bones.insert(std::make_pair(boneNode, std::make_pair((uint16)bones.size(), toXMMatrix(bone->mOffsetMatrix)))).first->second.first;
-
-				for (uint32 k = 0; k < bone->mNumWeights; k++) { // Iterate weights for each bone. These should be limited to 4 by using the aiProcess_LimitBoneWeights-flag (set at init)!
-					const aiVertexWeight &w = bone->mWeights[k];
-					std::pair<XMUSHORT4, XMFLOAT4> &vertex = blends[w.mVertexId];
-					for (uint32 p = 0; p < 4; p++) {
-						if (((const float32*)&vertex.second.x)[p] == 0.0f) {
-							((uint16*)&vertex.first.x)[p] = boneIndex;
-							((float32*)&vertex.second.x)[p] = w.mWeight;
-							break;
-						} 
-					}
-				}
+				boneIndices[j] = bones.insert(std::make_pair(boneNode, std::make_pair((uint16)bones.size(), toXMMatrix(bone->mOffsetMatrix)))).first->second.first;
 			}
 
 			vl.hasBlendWeigtsAndIndices = true;
 
-			// Add blend indices and weights to geometry.
-			for (size_t j = 0; j < blends.size(); j++) {
-				geometry->AddBlendIndices(blends[j].first);
-				geometry->AddBlendWeights(XMUBYTEN4(&blends[j].second.x));
-			}
+			// Add blend indices and weights to geometry. The converted indices refer to the bones of the mesh.
+			List<XMUSHORT4> blendIndices(cm.blendIndices);
+			for (XMUSHORT4 &b : blendIndices)
+				for (uint32 p = 0; p < 4; p++)
+					(&b.x)[p] = (&b.x)[p] == ConvertedMesh::UNUSED_BONE ? 0 : boneIndices[(&b.x)[p]];
+			geometry->AddBlendIndices(blendIndices.data(), n);
+			geometry->AddBlendWeights(cm.blendWeights.data(), n);
 
 			// Create the skeleton, if it does not exist.
 			if (!_skeletonInit) {
@@ -864,13 +907,8 @@ Renderable *OpenAssetImpLib::_processMeshList(const MeshList &meshes, BoneMap &b
 			md.sg = &_sg;
 		}
 
-		if (mesh->HasFaces()) { // Add the indices! Should ALWAYS be present!
-			for (uint32 j = 0; j < mesh->mNumFaces; j++) {
-				const aiFace &face = mesh->mFaces[j];
-				for (uint32 k = 0; k < face.mNumIndices; k++)
-					geometry->AddIndex(baseIndex + face.mIndices[k]);
-			}
-		}
+		// Add the indices! Should ALWAYS be present!
+		geometry->AddIndices(cm.indices.data(), (uint32)cm.indices.size(), baseIndex);
 
 		String subsetName = mesh->mName.C_Str();
 
@@ -888,7 +926,7 @@ Renderable *OpenAssetImpLib::_processMeshList(const MeshList &meshes, BoneMap &b
 			break;
 		}
 
-		baseIndex += mesh->mNumVertices;
+		baseIndex += n;
 
 		md.vertexLayout =vl;
 
@@ -898,6 +936,9 @@ Renderable *OpenAssetImpLib::_processMeshList(const MeshList &meshes, BoneMap &b
 		renderable->SetChild(material, 2, (uint32)i);
 	}
 
+	if (_optimizeMeshes)
+		_geometriesToOptimize.push_back(geometry); // Optimized in parallel when all geometries are created.
+
 	renderable->UpdateToGeometry();
 	renderable->CalculateBoundingBox();
 
@@ -914,7 +955,7 @@ void OpenAssetImpLib::_processNode(MeshMap &meshes, BoneMap &bones, Set<aiNode*>
 				auto n = meshes.find(mesh);
 				if (n == meshes.end()) {
 					MeshList meshList;
-					meshList.push_back(mesh);
+					meshList.push_back(p.node->mMeshes[i]);
 					Renderable *renderable = _processMeshList(meshList, bones, scene);
 					n = meshes.insert(std::make_pair(mesh, renderable)).first; // Add the mesh to a map, so we can resue it by other nodes!
 				}
@@ -930,11 +971,11 @@ void OpenAssetImpLib::_processNode(MeshMap &meshes, BoneMap &bones, Set<aiNode*>
 				for (uint32 p = 0; p < mesh->GetNumUVChannels(); p++) 
 					inputLayout += ((_postProcessFlags & EXTRAFLAG_force2CompTexcoords) ? 2 : mesh->mNumUVComponents[p]) << (5 + p * 2);
 				//inputLayout += mesh->GetNumUVChips() << 5; // bit5-7
-				inputLayout += mesh->HasTangentsAndBitangents() ? 0x200000 : 0; // bit21
+				inputLayout += _convertedMeshes[p.node->mMeshes[i]].tangents.size() ? 0x200000 : 0; // bit21 (Tangents may be generated by us.)
 				inputLayout += mesh->HasBones() ? 0x400000 : 0; // bit22
 				// Note: We can't combine meshes of different primitive types.
 				inputLayout += mesh->mPrimitiveTypes << 23; // bit 23-26
-				groupedByInputLayout.insert(std::make_pair(inputLayout, MeshList())).first->second.push_back(mesh);
+				groupedByInputLayout.insert(std::make_pair(inputLayout, MeshList())).first->second.push_back(p.node->mMeshes[i]);
 			}
 			if (mesh->HasBones()) // Mesh has bones? 
 				riggedNodes.insert(p.node); // Mark current node as "rigged" to help us find root node in bone hierarchy.
@@ -1275,6 +1316,11 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 	logger.get()->attachStream(new LogStream(WARN), Assimp::Logger::Warn);
 	logger.get()->attachStream(new LogStream(FATAL), Assimp::Logger::Err);
 
+	HighPrecisionTimer timer;
+	timer.Tick();
+	_importStats = ImportStats();
+	auto lap = [&timer]() { timer.Tick(); return timer.GetDt_us() / 1000000.0; };
+
 	// Create an instance of the Importer class
 	Assimp::Importer importer;
 
@@ -1284,6 +1330,13 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 
 	flags &= ~EXTRAFLAG_mask;
 
+	// Tangents are generated by us when converting the meshes, in parallel. Existing tangents are kept, like assimp does.
+	MeshConversionOptions conversionOptions;
+	conversionOptions.force2CompTexcoords = (_postProcessFlags & EXTRAFLAG_force2CompTexcoords) != 0;
+	conversionOptions.generateTangents = (flags & aiProcess_CalcTangentSpace) != 0;
+	conversionOptions.flipV = (flags & aiProcess_FlipUVs) != 0;
+	flags &= ~aiProcess_CalcTangentSpace;
+
 	// TODO: if OptimizeGraph we should multiply the only transform with all verticies and normals!
 	// DONE: If PretransformVerticies, we should combine all nodes into one!
 
@@ -1310,7 +1363,8 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 	aiComponent_MATERIALS
 */
 
-	const aiScene* scene = importer.ReadFile( _filename.AsString().c_str(), flags);
+	const aiScene* scene = _readFileCached(ImportCache::GetInstance(), importer, _filename, flags, removeComps, _useImportCache, &_importStats.fromCache);
+	_importStats.readTime = lap();
 	
 	// If the import failed, report it
 	if( !scene) {
@@ -1318,6 +1372,10 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 		return nullptr;
 	}
 
+	// Convert the meshes. This is the heavy part of processing the scene, and independent for each mesh.
+	meshconversion::ConvertScene(scene, _convertedMeshes, conversionOptions);
+	_importStats.convertTime = lap();
+
 	// Create the class
 	Document *doc = engine->GetDocumentManager()->CreateDocument();
 	if (!doc) {
@@ -1332,6 +1390,35 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 
 	// Process the scene!
 	Chip *rootChip = _processScene(scene);
+	_convertedMeshes.clear();
+	_importStats.buildTime = lap();
+
+	if (_geometriesToOptimize.size()) {
+		List<MeshOptimizationStats> stats(_geometriesToOptimize.size());
+		List<uint8> optimized(_geometriesToOptimize.size(), 0);
+		ThreadPool::GetShared().ParallelFor((uint32)_geometriesToOptimize.size(), [&](uint32 i) {
+			optimized[i] = _geometriesToOptimize[i]->Optimize(MeshOptimizationOptions(), &stats[i]) ? 1 : 0;
+		});
+		for (size_t i = 0; i < stats.size(); i++)
+			if (optimized[i])
+				_meshStats.push_back(stats[i]);
+		_geometriesToOptimize.clear();
+	}
+	_importStats.optimizeTime = lap();
+
+	if (_meshStats.size()) {
+		float64 acmr[2] = { 0.0, 0.0 }, atvr[2] = { 0.0, 0.0 }, triangles = 0.0;
+		for (const MeshOptimizationStats &m : _meshStats) {
+			acmr[0] += m.before.acmr * m.triangleCount;
+			acmr[1] += m.after.acmr * m.triangleCount;
+			atvr[0] += m.before.atvr * m.triangleCount;
+			atvr[1] += m.after.atvr * m.triangleCount;
+			triangles += m.triangleCount;
+		}
+		if (triangles > 0.0)
+			msg(NOTICE, strUtils::ConstructString(MTEXT("Optimized %1 geometries. ACMR: %2 -> %3. ATVR: %4 -> %5.")).arg((uint32)_meshStats.size()).arg(acmr[0] / triangles, MTEXT("%.3f")).arg(acmr[1] / triangles, MTEXT("%.3f")).arg(atvr[0] / triangles, MTEXT("%.3f")).arg(atvr[1] / triangles, MTEXT("%.3f")));
+		_meshStats.clear();
+	}
 
 	// Now, process *skeletal* animations if any!
 	if (scene->HasAnimations()) {
@@ -1443,6 +1530,8 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 		}
 	}
 	
+	_importStats.animationTime = lap();
+
 	if (mainChip)
 		*mainChip = rootChip;
 
@@ -1470,6 +1559,11 @@ Class *OpenAssetImpLib::Import(Chip **mainChip)
 		msg(INFO, MTEXT("------------------------"));
 	}
 
+	_importStats.totalTime = _importStats.readTime + _importStats.convertTime + _importStats.buildTime + _importStats.optimizeTime + _importStats.animationTime;
+	msg(NOTICE, strUtils::ConstructString(MTEXT("Import times (s): Read: %1%2. Convert meshes: %3. Build: %4. Optimize: %5. Animations: %6. Total: %7."))
+		.arg(_importStats.readTime, MTEXT("%.3f")).arg(_importStats.fromCache ? MTEXT(" (cached)") : MTEXT("")).arg(_importStats.convertTime, MTEXT("%.3f")).arg(_importStats.buildTime, MTEXT("%.3f"))
+		.arg(_importStats.optimizeTime, MTEXT("%.3f")).arg(_importStats.animationTime, MTEXT("%.3f")).arg(_importStats.totalTime, MTEXT("%.3f")));
+
 	msg(INFO, MTEXT("Import SUCCEEDED!"));
 
 	return _importedCG;
@@ -29,6 +29,8 @@
 #include "GraphicsChips/Texture.h"
 #include "GraphicsChips/Skeleton.h"
 #include "GraphicsChips/GraphicsDefines.h"
+#include "GraphicsChips/MeshOptimization.h"
+#include "MeshConversion.h"
 #include "M3DEngine/Class.h"
 #include "M3DEngine/Engine.h"
 
@@ -84,6 +86,30 @@ public:
 	virtual void SetPostProcessFlags(uint32 flags) { _postProcessFlags = flags; }
 	virtual uint32 GetRemoveCompsFlag() const { return _removeComps; }
 	virtual void SetRemoveCompsFlag(uint32 flags) { _removeComps = flags; }
+	// Generate mips and block compress the imported textures. Off by default. See Texture::ProcessImageData(...).
+	virtual bool GetCompressTextures() const { return _compressTextures; }
+	virtual void SetCompressTextures(bool b) { _compressTextures = b; }
+	// Run StdGeometry::Optimize(...) on the imported geometries.
+	virtual bool GetOptimizeMeshes() const { return _optimizeMeshes; }
+	virtual void SetOptimizeMeshes(bool b) { _optimizeMeshes = b; }
+	// Load the post processed scene from the ImportCache if the file and settings are unchanged since last import.
+	virtual bool GetUseImportCache() const { return _useImportCache; }
+	virtual void SetUseImportCache(bool b) { _useImportCache = b; }
+
+	// Time spent in each stage of an import, in seconds.
+	struct ImportStats
+	{
+		float64 readTime = 0.0; // Reading and post processing by assimp, or loading from the cache.
+		float64 convertTime = 0.0; // Converting meshes and generating tangents.
+		float64 buildTime = 0.0; // Creating the chips, including loading and processing textures.
+		float64 optimizeTime = 0.0; // Optimizing geometries.
+		float64 animationTime = 0.0; // Converting animations.
+		float64 totalTime = 0.0;
+		bool fromCache = false;
+	};
+
+	// Stats of the last import.
+	virtual const ImportStats &GetImportStats() const { return _importStats; }
 
 protected:
 	struct TexDesc
@@ -95,7 +121,8 @@ protected:
 		float32 blend;
 		aiTextureOp op;
 		aiTextureMapMode mapMode[2];
-		TexDesc() : mapping(aiTextureMapping_UV), uvindex(0), blend(0.0f), op(aiTextureOp_Multiply) { mapMode[0] = mapMode[1] = aiTextureMapMode_Wrap; }
+		aiTextureType type;
+		TexDesc() : mapping(aiTextureMapping_UV), uvindex(0), blend(0.0f), op(aiTextureOp_Multiply), type(aiTextureType_UNKNOWN) { mapMode[0] = mapMode[1] = aiTextureMapMode_Wrap; }
 	};
 
 	struct ProcessedNode
@@ -227,7 +254,7 @@ protected:
 	typedef Map<M3D_SAMPLER_DESC, Sampler*> SamplerMap;
 	SamplerMap _samplers;
 
-	typedef List<aiMesh*> MeshList;
+	typedef List<uint32> MeshList; // Indices into aiScene::mMeshes.
 	typedef Map<aiMesh*, Renderable*> MeshMap;
 	typedef Map<aiNode*, std::pair<uint16, XMFLOAT4X4>> BoneMap;
 	typedef uint32 InputLayout;
@@ -252,6 +279,19 @@ protected:
 	uint32 _removeComps;
 	//
 	bool _useShortcuts;
+	// Generate mips and compress textures when importing.
+	bool _compressTextures;
+	// Optimize vertex and index order of imported geometries.
+	bool _optimizeMeshes;
+	// Results of the mesh optimization, reported after import.
+	List<MeshOptimizationStats> _meshStats;
+	// Geometries to optimize when the scene is processed.
+	List<StdGeometry*> _geometriesToOptimize;
+	// Use the ImportCache.
+	bool _useImportCache;
+	// Meshes of the scene being imported, converted in parallel before processing the scene.
+	List<ConvertedMesh> _convertedMeshes;
+	ImportStats _importStats;
 
 	bool _skeletonInit;
 	bool _bonesBufferConnected;
@@ -269,6 +309,7 @@ protected:
 
 	void _readTextures(const aiScene* scene, const aiMaterial *material, aiTextureType type, List<TexDesc> &textures);
 	Chip *_loadTexture(const TexDesc &td, const Array<uint32, AI_MAX_NUMBER_OF_TEXTURECOORDS>& tcMap, M3D_SAMPLER_DESC&sampler, uint32 &cSet);
+	void _processTexture(Texture *tex, const TexDesc &td);
 	Chip *_processMaterial(const MaterialDesc &md, const aiScene* scene);
 	Renderable *_processMeshList(const MeshList &meshes, BoneMap &bones, const aiScene *scene);
 	void _buildSkeleton(Skeleton *skeleton, Skeleton::Joint &joint, aiNode *node, const Map<aiNode*, bool> &nodes, const BoneMap &skeletonNodes);
@@ -23,6 +23,8 @@
 
 #pragma once
 
+// STDIMPORTERS_STATIC is defined by the standalone targets (ImportCacheTest) that build only the portable sources, like ImportCache.cpp.
+#if defined(_WIN32) && !defined(STDIMPORTERS_STATIC)
 #include "targetver.h"
 
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
@@ -30,6 +32,7 @@
 #define NOMINMAX
 #include <windows.h>
 #include <assert.h>
+#endif
 
 
 // TODO: reference additional headers your program requires here
@@ -0,0 +1,68 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "stdafx.h"
+#include "DEMImporter_Dlg.h"
+#include "ChipDialogs/ChipDialogManager.h"
+
+
+using namespace m3d;
+
+
+DIALOGDESC_DEF(DEMImporter_Dlg, DEMIMPORTER_GUID);
+
+
+DEMImporter_Dlg::DEMImporter_Dlg()
+{
+}
+
+DEMImporter_Dlg::~DEMImporter_Dlg()
+{
+}
+
+void DEMImporter_Dlg::Init()
+{
+	_tileSize = AddSpinBox("Tile Size", GetChip()->GetTileSize(), 1, 4096, 32);
+	_tileSize->setToolTip("Number of quads along each edge of a tile. Each tile is a separate geometry with its own bounds, so it can be culled.");
+	_step = AddSpinBox("Step", GetChip()->GetStep(), 1, 64);
+	_step->setToolTip("Only every n'th elevation is imported. 1 imports the full resolution, 2 halves it.");
+	_skirtDepth = AddDoubleSpinBox("Skirt Depth", GetChip()->GetSkirtDepth(), 0.0, 100.0, 0.5);
+	_skirtDepth->setToolTip("Depth of the skirts along the edges of each tile, in sample spacings. Skirts hide cracks between tiles of different detail. 0 disables skirts.");
+	_generateGeometry = AddCheckBox("Generate Geometry", GetChip()->GetGenerateGeometry());
+	_generateGeometry->setToolTip("Create a geometry and renderable for each tile.");
+	_generateTextures = AddCheckBox("Generate Textures", GetChip()->GetGenerateTextures());
+	_generateTextures->setToolTip("Create heightmap and normal map textures for the whole terrain. These are kept in memory while importing, so disable them for very large files.");
+	_threadCount = AddSpinBox("Threads", GetChip()->GetThreadCount(), 0, 256);
+	_threadCount->setToolTip("Number of threads building tiles. 0 uses all hardware threads.");
+}
+
+void DEMImporter_Dlg::OnOK()
+{
+	GetChip()->SetTileSize(_tileSize->value());
+	GetChip()->SetStep(_step->value());
+	GetChip()->SetSkirtDepth((float32)_skirtDepth->value());
+	GetChip()->SetGenerateGeometry(_generateGeometry->isChecked());
+	GetChip()->SetGenerateTextures(_generateTextures->isChecked());
+	GetChip()->SetThreadCount(_threadCount->value());
+}
@@ -110,6 +110,12 @@ void OpenAssetImpLib_Dlg::Init()
 	_removeAnimations->setToolTip("Remove animations.");
 	_removeMaterials = AddCheckBox("Remove Materials", removeComps & aiComponent_MATERIALS);
 	_removeMaterials->setToolTip("Remove material definitions.");
+	_compressTextures = AddCheckBox("Compress Textures", GetChip()->GetCompressTextures());
+	_compressTextures->setToolTip("Generate mip maps and compress the imported textures to BC7. Reduces the memory and load time of the textures, at the cost of some quality and a slower import.");
+	_optimizeGeometry = AddCheckBox("Optimize Geometry", GetChip()->GetOptimizeMeshes());
+	_optimizeGeometry->setToolTip("Reorder triangles and vertices for vertex cache, overdraw and vertex fetch efficiency, and use 16-bit indices when possible. ACMR/ATVR is reported when done.");
+	_useImportCache = AddCheckBox("Use Import Cache", GetChip()->GetUseImportCache());
+	_useImportCache->setToolTip("Reuse the result of reading and post processing the file from the last import, if the file, the files it references and the settings are unchanged. The cache is stored in the temp directory.");
 }
 
 void OpenAssetImpLib_Dlg::OnOK()
@@ -146,6 +152,9 @@ void OpenAssetImpLib_Dlg::OnOK()
 	removeComps |= _removeMaterials->isChecked() ? aiComponent_MATERIALS : 0;
 	GetChip()->SetPostProcessFlags(flags);
 	GetChip()->SetRemoveCompsFlag(removeComps);
+	GetChip()->SetCompressTextures(_compressTextures->isChecked());
+	GetChip()->SetOptimizeMeshes(_optimizeGeometry->isChecked());
+	GetChip()->SetUseImportCache(_useImportCache->isChecked());
 }
 
 void OpenAssetImpLib_Dlg::CheckBoxUpdated(QCheckBox *widget, bool value)
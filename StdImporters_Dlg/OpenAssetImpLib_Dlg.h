@@ -79,6 +79,10 @@ protected:
 	QCheckBox *_removeAnimations;
 	QCheckBox *_removeMaterials;
 
+	QCheckBox *_compressTextures;
+	QCheckBox *_optimizeGeometry;
+	QCheckBox *_useImportCache;
+
 //	
 //	aiComponent_MESHES
 
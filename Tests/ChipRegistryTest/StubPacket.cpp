@@ -0,0 +1,49 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// A stub chip packet for ChipRegistryTest. Exports the functions the ChipManager uses to probe a packet, and two of the
+// three factory functions declared, so that probing finds two chips.
+
+#include "M3DEngine/ChipDef.h"
+
+using namespace m3d;
+
+#ifdef _WIN32
+#define STUB_EXPORT extern "C" __declspec(dllexport)
+#else
+#define STUB_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+
+static const ChipDesc STUB_CHIPS[3] = {
+	{ MTEXT("Stub Base"), { 0x11111111, 0x1111, 0x1111, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11 } }, { 0x11111111, 0x1111, 0x1111, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11 } }, ChipDesc::HIDDEN, Version(1, 2, 3, 4), MTEXT("StubBase_FACTORY"), MTEXT("") },
+	{ MTEXT("Stub Importer"), { 0x2A3B4C5D, 0x6E7F, 0x8091, { 0xA2, 0xB3, 0xC4, 0xD5, 0xE6, 0xF7, 0x08, 0x19 } }, { 0x11111111, 0x1111, 0x1111, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11 } }, ChipDesc::STANDARD, VERSION1, MTEXT("StubImporter_FACTORY"), MTEXT("obj;3ds") },
+	{ MTEXT("Stub Broken"), { 0x33333333, 0x3333, 0x3333, { 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33, 0x33 } }, { 0x11111111, 0x1111, 0x1111, { 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11 } }, ChipDesc::STANDARD, VERSION1, MTEXT("StubBroken_FACTORY"), MTEXT("") },
+};
+
+STUB_EXPORT const Char *GetPacketName() { return MTEXT("StubPacket"); }
+STUB_EXPORT uint32 GetChipCount() { return 3; }
+STUB_EXPORT const ChipDesc &GetChipDesc(uint32 index) { return STUB_CHIPS[index]; }
+STUB_EXPORT uint32 GetSupportedPlatforms() { return PLATFORM_all_platforms; }
+STUB_EXPORT void *StubBase_FACTORY() { return nullptr; }
+STUB_EXPORT void *StubImporter_FACTORY() { return nullptr; }
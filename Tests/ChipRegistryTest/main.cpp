@@ -0,0 +1,193 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "M3DEngine/ChipRegistryCache.h"
+#include "M3DEngine/PacketModuleLoader.h"
+#include "TestUtil.h"
+#include <cstdio>
+#include <string>
+#include <fstream>
+#include <chrono>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+// Stamps and probes a packet like the ChipManager does for packets not found in the cache.
+bool Probe(PacketModuleLoader &loader, const std::filesystem::path &file, PacketDesc &pd)
+{
+	pd = PacketDesc();
+	return loader.GetFileStamp(file, pd.fileSize, pd.fileTime) && ProbePacket(loader, file, pd);
+}
+
+bool Equal(const PacketDesc &a, const PacketDesc &b)
+{
+	if (a.filename != b.filename || a.fileSize != b.fileSize || a.fileTime != b.fileTime || a.name != b.name || a.supportedPlatforms != b.supportedPlatforms || a.chipCount != b.chipCount || a.chips.size() != b.chips.size())
+		return false;
+	for (size_t i = 0; i < a.chips.size(); i++) {
+		const PacketDesc::Chip &x = a.chips[i], &y = b.chips[i];
+		if (x.name != y.name || x.type != y.type || x.basetype != y.basetype || x.usage != y.usage || x.version != y.version || x.factoryFunc != y.factoryFunc || x.filters != y.filters)
+			return false;
+	}
+	return true;
+}
+
+// A new temp directory with two copies of the stub packet, a module that is not a packet and a file that is not a module.
+struct PacketDir : public TempDir
+{
+	std::filesystem::path packetA;
+	std::filesystem::path packetB;
+	std::filesystem::path broken;
+	PacketDir(const std::filesystem::path &stub) : TempDir("ChipRegistryTest")
+	{
+		packetA = path / (std::string("PacketA") + stub.extension().string());
+		packetB = path / (std::string("PacketB") + stub.extension().string());
+		broken = path / (std::string("Broken") + stub.extension().string());
+		std::filesystem::copy_file(stub, packetA);
+		std::filesystem::copy_file(stub, packetB);
+		std::ofstream(broken) << "not a module";
+		std::ofstream(path / "readme.txt") << "not a packet";
+	}
+};
+
+}
+
+
+void TestLoader(const std::filesystem::path &stub)
+{
+	printf("Loader\n");
+	PacketDir dir(stub);
+	PacketModuleLoader &loader = PacketModuleLoader::GetDefault();
+
+	List<std::filesystem::path> packets = loader.FindPackets(dir.path);
+	Check(packets.size() == 3 && packets[0] == dir.broken && packets[1] == dir.packetA && packets[2] == dir.packetB, "FindPackets finds modules only, sorted by name");
+	Check(loader.FindPackets(dir.path / "missing").empty(), "FindPackets on missing folder");
+
+	uint64 size = 0;
+	int64 time = 0;
+	Check(loader.GetFileStamp(dir.packetA, size, time) && size == std::filesystem::file_size(stub) && time != 0, "GetFileStamp");
+	Check(!loader.GetFileStamp(dir.path / "missing.so", size, time), "GetFileStamp on missing file");
+
+	Check(loader.Load(dir.broken) == nullptr && !loader.GetLastError().empty(), "Load fails for a file that is not a module, with a reason");
+
+	PacketDesc pd;
+	Check(Probe(loader, dir.packetA, pd), "probe the stub");
+	Check(pd.name == MTEXT("StubPacket") && pd.supportedPlatforms == PLATFORM_all_platforms && pd.chipCount == 3, "packet name, platforms and chip count");
+	Check(pd.chips.size() == 2, "chip with missing factory function is skipped");
+	Check(pd.chips.size() == 2 && pd.chips[1].name == MTEXT("Stub Importer") && pd.chips[1].filters == MTEXT("obj;3ds") && pd.chips[0].version == Version(1, 2, 3, 4) && pd.chips[0].usage == ChipDesc::HIDDEN, "chip descriptions");
+}
+
+void TestCache(const std::filesystem::path &stub)
+{
+	printf("Cache\n");
+	PacketDir dir(stub);
+	PacketModuleLoader &loader = PacketModuleLoader::GetDefault();
+	std::filesystem::path file = dir.path / "ChipRegistry.cache";
+
+	PacketDesc a, b, notAPacket;
+	Probe(loader, dir.packetA, a);
+	Probe(loader, dir.packetB, b);
+	notAPacket.filename = dir.path / "NotAPacket.so"; // Probed, but no chips: name is empty.
+	notAPacket.fileSize = 10;
+	notAPacket.fileTime = -5;
+
+	ChipRegistryCache cache;
+	Check(!cache.Load(file) && cache.GetPacketCount() == 0, "missing file");
+	cache.Add(a);
+	cache.Add(b);
+	cache.Add(notAPacket);
+	Check(cache.Save(file), "Save");
+
+	ChipRegistryCache loaded;
+	Check(loaded.Load(file) && loaded.GetPacketCount() == 3, "Load");
+	const PacketDesc *fa = loaded.Find(a.filename, a.fileSize, a.fileTime);
+	Check(fa && Equal(*fa, a), "round trip of a packet");
+	const PacketDesc *fn = loaded.Find(notAPacket.filename, notAPacket.fileSize, notAPacket.fileTime);
+	Check(fn && Equal(*fn, notAPacket), "round trip of a module without chips");
+	Check(loaded.Find(dir.path / "missing.so", a.fileSize, a.fileTime) == nullptr, "unknown packet");
+
+	// Changing a packet must invalidate its entry, and only that.
+	uint64 size;
+	int64 time;
+	std::ofstream(dir.packetA, std::ios::binary | std::ios::app) << "grow";
+	loader.GetFileStamp(dir.packetA, size, time);
+	Check(size == a.fileSize + 4 && loaded.Find(a.filename, size, time) == nullptr, "changed size invalidates");
+	std::filesystem::last_write_time(dir.packetB, std::filesystem::last_write_time(dir.packetB) + std::chrono::seconds(10));
+	loader.GetFileStamp(dir.packetB, size, time);
+	Check(size == b.fileSize && time != b.fileTime && loaded.Find(b.filename, size, time) == nullptr, "changed time invalidates");
+	Check(loaded.Find(notAPacket.filename, notAPacket.fileSize, notAPacket.fileTime) != nullptr, "other entries are kept");
+
+	// Probing again gives entries that match the new stamps.
+	PacketDesc a2;
+	Probe(loader, dir.packetA, a2);
+	loaded.Add(a2);
+	Check(loaded.Save(file) && cache.Load(file) && cache.Find(a2.filename, a2.fileSize, a2.fileTime) != nullptr && cache.GetPacketCount() == 3, "reprobed packet replaces its entry");
+}
+
+void TestCorrupt(const std::filesystem::path &stub)
+{
+	printf("Corrupt\n");
+	PacketDir dir(stub);
+	std::filesystem::path file = dir.path / "ChipRegistry.cache";
+	PacketDesc a;
+	Probe(PacketModuleLoader::GetDefault(), dir.packetA, a);
+
+	ChipRegistryCache cache;
+	cache.Add(a);
+	PacketDesc tab = a;
+	tab.filename = dir.path / "Tab\tName.so";
+	cache.Add(tab);
+	cache.Save(file);
+	Check(cache.Load(file) && cache.GetPacketCount() == 1, "packets with tabs in fields are not stored");
+
+	std::ifstream f(file, std::ios::binary);
+	std::string data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	f.close();
+
+	std::ofstream(file, std::ios::binary | std::ios::trunc) << data.substr(0, data.size() - 10);
+	Check(!cache.Load(file) && cache.GetPacketCount() == 0, "truncated file");
+	std::ofstream(file, std::ios::binary | std::ios::trunc) << "SnaXChipRegistry\t999\n";
+	Check(!cache.Load(file), "other format version");
+	std::ofstream(file, std::ios::binary | std::ios::trunc) << data.substr(0, data.find('\n') + 1) << "packet\tx\n";
+	Check(!cache.Load(file) && cache.GetPacketCount() == 0, "bad packet record");
+	std::ofstream(file, std::ios::binary | std::ios::trunc) << data;
+	Check(cache.Load(file) && cache.GetPacketCount() == 1, "restored file");
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		printf("Usage: ChipRegistryTest <stub packet module>\n");
+		return 1;
+	}
+	std::filesystem::path stub = std::filesystem::absolute(argv[1]);
+
+	TestLoader(stub);
+	TestCache(stub);
+	TestCorrupt(stub);
+
+	return Report();
+}
@@ -0,0 +1,778 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "GraphicsChips/ImageDecoder.h"
+#include "TestUtil.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <random>
+#include <string>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+typedef List<uint8> Bytes;
+
+void Put16LE(Bytes &b, uint32 v) { b.push_back(uint8(v)); b.push_back(uint8(v >> 8)); }
+void Put32LE(Bytes &b, uint32 v) { Put16LE(b, v & 0xFFFF); Put16LE(b, v >> 16); }
+void Put32BE(Bytes &b, uint32 v) { b.push_back(uint8(v >> 24)); b.push_back(uint8(v >> 16)); b.push_back(uint8(v >> 8)); b.push_back(uint8(v)); }
+
+// A w x h RGBA image with some variation in all channels.
+Bytes MakePattern(uint32 w, uint32 h, bool alpha = true)
+{
+	Bytes p(size_t(w) * h * 4);
+	for (uint32 y = 0; y < h; y++) {
+		for (uint32 x = 0; x < w; x++) {
+			uint8 *d = &p[(size_t(y) * w + x) * 4];
+			d[0] = uint8(x * 37 + y * 11);
+			d[1] = uint8(x * 5 + y * 71 + 3);
+			d[2] = uint8((x ^ y) * 29 + 101);
+			d[3] = alpha ? uint8(255 - x * 13 - y * 7) : 255;
+		}
+	}
+	return p;
+}
+
+bool IsRGBA8(const DecodedImage &img, uint32 w, uint32 h)
+{
+	return img.format == M3D_FORMAT_R8G8B8A8_UNORM && img.width == w && img.height == h && img.mipLevels == 1 && img.arraySize == 1 && img.subresources.size() == 1 && img.data.size() == size_t(w) * h * 4;
+}
+
+bool SamePixels(const DecodedImage &img, const Bytes &expected)
+{
+	return img.data.size() == expected.size() && std::memcmp(img.data.data(), expected.data(), expected.size()) == 0;
+}
+
+// Decoders must reject (not crash on) damaged files. Run under a sanitizer to catch out of bounds reads.
+void CheckDamaged(const Bytes &file, bool (*decode)(const uint8*, size_t, DecodedImage&), const char *what)
+{
+	std::mt19937 rnd(1234);
+	for (size_t n = 0; n < file.size(); n += std::max<size_t>(1, file.size() / 64)) {
+		Bytes truncated(file.begin(), file.begin() + n);
+		DecodedImage img;
+		decode(truncated.data(), truncated.size(), img);
+	}
+	for (uint32 i = 0; i < 500; i++) {
+		Bytes damaged = file;
+		for (uint32 j = 0, k = 1 + rnd() % 4; j < k; j++)
+			damaged[rnd() % damaged.size()] = uint8(rnd());
+		DecodedImage img;
+		decode(damaged.data(), damaged.size(), img);
+	}
+	Check(true, what);
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Inflate
+
+// Generated by zlib (level 9) from the text built by MakeInflateText(). Fixed Huffman codes forced with Z_FIXED.
+const uint8 FIXED_HUFFMAN_STREAM[] = {
+	0x78, 0x01, 0x33, 0xb0, 0x2a, 0xca, 0x2f, 0x57, 0x30, 0x50, 0xc8, 0x4f, 0x53, 0x28, 0xc9, 0x48, 0x55, 0x28, 0x49, 0x2d, 0x2e, 0x51, 0xc8, 0xcc,
+	0x4d, 0x4c, 0x4f, 0xd5, 0x51, 0x30, 0x04, 0x4b, 0x19, 0x62, 0x93, 0x32, 0x02, 0x4b, 0x99, 0x60, 0x93, 0x32, 0x06, 0x4b, 0x59, 0x62, 0x93, 0x32,
+	0x81, 0x18, 0x68, 0x86, 0x4d, 0xce, 0x14, 0x2c, 0x67, 0x64, 0x8a, 0x4d, 0xce, 0x0c, 0x2c, 0x67, 0x8c, 0x55, 0x9f, 0x39, 0xc4, 0x25, 0x58, 0xed,
+	0xb3, 0x00, 0xcb, 0x99, 0x61, 0x75, 0xa6, 0x25, 0x58, 0xce, 0x02, 0xab, 0xef, 0x0c, 0x0d, 0x20, 0x16, 0x62, 0x95, 0x83, 0x84, 0x8a, 0x11, 0x56,
+	0x43, 0x0d, 0xa1, 0xe1, 0x62, 0x8e, 0x55, 0x12, 0x12, 0x32, 0xe6, 0x46, 0x58, 0x25, 0x21, 0x61, 0x83, 0x5d, 0x0e, 0x12, 0x36, 0xc6, 0xd8, 0xdd,
+	0x0a, 0x09, 0x1c, 0x33, 0xec, 0x3a, 0x21, 0xa1, 0x63, 0x89, 0x35, 0x54, 0x0d, 0x21, 0xc1, 0x63, 0x8c, 0xdd, 0x9b, 0x90, 0xf0, 0x31, 0xc7, 0x9a,
+	0x30, 0x8c, 0x20, 0xe1, 0x63, 0x88, 0xd5, 0x4e, 0x23, 0x48, 0x00, 0x99, 0x62, 0x35, 0xd6, 0x08, 0x12, 0x40, 0x96, 0x58, 0xa3, 0xd2, 0x08, 0x12,
+	0x40, 0x26, 0x58, 0x83, 0xd6, 0x08, 0x12, 0x40, 0x96, 0xd8, 0x93, 0x23, 0x24, 0x84, 0x4c, 0xb0, 0xdb, 0x09, 0x09, 0x21, 0x4b, 0xec, 0xc6, 0x42,
+	0x42, 0xc8, 0x14, 0xbb, 0x3f, 0x21, 0x21, 0x64, 0x81, 0x55, 0x0e, 0x12, 0x40, 0x66, 0x58, 0x83, 0xd6, 0x18, 0x12, 0x40, 0x46, 0x58, 0xd3, 0x81,
+	0x31, 0x24, 0x80, 0x2c, 0xb0, 0x1a, 0x6b, 0x0c, 0x09, 0x20, 0x53, 0xec, 0x59, 0x0b, 0x12, 0x40, 0x46, 0x58, 0xc3, 0xdd, 0x18, 0x12, 0x40, 0x16,
+	0x58, 0x73, 0x82, 0x31, 0x24, 0x80, 0xcc, 0xb0, 0x86, 0x9e, 0x31, 0x34, 0x7f, 0x61, 0xf7, 0x0a, 0x24, 0x80, 0x0c, 0xb1, 0xeb, 0x84, 0x06, 0x10,
+	0xd6, 0xe8, 0x34, 0x86, 0x86, 0x10, 0x56, 0x49, 0x00, 0x8b, 0xf0, 0x6a, 0xad,
+};
+
+// Same text with dynamic Huffman codes.
+const uint8 DYNAMIC_HUFFMAN_STREAM[] = {
+	0x78, 0xda, 0x6d, 0xd3, 0x39, 0x0e, 0x02, 0x31, 0x10, 0x05, 0xd1, 0xab, 0xf8, 0x00, 0x04, 0xd3, 0xdd, 0x5e, 0xb9, 0x0d, 0xc1, 0xb0, 0x04, 0x68,
+	0x24, 0x18, 0x89, 0xeb, 0x23, 0xf9, 0x3b, 0xac, 0xb8, 0xe4, 0xed, 0xd9, 0xde, 0xae, 0x9f, 0xe3, 0x97, 0xb6, 0x74, 0xdc, 0xd3, 0xf9, 0xdc, 0xd3,
+	0xb9, 0x7f, 0xcf, 0xf4, 0x7a, 0xdf, 0x1e, 0xfb, 0x25, 0xd9, 0x4c, 0x46, 0xc9, 0x67, 0xca, 0x94, 0x62, 0xa6, 0x41, 0x29, 0x6b, 0xc2, 0x4a, 0xad,
+	0xcc, 0xe6, 0x85, 0x5a, 0x9d, 0x2d, 0x70, 0x5c, 0xd3, 0x4e, 0x70, 0xbd, 0x3e, 0x5b, 0xc5, 0x6d, 0x8e, 0xd9, 0x3a, 0x9e, 0xce, 0x36, 0x2d, 0x88,
+	0x4d, 0x2a, 0x8e, 0x93, 0xda, 0x72, 0x69, 0x18, 0x25, 0xd3, 0x1c, 0xa3, 0x6c, 0xb8, 0xc9, 0x26, 0x78, 0xaf, 0xc2, 0xa9, 0x3c, 0x52, 0x3a, 0x03,
+	0x55, 0x4d, 0x3c, 0xc1, 0xc7, 0x94, 0x4f, 0xc3, 0x87, 0xe1, 0xf2, 0x31, 0x5c, 0xd3, 0x05, 0x54, 0x70, 0x5a, 0x17, 0xd0, 0xc0, 0xab, 0x74, 0x01,
+	0x65, 0xa4, 0x75, 0x01, 0x0d, 0x7e, 0x8e, 0x12, 0xca, 0xbc, 0xa6, 0x84, 0x06, 0x4f, 0x2b, 0xa1, 0xc2, 0xe7, 0x94, 0x50, 0xc7, 0x26, 0xa0, 0x8a,
+	0xb4, 0x21, 0x20, 0xc7, 0x77, 0x10, 0x02, 0xea, 0x38, 0x6d, 0x08, 0xa8, 0xf0, 0xd7, 0x12, 0x90, 0xa3, 0x7b, 0x08, 0xa8, 0xe3, 0x4f, 0x08, 0x01,
+	0x55, 0xd4, 0x8b, 0xf5, 0xbf, 0xf8, 0x28, 0x02, 0x32, 0x1e, 0xb9, 0x80, 0xf0, 0x3a, 0x63, 0x09, 0x61, 0xfc, 0x03, 0x8b, 0xf0, 0x6a, 0xad,
+};
+
+
+std::string MakeInflateText()
+{
+	std::string s;
+	char buff[64];
+	for (uint32 i = 0; i < 40; i++) {
+		snprintf(buff, sizeof(buff), "%u:row %u of the test image, ", i, i * i % 97);
+		s += buff;
+	}
+	return s;
+}
+
+void TestInflate()
+{
+	printf("Inflate\n");
+	std::string text = MakeInflateText();
+	Bytes out(text.size());
+	Check(imagedecoder::Inflate(FIXED_HUFFMAN_STREAM, sizeof(FIXED_HUFFMAN_STREAM), out.data(), out.size()) && std::memcmp(out.data(), text.data(), text.size()) == 0, "fixed Huffman codes");
+	std::fill(out.begin(), out.end(), uint8(0));
+	Check(imagedecoder::Inflate(DYNAMIC_HUFFMAN_STREAM, sizeof(DYNAMIC_HUFFMAN_STREAM), out.data(), out.size()) && std::memcmp(out.data(), text.data(), text.size()) == 0, "dynamic Huffman codes");
+	Bytes small(text.size() - 1);
+	Check(!imagedecoder::Inflate(DYNAMIC_HUFFMAN_STREAM, sizeof(DYNAMIC_HUFFMAN_STREAM), small.data(), small.size()), "output size mismatch is rejected");
+	Check(!imagedecoder::Inflate(DYNAMIC_HUFFMAN_STREAM, sizeof(DYNAMIC_HUFFMAN_STREAM) / 2, out.data(), out.size()), "truncated stream is rejected");
+	Bytes badHeader(DYNAMIC_HUFFMAN_STREAM, DYNAMIC_HUFFMAN_STREAM + sizeof(DYNAMIC_HUFFMAN_STREAM));
+	badHeader[1] ^= 1;
+	Check(!imagedecoder::Inflate(badHeader.data(), badHeader.size(), out.data(), out.size()), "bad header check is rejected");
+	CheckDamaged(Bytes(DYNAMIC_HUFFMAN_STREAM, DYNAMIC_HUFFMAN_STREAM + sizeof(DYNAMIC_HUFFMAN_STREAM)), [](const uint8 *d, size_t s, DecodedImage&) { Bytes o(2048); return imagedecoder::Inflate(d, s, o.data(), o.size()); }, "damaged streams");
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// PNG
+
+// zlib stream using stored (uncompressed) blocks only.
+Bytes ZlibStored(const Bytes &raw)
+{
+	Bytes z = { 0x78, 0x01 };
+	size_t p = 0;
+	do {
+		size_t n = std::min<size_t>(raw.size() - p, 65535);
+		z.push_back(p + n == raw.size() ? 1 : 0);
+		Put16LE(z, uint32(n));
+		Put16LE(z, uint32(n) ^ 0xFFFF);
+		z.insert(z.end(), raw.begin() + p, raw.begin() + p + n);
+		p += n;
+	} while (p < raw.size());
+	uint32 a = 1, b = 0;
+	for (uint8 c : raw) {
+		a = (a + c) % 65521;
+		b = (b + a) % 65521;
+	}
+	Put32BE(z, (b << 16) | a);
+	return z;
+}
+
+void PutChunk(Bytes &png, const char *type, const Bytes &data)
+{
+	Put32BE(png, uint32(data.size()));
+	size_t start = png.size();
+	png.insert(png.end(), type, type + 4);
+	png.insert(png.end(), data.begin(), data.end());
+	uint32 crc = 0xFFFFFFFF;
+	for (size_t i = start; i < png.size(); i++) {
+		crc ^= png[i];
+		for (uint32 k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	Put32BE(png, crc ^ 0xFFFFFFFF);
+}
+
+uint8 Paeth(int32 a, int32 b, int32 c)
+{
+	int32 pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+	return uint8(pa <= pb && pa <= pc ? a : (pb <= pc ? b : c));
+}
+
+struct PNGDesc
+{
+	PNGDesc(uint32 width, uint32 height, uint32 bitDepth, uint32 colorType, Bytes rows = Bytes()) : width(width), height(height), bitDepth(bitDepth), colorType(colorType), rows(rows) {}
+
+	uint32 width, height, bitDepth, colorType;
+	Bytes rows; // Unfiltered scanlines, without filter bytes.
+	Bytes palette; // RGB triplets.
+	Bytes trns;
+	bool interlaced = false;
+	uint32 idatCount = 1;
+};
+
+// Encodes with filter type (y % 5) for row y, so all filters are tested.
+Bytes MakePNG(const PNGDesc &desc)
+{
+	static const uint32 CHANNELS[7] = { 1, 0, 3, 1, 2, 0, 4 };
+	const uint32 bitsPerPixel = CHANNELS[desc.colorType] * desc.bitDepth;
+	const size_t rowBytes = (size_t(desc.width) * bitsPerPixel + 7) / 8;
+	const size_t bpp = std::max(1u, bitsPerPixel / 8);
+
+	Bytes filtered;
+	for (uint32 y = 0; y < desc.height; y++) {
+		const uint8 *cur = &desc.rows[y * rowBytes];
+		const uint8 *prev = y > 0 ? cur - rowBytes : nullptr;
+		uint8 filter = uint8(y % 5);
+		filtered.push_back(filter);
+		for (size_t i = 0; i < rowBytes; i++) {
+			int32 a = i >= bpp ? cur[i - bpp] : 0, b = prev ? prev[i] : 0, c = prev && i >= bpp ? prev[i - bpp] : 0;
+			int32 p = 0;
+			switch (filter)
+			{
+			case 1: p = a; break;
+			case 2: p = b; break;
+			case 3: p = (a + b) >> 1; break;
+			case 4: p = Paeth(a, b, c); break;
+			}
+			filtered.push_back(uint8(cur[i] - p));
+		}
+	}
+
+	Bytes png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	Bytes ihdr;
+	Put32BE(ihdr, desc.width);
+	Put32BE(ihdr, desc.height);
+	ihdr.push_back(uint8(desc.bitDepth));
+	ihdr.push_back(uint8(desc.colorType));
+	ihdr.push_back(0);
+	ihdr.push_back(0);
+	ihdr.push_back(desc.interlaced ? 1 : 0);
+	PutChunk(png, "IHDR", ihdr);
+	if (!desc.palette.empty())
+		PutChunk(png, "PLTE", desc.palette);
+	if (!desc.trns.empty())
+		PutChunk(png, "tRNS", desc.trns);
+	Bytes z = ZlibStored(filtered);
+	for (uint32 i = 0; i < desc.idatCount; i++)
+		PutChunk(png, "IDAT", Bytes(z.begin() + z.size() * i / desc.idatCount, z.begin() + z.size() * (i + 1) / desc.idatCount));
+	PutChunk(png, "IEND", Bytes());
+	return png;
+}
+
+void TestPNG()
+{
+	printf("PNG\n");
+	const uint32 W = 7, H = 6;
+	const Bytes pattern = MakePattern(W, H);
+	DecodedImage img;
+
+	{ // RGBA, 8 bits, image data split over several IDAT chunks.
+		PNGDesc d{ W, H, 8, 6, pattern };
+		d.idatCount = 3;
+		Bytes png = MakePNG(d);
+		Check(imagedecoder::DecodePNG(png.data(), png.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, pattern), "RGBA 8 bit");
+		CheckDamaged(png, imagedecoder::DecodePNG, "damaged files");
+		d.interlaced = true;
+		png = MakePNG(d);
+		Check(!imagedecoder::DecodePNG(png.data(), png.size(), img), "interlaced is rejected");
+	}
+	{ // RGB with a transparent color key.
+		PNGDesc d{ W, H, 8, 2 };
+		Bytes expected = pattern;
+		for (size_t i = 0; i < size_t(W) * H; i++) {
+			d.rows.insert(d.rows.end(), &pattern[i * 4], &pattern[i * 4 + 3]);
+			expected[i * 4 + 3] = 255;
+		}
+		const uint8 *key = &pattern[(2 * W + 3) * 4];
+		d.trns = { 0, key[0], 0, key[1], 0, key[2] };
+		expected[(2 * W + 3) * 4 + 3] = 0;
+		Bytes png = MakePNG(d);
+		Check(imagedecoder::DecodePNG(png.data(), png.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "RGB 8 bit with color key");
+	}
+	{ // Gray, 16 bits. Only the most significant byte is kept.
+		PNGDesc d{ W, H, 16, 0 };
+		Bytes expected(size_t(W) * H * 4);
+		for (size_t i = 0; i < size_t(W) * H; i++) {
+			d.rows.push_back(pattern[i * 4]);
+			d.rows.push_back(pattern[i * 4 + 1]);
+			std::memset(&expected[i * 4], pattern[i * 4], 3);
+			expected[i * 4 + 3] = 255;
+		}
+		d.trns = { d.rows[8], d.rows[9] }; // Pixel 4.
+		expected[4 * 4 + 3] = 0;
+		Bytes png = MakePNG(d);
+		Check(imagedecoder::DecodePNG(png.data(), png.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "gray 16 bit with color key");
+	}
+	{ // Gray + alpha, 8 bits.
+		PNGDesc d{ W, H, 8, 4 };
+		Bytes expected(size_t(W) * H * 4);
+		for (size_t i = 0; i < size_t(W) * H; i++) {
+			d.rows.push_back(pattern[i * 4 + 1]);
+			d.rows.push_back(pattern[i * 4 + 3]);
+			std::memset(&expected[i * 4], pattern[i * 4 + 1], 3);
+			expected[i * 4 + 3] = pattern[i * 4 + 3];
+		}
+		Bytes png = MakePNG(d);
+		Check(imagedecoder::DecodePNG(png.data(), png.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "gray + alpha 8 bit");
+	}
+	{ // Palette, 4 bits, with partial transparency. Odd width, so rows end in the middle of a byte.
+		PNGDesc d{ W, H, 4, 3 };
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 i = 0; i < 16; i++)
+			d.palette.insert(d.palette.end(), { uint8(i * 16), uint8(255 - i * 8), uint8(i * 3) });
+		d.trns = { 0, 64, 128 };
+		const size_t rowBytes = (W * 4 + 7) / 8;
+		d.rows.resize(rowBytes * H);
+		for (uint32 y = 0; y < H; y++) {
+			for (uint32 x = 0; x < W; x++) {
+				uint32 index = (x + y * 3) % 16;
+				d.rows[y * rowBytes + x / 2] |= uint8(index << (x % 2 ? 0 : 4));
+				uint8 *e = &expected[(size_t(y) * W + x) * 4];
+				e[0] = d.palette[index * 3];
+				e[1] = d.palette[index * 3 + 1];
+				e[2] = d.palette[index * 3 + 2];
+				e[3] = index < d.trns.size() ? d.trns[index] : 255;
+			}
+		}
+		Bytes png = MakePNG(d);
+		Check(imagedecoder::DecodePNG(png.data(), png.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "palette 4 bit with transparency");
+	}
+	{ // Gray, 1 bit.
+		PNGDesc d{ 10, 3, 1, 0 };
+		Bytes expected(10 * 3 * 4);
+		d.rows.resize(2 * 3);
+		for (uint32 y = 0; y < 3; y++) {
+			for (uint32 x = 0; x < 10; x++) {
+				bool on = (x + y) % 3 == 0;
+				if (on)
+					d.rows[y * 2 + x / 8] |= uint8(0x80 >> (x % 8));
+				uint8 *e = &expected[(y * 10 + x) * 4];
+				e[0] = e[1] = e[2] = on ? 255 : 0;
+				e[3] = 255;
+			}
+		}
+		Bytes png = MakePNG(d);
+		Check(imagedecoder::DecodePNG(png.data(), png.size(), img) && IsRGBA8(img, 10, 3) && SamePixels(img, expected), "gray 1 bit");
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// TGA
+
+Bytes MakeTGAHeader(uint32 imageType, uint32 w, uint32 h, uint32 pixelDepth, uint32 descriptor, uint32 cmLength = 0, uint32 cmDepth = 0)
+{
+	Bytes t;
+	t.push_back(3); // ID length. The ID must be skipped.
+	t.push_back(cmLength ? 1 : 0);
+	t.push_back(uint8(imageType));
+	Put16LE(t, 0);
+	Put16LE(t, cmLength);
+	t.push_back(uint8(cmDepth));
+	Put16LE(t, 0);
+	Put16LE(t, 0);
+	Put16LE(t, w);
+	Put16LE(t, h);
+	t.push_back(uint8(pixelDepth));
+	t.push_back(uint8(descriptor));
+	t.insert(t.end(), { 'I', 'D', '!' });
+	return t;
+}
+
+void TestTGA()
+{
+	printf("TGA\n");
+	const uint32 W = 5, H = 4;
+	const Bytes pattern = MakePattern(W, H);
+	DecodedImage img;
+
+	{ // 24 bit, bottom-up.
+		Bytes t = MakeTGAHeader(2, W, H, 24, 0);
+		Bytes expected = pattern;
+		for (uint32 y = 0; y < H; y++) {
+			for (uint32 x = 0; x < W; x++) {
+				const uint8 *s = &pattern[(size_t(H - 1 - y) * W + x) * 4];
+				t.insert(t.end(), { s[2], s[1], s[0] });
+			}
+		}
+		for (size_t i = 0; i < size_t(W) * H; i++)
+			expected[i * 4 + 3] = 255;
+		Check(imagedecoder::DecodeTGA(t.data(), t.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "true color 24 bit, bottom-up");
+	}
+	{ // 32 bit with alpha, top-down and right-to-left.
+		Bytes t = MakeTGAHeader(2, W, H, 32, 0x38);
+		for (uint32 y = 0; y < H; y++) {
+			for (uint32 x = 0; x < W; x++) {
+				const uint8 *s = &pattern[(size_t(y) * W + (W - 1 - x)) * 4];
+				t.insert(t.end(), { s[2], s[1], s[0], s[3] });
+			}
+		}
+		Check(imagedecoder::DecodeTGA(t.data(), t.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, pattern), "true color 32 bit, top-down, right-to-left");
+	}
+	{ // RLE 32 bit. Each row is a run of one color followed by a raw packet.
+		Bytes t = MakeTGAHeader(10, W, H, 32, 0x28);
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 y = 0; y < H; y++) {
+			const uint8 *s = &pattern[size_t(y) * W * 4];
+			t.push_back(0x80 | 2); // Run of 3.
+			t.insert(t.end(), { s[2], s[1], s[0], s[3] });
+			for (uint32 x = 0; x < 3; x++)
+				std::memcpy(&expected[(size_t(y) * W + x) * 4], s, 4);
+			t.push_back(W - 4); // Raw packet of 2.
+			for (uint32 x = 3; x < W; x++) {
+				const uint8 *r = &pattern[(size_t(y) * W + x) * 4];
+				t.insert(t.end(), { r[2], r[1], r[0], r[3] });
+				std::memcpy(&expected[(size_t(y) * W + x) * 4], r, 4);
+			}
+		}
+		Check(imagedecoder::DecodeTGA(t.data(), t.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "RLE true color 32 bit");
+		CheckDamaged(t, imagedecoder::DecodeTGA, "damaged files");
+		t.resize(t.size() - 3);
+		Check(!imagedecoder::DecodeTGA(t.data(), t.size(), img), "truncated RLE data is rejected");
+	}
+	{ // Color mapped, 8 bit indices into a 24 bit map.
+		Bytes t = MakeTGAHeader(1, W, H, 8, 0x20, 8, 24);
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 i = 0; i < 8; i++)
+			t.insert(t.end(), { uint8(i * 30), uint8(i * 20), uint8(i * 10) });
+		for (uint32 i = 0; i < W * H; i++) {
+			uint32 index = (i * 5) % 8;
+			t.push_back(uint8(index));
+			expected[i * 4 + 0] = uint8(index * 10);
+			expected[i * 4 + 1] = uint8(index * 20);
+			expected[i * 4 + 2] = uint8(index * 30);
+			expected[i * 4 + 3] = 255;
+		}
+		Check(imagedecoder::DecodeTGA(t.data(), t.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "color mapped 8 bit");
+		t[18 + 3 + 8 * 3] = 8; // Index outside the color map.
+		Check(!imagedecoder::DecodeTGA(t.data(), t.size(), img), "index outside color map is rejected");
+	}
+	{ // 16 bit A1R5G5B5, top-down.
+		Bytes t = MakeTGAHeader(2, W, H, 16, 0x21);
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 i = 0; i < W * H; i++) {
+			uint32 r = i % 32, g = (i * 7) % 32, b = (i * 13) % 32, a = i % 2;
+			Put16LE(t, (a << 15) | (r << 10) | (g << 5) | b);
+			expected[i * 4 + 0] = uint8((r << 3) | (r >> 2));
+			expected[i * 4 + 1] = uint8((g << 3) | (g >> 2));
+			expected[i * 4 + 2] = uint8((b << 3) | (b >> 2));
+			expected[i * 4 + 3] = a ? 255 : 0;
+		}
+		Check(imagedecoder::DecodeTGA(t.data(), t.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "true color 16 bit");
+	}
+	{ // Gray, 8 bit, top-down.
+		Bytes t = MakeTGAHeader(3, W, H, 8, 0x20);
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 i = 0; i < W * H; i++) {
+			t.push_back(pattern[i * 4]);
+			std::memset(&expected[i * 4], pattern[i * 4], 3);
+			expected[i * 4 + 3] = 255;
+		}
+		Check(imagedecoder::DecodeTGA(t.data(), t.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "gray 8 bit");
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// BMP
+
+// File and info header. headerSize is 40 (BITMAPINFOHEADER) or 108 (BITMAPV4HEADER).
+Bytes MakeBMPHeader(int32 w, int32 h, uint32 bpp, uint32 compression, uint32 headerSize, uint32 paletteSize, size_t dataSize, const uint32 *masks = nullptr)
+{
+	Bytes b = { 'B', 'M' };
+	uint32 offBits = 14 + headerSize + paletteSize * 4 + (headerSize == 40 && masks ? 12 : 0);
+	Put32LE(b, uint32(offBits + dataSize));
+	Put32LE(b, 0);
+	Put32LE(b, offBits);
+	Put32LE(b, headerSize);
+	Put32LE(b, uint32(w));
+	Put32LE(b, uint32(h));
+	Put16LE(b, 1);
+	Put16LE(b, bpp);
+	Put32LE(b, compression);
+	Put32LE(b, uint32(dataSize));
+	Put32LE(b, 2835);
+	Put32LE(b, 2835);
+	Put32LE(b, paletteSize);
+	Put32LE(b, 0);
+	if (masks)
+		for (uint32 i = 0; i < (headerSize == 40 ? 3u : 4u); i++)
+			Put32LE(b, masks[i]);
+	b.resize(14 + headerSize + (headerSize == 40 && masks ? 12 : 0));
+	return b;
+}
+
+void TestBMP()
+{
+	printf("BMP\n");
+	const uint32 W = 5, H = 3;
+	const Bytes pattern = MakePattern(W, H);
+	DecodedImage img;
+
+	{ // 24 bit, bottom-up. Rows are padded to 4 bytes.
+		const size_t stride = 16;
+		Bytes b = MakeBMPHeader(W, H, 24, 0, 40, 0, stride * H);
+		Bytes expected = pattern;
+		for (uint32 y = 0; y < H; y++) {
+			Bytes row(stride, 0xCD);
+			for (uint32 x = 0; x < W; x++) {
+				const uint8 *s = &pattern[(size_t(H - 1 - y) * W + x) * 4];
+				row[x * 3] = s[2];
+				row[x * 3 + 1] = s[1];
+				row[x * 3 + 2] = s[0];
+			}
+			b.insert(b.end(), row.begin(), row.end());
+		}
+		for (size_t i = 0; i < size_t(W) * H; i++)
+			expected[i * 4 + 3] = 255;
+		Check(imagedecoder::DecodeBMP(b.data(), b.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "24 bit, bottom-up, padded rows");
+		CheckDamaged(b, imagedecoder::DecodeBMP, "damaged files");
+	}
+	{ // 32 bit bit fields with alpha (V4 header), top-down.
+		const uint32 masks[4] = { 0x0000FF00, 0x00FF0000, 0xFF000000, 0x000000FF };
+		Bytes b = MakeBMPHeader(W, -int32(H), 32, 3, 108, 0, W * H * 4, masks);
+		for (size_t i = 0; i < size_t(W) * H; i++) {
+			const uint8 *s = &pattern[i * 4];
+			b.insert(b.end(), { s[3], s[0], s[1], s[2] });
+		}
+		Check(imagedecoder::DecodeBMP(b.data(), b.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, pattern), "32 bit bit fields with alpha, top-down");
+	}
+	{ // 16 bit, default 5-5-5 layout.
+		const size_t stride = 12;
+		Bytes b = MakeBMPHeader(W, H, 16, 0, 40, 0, stride * H);
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 y = 0; y < H; y++) {
+			Bytes row;
+			for (uint32 x = 0; x < W; x++) {
+				uint32 r = (x * 7) % 32, g = (y * 9 + x) % 32, b5 = (x + y) % 32;
+				Put16LE(row, (r << 10) | (g << 5) | b5);
+				uint8 *e = &expected[(size_t(H - 1 - y) * W + x) * 4];
+				e[0] = uint8((r * 255 + 15) / 31);
+				e[1] = uint8((g * 255 + 15) / 31);
+				e[2] = uint8((b5 * 255 + 15) / 31);
+				e[3] = 255;
+			}
+			row.resize(stride);
+			b.insert(b.end(), row.begin(), row.end());
+		}
+		Check(imagedecoder::DecodeBMP(b.data(), b.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "16 bit 5-5-5");
+	}
+	{ // 8 bit palette.
+		const size_t stride = 8;
+		Bytes b = MakeBMPHeader(W, H, 8, 0, 40, 6, stride * H);
+		Bytes expected(size_t(W) * H * 4);
+		for (uint32 i = 0; i < 6; i++)
+			b.insert(b.end(), { uint8(i * 40), uint8(i * 20), uint8(i * 10), 0 });
+		for (uint32 y = 0; y < H; y++) {
+			Bytes row(stride);
+			for (uint32 x = 0; x < W; x++) {
+				uint32 index = (x + y * 2) % 6;
+				row[x] = uint8(index);
+				uint8 *e = &expected[(size_t(H - 1 - y) * W + x) * 4];
+				e[0] = uint8(index * 10);
+				e[1] = uint8(index * 20);
+				e[2] = uint8(index * 40);
+				e[3] = 255;
+			}
+			b.insert(b.end(), row.begin(), row.end());
+		}
+		Check(imagedecoder::DecodeBMP(b.data(), b.size(), img) && IsRGBA8(img, W, H) && SamePixels(img, expected), "8 bit palette");
+	}
+	{ // 1 bit palette.
+		const uint32 W1 = 11;
+		Bytes b = MakeBMPHeader(W1, H, 1, 0, 40, 2, 4 * H);
+		Bytes expected(size_t(W1) * H * 4);
+		b.insert(b.end(), { 10, 20, 30, 0, 200, 210, 220, 0 });
+		for (uint32 y = 0; y < H; y++) {
+			Bytes row(4);
+			for (uint32 x = 0; x < W1; x++) {
+				bool on = (x * y + x) % 3 == 1;
+				if (on)
+					row[x / 8] |= uint8(0x80 >> (x % 8));
+				uint8 *e = &expected[(size_t(H - 1 - y) * W1 + x) * 4];
+				e[0] = on ? 220 : 30;
+				e[1] = on ? 210 : 20;
+				e[2] = on ? 200 : 10;
+				e[3] = 255;
+			}
+			b.insert(b.end(), row.begin(), row.end());
+		}
+		Check(imagedecoder::DecodeBMP(b.data(), b.size(), img) && IsRGBA8(img, W1, H) && SamePixels(img, expected), "1 bit palette");
+	}
+	{ // RLE is left to the platform decoder.
+		Bytes b = MakeBMPHeader(W, H, 8, 1, 40, 0, 64);
+		b.resize(b.size() + 256 * 4 + 64);
+		Check(!imagedecoder::DecodeBMP(b.data(), b.size(), img), "RLE is rejected");
+	}
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// DDS
+
+const uint32 DDSD_CAPS = 0x1, DDSD_HEIGHT = 0x2, DDSD_WIDTH = 0x4, DDSD_PIXELFORMAT = 0x1000, DDSD_MIPMAPCOUNT = 0x20000, DDSD_DEPTH = 0x800000;
+const uint32 DDPF_FOURCC = 0x4, DDPF_RGB = 0x40, DDPF_ALPHAPIXELS = 0x1;
+
+uint32 FourCC(const char *s) { return uint32(uint8(s[0])) | (uint32(uint8(s[1])) << 8) | (uint32(uint8(s[2])) << 16) | (uint32(uint8(s[3])) << 24); }
+
+// Magic and DDS_HEADER. pf is flags, fourCC, bit count and the four masks.
+Bytes MakeDDSHeader(uint32 w, uint32 h, uint32 depth, uint32 mips, const uint32 pf[7], uint32 caps2 = 0)
+{
+	Bytes d;
+	Put32LE(d, FourCC("DDS "));
+	Put32LE(d, 124);
+	Put32LE(d, DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT | (mips > 1 ? DDSD_MIPMAPCOUNT : 0) | (depth > 1 ? DDSD_DEPTH : 0));
+	Put32LE(d, h);
+	Put32LE(d, w);
+	Put32LE(d, 0);
+	Put32LE(d, depth);
+	Put32LE(d, mips);
+	for (uint32 i = 0; i < 11; i++)
+		Put32LE(d, 0);
+	Put32LE(d, 32);
+	for (uint32 i = 0; i < 7; i++)
+		Put32LE(d, pf[i]);
+	Put32LE(d, 0x1000);
+	Put32LE(d, caps2);
+	Put32LE(d, 0);
+	Put32LE(d, 0);
+	Put32LE(d, 0);
+	return d;
+}
+
+Bytes Sequence(size_t n)
+{
+	Bytes b(n);
+	for (size_t i = 0; i < n; i++)
+		b[i] = uint8(i * 7 + (i >> 8));
+	return b;
+}
+
+void TestDDS()
+{
+	printf("DDS\n");
+	DecodedImage img;
+
+	{ // RGBA8 with a full mip chain.
+		const uint32 pf[7] = { DDPF_RGB | DDPF_ALPHAPIXELS, 0, 32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000 };
+		Bytes d = MakeDDSHeader(8, 4, 1, 4, pf);
+		Bytes pixels = Sequence((8 * 4 + 4 * 2 + 2 * 1 + 1 * 1) * 4);
+		d.insert(d.end(), pixels.begin(), pixels.end());
+		bool ok = imagedecoder::DecodeDDS(d.data(), d.size(), img) && img.format == M3D_FORMAT_R8G8B8A8_UNORM && img.dimension == 2 && img.mipLevels == 4 && img.subresources.size() == 4;
+		ok = ok && img.subresources[1].width == 4 && img.subresources[1].height == 2 && img.subresources[1].rowPitch == 16 && img.subresources[1].offset == 8 * 4 * 4;
+		ok = ok && img.subresources[3].width == 1 && img.subresources[3].height == 1 && img.subresources[3].slicePitch == 4;
+		Check(ok && img.data == pixels, "RGBA8 with mips");
+		CheckDamaged(d, imagedecoder::DecodeDDS, "damaged files");
+		d.pop_back();
+		Check(!imagedecoder::DecodeDDS(d.data(), d.size(), img), "truncated data is rejected");
+	}
+	{ // BC1 with a size that is not a multiple of the block size.
+		const uint32 pf[7] = { DDPF_FOURCC, FourCC("DXT1"), 0, 0, 0, 0, 0 };
+		Bytes d = MakeDDSHeader(5, 3, 1, 3, pf);
+		Bytes blocks = Sequence(2 * 8 + 8 + 8);
+		d.insert(d.end(), blocks.begin(), blocks.end());
+		bool ok = imagedecoder::DecodeDDS(d.data(), d.size(), img) && img.format == M3D_FORMAT_BC1_UNORM && img.mipLevels == 3 && img.subresources.size() == 3;
+		ok = ok && img.subresources[0].rowPitch == 16 && img.subresources[0].slicePitch == 16 && img.subresources[1].width == 2 && img.subresources[1].height == 1 && img.subresources[1].slicePitch == 8 && img.subresources[2].offset == 24;
+		Check(ok && img.data == blocks, "BC1 with partial blocks and mips");
+	}
+	{ // DX10 header, BC7 cube map.
+		const uint32 pf[7] = { DDPF_FOURCC, FourCC("DX10"), 0, 0, 0, 0, 0 };
+		Bytes d = MakeDDSHeader(4, 4, 1, 1, pf, 0x200 | 0xFC00);
+		Put32LE(d, M3D_FORMAT_BC7_UNORM_SRGB);
+		Put32LE(d, 3); // Texture 2D
+		Put32LE(d, 0x4); // Cube
+		Put32LE(d, 1);
+		Put32LE(d, 0);
+		Bytes blocks = Sequence(6 * 16);
+		d.insert(d.end(), blocks.begin(), blocks.end());
+		bool ok = imagedecoder::DecodeDDS(d.data(), d.size(), img) && img.format == M3D_FORMAT_BC7_UNORM_SRGB && img.cubeMap && img.arraySize == 6 && img.subresources.size() == 6;
+		Check(ok && img.subresources[5].offset == 5 * 16 && img.data == blocks, "DX10 BC7 cube map");
+	}
+	{ // Legacy header volume texture.
+		const uint32 pf[7] = { DDPF_RGB, 0, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0 };
+		Bytes d = MakeDDSHeader(4, 2, 4, 1, pf, 0x200000);
+		Bytes pixels = Sequence(4 * 2 * 4 * 4);
+		d.insert(d.end(), pixels.begin(), pixels.end());
+		bool ok = imagedecoder::DecodeDDS(d.data(), d.size(), img) && img.format == M3D_FORMAT_B8G8R8X8_UNORM && img.dimension == 3 && img.depth == 4 && img.subresources.size() == 1;
+		Check(ok && img.subresources[0].depth == 4 && img.subresources[0].slicePitch == 4 * 2 * 4 && img.data == pixels, "volume texture");
+	}
+	{ // Unsupported pixel formats are left to the platform decoder.
+		const uint32 pf[7] = { DDPF_RGB, 0, 24, 0xFF0000, 0xFF00, 0xFF, 0 };
+		Bytes d = MakeDDSHeader(4, 4, 1, 1, pf);
+		d.resize(d.size() + 4 * 4 * 3);
+		Check(!imagedecoder::DecodeDDS(d.data(), d.size(), img), "24 bit RGB is rejected");
+	}
+}
+
+void TestFormats()
+{
+	printf("Formats\n");
+	uint32 rowPitch, rowCount;
+	imagedecoder::GetSurfaceInfo(M3D_FORMAT_BC3_UNORM, 13, 9, rowPitch, rowCount);
+	Check(rowPitch == 4 * 16 && rowCount == 3, "BC3 surface info");
+	imagedecoder::GetSurfaceInfo(M3D_FORMAT_R16G16B16A16_FLOAT, 3, 2, rowPitch, rowCount);
+	Check(rowPitch == 24 && rowCount == 2, "RGBA16F surface info");
+	Check(imagedecoder::GetBitsPerPixel(M3D_FORMAT_BC1_UNORM) == 64 && imagedecoder::GetBitsPerPixel(M3D_FORMAT_BC7_UNORM) == 128, "block sizes");
+	Check(imagedecoder::IsBlockCompressed(M3D_FORMAT_BC5_UNORM) && !imagedecoder::IsBlockCompressed(M3D_FORMAT_R8G8B8A8_UNORM), "block compressed formats");
+	Check(imagedecoder::MakeSRGB(M3D_FORMAT_BC7_UNORM) == M3D_FORMAT_BC7_UNORM_SRGB && imagedecoder::MakeSRGB(M3D_FORMAT_BC4_UNORM) == M3D_FORMAT_BC4_UNORM, "sRGB formats");
+}
+
+
+// ------------------------------------------------------------------------------------------------
+// Benchmark
+
+int Bench(int argc, char *argv[])
+{
+	uint32 iterations = 20;
+	for (int i = 2; i < argc; i++) {
+		if (std::string(argv[i]) == "-iterations" && i + 1 < argc) {
+			iterations = std::max(1, atoi(argv[++i]));
+			continue;
+		}
+		std::ifstream f(argv[i], std::ios::binary);
+		Bytes file((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+		std::string ext = argv[i];
+		ext = ext.substr(ext.find_last_of('.') + 1);
+		for (char &c : ext)
+			c = char(tolower(c));
+		bool (*decode)(const uint8*, size_t, DecodedImage&) = ext == "png" ? imagedecoder::DecodePNG : ext == "tga" ? imagedecoder::DecodeTGA : ext == "bmp" ? imagedecoder::DecodeBMP : ext == "dds" ? imagedecoder::DecodeDDS : nullptr;
+		DecodedImage img;
+		if (file.empty() || !decode || !decode(file.data(), file.size(), img)) {
+			printf("%s: Not supported by the decoders.\n", argv[i]);
+			continue;
+		}
+		auto start = std::chrono::steady_clock::now();
+		for (uint32 j = 0; j < iterations; j++)
+			decode(file.data(), file.size(), img);
+		double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+		printf("%s: %ux%u, %.3f ms, %.1f MB/s decoded\n", argv[i], img.width, img.height, s * 1000.0, img.data.size() / s / (1024.0 * 1024.0));
+	}
+	return 0;
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1 && std::string(argv[1]) == "-bench")
+		return Bench(argc, argv);
+	if (argc > 1) {
+		printf("Usage: ImageDecoderTest [-bench [-iterations <n>] <image files>]\n"
+			"Runs the unit tests for the portable image decoders, or measures decoding of the given files.\n");
+		return 1;
+	}
+
+	TestInflate();
+	TestPNG();
+	TestTGA();
+	TestBMP();
+	TestDDS();
+	TestFormats();
+
+	return Report();
+}
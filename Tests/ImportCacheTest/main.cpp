@@ -0,0 +1,261 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "StdImporters/ImportCache.h"
+#include "TestUtil.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <sstream>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+// A minimal obj reader in place of assimp. Reads the model and the material libraries it references, and returns the
+// "scene" as text: the vertex and face count, and the material names with their diffuse colors. Returns false if a
+// file can not be read. dependencies are the files read, other than filename.
+bool ReadObj(const std::filesystem::path &filename, std::string &scene, List<std::filesystem::path> &dependencies)
+{
+	std::ifstream file(filename);
+	if (!file)
+		return false;
+	uint32 vertices = 0, faces = 0;
+	std::string materials;
+	for (std::string line; std::getline(file, line);) {
+		std::istringstream s(line);
+		std::string op;
+		s >> op;
+		if (op == "v")
+			vertices++;
+		else if (op == "f")
+			faces++;
+		else if (op == "mtllib") {
+			std::string name;
+			s >> name;
+			std::filesystem::path mtl = filename.parent_path() / name;
+			std::ifstream m(mtl);
+			if (!m)
+				return false;
+			dependencies.push_back(mtl);
+			for (std::string l; std::getline(m, l);)
+				if (l.compare(0, 7, "newmtl ") == 0 || l.compare(0, 3, "Kd ") == 0)
+					materials += l + "\n";
+		}
+	}
+	scene = "v " + std::to_string(vertices) + "\nf " + std::to_string(faces) + "\n" + materials;
+	return true;
+}
+
+// Reads filename through the cache, like OpenAssetImpLib does with assimp.
+bool Import(ImportCache &cache, const std::filesystem::path &filename, const String &settings, std::string &scene, bool &fromCache)
+{
+	fromCache = false;
+	uint64 key = cache.GetKey(filename, settings);
+	List<uint8> data;
+	if (key != 0 && cache.Load(key, data)) {
+		scene.assign((const char*)data.data(), data.size());
+		fromCache = true;
+		return true;
+	}
+	List<std::filesystem::path> dependencies;
+	if (!ReadObj(filename, scene, dependencies))
+		return false;
+	if (key != 0)
+		cache.Store(key, (const uint8*)scene.data(), scene.size(), dependencies);
+	return true;
+}
+
+uint32 CountCacheFiles(const std::filesystem::path &dir)
+{
+	uint32 n = 0;
+	std::error_code ec;
+	for (std::filesystem::directory_iterator itr(dir, ec), end; !ec && itr != end; itr.increment(ec))
+		if (itr->path().extension() == MTEXT(".sxic"))
+			n++;
+	return n;
+}
+
+void Append(const std::filesystem::path &filename, const char *text)
+{
+	std::ofstream(filename, std::ios::app) << text;
+}
+
+// A new temp directory with a copy of the sample models and a cache directory, not yet created.
+struct ModelDir : public TempDir
+{
+	std::filesystem::path models;
+	std::filesystem::path cache;
+	ModelDir() : TempDir("ImportCacheTest")
+	{
+		models = path / MTEXT("models");
+		cache = path / MTEXT("Sub") / MTEXT("Cache");
+		std::filesystem::create_directories(models);
+		std::filesystem::copy(IMPORTCACHETEST_MODELS, models, std::filesystem::copy_options::recursive);
+	}
+};
+
+const String SETTINGS = MTEXT("obj 1.0\n0\n0");
+
+}
+
+
+void TestKeys()
+{
+	printf("Keys\n");
+	ModelDir dir;
+	ImportCache cache(dir.cache);
+	std::filesystem::path cube = dir.models / MTEXT("cube.obj"), triangle = dir.models / MTEXT("triangle.obj");
+
+	uint64 k = cache.GetKey(cube, SETTINGS);
+	Check(k != 0 && k == cache.GetKey(cube, SETTINGS), "key is stable");
+	Check(k != cache.GetKey(triangle, SETTINGS), "different models give different keys");
+	Check(k != cache.GetKey(cube, MTEXT("obj 1.0\n8\n0")), "settings are part of the key");
+	Check(k != cache.GetKey(cube, MTEXT("obj 1.1\n0\n0")), "reader version is part of the key");
+	Check(cache.GetKey(dir.models / MTEXT("missing.obj"), SETTINGS) == 0, "missing file gives key 0");
+
+	std::filesystem::copy_file(cube, dir.path / MTEXT("copy.obj"));
+	Check(k == cache.GetKey(dir.path / MTEXT("copy.obj"), SETTINGS), "key depends on the content, not the path");
+	Append(cube, "# changed\n");
+	Check(k != cache.GetKey(cube, SETTINGS), "changing the model changes the key");
+}
+
+void TestRoundTrip()
+{
+	printf("Round trip\n");
+	ModelDir dir;
+	std::filesystem::path cube = dir.models / MTEXT("cube.obj"), triangle = dir.models / MTEXT("triangle.obj");
+	std::string a, b;
+	bool fromCache;
+
+	{
+		ImportCache cache(dir.cache);
+		Check(Import(cache, cube, SETTINGS, a, fromCache) && !fromCache, "first import is read");
+		Check(a == "v 8\nf 6\nnewmtl Red\nKd 0.8 0.0 0.0\n", "sample model is read");
+		Check(CountCacheFiles(dir.cache) == 1, "one file per entry, directory created");
+		Check(Import(cache, triangle, SETTINGS, b, fromCache) && !fromCache && CountCacheFiles(dir.cache) == 2, "second model is stored");
+	}
+
+	{ // A new session.
+		ImportCache cache(dir.cache);
+		std::string c;
+		Check(Import(cache, cube, SETTINGS, c, fromCache) && fromCache && c == a, "hit from disk");
+		Check(Import(cache, triangle, SETTINGS, c, fromCache) && fromCache && c == b, "hit without dependencies");
+		Check(Import(cache, cube, MTEXT("obj 1.0\n8\n0"), c, fromCache) && !fromCache, "other settings miss");
+	}
+
+	{ // Store and Load directly.
+		ImportCache cache(dir.cache);
+		List<uint8> data;
+		const uint8 blob[] = { 1, 2, 3, 4, 5 };
+		uint64 key = cache.GetKey(triangle, MTEXT("blob"));
+		Check(!cache.Load(key, data), "miss before Store");
+		Check(cache.Store(key, blob, sizeof(blob), List<std::filesystem::path>()), "Store");
+		Check(cache.Load(key, data) && data.size() == sizeof(blob) && std::memcmp(data.data(), blob, sizeof(blob)) == 0, "Load returns the stored data");
+		Check(!cache.Store(0, blob, sizeof(blob), List<std::filesystem::path>()), "key 0 is not stored");
+		Check(!cache.Store(key, blob, sizeof(blob), List<std::filesystem::path>(1, dir.models / MTEXT("missing.mtl"))), "missing dependency is not stored");
+		Check(cache.Load(key, data) && data.size() == sizeof(blob), "failed Store keeps the old entry");
+	}
+}
+
+void TestDependencies()
+{
+	printf("Dependencies\n");
+	ModelDir dir;
+	ImportCache cache(dir.cache);
+	std::filesystem::path cube = dir.models / MTEXT("cube.obj"), mtl = dir.models / MTEXT("cube.mtl");
+	std::string a, b;
+	bool fromCache;
+
+	Import(cache, cube, SETTINGS, a, fromCache);
+	std::filesystem::copy_file(mtl, dir.path / MTEXT("cube.mtl.bak"));
+
+	Append(mtl, "newmtl Green\nKd 0.0 0.8 0.0\n");
+	Check(Import(cache, cube, SETTINGS, b, fromCache) && !fromCache, "changed .mtl is read again");
+	Check(b == a + "newmtl Green\nKd 0.0 0.8 0.0\n", "changed .mtl is used");
+	Check(Import(cache, cube, SETTINGS, b, fromCache) && fromCache, "entry is replaced");
+
+	std::filesystem::copy_file(dir.path / MTEXT("cube.mtl.bak"), mtl, std::filesystem::copy_options::overwrite_existing);
+	Check(Import(cache, cube, SETTINGS, b, fromCache) && !fromCache && b == a, "restored .mtl is read again");
+
+	std::filesystem::remove(mtl);
+	List<uint8> data;
+	Check(!cache.Load(cache.GetKey(cube, SETTINGS), data), "removed .mtl misses");
+	Check(!Import(cache, cube, SETTINGS, b, fromCache), "import fails without the .mtl");
+}
+
+void TestDamaged()
+{
+	printf("Damaged\n");
+	ModelDir dir;
+	ImportCache cache(dir.cache);
+	std::filesystem::path cube = dir.models / MTEXT("cube.obj");
+	std::string a, b;
+	bool fromCache;
+
+	Import(cache, cube, SETTINGS, a, fromCache);
+	for (std::filesystem::directory_iterator itr(dir.cache), end; itr != end; ++itr)
+		std::filesystem::resize_file(itr->path(), std::filesystem::file_size(itr->path()) - 1);
+	Check(Import(cache, cube, SETTINGS, b, fromCache) && !fromCache && b == a, "truncated entry is read again");
+	Check(Import(cache, cube, SETTINGS, b, fromCache) && fromCache && b == a, "truncated entry is replaced");
+
+	for (std::filesystem::directory_iterator itr(dir.cache), end; itr != end; ++itr)
+		std::ofstream(itr->path(), std::ios::binary | std::ios::trunc) << "not a cache file, but long enough for a header";
+	Check(Import(cache, cube, SETTINGS, b, fromCache) && !fromCache && b == a, "foreign file is read again");
+}
+
+void TestClear()
+{
+	printf("Clear\n");
+	ModelDir dir;
+	ImportCache cache(dir.cache);
+	std::string a;
+	bool fromCache;
+
+	Import(cache, dir.models / MTEXT("cube.obj"), SETTINGS, a, fromCache);
+	Import(cache, dir.models / MTEXT("triangle.obj"), SETTINGS, a, fromCache);
+	std::ofstream(dir.cache / MTEXT("other.txt")) << "keep";
+	cache.Clear();
+	Check(CountCacheFiles(dir.cache) == 0, "Clear removes the entries");
+	Check(std::filesystem::exists(dir.cache / MTEXT("other.txt")), "Clear keeps other files");
+	Check(Import(cache, dir.models / MTEXT("cube.obj"), SETTINGS, a, fromCache) && !fromCache, "miss after Clear");
+
+	ImportCache none((std::filesystem::path()));
+	Check(Import(none, dir.models / MTEXT("cube.obj"), SETTINGS, a, fromCache) && !fromCache, "no directory: no cache");
+	none.Clear();
+}
+
+int main()
+{
+	TestKeys();
+	TestRoundTrip();
+	TestDependencies();
+	TestDamaged();
+	TestClear();
+
+	return Report();
+}
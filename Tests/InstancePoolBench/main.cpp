@@ -0,0 +1,301 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "M3DEngine/InstancePool.h"
+#include "M3DCore/MString.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace m3d;
+
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Stands in for an instance data chip. Created by cloning the template of the class, and reset by copying it.
+struct Member
+{
+	virtual ~Member() {}
+	virtual Member *Clone() const = 0;
+	virtual void CopyFrom(const Member *m) = 0;
+};
+
+struct ValueMember : Member
+{
+	float64 value = 1.0;
+	Member *Clone() const override { return new ValueMember(*this); }
+	void CopyFrom(const Member *m) override { value = static_cast<const ValueMember*>(m)->value; }
+};
+
+struct TextMember : Member
+{
+	String text = MTEXT("A text member of a class instance");
+	Member *Clone() const override { return new TextMember(*this); }
+	void CopyFrom(const Member *m) override { text = static_cast<const TextMember*>(m)->text; }
+};
+
+struct ArrayMember : Member
+{
+	List<float64> values = List<float64>(16, 0.5);
+	Member *Clone() const override { return new ArrayMember(*this); }
+	void CopyFrom(const Member *m) override { values = static_cast<const ArrayMember*>(m)->values; }
+};
+
+// Stands in for a ClassInstance.
+struct Instance
+{
+	uint64 id = 0;
+	List<Member*> data;
+	~Instance()
+	{
+		for (Member *m : data)
+			delete m;
+	}
+};
+
+// Stands in for a Class. Create() and Release() follow ClassInstance::Create() and ClassInstance::Release().
+class Clazz
+{
+public:
+	InstancePool<Instance> pool;
+
+	Clazz(uint32 dataMembers) : _ids(0)
+	{
+		for (uint32 i = 0; i < dataMembers; i++) {
+			switch (i % 3) {
+			case 0: _templates.push_back(new ValueMember()); break;
+			case 1: _templates.push_back(new TextMember()); break;
+			default: _templates.push_back(new ArrayMember()); break;
+			}
+		}
+	}
+	~Clazz()
+	{
+		pool.SetPolicy(InstancePoolPolicy::NONE);
+		Trim();
+		for (Member *m : _templates)
+			delete m;
+	}
+
+	Instance *Create()
+	{
+		Instance *instance = pool.Take();
+		if (!instance) {
+			instance = _construct();
+			pool.OnCreated();
+		}
+		instance->id = ++_ids;
+		_instances.insert(std::make_pair(instance->id, instance));
+		pool.OnLive((uint32)_instances.size());
+		return instance;
+	}
+	void Release(Instance *instance)
+	{
+		_instances.erase(instance->id);
+		if (pool.GetPolicy() != InstancePoolPolicy::NONE) {
+			if (pool.HasRoom()) {
+				for (size_t i = 0; i < _templates.size(); i++)
+					instance->data[i]->CopyFrom(_templates[i]);
+				pool.Put(instance);
+				return;
+			}
+			pool.OnDiscarded();
+		}
+		delete instance;
+	}
+	void Prewarm(uint32 count) { pool.Prewarm(count, [this]() { return _construct(); }); }
+	void Trim(uint32 count = 0) { pool.Trim(count, [](Instance *instance) { delete instance; }, (uint32)_instances.size()); }
+	size_t GetLiveCount() const { return _instances.size(); }
+
+private:
+	List<Member*> _templates;
+	Map<uint64, Instance*> _instances;
+	uint64 _ids;
+
+	Instance *_construct() const
+	{
+		Instance *instance = new Instance();
+		instance->data.reserve(_templates.size());
+		for (Member *m : _templates)
+			instance->data.push_back(m->Clone());
+		return instance;
+	}
+};
+
+struct Options
+{
+	uint32 dataMembers = 8; // Number of data members per instance. Cycles through values, texts and arrays.
+	uint32 batchSize = 1000; // Number of instances alive at the same time.
+	uint32 rounds = 100; // Number of times a batch is created and destroyed per iteration.
+	uint32 iterations = 5;
+	bool prewarm = false; // Fill the pool before measuring.
+};
+
+struct Result
+{
+	InstancePoolPolicy policy = InstancePoolPolicy::NONE;
+	bool succeeded = true;
+	float64 time = 0.0; // Seconds, from the fastest iteration.
+	float64 instancesPerSecond = 0.0; // Created and destroyed, from the fastest iteration.
+	InstancePoolStats stats; // Accumulated over all iterations.
+};
+
+const char *ToString(InstancePoolPolicy policy)
+{
+	switch (policy)
+	{
+	case InstancePoolPolicy::FIXED: return "FIXED";
+	case InstancePoolPolicy::ADAPTIVE: return "ADAPTIVE";
+	default: return "NONE";
+	}
+}
+
+Result Run(const Options &options, InstancePoolPolicy policy)
+{
+	Result r;
+	r.policy = policy;
+	r.time = std::numeric_limits<float64>::max();
+
+	Clazz clazz(options.dataMembers);
+	clazz.pool.SetPolicy(policy);
+	clazz.pool.SetCapacity(options.batchSize);
+
+	std::vector<Instance*> instances;
+	instances.reserve(options.batchSize);
+	for (uint32 i = 0; i < options.iterations; i++) {
+		if (options.prewarm)
+			clazz.Prewarm(options.batchSize);
+
+		Clock::time_point start = Clock::now();
+		for (uint32 j = 0; j < options.rounds; j++) {
+			for (uint32 k = 0; k < options.batchSize; k++)
+				instances.push_back(clazz.Create());
+			for (Instance *instance : instances)
+				clazz.Release(instance);
+			instances.clear();
+		}
+		r.time = std::min(r.time, std::chrono::duration<float64>(Clock::now() - start).count());
+
+		r.succeeded = r.succeeded && clazz.GetLiveCount() == 0;
+		clazz.Trim(); // Do not let the pool carry over to the next iteration.
+	}
+	r.instancesPerSecond = r.time > 0.0 ? float64(options.rounds) * options.batchSize / r.time : 0.0;
+	r.stats = clazz.pool.GetStats();
+
+	// Every instance handed out is either created, prewarmed or reused, and every release is recycled or discarded.
+	const InstancePoolStats &s = r.stats;
+	uint64 total = uint64(options.rounds) * options.batchSize * options.iterations;
+	r.succeeded = r.succeeded && s.created + s.reused == total && s.pooled == 0 && s.peakPooled <= options.batchSize;
+	if (policy == InstancePoolPolicy::NONE)
+		r.succeeded = r.succeeded && s.reused == 0 && s.recycled == 0 && s.discarded == 0 && s.prewarmed == 0;
+	else
+		r.succeeded = r.succeeded && s.recycled + s.discarded == total && s.reused <= s.recycled + s.prewarmed && s.created <= (options.prewarm ? 0 : options.batchSize) * options.iterations;
+	return r;
+}
+
+void PrintUsage()
+{
+	std::cerr <<
+		"Usage: InstancePoolBench [options]\n"
+		"  Measures create/destroy throughput of class instances for each pool policy.\n"
+		"  The instances are stand-ins driving InstancePool the way Class does, not ClassInstance and chips.\n"
+		"  Use SnaXBench -instances on Windows for the engine path.\n"
+		"  -members <n>      Data members per instance (default 8).\n"
+		"  -batch <n>        Instances alive at the same time (default 1000).\n"
+		"  -rounds <n>       Batches created and destroyed per iteration (default 100).\n"
+		"  -iterations <n>   Iterations per policy. The fastest is reported (default 5).\n"
+		"  -prewarm          Fill the pool before each iteration.\n"
+		"  -out <file>       Write the JSON report to file instead of stdout.\n";
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	std::string out;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "-members" && i + 1 < argc)
+			options.dataMembers = (uint32)std::max(0, std::atoi(argv[++i]));
+		else if (a == "-batch" && i + 1 < argc)
+			options.batchSize = (uint32)std::max(1, std::atoi(argv[++i]));
+		else if (a == "-rounds" && i + 1 < argc)
+			options.rounds = (uint32)std::max(1, std::atoi(argv[++i]));
+		else if (a == "-iterations" && i + 1 < argc)
+			options.iterations = (uint32)std::max(1, std::atoi(argv[++i]));
+		else if (a == "-prewarm")
+			options.prewarm = true;
+		else if (a == "-out" && i + 1 < argc)
+			out = argv[++i];
+		else {
+			PrintUsage();
+			return a == "-help" || a == "-h" ? 0 : 1;
+		}
+	}
+
+	std::vector<Result> results;
+	for (InstancePoolPolicy policy : { InstancePoolPolicy::NONE, InstancePoolPolicy::FIXED, InstancePoolPolicy::ADAPTIVE })
+		results.push_back(Run(options, policy));
+
+	std::cerr << "Stand-in instances driving InstancePool, not ClassInstance (see -help).\n";
+	bool succeeded = true;
+	std::stringstream json;
+	json << "{\n  \"subject\": \"stand-in instances (InstancePool only, not ClassInstance)\",\n  \"data_members\": " << options.dataMembers << ",\n  \"batch_size\": " << options.batchSize << ",\n  \"rounds\": " << options.rounds
+		<< ",\n  \"prewarm\": " << (options.prewarm ? "true" : "false") << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		json << "    { \"policy\": \"" << ToString(r.policy) << "\", \"succeeded\": " << (r.succeeded ? "true" : "false") << ", \"time_ms\": " << r.time * 1000.0
+			<< ", \"instances_per_second\": " << (uint64)r.instancesPerSecond << ", \"created\": " << r.stats.created << ", \"prewarmed\": " << r.stats.prewarmed
+			<< ", \"reused\": " << r.stats.reused << ", \"recycled\": " << r.stats.recycled << ", \"discarded\": " << r.stats.discarded << ", \"peak_pooled\": " << r.stats.peakPooled
+			<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		std::cerr << ToString(r.policy) << ": " << (uint64)r.instancesPerSecond << " instances/s" << (r.succeeded ? "" : " (FAILED)") << "\n";
+		succeeded = succeeded && r.succeeded;
+	}
+	json << "  ]\n}\n";
+
+	if (out.empty())
+		std::cout << json.str();
+	else {
+		std::ofstream f(out);
+		f << json.str();
+		if (!f) {
+			std::cerr << "Failed to write " << out << "\n";
+			return 1;
+		}
+	}
+
+	return succeeded ? 0 : 1;
+}
@@ -0,0 +1,233 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "M3DEngine/MemoryUsageCollector.h"
+#include "M3DCore/MemoryTracker.h"
+#include "TestUtil.h"
+#include <cstdio>
+#include <memory>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+// Stand-ins for Chip, ClassInstance and Class with the accessors used by MemoryUsageCollector.
+struct ChipDescStub
+{
+	const Char *name;
+};
+
+struct ChipStub
+{
+	ChipDescStub desc;
+	uint64 bytes;
+	uint64 geometry = 0;
+	uint64 textures = 0;
+
+	ChipStub(const Char *type, uint64 bytes) : desc{ type }, bytes(bytes) {}
+	const ChipDescStub &GetChipDesc() const { return desc; }
+	uint64 GetMemoryUsage() const { return bytes; }
+	uint64 GetSubsystemMemoryUsage(MemorySubsystem subsystem) const { return subsystem == MemorySubsystem::GEOMETRY ? geometry : (subsystem == MemorySubsystem::TEXTURES ? textures : 0); }
+};
+
+struct InstanceStub
+{
+	uint64 bytes;
+	Map<uint32, ChipStub*> data;
+
+	InstanceStub(uint64 bytes) : bytes(bytes) {}
+	uint64 GetMemoryUsage() const { return bytes; }
+	const Map<uint32, ChipStub*> &GetData() const { return data; }
+};
+
+struct ClassStub
+{
+	String name;
+	Map<uint32, ChipStub*> chips;
+	Set<InstanceStub*> instances;
+	List<InstanceStub*> pooled;
+
+	String GetName() const { return name; }
+	const Map<uint32, ChipStub*> &GetChips() const { return chips; }
+	const Set<InstanceStub*> &GetInstances() const { return instances; }
+	const List<InstanceStub*> &GetPooledInstances() const { return pooled; }
+};
+
+// Owns the stand-ins of a small project:
+// Player: 2 chips (Value 100, Texture 1000 with 4096 texture bytes), 2 instances (50 each) with Value data (100) and
+//         Geometry data (200 with 8192 geometry bytes), and 1 pooled instance (50) with the same data.
+// Enemy: 1 chip (Value 100), no instances.
+struct Project
+{
+	List<std::unique_ptr<ChipStub>> allChips;
+	List<std::unique_ptr<InstanceStub>> allInstances;
+	ClassStub player, enemy;
+	Map<uint32, ClassStub*> classes;
+
+	ChipStub *NewChip(const Char *type, uint64 bytes)
+	{
+		allChips.push_back(std::make_unique<ChipStub>(type, bytes));
+		return allChips.back().get();
+	}
+	InstanceStub *NewInstance()
+	{
+		allInstances.push_back(std::make_unique<InstanceStub>(50));
+		InstanceStub *instance = allInstances.back().get();
+		instance->data[0] = NewChip(MTEXT("Value"), 100);
+		ChipStub *geometry = NewChip(MTEXT("Geometry"), 200);
+		geometry->geometry = 8192;
+		instance->data[1] = geometry;
+		return instance;
+	}
+
+	Project()
+	{
+		player.name = MTEXT("Player");
+		player.chips[0] = NewChip(MTEXT("Value"), 100);
+		ChipStub *texture = NewChip(MTEXT("Texture"), 1000);
+		texture->textures = 4096;
+		player.chips[1] = texture;
+		player.instances.insert(NewInstance());
+		player.instances.insert(NewInstance());
+		player.pooled.push_back(NewInstance());
+
+		enemy.name = MTEXT("Enemy");
+		enemy.chips[0] = NewChip(MTEXT("Value"), 100);
+
+		classes[1] = &player;
+		classes[2] = &enemy;
+	}
+};
+
+int64 Live(MemoryTracker &mt, const Char *name)
+{
+	return mt.GetStats(mt.RegisterTag(name)).live;
+}
+
+void TestCollect()
+{
+	printf("Collect\n");
+	MemoryTracker mt;
+	MemoryUsageCollector collector(mt);
+	Project p;
+
+	collector.Collect(p.classes);
+
+	// Each instance is 50 + 100 + 200. The pooled one is counted too.
+	Check(Live(mt, MTEXT("Class/Player")) == 100 + 1000 + 3 * 350, "class includes chips, instances, instance data and pooled instances");
+	Check(Live(mt, MTEXT("Class/Enemy")) == 100, "class without instances");
+	Check(Live(mt, MTEXT("Chip/Value")) == 100 + 100 + 3 * 100, "chip type summed over classes and instances");
+	Check(Live(mt, MTEXT("Chip/Geometry")) == 3 * 200 && Live(mt, MTEXT("Chip/Texture")) == 1000, "chip types");
+	Check(mt.GetStats(mt.GetTag(MemorySubsystem::GEOMETRY)).live == 3 * 8192, "geometry subsystem");
+	Check(mt.GetStats(mt.GetTag(MemorySubsystem::TEXTURES)).live == 4096, "texture subsystem");
+	Check(collector.GetTags().size() == 5, "tags set");
+}
+
+void TestChanges()
+{
+	printf("Changes\n");
+	MemoryTracker mt;
+	MemoryUsageCollector collector(mt);
+	Project p;
+	collector.Collect(p.classes);
+	uint64 allocated = mt.GetStats(mt.RegisterTag(MTEXT("Class/Player"))).allocatedBytes;
+
+	// Growth counts as allocated bytes. Shrinking keeps the peak.
+	p.player.chips[0]->bytes += 400;
+	collector.Collect(p.classes);
+	MemoryTagStats s = mt.GetStats(mt.RegisterTag(MTEXT("Class/Player")));
+	Check(s.live == 2550 && s.allocatedBytes == allocated + 400, "growth is counted as allocated");
+	p.player.chips[0]->bytes -= 400;
+	collector.Collect(p.classes);
+	s = mt.GetStats(mt.RegisterTag(MTEXT("Class/Player")));
+	Check(s.live == 2150 && s.peak == 2550 && s.allocatedBytes == allocated + 400, "shrinking keeps the peak");
+
+	// A removed class and a chip type no longer used are set to 0.
+	p.classes.erase(2);
+	p.player.chips.erase(1);
+	collector.Collect(p.classes);
+	Check(Live(mt, MTEXT("Class/Enemy")) == 0, "removed class is cleared");
+	Check(Live(mt, MTEXT("Chip/Texture")) == 0 && mt.GetStats(mt.GetTag(MemorySubsystem::TEXTURES)).live == 0, "removed chip type is cleared");
+	Check(Live(mt, MTEXT("Chip/Value")) == 100 + 3 * 100, "remaining chip type");
+	Check(collector.GetTags().size() == 3, "tags set");
+
+	p.classes.clear();
+	collector.Collect(p.classes);
+	Check(Live(mt, MTEXT("Class/Player")) == 0 && Live(mt, MTEXT("Chip/Value")) == 0 && collector.GetTags().empty(), "no classes");
+}
+
+void TestSnapshot()
+{
+	printf("Snapshot\n");
+	MemoryTracker mt;
+	MemoryUsageCollector collector(mt);
+	Project p;
+	mt.SetCollector([&]() { collector.Collect(p.classes); });
+
+	mt.TakeSnapshot();
+	Check(collector.GetTags().empty(), "collector is not called while disabled");
+	mt.SetEnabled(true);
+	MemorySnapshot s = mt.TakeSnapshot();
+	MemoryTag tag = mt.RegisterTag(MTEXT("Class/Player"));
+	Check(tag < s.tags.size() && s.tags[tag].name == MTEXT("Class/Player") && s.tags[tag].live == 2150, "snapshot includes the walked classes");
+}
+
+void TestDocuments()
+{
+	printf("Documents\n");
+	MemoryTracker mt;
+	MemoryTag tag = mt.GetTag(MemorySubsystem::DOCUMENTS);
+	{
+		TrackedAllocation documentData(mt, tag);
+		documentData.Set(1000);
+		Check(documentData.GetBytes() == 0 && mt.GetStats(tag).live == 0, "nothing counted while disabled");
+	}
+	mt.SetEnabled(true);
+	{
+		TrackedAllocation a(mt, tag), b(mt, tag);
+		a.Set(1000);
+		b.Set(500);
+		Check(mt.GetStats(tag).live == 1500 && mt.GetStats(tag).allocations == 2, "two documents loading");
+		a.Set(0);
+		Check(mt.GetStats(tag).live == 500 && mt.GetStats(tag).peak == 1500, "one document loaded");
+		mt.SetEnabled(false);
+	}
+	Check(mt.GetStats(tag).live == 0, "freed after disabling");
+	Check(mt.GetStats(tag).allocations == 2 && mt.GetStats(tag).allocatedBytes == 1500, "Set(0) is not an allocation");
+}
+
+}
+
+
+int main()
+{
+	TestCollect();
+	TestChanges();
+	TestSnapshot();
+	TestDocuments();
+
+	return Report();
+}
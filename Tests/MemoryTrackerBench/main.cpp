@@ -0,0 +1,267 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "M3DCore/MemoryTracker.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct Result
+{
+	std::string mode; // "disabled", "enabled" or "enabled-shared".
+	uint32 threads = 0;
+	uint64 pairs = 0; // Allocate/Free pairs per thread.
+	float64 time = 0.0; // Seconds, wall time for all threads.
+	float64 nsPerPair = 0.0; // Per thread.
+};
+
+// Counts a sequence of allocations of random sizes on the given tags, freeing each after a while, like a frame of a running
+// project would. Returns the bytes counted, so that the caller can check the totals.
+uint64 Work(MemoryTracker &tracker, const std::vector<MemoryTag> &tags, uint64 count, uint32 seed)
+{
+	std::mt19937 rnd(seed);
+	const size_t WINDOW = 64; // Allocations alive at the same time.
+	struct Live { MemoryTag tag; uint64 bytes; };
+	std::vector<Live> live(WINDOW, Live{ 0, 0 });
+	uint64 total = 0;
+	for (uint64 i = 0; i < count; i++) {
+		Live &l = live[i % WINDOW];
+		tracker.Free(l.tag, l.bytes);
+		l.tag = tags[rnd() % tags.size()];
+		l.bytes = tracker.Allocate(l.tag, 16 + rnd() % 4096);
+		total += l.bytes;
+	}
+	for (const Live &l : live)
+		tracker.Free(l.tag, l.bytes);
+	return total;
+}
+
+Result Run(MemoryTracker &tracker, const std::string &mode, uint32 threads, uint64 count, const std::vector<MemoryTag> &tags)
+{
+	Result r;
+	r.mode = mode;
+	r.threads = threads;
+	r.pairs = count;
+
+	tracker.SetEnabled(mode != "disabled");
+	std::vector<std::thread> workers;
+	std::atomic<uint32> ready(0);
+	std::atomic<bool> go(false);
+	Clock::time_point start;
+	for (uint32 t = 0; t < threads; t++) {
+		workers.push_back(std::thread([&, t]() {
+			// Separate tags per thread, unless shared. Shared tags is the worst case, with all threads counting the same chip type.
+			std::vector<MemoryTag> mine = mode == "enabled-shared" ? tags : std::vector<MemoryTag>(1, tags[t % tags.size()]);
+			ready++;
+			while (!go.load())
+				std::this_thread::yield();
+			Work(tracker, mine, count, t + 1);
+		}));
+	}
+	while (ready.load() < threads)
+		std::this_thread::yield();
+	start = Clock::now();
+	go = true;
+	for (std::thread &w : workers)
+		w.join();
+	r.time = std::chrono::duration<float64>(Clock::now() - start).count();
+	r.nsPerPair = r.time * 1.0e9 / float64(count);
+	tracker.SetEnabled(false);
+	return r;
+}
+
+bool Balanced(const String &json)
+{
+	int32 depth = 0;
+	bool inString = false;
+	for (size_t i = 0; i < json.size(); i++) {
+		Char c = json[i];
+		if (inString) {
+			if (c == MCHAR('\\'))
+				i++;
+			else if (c == MCHAR('\"'))
+				inString = false;
+		}
+		else if (c == MCHAR('\"'))
+			inString = true;
+		else if (c == MCHAR('{') || c == MCHAR('['))
+			depth++;
+		else if ((c == MCHAR('}') || c == MCHAR(']')) && --depth < 0)
+			return false;
+	}
+	return depth == 0 && !inString;
+}
+
+// Checks that counting from many threads adds up, and that snapshots and diffs report it.
+void Verify(uint32 threads, uint64 count)
+{
+	MemoryTracker tracker;
+	std::vector<MemoryTag> tags;
+	for (uint32 i = 0; i < 8; i++)
+		tags.push_back(tracker.RegisterTag(String(("Chip/Test \"") + std::to_string(i) + "\"")));
+	Check(tracker.RegisterTag(MTEXT("Chip/Test \"3\"")) == tags[3], "registering a name twice gives the same tag");
+	Check(tracker.GetTagName(tracker.GetTag(MemorySubsystem::TEXTURES)) == MTEXT("Textures"), "subsystem tags");
+
+	Check(tracker.Allocate(tags[0], 100) == 0 && tracker.GetStats(tags[0]).allocations == 0, "nothing is counted while disabled");
+
+	tracker.SetEnabled(true);
+	MemorySnapshot before = tracker.TakeSnapshot();
+	tracker.Allocate(tags[7], 1000); // Kept, to be found by the diff.
+	std::vector<std::thread> workers;
+	std::vector<uint64> totals(threads, 0);
+	for (uint32 t = 0; t < threads; t++)
+		workers.push_back(std::thread([&, t]() { totals[t] = Work(tracker, tags, count, 100 + t); }));
+	for (std::thread &w : workers)
+		w.join();
+	MemorySnapshot after = tracker.TakeSnapshot();
+
+	uint64 allocations = 0, allocatedBytes = 0, expectedBytes = 1000;
+	for (uint64 t : totals)
+		expectedBytes += t;
+	for (MemoryTag tag : tags) {
+		MemoryTagStats s = tracker.GetStats(tag);
+		allocations += s.allocations;
+		allocatedBytes += s.allocatedBytes;
+		Check(s.live == (tag == tags[7] ? 1000 : 0), "live bytes return to zero when all is freed");
+		Check(s.peak >= s.live && (s.allocations == 0 || s.peak > 0), "peak");
+	}
+	Check(allocations == threads * count + 1, "allocation count");
+	Check(allocatedBytes == expectedBytes, "allocated bytes");
+
+	MemorySnapshotDiff diff = MemorySnapshotDiff::Compute(before, after);
+	Check(!diff.tags.empty() && diff.tags[0].name == tracker.GetTagName(tags[7]) && diff.tags[0].liveDelta == 1000, "diff finds the growing tag first");
+	Check(diff.duration >= 0.0, "diff duration");
+	Check(Balanced(after.ToJson()) && Balanced(diff.ToJson()), "snapshot and diff JSON is well formed, with names escaped");
+	Check(after.ToText().find(MTEXT("Chip/Test")) != String::npos && !diff.ToText().empty(), "snapshot and diff text");
+
+	tracker.Free(tags[7], 1000);
+	tracker.ResetCounters();
+	Check(tracker.GetStats(tags[7]).peak == 0 && tracker.GetStats(tags[7]).allocations == 0, "ResetCounters");
+
+	// The collector measures live memory when a snapshot is taken. Growth counts as allocated bytes.
+	uint64 measured = 500;
+	tracker.SetCollector([&]() { tracker.SetLive(tags[1], measured); });
+	tracker.TakeSnapshot();
+	measured = 300;
+	tracker.TakeSnapshot();
+	measured = 800;
+	MemoryTagStats s = tracker.TakeSnapshot().tags[tags[1]];
+	Check(s.live == 800 && s.peak == 800 && s.allocatedBytes == 1000, "collector");
+}
+
+void PrintUsage()
+{
+	std::cerr <<
+		"Usage: MemoryTrackerBench [options]\n"
+		"  Measures the cost of counting allocations with the MemoryTracker, and checks the counters.\n"
+		"  -threads <a,b,..>  Thread counts to run (default 1,2,4,8).\n"
+		"  -count <n>         Allocate/Free pairs per thread (default 1000000).\n"
+		"  -out <file>        Write the JSON report to file instead of stdout.\n";
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::vector<uint32> threadCounts = { 1, 2, 4, 8 };
+	uint64 count = 1000000;
+	std::string out;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "-threads" && i + 1 < argc) {
+			threadCounts.clear();
+			std::stringstream ss(argv[++i]);
+			for (std::string t; std::getline(ss, t, ',');)
+				threadCounts.push_back((uint32)std::max(1, std::atoi(t.c_str())));
+		}
+		else if (a == "-count" && i + 1 < argc)
+			count = (uint64)std::max(1ll, std::atoll(argv[++i]));
+		else if (a == "-out" && i + 1 < argc)
+			out = argv[++i];
+		else {
+			PrintUsage();
+			return a == "-help" || a == "-h" ? 0 : 1;
+		}
+	}
+
+	for (uint32 threads : threadCounts)
+		Verify(threads, std::min<uint64>(count, 100000));
+
+	MemoryTracker tracker;
+	std::vector<MemoryTag> tags;
+	for (uint32 i = 0; i < 16; i++)
+		tags.push_back(tracker.RegisterTag(String("Chip/" + std::to_string(i))));
+
+	std::vector<Result> results;
+	for (uint32 threads : threadCounts)
+		for (const char *mode : { "disabled", "enabled", "enabled-shared" })
+			results.push_back(Run(tracker, mode, threads, count, tags));
+
+	std::stringstream json;
+	json << "{\n  \"pairs_per_thread\": " << count << ",\n  \"failures\": " << Failures() << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		json << "    { \"mode\": \"" << r.mode << "\", \"threads\": " << r.threads << ", \"pairs\": " << r.pairs
+			<< ", \"total_ms\": " << r.time * 1000.0 << ", \"ns_per_pair\": " << r.nsPerPair << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		std::cerr << r.mode << " x" << r.threads << ": " << r.nsPerPair << " ns per allocate/free\n";
+	}
+	json << "  ]\n}\n";
+
+	if (out.empty())
+		std::cout << json.str();
+	else {
+		std::ofstream f(out);
+		f << json.str();
+		if (!f) {
+			std::cerr << "Failed to write " << out << "\n";
+			return 1;
+		}
+	}
+
+	if (Failures()) {
+		std::cerr << Failures() << " check(s) failed.\n";
+		return 1;
+	}
+	return 0;
+}
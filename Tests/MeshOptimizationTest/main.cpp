@@ -0,0 +1,540 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "GraphicsChips/MeshOptimization.h"
+#include "TestUtil.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+typedef std::array<uint32, 3> Triangle;
+
+struct Mesh
+{
+	List<float32> positions; // xyz
+	List<uint32> indices;
+
+	size_t VertexCount() const { return positions.size() / 3; }
+	size_t TriangleCount() const { return indices.size() / 3; }
+	const float32 *Positions() const { return positions.data(); }
+};
+
+struct Vec
+{
+	float64 x, y, z;
+};
+
+Vec operator-(const Vec &a, const Vec &b) { return Vec{ a.x - b.x, a.y - b.y, a.z - b.z }; }
+float64 Dot(const Vec &a, const Vec &b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+Vec Cross(const Vec &a, const Vec &b) { return Vec{ a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+float64 Length(const Vec &v) { return std::sqrt(Dot(v, v)); }
+
+Vec Position(const Mesh &mesh, uint32 v) { return Vec{ mesh.positions[v * 3], mesh.positions[v * 3 + 1], mesh.positions[v * 3 + 2] }; }
+
+// The face normal as used by the optimizations, scaled by twice the area.
+Vec Normal(const Mesh &mesh, const uint32 *tri)
+{
+	Vec a = Position(mesh, tri[0]);
+	return Cross(Position(mesh, tri[1]) - a, Position(mesh, tri[2]) - a);
+}
+
+// (n+1)^2 vertices in the xy-plane, spanning [0, size]. Faces +z.
+Mesh MakeGrid(uint32 n, float32 size = 1.0f)
+{
+	Mesh mesh;
+	for (uint32 y = 0; y <= n; y++)
+		for (uint32 x = 0; x <= n; x++)
+			mesh.positions.insert(mesh.positions.end(), { size * x / n, size * y / n, 0.0f });
+	for (uint32 y = 0; y < n; y++) {
+		for (uint32 x = 0; x < n; x++) {
+			uint32 v = y * (n + 1) + x;
+			mesh.indices.insert(mesh.indices.end(), { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 });
+		}
+	}
+	return mesh;
+}
+
+// A unit sphere made from the six faces of a cube, n x n quads each. The faces do not share vertices, so their edges are seams.
+// Triangles face outwards.
+Mesh MakeCubeSphere(uint32 n)
+{
+	Mesh mesh;
+	for (uint32 f = 0; f < 6; f++) {
+		uint32 axis = f / 2;
+		float64 side = f % 2 ? 1.0 : -1.0;
+		uint32 base = uint32(mesh.VertexCount());
+		for (uint32 j = 0; j <= n; j++) {
+			for (uint32 i = 0; i <= n; i++) {
+				float64 p[3];
+				p[axis] = side;
+				p[(axis + 1) % 3] = 2.0 * i / n - 1.0;
+				p[(axis + 2) % 3] = 2.0 * j / n - 1.0;
+				float64 l = std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+				mesh.positions.insert(mesh.positions.end(), { float32(p[0] / l), float32(p[1] / l), float32(p[2] / l) });
+			}
+		}
+		for (uint32 j = 0; j < n; j++) {
+			for (uint32 i = 0; i < n; i++) {
+				uint32 v = base + j * (n + 1) + i;
+				uint32 quad[6] = { v, v + 1, v + n + 2, v, v + n + 2, v + n + 1 };
+				for (uint32 t = 0; t < 6; t += 3) {
+					Vec a = Position(mesh, quad[t]), b = Position(mesh, quad[t + 1]), c = Position(mesh, quad[t + 2]);
+					Vec centroid{ a.x + b.x + c.x, a.y + b.y + c.y, a.z + b.z + c.z };
+					if (Dot(Normal(mesh, quad + t), centroid) < 0.0)
+						std::swap(quad[t + 1], quad[t + 2]);
+				}
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+	}
+	return mesh;
+}
+
+// The triangles rotated to start with the smallest index (keeping the winding) and sorted, for comparing triangle lists.
+List<Triangle> Canonical(const uint32 *indices, size_t indexCount)
+{
+	List<Triangle> tris;
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		Triangle t = { indices[i], indices[i + 1], indices[i + 2] };
+		std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+		tris.push_back(t);
+	}
+	std::sort(tris.begin(), tris.end());
+	return tris;
+}
+
+bool SameTriangles(const List<uint32> &a, const List<uint32> &b)
+{
+	return a.size() == b.size() && Canonical(a.data(), a.size()) == Canonical(b.data(), b.size());
+}
+
+bool ValidIndices(const uint32 *indices, size_t indexCount, size_t vertexCount)
+{
+	return indexCount % 3 == 0 && std::all_of(indices, indices + indexCount, [=](uint32 v) { return v < vertexCount; });
+}
+
+// The triangles in random order, each rotated randomly.
+List<uint32> Shuffled(const List<uint32> &indices, std::mt19937 &rnd)
+{
+	List<Triangle> tris;
+	for (size_t i = 0; i < indices.size(); i += 3)
+		tris.push_back(Triangle{ indices[i], indices[i + 1], indices[i + 2] });
+	std::shuffle(tris.begin(), tris.end(), rnd);
+	List<uint32> out;
+	for (Triangle &t : tris) {
+		std::rotate(t.begin(), t.begin() + rnd() % 3, t.end());
+		out.insert(out.end(), t.begin(), t.end());
+	}
+	return out;
+}
+
+size_t CountVertices(const uint32 *indices, size_t indexCount)
+{
+	List<uint32> v(indices, indices + indexCount);
+	std::sort(v.begin(), v.end());
+	return size_t(std::unique(v.begin(), v.end()) - v.begin());
+}
+
+// Row vector convention, like DirectXMath: p' = p.x*r0 + p.y*r1 + p.z*r2 + r3.
+struct World
+{
+	float32 m[4][3];
+
+	XMMATRIX Matrix() const { return XMMATRIX(m[0][0], m[0][1], m[0][2], 0.0f, m[1][0], m[1][1], m[1][2], 0.0f, m[2][0], m[2][1], m[2][2], 0.0f, m[3][0], m[3][1], m[3][2], 1.0f); }
+	Vec Transform(const Vec &p) const
+	{
+		return Vec{ p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + m[3][0], p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + m[3][1], p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + m[3][2] };
+	}
+};
+
+// Uniform scale s, rotation a radians about z and translation t.
+World MakeWorld(float32 s, float32 a, const Vec &t)
+{
+	float32 c = std::cos(a) * s, n = std::sin(a) * s;
+	return World{ { { c, n, 0.0f }, { -n, c, 0.0f }, { 0.0f, 0.0f, s }, { float32(t.x), float32(t.y), float32(t.z) } } };
+}
+
+Vec RandomDirection(std::mt19937 &rnd)
+{
+	std::normal_distribution<float64> d;
+	Vec v{ d(rnd), d(rnd), d(rnd) };
+	float64 l = Length(v);
+	return l > 0.0 ? Vec{ v.x / l, v.y / l, v.z / l } : Vec{ 0.0, 0.0, 1.0 };
+}
+
+// Checks the partition and bounds of meshlets built from mesh with given options.
+void CheckMeshlets(const Mesh &mesh, const MeshletOptions &options, uint32 indexOffset, const char *what)
+{
+	MeshletList meshlets;
+	List<uint32> dst(mesh.indices.size());
+	meshoptimization::BuildMeshlets(meshlets, dst.data(), mesh.indices.data(), mesh.indices.size(), mesh.Positions(), sizeof(float32) * 3, mesh.VertexCount(), indexOffset, options);
+
+	uint32 maxVertices = std::max(options.maxVertices, 3u), maxTriangles = std::max(options.maxTriangles, 1u);
+	bool contiguous = !meshlets.empty() && meshlets.front().startIndex == indexOffset, limits = true, counts = true, bounds = true, cones = true, axes = true;
+	size_t next = indexOffset, cullable = 0;
+	for (const Meshlet &m : meshlets) {
+		contiguous = contiguous && m.startIndex == next && m.indexCount > 0 && m.indexCount % 3 == 0;
+		next = m.startIndex + m.indexCount;
+		if (m.startIndex < indexOffset || next - indexOffset > dst.size())
+			break;
+		const uint32 *tris = dst.data() + (m.startIndex - indexOffset);
+
+		limits = limits && m.indexCount / 3 <= maxTriangles && m.vertexCount <= maxVertices;
+		counts = counts && CountVertices(tris, m.indexCount) == m.vertexCount;
+
+		Vec center{ m.center.x, m.center.y, m.center.z };
+		for (uint32 i = 0; i < m.indexCount; i++)
+			bounds = bounds && Length(Position(mesh, tris[i]) - center) <= m.radius * (1.0 + 1e-5) + 1e-6;
+
+		Vec axis{ m.coneAxis.x, m.coneAxis.y, m.coneAxis.z };
+		axes = axes && std::abs(Length(axis) - 1.0) < 1e-4;
+		if (m.coneCutoff < 1.0f) {
+			// Every normal is within the half angle of the cone, whose cosine is sqrt(1 - cutoff^2).
+			cullable++;
+			float64 minDot = std::sqrt(1.0 - float64(m.coneCutoff) * m.coneCutoff);
+			for (uint32 i = 0; i < m.indexCount; i += 3) {
+				Vec n = Normal(mesh, tris + i);
+				float64 l = Length(n);
+				if (l > 1e-12)
+					cones = cones && Dot(n, axis) / l >= minDot - 1e-4;
+			}
+		}
+	}
+
+	std::string s(what);
+	Check(contiguous && next == indexOffset + dst.size(), (s + ": meshlets cover the indices in order").c_str());
+	Check(SameTriangles(mesh.indices, dst), (s + ": same triangles with the same winding").c_str());
+	Check(limits, (s + ": vertex and triangle limits").c_str());
+	Check(counts, (s + ": vertex counts").c_str());
+	Check(bounds, (s + ": vertices within the bounding sphere").c_str());
+	Check(axes, (s + ": unit cone axes").c_str());
+	Check(cones, (s + ": normals within the cones").c_str());
+	printf("  %s: %u meshlets, %u with cones\n", what, uint32(meshlets.size()), uint32(cullable));
+}
+
+}
+
+
+void TestVertexCache()
+{
+	printf("Vertex cache\n");
+	std::mt19937 rnd(42);
+	Mesh grid = MakeGrid(40);
+	List<uint32> shuffled = Shuffled(grid.indices, rnd);
+	VertexCacheStats before = meshoptimization::AnalyzeVertexCache(shuffled.data(), shuffled.size(), grid.VertexCount());
+
+	List<uint32> out(shuffled.size());
+	meshoptimization::OptimizeVertexCache(out.data(), shuffled.data(), shuffled.size(), grid.VertexCount());
+	VertexCacheStats after = meshoptimization::AnalyzeVertexCache(out.data(), out.size(), grid.VertexCount());
+	printf("  ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", before.acmr, after.acmr, before.atvr, after.atvr);
+
+	Check(SameTriangles(shuffled, out), "same triangles with the same winding");
+	Check(after.acmr < before.acmr * 0.5f, "ACMR at least halved");
+	// Every referenced vertex is transformed at least once.
+	Check(after.acmr >= float32(grid.VertexCount()) / float32(grid.TriangleCount()) - 1e-4f && after.atvr >= 1.0f - 1e-4f, "ACMR and ATVR lower bounds");
+
+	List<uint32> inPlace = shuffled;
+	meshoptimization::OptimizeVertexCache(inPlace.data(), inPlace.data(), inPlace.size(), grid.VertexCount());
+	Check(inPlace == out, "in place");
+
+	VertexCacheStats empty = meshoptimization::AnalyzeVertexCache(nullptr, 0, grid.VertexCount());
+	Check(empty.acmr == 0.0f && empty.atvr == 0.0f, "empty");
+}
+
+void TestOverdraw()
+{
+	printf("Overdraw\n");
+	std::mt19937 rnd(7);
+	Mesh sphere = MakeCubeSphere(16);
+	List<uint32> indices = Shuffled(sphere.indices, rnd);
+	meshoptimization::OptimizeVertexCache(indices.data(), indices.data(), indices.size(), sphere.VertexCount());
+	VertexCacheStats before = meshoptimization::AnalyzeVertexCache(indices.data(), indices.size(), sphere.VertexCount());
+
+	const float32 threshold = 1.05f;
+	List<uint32> out(indices.size());
+	meshoptimization::OptimizeOverdraw(out.data(), indices.data(), indices.size(), sphere.Positions(), sizeof(float32) * 3, sphere.VertexCount(), threshold);
+	VertexCacheStats after = meshoptimization::AnalyzeVertexCache(out.data(), out.size(), sphere.VertexCount());
+	printf("  ACMR %.3f -> %.3f\n", before.acmr, after.acmr);
+
+	Check(SameTriangles(indices, out), "same triangles with the same winding");
+	Check(after.acmr <= before.acmr * threshold + 1e-4f, "ACMR within the threshold");
+}
+
+void TestVertexFetch()
+{
+	printf("Vertex fetch\n");
+	std::mt19937 rnd(3);
+	Mesh grid = MakeGrid(20);
+	const size_t unused = 10, vertexCount = grid.VertexCount() + unused;
+	// Reference the vertices in random order, leaving the last ones unused.
+	List<uint32> shuffle(grid.VertexCount());
+	for (uint32 i = 0; i < shuffle.size(); i++)
+		shuffle[i] = i;
+	std::shuffle(shuffle.begin(), shuffle.end(), rnd);
+	List<uint32> indices = grid.indices;
+	for (uint32 &v : indices)
+		v = shuffle[v];
+
+	List<uint32> remap(vertexCount, 0);
+	size_t count = meshoptimization::OptimizeVertexFetchRemap(remap.data(), indices.data(), indices.size(), vertexCount);
+	Check(count == grid.VertexCount(), "returns the referenced vertex count");
+
+	bool firstUse = true;
+	uint32 next = 0;
+	List<uint8> seen(vertexCount, 0);
+	for (uint32 v : indices) {
+		if (!seen[v]) {
+			seen[v] = 1;
+			firstUse = firstUse && remap[v] == next++;
+		}
+		else
+			firstUse = firstUse && remap[v] < next;
+	}
+	Check(firstUse, "vertices ordered by first use");
+	bool unreferenced = true;
+	for (size_t v = grid.VertexCount(); v < vertexCount; v++)
+		unreferenced = unreferenced && remap[v] == uint32(-1);
+	Check(unreferenced, "unreferenced vertices get -1");
+
+	const uint32 strip[] = { 4, 2, 4, uint32(-1), 0, 2 };
+	List<uint32> stripRemap(5, 0);
+	count = meshoptimization::OptimizeVertexFetchRemap(stripRemap.data(), strip, 6, 5);
+	Check(count == 3 && stripRemap[4] == 0 && stripRemap[2] == 1 && stripRemap[0] == 2 && stripRemap[1] == uint32(-1) && stripRemap[3] == uint32(-1), "strip cuts are ignored");
+}
+
+void TestMeshlets()
+{
+	printf("Meshlets\n");
+	Mesh sphere = MakeCubeSphere(12);
+	Mesh grid = MakeGrid(24);
+
+	MeshletOptions defaults;
+	MeshletOptions small;
+	small.maxVertices = 32;
+	small.maxTriangles = 32;
+	MeshletOptions minimal;
+	minimal.maxVertices = 3;
+	minimal.maxTriangles = 1;
+	MeshletOptions compact;
+	compact.maxVertices = 128;
+	compact.maxTriangles = 256;
+	compact.coneWeight = 0.0f;
+	MeshletOptions belowLimits; // Raised to 3 vertices and 1 triangle.
+	belowLimits.maxVertices = 0;
+	belowLimits.maxTriangles = 0;
+
+	CheckMeshlets(sphere, defaults, 0, "sphere 64/124");
+	CheckMeshlets(sphere, small, 0, "sphere 32/32");
+	CheckMeshlets(sphere, minimal, 0, "sphere 3/1");
+	CheckMeshlets(sphere, compact, 0, "sphere 128/256, no cone weight");
+	CheckMeshlets(sphere, defaults, 999, "sphere with index offset");
+	CheckMeshlets(grid, defaults, 0, "grid 64/124");
+	CheckMeshlets(grid, belowLimits, 0, "grid 0/0");
+
+	MeshletList meshlets;
+	meshoptimization::BuildMeshlets(meshlets, nullptr, nullptr, 0, sphere.Positions(), sizeof(float32) * 3, sphere.VertexCount());
+	Check(meshlets.empty(), "no triangles, no meshlets");
+}
+
+void TestCullMeshlets()
+{
+	printf("Cull meshlets\n");
+	std::mt19937 rnd(11);
+	Mesh sphere = MakeCubeSphere(12);
+	MeshletList meshlets;
+	List<uint32> dst(sphere.indices.size());
+	meshoptimization::BuildMeshlets(meshlets, dst.data(), sphere.indices.data(), sphere.indices.size(), sphere.Positions(), sizeof(float32) * 3, sphere.VertexCount());
+	uint32 indexCount = uint32(dst.size());
+
+	{
+		MeshletDrawList drawList;
+		MeshletCullStats stats;
+		meshoptimization::CullMeshlets(drawList, meshlets.data(), meshlets.size(), XMMatrixIdentity(), nullptr, nullptr, &stats);
+		Check(drawList.size() == 1 && drawList[0].startIndex == 0 && drawList[0].indexCount == indexCount, "no culling draws one range");
+		Check(stats.meshletCount == meshlets.size() && stats.frustumCulled == 0 && stats.backFaceCulled == 0 && stats.drawCount == 1 && stats.indexCount == indexCount, "no culling stats");
+	}
+
+	// A meshlet may only be culled if all its triangles face away from the camera.
+	const World worlds[] = { MakeWorld(1.0f, 0.0f, Vec{ 0.0, 0.0, 0.0 }), MakeWorld(2.5f, 0.7f, Vec{ 3.0, -1.0, 2.0 }) };
+	bool conservative = true, consistent = true;
+	uint32 culled = 0, tested = 0;
+	for (const World &world : worlds) {
+		XMMATRIX m = world.Matrix();
+		Vec center = world.Transform(Vec{ 0.0, 0.0, 0.0 });
+		float64 scale = Length(Vec{ world.m[0][0], world.m[0][1], world.m[0][2] });
+		for (uint32 i = 0; i < 40; i++) {
+			Vec dir = RandomDirection(rnd);
+			float64 distance = scale * (i < 5 ? 0.5 : 1.1 + 0.2 * i); // A few from inside the sphere.
+			XMFLOAT3 eye(float32(center.x + dir.x * distance), float32(center.y + dir.y * distance), float32(center.z + dir.z * distance));
+			Vec e{ eye.x, eye.y, eye.z };
+
+			uint32 culledHere = 0, indicesHere = 0;
+			for (const Meshlet &meshlet : meshlets) {
+				MeshletDrawList drawList;
+				meshoptimization::CullMeshlets(drawList, &meshlet, 1, m, nullptr, &eye);
+				tested++;
+				if (!drawList.empty()) {
+					indicesHere += meshlet.indexCount;
+					continue;
+				}
+				culled++;
+				culledHere++;
+				for (uint32 t = meshlet.startIndex; t < meshlet.startIndex + meshlet.indexCount; t += 3) {
+					Vec a = world.Transform(Position(sphere, dst[t])), b = world.Transform(Position(sphere, dst[t + 1])), c = world.Transform(Position(sphere, dst[t + 2]));
+					Vec n = Cross(b - a, c - a);
+					float64 l = Length(n);
+					if (l > 1e-12)
+						conservative = conservative && Dot(a - e, n) / l >= -1e-4 * (1.0 + Length(a - e));
+				}
+			}
+
+			// Culling all at once gives the same result, with adjacent meshlets merged.
+			MeshletDrawList drawList;
+			MeshletCullStats stats;
+			meshoptimization::CullMeshlets(drawList, meshlets.data(), meshlets.size(), m, nullptr, &eye, &stats);
+			uint32 drawn = 0, end = 0;
+			bool ordered = true;
+			for (size_t j = 0; j < drawList.size(); j++) {
+				ordered = ordered && drawList[j].startIndex >= end && (j == 0 || drawList[j].startIndex > end);
+				end = drawList[j].startIndex + drawList[j].indexCount;
+				drawn += drawList[j].indexCount;
+			}
+			consistent = consistent && ordered && stats.backFaceCulled == culledHere && stats.indexCount == indicesHere && drawn == indicesHere && stats.drawCount == drawList.size() && stats.meshletCount == meshlets.size();
+		}
+	}
+	printf("  %u of %u meshlets culled\n", culled, tested);
+	Check(conservative, "culled meshlets face away from the camera");
+	Check(culled > 0, "some meshlets are culled");
+	Check(consistent, "culling all meshlets at once matches culling them one by one");
+
+	// Non-uniform scale and mirroring do not preserve the cones, so they disable back face culling.
+	const World skipped[] = { World{ { { 1.0f, 0.0f, 0.0f }, { 0.0f, 2.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } } }, World{ { { -1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f, 0.0f } } } };
+	MeshletCullStats stats;
+	for (const World &world : skipped) {
+		for (uint32 i = 0; i < 10; i++) {
+			Vec dir = RandomDirection(rnd);
+			XMFLOAT3 eye(float32(dir.x * 5.0), float32(dir.y * 5.0), float32(dir.z * 5.0));
+			MeshletDrawList drawList;
+			meshoptimization::CullMeshlets(drawList, meshlets.data(), meshlets.size(), world.Matrix(), nullptr, &eye, &stats);
+		}
+	}
+	Check(stats.backFaceCulled == 0 && stats.indexCount == indexCount * 20, "no back face culling with non-uniform scale or mirroring");
+}
+
+void TestSimplify()
+{
+	printf("Simplify\n");
+	const size_t stride = sizeof(float32) * 3;
+
+	// A flat grid can be reduced a lot without error, but the corners and the covered area must stay.
+	Mesh grid = MakeGrid(32);
+	for (bool lockBorders : { false, true }) {
+		const char *what = lockBorders ? "grid, locked borders" : "grid";
+		List<uint32> out(grid.indices.size());
+		float32 error = -1.0f;
+		size_t count = meshoptimization::Simplify(out.data(), grid.indices.data(), grid.indices.size(), grid.Positions(), stride, grid.VertexCount(), nullptr, 0, 0, nullptr, nullptr, grid.indices.size() / 4, 0.01f, lockBorders, &error);
+		out.resize(count);
+		float32 hausdorff = meshoptimization::MeasureHausdorffDistance(grid.Positions(), stride, grid.VertexCount(), grid.indices.data(), grid.indices.size(), out.data(), out.size());
+		printf("  %s: %u -> %u triangles, error %g, Hausdorff %g\n", what, uint32(grid.TriangleCount()), uint32(count / 3), error, hausdorff);
+
+		float64 area = 0.0;
+		bool facing = true;
+		for (size_t i = 0; i < out.size(); i += 3) {
+			Vec n = Normal(grid, out.data() + i);
+			area += 0.5 * Length(n);
+			facing = facing && n.z >= 0.0;
+		}
+		Check(ValidIndices(out.data(), out.size(), grid.VertexCount()), (std::string(what) + ": valid indices").c_str());
+		Check(count > 0 && count <= grid.indices.size() / 4, (std::string(what) + ": reaches the target").c_str());
+		Check(error >= 0.0f && error < 1e-4f && hausdorff < 1e-4f, (std::string(what) + ": no error").c_str());
+		Check(facing && std::abs(area - 1.0) < 1e-4, (std::string(what) + ": no flipped triangles, same area").c_str());
+
+		if (lockBorders) {
+			bool kept = true;
+			List<uint8> used(grid.VertexCount(), 0);
+			for (uint32 v : out)
+				used[v] = 1;
+			for (uint32 y = 0; y <= 32; y++)
+				for (uint32 x = 0; x <= 32; x++)
+					if (x == 0 || y == 0 || x == 32 || y == 32)
+						kept = kept && used[y * 33 + x];
+			Check(kept, "locked border vertices are kept");
+		}
+	}
+
+	// On a curved surface the error bound stops the reduction. The extent of the unit sphere is 2.
+	Mesh sphere = MakeCubeSphere(16);
+	for (float32 targetError : { 0.001f, 0.01f, 0.05f }) {
+		List<uint32> out(sphere.indices.size());
+		float32 error = -1.0f;
+		size_t count = meshoptimization::Simplify(out.data(), sphere.indices.data(), sphere.indices.size(), sphere.Positions(), stride, sphere.VertexCount(), nullptr, 0, 0, nullptr, nullptr, 0, targetError, false, &error);
+		out.resize(count);
+		printf("  sphere, target error %g: %u -> %u triangles, error %g\n", targetError, uint32(sphere.TriangleCount()), uint32(count / 3), error);
+
+		bool outwards = true;
+		for (size_t i = 0; i < out.size(); i += 3) {
+			Vec n = Normal(sphere, out.data() + i);
+			Vec a = Position(sphere, out[i]);
+			if (Length(n) > 1e-12)
+				outwards = outwards && Dot(n, a) > 0.0;
+		}
+		std::string s = "sphere, target error " + std::to_string(targetError);
+		Check(ValidIndices(out.data(), out.size(), sphere.VertexCount()) && count > 0, (s + ": valid indices").c_str());
+		Check(count < sphere.indices.size(), (s + ": reduced").c_str());
+		Check(error >= 0.0f && error <= targetError * 2.0f * 1.0001f, (s + ": error within the target").c_str());
+		Check(outwards, (s + ": no flipped triangles").c_str());
+	}
+
+	List<uint32> copy(sphere.indices.size());
+	Check(meshoptimization::Simplify(copy.data(), sphere.indices.data(), sphere.indices.size(), sphere.Positions(), stride, sphere.VertexCount(), nullptr, 0, 0, nullptr, nullptr, sphere.indices.size(), 0.1f) == sphere.indices.size() && copy == sphere.indices, "target not below the input keeps it as is");
+	Check(meshoptimization::MeasureHausdorffDistance(sphere.Positions(), stride, sphere.VertexCount(), sphere.indices.data(), sphere.indices.size(), sphere.indices.data(), sphere.indices.size()) < 1e-6f, "no distance to itself");
+}
+
+
+int main(int argc, char *argv[])
+{
+	if (argc > 1) {
+		printf("Usage: MeshOptimizationTest\n"
+			"Runs the unit tests for the mesh optimizations (GraphicsChips/MeshOptimization.h) on generated meshes.\n");
+		return 1;
+	}
+
+	TestVertexCache();
+	TestOverdraw();
+	TestVertexFetch();
+	TestMeshlets();
+	TestCullMeshlets();
+	TestSimplify();
+
+	return Report();
+}
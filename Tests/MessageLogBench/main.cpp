@@ -0,0 +1,314 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "M3DCore/MessageLog.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace m3d;
+
+
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+// Formats a line like Engine does when writing the message file.
+void FormatLine(std::string &out, uint32 severity, time_t t, uint32 threadID, const String &message)
+{
+	static const char *MSG[6] = { " - DEBUG: ", " - INFO: ", " - NOTICE: ", " - WARNING: ", " - FATAL: ", " - " };
+	char buff[96];
+	tm tt;
+#ifdef _WIN32
+	localtime_s(&tt, &t);
+#else
+	localtime_r(&t, &tt);
+#endif
+	size_t n = strftime(buff, 64, "%d/%m/%y %H:%M:%S", &tt);
+	snprintf(buff + n, sizeof(buff) - n, " [%5u]", threadID);
+	out += buff;
+	out += MSG[std::min(severity, 5u)];
+	out.append(message.data(), message.size());
+	out += '\n';
+}
+
+// The way Engine::Message used to work: Everything done by the posting thread under a lock.
+class SyncLog
+{
+public:
+	SyncLog(const std::string &file) : _file(file) {}
+
+	void Post(uint32 severity, String message, uint32, uint32)
+	{
+		std::lock_guard<std::mutex> lock(_lock);
+		std::string line;
+		FormatLine(line, severity, time(0), (uint32)std::hash<std::thread::id>()(std::this_thread::get_id()), message);
+		_file << line;
+		_file.flush();
+		_delivered++;
+	}
+
+	uint64 GetDelivered() const { return _delivered; }
+
+private:
+	std::mutex _lock;
+	std::ofstream _file;
+	uint64 _delivered = 0;
+};
+
+// Sink writing each batch to the file with a single write and flush.
+class FileSink
+{
+public:
+	FileSink(const std::string &file) : _file(file) {}
+
+	void operator()(const MessageRecord *records, size_t count)
+	{
+		_buffer.clear();
+		for (size_t i = 0; i < count; i++)
+			FormatLine(_buffer, records[i].severity, records[i].timestamp, records[i].threadID, records[i].message);
+		_file << _buffer;
+		_file.flush();
+		_delivered += count;
+		_batches++;
+	}
+
+	uint64 GetDelivered() const { return _delivered; }
+	uint64 GetBatches() const { return _batches; }
+
+private:
+	std::ofstream _file;
+	std::string _buffer;
+	std::atomic<uint64> _delivered = 0;
+	std::atomic<uint64> _batches = 0;
+};
+
+struct Result
+{
+	std::string mode;
+	uint32 threads = 0;
+	uint64 messages = 0;
+	double postTime = 0.0; // Seconds until all threads had posted their messages.
+	double totalTime = 0.0; // Seconds until all messages were written.
+	double meanLatency = 0.0; // Nanoseconds per Post() call.
+	double p50 = 0.0, p99 = 0.0, p999 = 0.0, maxLatency = 0.0;
+	uint64 delivered = 0, folded = 0, suppressed = 0, dropped = 0, batches = 0;
+};
+
+// Runs threads posting messages, recording the latency of every call.
+template<typename POST>
+void RunThreads(Result &r, uint32 threads, uint64 messages, bool repeated, POST post)
+{
+	std::vector<std::vector<uint32>> latencies(threads);
+	std::vector<std::thread> workers;
+	std::atomic<uint32> ready = 0;
+	std::atomic<bool> go = false;
+
+	for (uint32 i = 0; i < threads; i++) {
+		workers.push_back(std::thread([&, i]() {
+			std::vector<uint32> &l = latencies[i];
+			l.reserve(messages);
+			ready++;
+			while (!go)
+				std::this_thread::yield();
+			for (uint64 j = 0; j < messages; j++) {
+				// The caller formats the message in any case, so that is not part of the measurement.
+				String m = repeated ? String("Value out of range.") : String("Value ") + std::to_string(j).c_str() + " out of range.";
+				auto start = Clock::now();
+				post(3, std::move(m), 1, repeated ? i + 1 : 0);
+				l.push_back((uint32)std::min<int64>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count(), 0xFFFFFFFF));
+			}
+		}));
+	}
+	while (ready < threads)
+		std::this_thread::yield();
+	auto start = Clock::now();
+	go = true;
+	for (std::thread &t : workers)
+		t.join();
+	r.postTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::vector<uint32> all;
+	for (const auto &l : latencies)
+		all.insert(all.end(), l.begin(), l.end());
+	std::sort(all.begin(), all.end());
+	double sum = 0.0;
+	for (uint32 v : all)
+		sum += v;
+	auto percentile = [&](double p) { return all.empty() ? 0.0 : (double)all[std::min(all.size() - 1, (size_t)(p * all.size()))]; };
+	r.threads = threads;
+	r.messages = all.size();
+	r.meanLatency = all.empty() ? 0.0 : sum / all.size();
+	r.p50 = percentile(0.5);
+	r.p99 = percentile(0.99);
+	r.p999 = percentile(0.999);
+	r.maxLatency = all.empty() ? 0.0 : all.back();
+}
+
+Result RunSync(const std::string &file, uint32 threads, uint64 messages, bool repeated)
+{
+	Result r;
+	r.mode = repeated ? "sync_repeated" : "sync";
+	SyncLog log(file);
+	auto start = Clock::now();
+	RunThreads(r, threads, messages, repeated, [&](uint32 severity, String m, uint32 clazzID, uint32 chipID) { log.Post(severity, std::move(m), clazzID, chipID); });
+	r.totalTime = std::chrono::duration<double>(Clock::now() - start).count();
+	r.delivered = log.GetDelivered();
+	return r;
+}
+
+Result RunAsync(const std::string &file, uint32 threads, uint64 messages, bool repeated, const MessageLogSettings &settings)
+{
+	Result r;
+	r.mode = repeated ? "async_repeated" : "async";
+	FileSink sink(file);
+	auto start = Clock::now();
+	{
+		MessageLog log([&sink](const MessageRecord *records, size_t count) { sink(records, count); }, settings);
+		RunThreads(r, threads, messages, repeated, [&](uint32 severity, String m, uint32 clazzID, uint32 chipID) { log.Post(severity, std::move(m), clazzID, chipID); });
+		log.Flush();
+		r.totalTime = std::chrono::duration<double>(Clock::now() - start).count();
+		r.folded = log.GetFoldedCount();
+		r.suppressed = log.GetSuppressedCount();
+		r.dropped = log.GetDroppedCount();
+	}
+	r.delivered = sink.GetDelivered();
+	r.batches = sink.GetBatches();
+	return r;
+}
+
+void PrintUsage()
+{
+	std::cout <<
+		"Usage: MessageLogBench [options]\n"
+		"  Posts messages from several threads, measuring the latency of each call.\n"
+		"  -threads <n,n,..>  Thread counts (default 1,2,4,8).\n"
+		"  -messages <n>      Messages per thread (default 100000).\n"
+		"  -capacity <n>      Ring capacity per thread for the asynchronous log (default messages per thread, so that\n"
+		"                     nothing is dropped). Dropped messages are reported next to the latencies.\n"
+		"  -ratelimit <n>     Messages per chip per second for the asynchronous log (default 100).\n"
+		"  -log <file>        File the messages are written to (default a temporary file, removed afterwards).\n"
+		"  -out <file>        Write the JSON report to the given file instead of stdout.\n"
+		"\n"
+		"Modes:\n"
+		"  sync               Formatting, writing and flushing under a lock by the posting thread.\n"
+		"  async              MessageLog with a distinct message every call.\n"
+		"  sync_repeated      As sync, but each thread posts the same message for its own chip.\n"
+		"  async_repeated     As async, but each thread posts the same message for its own chip.\n";
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::vector<uint32> threadCounts = { 1, 2, 4, 8 };
+	uint64 messages = 100000;
+	MessageLogSettings settings;
+	settings.ringCapacity = 0;
+	std::string logFile, out;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "-threads" && i + 1 < argc) {
+			threadCounts.clear();
+			std::stringstream ss(argv[++i]);
+			for (std::string t; std::getline(ss, t, ',');)
+				threadCounts.push_back((uint32)std::max(1, std::atoi(t.c_str())));
+		}
+		else if (a == "-messages" && i + 1 < argc)
+			messages = (uint64)std::max(1ll, std::atoll(argv[++i]));
+		else if (a == "-capacity" && i + 1 < argc)
+			settings.ringCapacity = (uint32)std::max(2, std::atoi(argv[++i]));
+		else if (a == "-ratelimit" && i + 1 < argc)
+			settings.rateLimit = (uint32)std::max(0, std::atoi(argv[++i]));
+		else if (a == "-log" && i + 1 < argc)
+			logFile = argv[++i];
+		else if (a == "-out" && i + 1 < argc)
+			out = argv[++i];
+		else {
+			PrintUsage();
+			return a == "-help" || a == "-h" ? 0 : 1;
+		}
+	}
+
+	// A ring holding all messages of a thread. With a smaller ring, the latencies of dropped messages are those of
+	// a full ring, which is cheaper than a real post.
+	if (settings.ringCapacity == 0)
+		settings.ringCapacity = (uint32)std::min<uint64>(messages, 1u << 24);
+
+	bool removeLog = logFile.empty();
+	if (removeLog)
+		logFile = (std::filesystem::temp_directory_path() / "MessageLogBench.log").string();
+
+	std::vector<Result> results;
+	for (uint32 threads : threadCounts) {
+		for (bool repeated : { false, true }) {
+			results.push_back(RunSync(logFile, threads, messages, repeated));
+			results.push_back(RunAsync(logFile, threads, messages, repeated, settings));
+		}
+	}
+
+	if (removeLog)
+		std::filesystem::remove(logFile);
+
+	std::stringstream json;
+	json << "{\n  \"messages_per_thread\": " << messages << ",\n  \"ring_capacity\": " << settings.ringCapacity << ",\n  \"rate_limit\": " << settings.rateLimit << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		json << "    { \"mode\": \"" << r.mode << "\", \"threads\": " << r.threads << ", \"messages\": " << r.messages
+			<< ", \"post_ms\": " << r.postTime * 1000.0 << ", \"total_ms\": " << r.totalTime * 1000.0
+			<< ", \"mean_ns\": " << r.meanLatency << ", \"p50_ns\": " << r.p50 << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999 << ", \"max_ns\": " << r.maxLatency << ", \"dropped\": " << r.dropped
+			<< ", \"written\": " << r.delivered << ", \"batches\": " << r.batches << ", \"folded\": " << r.folded << ", \"suppressed\": " << r.suppressed
+			<< " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		std::cerr << r.mode << " x" << r.threads << ": mean " << r.meanLatency << " ns, p99 " << r.p99 << " ns, max " << r.maxLatency << " ns, dropped " << r.dropped << " of " << r.messages
+			<< ", folded " << r.folded << ", suppressed " << r.suppressed << ", written " << r.delivered << "\n";
+	}
+	json << "  ]\n}\n";
+
+	if (out.empty())
+		std::cout << json.str();
+	else {
+		std::ofstream f(out);
+		f << json.str();
+		if (!f) {
+			std::cerr << "Failed to write " << out << "\n";
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,207 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "NumberBenchmark.h"
+#include "M3DCore/Clock.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <cstring>
+
+using namespace m3d;
+
+
+// The reference implementation of fromNum() for the default formats.
+template<typename T>
+static String ReferenceFromNum(T v, const Char *fmt)
+{
+	if (v != v)
+		return MTEXT("nan");
+	else if (v < -std::numeric_limits<T>::max())
+		return MTEXT("-inf");
+	else if (v > std::numeric_limits<T>::max())
+		return MTEXT("+inf");
+	else if (v == -std::numeric_limits<T>::max())
+		return MTEXT("-max");
+	else if (v == std::numeric_limits<T>::max())
+		return MTEXT("+max");
+	else if (v < std::numeric_limits<T>::min() && v > -std::numeric_limits<T>::min())
+		return strUtils::format(fmt, 0.0);
+	return strUtils::format(fmt, v);
+}
+static String ReferenceFromNum(float32 v) { return ReferenceFromNum(v, MTEXT("%.9g")); }
+static String ReferenceFromNum(float64 v) { return ReferenceFromNum(v, MTEXT("%.17g")); }
+static String ReferenceFromNum(int32 v) { return strUtils::format(MTEXT("%i"), v); }
+
+// The reference implementation of toNum(). Only floats have special values.
+template<typename T>
+static bool ReferenceToNum(const String &s, T &v)
+{
+	if constexpr (std::is_floating_point<T>::value) {
+		if (s == MTEXT("nan")) { v = std::numeric_limits<T>::quiet_NaN(); return true; }
+		if (s == MTEXT("+inf")) { v = std::numeric_limits<T>::infinity(); return true; }
+		if (s == MTEXT("-inf")) { v = -std::numeric_limits<T>::infinity(); return true; }
+		if (s == MTEXT("+max")) { v = std::numeric_limits<T>::max(); return true; }
+		if (s == MTEXT("-max")) { v = -std::numeric_limits<T>::max(); return true; }
+	}
+	return strUtils::__toNumFromString(s, v, strUtils::NumBase::DEC);
+}
+
+// The reference tokenizer, strtok_s() on Windows.
+static Char *ReferenceTokenize(Char *str, const Char *delimiters, Char **context)
+{
+#ifdef _WIN32
+	return strtok_s(str, delimiters, context);
+#else
+	return strtok_r(str, delimiters, context);
+#endif
+}
+
+template<typename T>
+static bool Same(T a, T b) { return a == b || (a != a && b != b); }
+
+template<typename T>
+void NumberBenchmark::_run(const List<T> &numbers, const Char *type, uint32 iterations, List<NumberBenchmarkResult> &results)
+{
+	NumberBenchmarkResult format, parse, parseList;
+	format.type = parse.type = parseList.type = type;
+	format.operation = MTEXT("format");
+	parse.operation = MTEXT("parse");
+	parseList.operation = MTEXT("parseList");
+	format.count = parse.count = parseList.count = (uint32)numbers.size();
+	format.referenceTime = format.time = parse.referenceTime = parse.time = parseList.referenceTime = parseList.time = std::numeric_limits<float64>::max();
+
+	List<String> texts(numbers.size());
+	String list;
+	for (size_t i = 0; i < numbers.size(); i++) {
+		texts[i] = ReferenceFromNum(numbers[i]);
+		list += texts[i] + MTEXT(" ");
+	}
+
+	for (size_t i = 0; i < numbers.size(); i++)
+		if (strUtils::fromNum(numbers[i]) != texts[i])
+			format.mismatches++;
+	for (size_t i = 0; i < numbers.size(); i++) {
+		T a = T(0), b = T(0);
+		bool ra = ReferenceToNum(texts[i], a);
+		bool rb = strUtils::toNum(texts[i], b);
+		if (ra != rb || !Same(a, b))
+			parse.mismatches++;
+	}
+
+	List<T> reference, parsed;
+	reference.reserve(numbers.size());
+	parsed.reserve(numbers.size());
+
+	volatile size_t sink = 0; // Keep the optimizer from removing the work.
+
+	for (uint32 i = 0; i < iterations; i++) {
+		int64 t = Clock::GetTime_ns();
+		for (const T &v : numbers)
+			sink = sink + ReferenceFromNum(v).size();
+		format.referenceTime = std::min(format.referenceTime, Clock::ToSeconds(Clock::GetTime_ns() - t));
+
+		t = Clock::GetTime_ns();
+		for (const T &v : numbers)
+			sink = sink + strUtils::fromNum(v).size();
+		format.time = std::min(format.time, Clock::ToSeconds(Clock::GetTime_ns() - t));
+
+		T v;
+		t = Clock::GetTime_ns();
+		for (const String &s : texts)
+			sink = sink + ReferenceToNum(s, v);
+		parse.referenceTime = std::min(parse.referenceTime, Clock::ToSeconds(Clock::GetTime_ns() - t));
+
+		t = Clock::GetTime_ns();
+		for (const String &s : texts)
+			sink = sink + strUtils::toNum(s, v);
+		parse.time = std::min(parse.time, Clock::ToSeconds(Clock::GetTime_ns() - t));
+
+		// The way the XML document loader used to read number lists.
+		String tmp = list;
+		reference.clear();
+		t = Clock::GetTime_ns();
+		for (Char *co = 0, *token = ReferenceTokenize(tmp.data(), MTEXT(" "), &co); token; token = ReferenceTokenize(0, MTEXT(" "), &co))
+			if (ReferenceToNum(String(token), v))
+				reference.push_back(v);
+		parseList.referenceTime = std::min(parseList.referenceTime, Clock::ToSeconds(Clock::GetTime_ns() - t));
+
+		parsed.clear();
+		t = Clock::GetTime_ns();
+		strUtils::toNums<T>(list, parsed, MTEXT(""));
+		parseList.time = std::min(parseList.time, Clock::ToSeconds(Clock::GetTime_ns() - t));
+	}
+
+	parseList.mismatches = (uint32)std::abs((int64)reference.size() - (int64)parsed.size());
+	for (size_t i = 0, j = std::min(reference.size(), parsed.size()); i < j; i++)
+		if (!Same(reference[i], parsed[i]))
+			parseList.mismatches++;
+
+	results.push_back(format);
+	results.push_back(parse);
+	results.push_back(parseList);
+}
+
+List<NumberBenchmarkResult> NumberBenchmark::Run(uint32 count, uint32 iterations)
+{
+	iterations = std::max(iterations, 1u);
+
+	std::mt19937_64 rng(12345); // Fixed seed so that runs are comparable.
+	std::uniform_real_distribution<float64> mantissa(-1.0, 1.0);
+	std::uniform_int_distribution<int32> exponent(-40, 40);
+
+	List<float64> f64(count);
+	List<float32> f32(count);
+	List<int32> i32(count);
+	for (uint32 i = 0; i < count; i++) {
+		// Mostly typical document values (positions, colors, angles), with a few of extreme magnitude.
+		float64 d = mantissa(rng) * (i % 16 == 0 ? std::pow(10.0, exponent(rng)) : 1000.0);
+		f64[i] = d;
+		f32[i] = (float32)d;
+		i32[i] = (int32)(rng() >> 32);
+	}
+	const float64 special[] = { 0.0, -0.0, 1.0, -1.0, 0.1, 1e-310, 1e300, std::numeric_limits<float32>::min(), std::numeric_limits<float32>::denorm_min() };
+	for (uint32 i = 0; i < std::size(special) && i < count; i++) {
+		f64[i] = special[i];
+		f32[i] = (float32)special[i];
+	}
+
+	List<NumberBenchmarkResult> results;
+	_run(f32, MTEXT("float32"), iterations, results);
+	_run(f64, MTEXT("float64"), iterations, results);
+	_run(i32, MTEXT("int32"), iterations, results);
+	return results;
+}
+
+String NumberBenchmark::ToJSON(const List<NumberBenchmarkResult> &results)
+{
+	String s = MTEXT("\t\"numbers\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		const NumberBenchmarkResult &r = results[i];
+		s += strUtils::format(MTEXT("\t\t{ \"type\": \"%s\", \"operation\": \"%s\", \"count\": %u, \"referenceTimeMs\": %.3f, \"timeMs\": %.3f, \"speedup\": %.2f, \"mismatches\": %u }%s\n"),
+			r.type.c_str(), r.operation.c_str(), r.count, r.referenceTime * 1000.0, r.time * 1000.0, r.time > 0.0 ? r.referenceTime / r.time : 0.0, r.mismatches, i + 1 < results.size() ? MTEXT(",") : MTEXT(""));
+	}
+	s += MTEXT("\t]");
+	return s;
+}
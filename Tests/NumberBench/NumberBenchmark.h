@@ -0,0 +1,57 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#pragma once
+
+#include "M3DCore/MString.h"
+#include "M3DCore/Containers.h"
+
+namespace m3d
+{
+
+struct NumberBenchmarkResult
+{
+	String type; // "float32", "float64" or "int32".
+	String operation; // "format", "parse" or "parseList".
+	uint32 count = 0; // Numbers per iteration.
+	float64 referenceTime = 0.0; // Seconds, fastest iteration, using the stream and printf based implementation.
+	float64 time = 0.0; // Seconds, fastest iteration, using strUtils.
+	uint32 mismatches = 0; // Numbers where strUtils gave a different result than the reference.
+};
+
+// Compares strUtils::fromNum(), toNum() and forEachNum() against the stream and printf based implementation they replace,
+// both for speed and for identical results. Random numbers of mixed magnitudes are used, and some special values.
+class NumberBenchmark
+{
+public:
+	List<NumberBenchmarkResult> Run(uint32 count, uint32 iterations);
+
+	static String ToJSON(const List<NumberBenchmarkResult> &results);
+
+private:
+	template<typename T>
+	void _run(const List<T> &numbers, const Char *type, uint32 iterations, List<NumberBenchmarkResult> &results);
+};
+
+}
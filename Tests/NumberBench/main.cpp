@@ -0,0 +1,94 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "NumberBenchmark.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace m3d;
+
+
+namespace
+{
+
+void PrintUsage()
+{
+	std::cerr <<
+		"Usage: NumberBench [options]\n"
+		"  Formats and parses numbers with strUtils and with the stream/printf implementation it replaced (time and mismatches).\n"
+		"  -count <n>        Number of numbers per type (default 1000000).\n"
+		"  -iterations <n>   Number of times to run each operation. The fastest is reported (default 3).\n"
+		"  -out <file>       Write the JSON report to file instead of stdout.\n";
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	uint32 count = 1000000;
+	uint32 iterations = 3;
+	std::string out;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "-count" && i + 1 < argc)
+			count = (uint32)std::max(1, std::atoi(argv[++i]));
+		else if (a == "-iterations" && i + 1 < argc)
+			iterations = (uint32)std::max(1, std::atoi(argv[++i]));
+		else if (a == "-out" && i + 1 < argc)
+			out = argv[++i];
+		else {
+			PrintUsage();
+			return a == "-help" || a == "-h" ? 0 : 1;
+		}
+	}
+
+	NumberBenchmark numbers;
+	List<NumberBenchmarkResult> results = numbers.Run(count, iterations);
+
+	String json = MTEXT("{\n");
+	json += NumberBenchmark::ToJSON(results) + MTEXT("\n");
+	json += MTEXT("}\n");
+
+	if (out.empty())
+		std::cout << json;
+	else {
+		std::ofstream f(out);
+		f << json;
+		if (!f) {
+			std::cerr << "Failed to write " << out << "\n";
+			return 1;
+		}
+	}
+
+	bool succeeded = true;
+	for (const NumberBenchmarkResult &r : results) {
+		std::cerr << r.type << " " << r.operation << ": " << (r.time > 0.0 ? r.referenceTime / r.time : 0.0) << "x" << (r.mismatches ? " (" + std::to_string(r.mismatches) + " mismatches)" : std::string()) << "\n";
+		succeeded = succeeded && r.mismatches == 0;
+	}
+	return succeeded ? 0 : 1;
+}
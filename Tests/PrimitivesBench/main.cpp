@@ -0,0 +1,235 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "Primitives.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+// Generates into storage that is kept between iterations, like the streams of a StdGeometry.
+class ReusedStreams : public prim::MeshStreams
+{
+public:
+	bool tangents = false;
+	std::vector<prim::Vec3> p, n, t, bt;
+	std::vector<prim::Vec2> tc;
+	std::vector<prim::uVec3> indices;
+
+	bool allocate(size_t vertexCount, size_t triangleCount, prim::MeshStreamPointers &streams) override
+	{
+		p.resize(vertexCount);
+		n.resize(vertexCount);
+		tc.resize(vertexCount);
+		indices.resize(triangleCount);
+		streams.p = p.data();
+		streams.n = n.data();
+		streams.tc = tc.data();
+		streams.indices = indices.data();
+		if (tangents) {
+			t.resize(vertexCount);
+			bt.resize(vertexCount);
+			streams.t = t.data();
+			streams.bt = bt.data();
+		}
+		return true;
+	}
+};
+
+struct Shape
+{
+	const char *name;
+	std::function<bool(prim::MeshStreams&, int)> generate; // Tessellation level as argument.
+};
+
+// All primitives of the Primitive chip, with subdivisions scaled by the tessellation level.
+std::vector<Shape> GetShapes()
+{
+	using prim::Primitives;
+	return {
+		{ "box", [](prim::MeshStreams &m, int l) { return Primitives::boxMesh(m, { 1.0, 1.0, 1.0 }, { l, l, l }); } },
+		{ "sphere", [](prim::MeshStreams &m, int l) { return Primitives::sphereMesh(m, 1.0, 2 * l, l); } },
+		{ "cylinder", [](prim::MeshStreams &m, int l) { return Primitives::cylinderMesh(m, 1.0, 1.0, 2 * l, l); } },
+		{ "cone", [](prim::MeshStreams &m, int l) { return Primitives::coneMesh(m, 1.0, 1.0, 2 * l, l); } },
+		{ "torus", [](prim::MeshStreams &m, int l) { return Primitives::torusMesh(m, 0.25, 1.0, l, 2 * l); } },
+		{ "capsule", [](prim::MeshStreams &m, int l) { return Primitives::capsuleMesh(m, 1.0, 0.5, 2 * l, l, l); } },
+		{ "capped_cylinder", [](prim::MeshStreams &m, int l) { return Primitives::cappedCylinderMesh(m, 1.0, 1.0, 2 * l, l, l); } },
+		{ "capped_cone", [](prim::MeshStreams &m, int l) { return Primitives::cappedConeMesh(m, 1.0, 1.0, 2 * l, l, l); } },
+		{ "capped_tube", [](prim::MeshStreams &m, int l) { return Primitives::cappedTubeMesh(m, 1.0, 0.75, 1.0, 2 * l, l, l); } },
+		{ "dodecahedron", [](prim::MeshStreams &m, int l) { return Primitives::dodecahedronMesh(m, 1.0, l, l); } },
+		{ "disk", [](prim::MeshStreams &m, int l) { return Primitives::diskMesh(m, 1.0, 0.0, 2 * l, l); } },
+		{ "icosahedron", [](prim::MeshStreams &m, int l) { return Primitives::icosahedronMesh(m, 1.0, l); } },
+		{ "icosphere", [](prim::MeshStreams &m, int l) { return Primitives::icoSphereMesh(m, 1.0, std::max(1, l / 8)); } },
+		{ "plane", [](prim::MeshStreams &m, int l) { return Primitives::planeMesh(m, { 1.0, 1.0 }, { l, l }); } },
+		{ "rounded_box", [](prim::MeshStreams &m, int l) { return Primitives::roundedBoxMesh(m, 0.25, { 0.75, 0.75, 0.75 }, l, { l, l, l }); } },
+		{ "spherical_cone", [](prim::MeshStreams &m, int l) { return Primitives::sphericalConeMesh(m, 1.0, 1.0, 2 * l, l, l); } },
+		{ "spherical_triangle", [](prim::MeshStreams &m, int l) { return Primitives::sphericalTriangleMesh(m, 1.0, l); } },
+		{ "spring", [](prim::MeshStreams &m, int l) { return Primitives::springMesh(m, 0.25, 1.0, 1.0, l, 4 * l); } },
+		{ "teapot", [](prim::MeshStreams &m, int l) { return Primitives::teapotMesh(m, 1.0, l); } },
+		{ "torus_knot", [](prim::MeshStreams &m, int l) { return Primitives::torusKnotMesh(m, 2, 3, l, 4 * l); } },
+		{ "triangle", [](prim::MeshStreams &m, int l) { return Primitives::triangleMesh(m, 1.0, l); } },
+		{ "tube", [](prim::MeshStreams &m, int l) { return Primitives::tubeMesh(m, 1.0, 0.75, 1.0, 2 * l, l); } },
+	};
+}
+
+struct Result
+{
+	int level = 0;
+	std::string mode;
+	size_t vertexCount = 0; // For the whole set.
+	size_t triangleCount = 0;
+	double time = 0.0; // Seconds for the whole set, from the fastest iteration.
+};
+
+void PrintUsage()
+{
+	std::cout <<
+		"Usage: PrimitivesBench [options]\n"
+		"  Generates all primitives at several tessellation levels.\n"
+		"  -levels <l,l,..>  Tessellation levels (default 4,8,16,32,64).\n"
+		"  -iterations <n>   Number of times to generate the set per level and mode (default 5).\n"
+		"  -out <file>       Write the JSON report to the given file instead of stdout.\n"
+		"\n"
+		"Modes:\n"
+		"  mesh              Into a new prim::Mesh for each primitive (all streams, including tangents).\n"
+		"  streams           Into reused structure of arrays storage, without tangents.\n"
+		"  streams_tangents  Into reused structure of arrays storage, with tangents.\n"
+		"  cache_hit         Copying already generated meshes, which is what a Primitive chip does on a PrimitiveCache hit.\n";
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::vector<int> levels = { 4, 8, 16, 32, 64 };
+	int iterations = 5;
+	std::string out;
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		if (a == "-levels" && i + 1 < argc) {
+			levels.clear();
+			std::stringstream ss(argv[++i]);
+			for (std::string l; std::getline(ss, l, ',');)
+				levels.push_back(std::max(1, std::atoi(l.c_str())));
+		}
+		else if (a == "-iterations" && i + 1 < argc)
+			iterations = std::max(1, std::atoi(argv[++i]));
+		else if (a == "-out" && i + 1 < argc)
+			out = argv[++i];
+		else {
+			PrintUsage();
+			return a == "-help" || a == "-h" ? 0 : 1;
+		}
+	}
+
+	const std::vector<Shape> shapes = GetShapes();
+	const char *modes[] = { "mesh", "streams", "streams_tangents", "cache_hit" };
+	std::vector<Result> results;
+	int failures = 0;
+
+	for (int level : levels) {
+		std::vector<prim::Mesh> cached(shapes.size()); // For cache_hit.
+		for (size_t i = 0; i < shapes.size(); i++)
+			shapes[i].generate(cached[i], level);
+
+		for (const char *mode : modes) {
+			Result r;
+			r.level = level;
+			r.mode = mode;
+			r.time = 1e30;
+			ReusedStreams reused;
+			reused.tangents = std::strcmp(mode, "streams_tangents") == 0;
+
+			for (int it = 0; it < iterations; it++) {
+				size_t vertices = 0, triangles = 0;
+				auto start = std::chrono::steady_clock::now();
+				for (size_t i = 0; i < shapes.size(); i++) {
+					if (std::strcmp(mode, "mesh") == 0) {
+						prim::Mesh mesh;
+						if (!shapes[i].generate(mesh, level))
+							failures += it == 0 ? 1 : 0;
+						vertices += mesh.p.size();
+						triangles += mesh.indices.size();
+					}
+					else if (std::strcmp(mode, "cache_hit") == 0) {
+						reused.p = cached[i].p;
+						reused.n = cached[i].n;
+						reused.tc = cached[i].tc;
+						reused.t = cached[i].t;
+						reused.bt = cached[i].bt;
+						reused.indices = cached[i].indices;
+						vertices += reused.p.size();
+						triangles += reused.indices.size();
+					}
+					else {
+						if (!shapes[i].generate(reused, level))
+							failures += it == 0 ? 1 : 0;
+						vertices += reused.p.size();
+						triangles += reused.indices.size();
+					}
+				}
+				double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+				r.time = std::min(r.time, t);
+				r.vertexCount = vertices;
+				r.triangleCount = triangles;
+			}
+			results.push_back(r);
+			std::cerr << "level " << level << " " << mode << ": " << r.time * 1000.0 << " ms, " << r.vertexCount << " vertices, " << r.triangleCount << " triangles\n";
+		}
+	}
+
+	std::stringstream json;
+	json << "{\n  \"primitives\": " << shapes.size() << ",\n  \"iterations\": " << iterations << ",\n  \"failures\": " << failures << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		json << "    { \"level\": " << r.level << ", \"mode\": \"" << r.mode << "\", \"vertices\": " << r.vertexCount << ", \"triangles\": " << r.triangleCount
+			<< ", \"time_ms\": " << r.time * 1000.0 << ", \"mvertices_per_s\": " << (r.time > 0.0 ? r.vertexCount / r.time / 1e6 : 0.0) << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+	}
+	json << "  ]\n}\n";
+
+	if (out.empty())
+		std::cout << json.str();
+	else {
+		std::ofstream f(out);
+		f << json.str();
+		if (!f) {
+			std::cerr << "Failed to write " << out << "\n";
+			return 1;
+		}
+	}
+
+	return failures > 0 ? 1 : 0;
+}
@@ -0,0 +1,298 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#include "GraphicsChips/ShaderCache.h"
+#include "TestUtil.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+
+using namespace m3d;
+using namespace m3d::test;
+
+
+namespace
+{
+
+// Preprocessing strips comments, so changing a comment gives the same key. A line "#include <Std>" is replaced by
+// the current include text. Compiling gives byte code made from the profile and the preprocessed source, and fails 
+// if the source contains "error".
+class MockCompiler : public ShaderCompiler
+{
+public:
+	String identity = MTEXT("Mock 1.0");
+	String stdText = MTEXT("float4 stdFunc();\n");
+	std::atomic<uint32> compileCount = 0;
+
+	String GetIdentity() const override { return identity; }
+
+	bool Preprocess(const ShaderCompileRequest &request, String &preprocessed, String &messages) override
+	{
+		if (request.source.find(MTEXT("#bad")) != String::npos) {
+			messages += MTEXT("mock(1): unknown directive\n");
+			return false;
+		}
+		preprocessed.clear();
+		size_t p = 0;
+		while (p < request.source.size()) {
+			size_t e = request.source.find('\n', p);
+			String line = request.source.substr(p, e == String::npos ? String::npos : e - p);
+			p = e == String::npos ? request.source.size() : e + 1;
+			line = line.substr(0, line.find(MTEXT("//")));
+			while (!line.empty() && line.back() == ' ')
+				line.pop_back();
+			if (line == MTEXT("#include <Std>"))
+				preprocessed += stdText;
+			else if (!line.empty())
+				preprocessed += line + MTEXT("\n");
+		}
+		return true;
+	}
+
+	bool Compile(const ShaderCompileRequest &request, DataBuffer &byteCode, String &messages) override
+	{
+		compileCount++;
+		String preprocessed;
+		Preprocess(request, preprocessed, messages);
+		if (preprocessed.find(MTEXT("error")) != String::npos) {
+			messages += MTEXT("mock(1): error\n");
+			return false;
+		}
+		messages += MTEXT("mock: warning\n");
+		String bc = MTEXT("BC:") + request.profile + MTEXT(":") + preprocessed;
+		byteCode = DataBuffer((const uint8*)bc.c_str(), bc.size());
+		return true;
+	}
+};
+
+ShaderCompileRequest MakeRequest(String source)
+{
+	ShaderCompileRequest r;
+	r.source = source;
+	r.profile = MTEXT("ps_5_1");
+	return r;
+}
+
+String ToString(const DataBuffer &db)
+{
+	return String((const Char*)db.getConstBuffer(), db.getBufferSize());
+}
+
+uint32 CountCacheFiles(const std::filesystem::path &dir)
+{
+	uint32 n = 0;
+	std::error_code ec;
+	for (std::filesystem::directory_iterator itr(dir, ec), end; !ec && itr != end; itr.increment(ec))
+		if (itr->path().extension() == MTEXT(".sxsc"))
+			n++;
+	return n;
+}
+
+
+}
+
+
+void TestHitAndMiss()
+{
+	printf("Hit and miss\n");
+	auto compiler = std::make_shared<MockCompiler>();
+	ShaderCache cache(compiler);
+	const ShaderCompileRequest r = MakeRequest(MTEXT("#include <Std>\nfloat4 main() : SV_Target { return 1; }\n"));
+
+	ShaderCompileResult a = cache.Compile(r);
+	Check(a.ok && !a.fromCache && a.key != 0, "first compile is a miss");
+	Check(ToString(a.byteCode) == MTEXT("BC:ps_5_1:float4 stdFunc();\nfloat4 main() : SV_Target { return 1; }\n"), "byte code from compiler");
+	Check(a.messages == MTEXT("mock: warning\n"), "compiler messages");
+	Check(cache.GetMissCount() == 1 && cache.GetHitCount() == 0 && compiler->compileCount == 1, "counters after miss");
+
+	ShaderCompileResult b = cache.Compile(r);
+	Check(b.ok && b.fromCache && b.key == a.key, "second compile is a hit");
+	Check(ToString(b.byteCode) == ToString(a.byteCode) && b.messages == a.messages, "hit returns the stored byte code and messages");
+	Check(cache.GetMissCount() == 1 && cache.GetHitCount() == 1 && compiler->compileCount == 1, "counters after hit");
+
+	// Only the preprocessed source is part of the key.
+	ShaderCompileRequest c = MakeRequest(MTEXT("#include <Std> // The standard include.\nfloat4 main() : SV_Target { return 1; } // Changed comment\n"));
+	Check(cache.GetKey(c) == a.key && cache.Compile(c).fromCache, "changed comment is a hit");
+	Check(compiler->compileCount == 1, "changed comment is not compiled");
+
+	cache.Clear();
+	Check(cache.GetHitCount() == 0 && cache.GetMissCount() == 0, "Clear() resets counters");
+	Check(!cache.Compile(r).fromCache && compiler->compileCount == 2, "Clear() removes entries");
+}
+
+void TestInvalidation()
+{
+	printf("Invalidation\n");
+	auto compiler = std::make_shared<MockCompiler>();
+	ShaderCache cache(compiler);
+	const ShaderCompileRequest r = MakeRequest(MTEXT("#include <Std>\nfloat4 main() : SV_Target { return 1; }\n"));
+	const uint64 key = cache.Compile(r).key;
+
+	auto checkMiss = [&](const ShaderCompileRequest &request, const char *what) {
+		uint32 misses = cache.GetMissCount();
+		ShaderCompileResult res = cache.Compile(request);
+		Check(res.ok && !res.fromCache && res.key != key && cache.GetMissCount() == misses + 1, what);
+	};
+
+	checkMiss(MakeRequest(MTEXT("#include <Std>\nfloat4 main() : SV_Target { return 2; }\n")), "changed source");
+	ShaderCompileRequest p = r;
+	p.profile = MTEXT("ps_5_0");
+	checkMiss(p, "changed profile");
+	ShaderCompileRequest e = r;
+	e.entryPoint = MTEXT("psMain");
+	checkMiss(e, "changed entry point");
+	ShaderCompileRequest f = r;
+	f.flags = 1;
+	checkMiss(f, "changed flags");
+	ShaderCompileRequest d = r;
+	d.defines.push_back(std::make_pair(String(MTEXT("USE_FOG")), String(MTEXT("1"))));
+	checkMiss(d, "added define");
+	d.defines.back().second = MTEXT("0");
+	checkMiss(d, "changed define value");
+
+	// The include is expanded by the preprocessor, so changing it changes the key of shaders using it only.
+	const ShaderCompileRequest noInclude = MakeRequest(MTEXT("float4 main() : SV_Target { return 3; }\n"));
+	const uint64 noIncludeKey = cache.Compile(noInclude).key;
+	compiler->stdText = MTEXT("float4 stdFunc2();\n");
+	checkMiss(r, "changed include");
+	Check(cache.GetKey(noInclude) == noIncludeKey && cache.Compile(noInclude).fromCache, "shader not using the include is a hit");
+	compiler->stdText = MTEXT("float4 stdFunc();\n");
+	Check(cache.Compile(r).fromCache, "include changed back is a hit");
+
+	compiler->identity = MTEXT("Mock 1.1");
+	checkMiss(r, "changed compiler identity");
+}
+
+void TestFailures()
+{
+	printf("Failures\n");
+	auto compiler = std::make_shared<MockCompiler>();
+	ShaderCache cache(compiler);
+
+	ShaderCompileRequest bad = MakeRequest(MTEXT("#bad\n"));
+	String msg;
+	Check(cache.GetKey(bad, &msg) == 0 && msg == MTEXT("mock(1): unknown directive\n"), "preprocessor failure gives key 0 and messages");
+	ShaderCompileResult a = cache.Compile(bad);
+	Check(!a.ok && a.key == 0 && a.messages == MTEXT("mock(1): unknown directive\n") && compiler->compileCount == 0, "preprocessor failure is not compiled");
+
+	ShaderCompileRequest error = MakeRequest(MTEXT("error\n"));
+	ShaderCompileResult b = cache.Compile(error);
+	Check(!b.ok && b.key != 0 && b.messages == MTEXT("mock(1): error\n"), "compile failure");
+	ShaderCompileResult c = cache.Compile(error);
+	Check(!c.ok && !c.fromCache && compiler->compileCount == 2, "compile failures are not cached");
+}
+
+void TestDisk()
+{
+	printf("Disk\n");
+	TempDir dir("ShaderCacheTest");
+	auto compiler = std::make_shared<MockCompiler>();
+	const ShaderCompileRequest r = MakeRequest(MTEXT("float4 main() : SV_Target { return 1; }\n"));
+	const ShaderCompileRequest r2 = MakeRequest(MTEXT("float4 main() : SV_Target { return 2; }\n"));
+	String byteCode;
+
+	{
+		ShaderCache cache(compiler, dir.path / MTEXT("Sub") / MTEXT("Cache"));
+		byteCode = ToString(cache.Compile(r).byteCode);
+		cache.Compile(r2);
+		Check(CountCacheFiles(cache.GetDirectory()) == 2, "one file per entry, directory created");
+		Check(cache.Compile(MakeRequest(MTEXT("error\n"))).ok == false && CountCacheFiles(cache.GetDirectory()) == 2, "failures are not stored");
+	}
+
+	{ // A new session.
+		ShaderCache cache(compiler, dir.path / MTEXT("Sub") / MTEXT("Cache"));
+		uint32 n = compiler->compileCount;
+		ShaderCompileResult a = cache.Compile(r);
+		Check(a.ok && a.fromCache && compiler->compileCount == n, "hit from disk");
+		Check(ToString(a.byteCode) == byteCode && a.messages == MTEXT("mock: warning\n"), "byte code and messages from disk");
+
+		// Damaged entries are compiled again and replaced.
+		cache.Clear();
+		for (std::filesystem::directory_iterator itr(cache.GetDirectory()), end; itr != end; ++itr)
+			std::filesystem::resize_file(itr->path(), std::filesystem::file_size(itr->path()) - 1);
+		ShaderCompileResult b = cache.Compile(r);
+		Check(b.ok && !b.fromCache && ToString(b.byteCode) == byteCode, "damaged file is compiled again");
+		cache.Clear();
+		Check(cache.Compile(r).fromCache, "damaged file is replaced");
+
+		cache.Clear(true);
+		Check(CountCacheFiles(cache.GetDirectory()) == 0, "Clear(true) removes the files");
+		Check(!cache.Compile(r2).fromCache, "miss after Clear(true)");
+	}
+
+	{ // No directory: memory only.
+		ShaderCache cache(compiler);
+		cache.Compile(r);
+		Check(cache.GetDirectory().empty() && CountCacheFiles(dir.path / MTEXT("Sub") / MTEXT("Cache")) == 1, "memory only without directory");
+	}
+}
+
+void TestBatch()
+{
+	printf("Batch\n");
+	auto compiler = std::make_shared<MockCompiler>();
+	ShaderCache cache(compiler);
+
+	List<ShaderCompileRequest> requests;
+	for (uint32 i = 0; i < 64; i++)
+		requests.push_back(MakeRequest(String(MTEXT("float4 main() : SV_Target { return ")) + Char('0' + i % 8) + MTEXT("; } // ") + String(std::to_string(i)) + MTEXT("\n")));
+	requests.push_back(MakeRequest(MTEXT("#bad\n")));
+	requests.push_back(MakeRequest(MTEXT("error\n")));
+
+	List<uint64> keys = cache.GetKeys(requests, 4);
+	Check(keys.size() == requests.size(), "one key per request");
+	bool keysOk = true;
+	for (uint32 i = 0; i < 64; i++)
+		keysOk = keysOk && keys[i] != 0 && keys[i] == keys[i % 8] && cache.GetKey(requests[i]) == keys[i];
+	for (uint32 i = 1; i < 8; i++)
+		keysOk = keysOk && keys[i] != keys[0];
+	Check(keysOk && keys[64] == 0, "parallel keys match GetKey()");
+
+	List<ShaderCompileResult> results = cache.CompileBatch(requests, 4, &keys);
+	Check(results.size() == requests.size(), "one result per request");
+	Check(compiler->compileCount == 9, "equal keys are compiled once");
+	bool resultsOk = true;
+	for (uint32 i = 0; i < 64; i++)
+		resultsOk = resultsOk && results[i].ok && results[i].key == keys[i] && ToString(results[i].byteCode) == ToString(results[i % 8].byteCode) && results[i].fromCache == (i >= 8);
+	Check(resultsOk, "results in request order");
+	Check(!results[64].ok && results[64].messages == MTEXT("mock(1): unknown directive\n") && !results[65].ok, "failures in batch");
+
+	results = cache.CompileBatch(requests, 0);
+	bool allCached = true;
+	for (uint32 i = 0; i < 64; i++)
+		allCached = allCached && results[i].ok && results[i].fromCache;
+	Check(allCached && compiler->compileCount == 10, "second batch hits the cache (only the failing request compiled)");
+}
+
+int main()
+{
+	TestHitAndMiss();
+	TestInvalidation();
+	TestFailures();
+	TestDisk();
+	TestBatch();
+
+	return Report();
+}
@@ -0,0 +1,90 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#pragma once
+
+#include "M3DCore/MTypes.h"
+#include <cstdio>
+#include <string>
+#include <chrono>
+#include <filesystem>
+
+// Helpers shared by the portable tests and benchmarks.
+
+namespace m3d
+{
+namespace test
+{
+
+// Number of failed checks so far.
+inline uint32 &Failures()
+{
+	static uint32 failures = 0;
+	return failures;
+}
+
+// Prints and counts a failed check. Returns ok. Printed to stderr, so benchmarks can write their results to stdout.
+inline bool Check(bool ok, const char *what)
+{
+	if (!ok) {
+		fflush(stdout);
+		fprintf(stderr, "  FAILED: %s\n", what);
+		Failures()++;
+	}
+	return ok;
+}
+
+// Prints the summary and returns the exit code of the test program.
+inline int Report()
+{
+	if (Failures()) {
+		printf("%u test(s) failed.\n", Failures());
+		return 1;
+	}
+	printf("All tests passed.\n");
+	return 0;
+}
+
+// A new empty directory in the temp folder, removed with everything in it by the destructor.
+struct TempDir
+{
+	std::filesystem::path path;
+
+	TempDir(const char *prefix)
+	{
+		path = std::filesystem::temp_directory_path() / (std::string(prefix) + "_" + std::to_string((uint64)std::chrono::steady_clock::now().time_since_epoch().count()));
+		std::filesystem::remove_all(path);
+		std::filesystem::create_directories(path);
+	}
+	~TempDir()
+	{
+		std::error_code ec;
+		std::filesystem::remove_all(path, ec);
+	}
+
+	TempDir(const TempDir&) = delete;
+	TempDir &operator=(const TempDir&) = delete;
+};
+
+}
+}
@@ -0,0 +1,224 @@
+// SnaX Game Engine - https://github.com/snaxgameengine/snax
+// Licensed under the MIT License <http://opensource.org/licenses/MIT>.
+// SPDX-License-Identifier: MIT
+// Copyright (c) 2013 - 2022 Frank-Vegar Mortensen <franksvm(at)outlook(dot)com>.
+//
+// Permission is hereby  granted, free of charge, to any  person obtaining a copy
+// of this software and associated  documentation files (the "Software"), to deal
+// in the Software  without restriction, including without  limitation the rights
+// to  use, copy,  modify, merge,  publish, distribute,  sublicense, and/or  sell
+// copies  of  the Software,  and  to  permit persons  to  whom  the Software  is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE  IS PROVIDED "AS  IS", WITHOUT WARRANTY  OF ANY KIND,  EXPRESS OR
+// IMPLIED,  INCLUDING BUT  NOT  LIMITED TO  THE  WARRANTIES OF  MERCHANTABILITY,
+// FITNESS FOR  A PARTICULAR PURPOSE AND  NONINFRINGEMENT. IN NO EVENT  SHALL THE
+// AUTHORS  OR COPYRIGHT  HOLDERS  BE  LIABLE FOR  ANY  CLAIM,  DAMAGES OR  OTHER
+// LIABILITY, WHETHER IN AN ACTION OF  CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE  OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+
+#include "GraphicsChips/TextureProcessing.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+using namespace m3d;
+
+
+namespace
+{
+
+const char *ToString(TextureCompression compression)
+{
+	switch (compression)
+	{
+	case TextureCompression::BC1: return "BC1";
+	case TextureCompression::BC3: return "BC3";
+	case TextureCompression::BC4: return "BC4";
+	case TextureCompression::BC5: return "BC5";
+	case TextureCompression::BC7: return "BC7";
+	default: return "NONE";
+	}
+}
+
+struct Result
+{
+	TextureCompression compression = TextureCompression::NONE;
+	bool succeeded = false;
+	TextureProcessingStats stats; // From the fastest iteration.
+};
+
+// Reads an image with the portable decoders. JPG and other WIC formats are not supported here. Use SnaXBench -texture for those.
+bool LoadImage(const std::string &file, DecodedImage &img)
+{
+	std::ifstream f(file, std::ios::binary);
+	List<uint8> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+	if (data.empty())
+		return false;
+	return imagedecoder::DecodePNG(data.data(), data.size(), img) || imagedecoder::DecodeTGA(data.data(), data.size(), img) || imagedecoder::DecodeBMP(data.data(), data.size(), img) || imagedecoder::DecodeDDS(data.data(), data.size(), img);
+}
+
+// A size x size image with smooth gradients, hard edges and noise. Opaque unless alpha is set, since BC1 only has 1-bit alpha.
+void MakeTestImage(uint32 size, bool normalMap, bool alpha, DecodedImage &img)
+{
+	img.InitRGBA8(size, size);
+	uint32 seed = 12345;
+	for (uint32 y = 0; y < size; y++) {
+		for (uint32 x = 0; x < size; x++) {
+			seed = seed * 1664525u + 1013904223u;
+			float64 u = float64(x) / size, v = float64(y) / size, n = float64(seed >> 24) / 255.0 - 0.5;
+			uint8 *d = &img.data[(size_t(y) * size + x) * 4];
+			if (normalMap) {
+				float64 nx = 0.4 * std::sin(u * 25.0) + 0.05 * n, ny = 0.4 * std::cos(v * 17.0), nz = std::sqrt(std::max(0.0, 1.0 - nx * nx - ny * ny));
+				d[0] = uint8((nx * 0.5 + 0.5) * 255.0 + 0.5);
+				d[1] = uint8((ny * 0.5 + 0.5) * 255.0 + 0.5);
+				d[2] = uint8((nz * 0.5 + 0.5) * 255.0 + 0.5);
+				d[3] = 255;
+			}
+			else {
+				bool checker = ((x / 32) + (y / 32)) % 2 == 0;
+				d[0] = uint8(std::clamp(u * 255.0 + n * 16.0, 0.0, 255.0));
+				d[1] = uint8(std::clamp(v * 255.0 + n * 16.0, 0.0, 255.0));
+				d[2] = checker ? 200 : 40;
+				d[3] = alpha ? uint8(std::clamp(255.0 * (0.5 + 0.5 * std::sin((u + v) * 12.0)), 0.0, 255.0)) : 255;
+			}
+		}
+	}
+}
+
+void PrintUsage()
+{
+	std::cout <<
+		"Usage: TextureBench [image] [options]\n"
+		"  Measures CPU mip generation and block compression (PSNR and MB/s) of a PNG, TGA, BMP or DDS image,\n"
+		"  or of a generated test image if none is given.\n"
+		"  -size <n>          Size of the generated test image (default 1024).\n"
+		"  -alpha             Give the generated test image a varying alpha channel.\n"
+		"  -format <f>        BC1, BC3, BC4, BC5, BC7, NONE or ALL (default ALL).\n"
+		"  -mipfilter <f>     NONE, BOX or KAISER (default KAISER).\n"
+		"  -linear            The image is not gamma encoded.\n"
+		"  -normalmap         The image is a normal map.\n"
+		"  -iterations <n>    Number of times to process the image per format (default 3).\n"
+		"  -threads <n>       Number of worker threads. 0 for all (default 0).\n"
+		"  -minpsnr <db>      Fail if the PSNR of any format is below this (default 0).\n"
+		"  -out <file>        Write the JSON report to the given file instead of stdout.\n";
+}
+
+}
+
+
+int main(int argc, char *argv[])
+{
+	std::string image, out;
+	uint32 size = 1024, iterations = 3;
+	float64 minPSNR = 0.0;
+	bool alpha = false;
+	TextureProcessingOptions options;
+	List<TextureCompression> compressions = { TextureCompression::NONE, TextureCompression::BC1, TextureCompression::BC3, TextureCompression::BC4, TextureCompression::BC5, TextureCompression::BC7 };
+
+	for (int i = 1; i < argc; i++) {
+		std::string a = argv[i];
+		std::string v = i + 1 < argc ? argv[i + 1] : "";
+		if (a == "-size" && !v.empty()) { size = (uint32)std::max(4, std::atoi(v.c_str())); i++; }
+		else if (a == "-format" && !v.empty()) {
+			if (v != "ALL") {
+				compressions.clear();
+				for (uint32 j = 0; j <= uint32(TextureCompression::BC7); j++)
+					if (v == ToString(TextureCompression(j)))
+						compressions.push_back(TextureCompression(j));
+				if (compressions.empty()) {
+					std::cerr << "Invalid format: " << v << "\n";
+					return 1;
+				}
+			}
+			i++;
+		}
+		else if (a == "-mipfilter" && (v == "NONE" || v == "BOX" || v == "KAISER")) {
+			options.mipFilter = v == "NONE" ? TextureMipFilter::NONE : (v == "BOX" ? TextureMipFilter::BOX : TextureMipFilter::KAISER);
+			i++;
+		}
+		else if (a == "-alpha") alpha = true;
+		else if (a == "-linear") options.sRGB = false;
+		else if (a == "-normalmap") options.normalMap = true;
+		else if (a == "-iterations" && !v.empty()) { iterations = (uint32)std::max(1, std::atoi(v.c_str())); i++; }
+		else if (a == "-threads" && !v.empty()) { options.threadCount = (uint32)std::max(0, std::atoi(v.c_str())); i++; }
+		else if (a == "-minpsnr" && !v.empty()) { minPSNR = std::atof(v.c_str()); i++; }
+		else if (a == "-out" && !v.empty()) { out = v; i++; }
+		else if (a[0] != '-' && image.empty()) image = a;
+		else {
+			PrintUsage();
+			return a == "-help" || a == "-h" ? 0 : 1;
+		}
+	}
+
+	DecodedImage source;
+	if (image.empty())
+		MakeTestImage(size, options.normalMap, alpha, source);
+	else if (!LoadImage(image, source)) {
+		std::cerr << "Failed to load image (only PNG, TGA, BMP and DDS are supported): " << image << "\n";
+		return 1;
+	}
+
+	List<Result> results;
+	for (TextureCompression compression : compressions) {
+		Result r;
+		r.compression = compression;
+		TextureProcessingOptions o = options;
+		o.compression = compression;
+		for (uint32 i = 0; i < iterations; i++) {
+			DecodedImage img = source;
+			TextureProcessingStats stats;
+			if (!textureprocessing::Process(img, o, &stats))
+				break;
+			if (!r.succeeded || stats.mipTime + stats.compressTime < r.stats.mipTime + r.stats.compressTime)
+				r.stats = stats;
+			r.succeeded = true;
+		}
+		results.push_back(r);
+	}
+
+	static const char *FILTER[] = { "NONE", "BOX", "KAISER" };
+
+	bool succeeded = true;
+	std::stringstream json;
+	json << "{\n  \"image\": \"" << (image.empty() ? "generated" : image) << "\",\n  \"width\": " << source.width << ",\n  \"height\": " << source.height
+		<< ",\n  \"mipFilter\": \"" << FILTER[uint32(options.mipFilter)] << "\",\n  \"sRGB\": " << (options.sRGB ? "true" : "false") << ",\n  \"normalMap\": " << (options.normalMap ? "true" : "false")
+		<< ",\n  \"threads\": " << options.threadCount << ",\n  \"results\": [\n";
+	for (size_t i = 0; i < results.size(); i++) {
+		const Result &r = results[i];
+		const TextureProcessingStats &t = r.stats;
+		json << "    { \"format\": \"" << ToString(r.compression) << "\", \"succeeded\": " << (r.succeeded ? "true" : "false") << ", \"psnr\": " << t.psnr
+			<< ", \"mipTimeMs\": " << t.mipTime * 1000.0 << ", \"compressTimeMs\": " << t.compressTime * 1000.0 << ", \"compressMBps\": " << (t.compressTime > 0.0 ? t.sourceBytes / t.compressTime / 1.0e6 : 0.0)
+			<< ", \"sourceBytes\": " << t.sourceBytes << ", \"outputBytes\": " << t.outputBytes << " }" << (i + 1 < results.size() ? "," : "") << "\n";
+		std::cerr << ToString(r.compression) << ": psnr " << t.psnr << " dB, mips " << t.mipTime * 1000.0 << " ms, compress " << t.compressTime * 1000.0 << " ms\n";
+		// NONE is lossless, so it is not checked.
+		if (!r.succeeded || (r.compression != TextureCompression::NONE && t.psnr < minPSNR))
+			succeeded = false;
+	}
+	json << "  ]\n}\n";
+
+	if (out.empty())
+		std::cout << json.str();
+	else {
+		std::ofstream f(out);
+		f << json.str();
+		if (!f) {
+			std::cerr << "Failed to write " << out << "\n";
+			return 1;
+		}
+	}
+
+	return succeeded ? 0 : 1;
+}